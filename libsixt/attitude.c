@@ -23,6 +23,11 @@
 #include "attitude.h"
 
 
+/** Number of entries the current entry of the Attitude is moved
+    step by step, before it is searched by bisection. */
+#define ATTITUDE_MAX_STEPS (8)
+
+
 Attitude* getAttitude(int* const status)
 {
   Attitude* ac=(Attitude*)malloc(sizeof(Attitude));
@@ -40,6 +45,7 @@ Attitude* getAttitude(int* const status)
   ac->mjdref   =0.0;
   ac->tstart   =0.0;
   ac->tstop    =0.0;
+  ac->segment.index=-1;
 
   return(ac);
 }
@@ -211,6 +217,40 @@ static void setAttitudeCurrEntry(Attitude* const ac,
     return;
   }
 
+  // If the requested time lies far away from the current time bin,
+  // jump to the appropriate bin by bisection. The result is the same
+  // as the one of the step-wise search below.
+  long currentry=ac->currentry;
+  if ((time < ac->entry[0].time) || (time > ac->entry[ac->nentries-1].time)) {
+    // Leave the error handling to the step-wise search.
+  } else if ((currentry >= ATTITUDE_MAX_STEPS) &&
+	     (time < ac->entry[currentry-ATTITUDE_MAX_STEPS].time)) {
+    // Last entry before or at the requested time.
+    long lower=0, upper=currentry-ATTITUDE_MAX_STEPS;
+    while (upper-lower > 1) {
+      long middle=(lower+upper)/2;
+      if (ac->entry[middle].time <= time) {
+	lower=middle;
+      } else {
+	upper=middle;
+      }
+    }
+    ac->currentry=lower;
+  } else if ((currentry+1+ATTITUDE_MAX_STEPS <= ac->nentries-1) &&
+	     (time > ac->entry[currentry+1+ATTITUDE_MAX_STEPS].time)) {
+    // First entry at or after the requested time.
+    long lower=currentry+1+ATTITUDE_MAX_STEPS, upper=ac->nentries-1;
+    while (upper-lower > 1) {
+      long middle=(lower+upper)/2;
+      if (ac->entry[middle].time < time) {
+	lower=middle;
+      } else {
+	upper=middle;
+      }
+    }
+    ac->currentry=upper-1;
+  }
+
   // Check if the requested time lies within the current time bin.
   while (time < ac->entry[ac->currentry].time) {
     // Check if the beginning of the Attitude is reached.
@@ -269,36 +309,20 @@ Vector getTelescopeNz(Attitude* const ac,
 }
 
 
-void getTelescopeAxes(Attitude* const ac,
-		      Vector* const nx,
-		      Vector* const ny,
-		      Vector* const nz,
-		      const double time,
-		      int* const status)
+/** Determine the nx and ny axes of the telescope coordinate system
+    from the pointing direction nz. The difference vector dnz to the
+    neighbouring attitude entry is only used for alignment along the
+    direction of motion of non-pointed observations. */
+static void setTelescopeNxNy(const Attitude* const ac,
+			     Vector* const nx,
+			     Vector* const ny,
+			     const Vector* const nz,
+			     const Vector dnz,
+			     const int pointed,
+			     const double cosroll,
+			     const double sinroll,
+			     int* const status)
 {
-  // Determine the z vector (telescope pointing direction):
-  *nz=getTelescopeNz(ac, time, status);
-  CHECK_STATUS_VOID(*status);
-  // After calling getTelescopeNz() the internal current entry pointer
-  // within the attitude catalog is set to the appropriate time bin.
-
-  // Check if this is a pointed observation.
-  int pointed=0;
-  Vector dnz;
-  if (1==ac->nentries) {
-    // There is only one entry in the Attitude.
-    pointed=1;
-  } else {
-    if (ac->currentry>0) {
-      dnz=vector_difference(*nz, ac->entry[ac->currentry-1].nz);
-    } else {
-      dnz=vector_difference(ac->entry[ac->currentry+1].nz, *nz);
-    }
-    if (scalar_product(&dnz, &dnz)<1.e-10) {
-      pointed=1;
-    }
-  }
-
   // Check if the x1 vector should be aligned along the north direction
   // or along the direction of motion of the telescope axis
   // (neglecting the rotation according to the roll angle). For a pointed
@@ -346,10 +370,6 @@ void getTelescopeAxes(Attitude* const ac,
   Vector y1=normalize_vector(vector_product(*nz, x1));
 
   // Take into account the roll angle.
-  float roll_angle=getRollAngle(ac, time, status);
-  CHECK_STATUS_VOID(*status);
-  double sinroll=sin(roll_angle);
-  double cosroll=cos(roll_angle);
   nx->x= x1.x * cosroll + y1.x * sinroll;
   nx->y= x1.y * cosroll + y1.y * sinroll;
   nx->z= x1.z * cosroll + y1.z * sinroll;
@@ -359,6 +379,178 @@ void getTelescopeAxes(Attitude* const ac,
 }
 
 
+/** Difference vector between the pointing direction nz within the
+    current time bin and the neighbouring attitude entry, and check
+    whether the telescope axis is at rest. */
+static int getTelescopeMotion(const Attitude* const ac,
+			      const Vector* const nz,
+			      Vector* const dnz)
+{
+  if (1==ac->nentries) {
+    // There is only one entry in the Attitude.
+    dnz->x=0.;
+    dnz->y=0.;
+    dnz->z=0.;
+    return(1);
+  }
+
+  if (ac->currentry>0) {
+    *dnz=vector_difference(*nz, ac->entry[ac->currentry-1].nz);
+  } else {
+    *dnz=vector_difference(ac->entry[ac->currentry+1].nz, *nz);
+  }
+  if (scalar_product(dnz, dnz)<1.e-10) {
+    return(1);
+  }
+  return(0);
+}
+
+
+void getTelescopeAxes(Attitude* const ac,
+		      Vector* const nx,
+		      Vector* const ny,
+		      Vector* const nz,
+		      const double time,
+		      int* const status)
+{
+  // Determine the z vector (telescope pointing direction):
+  *nz=getTelescopeNz(ac, time, status);
+  CHECK_STATUS_VOID(*status);
+  // After calling getTelescopeNz() the internal current entry pointer
+  // within the attitude catalog is set to the appropriate time bin.
+
+  // Check if this is a pointed observation.
+  Vector dnz;
+  int pointed=getTelescopeMotion(ac, nz, &dnz);
+
+  // Take into account the roll angle.
+  float roll_angle=getRollAngle(ac, time, status);
+  CHECK_STATUS_VOID(*status);
+  setTelescopeNxNy(ac, nx, ny, nz, dnz, pointed,
+		   cos(roll_angle), sin(roll_angle), status);
+}
+
+
+/** Fill the segment cache of the Attitude for the current entry. */
+static void setAttitudeSegment(Attitude* const ac)
+{
+  AttitudeSegment* const seg=&ac->segment;
+  const AttitudeEntry* const e0=&ac->entry[ac->currentry];
+  seg->index=ac->currentry;
+  seg->nz0=e0->nz;
+
+  if (1==ac->nentries) {
+    // Pointing attitude.
+    seg->angle=0.;
+    seg->const_roll=1;
+  } else {
+    const AttitudeEntry* const e1=&ac->entry[ac->currentry+1];
+
+    // Rotation along the great circle from the pointing direction at
+    // the beginning to the one at the end of the segment (see
+    // interpolateCircleVector()).
+    double scp=scalar_product(&e0->nz, &e1->nz);
+    if (fabs(scp-1.0)<1.e-15) {
+      seg->angle=0.;
+    } else {
+      seg->angle=acos(scp);
+      double norm=sqrt(1.-scp*scp);
+      seg->nperp.x=(e1->nz.x-scp*e0->nz.x)/norm;
+      seg->nperp.y=(e1->nz.y-scp*e0->nz.y)/norm;
+      seg->nperp.z=(e1->nz.z-scp*e0->nz.z)/norm;
+    }
+    seg->const_roll=(e0->roll_angle==e1->roll_angle);
+  }
+
+  if (seg->const_roll) {
+    seg->cosroll=cos(e0->roll_angle);
+    seg->sinroll=sin(e0->roll_angle);
+  }
+}
+
+
+void getTelescopeFrame(Attitude* const ac,
+		       Vector* const nx,
+		       Vector* const ny,
+		       Vector* const nz,
+		       const double time,
+		       int* const status)
+{
+  // Find the appropriate entry in the Attitude for the requested time
+  // and the corresponding segment.
+  if (ac->nentries>1) {
+    setAttitudeCurrEntry(ac, time, status);
+    CHECK_STATUS_VOID(*status);
+  } else {
+    ac->currentry=0;
+  }
+  if (ac->segment.index!=ac->currentry) {
+    setAttitudeSegment(ac);
+  }
+  const AttitudeSegment* const seg=&ac->segment;
+
+  // Determine the z vector (telescope pointing direction) by the
+  // rotation along the great circle of the segment.
+  double fraction=0.;
+  if (ac->nentries>1) {
+    fraction=
+      (time-ac->entry[ac->currentry].time)/
+      (ac->entry[ac->currentry+1].time-ac->entry[ac->currentry].time);
+  }
+  if (seg->angle>0.) {
+    double cosphase=cos(fraction*seg->angle);
+    double sinphase=sin(fraction*seg->angle);
+    nz->x=cosphase*seg->nz0.x + sinphase*seg->nperp.x;
+    nz->y=cosphase*seg->nz0.y + sinphase*seg->nperp.y;
+    nz->z=cosphase*seg->nz0.z + sinphase*seg->nperp.z;
+  } else {
+    *nz=seg->nz0;
+  }
+
+  if ((NULL==nx) || (NULL==ny)) {
+    return;
+  }
+
+  // Check if this is a pointed observation.
+  Vector dnz;
+  int pointed=getTelescopeMotion(ac, nz, &dnz);
+
+  // Take into account the roll angle (interpolated in the same way as
+  // in getRollAngle()).
+  if (seg->const_roll) {
+    setTelescopeNxNy(ac, nx, ny, nz, dnz, pointed,
+		     seg->cosroll, seg->sinroll, status);
+  } else {
+    float roll_angle=
+      ac->entry[ac->currentry  ].roll_angle*(1.-fraction) +
+      ac->entry[ac->currentry+1].roll_angle*    fraction;
+    setTelescopeNxNy(ac, nx, ny, nz, dnz, pointed,
+		     cos(roll_angle), sin(roll_angle), status);
+  }
+}
+
+
+void getTelescopeFrames(Attitude* const ac,
+			const long ntimes,
+			const double* const time,
+			Vector* const nx,
+			Vector* const ny,
+			Vector* const nz,
+			int* const status)
+{
+  // As the points of time are sorted, the segments are passed
+  // one after the other and each of them is only prepared once.
+  long ii;
+  for (ii=0; ii<ntimes; ii++) {
+    getTelescopeFrame(ac,
+		      (NULL==nx) ? NULL : &nx[ii],
+		      (NULL==ny) ? NULL : &ny[ii],
+		      &nz[ii], time[ii], status);
+    CHECK_STATUS_VOID(*status);
+  }
+}
+
+
 float getRollAngle(Attitude* const ac,
 		   const double time,
 		   int* const status)
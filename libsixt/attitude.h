@@ -66,6 +66,31 @@ typedef struct {
 } AttitudeEntry;
 
 
+/** Segment of the Attitude between two subsequent entries, cached
+    for the evaluation of the telescope frame at points of time within
+    the segment. */
+typedef struct {
+  /** Index of the entry at the beginning of the segment (-1 if no
+      segment is cached). */
+  long index;
+
+  /** Telescope pointing direction at the beginning of the segment and
+      unit vector perpendicular to it in the plane of the great circle
+      towards the pointing direction at the end of the segment. */
+  Vector nz0, nperp;
+
+  /** Angle between the pointing directions at the beginning and at
+      the end of the segment ([rad]). Zero if they are identical. */
+  double angle;
+
+  /** Flag whether the roll-angle is constant along the segment, and
+      its cosine and sine in that case. */
+  int const_roll;
+  double cosroll, sinroll;
+
+} AttitudeSegment;
+
+
 /** Collection containing the temporal evolution of the attitude. */
 typedef struct {
   /** Number of AttituideEntry elements in the Attitude. */
@@ -89,6 +114,10 @@ typedef struct {
   /** TSTART and TSTOP. */
   double tstart, tstop;
 
+  /** Segment used by the last call of getTelescopeFrame(). Has to be
+      reset (index=-1) if the entries are modified afterwards. */
+  AttitudeSegment segment;
+
 } Attitude;
 
 
@@ -126,6 +155,31 @@ void getTelescopeAxes(Attitude* const ac,
 		      const double time,
 		      int* const status);
 
+/** Determine the 3 axes vectors for the telescope coordinate system
+    at a specific time in a single call. The results are the same as
+    the ones of getTelescopeAxes(), but the attitude segment containing
+    the requested time and its great-circle rotation are cached, such
+    that subsequent calls within the same segment do not have to
+    search and interpolate the attitude entries again. If nx and ny
+    are NULL, only the pointing direction nz is determined. */
+void getTelescopeFrame(Attitude* const ac,
+		       Vector* const nx,
+		       Vector* const ny,
+		       Vector* const nz,
+		       const double time,
+		       int* const status);
+
+/** Determine the telescope frames for an array of ntimes points of
+    time, which have to be sorted in ascending order (batch version of
+    getTelescopeFrame()). */
+void getTelescopeFrames(Attitude* const ac,
+			const long ntimes,
+			const double* const time,
+			Vector* const nx,
+			Vector* const ny,
+			Vector* const nz,
+			int* const status);
+
 /** Determine the roll-angle ([rad]) at a specific time. */
 float getRollAngle(Attitude* const ac,
 		   const double time,
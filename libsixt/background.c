@@ -22,15 +22,14 @@
 
 #include "background.h"
 
-static backgroundInput bkginputdata;
-static backgroundRateFct bkgratefct;
-static struct rateCurrentInterval rCurr = {0L, 0., NULL, 0L};
+/* Generator and random number generator used by the module-level
+ * interface (bkgInitialize, bkgGetBackgroundList, ...). */
+static BkgGenerator* bkggen = NULL;
+static gsl_rng* bkgrng = NULL;
 
 /* Needed for dynamic rate adjustment during initialization. */
 static int rate_initialized = 0;
-
-/* Conversion from eV to keV if necessary. Will be 1 or 1000. */
-static int ev_conversion = 1;
+static double aux_rate = 0.;
 
 struct timeb time_struct;
 
@@ -38,46 +37,31 @@ struct timeb time_struct;
 
 /** @internal
  *  Count the number of separate events (i.e. the events without
- *  secondary interactions) by looking at the timestamps.
+ *  secondary interactions) by looking at the timestamps and write
+ *  the positions of their first hits to the event list (numevents+1
+ *  elements, the last one being the total number of hits).
  */
-static int calcEvents(const double* const hit_time, const long numrows) {
-  int cc = 0;
-  int numevents = 1;
+static void fillEventList(bkgEventTable* const table, int* const status) {
+  long cc = 0, dd = 0;
 
-  for(cc = 0; cc < (numrows - 1); cc++) {
-    if(hit_time[cc] != hit_time[cc + 1]) {
-      numevents++;
+  table->numevents = 1;
+  for(cc = 0; cc < (table->numrows - 1); cc++) {
+    if(table->hit_time[cc] != table->hit_time[cc + 1]) {
+      table->numevents++;
     }
   }
 
-  return numevents;
-}
+  table->event_start = (long*) malloc((table->numevents + 1) * sizeof(long));
+  CHECK_MALLOC_VOID_STATUS(table->event_start, *status);
 
-/** @internal
- *  Write positions of next separate events to an eventlist.
- */
-static void fillEventList(const double* const hit_time,
-		   const long numrows,
-		   size_t* const eventlist) {
-  int cc = 0, dd = 0;
-
-  eventlist[dd] = cc;
-  for(cc = 0; cc < (numrows - 1); cc++) {
-    if(hit_time[cc] != hit_time[cc + 1]) {
+  table->event_start[dd] = 0;
+  for(cc = 0; cc < (table->numrows - 1); cc++) {
+    if(table->hit_time[cc] != table->hit_time[cc + 1]) {
       dd++;
-      eventlist[dd] = cc + 1;
+      table->event_start[dd] = cc + 1;
     }
   }
-}
-
-/** @internal
- *  Calculate the number of events for the given interval.
- */
-static inline double calcEventRate(const double interval) {
-  double eventrate = bkginputdata.aux.rate;
-  eventrate *= interval;
-
-  return eventrate;
+  table->event_start[table->numevents] = table->numrows;
 }
 
 /** @internal
@@ -85,9 +69,11 @@ static inline double calcEventRate(const double interval) {
  *  If the unit is 'eV' the module will convert the energy output values
  *  to keV. If no unit is supplied we assume that the unit is keV.
  *  In any other case the module will throw an error and exit.
+ *  Returns the conversion factor to keV (1 or 1000).
  */
-static void checkEnergyUnit(fitsfile* fptr, const int colnum, int* const status) {
+static int checkEnergyUnit(fitsfile* fptr, const int colnum, int* const status) {
   int ii = 0;
+  int ev_conversion = 1;
   char tunit[10];
   char tunit_val[FLEN_KEYWORD];
 
@@ -108,195 +94,444 @@ static void checkEnergyUnit(fitsfile* fptr, const int colnum, int* const status)
         ev_conversion = 1000;
         SIXT_WARNING("Energy is given in eV. Background output will be in keV!");
       }
-    } else {
-      ev_conversion = 1;
     }
   } else {
-    ev_conversion = 1;
     SIXT_WARNING("Energy is unitless! Assuming it to be in keV...");
   }
+
+  return ev_conversion;
 }
 
-/* ------------------ */
+/** @internal
+ *  Allocate an event table for the given number of hits.
+ */
+static bkgEventTable* newBkgEventTable(const long numrows, int* const status) {
+  bkgEventTable* table = (bkgEventTable*) malloc(sizeof(bkgEventTable));
+  CHECK_MALLOC_RET_NULL_STATUS(table, *status);
+
+  table->numrows = numrows;
+  table->numevents = 0;
+  table->event_start = NULL;
+  table->rate = 0.;
+  table->refcount = 1;
+  table->hit_xpos = (double*) malloc(numrows * sizeof(double));
+  table->hit_ypos = (double*) malloc(numrows * sizeof(double));
+  table->hit_time = (double*) malloc(numrows * sizeof(double));
+  table->hit_energy = (double*) malloc(numrows * sizeof(double));
+  if((NULL == table->hit_xpos) || (NULL == table->hit_ypos) ||
+     (NULL == table->hit_time) || (NULL == table->hit_energy)) {
+    *status = EXIT_FAILURE;
+    SIXT_ERROR("memory allocation for background hits failed");
+  }
 
-/* external functions */
+  return table;
+}
 
-void bkgInitialize(const char* const filename,
-    const unsigned int seed,
-    int* const status) {
+/** @internal
+ *  Release the event table if it is not used by any generator anymore.
+ */
+static void releaseBkgEventTable(bkgEventTable** const table) {
+  if(NULL != *table) {
+    (*table)->refcount--;
+    if((*table)->refcount <= 0) {
+      free((*table)->hit_xpos);
+      free((*table)->hit_ypos);
+      free((*table)->hit_time);
+      free((*table)->hit_energy);
+      free((*table)->event_start);
+      free(*table);
+    }
+    *table = NULL;
+  }
+}
 
-  bkgratefct.numelements = 0L;
-  bkgratefct.time = NULL;
-  bkgratefct.rate = NULL;
-  bkgratefct.currenttime = NULL;
-  bkgratefct.currentrate = NULL;
-  bkgratefct.intervalsum = 0.;
-  bkgratefct.starttime = 0.;
-
-  bkginputdata.eventlist = NULL;
-  bkginputdata.numrows = 0L;
-  bkginputdata.interval = 0.;
-  bkginputdata.intervalsum = 0.;
-  bkginputdata.timecolname = "primaryid";
-  bkginputdata.energycolname = "edep";
-  bkginputdata.xcolname = "X";
-  bkginputdata.ycolname = "Y";
-  ftime(&time_struct);
+/** @internal
+ *  Allocate a generator for the given event table.
+ */
+static BkgGenerator* newBkgGeneratorTable(bkgEventTable* const table, int* const status) {
+  BkgGenerator* gen = (BkgGenerator*) malloc(sizeof(BkgGenerator));
+  CHECK_MALLOC_RET_NULL_STATUS(gen, *status);
+
+  gen->table = table;
+  gen->ratefct.numelements = 0L;
+  gen->ratefct.time = NULL;
+  gen->ratefct.rate = NULL;
+  gen->ratefct.currenttime = NULL;
+  gen->ratefct.currentrate = NULL;
+  gen->ratefct.intervalsum = 0.;
+  gen->ratefct.starttime = 0.;
+  gen->ratefct.currentslope = 0.;
+  gen->intervalsum = 0.;
+  gen->rcurr.numelements = 0L;
+  gen->rcurr.interval = 0.;
+  gen->rcurr.rate = NULL;
+  gen->rcurr.ratesize = 0L;
+
+  return gen;
+}
 
-  fits_open_table(&bkginputdata.inputfptr, filename, READONLY, status);
-  fits_report_error(stderr, *status);
+/** @internal
+ *  Append a normalized rate to the rates of the current interval.
+ */
+static void addCurrentRate(struct rateCurrentInterval* const rcurr, const float rate) {
+  if(rcurr->numelements >= rcurr->ratesize) {
+    long ratesize = rcurr->numelements + 50;
+    float* buffer = (float*) realloc(rcurr->rate, ratesize * sizeof(float));
+    if(NULL == buffer) {
+      SIXT_ERROR("memory allocation for background rates failed");
+      return;
+    }
+    rcurr->rate = buffer;
+    rcurr->ratesize = ratesize;
+  }
+  rcurr->rate[rcurr->numelements] = rate;
+  rcurr->numelements++;
+}
 
-  /* lead keywords describing the detector size used in the background simulations.*/
-  fits_read_key(bkginputdata.inputfptr, TDOUBLE, "SAMINX", &bkginputdata.xmin_mm, NULL, status);
-  if(*status != 0) {
-    SIXT_ERROR("SAMINX keyword not found! Cannot set rate for background data.");
-    *status = EXIT_FAILURE;
-    return;
+/** @internal
+ *  Slope of the light curve in the current bin.
+ */
+static void setRateFctSlope(backgroundRateFct* const fct) {
+  if(fct->currenttime < &fct->time[fct->numelements - 1]) {
+    fct->currentslope = (*(fct->currentrate + 1) - *fct->currentrate) /
+                        (*(fct->currenttime + 1) - *fct->currenttime);
   }
-  fits_read_key(bkginputdata.inputfptr, TDOUBLE, "SAMAXX", &bkginputdata.xmax_mm, NULL, status);
-  if(*status != 0) {
-    SIXT_ERROR("SAMAXX keyword not found! Cannot set rate for background data.");
-    *status = EXIT_FAILURE;
-    return;
+}
+
+/** @internal
+ *  Determine the background rate of the generator over a certain time
+ *  interval. All data will be normalized to the respective length
+ *  fraction of the interval as the rate output is multiplied later
+ *  with the total number of events directly.
+ */
+static void getBkgGeneratorRates(BkgGenerator* const gen, double interval) {
+  backgroundRateFct* const fct = &gen->ratefct;
+  struct rateCurrentInterval* const rcurr = &gen->rcurr;
+  double startfraction = 0.;
+  double endfraction = 0.;
+  double fullinterval = interval;
+
+  // The rate array is reused for all intervals.
+  rcurr->numelements = 0L;
+  rcurr->interval = interval;
+
+  // calculate current lightcurve slope to be used for interpolation
+  setRateFctSlope(fct);
+
+  // check if we've reached the beginning of the lightcurve so far
+  if(gen->intervalsum < fct->starttime) {
+    // if yes we assume the interval fraction in front of the lightcurve as rate 1 and process the rest.
+    if((gen->intervalsum + interval) >= fct->starttime) {
+      addCurrentRate(rcurr, (fct->starttime - gen->intervalsum) / fullinterval);
+      interval -= (fct->starttime - gen->intervalsum);
+      gen->intervalsum = fct->starttime;
+    } else {
+      // if not we assume rate 1 and return.
+      addCurrentRate(rcurr, 1);
+      gen->intervalsum += interval;
+      return;
+    }
   }
-  fits_read_key(bkginputdata.inputfptr, TDOUBLE, "SAMINY", &bkginputdata.ymin_mm, NULL, status);
-  if(*status != 0) {
-    SIXT_ERROR("SAMINY keyword not found! Cannot set rate for background data.");
-    *status = EXIT_FAILURE;
-    return;
+
+  // Add interpolated lightcurve data points to rate array until we've covered the interval.
+  while((gen->intervalsum >= fct->starttime) &&
+        (interval > 0) &&
+        (fct->currenttime < &fct->time[fct->numelements - 1])) {
+    startfraction = fct->time[0] + fct->intervalsum - *fct->currenttime;
+    endfraction = *(fct->currenttime + 1) - (fct->time[0] + fct->intervalsum);
+    interval -= endfraction;
+    fct->intervalsum += endfraction;
+    gen->intervalsum += endfraction;
+
+    // if the interval is larger than the current bin we jump to the next and update the slope
+    float rate;
+    if(interval > 0) {
+      rate = 0.5 * ((*fct->currentrate + fct->currentslope * startfraction) +
+                    *(fct->currentrate + 1));
+      rate *= endfraction / fullinterval;
+      fct->currentrate++;
+      fct->currenttime++;
+      setRateFctSlope(fct);
+    } else {
+      rate = 0.5 * ((*fct->currentrate + fct->currentslope * startfraction) +
+                    *(fct->currentrate + 1) + fct->currentslope * interval);
+      rate *= (*(fct->currenttime + 1) - (*fct->currenttime + startfraction) + interval) / fullinterval;
+    }
+    addCurrentRate(rcurr, rate);
   }
-  fits_read_key(bkginputdata.inputfptr, TDOUBLE, "SAMAXY", &bkginputdata.ymax_mm, NULL, status);
-  if(*status != 0) {
-    SIXT_ERROR("SAMAXY keyword not found! Cannot set rate for background data.");
-    *status = EXIT_FAILURE;
+
+  // if we hit the end of the last bin we increase the pointers and recalculate the slope
+  if(interval == 0) {
+    if(fct->currenttime < &fct->time[fct->numelements - 1]) {
+      fct->currentrate++;
+      fct->currenttime++;
+      setRateFctSlope(fct);
+    }
+  } else {
+    fct->intervalsum += interval;
+    gen->intervalsum += interval;
+  }
+
+  // if we are at the EOF but still have some interval left we set the rate to 1.
+  if((interval > 0) && (fct->currenttime >= &fct->time[fct->numelements - 1])) {
+    addCurrentRate(rcurr, interval / fullinterval);
+  }
+}
+
+/** @internal
+ *  Make sure that the hit arrays of the list can hold at least the
+ *  given number of hits.
+ */
+static void reserveBkgOutput(backgroundOutput* const list, const int numhits, int* const status) {
+  if(numhits <= list->arraysize) {
     return;
   }
-  bkginputdata.area_sqcm=(bkginputdata.xmax_mm-bkginputdata.xmin_mm)*(bkginputdata.ymax_mm-bkginputdata.ymin_mm)/100.;
 
-  /* If the rate has not been set explicitly, we use the value from the header keyword. */
-  if(rate_initialized == 0) {
-    fits_read_key(bkginputdata.inputfptr, TDOUBLE, "RATE", &bkginputdata.aux.rate, NULL, status);
+  int arraysize = 2 * list->arraysize;
+  if(arraysize < numhits) {
+    arraysize = numhits;
+  }
+  double** arrays[4] = {&list->hit_xpos, &list->hit_ypos, &list->hit_time, &list->hit_energy};
+  int ii;
+  for(ii = 0; ii < 4; ii++) {
+    double* buffer = (double*) realloc(*arrays[ii], arraysize * sizeof(double));
+    CHECK_MALLOC_VOID_STATUS(buffer, *status);
+    *arrays[ii] = buffer;
+  }
+  list->arraysize = arraysize;
+}
+
+/* ------------------ */
+
+/* external functions */
+
+BkgGenerator* newBkgGenerator(const char* const filename,
+    const double rate,
+    int* const status) {
+
+  fitsfile* fptr = NULL;
+  bkgEventTable* table = NULL;
+  BkgGenerator* gen = NULL;
+
+  do { // Beginning of ERROR handling loop.
+
+    fits_open_table(&fptr, filename, READONLY, status);
     if(*status != 0) {
-      SIXT_ERROR("RATE keyword not found! Cannot set rate for background data.");
+      fits_report_error(stderr, *status);
+      char msg[MAXMSG];
+      sprintf(msg, "could not open background file '%s'", filename);
+      SIXT_ERROR(msg);
+      break;
+    }
+
+    /* lead keywords describing the detector size used in the background simulations.*/
+    double xmin_mm, xmax_mm, ymin_mm, ymax_mm;
+    fits_read_key(fptr, TDOUBLE, "SAMINX", &xmin_mm, NULL, status);
+    if(*status != 0) {
+      SIXT_ERROR("SAMINX keyword not found! Cannot set rate for background data.");
       *status = EXIT_FAILURE;
-      return;
+      break;
     }
-  }
-  bkginputdata.aux.rate=bkginputdata.aux.rate*bkginputdata.area_sqcm;
-
-  fits_get_num_rows(bkginputdata.inputfptr, &bkginputdata.numrows, status);
-  fits_report_error(stderr, *status);
-
-  bkginputdata.hit_xpos = (double*) malloc(bkginputdata.numrows * sizeof(double));
-  bkginputdata.hit_ypos = (double*) malloc(bkginputdata.numrows * sizeof(double));
-  bkginputdata.hit_time = (double*) malloc(bkginputdata.numrows * sizeof(double));
-  bkginputdata.hit_energy = (double*) malloc(bkginputdata.numrows * sizeof(double));
-
-  fits_get_colnum(bkginputdata.inputfptr, CASEINSEN, bkginputdata.timecolname, &bkginputdata.timecolnum, status);
-  fits_get_colnum(bkginputdata.inputfptr, CASEINSEN, bkginputdata.xcolname, &bkginputdata.xcolnum, status);
-  fits_get_colnum(bkginputdata.inputfptr, CASEINSEN, bkginputdata.ycolname, &bkginputdata.ycolnum, status);
-  fits_get_colnum(bkginputdata.inputfptr, CASEINSEN, bkginputdata.energycolname, &bkginputdata.energycolnum, status);
-  fits_report_error(stderr, *status);
-
-  fits_read_col(bkginputdata.inputfptr, TDOUBLE, bkginputdata.timecolnum, 1L, 1L, bkginputdata.numrows, 0, bkginputdata.hit_time, NULL, status);
-  fits_read_col(bkginputdata.inputfptr, TDOUBLE, bkginputdata.xcolnum, 1L, 1L, bkginputdata.numrows, 0, bkginputdata.hit_xpos, NULL, status);
-  fits_read_col(bkginputdata.inputfptr, TDOUBLE, bkginputdata.ycolnum, 1L, 1L, bkginputdata.numrows, 0, bkginputdata.hit_ypos, NULL, status);
-  fits_read_col(bkginputdata.inputfptr, TDOUBLE, bkginputdata.energycolnum, 1L, 1L, bkginputdata.numrows, 0, bkginputdata.hit_energy, NULL, status);
-  fits_report_error(stderr, *status);
-
-  /* Convert the input energy to keV if necessary. */
-  checkEnergyUnit(bkginputdata.inputfptr, bkginputdata.energycolnum, status);
-  int ii = 0;
-  if(ev_conversion != 1) {
-    for(ii = 0; ii < bkginputdata.numrows; ii++) {
-      bkginputdata.hit_energy[ii] /= ev_conversion;
+    fits_read_key(fptr, TDOUBLE, "SAMAXX", &xmax_mm, NULL, status);
+    if(*status != 0) {
+      SIXT_ERROR("SAMAXX keyword not found! Cannot set rate for background data.");
+      *status = EXIT_FAILURE;
+      break;
+    }
+    fits_read_key(fptr, TDOUBLE, "SAMINY", &ymin_mm, NULL, status);
+    if(*status != 0) {
+      SIXT_ERROR("SAMINY keyword not found! Cannot set rate for background data.");
+      *status = EXIT_FAILURE;
+      break;
+    }
+    fits_read_key(fptr, TDOUBLE, "SAMAXY", &ymax_mm, NULL, status);
+    if(*status != 0) {
+      SIXT_ERROR("SAMAXY keyword not found! Cannot set rate for background data.");
+      *status = EXIT_FAILURE;
+      break;
+    }
+    double area_sqcm = (xmax_mm - xmin_mm) * (ymax_mm - ymin_mm) / 100.;
+
+    /* If the rate has not been set explicitly, we use the value from the header keyword. */
+    double eventrate = rate;
+    if(eventrate <= 0.) {
+      fits_read_key(fptr, TDOUBLE, "RATE", &eventrate, NULL, status);
+      if(*status != 0) {
+        SIXT_ERROR("RATE keyword not found! Cannot set rate for background data.");
+        *status = EXIT_FAILURE;
+        break;
+      }
     }
-  }
 
-  bkginputdata.numevents = calcEvents(bkginputdata.hit_time, bkginputdata.numrows);
-  bkginputdata.eventlist = (size_t*) calloc(bkginputdata.numevents, sizeof(size_t));
-  fillEventList(bkginputdata.hit_time, bkginputdata.numrows, bkginputdata.eventlist);
+    long numrows = 0;
+    fits_get_num_rows(fptr, &numrows, status);
+    fits_report_error(stderr, *status);
+    CHECK_STATUS_BREAK(*status);
+
+    table = newBkgEventTable(numrows, status);
+    CHECK_STATUS_BREAK(*status);
+    table->rate = eventrate * area_sqcm;
+
+    int timecolnum, energycolnum, xcolnum, ycolnum;
+    fits_get_colnum(fptr, CASEINSEN, "primaryid", &timecolnum, status);
+    fits_get_colnum(fptr, CASEINSEN, "X", &xcolnum, status);
+    fits_get_colnum(fptr, CASEINSEN, "Y", &ycolnum, status);
+    fits_get_colnum(fptr, CASEINSEN, "edep", &energycolnum, status);
+    fits_report_error(stderr, *status);
+    CHECK_STATUS_BREAK(*status);
+
+    fits_read_col(fptr, TDOUBLE, timecolnum, 1L, 1L, numrows, 0, table->hit_time, NULL, status);
+    fits_read_col(fptr, TDOUBLE, xcolnum, 1L, 1L, numrows, 0, table->hit_xpos, NULL, status);
+    fits_read_col(fptr, TDOUBLE, ycolnum, 1L, 1L, numrows, 0, table->hit_ypos, NULL, status);
+    fits_read_col(fptr, TDOUBLE, energycolnum, 1L, 1L, numrows, 0, table->hit_energy, NULL, status);
+    fits_report_error(stderr, *status);
+    CHECK_STATUS_BREAK(*status);
+
+    /* Convert the input energy to keV if necessary. */
+    int ev_conversion = checkEnergyUnit(fptr, energycolnum, status);
+    CHECK_STATUS_BREAK(*status);
+    long ii;
+    if(ev_conversion != 1) {
+      for(ii = 0; ii < numrows; ii++) {
+        table->hit_energy[ii] /= ev_conversion;
+      }
+    }
 
-  bkginputdata.randgen = gsl_rng_alloc(gsl_rng_ranlux);
-  gsl_rng_set(bkginputdata.randgen, seed);
+    fillEventList(table, status);
+    CHECK_STATUS_BREAK(*status);
+
+    gen = newBkgGeneratorTable(table, status);
+    CHECK_STATUS_BREAK(*status);
+    table = NULL;
+
+  } while(0); // END of error handling loop.
+
+  if(NULL != fptr) {
+    int status2 = EXIT_SUCCESS;
+    fits_close_file(fptr, &status2);
+  }
+  releaseBkgEventTable(&table);
+
+  return gen;
 }
 
-void bkgInitializeAux(const char* const filename,
-    const unsigned int seed,
-    bkgAux* bkgaux,
+BkgGenerator* newBkgGeneratorHits(const long numrows,
+    const double* const hit_xpos,
+    const double* const hit_ypos,
+    const double* const hit_time,
+    const double* const hit_energy,
+    const double rate,
     int* const status) {
 
-  if(bkgaux != NULL) {
-    if(bkgaux->rate>0.){
-      bkginputdata.aux.rate = bkgaux->rate;
-      rate_initialized = 1;
-    }
-    bkgInitialize(filename, seed, status);
-  } else {
-    SIXT_ERROR("Invalid auxiliary information provided for init of background module!");
+  if(numrows <= 0) {
+    *status = EXIT_FAILURE;
+    SIXT_ERROR("no hits given for the background generator");
+    return NULL;
   }
-}
 
-/* Free passed background structure. */
-void bkgFree(backgroundOutput* struct_to_free) {
-	if(struct_to_free->numhits != 0) {
-		free(struct_to_free->hit_xpos);
-		free(struct_to_free->hit_ypos);
-		free(struct_to_free->hit_time);
-		free(struct_to_free->hit_energy);
-	}
-  free(struct_to_free);
+  bkgEventTable* table = newBkgEventTable(numrows, status);
+  if(EXIT_SUCCESS != *status) {
+    releaseBkgEventTable(&table);
+    return NULL;
+  }
+  memcpy(table->hit_xpos, hit_xpos, numrows * sizeof(double));
+  memcpy(table->hit_ypos, hit_ypos, numrows * sizeof(double));
+  memcpy(table->hit_time, hit_time, numrows * sizeof(double));
+  memcpy(table->hit_energy, hit_energy, numrows * sizeof(double));
+  table->rate = rate;
+
+  fillEventList(table, status);
+  BkgGenerator* gen = NULL;
+  if(EXIT_SUCCESS == *status) {
+    gen = newBkgGeneratorTable(table, status);
+  }
+  if(NULL == gen) {
+    releaseBkgEventTable(&table);
+  }
+
+  return gen;
 }
 
-/* Clean up everything and close background file. */
-void bkgCleanUp(int* const status) {
-	fits_close_file(bkginputdata.inputfptr, status);
-	fits_report_error(stderr, *status);
-	bkginputdata.inputfptr = NULL;
+BkgGenerator* cloneBkgGenerator(const BkgGenerator* const gen,
+    int* const status) {
 
-	gsl_rng_free(bkginputdata.randgen);
+  BkgGenerator* clone = newBkgGeneratorTable(gen->table, status);
+  CHECK_STATUS_RET(*status, clone);
+  gen->table->refcount++;
+
+  // Copy the light curve, which is traversed independently by the clone.
+  if(gen->ratefct.numelements > 0) {
+    long numelements = gen->ratefct.numelements;
+    clone->ratefct = gen->ratefct;
+    clone->ratefct.time = (double*) malloc(numelements * sizeof(double));
+    clone->ratefct.rate = (float*) malloc(numelements * sizeof(float));
+    if((NULL == clone->ratefct.time) || (NULL == clone->ratefct.rate)) {
+      *status = EXIT_FAILURE;
+      SIXT_ERROR("memory allocation for background light curve failed");
+      destroyBkgGenerator(&clone);
+      return NULL;
+    }
+    memcpy(clone->ratefct.time, gen->ratefct.time, numelements * sizeof(double));
+    memcpy(clone->ratefct.rate, gen->ratefct.rate, numelements * sizeof(float));
+    clone->ratefct.currenttime = clone->ratefct.time + (gen->ratefct.currenttime - gen->ratefct.time);
+    clone->ratefct.currentrate = clone->ratefct.rate + (gen->ratefct.currentrate - gen->ratefct.rate);
+  }
+  clone->intervalsum = gen->intervalsum;
 
-	free(bkginputdata.hit_xpos);
-	free(bkginputdata.hit_ypos);
-	free(bkginputdata.hit_time);
-	free(bkginputdata.hit_energy);
+  return clone;
+}
+
+void destroyBkgGenerator(BkgGenerator** const gen) {
+  if(NULL != *gen) {
+    releaseBkgEventTable(&(*gen)->table);
+    free((*gen)->ratefct.time);
+    free((*gen)->ratefct.rate);
+    free((*gen)->rcurr.rate);
+    free(*gen);
+    *gen = NULL;
+  }
 }
 
 /* Optional: use a Simput light curve to manipulate the background rate over time. */
-void bkgSetRateFct(const char* const filename, int* const status) {
+void setBkgGeneratorRateFct(BkgGenerator* const gen,
+    const char* const filename,
+    int* const status) {
   SimputLC *rate_lc = NULL;
+  backgroundRateFct* const fct = &gen->ratefct;
 
   if(filename != NULL) {
     rate_lc = loadSimputLC(filename, status);
+    CHECK_STATUS_VOID(*status);
 
     // Make sure that the light curve is given as a function of time.
     // Periodic light curves cannot be processed here.
     if (rate_lc->time == NULL) {
       SIXT_ERROR("Light curve for background variation does not contain TIME column");
       *status = EXIT_FAILURE;
+      freeSimputLC(&rate_lc);
       return;
     }
 
-    bkgratefct.numelements = rate_lc->nentries;
-    bkgratefct.starttime = rate_lc->timezero;
-    if(bkgratefct.time != NULL) {
-      free(bkgratefct.time);
-      bkgratefct.time = NULL;
-    }
-    bkgratefct.time = (double*) malloc(rate_lc->nentries * sizeof(double));
-    memcpy(bkgratefct.time, rate_lc->time, rate_lc->nentries * sizeof(double));
-
-    if(bkgratefct.rate != NULL) {
-      free(bkgratefct.rate);
-      bkgratefct.rate = NULL;
+    fct->numelements = rate_lc->nentries;
+    fct->starttime = rate_lc->timezero;
+    free(fct->time);
+    fct->time = (double*) malloc(rate_lc->nentries * sizeof(double));
+    free(fct->rate);
+    fct->rate = (float*) malloc(rate_lc->nentries * sizeof(float));
+    if((NULL == fct->time) || (NULL == fct->rate)) {
+      SIXT_ERROR("memory allocation for background light curve failed");
+      *status = EXIT_FAILURE;
+      fct->numelements = 0;
+      freeSimputLC(&rate_lc);
+      return;
     }
-    bkgratefct.rate = (float*) malloc(rate_lc->nentries * sizeof(float));
-    memcpy(bkgratefct.rate, rate_lc->flux, rate_lc->nentries * sizeof(float));
+    memcpy(fct->time, rate_lc->time, rate_lc->nentries * sizeof(double));
+    memcpy(fct->rate, rate_lc->flux, rate_lc->nentries * sizeof(float));
 
-    bkgratefct.currenttime = bkgratefct.time;
-    bkgratefct.currentrate = bkgratefct.rate;
-    bkgratefct.currentslope = 0;
-    bkgratefct.intervalsum = 0;
+    fct->currenttime = fct->time;
+    fct->currentrate = fct->rate;
+    fct->currentslope = 0;
+    fct->intervalsum = 0;
 
     freeSimputLC(&rate_lc);
   } else {
@@ -306,192 +541,153 @@ void bkgSetRateFct(const char* const filename, int* const status) {
   }
 }
 
-/* Determine the background rate over a certain time interval. */
-void bkgGetRate(double interval) {
-  double startfraction = 0.;
-  double endfraction = 0.;
-  double fullinterval = interval;
+backgroundOutput* newBkgOutput(int* const status) {
+  backgroundOutput* list = (backgroundOutput*) malloc(sizeof(backgroundOutput));
+  CHECK_MALLOC_RET_NULL_STATUS(list, *status);
 
-  // free rate structure if it contains data from recent calculations
-  if(rCurr.rate != NULL) {
-    free(rCurr.rate);
-    rCurr.rate = NULL;
-    rCurr.numelements = 0L;
-  }
-  rCurr.ratesize = 10L;
-  rCurr.rate = (float*) malloc(rCurr.ratesize * sizeof(float));
+  list->numevents = 0;
+  list->numhits = 0;
+  list->hit_xpos = NULL;
+  list->hit_ypos = NULL;
+  list->hit_time = NULL;
+  list->hit_energy = NULL;
+  list->arraysize = 0;
 
-  // calculate current lightcurve slope to be used for interpolation
-  bkgratefct.currentslope = (*(bkgratefct.currentrate + 1) - *bkgratefct.currentrate) /
-                            (*(bkgratefct.currenttime + 1) - *bkgratefct.currenttime);
+  return list;
+}
 
+/* Fills the list with a random (poisson) number of background events
+ * for the requested interval. A flat random distribution decides, which
+ * events from the table will be returned in the end.
+ */
+void getBkgGeneratorList(BkgGenerator* const gen,
+    gsl_rng* const rng,
+    const double interval,
+    backgroundOutput* const list,
+    int* const status) {
 
-  // check if we've reached the beginning of the lightcurve so far
-  if(bkginputdata.intervalsum < bkgratefct.starttime) {
-    // if yes we assume the interval fraction in front of the lightcurve as rate 1 and process the rest.
-    if((bkginputdata.intervalsum + interval) >= bkgratefct.starttime) {
-      rCurr.rate[rCurr.numelements] = (bkgratefct.starttime - bkginputdata.intervalsum) / fullinterval;
-      rCurr.numelements++;
-      interval -= (bkgratefct.starttime - bkginputdata.intervalsum);
-      bkginputdata.intervalsum = bkgratefct.starttime;
-    } else {
-      // if not we assume rate 1 and return.
-      rCurr.rate[rCurr.numelements] = 1;
-      rCurr.numelements++;
-      bkginputdata.intervalsum += interval;
-      interval = 0;
-      return;
+  int cc = 0;
+  list->numevents = 0;
+  list->numhits = 0;
+
+  // If the requested interval is valid we calculate the average number of events for this interval length.
+  if(interval <= 0) {
+    SIXT_ERROR("Invalid interval for background generation specified!");
+    *status = EXIT_FAILURE;
+    return;
+  }
+  const bkgEventTable* const table = gen->table;
+  double eventsperinterval = table->rate * interval;
+
+  // If we use a rate function we multiply the output poisson events by the normalized rate(s) for this interval.
+  // Otherwise we just take the unchanged result of the poisson random function.
+  if(gen->ratefct.numelements == 0) {
+    list->numevents = gsl_ran_poisson(rng, eventsperinterval);
+    gen->intervalsum += interval;
+  } else {
+    getBkgGeneratorRates(gen, interval);
+    for(cc = 0; cc < gen->rcurr.numelements; cc++) {
+      list->numevents += gsl_ran_poisson(rng, eventsperinterval * gen->rcurr.rate[cc]);
     }
   }
 
-  // Add interpolated lightcurve data points to rate array until we've covered the interval.
-  // All data will be normalized to the respective length fraction of the interval as the
-  // rate output is multiplied later with the total number of events directly.
-  while((bkginputdata.intervalsum >= bkgratefct.starttime) &&
-        (interval > 0) &&
-        (bkgratefct.currenttime < &bkgratefct.time[bkgratefct.numelements - 1])) {
-    startfraction = bkgratefct.time[0] + bkgratefct.intervalsum - *bkgratefct.currenttime;
-    endfraction = *(bkgratefct.currenttime + 1) - (bkgratefct.time[0] + bkgratefct.intervalsum);
-    interval -= endfraction;
-    bkgratefct.intervalsum += endfraction;
-    bkginputdata.intervalsum += endfraction;
+  // Copy the hits of the chosen events (an event together with its
+  // secondary interactions) to the list.
+  for(cc = 0; cc < list->numevents; cc++) {
+    long event = (long)floor((table->numevents - 1) * gsl_ran_flat(rng, 0, 1));
+    long first = table->event_start[event];
+    int numhits = (int)(table->event_start[event + 1] - first);
+
+    reserveBkgOutput(list, list->numhits + numhits, status);
+    CHECK_STATUS_VOID(*status);
+    memcpy(&list->hit_xpos[list->numhits], &table->hit_xpos[first], numhits * sizeof(double));
+    memcpy(&list->hit_ypos[list->numhits], &table->hit_ypos[first], numhits * sizeof(double));
+    memcpy(&list->hit_time[list->numhits], &table->hit_time[first], numhits * sizeof(double));
+    memcpy(&list->hit_energy[list->numhits], &table->hit_energy[first], numhits * sizeof(double));
+    list->numhits += numhits;
+  }
+}
 
-    // if the interval is larger than the current bin we jump to the next and update the slope
-    if(interval > 0) {
-      rCurr.rate[rCurr.numelements] = 0.5 *
-                                      ((*bkgratefct.currentrate + bkgratefct.currentslope * startfraction) +
-                                      *(bkgratefct.currentrate + 1));
-      rCurr.rate[rCurr.numelements] *= endfraction / fullinterval;
-      bkgratefct.currentrate++;
-      bkgratefct.currenttime++;
-      bkgratefct.currentslope = (*(bkgratefct.currentrate + 1) - *bkgratefct.currentrate) /
-                                (*(bkgratefct.currenttime + 1) - *bkgratefct.currenttime);
-    } else {
-      rCurr.rate[rCurr.numelements] = 0.5 *
-                                      ((*bkgratefct.currentrate + bkgratefct.currentslope * startfraction) +
-                                      *(bkgratefct.currentrate + 1) + bkgratefct.currentslope * interval);
-      rCurr.rate[rCurr.numelements] *= (*(bkgratefct.currenttime + 1) - (*bkgratefct.currenttime + startfraction) + interval) / fullinterval;
-    }
-    rCurr.numelements++;
+/* Module-level interface, using a single generator. */
 
-    // resize rate array if its maximum size has been reached
-    if(rCurr.numelements >= rCurr.ratesize) {
-      rCurr.rate = (float*) realloc(rCurr.rate, (rCurr.numelements + 50) * sizeof(float));
-      rCurr.ratesize = rCurr.numelements + 50;
-    }
+void bkgInitialize(const char* const filename,
+    const unsigned int seed,
+    int* const status) {
+
+  ftime(&time_struct);
+
+  destroyBkgGenerator(&bkggen);
+  bkggen = newBkgGenerator(filename, (rate_initialized == 1) ? aux_rate : 0., status);
+  CHECK_STATUS_VOID(*status);
+
+  if(NULL != bkgrng) {
+    gsl_rng_free(bkgrng);
   }
+  bkgrng = gsl_rng_alloc(gsl_rng_ranlux);
+  gsl_rng_set(bkgrng, seed);
+}
 
-  // if we hit the end of the last bin we increase the pointers and recalculate the slope
-  if(interval == 0) {
-    bkgratefct.currentrate++;
-    bkgratefct.currenttime++;
-    bkgratefct.currentslope = (*(bkgratefct.currentrate + 1) - *bkgratefct.currentrate) /
-                              (*(bkgratefct.currenttime + 1) - *bkgratefct.currenttime);
+void bkgInitializeAux(const char* const filename,
+    const unsigned int seed,
+    bkgAux* bkgaux,
+    int* const status) {
+
+  if(bkgaux != NULL) {
+    if(bkgaux->rate>0.){
+      aux_rate = bkgaux->rate;
+      rate_initialized = 1;
+    }
+    bkgInitialize(filename, seed, status);
   } else {
-    bkgratefct.intervalsum += interval;
-    bkginputdata.intervalsum += interval;
+    SIXT_ERROR("Invalid auxiliary information provided for init of background module!");
   }
+}
 
-  // re-adjust size of rate array to actual size and remove trailing free space */
-  rCurr.ratesize = rCurr.numelements + 1;
-  rCurr.rate = (float*) realloc(rCurr.rate, rCurr.ratesize * sizeof(float));
+/* Free passed background structure. */
+void bkgFree(backgroundOutput* struct_to_free) {
+  if(NULL == struct_to_free) {
+    return;
+  }
+  free(struct_to_free->hit_xpos);
+  free(struct_to_free->hit_ypos);
+  free(struct_to_free->hit_time);
+  free(struct_to_free->hit_energy);
+  free(struct_to_free);
+}
 
-  // if we are at the EOF but still have some interval left we set the rate to 1.
-  if((interval > 0) && (bkgratefct.currenttime >= &bkgratefct.time[bkgratefct.numelements - 1])) {
-    rCurr.numelements++;
-    rCurr.rate[rCurr.ratesize - 1] = interval / fullinterval;
+/* Clean up everything and close background file. */
+void bkgCleanUp(int* const status) {
+  (void)status;
+
+  destroyBkgGenerator(&bkggen);
+  if(NULL != bkgrng) {
+    gsl_rng_free(bkgrng);
+    bkgrng = NULL;
   }
 }
 
+/* Optional: use a Simput light curve to manipulate the background rate over time. */
+void bkgSetRateFct(const char* const filename, int* const status) {
+  if(NULL == bkggen) {
+    SIXT_WARNING("background module not initialized, light curve is ignored");
+    return;
+  }
+  setBkgGeneratorRateFct(bkggen, filename, status);
+}
+
 /* Returns a background structure with a random (poisson) number of background events
  * for the requested interval. A flat random distribution decides, which events from
  * the file will be returned in the end.
  */
 backgroundOutput* bkgGetBackgroundList(double interval) {
-  int cc = 0;
-	backgroundOutput* bkgresultlist = NULL;
-  bkgresultlist = (backgroundOutput*) realloc(bkgresultlist, sizeof(backgroundOutput));
-  bkgresultlist->numevents = 0;
-  bkgresultlist->numhits = 0;
+  int status = EXIT_SUCCESS;
+  backgroundOutput* bkgresultlist = newBkgOutput(&status);
+  CHECK_STATUS_RET(status, NULL);
 
-  // If the requested interval is valid we calculate the average number of events for this interval length.
-  if(interval > 0) {
-    bkginputdata.interval = interval;
-    bkginputdata.eventsperinterval = calcEventRate(bkginputdata.interval);
-  } else {
-    SIXT_ERROR("Invalid interval for background generation specified!");
-    free(bkgresultlist);
+  getBkgGeneratorList(bkggen, bkgrng, interval, bkgresultlist, &status);
+  if(EXIT_SUCCESS != status) {
+    bkgFree(bkgresultlist);
     bkgresultlist = NULL;
-    return bkgresultlist;
-  }
-
-  // If we use a rate function we multiply the output poisson events by the normalized rate(s) for this interval.
-  // Otherwise we just take the unchanged result of the poisson random function.
-  if(bkgratefct.numelements == 0) {
-    bkgresultlist->numevents = gsl_ran_poisson(bkginputdata.randgen, bkginputdata.eventsperinterval);
-    bkginputdata.intervalsum += interval;
-  } else {
-    bkgGetRate(interval);
-    for(cc = 0; cc < rCurr.numelements; cc++) {
-      bkgresultlist->numevents += gsl_ran_poisson(bkginputdata.randgen, bkginputdata.eventsperinterval * rCurr.rate[cc]);
-    }
-  }
-
-  bkgresultlist->numhits = 0;
-  if(bkgresultlist->numevents > 0) {
-    int rand = 0, hitcnt = 0, arrsize = bkgresultlist->numevents;
-    bkgresultlist->hit_energy = (double*) malloc(arrsize * sizeof(double));
-    bkgresultlist->hit_time = (double*) malloc(arrsize * sizeof(double));
-    bkgresultlist->hit_xpos = (double*) malloc(arrsize * sizeof(double));
-    bkgresultlist->hit_ypos = (double*) malloc(arrsize * sizeof(double));
-
-    for(cc = 0; cc < bkgresultlist->numevents; cc++) {
-      rand = (int)floor((bkginputdata.numevents - 1) * gsl_ran_flat(bkginputdata.randgen, 0, 1));
-      /* Do this until we reach the next "real" event and add subevents to the list. Count their number with numhits. */
-      do {
-        bkgresultlist->hit_energy[bkgresultlist->numhits] = bkginputdata.hit_energy[bkginputdata.eventlist[rand] + hitcnt];
-        bkgresultlist->hit_time[bkgresultlist->numhits] = bkginputdata.hit_time[bkginputdata.eventlist[rand] + hitcnt];
-        bkgresultlist->hit_xpos[bkgresultlist->numhits] = bkginputdata.hit_xpos[bkginputdata.eventlist[rand] + hitcnt];
-        bkgresultlist->hit_ypos[bkgresultlist->numhits] = bkginputdata.hit_ypos[bkginputdata.eventlist[rand] + hitcnt];
-        bkgresultlist->numhits++;
-
-        /* Check if we are currently inside a subevent (i.e. the next "event" in the list belongs to the same event -> same time).
-         * If yes, set hitcnt to something != 0
-         */
-        if(&bkginputdata.hit_time[bkginputdata.eventlist[rand] + hitcnt] != &bkginputdata.hit_time[bkginputdata.numrows - 1]) {
-          if(bkginputdata.hit_time[bkginputdata.eventlist[rand] + hitcnt + 1] != bkginputdata.hit_time[bkginputdata.eventlist[rand] + hitcnt]) {
-            hitcnt = 0;
-          } else {
-            hitcnt++;
-          }
-        } else {
-          hitcnt = 0;
-        }
-        if(bkgresultlist->numhits == arrsize) {
-          arrsize += 50;
-          bkgresultlist->hit_energy = (double*) realloc(bkgresultlist->hit_energy, arrsize * sizeof(double));
-          bkgresultlist->hit_time = (double*) realloc(bkgresultlist->hit_time, arrsize * sizeof(double));
-          bkgresultlist->hit_xpos = (double*) realloc(bkgresultlist->hit_xpos, arrsize * sizeof(double));
-          bkgresultlist->hit_ypos = (double*) realloc(bkgresultlist->hit_ypos, arrsize * sizeof(double));
-        }
-      } while(hitcnt > 0);
-    }
-
-    if(bkgresultlist->numhits < arrsize) {
-    	if(bkgresultlist->numhits == 0) {
-    		arrsize = 0;
-    		free(bkgresultlist->hit_energy);
-    		free(bkgresultlist->hit_time);
-    		free(bkgresultlist->hit_xpos);
-    		free(bkgresultlist->hit_ypos);
-    	} else {
-				arrsize = bkgresultlist->numhits;
-				bkgresultlist->hit_energy = (double*) realloc(bkgresultlist->hit_energy, arrsize * sizeof(double));
-				bkgresultlist->hit_time = (double*) realloc(bkgresultlist->hit_time, arrsize * sizeof(double));
-				bkgresultlist->hit_xpos = (double*) realloc(bkgresultlist->hit_xpos, arrsize * sizeof(double));
-				bkgresultlist->hit_ypos = (double*) realloc(bkgresultlist->hit_ypos, arrsize * sizeof(double));
-    	}
-    }
   }
 
   return bkgresultlist;
@@ -523,12 +719,6 @@ void eroBkgSetRateFct(const char* const filename, int* const status) {
   bkgSetRateFct(filename, status);
 }
 
-void eroBkgGetRate(double interval) {
-  SIXT_DEPRECATED("eroBkgGetRate", "bkgGetRate");
-
-  bkgGetRate(interval);
-}
-
 eroBackgroundOutput* eroBkgGetBackgroundList(double interval) {
   SIXT_DEPRECATED("eroBkgGetBackgroundList", "bkgGetBackgroundList");
 
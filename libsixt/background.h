@@ -93,6 +93,8 @@ typedef struct backgroundOutput {
   double *hit_ypos;
   double *hit_time;
   double *hit_energy;  // is required to be in keV or eV.
+
+  int arraysize;       // allocated length of the hit arrays
 } backgroundOutput;
 
 /** Information extracted from a lightcurve which allows to modify
@@ -118,6 +120,97 @@ struct rateCurrentInterval {
   long ratesize;
 };
 
+/** Hits of the background simulation file together with the index
+ *  of the hits belonging to each event (i.e. an event together with
+ *  its secondary interactions, which have the same time stamp).
+ *  The table is only read after its initialization and is shared
+ *  between the generators cloned from the same generator. */
+typedef struct bkgEventTable {
+  long numrows;
+  double *hit_xpos;
+  double *hit_ypos;
+  double *hit_time;
+  double *hit_energy;  // [keV]
+
+  /** Number of events and index of their first hits. The hits of
+   *  event ii are hit_*[event_start[ii]..event_start[ii+1]-1]. */
+  long numevents;
+  long *event_start;
+
+  /** Mean number of events per second. */
+  double rate;
+
+  /** Number of generators using the table. */
+  int refcount;
+} bkgEventTable;
+
+/** Background generator. Contains the complete state of the
+ *  background generation, such that several generators (e.g. one
+ *  per camera or per thread) can be used at the same time. The
+ *  random numbers are drawn from the generator given by the caller. */
+typedef struct BkgGenerator {
+  bkgEventTable *table;
+
+  /** Optional light curve modifying the background rate over time
+   *  (numelements==0 if not used). */
+  backgroundRateFct ratefct;
+
+  /** Time covered by the intervals generated so far [s]. */
+  double intervalsum;
+
+  /** Normalized rates of the current interval. */
+  struct rateCurrentInterval rcurr;
+} BkgGenerator;
+
+/** Constructor of a background generator, which loads the hits from
+ *  the given background simulation file. If rate is greater than 0,
+ *  it is used as event rate [1/s/cm^2] instead of the RATE keyword. */
+BkgGenerator* newBkgGenerator(const char* const filename,
+    const double rate,
+    int* const status);
+
+/** Constructor of a background generator from the given hits (the
+ *  arrays are copied). The rate is given as the mean number of events
+ *  per second. */
+BkgGenerator* newBkgGeneratorHits(const long numrows,
+    const double* const hit_xpos,
+    const double* const hit_ypos,
+    const double* const hit_time,
+    const double* const hit_energy,
+    const double rate,
+    int* const status);
+
+/** Returns a new generator sharing the event table of the given one,
+ *  but with its own state (e.g. for another thread). Cloning and
+ *  destroying generators of the same table must not be done from
+ *  different threads at the same time. */
+BkgGenerator* cloneBkgGenerator(const BkgGenerator* const gen,
+    int* const status);
+
+/** Destructor of the background generator. The event table is
+ *  released with the last generator using it. */
+void destroyBkgGenerator(BkgGenerator** const gen);
+
+/** Use a Simput light curve to manipulate the background rate of the
+ *  generator over time (optional). */
+void setBkgGeneratorRateFct(BkgGenerator* const gen,
+    const char* const filename,
+    int* const status);
+
+/** Returns an empty list of background hits, which can be reused for
+ *  subsequent calls of getBkgGeneratorList (to be released by bkgFree). */
+backgroundOutput* newBkgOutput(int* const status);
+
+/** Fill the given list with a randomly chosen list of events for the
+ *  given interval, as bkgGetBackgroundList. The random numbers are
+ *  drawn from the given random number generator. The arrays of the
+ *  list are only reallocated if they are too small. */
+void getBkgGeneratorList(BkgGenerator* const gen,
+    gsl_rng* const rng,
+    const double interval,
+    backgroundOutput* const list,
+    int* const status);
+
 /** Use a Simput light curve to manipulate the background rate over time.
  *  The use of this function is optional.
  */
@@ -129,7 +222,9 @@ void bkgSetRateFct(const char* const filename, int* const status);
  * distribution. This function requires bkgInitialize to be called
  * once before being ready to deliver data. As soon as no more data will
  * be needed one should call the function bkgCleanUp in order to
- * release memory and close the input files. */
+ * release memory and close the input files. The module-level functions
+ * use a single BkgGenerator; for several independent backgrounds use
+ * the generator functions directly. */
 backgroundOutput* bkgGetBackgroundList(const double interval);
 
 /* Initialize data structures and read background data table.
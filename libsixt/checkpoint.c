@@ -0,0 +1,1097 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                  Erlangen-Nuernberg
+*/
+
+#include "checkpoint.h"
+
+#include <signal.h>
+#include <unistd.h>
+
+
+/** Version of the checkpoint format. */
+#define CHECKPOINT_VERSION (3)
+
+/** Number of significant digits of floating point header keywords,
+    such that their values are restored exactly. */
+#define CHECKPOINT_DIGITS (-17)
+
+
+/** Number of checkpoints written by this process. */
+static long ncheckpoints=0;
+
+
+/////////////////////////////////////////////////////////////////
+// Sources.
+/////////////////////////////////////////////////////////////////
+
+
+static long countKDTree(const KDTreeElement* const node)
+{
+  if (NULL==node) return(0);
+  return(1+countKDTree(node->left)+countKDTree(node->right));
+}
+
+
+static void collectKDTree(KDTreeElement* const node,
+			  Source** const list, long* const n)
+{
+  if (NULL==node) return;
+  list[(*n)++]=node->src;
+  collectKDTree(node->left, list, n);
+  collectKDTree(node->right, list, n);
+}
+
+
+/** Return the sources of a catalog in a fixed order: the point-like
+    sources in the pre-order of the KDTree followed by the extended
+    sources. */
+static Source** getCatalogSources(SourceCatalog* const cat,
+				  long* const nsources,
+				  int* const status)
+{
+  *nsources=countKDTree(cat->tree)+cat->nextsources;
+  Source** list=(Source**)malloc(MAX(*nsources, 1)*sizeof(Source*));
+  CHECK_NULL_RET(list, *status, "memory allocation for source list failed",
+		 NULL);
+
+  long n=0;
+  collectKDTree(cat->tree, list, &n);
+  long ii;
+  for (ii=0; ii<cat->nextsources; ii++) {
+    list[n++]=&(cat->extsources[ii]);
+  }
+  return(list);
+}
+
+
+/** Store the time of the next photon of all sources, for which
+    photons have been generated. */
+static void writeSourceTable(fitsfile* const fptr,
+			     SourceCatalog** const srccat,
+			     const unsigned int ncat,
+			     int* const status)
+{
+  char* ttype[]={"CATALOG", "SRCINDEX", "TNEXT", "ISCONST"};
+  char* tform[]={"1J", "1K", "1D", "1B"};
+  char* tunit[]={"", "", "s", ""};
+  fits_create_tbl(fptr, BINARY_TBL, 0, 4, ttype, tform, tunit,
+		  "SOURCES", status);
+  CHECK_STATUS_VOID(*status);
+
+  long row=0;
+  unsigned int ii;
+  for (ii=0; ii<ncat; ii++) {
+    char key[MAXMSG];
+    sprintf(key, "NSRC%u", ii);
+    long nsources=-1;
+    if (NULL==srccat[ii]) {
+      fits_update_key(fptr, TLONG, key, &nsources,
+		      "number of sources in catalog", status);
+      continue;
+    }
+
+    Source** list=getCatalogSources(srccat[ii], &nsources, status);
+    CHECK_STATUS_VOID(*status);
+    fits_update_key(fptr, TLONG, key, &nsources,
+		    "number of sources in catalog", status);
+
+    int* catalog=(int*)malloc(MAX(nsources, 1)*sizeof(int));
+    long* index=(long*)malloc(MAX(nsources, 1)*sizeof(long));
+    double* tnext=(double*)malloc(MAX(nsources, 1)*sizeof(double));
+    unsigned char* isconst=
+      (unsigned char*)malloc(MAX(nsources, 1)*sizeof(unsigned char));
+    if ((NULL==catalog)||(NULL==index)||(NULL==tnext)||(NULL==isconst)) {
+      SIXT_ERROR("memory allocation for source state failed");
+      *status=EXIT_FAILURE;
+    } else {
+      long jj, n=0;
+      for (jj=0; jj<nsources; jj++) {
+	if (NULL==list[jj]->t_next_photon) continue;
+	catalog[n]=(int)ii;
+	index[n]=jj;
+	tnext[n]=*(list[jj]->t_next_photon);
+	isconst[n]=(NULL!=list[jj]->energies) ? 1 : 0;
+	n++;
+      }
+      if (n>0) {
+	fits_write_col(fptr, TINT, 1, row+1, 1, n, catalog, status);
+	fits_write_col(fptr, TLONG, 2, row+1, 1, n, index, status);
+	fits_write_col(fptr, TDOUBLE, 3, row+1, 1, n, tnext, status);
+	fits_write_col(fptr, TBYTE, 4, row+1, 1, n, isconst, status);
+	row+=n;
+      }
+    }
+
+    free(list);
+    if (NULL!=catalog) free(catalog);
+    if (NULL!=index) free(index);
+    if (NULL!=tnext) free(tnext);
+    if (NULL!=isconst) free(isconst);
+    CHECK_STATUS_VOID(*status);
+  }
+}
+
+
+static void readSourceTable(fitsfile* const fptr,
+			    SourceCatalog** const srccat,
+			    const unsigned int ncat,
+			    const double mjdref,
+			    int* const status)
+{
+  fits_movnam_hdu(fptr, BINARY_TBL, "SOURCES", 0, status);
+  CHECK_STATUS_VOID(*status);
+
+  // Source lists of the individual catalogs.
+  Source*** lists=(Source***)calloc(MAX(ncat, 1), sizeof(Source**));
+  long* nsources=(long*)malloc(MAX(ncat, 1)*sizeof(long));
+  if ((NULL==lists)||(NULL==nsources)) {
+    SIXT_ERROR("memory allocation for source lists failed");
+    *status=EXIT_FAILURE;
+    if (NULL!=lists) free(lists);
+    if (NULL!=nsources) free(nsources);
+    return;
+  }
+  unsigned int ii;
+  for (ii=0; ii<ncat; ii++) {
+    nsources[ii]=-1;
+  }
+
+  long nrows=0;
+  int* catalog=NULL;
+  long* index=NULL;
+  double* tnext=NULL;
+  unsigned char* isconst=NULL;
+
+  do { // Error handling loop.
+    for (ii=0; ii<ncat; ii++) {
+      if (NULL!=srccat[ii]) {
+	lists[ii]=getCatalogSources(srccat[ii], &nsources[ii], status);
+	CHECK_STATUS_BREAK(*status);
+      }
+      char key[MAXMSG];
+      sprintf(key, "NSRC%u", ii);
+      long n;
+      fits_read_key(fptr, TLONG, key, &n, NULL, status);
+      CHECK_STATUS_BREAK(*status);
+      if (n!=nsources[ii]) {
+	char msg[MAXMSG];
+	sprintf(msg, "number of sources in catalog %u (%ld) differs from "
+		"the checkpoint (%ld)", ii+1, nsources[ii], n);
+	SIXT_ERROR(msg);
+	*status=EXIT_FAILURE;
+	break;
+      }
+    }
+    CHECK_STATUS_BREAK(*status);
+
+    fits_get_num_rows(fptr, &nrows, status);
+    CHECK_STATUS_BREAK(*status);
+    if (0==nrows) break;
+
+    catalog=(int*)malloc(nrows*sizeof(int));
+    index=(long*)malloc(nrows*sizeof(long));
+    tnext=(double*)malloc(nrows*sizeof(double));
+    isconst=(unsigned char*)malloc(nrows*sizeof(unsigned char));
+    if ((NULL==catalog)||(NULL==index)||(NULL==tnext)||(NULL==isconst)) {
+      SIXT_ERROR("memory allocation for source state failed");
+      *status=EXIT_FAILURE;
+      break;
+    }
+
+    int anynul=0;
+    fits_read_col(fptr, TINT, 1, 1, 1, nrows, NULL, catalog, &anynul, status);
+    fits_read_col(fptr, TLONG, 2, 1, 1, nrows, NULL, index, &anynul, status);
+    fits_read_col(fptr, TDOUBLE, 3, 1, 1, nrows, NULL, tnext, &anynul, status);
+    fits_read_col(fptr, TBYTE, 4, 1, 1, nrows, NULL, isconst, &anynul, status);
+    CHECK_STATUS_BREAK(*status);
+
+    long jj;
+    for (jj=0; jj<nrows; jj++) {
+      if ((catalog[jj]<0)||((unsigned int)catalog[jj]>=ncat)||
+	  (NULL==lists[catalog[jj]])||
+	  (index[jj]<0)||(index[jj]>=nsources[catalog[jj]])) {
+	SIXT_ERROR("invalid source in checkpoint");
+	*status=EXIT_FAILURE;
+	break;
+      }
+      SourceCatalog* cat=srccat[catalog[jj]];
+      restoreSource(lists[catalog[jj]][index[jj]], cat->simput, cat->energies,
+		    tnext[jj], isconst[jj], mjdref, status);
+      CHECK_STATUS_BREAK(*status);
+    }
+  } while(0); // END of error handling loop.
+
+  for (ii=0; ii<ncat; ii++) {
+    if (NULL!=lists[ii]) free(lists[ii]);
+  }
+  free(lists);
+  free(nsources);
+  if (NULL!=catalog) free(catalog);
+  if (NULL!=index) free(index);
+  if (NULL!=tnext) free(tnext);
+  if (NULL!=isconst) free(isconst);
+}
+
+
+/** Check whether a SIMPUT timing reference points to a power
+    spectrum (HDUCLAS1 POWSPEC), from which libsimput generates a
+    light curve with random numbers. The reference is resolved
+    relative to the catalog as in libsimput. */
+static int isPSDTimingRef(const SimputCtlg* const simput,
+			  const char* const ref,
+			  int* const status)
+{
+  char filename[MAXFILENAME];
+  if ('['==ref[0]) {
+    if (strlen(simput->filepath)+strlen(simput->filename)+strlen(ref)
+	>=MAXFILENAME) {
+      SIXT_ERROR("file name of timing extension too long");
+      *status=EXIT_FAILURE;
+      return(0);
+    }
+    sprintf(filename, "%s%s%s", simput->filepath, simput->filename, ref);
+  } else if ('/'!=ref[0]) {
+    if (strlen(simput->filepath)+strlen(ref)>=MAXFILENAME) {
+      SIXT_ERROR("file name of timing extension too long");
+      *status=EXIT_FAILURE;
+      return(0);
+    }
+    sprintf(filename, "%s%s", simput->filepath, ref);
+  } else {
+    strncpy(filename, ref, MAXFILENAME-1);
+    filename[MAXFILENAME-1]='\0';
+  }
+
+  fitsfile* fptr=NULL;
+  fits_open_file(&fptr, filename, READONLY, status);
+  CHECK_STATUS_RET(*status, 0);
+  char hduclas1[MAXMSG]={""};
+  int keystatus=EXIT_SUCCESS;
+  fits_read_key(fptr, TSTRING, "HDUCLAS1", hduclas1, NULL, &keystatus);
+  fits_close_file(fptr, status);
+  CHECK_STATUS_RET(*status, 0);
+
+  strtoupper(hduclas1);
+  return((EXIT_SUCCESS==keystatus)&&(0==strcmp(hduclas1, "POWSPEC")));
+}
+
+
+void checkCheckpointSources(SourceCatalog** const srccat,
+			    const unsigned int ncat,
+			    int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+
+  unsigned int ii;
+  for (ii=0; ii<ncat; ii++) {
+    if (NULL==srccat[ii]) continue;
+
+    long nsources;
+    Source** list=getCatalogSources(srccat[ii], &nsources, status);
+    CHECK_STATUS_VOID(*status);
+
+    // Many sources usually share the same timing extension.
+    char lastref[MAXFILENAME]={""};
+    long jj;
+    for (jj=0; jj<nsources; jj++) {
+      SimputSrc* src=getSimputSrc(srccat[ii]->simput, list[jj]->row, status);
+      CHECK_STATUS_BREAK(*status);
+      if ((NULL==src->timing)||(isSimputNullRef(src->timing))||
+	  (0==strcmp(src->timing, lastref))) {
+	continue;
+      }
+      if (1==isPSDTimingRef(srccat[ii]->simput, src->timing, status)) {
+	char msg[MAXMSG];
+	sprintf(msg, "checkpoints are not supported for sources with light "
+		"curves generated from a power spectrum (source %ld)",
+		src->src_id);
+	SIXT_ERROR(msg);
+	*status=EXIT_FAILURE;
+      }
+      CHECK_STATUS_BREAK(*status);
+      strncpy(lastref, src->timing, MAXFILENAME-1);
+      lastref[MAXFILENAME-1]='\0';
+    }
+    free(list);
+    CHECK_STATUS_VOID(*status);
+  }
+}
+
+
+/////////////////////////////////////////////////////////////////
+// Random number generator.
+/////////////////////////////////////////////////////////////////
+
+
+static void writeRngState(fitsfile* const fptr, int* const status)
+{
+  SixtRngState rng;
+  sixt_get_rng_state(&rng, status);
+  CHECK_STATUS_VOID(*status);
+
+  char tform0[MAXMSG];
+  sprintf(tform0, "%dK", SIXT_RNG_STATESIZE);
+  char* ttype[]={"MT"};
+  char* tform[]={tform0};
+  fits_create_tbl(fptr, BINARY_TBL, 0, 1, ttype, tform, NULL, "RNG", status);
+
+  LONGLONG ndraws=(LONGLONG)rng.ndraws;
+  fits_update_key(fptr, TINT, "PSEUDO", &rng.pseudo,
+		  "pseudo random number generator", status);
+  fits_update_key(fptr, TUINT, "SEED", &rng.seed,
+		  "seed of the random number generator", status);
+  fits_update_key(fptr, TLONGLONG, "NDRAWS", &ndraws,
+		  "random numbers drawn since the initialization", status);
+  fits_update_key(fptr, TINT, "MTI", &rng.mti,
+		  "position in the state vector", status);
+  fits_write_col(fptr, TULONG, 1, 1, 1, SIXT_RNG_STATESIZE, rng.mt, status);
+}
+
+
+static void readRngState(fitsfile* const fptr, int* const status)
+{
+  fits_movnam_hdu(fptr, BINARY_TBL, "RNG", 0, status);
+  CHECK_STATUS_VOID(*status);
+
+  SixtRngState rng;
+  LONGLONG ndraws;
+  int anynul=0;
+  fits_read_key(fptr, TINT, "PSEUDO", &rng.pseudo, NULL, status);
+  fits_read_key(fptr, TUINT, "SEED", &rng.seed, NULL, status);
+  fits_read_key(fptr, TLONGLONG, "NDRAWS", &ndraws, NULL, status);
+  fits_read_key(fptr, TINT, "MTI", &rng.mti, NULL, status);
+  fits_read_col(fptr, TULONG, 1, 1, 1, SIXT_RNG_STATESIZE, NULL, rng.mt,
+		&anynul, status);
+  CHECK_STATUS_VOID(*status);
+  rng.ndraws=(unsigned long long)ndraws;
+
+  sixt_set_rng_state(&rng, status);
+}
+
+
+/////////////////////////////////////////////////////////////////
+// Instruments.
+/////////////////////////////////////////////////////////////////
+
+
+/** Store the number of imaged photons, the numbers of rows in the
+    output files, the clock, the flags of the lines, and the charges
+    and dead times of the individual pixels of an instrument. Only the
+    pixels listed in the 'occupied' lists and the pixels with a dead
+    time are stored. The tables of the instrument with the given index
+    are distinguished by their EXTVER. */
+static void writeInstrumentState(fitsfile* const fptr,
+				 const GenInst* const inst,
+				 const SimCheckpoint* const cp,
+				 const unsigned int index,
+				 int* const status)
+{
+  const GenDet* const det=inst->det;
+  const int xwidth=det->pixgrid->xwidth;
+  const int ywidth=det->pixgrid->ywidth;
+
+  // Flags of the lines in the order of the 'line' array.
+  char* ttype1[]={"LASTREAD", "ANYCHRG", "ANYCARRY"};
+  char* tform1[]={"1D", "1J", "1J"};
+  fits_create_tbl(fptr, BINARY_TBL, 0, 3, ttype1, tform1, NULL,
+		  "LINES", status);
+  int extver=(int)index+1;
+  fits_update_key(fptr, TINT, "EXTVER", &extver, "instrument", status);
+
+  // The instrument, the clock, and the background models are stored
+  // in the header of the table.
+  fits_update_key(fptr, TLONG, "NIMAGED", (void*)&inst->tel->num_imaged,
+		  "number of imaged photons", status);
+  fits_update_key(fptr, TLONG, "NPHOTONS", (void*)&cp->nphotons[index],
+		  "rows in the photon file", status);
+  fits_update_key(fptr, TLONG, "NIMPACTS", (void*)&cp->nimpacts[index],
+		  "rows in the impact file", status);
+  fits_update_key(fptr, TLONG, "NEVENTS", (void*)&cp->nevents[index],
+		  "rows in the raw event file", status);
+  fits_update_key(fptr, TINT, "XWIDTH", (void*)&xwidth,
+		  "detector width [pixels]", status);
+  fits_update_key(fptr, TINT, "YWIDTH", (void*)&ywidth,
+		  "detector height [pixels]", status);
+  fits_update_key(fptr, TINT, "LINEOFF", (void*)&det->lineoffset,
+		  "offset of the line ring buffer", status);
+  fits_update_key(fptr, TINT, "ANYPHOT", (void*)&det->anyphoton,
+		  "photon interaction in current frame", status);
+  if (NULL!=det->clocklist) {
+    fits_update_key(fptr, TINT, "CLELEM", &det->clocklist->element,
+		    "current clock list element", status);
+    fits_update_key(fptr, TLONG, "CLFRAME", &det->clocklist->frame,
+		    "current frame", status);
+    fits_update_key_dbl(fptr, "CLTIME", det->clocklist->time,
+			CHECKPOINT_DIGITS, "[s] detector time", status);
+    fits_update_key_dbl(fptr, "CLROTIME", det->clocklist->readout_time,
+			CHECKPOINT_DIGITS, "[s] frame time", status);
+  }
+  int ii;
+  for (ii=0; ii<MAX_PHABKG; ii++) {
+    if (NULL==det->phabkg[ii]) continue;
+    char key[MAXMSG];
+    sprintf(key, "BKGTNXT%d", ii+1);
+    fits_update_key_dbl(fptr, key, det->phabkg[ii]->tnext,
+			CHECKPOINT_DIGITS, "[s] next background event", status);
+  }
+  CHECK_STATUS_VOID(*status);
+
+  for (ii=0; ii<ywidth; ii++) {
+    const GenDetLine* line=det->line[ii];
+    fits_write_col(fptr, TDOUBLE, 1, ii+1, 1, 1,
+		   (void*)&line->last_readouttime, status);
+    fits_write_col(fptr, TINT, 2, ii+1, 1, 1, (void*)&line->anycharge, status);
+    fits_write_col(fptr, TINT, 3, ii+1, 1, 1, (void*)&line->anycarry, status);
+  }
+  CHECK_STATUS_VOID(*status);
+
+  // Count the occupied pixels and the pixels with a dead time.
+  long noccupied=0, ndead=0;
+  for (ii=0; ii<ywidth; ii++) {
+    noccupied+=det->line[ii]->noccupied;
+    int jj;
+    for (jj=0; jj<xwidth; jj++) {
+      if (0.!=det->line[ii]->deadtime[jj]) ndead++;
+    }
+  }
+
+  int* lineidx=NULL;
+  int* column=NULL;
+  float* charge=NULL;
+  float* ccarry=NULL;
+  long* ids=NULL;
+  double* deadtime=NULL;
+
+  do { // Error handling loop.
+    const long n=MAX(noccupied, ndead);
+    lineidx=(int*)malloc(MAX(n, 1)*sizeof(int));
+    column=(int*)malloc(MAX(n, 1)*sizeof(int));
+    charge=(float*)malloc(MAX(noccupied, 1)*sizeof(float));
+    ccarry=(float*)malloc(MAX(noccupied, 1)*sizeof(float));
+    ids=(long*)malloc(MAX(noccupied, 1)*4*NEVENTPHOTONS*sizeof(long));
+    deadtime=(double*)malloc(MAX(ndead, 1)*sizeof(double));
+    if ((NULL==lineidx)||(NULL==column)||(NULL==charge)||(NULL==ccarry)||
+	(NULL==ids)||(NULL==deadtime)) {
+      SIXT_ERROR("memory allocation for detector state failed");
+      *status=EXIT_FAILURE;
+      break;
+    }
+
+    // Occupied pixels in the order of the 'occupied' lists, such that
+    // the order of the read-out is preserved.
+    long* ph_id=ids;
+    long* carry_ph_id=ids+noccupied*NEVENTPHOTONS;
+    long* src_id=ids+2*noccupied*NEVENTPHOTONS;
+    long* carry_src_id=ids+3*noccupied*NEVENTPHOTONS;
+    long kk=0;
+    for (ii=0; ii<ywidth; ii++) {
+      const GenDetLine* line=det->line[ii];
+      int jj;
+      for (jj=0; jj<line->noccupied; jj++, kk++) {
+	int x=line->occupied[jj];
+	lineidx[kk]=ii;
+	column[kk]=x;
+	charge[kk]=line->charge[x];
+	ccarry[kk]=line->ccarry[x];
+	memcpy(&ph_id[kk*NEVENTPHOTONS], line->ph_id[x],
+	       NEVENTPHOTONS*sizeof(long));
+	memcpy(&carry_ph_id[kk*NEVENTPHOTONS], line->carry_ph_id[x],
+	       NEVENTPHOTONS*sizeof(long));
+	memcpy(&src_id[kk*NEVENTPHOTONS], line->src_id[x],
+	       NEVENTPHOTONS*sizeof(long));
+	memcpy(&carry_src_id[kk*NEVENTPHOTONS], line->carry_src_id[x],
+	       NEVENTPHOTONS*sizeof(long));
+      }
+    }
+
+    char tformid[MAXMSG];
+    sprintf(tformid, "%dK", NEVENTPHOTONS);
+    char* ttype2[]={"LINE", "COLUMN", "CHARGE", "CCARRY",
+		    "PH_ID", "CPH_ID", "SRC_ID", "CSRC_ID"};
+    char* tform2[]={"1J", "1J", "1E", "1E", tformid, tformid, tformid, tformid};
+    fits_create_tbl(fptr, BINARY_TBL, 0, 8, ttype2, tform2, NULL,
+		    "PIXELS", status);
+    fits_update_key(fptr, TINT, "EXTVER", &extver, "instrument", status);
+    if (noccupied>0) {
+      fits_write_col(fptr, TINT, 1, 1, 1, noccupied, lineidx, status);
+      fits_write_col(fptr, TINT, 2, 1, 1, noccupied, column, status);
+      fits_write_col(fptr, TFLOAT, 3, 1, 1, noccupied, charge, status);
+      fits_write_col(fptr, TFLOAT, 4, 1, 1, noccupied, ccarry, status);
+      fits_write_col(fptr, TLONG, 5, 1, 1, noccupied*NEVENTPHOTONS,
+		     ph_id, status);
+      fits_write_col(fptr, TLONG, 6, 1, 1, noccupied*NEVENTPHOTONS,
+		     carry_ph_id, status);
+      fits_write_col(fptr, TLONG, 7, 1, 1, noccupied*NEVENTPHOTONS,
+		     src_id, status);
+      fits_write_col(fptr, TLONG, 8, 1, 1, noccupied*NEVENTPHOTONS,
+		     carry_src_id, status);
+    }
+    CHECK_STATUS_BREAK(*status);
+
+    // Dead times.
+    kk=0;
+    for (ii=0; ii<ywidth; ii++) {
+      int jj;
+      for (jj=0; jj<xwidth; jj++) {
+	if (0.==det->line[ii]->deadtime[jj]) continue;
+	lineidx[kk]=ii;
+	column[kk]=jj;
+	deadtime[kk]=det->line[ii]->deadtime[jj];
+	kk++;
+      }
+    }
+
+    char* ttype3[]={"LINE", "COLUMN", "DEADTIME"};
+    char* tform3[]={"1J", "1J", "1D"};
+    char* tunit3[]={"", "", "s"};
+    fits_create_tbl(fptr, BINARY_TBL, 0, 3, ttype3, tform3, tunit3,
+		    "DEADTIME", status);
+    fits_update_key(fptr, TINT, "EXTVER", &extver, "instrument", status);
+    if (ndead>0) {
+      fits_write_col(fptr, TINT, 1, 1, 1, ndead, lineidx, status);
+      fits_write_col(fptr, TINT, 2, 1, 1, ndead, column, status);
+      fits_write_col(fptr, TDOUBLE, 3, 1, 1, ndead, deadtime, status);
+    }
+    CHECK_STATUS_BREAK(*status);
+  } while(0); // END of error handling loop.
+
+  if (NULL!=lineidx) free(lineidx);
+  if (NULL!=column) free(column);
+  if (NULL!=charge) free(charge);
+  if (NULL!=ccarry) free(ccarry);
+  if (NULL!=ids) free(ids);
+  if (NULL!=deadtime) free(deadtime);
+}
+
+
+/** Check that a line and column index read from a checkpoint lie
+    within the detector. */
+static int isValidPixel(const GenDet* const det, const int line,
+			const int column)
+{
+  return((line>=0)&&(line<det->pixgrid->ywidth)&&
+	 (column>=0)&&(column<det->pixgrid->xwidth));
+}
+
+
+static void readInstrumentState(fitsfile* const fptr,
+				GenInst* const inst,
+				SimCheckpoint* const cp,
+				const unsigned int index,
+				int* const status)
+{
+  GenDet* const det=inst->det;
+  const int xwidth=det->pixgrid->xwidth;
+  const int ywidth=det->pixgrid->ywidth;
+  const int extver=(int)index+1;
+
+  fits_movnam_hdu(fptr, BINARY_TBL, "LINES", extver, status);
+  int cxwidth, cywidth;
+  fits_read_key(fptr, TINT, "XWIDTH", &cxwidth, NULL, status);
+  fits_read_key(fptr, TINT, "YWIDTH", &cywidth, NULL, status);
+  CHECK_STATUS_VOID(*status);
+  if ((cxwidth!=xwidth)||(cywidth!=ywidth)) {
+    SIXT_ERROR("detector dimensions differ from the checkpoint");
+    *status=EXIT_FAILURE;
+    return;
+  }
+  fits_read_key(fptr, TLONG, "NIMAGED", &inst->tel->num_imaged, NULL, status);
+  fits_read_key(fptr, TLONG, "NPHOTONS", &cp->nphotons[index], NULL, status);
+  fits_read_key(fptr, TLONG, "NIMPACTS", &cp->nimpacts[index], NULL, status);
+  fits_read_key(fptr, TLONG, "NEVENTS", &cp->nevents[index], NULL, status);
+  fits_read_key(fptr, TINT, "LINEOFF", &det->lineoffset, NULL, status);
+  fits_read_key(fptr, TINT, "ANYPHOT", &det->anyphoton, NULL, status);
+  if (NULL!=det->clocklist) {
+    fits_read_key(fptr, TINT, "CLELEM", &det->clocklist->element, NULL, status);
+    fits_read_key(fptr, TLONG, "CLFRAME", &det->clocklist->frame, NULL, status);
+    fits_read_key(fptr, TDOUBLE, "CLTIME", &det->clocklist->time, NULL, status);
+    fits_read_key(fptr, TDOUBLE, "CLROTIME", &det->clocklist->readout_time,
+		  NULL, status);
+  }
+  int ii;
+  for (ii=0; ii<MAX_PHABKG; ii++) {
+    if (NULL==det->phabkg[ii]) continue;
+    char key[MAXMSG];
+    sprintf(key, "BKGTNXT%d", ii+1);
+    fits_read_key(fptr, TDOUBLE, key, &det->phabkg[ii]->tnext, NULL, status);
+  }
+  CHECK_STATUS_VOID(*status);
+
+  // Lines.
+  det->nchargedlines=0;
+  for (ii=0; ii<ywidth; ii++) {
+    GenDetLine* line=det->line[ii];
+    int anynul=0;
+    fits_read_col(fptr, TDOUBLE, 1, ii+1, 1, 1, NULL,
+		  &line->last_readouttime, &anynul, status);
+    fits_read_col(fptr, TINT, 2, ii+1, 1, 1, NULL,
+		  &line->anycharge, &anynul, status);
+    fits_read_col(fptr, TINT, 3, ii+1, 1, 1, NULL,
+		  &line->anycarry, &anynul, status);
+    line->incharged=0;
+    if (0!=line->anycharge) {
+      markGenDetLineCharged(det, line);
+    }
+  }
+  CHECK_STATUS_VOID(*status);
+
+  int* lineidx=NULL;
+  int* column=NULL;
+  float* charge=NULL;
+  float* ccarry=NULL;
+  long* ids=NULL;
+  double* deadtime=NULL;
+
+  do { // Error handling loop.
+    // Occupied pixels.
+    long noccupied, ndead;
+    fits_movnam_hdu(fptr, BINARY_TBL, "PIXELS", extver, status);
+    fits_get_num_rows(fptr, &noccupied, status);
+    CHECK_STATUS_BREAK(*status);
+
+    lineidx=(int*)malloc(MAX(noccupied, 1)*sizeof(int));
+    column=(int*)malloc(MAX(noccupied, 1)*sizeof(int));
+    charge=(float*)malloc(MAX(noccupied, 1)*sizeof(float));
+    ccarry=(float*)malloc(MAX(noccupied, 1)*sizeof(float));
+    ids=(long*)malloc(MAX(noccupied, 1)*4*NEVENTPHOTONS*sizeof(long));
+    if ((NULL==lineidx)||(NULL==column)||(NULL==charge)||(NULL==ccarry)||
+	(NULL==ids)) {
+      SIXT_ERROR("memory allocation for detector state failed");
+      *status=EXIT_FAILURE;
+      break;
+    }
+
+    long* ph_id=ids;
+    long* carry_ph_id=ids+noccupied*NEVENTPHOTONS;
+    long* src_id=ids+2*noccupied*NEVENTPHOTONS;
+    long* carry_src_id=ids+3*noccupied*NEVENTPHOTONS;
+    if (noccupied>0) {
+      int anynul=0;
+      fits_read_col(fptr, TINT, 1, 1, 1, noccupied, NULL, lineidx,
+		    &anynul, status);
+      fits_read_col(fptr, TINT, 2, 1, 1, noccupied, NULL, column,
+		    &anynul, status);
+      fits_read_col(fptr, TFLOAT, 3, 1, 1, noccupied, NULL, charge,
+		    &anynul, status);
+      fits_read_col(fptr, TFLOAT, 4, 1, 1, noccupied, NULL, ccarry,
+		    &anynul, status);
+      fits_read_col(fptr, TLONG, 5, 1, 1, noccupied*NEVENTPHOTONS, NULL,
+		    ph_id, &anynul, status);
+      fits_read_col(fptr, TLONG, 6, 1, 1, noccupied*NEVENTPHOTONS, NULL,
+		    carry_ph_id, &anynul, status);
+      fits_read_col(fptr, TLONG, 7, 1, 1, noccupied*NEVENTPHOTONS, NULL,
+		    src_id, &anynul, status);
+      fits_read_col(fptr, TLONG, 8, 1, 1, noccupied*NEVENTPHOTONS, NULL,
+		    carry_src_id, &anynul, status);
+      CHECK_STATUS_BREAK(*status);
+    }
+
+    long kk;
+    for (kk=0; kk<noccupied; kk++) {
+      if (!isValidPixel(det, lineidx[kk], column[kk])) {
+	SIXT_ERROR("invalid pixel in checkpoint");
+	*status=EXIT_FAILURE;
+	break;
+      }
+      GenDetLine* line=det->line[lineidx[kk]];
+      int x=column[kk];
+      markGenDetLinePixel(line, x);
+      line->charge[x]=charge[kk];
+      line->ccarry[x]=ccarry[kk];
+      memcpy(line->ph_id[x], &ph_id[kk*NEVENTPHOTONS],
+	     NEVENTPHOTONS*sizeof(long));
+      memcpy(line->carry_ph_id[x], &carry_ph_id[kk*NEVENTPHOTONS],
+	     NEVENTPHOTONS*sizeof(long));
+      memcpy(line->src_id[x], &src_id[kk*NEVENTPHOTONS],
+	     NEVENTPHOTONS*sizeof(long));
+      memcpy(line->carry_src_id[x], &carry_src_id[kk*NEVENTPHOTONS],
+	     NEVENTPHOTONS*sizeof(long));
+    }
+    CHECK_STATUS_BREAK(*status);
+
+    // Dead times.
+    fits_movnam_hdu(fptr, BINARY_TBL, "DEADTIME", extver, status);
+    fits_get_num_rows(fptr, &ndead, status);
+    CHECK_STATUS_BREAK(*status);
+    if (0==ndead) break;
+
+    free(lineidx);
+    free(column);
+    lineidx=(int*)malloc(ndead*sizeof(int));
+    column=(int*)malloc(ndead*sizeof(int));
+    deadtime=(double*)malloc(ndead*sizeof(double));
+    if ((NULL==lineidx)||(NULL==column)||(NULL==deadtime)) {
+      SIXT_ERROR("memory allocation for detector state failed");
+      *status=EXIT_FAILURE;
+      break;
+    }
+    int anynul=0;
+    fits_read_col(fptr, TINT, 1, 1, 1, ndead, NULL, lineidx, &anynul, status);
+    fits_read_col(fptr, TINT, 2, 1, 1, ndead, NULL, column, &anynul, status);
+    fits_read_col(fptr, TDOUBLE, 3, 1, 1, ndead, NULL, deadtime,
+		  &anynul, status);
+    CHECK_STATUS_BREAK(*status);
+    for (kk=0; kk<ndead; kk++) {
+      if (!isValidPixel(det, lineidx[kk], column[kk])) {
+	SIXT_ERROR("invalid pixel in checkpoint");
+	*status=EXIT_FAILURE;
+	break;
+      }
+      det->line[lineidx[kk]]->deadtime[column[kk]]=deadtime[kk];
+    }
+  } while(0); // END of error handling loop.
+
+  if (NULL!=lineidx) free(lineidx);
+  if (NULL!=column) free(column);
+  if (NULL!=charge) free(charge);
+  if (NULL!=ccarry) free(ccarry);
+  if (NULL!=ids) free(ids);
+  if (NULL!=deadtime) free(deadtime);
+}
+
+
+/////////////////////////////////////////////////////////////////
+// Checkpoint files.
+/////////////////////////////////////////////////////////////////
+
+
+void checkCheckpointSupport(GenInst* const* const inst,
+			    const unsigned int ninst,
+			    int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+#ifdef USE_RCL
+  SIXT_ERROR("checkpoints are not supported with the RCL random number server");
+  *status=EXIT_FAILURE;
+  return;
+#endif
+  if (ninst>CHECKPOINT_MAX_INST) {
+    SIXT_ERROR("too many instruments for a checkpoint");
+    *status=EXIT_FAILURE;
+    return;
+  }
+  unsigned int ii;
+  for (ii=0; ii<ninst; ii++) {
+    if ((1==inst[ii]->det->auxbackground)&&(0==inst[ii]->det->ignore_bkg)) {
+      SIXT_ERROR("checkpoints are not supported with the auxiliary "
+		 "background model");
+      *status=EXIT_FAILURE;
+      return;
+    }
+  }
+}
+
+
+/** Flush an output file, such that its contents on disk are complete
+    up to the current number of rows. */
+static void flushOutputFile(fitsfile* const fptr, int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+  fits_flush_file(fptr, status);
+}
+
+
+void writeCheckpoint(const char* const filename,
+		     SimCheckpoint* const cp,
+		     GenInst* const* const inst,
+		     const unsigned int ninst,
+		     SourceCatalog** const srccat,
+		     const unsigned int ncat,
+		     const double mjdref,
+		     PhotonFile* const* const plf,
+		     ImpactFile* const* const ilf,
+		     EventFile* const* const elf,
+		     int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+
+  double phtime;
+  long long ph_id;
+  if (0==getPhgenState(&phtime, &ph_id)) {
+    SIXT_ERROR("checkpoint can only be written when all generated photons "
+	       "have been processed");
+    *status=EXIT_FAILURE;
+    return;
+  }
+  if (ninst>CHECKPOINT_MAX_INST) {
+    SIXT_ERROR("too many instruments for a checkpoint");
+    *status=EXIT_FAILURE;
+    return;
+  }
+
+  // The checkpoint refers to the output files on disk.
+  unsigned int ii;
+  for (ii=0; ii<ninst; ii++) {
+    cp->nphotons[ii]=-1;
+    cp->nimpacts[ii]=-1;
+    cp->nevents[ii]=-1;
+    if (NULL!=plf[ii]) {
+      flushOutputFile(plf[ii]->fptr, status);
+      cp->nphotons[ii]=plf[ii]->nrows;
+    }
+    if (NULL!=ilf[ii]) {
+      flushImpactFile(ilf[ii], status);
+      flushOutputFile(ilf[ii]->fptr, status);
+      cp->nimpacts[ii]=ilf[ii]->nrows;
+    }
+    if (NULL!=elf[ii]) {
+      flushEventFile(elf[ii], status);
+      flushOutputFile(elf[ii]->fptr, status);
+      cp->nevents[ii]=elf[ii]->nrows;
+    }
+  }
+  CHECK_STATUS_VOID(*status);
+
+  // For testing, the process can be killed instead of writing the
+  // n-th checkpoint (SIXTE_CHECKPOINT_KILL=n). The output files then
+  // contain rows beyond the preceding checkpoint.
+  const char* killenv=getenv("SIXTE_CHECKPOINT_KILL");
+  if ((NULL!=killenv)&&(atol(killenv)==ncheckpoints+1)) {
+    headas_chat(3, "\nkill simulation before checkpoint %ld\n",
+		ncheckpoints+1);
+    fflush(NULL);
+    raise(SIGKILL);
+  }
+
+  char tmpfile[MAXFILENAME];
+  if (strlen(filename)+16>=MAXFILENAME) {
+    SIXT_ERROR("checkpoint file name too long");
+    *status=EXIT_FAILURE;
+    return;
+  }
+  sprintf(tmpfile, "%s.%ld", filename, (long)getpid());
+  remove(tmpfile);
+
+  fitsfile* fptr=NULL;
+  fits_create_file(&fptr, tmpfile, status);
+  CHECK_STATUS_VOID(*status);
+
+  do { // Error handling loop.
+    fits_create_img(fptr, BYTE_IMG, 0, NULL, status);
+    int version=CHECKPOINT_VERSION;
+    LONGLONG id=(LONGLONG)ph_id;
+    fits_update_key(fptr, TINT, "CHKPTVER", &version,
+		    "version of the checkpoint format", status);
+    fits_update_key_dbl(fptr, "TSTART", cp->tstart, CHECKPOINT_DIGITS,
+			"[s] start of the simulation", status);
+    fits_update_key_dbl(fptr, "TSTOP", cp->tstop, CHECKPOINT_DIGITS,
+			"[s] end of the simulation", status);
+    fits_update_key_dbl(fptr, "MJDREF", mjdref, CHECKPOINT_DIGITS,
+			"reference MJD", status);
+    fits_update_key(fptr, TINT, "GTIBIN", &cp->gtibin,
+		    "current GTI interval", status);
+    fits_update_key_dbl(fptr, "SIMTIME", cp->simtime, CHECKPOINT_DIGITS,
+			"[s] length of the completed GTI intervals", status);
+    fits_update_key(fptr, TUINT, "PROGRESS", &cp->progress,
+		    "progress status [%]", status);
+    fits_update_key_dbl(fptr, "PHTIME", phtime, CHECKPOINT_DIGITS,
+			"[s] end of the photon generation", status);
+    fits_update_key(fptr, TLONGLONG, "PH_ID", &id,
+		    "ID of the last photon", status);
+    fits_update_key_dbl(fptr, "BKGTIME", getGenDetBkgTime(),
+			CHECKPOINT_DIGITS, "[s] last background insertion",
+			status);
+    unsigned int n=ninst;
+    fits_update_key(fptr, TUINT, "NINST", &n,
+		    "number of instruments", status);
+    CHECK_STATUS_BREAK(*status);
+
+    for (ii=0; ii<ninst; ii++) {
+      writeInstrumentState(fptr, inst[ii], cp, ii, status);
+      CHECK_STATUS_BREAK(*status);
+    }
+    CHECK_STATUS_BREAK(*status);
+
+    writeSourceTable(fptr, srccat, ncat, status);
+    CHECK_STATUS_BREAK(*status);
+
+    writeRngState(fptr, status);
+    CHECK_STATUS_BREAK(*status);
+  } while(0); // END of error handling loop.
+
+  int status2=EXIT_SUCCESS;
+  fits_close_file(fptr, &status2);
+  if (EXIT_SUCCESS==*status) {
+    *status=status2;
+  }
+
+  if ((EXIT_SUCCESS!=*status)||(0!=rename(tmpfile, filename))) {
+    remove(tmpfile);
+    char msg[MAXMSG];
+    sprintf(msg, "could not write checkpoint '%s'", filename);
+    SIXT_ERROR(msg);
+    *status=EXIT_FAILURE;
+    return;
+  }
+  ncheckpoints++;
+  headas_chat(5, "wrote checkpoint '%s' (t=%.3lf s)\n", filename, phtime);
+}
+
+
+unsigned int getCheckpointSeed(const char* const filename,
+			       int* const status)
+{
+  unsigned int seed=0;
+  CHECK_STATUS_RET(*status, seed);
+
+  fitsfile* fptr=NULL;
+  fits_open_file(&fptr, filename, READONLY, status);
+  CHECK_STATUS_RET(*status, seed);
+  fits_movnam_hdu(fptr, BINARY_TBL, "RNG", 0, status);
+  fits_read_key(fptr, TUINT, "SEED", &seed, NULL, status);
+
+  int status2=EXIT_SUCCESS;
+  fits_close_file(fptr, &status2);
+  if (EXIT_SUCCESS==*status) {
+    *status=status2;
+  }
+  return(seed);
+}
+
+
+void loadCheckpoint(const char* const filename,
+		    SimCheckpoint* const cp,
+		    GenInst* const* const inst,
+		    const unsigned int ninst,
+		    SourceCatalog** const srccat,
+		    const unsigned int ncat,
+		    const double mjdref,
+		    int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+
+  headas_chat(3, "load checkpoint '%s' ...\n", filename);
+  fitsfile* fptr=NULL;
+  fits_open_file(&fptr, filename, READONLY, status);
+  CHECK_STATUS_VOID(*status);
+
+  do { // Error handling loop.
+    int version;
+    double tstart, tstop, cmjdref, phtime;
+    LONGLONG id;
+    fits_read_key(fptr, TINT, "CHKPTVER", &version, NULL, status);
+    fits_read_key(fptr, TDOUBLE, "TSTART", &tstart, NULL, status);
+    fits_read_key(fptr, TDOUBLE, "TSTOP", &tstop, NULL, status);
+    fits_read_key(fptr, TDOUBLE, "MJDREF", &cmjdref, NULL, status);
+    CHECK_STATUS_BREAK(*status);
+    if (CHECKPOINT_VERSION!=version) {
+      SIXT_ERROR("unsupported version of the checkpoint format");
+      *status=EXIT_FAILURE;
+      break;
+    }
+    if ((tstart!=cp->tstart)||(tstop!=cp->tstop)||(cmjdref!=mjdref)) {
+      SIXT_ERROR("simulated time interval differs from the checkpoint");
+      *status=EXIT_FAILURE;
+      break;
+    }
+
+    fits_read_key(fptr, TINT, "GTIBIN", &cp->gtibin, NULL, status);
+    fits_read_key(fptr, TDOUBLE, "SIMTIME", &cp->simtime, NULL, status);
+    fits_read_key(fptr, TUINT, "PROGRESS", &cp->progress, NULL, status);
+    fits_read_key(fptr, TDOUBLE, "PHTIME", &phtime, NULL, status);
+    fits_read_key(fptr, TLONGLONG, "PH_ID", &id, NULL, status);
+    double bkgtime;
+    fits_read_key(fptr, TDOUBLE, "BKGTIME", &bkgtime, NULL, status);
+    unsigned int n;
+    fits_read_key(fptr, TUINT, "NINST", &n, NULL, status);
+    CHECK_STATUS_BREAK(*status);
+    if (n!=ninst) {
+      SIXT_ERROR("number of instruments differs from the checkpoint");
+      *status=EXIT_FAILURE;
+      break;
+    }
+    setPhgenState(phtime, (long long)id);
+    setGenDetBkgTime(bkgtime);
+
+    unsigned int ii;
+    for (ii=0; ii<ninst; ii++) {
+      readInstrumentState(fptr, inst[ii], cp, ii, status);
+      CHECK_STATUS_BREAK(*status);
+    }
+    CHECK_STATUS_BREAK(*status);
+
+    readSourceTable(fptr, srccat, ncat, mjdref, status);
+    CHECK_STATUS_BREAK(*status);
+
+    readRngState(fptr, status);
+    CHECK_STATUS_BREAK(*status);
+  } while(0); // END of error handling loop.
+
+  int status2=EXIT_SUCCESS;
+  fits_close_file(fptr, &status2);
+  if (EXIT_SUCCESS==*status) {
+    *status=status2;
+  }
+}
+
+
+/** Delete the rows beyond 'nrows' from a table and return the
+    remaining number of rows. */
+static long truncateTable(fitsfile* const fptr, const long nrows,
+			  int* const status)
+{
+  long filerows=0;
+  fits_get_num_rows(fptr, &filerows, status);
+  CHECK_STATUS_RET(*status, filerows);
+  if (filerows<nrows) {
+    SIXT_ERROR("output file contains fewer rows than stored in the checkpoint");
+    *status=EXIT_FAILURE;
+    return(filerows);
+  }
+  if (filerows>nrows) {
+    fits_delete_rows(fptr, nrows+1, filerows-nrows, status);
+  }
+  return(nrows);
+}
+
+
+void resumeCheckpointFiles(const SimCheckpoint* const cp,
+			   const unsigned int ninst,
+			   PhotonFile* const* const plf,
+			   ImpactFile* const* const ilf,
+			   EventFile* const* const elf,
+			   int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+
+  unsigned int ii;
+  for (ii=0; ii<ninst; ii++) {
+    if (((NULL==plf[ii])!=(cp->nphotons[ii]<0))||
+	((NULL==ilf[ii])!=(cp->nimpacts[ii]<0))||
+	((NULL==elf[ii])!=(cp->nevents[ii]<0))) {
+      SIXT_ERROR("requested output files differ from the checkpoint");
+      *status=EXIT_FAILURE;
+      return;
+    }
+
+    if (NULL!=plf[ii]) {
+      plf[ii]->nrows=truncateTable(plf[ii]->fptr, cp->nphotons[ii], status);
+      plf[ii]->row=plf[ii]->nrows;
+    }
+    if (NULL!=ilf[ii]) {
+      ilf[ii]->nrows=truncateTable(ilf[ii]->fptr, cp->nimpacts[ii], status);
+      ilf[ii]->row=ilf[ii]->nrows;
+    }
+    if (NULL!=elf[ii]) {
+      elf[ii]->nrows=truncateTable(elf[ii]->fptr, cp->nevents[ii], status);
+    }
+    CHECK_STATUS_VOID(*status);
+  }
+}
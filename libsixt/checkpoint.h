@@ -0,0 +1,170 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                  Erlangen-Nuernberg
+*/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H 1
+
+#include "sixt.h"
+#include "eventfile.h"
+#include "geninst.h"
+#include "impactfile.h"
+#include "phgen.h"
+#include "photonfile.h"
+#include "sourcecatalog.h"
+
+
+/** Checkpoints of a simulation with one or several instruments with
+    the GenDet detector model (runsixt, erosim).
+
+    A checkpoint is a FITS file containing the complete state of the
+    simulation at a point where all generated photons have been
+    processed (see getPhgenState()): the progress within the GTI, the
+    time of the next photon of each source, the state of the random
+    number generator, the charges, dead times, and clock of each
+    detector, and the number of rows in the output files of each
+    instrument. Resuming from a checkpoint yields the same output as
+    an uninterrupted simulation with the same seed. Writing
+    checkpoints does not change the random numbers of the simulation.
+
+    The state of the HEAdas random number generator cannot be
+    exported. It is restored by re-initializing the generator with
+    the seed and drawing the same random numbers again (see
+    sixt_set_rng_state()).
+
+    The state of the auxiliary (cosmic ray) background model, of the
+    RCL random number server, and of SIMPUT light curves generated
+    from a power spectrum cannot be stored. Simulations using them are
+    refused by checkCheckpointSupport() and checkCheckpointSources()
+    when checkpoints are written or resumed. The TES simulation
+    (tessim, xifupipeline) does not support checkpoints: the state of
+    its integrator, noise generators, triggers, and impact buffers is
+    not covered here. */
+
+
+/////////////////////////////////////////////////////////////////
+// Constants.
+/////////////////////////////////////////////////////////////////
+
+
+/** Maximum number of instruments in a checkpoint (the seven
+    telescopes of eROSITA). */
+#define CHECKPOINT_MAX_INST (7)
+
+
+/////////////////////////////////////////////////////////////////
+// Type Declarations.
+/////////////////////////////////////////////////////////////////
+
+
+/** Progress of the simulation, which is stored in a checkpoint in
+    addition to the state of the instrument and the sources. */
+typedef struct {
+  /** Simulated time interval [s]. It has to be set before writing
+      or loading a checkpoint and must be the same for both. */
+  double tstart, tstop;
+
+  /** Index of the current GTI interval. */
+  int gtibin;
+
+  /** Total length of the preceding GTI intervals [s]. */
+  double simtime;
+
+  /** Progress status (0 to 100). */
+  unsigned int progress;
+
+  /** Number of rows in the output photon, impact, and raw event
+      files of each instrument (-1 if the respective file is not
+      written). */
+  long nphotons[CHECKPOINT_MAX_INST];
+  long nimpacts[CHECKPOINT_MAX_INST];
+  long nevents[CHECKPOINT_MAX_INST];
+
+} SimCheckpoint;
+
+
+/////////////////////////////////////////////////////////////////
+// Function Declarations.
+/////////////////////////////////////////////////////////////////
+
+
+/** Check whether the state of the instruments can be stored in a
+    checkpoint. */
+void checkCheckpointSupport(GenInst* const* const inst,
+			    const unsigned int ninst,
+			    int* const status);
+
+/** Check whether the state of the sources of the given catalogs can
+    be stored in a checkpoint. Light curves generated from a power
+    spectrum cannot be restored. */
+void checkCheckpointSources(SourceCatalog** const srccat,
+			    const unsigned int ncat,
+			    int* const status);
+
+/** Write a checkpoint of the simulation with the given instruments
+    and their output files (the elements of the file arrays are NULL
+    for files that are not written). The output files are flushed,
+    such that their contents on disk match the stored numbers of
+    rows. The checkpoint is written under a temporary name and
+    renamed afterwards, such that an interruption never leaves an
+    incomplete file. For testing, the environment variable
+    SIXTE_CHECKPOINT_KILL=n kills the process with SIGKILL instead of
+    writing its n-th checkpoint. */
+void writeCheckpoint(const char* const filename,
+		     SimCheckpoint* const cp,
+		     GenInst* const* const inst,
+		     const unsigned int ninst,
+		     SourceCatalog** const srccat,
+		     const unsigned int ncat,
+		     const double mjdref,
+		     PhotonFile* const* const plf,
+		     ImpactFile* const* const ilf,
+		     EventFile* const* const elf,
+		     int* const status);
+
+/** Return the seed of the random number generator stored in a
+    checkpoint. A simulation must be resumed with this seed. */
+unsigned int getCheckpointSeed(const char* const filename,
+			       int* const status);
+
+/** Load a checkpoint. The state of the freshly loaded instruments and
+    source catalogs, of the photon generation, and of the random
+    number generator (initialized with the seed from
+    getCheckpointSeed()) is restored. */
+void loadCheckpoint(const char* const filename,
+		    SimCheckpoint* const cp,
+		    GenInst* const* const inst,
+		    const unsigned int ninst,
+		    SourceCatalog** const srccat,
+		    const unsigned int ncat,
+		    const double mjdref,
+		    int* const status);
+
+/** Remove the rows beyond the numbers stored in the checkpoint from
+    the re-opened output files. */
+void resumeCheckpointFiles(const SimCheckpoint* const cp,
+			   const unsigned int ninst,
+			   PhotonFile* const* const plf,
+			   ImpactFile* const* const ilf,
+			   EventFile* const* const elf,
+			   int* const status);
+
+
+#endif /* CHECKPOINT_H */
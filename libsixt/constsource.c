@@ -0,0 +1,331 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                  Erlangen-Nuernberg
+*/
+
+#include "constsource.h"
+
+#include <strings.h>
+
+
+int isSimputNullRef(const char* ref)
+{
+  if (NULL==ref) return(1);
+  while (isspace((unsigned char)*ref)) ref++;
+  if (0==strncasecmp(ref, "NULL", 4)) ref+=4;
+  while (isspace((unsigned char)*ref)) ref++;
+  return('\0'==*ref);
+}
+
+
+/** Photon flux density of the spectrum at the given energy obtained
+    by linear interpolation. The search for the spectral bin starts
+    at *bin, which is updated. */
+static double getSpecFlux(const SimputMIdpSpec* const spec,
+			  const double energy,
+			  long* const bin)
+{
+  if ((spec->nentries<1)||(energy<spec->energy[0])||
+      (energy>spec->energy[spec->nentries-1])) {
+    return(0.);
+  }
+  if (1==spec->nentries) {
+    return(spec->pflux[0]);
+  }
+  while ((*bin<spec->nentries-2)&&(spec->energy[*bin+1]<energy)) {
+    (*bin)++;
+  }
+  const double e0=spec->energy[*bin], e1=spec->energy[*bin+1];
+  if (e1<=e0) {
+    return(spec->pflux[*bin]);
+  }
+  return(spec->pflux[*bin]+
+	 (spec->pflux[*bin+1]-spec->pflux[*bin])*(energy-e0)/(e1-e0));
+}
+
+
+PhotonEnergyTable* newPhotonEnergyTable(const SimputMIdpSpec* const spec,
+					const struct ARF* const arf,
+					int* const status)
+{
+  PhotonEnergyTable* table=
+    (PhotonEnergyTable*)malloc(sizeof(PhotonEnergyTable));
+  CHECK_NULL_RET(table, *status,
+		 "memory allocation for PhotonEnergyTable failed", table);
+
+  // Initialize pointers with NULL.
+  table->specref=NULL;
+  table->nbins=0;
+  table->elow =NULL;
+  table->ehigh=NULL;
+  table->cdf  =NULL;
+  table->index=NULL;
+
+  if ((NULL==arf)||(arf->NumberEnergyBins<1)) {
+    SIXT_ERROR("no ARF available for the energy distribution of the photons");
+    *status=EXIT_FAILURE;
+    return(table);
+  }
+
+  const long nbins=arf->NumberEnergyBins;
+  table->elow =(float*)malloc(nbins*sizeof(float));
+  table->ehigh=(float*)malloc(nbins*sizeof(float));
+  table->cdf  =(double*)malloc(nbins*sizeof(double));
+  table->index=(long*)malloc(nbins*sizeof(long));
+  if ((NULL==table->elow)||(NULL==table->ehigh)||
+      (NULL==table->cdf)||(NULL==table->index)) {
+    SIXT_ERROR("memory allocation for PhotonEnergyTable failed");
+    *status=EXIT_FAILURE;
+    return(table);
+  }
+  table->nbins=nbins;
+
+  // Fold the spectrum with the ARF.
+  long ii, bin=0;
+  double sum=0.;
+  for (ii=0; ii<nbins; ii++) {
+    table->elow[ii] =arf->LowEnergy[ii];
+    table->ehigh[ii]=arf->HighEnergy[ii];
+    double energy=0.5*(arf->LowEnergy[ii]+arf->HighEnergy[ii]);
+    double flux=getSpecFlux(spec, energy, &bin);
+    double rate=flux*(arf->HighEnergy[ii]-arf->LowEnergy[ii])*arf->EffArea[ii];
+    if (rate>0.) {
+      sum+=rate;
+    }
+    table->cdf[ii]=sum;
+  }
+
+  // Normalize the distribution.
+  if (sum>0.) {
+    for (ii=0; ii<nbins; ii++) {
+      table->cdf[ii]/=sum;
+    }
+    table->cdf[nbins-1]=1.;
+  }
+
+  // Guide table.
+  bin=0;
+  for (ii=0; ii<nbins; ii++) {
+    double limit=(double)ii/nbins;
+    while ((bin<nbins-1)&&(table->cdf[bin]<=limit)) {
+      bin++;
+    }
+    table->index[ii]=bin;
+  }
+
+  return(table);
+}
+
+
+void freePhotonEnergyTable(PhotonEnergyTable** const table)
+{
+  if (NULL!=*table) {
+    if (NULL!=(*table)->specref) {
+      free((*table)->specref);
+    }
+    if (NULL!=(*table)->elow) {
+      free((*table)->elow);
+    }
+    if (NULL!=(*table)->ehigh) {
+      free((*table)->ehigh);
+    }
+    if (NULL!=(*table)->cdf) {
+      free((*table)->cdf);
+    }
+    if (NULL!=(*table)->index) {
+      free((*table)->index);
+    }
+    free(*table);
+    *table=NULL;
+  }
+}
+
+
+float samplePhotonEnergy(const PhotonEnergyTable* const table,
+			 const double rnd)
+{
+  long bin=table->index[MIN((long)(rnd*table->nbins), table->nbins-1)];
+  while ((bin<table->nbins-1)&&(table->cdf[bin]<=rnd)) {
+    bin++;
+  }
+
+  // Choose the energy within the bin with the remaining fraction of
+  // the random number.
+  double lower=(bin>0) ? table->cdf[bin-1] : 0.;
+  double width=table->cdf[bin]-lower;
+  double frac=(width>0.) ? (rnd-lower)/width : 0.5;
+  frac=MAX(0., MIN(1., frac));
+  return((float)(table->elow[bin]+frac*(table->ehigh[bin]-table->elow[bin])));
+}
+
+
+PhotonEnergyTables* newPhotonEnergyTables(int* const status)
+{
+  PhotonEnergyTables* tables=
+    (PhotonEnergyTables*)malloc(sizeof(PhotonEnergyTables));
+  CHECK_NULL(tables, *status,
+	     "memory allocation for PhotonEnergyTables failed");
+
+  // Initialize pointers with NULL.
+  tables->table=NULL;
+  tables->ntables=0;
+
+  return(tables);
+}
+
+
+void freePhotonEnergyTables(PhotonEnergyTables** const tables)
+{
+  if (NULL!=*tables) {
+    long ii;
+    for (ii=0; ii<(*tables)->ntables; ii++) {
+      freePhotonEnergyTable(&((*tables)->table[ii]));
+    }
+    if (NULL!=(*tables)->table) {
+      free((*tables)->table);
+    }
+    free(*tables);
+    *tables=NULL;
+  }
+}
+
+
+const PhotonEnergyTable* getPhotonEnergyTable(PhotonEnergyTables* const tables,
+					      SimputCtlg* const simputcat,
+					      const char* const specref,
+					      int* const status)
+{
+  // Check if the table has already been created.
+  long ii;
+  for (ii=0; ii<tables->ntables; ii++) {
+    if (0==strcmp(tables->table[ii]->specref, specref)) {
+      return(tables->table[ii]);
+    }
+  }
+
+  // Load the spectrum and fold it with the ARF.
+  SimputMIdpSpec* spec=loadSimputMIdpSpec(specref, status);
+  CHECK_STATUS_RET(*status, NULL);
+  PhotonEnergyTable* table=newPhotonEnergyTable(spec, simputcat->arf, status);
+  freeSimputMIdpSpec(&spec);
+  if (EXIT_SUCCESS==*status) {
+    table->specref=strdup(specref);
+    if (NULL==table->specref) {
+      SIXT_ERROR("memory allocation for PhotonEnergyTable failed");
+      *status=EXIT_FAILURE;
+    }
+  }
+  if (EXIT_SUCCESS!=*status) {
+    freePhotonEnergyTable(&table);
+    return(NULL);
+  }
+
+  PhotonEnergyTable** newtable=(PhotonEnergyTable**)
+    realloc(tables->table, (tables->ntables+1)*sizeof(PhotonEnergyTable*));
+  if (NULL==newtable) {
+    SIXT_ERROR("memory allocation for PhotonEnergyTables failed");
+    *status=EXIT_FAILURE;
+    freePhotonEnergyTable(&table);
+    return(NULL);
+  }
+  tables->table=newtable;
+  tables->table[tables->ntables++]=table;
+
+  return(table);
+}
+
+
+int useConstSourcePhotons(void)
+{
+  const char* env=getenv("SIXTE_SIMPUT_PHOTONS");
+  return((NULL==env)||('\0'==env[0])||(0==strcmp(env, "0")));
+}
+
+
+int isConstSimputSrc(const SimputSrc* const src)
+{
+  return(isSimputNullRef(src->image)&&isSimputNullRef(src->timing)&&
+	 !isSimputNullRef(src->spectrum));
+}
+
+
+long genConstSourcePhotons(const PhotonEnergyTable* const table,
+			   const double rate,
+			   const double ra, const double dec,
+			   const long src_id,
+			   const double t0, const double t1,
+			   Photon** const photons,
+			   long* const nphotons,
+			   long* const size,
+			   int* const status)
+{
+  if ((t1<=t0)||(rate<=0.)||(table->nbins<1)||
+      (table->cdf[table->nbins-1]<=0.)) {
+    return(0);
+  }
+
+  // Number of photons within the interval.
+  long n=rndpoisson(rate*(t1-t0), status);
+  CHECK_STATUS_RET(*status, 0);
+  if (0==n) {
+    return(0);
+  }
+
+  // Make sure that the buffer is large enough.
+  if (*nphotons+n>*size) {
+    long newsize=MAX(*nphotons+n, 2*(*size));
+    Photon* newphotons=(Photon*)realloc(*photons, newsize*sizeof(Photon));
+    CHECK_NULL_RET(newphotons, *status,
+		   "memory allocation for photon buffer failed", 0);
+    *photons=newphotons;
+    *size=newsize;
+  }
+  Photon* ph=&((*photons)[*nphotons]);
+
+  // Arrival times: the cumulative sums of n+1 exponentially
+  // distributed spacings normalized by their total are distributed
+  // like the ordered sample of n uniform random numbers.
+  long ii;
+  double sum=0.;
+  for (ii=0; ii<n; ii++) {
+    sum+=rndexp(1., status);
+    ph[ii].time=sum;
+  }
+  sum+=rndexp(1., status);
+  CHECK_STATUS_RET(*status, 0);
+  const double scale=(t1-t0)/sum;
+  for (ii=0; ii<n; ii++) {
+    ph[ii].time=MIN(t0+ph[ii].time*scale, t1);
+  }
+
+  // Energies and remaining properties.
+  for (ii=0; ii<n; ii++) {
+    ph[ii].energy=samplePhotonEnergy(table, sixt_get_random_number(status));
+    ph[ii].ra =ra;
+    ph[ii].dec=dec;
+    ph[ii].src_id=src_id;
+    // The photon ID is set later, when the photon is inserted in the
+    // photon list file.
+    ph[ii].ph_id=0;
+  }
+  CHECK_STATUS_RET(*status, 0);
+
+  *nphotons+=n;
+  return(n);
+}
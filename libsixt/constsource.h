@@ -0,0 +1,144 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                  Erlangen-Nuernberg
+*/
+
+
+#ifndef CONSTSOURCE_H
+#define CONSTSOURCE_H 1
+
+#include "sixt.h"
+#include "photon.h"
+#include "rndgen.h"
+#include "simput.h"
+
+
+/////////////////////////////////////////////////////////////////
+// Type Declarations.
+/////////////////////////////////////////////////////////////////
+
+
+/** Energy distribution of the photons of a spectrum folded with the
+    ARF. It is used to create the photons of point sources with
+    constant flux and spectrum by inverse transform sampling instead
+    of calling the SIMPUT library for each photon. */
+typedef struct {
+  /** Reference to the spectrum in the SIMPUT catalog. */
+  char* specref;
+
+  /** Number of energy bins (bins of the ARF). */
+  long nbins;
+
+  /** Lower and upper boundaries of the energy bins [keV]. */
+  float* elow;
+  float* ehigh;
+
+  /** Cumulative probability of the energy bins. The last entry is 1
+      (or 0 if the spectrum does not yield any photons). */
+  double* cdf;
+
+  /** Guide table for the inverse transform sampling: index[k] is the
+      first bin with cdf>k/nbins. */
+  long* index;
+
+} PhotonEnergyTable;
+
+
+/** Energy tables of all constant point sources of a catalog. Sources
+    with the same spectrum share their table. */
+typedef struct {
+  PhotonEnergyTable** table;
+
+  /** Number of entries in the array. */
+  long ntables;
+
+} PhotonEnergyTables;
+
+
+/////////////////////////////////////////////////////////////////
+// Function Declarations.
+/////////////////////////////////////////////////////////////////
+
+
+/** Constructor. Folds the spectrum with the ARF and determines the
+    cumulative distribution of the photon energies. The photon flux of
+    the spectrum is evaluated at the center of each ARF bin like in
+    the SIMPUT library. */
+PhotonEnergyTable* newPhotonEnergyTable(const SimputMIdpSpec* const spec,
+					const struct ARF* const arf,
+					int* const status);
+
+/** Destructor. */
+void freePhotonEnergyTable(PhotonEnergyTable** const table);
+
+/** Return a photon energy [keV] for a random number out of the
+    interval [0,1). */
+float samplePhotonEnergy(const PhotonEnergyTable* const table,
+			 const double rnd);
+
+/** Constructor for the energy tables of a catalog. */
+PhotonEnergyTables* newPhotonEnergyTables(int* const status);
+
+/** Destructor. */
+void freePhotonEnergyTables(PhotonEnergyTables** const tables);
+
+/** Return the energy table for the referenced spectrum. The table is
+    created from the SIMPUT catalog, if it does not exist yet. */
+const PhotonEnergyTable* getPhotonEnergyTable(PhotonEnergyTables* const tables,
+					      SimputCtlg* const simputcat,
+					      const char* const specref,
+					      int* const status);
+
+/** Check whether a reference in the SIMPUT catalog (e.g. to an image
+    or a light curve) is empty, i.e., NULL, blank, or "NULL". */
+int isSimputNullRef(const char* ref);
+
+/** Check whether the photons of constant point sources are created
+    with energy tables. This draws other random numbers than the
+    SIMPUT library, so the photons differ from earlier versions for
+    the same seed (with the same distributions). The SIMPUT library
+    is used for all photons, if the environment variable
+    SIXTE_SIMPUT_PHOTONS is set (and not "0"). */
+int useConstSourcePhotons(void);
+
+/** Check whether photons of the SIMPUT source can be created with an
+    energy table, i.e., the source is point-like without image and
+    has no timing extension. */
+int isConstSimputSrc(const SimputSrc* const src);
+
+/** Create the photons of a point source with the given photon rate
+    [photons/s] and energy table within the time interval (t0, t1].
+    The number of photons is drawn from a Poisson distribution and
+    the arrival times are obtained from the cumulative sum of
+    exponentially distributed spacings, such that they are already
+    sorted. The photons are appended to the array 'photons' with
+    'nphotons' entries and allocated memory for 'size' entries, which
+    is enlarged if necessary. Returns the number of new photons. */
+long genConstSourcePhotons(const PhotonEnergyTable* const table,
+			   const double rate,
+			   const double ra, const double dec,
+			   const long src_id,
+			   const double t0, const double t1,
+			   Photon** const photons,
+			   long* const nphotons,
+			   long* const size,
+			   int* const status);
+
+
+#endif /* CONSTSOURCE_H */
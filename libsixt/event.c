@@ -30,30 +30,36 @@ Event* getEvent(int* const status)
 		 "memory allocation for Event failed", ev);
 
   // Initalize.
-  ev->rawx=0;
-  ev->rawy=0;
-  ev->pha  =0;
-  ev->pi   = -1;
-  ev->signal =0.;
-  ev->time   =0.;
-  ev->frame  =0;
-  ev->npixels=0;
-  ev->type   =0;
-  ev->pileup =0;
-  ev->ra     =0.;
-  ev->dec    =0.;
+  clearEvent(ev);
+
+  return(ev);
+}
+
+
+void clearEvent(Event* const event)
+{
+  event->rawx=0;
+  event->rawy=0;
+  event->pha  =0;
+  event->pi   = -1;
+  event->signal =0.;
+  event->time   =0.;
+  event->frame  =0;
+  event->npixels=0;
+  event->type   =0;
+  event->pileup =0;
+  event->ra     =0.;
+  event->dec    =0.;
 
   int ii;
   for(ii=0; ii<9; ii++) {
-    ev->signals[ii]=0.;
-    ev->phas[ii]    =0;
+    event->signals[ii]=0.;
+    event->phas[ii]    =0;
   }
   for(ii=0; ii<NEVENTPHOTONS; ii++) {
-    ev->ph_id[ii] =0;
-    ev->src_id[ii]=0;
+    event->ph_id[ii] =0;
+    event->src_id[ii]=0;
   }
-
-  return(ev);
 }
 
 
@@ -103,6 +103,11 @@ typedef struct {
     NULL and variables with their default values. */
 Event* getEvent(int* const status);
 
+/** Reset all entries of an existing Event data structure to their
+    default values. Allows to use Event objects on the stack or in
+    pre-allocated arrays without going through the constructor. */
+void clearEvent(Event* const event);
+
 /** Destructor for Event data structure. */
 void freeEvent(Event** const event);
 
@@ -23,6 +23,9 @@
 #include "eventfile.h"
 
 
+static void writeEventBuffer(EventFile* const file, int* const status);
+
+
 EventFile* newEventFile(int* const status)
 {
   EventFile* file=(EventFile*)malloc(sizeof(EventFile));
@@ -51,6 +54,12 @@ EventFile* newEventFile(int* const status)
   file->cphas    =0;
   file->cpileup =0;
 
+  file->buffer   =NULL;
+  file->nbuffer  =0;
+  file->colbuffer=NULL;
+  file->hdunum   =0;
+  file->writer   =NULL;
+
   return(file);
 }
 
@@ -60,6 +69,15 @@ void freeEventFile(EventFile** const file,
 {
   if (NULL!=*file) {
     if (NULL!=(*file)->fptr) {
+      // Write the remaining buffered events, even if an error
+      // occurred before.
+      int flush_status=EXIT_SUCCESS;
+      flushEventFile(*file, &flush_status);
+      destroyFitsWriter(&(*file)->writer, &flush_status);
+      if (EXIT_SUCCESS==*status) {
+	*status=flush_status;
+      }
+
       // If the file was opened in READWRITE mode, calculate
       // the check sum an append it to the FITS header.
       int mode;
@@ -69,6 +87,12 @@ void freeEventFile(EventFile** const file,
       }
       fits_close_file((*file)->fptr, status);
     }
+    if (NULL!=(*file)->buffer) {
+      free((*file)->buffer);
+    }
+    if (NULL!=(*file)->colbuffer) {
+      free((*file)->colbuffer);
+    }
     free(*file);
     *file=NULL;
   }
@@ -201,6 +225,7 @@ EventFile* openEventFile(const char* const filename,
   headas_chat(3, "open event file '%s' ...\n", filename);
   fits_open_table(&file->fptr, filename, mode, status);
   CHECK_STATUS_RET(*status, file);
+  fits_get_hdu_num(file->fptr, &file->hdunum);
 
   // Determine the row numbers.
   fits_get_num_rows(file->fptr, &file->nrows, status);
@@ -252,6 +277,10 @@ void addCol2EventFile(EventFile* const file,
 		char* const tunit,
 		int* const status){
 
+	// Buffered events have to be written with the old column layout.
+	flushEventFile(file, status);
+	CHECK_STATUS_VOID(*status);
+
 	// Check if colnum is out of bounds
 	int cnum = 0;
 	fits_get_num_cols(file->fptr, &cnum, status);
@@ -289,16 +318,259 @@ void addCol2EventFile(EventFile* const file,
 }
 
 void addEvent2File(EventFile* const file,
-		   Event* const event,
+		   const Event* const event,
 		   int* const status)
 {
   // Check if the file has been opened.
   CHECK_NULL_VOID(file, *status, "event file not open");
   CHECK_NULL_VOID(file->fptr, *status, "event file not open");
 
-  // Write the data.
-  updateEventInFile(file, ++file->nrows, event, status);
+  // The buffer is allocated once, when the first event is added.
+  if (NULL==file->buffer) {
+    file->buffer=(Event*)malloc(EVENTFILE_BUFFERSIZE*sizeof(Event));
+    CHECK_MALLOC_VOID_STATUS(file->buffer, *status);
+  }
+
+  // Store a copy of the event and write the buffer if it is full.
+  file->buffer[file->nbuffer++]=*event;
+  file->nrows++;
+  SIXT_PROF_COUNT(SIXT_PROF_ROWS_WRITTEN, 1);
+  if (EVENTFILE_BUFFERSIZE==file->nbuffer) {
+    writeEventBuffer(file, status);
+    CHECK_STATUS_VOID(*status);
+  }
+}
+
+
+/** Scratch buffer for the transfer of single columns of up to
+    EVENTFILE_BUFFERSIZE events. It has to hold the largest vector
+    column. */
+static void* getEventColBuffer(EventFile* const file, int* const status)
+{
+  const long maxrepeat=MAX(9, NEVENTPHOTONS);
+  if (NULL==file->colbuffer) {
+    file->colbuffer=malloc(EVENTFILE_BUFFERSIZE*maxrepeat*
+			   MAX(sizeof(double), sizeof(long)));
+    CHECK_MALLOC_RET_NULL_STATUS(file->colbuffer, *status);
+  }
+  return(file->colbuffer);
+}
+
+
+/** Write the selected columns (EVENTCOL_*) of the events ev[0..n-1]
+    to the rows starting at 'firstrow'. */
+static void writeEventRows(EventFile* const file, const unsigned int columns,
+			   const long firstrow, const long n,
+			   const Event* const* const ev, int* const status)
+{
+  void* colbuffer=getEventColBuffer(file, status);
+  CHECK_STATUS_VOID(*status);
+  double* dbuffer=(double*)colbuffer;
+  float* fbuffer=(float*)colbuffer;
+  long* lbuffer=(long*)colbuffer;
+  int* ibuffer=(int*)colbuffer;
+
+  // Make sure that the rows are written to the event table, even if
+  // another HDU (e.g. a GTI extension) has been accessed in the
+  // meantime.
+  int hdunum;
+  fits_get_hdu_num(file->fptr, &hdunum);
+  if ((file->hdunum>0)&&(hdunum!=file->hdunum)) {
+    int hdutype;
+    fits_movabs_hdu(file->fptr, file->hdunum, &hdutype, status);
+    CHECK_STATUS_VOID(*status);
+  }
+
+  long ii, jj;
+
+  if (columns&EVENTCOL_TIME) {
+    for (ii=0; ii<n; ii++) dbuffer[ii]=ev[ii]->time;
+    fits_write_col(file->fptr, TDOUBLE, file->ctime, firstrow, 1, n,
+		   dbuffer, status);
+  }
+  if (columns&EVENTCOL_FRAME) {
+    for (ii=0; ii<n; ii++) lbuffer[ii]=ev[ii]->frame;
+    fits_write_col(file->fptr, TLONG, file->cframe, firstrow, 1, n,
+		   lbuffer, status);
+  }
+  if (columns&EVENTCOL_PHA) {
+    for (ii=0; ii<n; ii++) lbuffer[ii]=ev[ii]->pha;
+    fits_write_col(file->fptr, TLONG, file->cpha, firstrow, 1, n,
+		   lbuffer, status);
+  }
+  if (columns&EVENTCOL_SIGNAL) {
+    for (ii=0; ii<n; ii++) fbuffer[ii]=ev[ii]->signal;
+    fits_write_col(file->fptr, TFLOAT, file->csignal, firstrow, 1, n,
+		   fbuffer, status);
+  }
+  if (columns&EVENTCOL_RAWX) {
+    for (ii=0; ii<n; ii++) ibuffer[ii]=ev[ii]->rawx;
+    fits_write_col(file->fptr, TINT, file->crawx, firstrow, 1, n,
+		   ibuffer, status);
+  }
+  if (columns&EVENTCOL_RAWY) {
+    for (ii=0; ii<n; ii++) ibuffer[ii]=ev[ii]->rawy;
+    fits_write_col(file->fptr, TINT, file->crawy, firstrow, 1, n,
+		   ibuffer, status);
+  }
+  if (columns&EVENTCOL_RA) {
+    for (ii=0; ii<n; ii++) dbuffer[ii]=ev[ii]->ra*180./M_PI;
+    fits_write_col(file->fptr, TDOUBLE, file->cra, firstrow, 1, n,
+		   dbuffer, status);
+  }
+  if (columns&EVENTCOL_DEC) {
+    for (ii=0; ii<n; ii++) dbuffer[ii]=ev[ii]->dec*180./M_PI;
+    fits_write_col(file->fptr, TDOUBLE, file->cdec, firstrow, 1, n,
+		   dbuffer, status);
+  }
+  if (columns&EVENTCOL_PH_ID) {
+    for (ii=0; ii<n; ii++) {
+      for (jj=0; jj<NEVENTPHOTONS; jj++) {
+	lbuffer[ii*NEVENTPHOTONS+jj]=ev[ii]->ph_id[jj];
+      }
+    }
+    fits_write_col(file->fptr, TLONG, file->cph_id, firstrow, 1,
+		   n*NEVENTPHOTONS, lbuffer, status);
+  }
+  if (columns&EVENTCOL_SRC_ID) {
+    for (ii=0; ii<n; ii++) {
+      for (jj=0; jj<NEVENTPHOTONS; jj++) {
+	lbuffer[ii*NEVENTPHOTONS+jj]=ev[ii]->src_id[jj];
+      }
+    }
+    fits_write_col(file->fptr, TLONG, file->csrc_id, firstrow, 1,
+		   n*NEVENTPHOTONS, lbuffer, status);
+  }
+  if (columns&EVENTCOL_NPIXELS) {
+    for (ii=0; ii<n; ii++) lbuffer[ii]=ev[ii]->npixels;
+    fits_write_col(file->fptr, TLONG, file->cnpixels, firstrow, 1, n,
+		   lbuffer, status);
+  }
+  if (columns&EVENTCOL_PILEUP) {
+    for (ii=0; ii<n; ii++) ibuffer[ii]=ev[ii]->pileup;
+    fits_write_col(file->fptr, TINT, file->cpileup, firstrow, 1, n,
+		   ibuffer, status);
+  }
+  if (columns&EVENTCOL_TYPE) {
+    for (ii=0; ii<n; ii++) ibuffer[ii]=ev[ii]->type;
+    fits_write_col(file->fptr, TINT, file->ctype, firstrow, 1, n,
+		   ibuffer, status);
+  }
+  if (columns&EVENTCOL_SIGNALS) {
+    for (ii=0; ii<n; ii++) {
+      for (jj=0; jj<9; jj++) {
+	fbuffer[ii*9+jj]=ev[ii]->signals[jj];
+      }
+    }
+    fits_write_col(file->fptr, TFLOAT, file->csignals, firstrow, 1, n*9,
+		   fbuffer, status);
+  }
+  if (columns&EVENTCOL_PHAS) {
+    for (ii=0; ii<n; ii++) {
+      for (jj=0; jj<9; jj++) {
+	lbuffer[ii*9+jj]=ev[ii]->phas[jj];
+      }
+    }
+    fits_write_col(file->fptr, TLONG, file->cphas, firstrow, 1, n*9,
+		   lbuffer, status);
+  }
+  if ((columns&EVENTCOL_PI)&&(file->cpi>0)) {
+    for (ii=0; ii<n; ii++) lbuffer[ii]=ev[ii]->pi;
+    fits_write_col(file->fptr, TLONG, file->cpi, firstrow, 1, n,
+		   lbuffer, status);
+  }
+  CHECK_STATUS_VOID(*status);
+
+  // Return to the previously active HDU.
+  if ((file->hdunum>0)&&(hdunum!=file->hdunum)) {
+    int hdutype;
+    fits_movabs_hdu(file->fptr, hdunum, &hdutype, status);
+    CHECK_STATUS_VOID(*status);
+  }
+}
+
+
+/** FitsWriterFct for the blocks of events. */
+static void writeEventBlock(fitsfile* const fptr, const long firstrow,
+			    const long nrows, void* const* const rows,
+			    void* const data, int* const status)
+{
+  (void)fptr;
+  writeEventRows((EventFile*)data, EVENTCOL_ALL, firstrow, nrows,
+		 (const Event* const*)rows, status);
+}
+
+
+/** Hand the events in the buffer of addEvent2File() over to the
+    writer or write them to the FITS file. */
+static void writeEventBuffer(EventFile* const file, int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+  if ((NULL==file)||(0==file->nbuffer)) {
+    return;
+  }
+
+  const long n=file->nbuffer;
+  long ii;
+  if (NULL!=file->writer) {
+    for (ii=0; ii<n; ii++) {
+      Event* row=(Event*)addFitsWriterRow(file->writer, sizeof(Event), status);
+      CHECK_STATUS_VOID(*status);
+      *row=file->buffer[ii];
+    }
+  } else {
+    const Event* ev[EVENTFILE_BUFFERSIZE];
+    for (ii=0; ii<n; ii++) {
+      ev[ii]=&file->buffer[ii];
+    }
+    writeEventRows(file, EVENTCOL_ALL, file->nrows-n+1, n, ev, status);
+    CHECK_STATUS_VOID(*status);
+  }
+
+  file->nbuffer=0;
+}
+
+
+/** Wait until all events handed over to the writer have been
+    written, such that the FITS file can be accessed. */
+static void syncEventFile(const EventFile* const file, int* const status)
+{
+  if (NULL!=file->writer) {
+    flushFitsWriter(file->writer, status);
+  }
+}
+
+
+void flushEventFile(EventFile* const file, int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+  if (NULL==file) {
+    return;
+  }
+  writeEventBuffer(file, status);
+  CHECK_STATUS_VOID(*status);
+  syncEventFile(file, status);
+}
+
+
+void startEventFileWriter(EventFile* const file, const int threaded,
+			  int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+  CHECK_NULL_VOID(file, *status, "event file not open");
+  CHECK_NULL_VOID(file->fptr, *status, "event file not open");
+  if (NULL!=file->writer) {
+    return;
+  }
+
+  // The events appended so far are written in the order of the rows.
+  writeEventBuffer(file, status);
   CHECK_STATUS_VOID(*status);
+
+  file->writer=newFitsWriter(file->fptr, file->nrows+1, sizeof(Event),
+			     EVENTFILE_BUFFERSIZE, EVENTFILE_WRITERBLOCKS,
+			     getFitsWriterThreading(threaded),
+			     writeEventBlock, file, status);
 }
 
 
@@ -316,6 +588,15 @@ void getEventFromFile(const EventFile* const file,
     SIXT_ERROR("event file contains no further entries");
     return;
   }
+  SIXT_PROF_COUNT(SIXT_PROF_ROWS_READ, 1);
+
+  // The row might still be in the buffer of addEvent2File().
+  if (row>file->nrows-file->nbuffer) {
+    *event=file->buffer[row-(file->nrows-file->nbuffer)-1];
+    return;
+  }
+  syncEventFile(file, status);
+  CHECK_STATUS_VOID(*status);
 
   // Read in the data.
   int anynul=0;
@@ -378,6 +659,15 @@ void updateEventInFile(const EventFile* const file,
 		       const int row, Event* const event,
 		       int* const status)
 {
+  // Rows that have not been written to the file yet are updated
+  // in the buffer of addEvent2File().
+  if (row>file->nrows-file->nbuffer) {
+    file->buffer[row-(file->nrows-file->nbuffer)-1]=*event;
+    return;
+  }
+  syncEventFile(file, status);
+  CHECK_STATUS_VOID(*status);
+
 //puts("write event.");
   fits_write_col(file->fptr, TDOUBLE, file->ctime, row,
 		 1, 1, &event->time, status);
@@ -422,6 +712,191 @@ void updateEventInFile(const EventFile* const file,
 }
 
 
+void readEventColumns(EventFile* const file, const unsigned int columns,
+		      const long firstrow, const long nrows,
+		      Event* const events, int* const status)
+{
+  CHECK_NULL_VOID(file, *status, "event file not open");
+  CHECK_NULL_VOID(file->fptr, *status, "event file not open");
+
+  if ((firstrow<1)||(firstrow+nrows-1>file->nrows)) {
+    *status=EXIT_FAILURE;
+    SIXT_ERROR("event file contains no further entries");
+    return;
+  }
+
+  // All rows have to be in the FITS file.
+  flushEventFile(file, status);
+  CHECK_STATUS_VOID(*status);
+  SIXT_PROF_COUNT(SIXT_PROF_ROWS_READ, nrows);
+
+  void* colbuffer=getEventColBuffer(file, status);
+  CHECK_STATUS_VOID(*status);
+  double* dbuffer=(double*)colbuffer;
+  float* fbuffer=(float*)colbuffer;
+  long* lbuffer=(long*)colbuffer;
+  int* ibuffer=(int*)colbuffer;
+
+  int anynul=0;
+  double dnull=0.;
+  float fnull=0.;
+  long lnull=0;
+  int inull=0;
+
+  // Transfer the columns in chunks fitting into the scratch buffer.
+  long first;
+  for (first=0; first<nrows; first+=EVENTFILE_BUFFERSIZE) {
+    const long row=firstrow+first;
+    const long n=MIN(EVENTFILE_BUFFERSIZE, nrows-first);
+    Event* const ev=&events[first];
+    long ii, jj;
+
+    if (columns&EVENTCOL_TIME) {
+      fits_read_col(file->fptr, TDOUBLE, file->ctime, row, 1, n,
+		    &dnull, dbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) ev[ii].time=dbuffer[ii];
+    }
+    if (columns&EVENTCOL_FRAME) {
+      fits_read_col(file->fptr, TLONG, file->cframe, row, 1, n,
+		    &lnull, lbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) ev[ii].frame=lbuffer[ii];
+    }
+    if (columns&EVENTCOL_PHA) {
+      fits_read_col(file->fptr, TLONG, file->cpha, row, 1, n,
+		    &lnull, lbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) ev[ii].pha=lbuffer[ii];
+    }
+    if (columns&EVENTCOL_SIGNAL) {
+      fits_read_col(file->fptr, TFLOAT, file->csignal, row, 1, n,
+		    &fnull, fbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) ev[ii].signal=fbuffer[ii];
+    }
+    if (columns&EVENTCOL_RAWX) {
+      fits_read_col(file->fptr, TINT, file->crawx, row, 1, n,
+		    &inull, ibuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) ev[ii].rawx=ibuffer[ii];
+    }
+    if (columns&EVENTCOL_RAWY) {
+      fits_read_col(file->fptr, TINT, file->crawy, row, 1, n,
+		    &inull, ibuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) ev[ii].rawy=ibuffer[ii];
+    }
+    if (columns&EVENTCOL_RA) {
+      fits_read_col(file->fptr, TDOUBLE, file->cra, row, 1, n,
+		    &dnull, dbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) {
+	ev[ii].ra=dbuffer[ii];
+	ev[ii].ra*=M_PI/180.;
+      }
+    }
+    if (columns&EVENTCOL_DEC) {
+      fits_read_col(file->fptr, TDOUBLE, file->cdec, row, 1, n,
+		    &dnull, dbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) {
+	ev[ii].dec=dbuffer[ii];
+	ev[ii].dec*=M_PI/180.;
+      }
+    }
+    if (columns&EVENTCOL_PH_ID) {
+      fits_read_col(file->fptr, TLONG, file->cph_id, row, 1,
+		    n*NEVENTPHOTONS, &lnull, lbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) {
+	for (jj=0; jj<NEVENTPHOTONS; jj++) {
+	  ev[ii].ph_id[jj]=lbuffer[ii*NEVENTPHOTONS+jj];
+	}
+      }
+    }
+    if (columns&EVENTCOL_SRC_ID) {
+      fits_read_col(file->fptr, TLONG, file->csrc_id, row, 1,
+		    n*NEVENTPHOTONS, &lnull, lbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) {
+	for (jj=0; jj<NEVENTPHOTONS; jj++) {
+	  ev[ii].src_id[jj]=lbuffer[ii*NEVENTPHOTONS+jj];
+	}
+      }
+    }
+    if (columns&EVENTCOL_NPIXELS) {
+      fits_read_col(file->fptr, TLONG, file->cnpixels, row, 1, n,
+		    &lnull, lbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) ev[ii].npixels=lbuffer[ii];
+    }
+    if (columns&EVENTCOL_TYPE) {
+      fits_read_col(file->fptr, TINT, file->ctype, row, 1, n,
+		    &inull, ibuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) ev[ii].type=ibuffer[ii];
+    }
+    if (columns&EVENTCOL_PILEUP) {
+      fits_read_col(file->fptr, TINT, file->cpileup, row, 1, n,
+		    &inull, ibuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) ev[ii].pileup=ibuffer[ii];
+    }
+    if (columns&EVENTCOL_SIGNALS) {
+      fits_read_col(file->fptr, TFLOAT, file->csignals, row, 1, n*9,
+		    &fnull, fbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) {
+	for (jj=0; jj<9; jj++) {
+	  ev[ii].signals[jj]=fbuffer[ii*9+jj];
+	}
+      }
+    }
+    if (columns&EVENTCOL_PHAS) {
+      fits_read_col(file->fptr, TLONG, file->cphas, row, 1, n*9,
+		    &lnull, lbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) {
+	for (jj=0; jj<9; jj++) {
+	  ev[ii].phas[jj]=lbuffer[ii*9+jj];
+	}
+      }
+    }
+    if ((columns&EVENTCOL_PI)&&(file->cpi>0)) {
+      fits_read_col(file->fptr, TLONG, file->cpi, row, 1, n,
+		    &lnull, lbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) ev[ii].pi=lbuffer[ii];
+    }
+    CHECK_STATUS_VOID(*status);
+
+    // Check if an error occurred during the reading process.
+    if (0!=anynul) {
+      *status=EXIT_FAILURE;
+      SIXT_ERROR("reading from EventFile failed");
+      return;
+    }
+  }
+}
+
+
+void writeEventColumns(EventFile* const file, const unsigned int columns,
+		       const long firstrow, const long nrows,
+		       const Event* const events, int* const status)
+{
+  CHECK_NULL_VOID(file, *status, "event file not open");
+  CHECK_NULL_VOID(file->fptr, *status, "event file not open");
+
+  if ((firstrow<1)||(firstrow+nrows-1>file->nrows)) {
+    *status=EXIT_FAILURE;
+    SIXT_ERROR("event file contains no further entries");
+    return;
+  }
+
+  // Buffered rows would overwrite the changes later on.
+  flushEventFile(file, status);
+  CHECK_STATUS_VOID(*status);
+
+  const Event* ev[EVENTFILE_BUFFERSIZE];
+  long first;
+  for (first=0; first<nrows; first+=EVENTFILE_BUFFERSIZE) {
+    const long n=MIN(EVENTFILE_BUFFERSIZE, nrows-first);
+    long ii;
+    for (ii=0; ii<n; ii++) {
+      ev[ii]=&events[first+ii];
+    }
+    writeEventRows(file, columns, firstrow+first, n, ev, status);
+    CHECK_STATUS_VOID(*status);
+  }
+  SIXT_PROF_COUNT(SIXT_PROF_ROWS_WRITTEN, nrows);
+}
+
+
 void copyEventFile(const EventFile* const src,
 		   EventFile* const dest,
 		   const float threshold_lo_keV,
@@ -435,6 +910,9 @@ void copyEventFile(const EventFile* const src,
     return;
   }
 
+  syncEventFile(src, status);
+  CHECK_STATUS_VOID(*status);
+
   // Copy the event type.
   char evtype[MAXMSG], comment[MAXMSG];
   fits_read_key(src->fptr, TSTRING, "EVTYPE", evtype, comment, status);
@@ -445,34 +923,30 @@ void copyEventFile(const EventFile* const src,
   fits_update_key(dest->fptr, TSTRING, "EVTYPE", evtype, comment, status);
   CHECK_STATUS_VOID(*status);
 
-  // Get memory for buffers.
-  Event* event=getEvent(status);
-  CHECK_STATUS_VOID(*status);
+  Event event;
+  clearEvent(&event);
 
   // Loop over all rows in the event file.
   long row;
   for (row=0; row<src->nrows; row++) {
 
     // Read an event from the input list.
-    getEventFromFile(src, row+1, event, status);
+    getEventFromFile(src, row+1, &event, status);
     CHECK_STATUS_BREAK(*status);
 
     // Apply the lower event threshold.
-    if (event->signal<threshold_lo_keV) {
+    if (event.signal<threshold_lo_keV) {
       continue;
     }
 
     // Apply the upper event threshold.
-    if ((threshold_up_keV>0.0)&&(event->signal>threshold_up_keV)) {
+    if ((threshold_up_keV>0.0)&&(event.signal>threshold_up_keV)) {
       continue;
     }
 
     // Add the new event to the output file.
-    addEvent2File(dest, event, status);
+    addEvent2File(dest, &event, status);
     CHECK_STATUS_BREAK(*status);
   }
   CHECK_STATUS_VOID(*status);
-
-  // Free memory.
-  freeEvent(&event);
 }
@@ -24,7 +24,39 @@
 #define EVENTFILE_H 1
 
 #include "sixt.h"
+#include "profiling.h"
 #include "event.h"
+#include "fitswriter.h"
+
+
+/** Number of events that are collected by addEvent2File() before
+    they are written to the FITS file in one block. */
+#define EVENTFILE_BUFFERSIZE (1024)
+
+/** Number of blocks of EVENTFILE_BUFFERSIZE events that can be
+    queued for the background writer. */
+#define EVENTFILE_WRITERBLOCKS (4)
+
+/** Columns of the event table, which can be selected for the
+    transfer of blocks of events with readEventColumns() and
+    writeEventColumns(). */
+#define EVENTCOL_TIME    (1u<<0)
+#define EVENTCOL_FRAME   (1u<<1)
+#define EVENTCOL_PHA     (1u<<2)
+#define EVENTCOL_SIGNAL  (1u<<3)
+#define EVENTCOL_RAWX    (1u<<4)
+#define EVENTCOL_RAWY    (1u<<5)
+#define EVENTCOL_RA      (1u<<6)
+#define EVENTCOL_DEC     (1u<<7)
+#define EVENTCOL_PH_ID   (1u<<8)
+#define EVENTCOL_SRC_ID  (1u<<9)
+#define EVENTCOL_NPIXELS (1u<<10)
+#define EVENTCOL_TYPE    (1u<<11)
+#define EVENTCOL_PILEUP  (1u<<12)
+#define EVENTCOL_SIGNALS (1u<<13)
+#define EVENTCOL_PHAS    (1u<<14)
+#define EVENTCOL_PI      (1u<<15)
+#define EVENTCOL_ALL     ((1u<<16)-1)
 
 
 /////////////////////////////////////////////////////////////////
@@ -44,6 +76,23 @@ typedef struct {
   int ctime, cframe, cpha, cpi, csignal, crawx, crawy, cra, cdec,
     cph_id, csrc_id, cnpixels, ctype, cpileup, csignals, cphas;
 
+  /** Events that have been appended with addEvent2File(), but not
+      written to the FITS file yet. They occupy the last nbuffer rows
+      counted in nrows. */
+  Event* buffer;
+  long nbuffer;
+
+  /** Scratch memory for the transfer of a single column of the
+      buffered events. */
+  void* colbuffer;
+
+  /** Number of the HDU containing the event table. */
+  int hdunum;
+
+  /** Background writer (NULL if the blocks are written directly),
+      see startEventFileWriter(). */
+  FitsWriter* writer;
+
 } EventFile;
 
 
@@ -91,11 +140,30 @@ void addCol2EventFile(EventFile* const file,
 		char* const tform, char* const tunit,
 		int* const status);
 
-/** Append a new event to the event file. */
+/** Append a new event to the event file. The event is copied to an
+    internal buffer, which is written to the file as a block of
+    EVENTFILE_BUFFERSIZE rows. The buffer is flushed automatically
+    before any other access to the rows of the file and when the file
+    is closed. Buffered events can be accessed with getEventFromFile()
+    and updateEventInFile() like any other row. */
 void addEvent2File(EventFile* const file,
-		   Event* const event,
+		   const Event* const event,
 		   int* const status);
 
+/** Write all events that are still kept in the buffer of
+    addEvent2File() to the FITS file. */
+void flushEventFile(EventFile* const file, int* const status);
+
+/** Write the blocks of addEvent2File() with a FitsWriter. If
+    'threaded' is non-zero and CFITSIO is thread-safe, they are
+    written by a background thread, while the simulation
+    continues. The FITS file must not be accessed directly (via
+    'fptr') afterwards without calling flushEventFile() before. The
+    other functions of this module take care of that
+    themselves. */
+void startEventFileWriter(EventFile* const file, const int threaded,
+			  int* const status);
+
 /** Read the Event at the specified row from the file. The
     numbering for the rows starts at 1 for the first line. */
 void getEventFromFile(const EventFile* const file,
@@ -108,6 +176,22 @@ void updateEventInFile(const EventFile* const file,
 		       const int row, Event* const event,
 		       int* const status);
 
+/** Read the selected columns (EVENTCOL_*) of 'nrows' rows starting
+    at 'firstrow' into events[0..nrows-1] with one access per column
+    and block of EVENTFILE_BUFFERSIZE rows. The other members of the
+    events are not modified. The PI column is skipped, if the file
+    does not contain it. */
+void readEventColumns(EventFile* const file, const unsigned int columns,
+		      const long firstrow, const long nrows,
+		      Event* const events, int* const status);
+
+/** Write the selected columns (EVENTCOL_*) of events[0..nrows-1] to
+    the existing rows starting at 'firstrow'. The other columns of the
+    rows remain unchanged. */
+void writeEventColumns(EventFile* const file, const unsigned int columns,
+		       const long firstrow, const long nrows,
+		       const Event* const events, int* const status);
+
 /** Fill the destination EventFile with data from the source
     EventFile. The specified thesholds are applied to the transferred
     events. */
@@ -0,0 +1,106 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                  Erlangen-Nuernberg
+*/
+
+#include "eventtransform.h"
+
+
+EventTransform* newEventTransform(EventTransformFct fct,
+				  EventTransformFreeFct freedata,
+				  void* const data,
+				  const unsigned int incols,
+				  const unsigned int outcols,
+				  int* const status)
+{
+  EventTransform* transform=(EventTransform*)malloc(sizeof(EventTransform));
+  CHECK_MALLOC_RET_NULL_STATUS(transform, *status);
+
+  transform->fct=fct;
+  transform->freedata=freedata;
+  transform->data=data;
+  transform->incols=incols;
+  transform->outcols=outcols;
+
+  return(transform);
+}
+
+
+void freeEventTransform(EventTransform** const transform)
+{
+  if (NULL!=*transform) {
+    if ((NULL!=(*transform)->freedata)&&(NULL!=(*transform)->data)) {
+      (*transform)->freedata((*transform)->data);
+    }
+    free(*transform);
+    *transform=NULL;
+  }
+}
+
+
+void runEventTransforms(EventFile* const file,
+			EventTransform* const* const transforms,
+			const int ntransforms,
+			int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+  CHECK_NULL_VOID(file, *status, "event file not open");
+
+  // Columns that have to be read and written for all transforms.
+  unsigned int incols=0, outcols=0;
+  int ii;
+  for (ii=0; ii<ntransforms; ii++) {
+    incols|=transforms[ii]->incols;
+    outcols|=transforms[ii]->outcols;
+  }
+
+  // Buffered events have to be in the FITS file.
+  flushEventFile(file, status);
+  CHECK_STATUS_VOID(*status);
+
+  const long blocksize=MIN(EVENTTRANSFORM_BLOCKSIZE, MAX(file->nrows, 1));
+  Event* events=(Event*)malloc(blocksize*sizeof(Event));
+  CHECK_MALLOC_VOID_STATUS(events, *status);
+  long jj;
+  for (jj=0; jj<blocksize; jj++) {
+    clearEvent(&events[jj]);
+  }
+
+  long firstrow;
+  for (firstrow=1; firstrow<=file->nrows; firstrow+=blocksize) {
+    const long n=MIN(blocksize, file->nrows-firstrow+1);
+
+    readEventColumns(file, incols, firstrow, n, events, status);
+    CHECK_STATUS_BREAK(*status);
+
+    for (ii=0; ii<ntransforms; ii++) {
+      transforms[ii]->fct(file, firstrow, events, n,
+			  transforms[ii]->data, status);
+      CHECK_STATUS_BREAK(*status);
+    }
+    CHECK_STATUS_BREAK(*status);
+
+    if (0!=outcols) {
+      writeEventColumns(file, outcols, firstrow, n, events, status);
+      CHECK_STATUS_BREAK(*status);
+    }
+  }
+
+  free(events);
+}
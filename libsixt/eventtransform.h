@@ -0,0 +1,100 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                  Erlangen-Nuernberg
+*/
+
+#ifndef EVENTTRANSFORM_H
+#define EVENTTRANSFORM_H 1
+
+#include "sixt.h"
+#include "event.h"
+#include "eventfile.h"
+
+
+/** Number of events that are processed as one block by
+    runEventTransforms(). */
+#define EVENTTRANSFORM_BLOCKSIZE (16384)
+
+
+/////////////////////////////////////////////////////////////////
+// Type Declarations.
+/////////////////////////////////////////////////////////////////
+
+
+/** Function transforming the events of the rows 'firstrow' to
+    'firstrow+nevents-1' of the event file. Only the input columns
+    of the transform (and of the transforms before it) are set in
+    'events'. Columns that are not part of the Event data structure
+    can be written directly to the file for these rows. 'data' is the
+    pointer given to newEventTransform(). */
+typedef void (*EventTransformFct)(EventFile* const file,
+				  const long firstrow,
+				  Event* const events,
+				  const long nevents,
+				  void* const data,
+				  int* const status);
+
+/** Destructor for the data of a transform. */
+typedef void (*EventTransformFreeFct)(void* const data);
+
+
+/** Operation that is applied to all events in an event file, such
+    as the PHA to PI correction. Only the columns it needs are read
+    and only the columns it changes are written back. */
+typedef struct {
+  EventTransformFct fct;
+  EventTransformFreeFct freedata;
+  void* data;
+
+  /** Columns (EVENTCOL_*) that are read and changed by the
+      transform. */
+  unsigned int incols, outcols;
+} EventTransform;
+
+
+/////////////////////////////////////////////////////////////////
+// Function Declarations.
+/////////////////////////////////////////////////////////////////
+
+
+/** Constructor. The transform takes the ownership of 'data', which
+    is released with 'freedata' (if not NULL) by the destructor. */
+EventTransform* newEventTransform(EventTransformFct fct,
+				  EventTransformFreeFct freedata,
+				  void* const data,
+				  const unsigned int incols,
+				  const unsigned int outcols,
+				  int* const status);
+
+/** Destructor. */
+void freeEventTransform(EventTransform** const transform);
+
+/** Apply the transforms to all events in the file in a single pass
+    over blocks of EVENTTRANSFORM_BLOCKSIZE rows. The transforms are
+    applied one after another to each block, so a transform sees the
+    changes of the ones before, as if they were run separately. The
+    columns needed by any transform are read once per block, and the
+    columns changed by any of them are written back. */
+void runEventTransforms(EventFile* const file,
+			EventTransform* const* const transforms,
+			const int ntransforms,
+			int* const status);
+
+
+#endif /* EVENTTRANSFORM_H */
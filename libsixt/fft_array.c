@@ -21,7 +21,172 @@
 
 #include "fft_array.h"
 
-fftw_complex* FFTOfArray_1d(double* Image1d, int ImageSize1, int ImageSize2, int type)
+//kinds of transforms that are cached
+enum {
+  FFT_C2C_FORWARD,
+  FFT_C2C_BACKWARD,
+  FFT_R2C,
+  FFT_C2R
+};
+
+//FFTW plan for a particular size and kind of transform; the plan is applied
+//to the actual arrays via the new-array execute functions of FFTW
+typedef struct {
+  int kind;
+  int n0, n1;
+  fftw_plan plan;
+} FFTPlanCacheEntry;
+
+static FFTPlanCacheEntry plan_cache[FFT_PLAN_CACHE_SIZE];
+static int nplans=0;
+//index of the entry that is replaced next, if the cache is full
+static int nextplan=0;
+static unsigned plan_flags=FFTW_ESTIMATE;
+
+
+static int isWisdomFile(const char* const wisdomfile)
+{
+  if ((NULL==wisdomfile)||(0==strlen(wisdomfile))) {
+    return(0);
+  }
+  char buffer[MAXFILENAME];
+  strncpy(buffer, wisdomfile, MAXFILENAME-1);
+  buffer[MAXFILENAME-1]='\0';
+  strtoupper(buffer);
+  return(0!=strcmp(buffer, "NONE"));
+}
+
+
+void initFFTPlans(const char* const wisdomfile, const int nthreads, int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+
+  if (nthreads>1) {
+#ifdef HAVE_FFTW3_THREADS
+    if (0==fftw_init_threads()) {
+      SIXT_ERROR("initialization of FFTW threads failed");
+      *status=EXIT_FAILURE;
+      return;
+    }
+    fftw_plan_with_nthreads(nthreads);
+#else
+    SIXT_WARNING("FFTW threads library not available, using a single thread");
+#endif
+  }
+
+  if (isWisdomFile(wisdomfile)) {
+    // A missing wisdom file is not an error, as it is created
+    // by freeFFTPlans.
+    FILE* file=fopen(wisdomfile, "r");
+    if (NULL!=file) {
+      if (0==fftw_import_wisdom_from_file(file)) {
+	char msg[MAXMSG];
+	sprintf(msg, "could not import FFTW wisdom from '%s'", wisdomfile);
+	SIXT_WARNING(msg);
+      }
+      fclose(file);
+    }
+    plan_flags=FFTW_MEASURE;
+  }
+}
+
+
+void freeFFTPlans(const char* const wisdomfile, int* const status)
+{
+  if (isWisdomFile(wisdomfile)) {
+    FILE* file=fopen(wisdomfile, "w");
+    if (NULL!=file) {
+      fftw_export_wisdom_to_file(file);
+      fclose(file);
+    } else {
+      char msg[MAXMSG];
+      sprintf(msg, "could not write FFTW wisdom to '%s'", wisdomfile);
+      SIXT_ERROR(msg);
+      *status=EXIT_FAILURE;
+    }
+  }
+
+  int ii;
+  for(ii=0; ii<nplans; ii++){
+    fftw_destroy_plan(plan_cache[ii].plan);
+  }
+  nplans=0;
+  nextplan=0;
+  plan_flags=FFTW_ESTIMATE;
+}
+
+
+//returns the cached plan for the given transform or creates a new one; the
+//plan is created for temporary arrays, such that planning with FFTW_MEASURE
+//does not overwrite the data
+static fftw_plan getFFTPlan(const int kind, const int n0, const int n1)
+{
+  int ii;
+  for(ii=0; ii<nplans; ii++){
+    if ((plan_cache[ii].kind==kind)&&(plan_cache[ii].n0==n0)&&(plan_cache[ii].n1==n1)) {
+      return(plan_cache[ii].plan);
+    }
+  }
+
+  const size_t nreal=(size_t)n0*n1;
+  const size_t ncomplex=(size_t)n0*(n1/2+1);
+  fftw_plan plan=NULL;
+  fftw_complex* cin=NULL;
+  fftw_complex* cout=NULL;
+  double* rbuf=NULL;
+  switch (kind) {
+  case FFT_C2C_FORWARD:
+  case FFT_C2C_BACKWARD:
+    cin=(fftw_complex*) fftw_malloc(sizeof(fftw_complex)*nreal);
+    cout=(fftw_complex*) fftw_malloc(sizeof(fftw_complex)*nreal);
+    if ((NULL!=cin)&&(NULL!=cout)) {
+      plan=fftw_plan_dft_2d(n0, n1, cin, cout,
+			    (FFT_C2C_FORWARD==kind) ? FFTW_FORWARD : FFTW_BACKWARD,
+			    plan_flags);
+    }
+    break;
+  case FFT_R2C:
+    rbuf=(double*) fftw_malloc(sizeof(double)*nreal);
+    cout=(fftw_complex*) fftw_malloc(sizeof(fftw_complex)*ncomplex);
+    if ((NULL!=rbuf)&&(NULL!=cout)) {
+      plan=fftw_plan_dft_r2c_2d(n0, n1, rbuf, cout, plan_flags);
+    }
+    break;
+  case FFT_C2R:
+    cin=(fftw_complex*) fftw_malloc(sizeof(fftw_complex)*ncomplex);
+    rbuf=(double*) fftw_malloc(sizeof(double)*nreal);
+    if ((NULL!=cin)&&(NULL!=rbuf)) {
+      plan=fftw_plan_dft_c2r_2d(n0, n1, cin, rbuf, plan_flags);
+    }
+    break;
+  }
+  if (NULL!=cin) fftw_free(cin);
+  if (NULL!=cout) fftw_free(cout);
+  if (NULL!=rbuf) fftw_free(rbuf);
+  if (NULL==plan) {
+    return(NULL);
+  }
+
+  // Replace the oldest plan, if the cache is full.
+  if (nplans<FFT_PLAN_CACHE_SIZE) {
+    ii=nplans++;
+  } else {
+    ii=nextplan;
+    nextplan=(nextplan+1)%FFT_PLAN_CACHE_SIZE;
+    fftw_destroy_plan(plan_cache[ii].plan);
+  }
+  plan_cache[ii].kind=kind;
+  plan_cache[ii].n0=n0;
+  plan_cache[ii].n1=n1;
+  plan_cache[ii].plan=plan;
+
+  return(plan);
+}
+
+
+
+fftw_complex* FFTOfArray_1d(double* Image1d, int ImageSize1, int ImageSize2, int type,
+			    int* const status)
 {
   fftw_complex* Input;
   fftw_complex* Output;
@@ -31,6 +196,13 @@ fftw_complex* FFTOfArray_1d(double* Image1d, int ImageSize1, int ImageSize2, int
   //Memory-Allocation
   Input=(fftw_complex*) fftw_malloc(sizeof(fftw_complex)*ImageSize1*ImageSize2);
   Output=(fftw_complex*) fftw_malloc(sizeof(fftw_complex)*ImageSize1*ImageSize2);
+  if ((NULL==Input)||(NULL==Output)) {
+    if (NULL!=Input) fftw_free(Input);
+    if (NULL!=Output) fftw_free(Output);
+    SIXT_ERROR("memory allocation for FFT arrays failed");
+    *status=EXIT_FAILURE;
+    return(NULL);
+  }
 
   //Copy Image1d of type double to Input-Array of type fftw_complex
 
@@ -41,18 +213,26 @@ fftw_complex* FFTOfArray_1d(double* Image1d, int ImageSize1, int ImageSize2, int
     }
   }
 
-  plan=fftw_plan_dft_2d(ImageSize1, ImageSize2, Input, Output, type, FFTW_ESTIMATE);
+  plan=getFFTPlan((FFTW_FORWARD==type) ? FFT_C2C_FORWARD : FFT_C2C_BACKWARD,
+		   ImageSize1, ImageSize2);
+  if (NULL==plan) {
+    fftw_free(Input);
+    fftw_free(Output);
+    SIXT_ERROR("creation of FFTW plan failed");
+    *status=EXIT_FAILURE;
+    return(NULL);
+  }
 
-  fftw_execute(plan);
+  fftw_execute_dft(plan, Input, Output);
 
-  fftw_destroy_plan(plan);
   fftw_free(Input);
 
   return(Output);
 }
 
 
-fftw_complex* FFTOfArray(fftw_complex* Input, int ImageSize1, int ImageSize2, int type)
+fftw_complex* FFTOfArray(fftw_complex* Input, int ImageSize1, int ImageSize2, int type,
+			 int* const status)
 {
   fftw_complex* Output;
   fftw_plan plan;
@@ -60,11 +240,77 @@ fftw_complex* FFTOfArray(fftw_complex* Input, int ImageSize1, int ImageSize2, in
   //Memory-Allocation
   Output=(fftw_complex*) fftw_malloc(sizeof(fftw_complex)*ImageSize1*ImageSize2);
 
-  plan=fftw_plan_dft_2d(ImageSize1, ImageSize2, Input, Output, type, FFTW_ESTIMATE);
+  plan=getFFTPlan((FFTW_FORWARD==type) ? FFT_C2C_FORWARD : FFT_C2C_BACKWARD,
+		   ImageSize1, ImageSize2);
+  if ((NULL==Output)||(NULL==plan)) {
+    if (NULL!=Output) fftw_free(Output);
+    fftw_free(Input);
+    SIXT_ERROR("FFT of array failed");
+    *status=EXIT_FAILURE;
+    return(NULL);
+  }
+
+  fftw_execute_dft(plan, Input, Output);
+
+  fftw_free(Input);
+
+  return(Output);
+}
+
+
+fftw_complex* FFTOfArray_r2c(const double* Image1d, int ImageSize1, int ImageSize2,
+			     int* const status)
+{
+  fftw_complex* Output;
+  fftw_plan plan;
+
+  //Memory-Allocation
+  Output=(fftw_complex*) fftw_malloc(sizeof(fftw_complex)*ImageSize1*(ImageSize2/2+1));
+
+  plan=getFFTPlan(FFT_R2C, ImageSize1, ImageSize2);
+  if ((NULL==Output)||(NULL==plan)) {
+    if (NULL!=Output) fftw_free(Output);
+    SIXT_ERROR("real-to-complex FFT of array failed");
+    *status=EXIT_FAILURE;
+    return(NULL);
+  }
+
+  //the plan requires the same alignment as the arrays it has been created for,
+  //which is only guaranteed for memory obtained from fftw_malloc
+  if (0==fftw_alignment_of((double*)Image1d)) {
+    fftw_execute_dft_r2c(plan, (double*)Image1d, Output);
+  } else {
+    double* Input=(double*) fftw_malloc(sizeof(double)*ImageSize1*ImageSize2);
+    memcpy(Input, Image1d, sizeof(double)*ImageSize1*ImageSize2);
+    fftw_execute_dft_r2c(plan, Input, Output);
+    fftw_free(Input);
+  }
+
+  return(Output);
+}
+
+
+double* FFTOfArray_c2r(fftw_complex* Input, int ImageSize1, int ImageSize2,
+		       int* const status)
+{
+  double* Output;
+  fftw_plan plan;
+
+  //Memory-Allocation
+  Output=(double*) fftw_malloc(sizeof(double)*ImageSize1*ImageSize2);
+
+  plan=getFFTPlan(FFT_C2R, ImageSize1, ImageSize2);
+  if ((NULL==Output)||(NULL==plan)) {
+    if (NULL!=Output) fftw_free(Output);
+    fftw_free(Input);
+    SIXT_ERROR("complex-to-real FFT of array failed");
+    *status=EXIT_FAILURE;
+    return(NULL);
+  }
 
-  fftw_execute(plan);
+  //the multi-dimensional c2r transform overwrites its input
+  fftw_execute_dft_c2r(plan, Input, Output);
 
-  fftw_destroy_plan(plan);
   fftw_free(Input);
 
   return(Output);
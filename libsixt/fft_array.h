@@ -25,6 +25,9 @@
 #include "sixt.h"
 #include "fftw3.h"
 
+/** Maximum number of FFTW plans that are kept for re-use. */
+#define FFT_PLAN_CACHE_SIZE (16)
+
 ////////////////////////////////////////////////////////////////////////
 // Type Declarations.
 ////////////////////////////////////////////////////////////////////////
@@ -34,12 +37,40 @@
 // Function Declarations.
 /////////////////////////////////////////////////////////////////////
 
+//sets up the FFTW plans: if a wisdom file is given (not NULL, empty or 'none'),
+//previously accumulated wisdom is imported from it and the plans are measured
+//instead of estimated; with nthreads>1 the transforms are distributed over
+//several threads, if SIXTE has been linked against the FFTW threads library.
+//Calling this function is optional.
+void initFFTPlans(const char* const wisdomfile, const int nthreads, int* const status);
+
+//destroys all cached plans and exports the accumulated wisdom to the given file
+void freeFFTPlans(const char* const wisdomfile, int* const status);
+
+//all transforms return NULL and set the status to EXIT_FAILURE, if the memory
+//allocation or the creation of the FFTW plan fails
+
 //performs a fft of an input array which has to be in row-major format (1d-image)
 //type +1 equals FFTW_BAKWARD;type -1 equals FFTW_FORWARD
-fftw_complex* FFTOfArray_1d(double* Image1d, int ImageSize1, int ImageSize2, int type);
+fftw_complex* FFTOfArray_1d(double* Image1d, int ImageSize1, int ImageSize2, int type,
+			    int* const status);
 
 //performs a fft of an input array which is of type fftw_complex
 //type +1 equals FFTW_BAKWARD;type -1 equals FFTW_FORWARD
-fftw_complex* FFTOfArray(fftw_complex* Input, int ImageSize1, int ImageSize2, int type);
+fftw_complex* FFTOfArray(fftw_complex* Input, int ImageSize1, int ImageSize2, int type,
+			 int* const status);
+
+//performs a forward fft of a real-valued 1d-image with the same dimensions as
+//for FFTOfArray_1d, i.e., a row-major array of ImageSize1 rows with ImageSize2
+//entries each; only the ImageSize1*(ImageSize2/2+1) non-redundant complex
+//values are returned
+fftw_complex* FFTOfArray_r2c(const double* Image1d, int ImageSize1, int ImageSize2,
+			     int* const status);
+
+//performs the backward fft of the non-redundant half of a hermitian array as
+//returned by FFTOfArray_r2c; the result is real-valued and, as for FFTOfArray,
+//not normalized; the input array is released
+double* FFTOfArray_c2r(fftw_complex* Input, int ImageSize1, int ImageSize2,
+		       int* const status);
 
 #endif
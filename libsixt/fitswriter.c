@@ -0,0 +1,425 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                  Erlangen-Nuernberg
+*/
+
+#include "fitswriter.h"
+
+
+/** Alignment of the rows in the block buffers (bytes). */
+#define FITSWRITER_ALIGN (16)
+
+
+/** Pass an error of the writer to the producer. */
+static void checkFitsWriterStatus(const int wstatus, int* const status)
+{
+  if ((EXIT_SUCCESS==*status)&&(EXIT_SUCCESS!=wstatus)) {
+    *status=wstatus;
+    SIXT_ERROR("writing to FITS file failed");
+  }
+}
+
+
+/** Write a block, unless an error occurred before. Consecutive rows
+    of the same file are written with one call of its
+    FitsWriterFct. */
+static void writeFitsWriterBlock(FitsWriterBlock* const block,
+				 int* const status)
+{
+  long first=0;
+  while ((EXIT_SUCCESS==*status)&&(first<block->nrows)) {
+    FitsWriter* const writer=block->writer[first];
+    long last=first+1;
+    while ((last<block->nrows)&&(block->writer[last]==writer)&&
+	   (block->tablerow[last]==block->tablerow[first]+last-first)) {
+      last++;
+    }
+    writer->fct(writer->fptr, block->tablerow[first], last-first,
+		block->rows+first, writer->data, status);
+    first=last;
+  }
+  block->nrows=0;
+  block->used=0;
+}
+
+
+static void* fitsWriterThread(void* arg)
+{
+  FitsWriterPool* const pool=(FitsWriterPool*)arg;
+
+  pthread_mutex_lock(&pool->mutex);
+  while(1) {
+    while ((0==pool->nqueue)&&(0==pool->stop)) {
+      pthread_cond_wait(&pool->cond_queued, &pool->mutex);
+    }
+    if (0==pool->nqueue) break;
+
+    FitsWriterBlock* block=pool->queue[pool->qfirst];
+    pool->qfirst=(pool->qfirst+1)%pool->nblocks;
+    pool->nqueue--;
+    pool->busy=1;
+    int status=pool->status;
+    pthread_mutex_unlock(&pool->mutex);
+
+    // The FITS files are only accessed outside of the lock, such that
+    // the producer can continue to fill the next block.
+    writeFitsWriterBlock(block, &status);
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->status=status;
+    pool->unused[pool->nunused++]=block;
+    pool->busy=0;
+    pthread_cond_broadcast(&pool->cond_written);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+
+  return(NULL);
+}
+
+
+/** Hand the current block over to the writer. */
+static void submitFitsWriterBlock(FitsWriterPool* const pool, int* const status)
+{
+  FitsWriterBlock* block=pool->curr;
+  if (NULL==block) return;
+  pool->curr=NULL;
+
+  // The buffer is not reallocated any more, so the row pointers can
+  // be determined now.
+  long ii;
+  for (ii=0; ii<block->nrows; ii++) {
+    block->rows[ii]=block->buffer+block->offset[ii];
+  }
+
+  if (0==pool->threaded) {
+    writeFitsWriterBlock(block, &pool->status);
+    pool->unused[pool->nunused++]=block;
+    checkFitsWriterStatus(pool->status, status);
+  } else {
+    pthread_mutex_lock(&pool->mutex);
+    pool->queue[(pool->qfirst+pool->nqueue)%pool->nblocks]=block;
+    pool->nqueue++;
+    pthread_cond_signal(&pool->cond_queued);
+    checkFitsWriterStatus(pool->status, status);
+    pthread_mutex_unlock(&pool->mutex);
+  }
+}
+
+
+/** Get an unused block for the producer, waiting for the writer if
+    necessary. */
+static void nextFitsWriterBlock(FitsWriterPool* const pool, int* const status)
+{
+  if (0!=pool->threaded) {
+    pthread_mutex_lock(&pool->mutex);
+    while (0==pool->nunused) {
+      pthread_cond_wait(&pool->cond_written, &pool->mutex);
+    }
+    pool->curr=pool->unused[--pool->nunused];
+    checkFitsWriterStatus(pool->status, status);
+    pthread_mutex_unlock(&pool->mutex);
+  } else {
+    pool->curr=pool->unused[--pool->nunused];
+    checkFitsWriterStatus(pool->status, status);
+  }
+}
+
+
+FitsWriterPool* newFitsWriterPool(const size_t rowsize,
+				  const long blocksize,
+				  const int nblocks,
+				  const int threaded,
+				  int* const status)
+{
+  if ((blocksize<1)||(nblocks<1)) {
+    *status=EXIT_FAILURE;
+    SIXT_ERROR("invalid parameters for FITS writer");
+    return(NULL);
+  }
+
+  FitsWriterPool* pool=(FitsWriterPool*)malloc(sizeof(FitsWriterPool));
+  CHECK_MALLOC_RET_NULL_STATUS(pool, *status);
+
+  pool->blocksize=blocksize;
+  pool->nblocks=nblocks;
+  pool->curr=NULL;
+  pool->qfirst=0;
+  pool->nqueue=0;
+  pool->nunused=0;
+  pool->threaded=0;
+  pool->busy=0;
+  pool->stop=0;
+  pool->status=EXIT_SUCCESS;
+
+  pool->blocks=(FitsWriterBlock*)calloc(nblocks, sizeof(FitsWriterBlock));
+  pool->queue=(FitsWriterBlock**)malloc(nblocks*sizeof(FitsWriterBlock*));
+  pool->unused=(FitsWriterBlock**)malloc(nblocks*sizeof(FitsWriterBlock*));
+  if ((NULL==pool->blocks)||(NULL==pool->queue)||(NULL==pool->unused)) {
+    destroyFitsWriterPool(&pool, status);
+    *status=EXIT_FAILURE;
+    SIXT_ERROR("memory allocation for FITS writer failed");
+    return(NULL);
+  }
+
+  int ii;
+  for (ii=0; ii<nblocks; ii++) {
+    FitsWriterBlock* block=&pool->blocks[ii];
+    block->size=MAX(rowsize, 1)*blocksize;
+    block->buffer=(char*)malloc(block->size);
+    block->offset=(size_t*)malloc(blocksize*sizeof(size_t));
+    block->rows=(void**)malloc(blocksize*sizeof(void*));
+    block->writer=(FitsWriter**)malloc(blocksize*sizeof(FitsWriter*));
+    block->tablerow=(long*)malloc(blocksize*sizeof(long));
+    if ((NULL==block->buffer)||(NULL==block->offset)||(NULL==block->rows)||
+	(NULL==block->writer)||(NULL==block->tablerow)) {
+      destroyFitsWriterPool(&pool, status);
+      *status=EXIT_FAILURE;
+      SIXT_ERROR("memory allocation for FITS writer failed");
+      return(NULL);
+    }
+    pool->unused[pool->nunused++]=block;
+  }
+
+  if (0!=threaded) {
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->cond_queued, NULL);
+    pthread_cond_init(&pool->cond_written, NULL);
+    pool->threaded=1;
+    if (0!=pthread_create(&pool->thread, NULL, fitsWriterThread, pool)) {
+      // Continue without the thread.
+      pthread_mutex_destroy(&pool->mutex);
+      pthread_cond_destroy(&pool->cond_queued);
+      pthread_cond_destroy(&pool->cond_written);
+      pool->threaded=0;
+      SIXT_WARNING("could not start FITS writer thread, writing synchronously");
+    }
+  }
+
+  return(pool);
+}
+
+
+void destroyFitsWriterPool(FitsWriterPool** const pool, int* const status)
+{
+  if (NULL==*pool) return;
+
+  if (NULL!=(*pool)->blocks) {
+    // Write the remaining rows, even if an error occurred before.
+    int flush_status=EXIT_SUCCESS;
+    flushFitsWriterPool(*pool, &flush_status);
+    if (EXIT_SUCCESS==*status) {
+      *status=flush_status;
+    }
+  }
+
+  if (0!=(*pool)->threaded) {
+    pthread_mutex_lock(&(*pool)->mutex);
+    (*pool)->stop=1;
+    pthread_cond_signal(&(*pool)->cond_queued);
+    pthread_mutex_unlock(&(*pool)->mutex);
+    pthread_join((*pool)->thread, NULL);
+    pthread_mutex_destroy(&(*pool)->mutex);
+    pthread_cond_destroy(&(*pool)->cond_queued);
+    pthread_cond_destroy(&(*pool)->cond_written);
+  }
+
+  if (NULL!=(*pool)->blocks) {
+    int ii;
+    for (ii=0; ii<(*pool)->nblocks; ii++) {
+      free((*pool)->blocks[ii].buffer);
+      free((*pool)->blocks[ii].offset);
+      free((*pool)->blocks[ii].rows);
+      free((*pool)->blocks[ii].writer);
+      free((*pool)->blocks[ii].tablerow);
+    }
+    free((*pool)->blocks);
+  }
+  if (NULL!=(*pool)->queue) {
+    free((*pool)->queue);
+  }
+  if (NULL!=(*pool)->unused) {
+    free((*pool)->unused);
+  }
+  free(*pool);
+  *pool=NULL;
+}
+
+
+void flushFitsWriterPool(FitsWriterPool* const pool, int* const status)
+{
+  if (NULL==pool) return;
+
+  submitFitsWriterBlock(pool, status);
+
+  if (0!=pool->threaded) {
+    pthread_mutex_lock(&pool->mutex);
+    while ((pool->nqueue>0)||(0!=pool->busy)) {
+      pthread_cond_wait(&pool->cond_written, &pool->mutex);
+    }
+    checkFitsWriterStatus(pool->status, status);
+    pthread_mutex_unlock(&pool->mutex);
+  } else {
+    checkFitsWriterStatus(pool->status, status);
+  }
+}
+
+
+FitsWriter* newSharedFitsWriter(FitsWriterPool* const pool,
+				fitsfile* const fptr,
+				const long firstrow,
+				FitsWriterFct fct,
+				void* const data,
+				int* const status)
+{
+  if ((NULL==pool)||(NULL==fct)) {
+    *status=EXIT_FAILURE;
+    SIXT_ERROR("invalid parameters for FITS writer");
+    return(NULL);
+  }
+
+  FitsWriter* writer=(FitsWriter*)malloc(sizeof(FitsWriter));
+  CHECK_MALLOC_RET_NULL_STATUS(writer, *status);
+
+  writer->fptr=fptr;
+  writer->fct=fct;
+  writer->data=data;
+  writer->nextrow=firstrow;
+  writer->pool=pool;
+  writer->ownpool=0;
+
+  return(writer);
+}
+
+
+FitsWriter* newFitsWriter(fitsfile* const fptr,
+			  const long firstrow,
+			  const size_t rowsize,
+			  const long blocksize,
+			  const int nblocks,
+			  const int threaded,
+			  FitsWriterFct fct,
+			  void* const data,
+			  int* const status)
+{
+  if (NULL==fct) {
+    *status=EXIT_FAILURE;
+    SIXT_ERROR("invalid parameters for FITS writer");
+    return(NULL);
+  }
+
+  FitsWriterPool* pool=newFitsWriterPool(rowsize, blocksize, nblocks,
+					 threaded, status);
+  CHECK_STATUS_RET(*status, NULL);
+
+  FitsWriter* writer=newSharedFitsWriter(pool, fptr, firstrow, fct, data,
+					 status);
+  if (EXIT_SUCCESS!=*status) {
+    destroyFitsWriterPool(&pool, status);
+    return(NULL);
+  }
+  writer->ownpool=1;
+
+  return(writer);
+}
+
+
+void destroyFitsWriter(FitsWriter** const writer, int* const status)
+{
+  if (NULL==*writer) return;
+
+  // Write the remaining rows, even if an error occurred before. The
+  // rows of a shared pool may refer to the writer until then.
+  int flush_status=EXIT_SUCCESS;
+  if (0!=(*writer)->ownpool) {
+    destroyFitsWriterPool(&(*writer)->pool, &flush_status);
+  } else {
+    flushFitsWriterPool((*writer)->pool, &flush_status);
+  }
+  if (EXIT_SUCCESS==*status) {
+    *status=flush_status;
+  }
+
+  free(*writer);
+  *writer=NULL;
+}
+
+
+int getFitsWriterThreading(const int threaded)
+{
+  if (0==threaded) return(0);
+
+  if (0==fits_is_reentrant()) {
+    static int warned=0;
+    if (0==warned) {
+      headas_chat(3, "CFITSIO library is not thread-safe, output files are "
+		  "written without background thread\n");
+      warned=1;
+    }
+    return(0);
+  }
+  return(1);
+}
+
+
+void* addFitsWriterRow(FitsWriter* const writer, const size_t size,
+		       int* const status)
+{
+  CHECK_STATUS_RET(*status, NULL);
+
+  FitsWriterPool* const pool=writer->pool;
+
+  // Keep the rows aligned.
+  const size_t aligned=(size+FITSWRITER_ALIGN-1)/FITSWRITER_ALIGN*FITSWRITER_ALIGN;
+
+  if ((NULL!=pool->curr)&&
+      ((pool->curr->nrows==pool->blocksize)||
+       ((pool->curr->used+aligned>pool->curr->size)&&(pool->curr->nrows>0)))) {
+    submitFitsWriterBlock(pool, status);
+    CHECK_STATUS_RET(*status, NULL);
+  }
+  if (NULL==pool->curr) {
+    nextFitsWriterBlock(pool, status);
+    CHECK_STATUS_RET(*status, NULL);
+  }
+
+  // A single row exceeding the block buffer.
+  FitsWriterBlock* block=pool->curr;
+  if (block->used+aligned>block->size) {
+    char* buffer=(char*)realloc(block->buffer, aligned);
+    CHECK_MALLOC_RET_NULL_STATUS(buffer, *status);
+    block->buffer=buffer;
+    block->size=aligned;
+  }
+
+  void* row=block->buffer+block->used;
+  block->offset[block->nrows]=block->used;
+  block->writer[block->nrows]=writer;
+  block->tablerow[block->nrows]=writer->nextrow++;
+  block->nrows++;
+  block->used+=aligned;
+  return(row);
+}
+
+
+void flushFitsWriter(FitsWriter* const writer, int* const status)
+{
+  if (NULL==writer) return;
+
+  flushFitsWriterPool(writer->pool, status);
+}
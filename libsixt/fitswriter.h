@@ -0,0 +1,204 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                  Erlangen-Nuernberg
+*/
+
+#ifndef FITSWRITER_H
+#define FITSWRITER_H 1
+
+#include "sixt.h"
+
+#include <pthread.h>
+
+
+/////////////////////////////////////////////////////////////////
+// Type Declarations.
+/////////////////////////////////////////////////////////////////
+
+
+/** Function writing a block of rows to the FITS file. The rows are
+    the memory areas handed out by addFitsWriterRow() in the order of
+    the calls. They have to be written to the table rows starting at
+    'firstrow'. 'data' is the pointer given to newFitsWriter(). */
+typedef void (*FitsWriterFct)(fitsfile* const fptr,
+			      const long firstrow,
+			      const long nrows,
+			      void* const* const rows,
+			      void* const data,
+			      int* const status);
+
+
+/** Writer of a single FITS table (see below). */
+typedef struct FitsWriter FitsWriter;
+
+
+/** Block of rows that is filled by the producer and written as a
+    whole. The rows may belong to different files of the same
+    FitsWriterPool. */
+typedef struct {
+  /** Memory holding the rows one after another. */
+  char* buffer;
+  size_t size, used;
+
+  /** Offsets of the rows in the buffer and pointers to them (set
+      when the block is handed over to the writer). */
+  size_t* offset;
+  void** rows;
+
+  /** Writer and table row of each row. */
+  FitsWriter** writer;
+  long* tablerow;
+
+  /** Number of rows in the block. */
+  long nrows;
+} FitsWriterBlock;
+
+
+/** Blocks and background thread shared by one or several
+    FitsWriters. Full blocks are queued and the thread, which owns
+    the FITS files while it is active, writes them with the
+    FitsWriterFct of the respective file. At most 'nblocks' blocks
+    are in use, independent of the number of files, so the producer
+    is stalled, if the writer cannot keep up. Without the thread the
+    blocks are written by the producer itself when they are full. */
+typedef struct {
+  /** Maximum number of rows per block. */
+  long blocksize;
+
+  /** All blocks, the block currently filled by the producer (NULL if
+      none), the blocks that are ready to be written (FIFO), and the
+      unused ones (stack). */
+  FitsWriterBlock* blocks;
+  int nblocks;
+  FitsWriterBlock* curr;
+  FitsWriterBlock** queue;
+  int qfirst, nqueue;
+  FitsWriterBlock** unused;
+  int nunused;
+
+  /** Background thread. The members below are protected by the
+      mutex. */
+  int threaded;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond_queued, cond_written;
+
+  /** Non-zero while the thread writes a block or should terminate. */
+  int busy, stop;
+
+  /** First error that occurred in the writer. No further blocks are
+      written after an error. */
+  int status;
+} FitsWriterPool;
+
+
+/** Writer for a FITS table, to which the rows are appended in blocks
+    of a FitsWriterPool. The producer obtains the memory for each row
+    from addFitsWriterRow(). */
+struct FitsWriter {
+  /** FITS file and function writing the rows. */
+  fitsfile* fptr;
+  FitsWriterFct fct;
+  void* data;
+
+  /** Table row of the next row. */
+  long nextrow;
+
+  /** Pool writing the blocks, and whether it belongs to this writer
+      alone (see newFitsWriter()). */
+  FitsWriterPool* pool;
+  int ownpool;
+};
+
+
+/////////////////////////////////////////////////////////////////
+// Function Declarations.
+/////////////////////////////////////////////////////////////////
+
+
+/** Constructor of a pool of 'nblocks' blocks with at most
+    'blocksize' rows. 'rowsize' is the typical size of a row (for the
+    initial allocation). If 'threaded' is non-zero, the blocks are
+    written by a background thread. As other FITS files are usually
+    accessed in the meantime, this requires a thread-safe CFITSIO
+    library (see getFitsWriterThreading()). */
+FitsWriterPool* newFitsWriterPool(const size_t rowsize,
+				  const long blocksize,
+				  const int nblocks,
+				  const int threaded,
+				  int* const status);
+
+/** Destructor. Writes all remaining rows and terminates the
+    thread. The writers using the pool have to be destroyed before.
+    Errors of the writer are returned in 'status'. */
+void destroyFitsWriterPool(FitsWriterPool** const pool, int* const status);
+
+/** Write all rows of all files of the pool and wait until the
+    writer is idle. Errors of the writer are returned in 'status'. */
+void flushFitsWriterPool(FitsWriterPool* const pool, int* const status);
+
+/** Constructor of a writer with a pool of its own (see
+    newFitsWriterPool() for the parameters). The rows are appended to
+    the table starting at 'firstrow'. */
+FitsWriter* newFitsWriter(fitsfile* const fptr,
+			  const long firstrow,
+			  const size_t rowsize,
+			  const long blocksize,
+			  const int nblocks,
+			  const int threaded,
+			  FitsWriterFct fct,
+			  void* const data,
+			  int* const status);
+
+/** Constructor of a writer using the blocks and the thread of an
+    existing pool. This allows to write many files (e.g., one per
+    pixel) with a single thread and a fixed amount of memory. The
+    pool has to be used by a single producer. */
+FitsWriter* newSharedFitsWriter(FitsWriterPool* const pool,
+				fitsfile* const fptr,
+				const long firstrow,
+				FitsWriterFct fct,
+				void* const data,
+				int* const status);
+
+/** Destructor. Writes all remaining rows and, if the pool belongs
+    to the writer, terminates the thread. Errors of the writer are
+    returned in 'status'. */
+void destroyFitsWriter(FitsWriter** const writer, int* const status);
+
+/** Return the memory for the next row (of 'size' bytes). The row
+    has to be filled before the next call of any of the FitsWriter
+    functions. Returns NULL, if an error occurred, also if it occurred
+    in the writer thread before. */
+void* addFitsWriterRow(FitsWriter* const writer, const size_t size,
+		       int* const status);
+
+/** Return whether a background thread can be used for writing FITS
+    files, i.e., if it is requested ('threaded' non-zero) and the
+    CFITSIO library is thread-safe. */
+int getFitsWriterThreading(const int threaded);
+
+/** Write all rows and wait until the writer is idle. Afterwards the
+    FITS file can be accessed by the caller, until the next row is
+    added. For a shared pool, the rows of all its files are
+    written. Errors of the writer are returned in 'status'. */
+void flushFitsWriter(FitsWriter* const writer, int* const status);
+
+
+#endif /* FITSWRITER_H */
@@ -39,6 +39,9 @@ GenDet* newGenDet(int* const status) {
 	det->pixgrid = NULL;
 	det->split = NULL;
 	det->line = NULL;
+	det->lineoffset = 0;
+	det->chargedlines = NULL;
+	det->nchargedlines = 0;
 	det->pha2pi_filename = NULL;
 	det->pirmf_filename = NULL;
 	det->specarf_filename = NULL;
@@ -50,6 +53,9 @@ GenDet* newGenDet(int* const status) {
 	}
 	det->clocklist = NULL;
 	det->badpixmap = NULL;
+	det->auxbkg = NULL;
+	det->auxbkg_rng = NULL;
+	det->auxbkg_list = NULL;
 
 	// Set initial values.
 	det->ignore_bkg = 0;
@@ -95,6 +101,9 @@ void destroyGenDet(GenDet** const det) {
 			}
 			free((*det)->line);
 		}
+		if (NULL != (*det)->chargedlines) {
+			free((*det)->chargedlines);
+		}
 		if (NULL != (*det)->pha2pi_filename) {
 			free((*det)->pha2pi_filename);
 		}
@@ -116,6 +125,11 @@ void destroyGenDet(GenDet** const det) {
 		for (int ii = 0; ii < MAX_PHABKG; ii++) {
 			destroyPHABkg(&(*det)->phabkg[ii]);
 		}
+		destroyBkgGenerator(&(*det)->auxbkg);
+		if (NULL != (*det)->auxbkg_rng) {
+			gsl_rng_free((*det)->auxbkg_rng);
+		}
+		bkgFree((*det)->auxbkg_list);
 		if ((*det)->depfet.clear_const != NULL) {
 			free((*det)->depfet.clear_const);
 			(*det)->depfet.clear_const = NULL;
@@ -192,34 +206,43 @@ void GenDetLineShift(GenDet* const det) {
 	if (2 > det->pixgrid->ywidth)
 		return;
 
-	// Apply the Charge Transfer Efficiency.
-	int ii;
-	if (det->cte != 1.) {
-		for (ii = 1; ii < det->pixgrid->ywidth; ii++) {
-			if (0 != det->line[ii]->anycharge) {
-				int jj;
-				for (jj = 0; jj < det->line[ii]->xwidth; jj++) {
-					if (det->line[ii]->charge[jj] > 0.) {
-						det->line[ii]->charge[jj] *= det->cte;
-					}
+	// Apply the Charge Transfer Efficiency. Only the lines in the list
+	// of charged lines have to be regarded. Lines that do not contain
+	// any charges any more are removed from the list.
+	int ii, nn = 0;
+	for (ii = 0; ii < det->nchargedlines; ii++) {
+		GenDetLine* line = det->chargedlines[ii];
+		if ((0 == line->anycharge) || (line == det->line[0])) {
+			line->incharged = 0;
+			continue;
+		}
+		det->chargedlines[nn++] = line;
+		if (det->cte != 1.) {
+			int jj;
+			for (jj = 0; jj < line->noccupied; jj++) {
+				int xx = line->occupied[jj];
+				if (line->charge[xx] > 0.) {
+					line->charge[xx] *= det->cte;
 				}
 			}
 		}
 	}
+	det->nchargedlines = nn;
 
 	// Add the charges in line 1 to line 0.
-	addGenDetLine(det->line[0], det->line[1]);
+	GenDetLine* line1 = getGenDetLine(det, 1);
+	addGenDetLine(det->line[0], line1);
 
 	// Clear the charges in line 1, as they are now contained in line 0.
-	clearGenDetLine(det->line[1]);
+	clearGenDetLine(line1);
 
 	// Shift the other lines in increasing order and put the newly cleared
-	// original line number 1 at the end as the last line.
-	GenDetLine* buffer = det->line[1];
-	for (ii = 1; ii < det->pixgrid->ywidth - 1; ii++) {
-		det->line[ii] = det->line[ii + 1];
+	// original line number 1 at the end as the last line. This is done
+	// by advancing the start of the ring buffer.
+	det->lineoffset++;
+	if (det->lineoffset >= det->pixgrid->ywidth - 1) {
+		det->lineoffset = 0;
 	}
-	det->line[det->pixgrid->ywidth - 1] = buffer;
 }
 
 void setGenDetEventFile(GenDet* const det, EventFile* const elf) {
@@ -239,7 +262,7 @@ static inline void GenDetReadoutPixel(GenDet* const det, const int lineindex,
 		int* const status) {
 	headas_chat(5, "read out line %d as %d\n", lineindex, readoutindex);
 
-	GenDetLine* line = det->line[lineindex];
+	GenDetLine* line = getGenDetLine(det, lineindex);
 
 	// Check if an output event file is defined.
 	if (NULL == det->elf) {
@@ -249,17 +272,16 @@ static inline void GenDetReadoutPixel(GenDet* const det, const int lineindex,
 	}
 
 	if (line->charge[xindex] != 0. || line->ccarry[xindex] != 0.) {
-		Event* event = NULL;
+		// The event is only needed until it has been copied to the
+		// event file, so it is kept on the stack.
+		Event event;
+		clearEvent(&event);
 
 		// Error handling loop.
 		do {
 
-			// Determine the properties of a new Event object.
-			event = getEvent(status);
-			CHECK_STATUS_BREAK(*status);
-
 			// Readout the signal from the pixel array ...
-			event->signal = line->charge[xindex];
+			event.signal = line->charge[xindex];
 			// ... overwrite the charge with the carry charge for the next cycle...
 			line->charge[xindex] = line->ccarry[xindex];
 			// ... and delete the carry charge.
@@ -271,8 +293,8 @@ static inline void GenDetReadoutPixel(GenDet* const det, const int lineindex,
 			// Copy the information about the original photons.
 			int jj;
 			for (jj = 0; jj < NEVENTPHOTONS; jj++) {
-				event->ph_id[jj] = line->ph_id[xindex][jj];
-				event->src_id[jj] = line->src_id[xindex][jj];
+				event.ph_id[jj] = line->ph_id[xindex][jj];
+				event.src_id[jj] = line->src_id[xindex][jj];
 				// Set the IDs to the carry IDs
 				line->ph_id[xindex][jj] = line->carry_ph_id[xindex][jj];
 				line->src_id[xindex][jj] = line->carry_src_id[xindex][jj];
@@ -283,7 +305,7 @@ static inline void GenDetReadoutPixel(GenDet* const det, const int lineindex,
 
 			// Apply the lower readout threshold. Note that the upper
 			// threshold is only applied after pattern recombination.
-			if ((event->signal * event->signal)
+			if ((event.signal * event.signal)
 					<= (det->threshold_readout_lo_keV
 							* det->threshold_readout_lo_keV)) {
 				break;
@@ -291,26 +313,23 @@ static inline void GenDetReadoutPixel(GenDet* const det, const int lineindex,
 
 			// Apply the detector response if available.
 			if (NULL != det->rmf) {
-				event->pha = getEBOUNDSChannel(event->signal, det->rmf);
+				event.pha = getEBOUNDSChannel(event.signal, det->rmf);
 			} else {
-				event->pha = 0;
+				event.pha = 0;
 			}
 
 			// Store remaining information.
-			event->rawy = readoutindex;
-			event->rawx = xindex;
-			event->time = time;  // Time of detection.
-			event->frame = det->clocklist->frame; // Frame of detection.
-			event->npixels = 1;
+			event.rawy = readoutindex;
+			event.rawx = xindex;
+			event.time = time;  // Time of detection.
+			event.frame = det->clocklist->frame; // Frame of detection.
+			event.npixels = 1;
 
 			// Store the event in the output event file.
-			addEvent2File(det->elf, event, status);
+			addEvent2File(det->elf, &event, status);
 			CHECK_STATUS_BREAK(*status);
 
 		} while (0); // END of error handling loop.
-
-		// Release memory
-		freeEvent(&event);
 	}
 }
 
@@ -318,19 +337,25 @@ void GenDetReadoutLine(GenDet* const det, const int lineindex,
 		const int readoutindex, int* const status) {
 	headas_chat(5, "read out line %d as %d\n", lineindex, readoutindex);
 
-	GenDetLine* line = det->line[lineindex];
+	GenDetLine* line = getGenDetLine(det, lineindex);
 	line->last_readouttime = det->clocklist->time;
 
 	if (0 != line->anycharge) {
+		// Only the occupied pixels have to be regarded. They are
+		// read out in increasing order.
+		updateGenDetLineOccupied(line);
 		int ii;
-		for (ii = 0; ii < line->xwidth; ii++) {
-			GenDetReadoutPixel(det, lineindex, readoutindex, ii,
+		for (ii = 0; ii < line->noccupied; ii++) {
+			GenDetReadoutPixel(det, lineindex, readoutindex, line->occupied[ii],
 					det->clocklist->readout_time, status);
 			CHECK_STATUS_BREAK(*status);
 		}
 		CHECK_STATUS_VOID(*status);
 		// END of loop over all pixels in the line.
 
+		// Remove the pixels that have been read out.
+		updateGenDetLineOccupied(line);
+
 		// Reset the anycharge flag of this line.
 		line->anycharge = line->anycarry;
 		line->anycarry = 0;
@@ -339,7 +364,7 @@ void GenDetReadoutLine(GenDet* const det, const int lineindex,
 
 void GenDetClearLine(GenDet* const det, const int lineindex) {
 
-	clearGenDetLine(det->line[lineindex]);
+	clearGenDetLine(getGenDetLine(det, lineindex));
 }
 
 /** Apply the bad pixels of the bad pixel map. */
@@ -355,10 +380,11 @@ static void insertBadPix(GenDet* const det, const double timespan) {
 					addGenDetCharge2Pixel(det, ii, jj, diff, -1.0, -1, -1);
 				} else if (det->badpixmap->pixels[ii][jj] < 0.) {
 					// If the pixel is a cold one, remove charge.
-					if (det->line[jj]->charge[ii] < (-1.) * diff) {
-						det->line[jj]->charge[ii] = 0.;
+					GenDetLine* line = getGenDetLine(det, jj);
+					if (line->charge[ii] < (-1.) * diff) {
+						line->charge[ii] = 0.;
 					} else {
-						det->line[jj]->charge[ii] += diff;
+						line->charge[ii] += diff;
 					}
 				}
 			}
@@ -368,10 +394,13 @@ static void insertBadPix(GenDet* const det, const double timespan) {
 	// END of loop over x-coordinate.
 }
 
-static void insert_aux_bkg(GenDet* const det, double time, double dt) {
+static void insert_aux_bkg(GenDet* const det, double time, double dt,
+		int* const status) {
 	// Get background events for the required time interval (has
 	// to be given in [s]).
-	backgroundOutput* list = bkgGetBackgroundList(dt);
+	backgroundOutput* list = det->auxbkg_list;
+	getBkgGeneratorList(det->auxbkg, det->auxbkg_rng, dt, list, status);
+	CHECK_STATUS_VOID(*status);
 	double cosrota = cos(det->pixgrid->rota);
 	double sinrota = sin(det->pixgrid->rota);
 	int ii;
@@ -405,7 +434,6 @@ static void insert_aux_bkg(GenDet* const det, double time, double dt) {
 		addGenDetCharge2Pixel(det, x, y, list->hit_energy[ii],
 				time, -1, -1);
 	}
-	bkgFree(list);
 }
 
 static float calc_offaxis_angle(int xi, int yi, int ii, GenDet* const det) {
@@ -518,14 +546,27 @@ static void insert_background_events(GenDet* const det,
 	// model is defined and should be used.
 	if (NULL != det->phabkg[0]) {
 		insert_pha_bkg(det, tstart, dt, status);
+		CHECK_STATUS_VOID(*status);
 	}
 	// Insert cosmic ray background events,
 	// if the appropriate model is defined and should be used.
 	if ((1 == det->auxbackground)) {
-		insert_aux_bkg(det, tstart, dt );
+		insert_aux_bkg(det, tstart, dt, status);
 	}
 }
 
+/** Time of the last insertion of background events in the
+    event-triggered mode. */
+static double evt_bkg_time = 0.0;
+
+double getGenDetBkgTime(void) {
+	return evt_bkg_time;
+}
+
+void setGenDetBkgTime(const double time) {
+	evt_bkg_time = time;
+}
+
 void operateGenDetClock(GenDet* const det, const double time, int* const status) {
 
 	// Event-triggered mode. In this mode only background
@@ -533,14 +574,12 @@ void operateGenDetClock(GenDet* const det, const double time, int* const status)
 	if ( (GENDET_EVENT_TRIGGERED == det->readout_trigger )
 			 && (0 == det->ignore_bkg)  ){
 
-		static double last_time = 0.0; // Time of the last function call.
-
 		// Insert background events (PHA and AUX)
-		insert_background_events(det, last_time,time - last_time, status);
+		insert_background_events(det, evt_bkg_time, time - evt_bkg_time, status);
 		CHECK_STATUS_VOID(*status);
 
 		// Remember the time of the function call.
-		last_time = time;
+		evt_bkg_time = time;
 
 	} else if (GENDET_TIME_TRIGGERED == det->readout_trigger) {
 		// Time-triggered mode.
@@ -879,7 +918,7 @@ int makeGenSplitEvents(GenDet* const det, const struct Point2d* const position,
 void addGenDetCharge2Pixel(GenDet* const det, const int column, const int row,
 		const float signal, const double time, const long ph_id,
 		const long src_id) {
-	GenDetLine* line = det->line[row];
+	GenDetLine* line = getGenDetLine(det, row);
 
 	// Check if the pixel is sensitive right now.
 	if ((time < line->deadtime[column]) && (time >= 0.0))
@@ -899,7 +938,8 @@ void addGenDetCharge2Pixel(GenDet* const det, const int column, const int row,
 			sign = addDepfetSignal(det, column, row, signal, time, ph_id,
 					src_id);
 		}
-		line->anycharge = 1;
+		markGenDetLineCharged(det, line);
+		markGenDetLinePixel(line, column);
 
 		// Set PH_ID and SRC_ID.
 		if (oldcharge < 0.001) {
@@ -932,7 +972,7 @@ int addDepfetSignal(GenDet* const det, const int colnum, const int row,
 		const float signal, const double time, const long ph_id,
 		const long src_id) {
 
-	GenDetLine* line = det->line[row];
+	GenDetLine* line = getGenDetLine(det, row);
 
 	int sign = 1;
 
@@ -119,8 +119,18 @@ typedef struct {
   /** Detector pixel dimensions. */
   GenPixGrid* pixgrid;
 
-  /** Array of pointers to pixel lines. */
+  /** Array of pointers to pixel lines. The lines 1 to ywidth-1 are
+      organized as a ring buffer starting at 'lineoffset', such that
+      a line shift does not have to move all pointers. The lines must
+      therefore be accessed via getGenDetLine(). */
   GenDetLine** line;
+  int lineoffset;
+
+  /** Lines that might contain charges. Each line with the anycharge
+      flag set is contained in this list, such that the charge
+      transfer in a line shift does not have to regard empty lines. */
+  GenDetLine** chargedlines;
+  int nchargedlines;
 
   /** Pha2Pi correction filename used to convert PHA to PI accounting
       for signal loss due to lower energy thresholds */
@@ -171,6 +181,13 @@ typedef struct {
       ray detector background. */
   int auxbackground;
 
+  /** Generator of the cosmic ray detector background, its random
+      number generator, and the list of background hits, which is
+      reused for all time intervals. */
+  BkgGenerator* auxbkg;
+  gsl_rng* auxbkg_rng;
+  backgroundOutput* auxbkg_list;
+
   /** Models for detector background based on PHA spectra. */
   PHABkg* phabkg[2];
 
@@ -237,6 +254,33 @@ GenDet* newGenDet(int* const status);
     to the GenDet data structure to NULL. */
 void destroyGenDet(GenDet** const det);
 
+/** Return the pixel line with the specified index. Line 0 is the
+    one next to the read-out node. */
+static inline GenDetLine* getGenDetLine(const GenDet* const det,
+					const int lineindex)
+{
+  if (0==lineindex) {
+    return(det->line[0]);
+  }
+  int index=lineindex-1+det->lineoffset;
+  if (index>=det->pixgrid->ywidth-1) {
+    index-=det->pixgrid->ywidth-1;
+  }
+  return(det->line[index+1]);
+}
+
+/** Mark a line as containing charges. This function has to be called
+    whenever the anycharge flag of a line is set. */
+static inline void markGenDetLineCharged(GenDet* const det,
+					 GenDetLine* const line)
+{
+  line->anycharge=1;
+  if (0==line->incharged) {
+    line->incharged=1;
+    det->chargedlines[det->nchargedlines++]=line;
+  }
+}
+
 /** Function which returns the signal result of a photon impacting
     during the depfet clear. Assumes a linear clear behaviour. */
 double depfet_get_linear_clear_signal(double time,
@@ -261,6 +305,12 @@ void operateGenDetClock(GenDet* const det,
 			const double time,
 			int* const status);
 
+/** Get and set the time of the last insertion of background events
+    in the event-triggered mode, which is part of the state stored in a
+    simulation checkpoint. */
+double getGenDetBkgTime(void);
+void setGenDetBkgTime(const double time);
+
 /** Set the current detector time in the clocklist to the specified
     value. The default value for the start time is 0. */
 void setGenDetStartTime(GenDet* const det, const double t0);
@@ -49,74 +49,47 @@ GenDetLine* newGenDetLine(const int xwidth, int* const status)
   line->src_id  =NULL;
   line->carry_ph_id   =NULL;
   line->carry_src_id  =NULL;
+  line->occupied  =NULL;
+  line->isoccupied=NULL;
 
   line->xwidth=0;
+  line->noccupied=0;
   line->anycharge=0;
   line->anycarry=0;
+  line->incharged=0;
   line->last_readouttime=0.;
 
-  // Allocate memory.
-  line->charge=(float*)malloc(xwidth*sizeof(float));
+  // Allocate memory. All arrays are initialized with 0.
+  line->charge=(float*)calloc(xwidth, sizeof(float));
   CHECK_NULL_RET(line->charge, *status,
 		 "memory allocation for GenDetLine failed", line);
-  line->ccarry=(float*)malloc(xwidth*sizeof(float));
+  line->ccarry=(float*)calloc(xwidth, sizeof(float));
   CHECK_NULL_RET(line->ccarry, *status,
 		 "memory allocation for GenDetLine failed", line);
-  line->deadtime=(double*)malloc(xwidth*sizeof(double));
+  line->deadtime=(double*)calloc(xwidth, sizeof(double));
   CHECK_NULL_RET(line->deadtime, *status,
 		 "memory allocation for GenDetLine failed", line);
-  line->ph_id=(long**)malloc(xwidth*sizeof(long*));
+  line->ph_id=(long(*)[NEVENTPHOTONS])calloc(xwidth, sizeof(*line->ph_id));
   CHECK_NULL_RET(line->ph_id, *status,
 		 "memory allocation for GenDetLine failed", line);
-  line->src_id=(long**)malloc(xwidth*sizeof(long*));
+  line->src_id=(long(*)[NEVENTPHOTONS])calloc(xwidth, sizeof(*line->src_id));
   CHECK_NULL_RET(line->src_id, *status,
 		 "memory allocation for GenDetLine failed", line);
-  line->carry_ph_id=(long**)malloc(xwidth*sizeof(long*));
+  line->carry_ph_id=(long(*)[NEVENTPHOTONS])calloc(xwidth, sizeof(*line->carry_ph_id));
   CHECK_NULL_RET(line->carry_ph_id, *status,
 		 "memory allocation for GenDetLine failed", line);
-  line->carry_src_id=(long**)malloc(xwidth*sizeof(long*));
+  line->carry_src_id=(long(*)[NEVENTPHOTONS])calloc(xwidth, sizeof(*line->carry_src_id));
   CHECK_NULL_RET(line->carry_src_id, *status,
 		 "memory allocation for GenDetLine failed", line);
-  int ii;
-  for(ii=0; ii<xwidth; ii++) {
-    line->ph_id[ii]=(long*)malloc(NEVENTPHOTONS*sizeof(long));
-    CHECK_NULL_RET(line->ph_id[ii], *status,
-		   "memory allocation for GenDetLine failed", line);
-    line->src_id[ii]=(long*)malloc(NEVENTPHOTONS*sizeof(long));
-    CHECK_NULL_RET(line->src_id[ii], *status,
-		   "memory allocation for GenDetLine failed", line);
-    line->carry_ph_id[ii]=(long*)malloc(NEVENTPHOTONS*sizeof(long));
-    CHECK_NULL_RET(line->carry_ph_id[ii], *status,
-		   "memory allocation for GenDetLine failed", line);
-    line->carry_src_id[ii]=(long*)malloc(NEVENTPHOTONS*sizeof(long));
-    CHECK_NULL_RET(line->carry_src_id[ii], *status,
-		   "memory allocation for GenDetLine failed", line);
-    // Initialize.
-    int jj;
-    for (jj=0; jj<NEVENTPHOTONS; jj++) {
-      line->ph_id[ii][jj] =0;
-      line->src_id[ii][jj]=0;
-      line->carry_ph_id[ii][jj] =0;
-      line->carry_src_id[ii][jj]=0;
-    }
-  }
+  line->occupied=(int*)malloc(xwidth*sizeof(int));
+  CHECK_NULL_RET(line->occupied, *status,
+		 "memory allocation for GenDetLine failed", line);
+  line->isoccupied=(unsigned char*)calloc(xwidth, sizeof(unsigned char));
+  CHECK_NULL_RET(line->isoccupied, *status,
+		 "memory allocation for GenDetLine failed", line);
 
   line->xwidth=xwidth;
 
-  // Clear the pixels.
-  for(ii=0; ii<line->xwidth; ii++) {
-    line->charge[ii]=0.;
-    line->ccarry[ii]=0.;
-    line->deadtime[ii]=0.;
-    int jj;
-    for (jj=0; jj<NEVENTPHOTONS; jj++) {
-      line->ph_id[ii][jj] =0;
-      line->src_id[ii][jj]=0;
-      line->carry_ph_id[ii][jj] =0;
-      line->carry_src_id[ii][jj]=0;
-    }
-  }
-
   return(line);
 }
 
@@ -134,60 +107,81 @@ void destroyGenDetLine(GenDetLine** const line)
       free((*line)->deadtime);
     }
     if (NULL!=(*line)->ph_id) {
-      int ii;
-      for (ii=0; ii<(*line)->xwidth; ii++) {
-	if (NULL!=(*line)->ph_id[ii]) {
-	  free((*line)->ph_id[ii]);
-	}
-      }
       free((*line)->ph_id);
     }
     if (NULL!=(*line)->src_id) {
-      int ii;
-      for (ii=0; ii<(*line)->xwidth; ii++) {
-	if (NULL!=(*line)->src_id[ii]) {
-	  free((*line)->src_id[ii]);
-	}
-      }
       free((*line)->src_id);
     }
     if (NULL!=(*line)->carry_ph_id) {
-      int ii;
-      for (ii=0; ii<(*line)->xwidth; ii++) {
-	if (NULL!=(*line)->carry_ph_id[ii]) {
-	  free((*line)->carry_ph_id[ii]);
-	}
-      }
       free((*line)->carry_ph_id);
     }
     if (NULL!=(*line)->carry_src_id) {
-      int ii;
-      for (ii=0; ii<(*line)->xwidth; ii++) {
-	if (NULL!=(*line)->carry_src_id[ii]) {
-	  free((*line)->carry_src_id[ii]);
-	}
-      }
       free((*line)->carry_src_id);
     }
+    if (NULL!=(*line)->occupied) {
+      free((*line)->occupied);
+    }
+    if (NULL!=(*line)->isoccupied) {
+      free((*line)->isoccupied);
+    }
     free(*line);
     *line=NULL;
   }
 }
 
 
+void updateGenDetLineOccupied(GenDetLine* const line)
+{
+  int ii, nn=0;
+
+  if (line->noccupied>32) {
+    // For many occupied pixels it is cheaper to rebuild the sorted
+    // list from the flags.
+    for (ii=0; ii<line->xwidth; ii++) {
+      if (0==line->isoccupied[ii]) continue;
+      if ((line->charge[ii]!=0.)||(line->ccarry[ii]!=0.)) {
+	line->occupied[nn++]=ii;
+      } else {
+	line->isoccupied[ii]=0;
+      }
+    }
+
+  } else {
+    // Remove the empty pixels and sort the remaining ones by
+    // insertion.
+    for (ii=0; ii<line->noccupied; ii++) {
+      int xx=line->occupied[ii];
+      if ((line->charge[xx]==0.)&&(line->ccarry[xx]==0.)) {
+	line->isoccupied[xx]=0;
+	continue;
+      }
+      int jj=nn++;
+      while ((jj>0)&&(line->occupied[jj-1]>xx)) {
+	line->occupied[jj]=line->occupied[jj-1];
+	jj--;
+      }
+      line->occupied[jj]=xx;
+    }
+  }
+
+  line->noccupied=nn;
+}
+
+
 void clearGenDetLine(GenDetLine* const line)
 {
   // Check if the line contains any charge. If not the clearing
   // is not necessary.
   if (1==line->anycharge) {
     int ii;
-    for(ii=0; ii<line->xwidth; ii++) {
-      if (line->charge[ii]>0.) {
-	line->charge[ii]=0.;
+    for(ii=0; ii<line->noccupied; ii++) {
+      int xx=line->occupied[ii];
+      if (line->charge[xx]>0.) {
+	line->charge[xx]=0.;
 	int jj;
 	for (jj=0; jj<NEVENTPHOTONS; jj++) {
-	  line->ph_id[ii][jj] =0;
-	  line->src_id[ii][jj]=0;
+	  line->ph_id[xx][jj] =0;
+	  line->src_id[xx][jj]=0;
 	}
       }
     }
@@ -197,21 +191,25 @@ void clearGenDetLine(GenDetLine* const line)
   // read-out cycle.
   if (1==line->anycarry) {
     int ii;
-    for(ii=0; ii<line->xwidth; ii++) {
-      if (line->ccarry[ii]>0.) {
-	line->charge[ii]=line->ccarry[ii];
-	line->ccarry[ii]=0.;
+    for(ii=0; ii<line->noccupied; ii++) {
+      int xx=line->occupied[ii];
+      if (line->ccarry[xx]>0.) {
+	line->charge[xx]=line->ccarry[xx];
+	line->ccarry[xx]=0.;
 	int jj;
 	for (jj=0; jj<NEVENTPHOTONS; jj++) {
-	  line->ph_id[ii][jj] =line->carry_ph_id[ii][jj];
-	  line->src_id[ii][jj]=line->carry_src_id[ii][jj];
-	  line->carry_ph_id[ii][jj] =0;
-	  line->carry_src_id[ii][jj]=0;
+	  line->ph_id[xx][jj] =line->carry_ph_id[xx][jj];
+	  line->src_id[xx][jj]=line->carry_src_id[xx][jj];
+	  line->carry_ph_id[xx][jj] =0;
+	  line->carry_src_id[xx][jj]=0;
 	}
       }
     }
     line->anycarry=0;
   }
+
+  // Remove the cleared pixels from the list of occupied pixels.
+  updateGenDetLineOccupied(line);
 }
 
 
@@ -225,17 +223,19 @@ void addGenDetLine(GenDetLine* const line0, const GenDetLine* const line1)
 
   // Add the charges.
   int ii;
-  for(ii=0; ii<line1->xwidth; ii++) {
-    if (line1->charge[ii]>0.) {
-      line0->charge[ii]+=line1->charge[ii];
+  for(ii=0; ii<line1->noccupied; ii++) {
+    int xx=line1->occupied[ii];
+    if (line1->charge[xx]>0.) {
+      line0->charge[xx]+=line1->charge[xx];
+      markGenDetLinePixel(line0, xx);
 
       // Copy the photon and source IDs.
       int jj, kk;
       for (jj=0, kk=0; jj<NEVENTPHOTONS; jj++) {
-	if (0==line1->ph_id[ii][kk]) break;
-	if (0==line0->ph_id[ii][jj]) {
-	  line0->ph_id[ii][jj] =line1->ph_id[ii][kk];
-	  line0->src_id[ii][jj]=line1->src_id[ii][kk];
+	if (0==line1->ph_id[xx][kk]) break;
+	if (0==line0->ph_id[xx][jj]) {
+	  line0->ph_id[xx][jj] =line1->ph_id[xx][kk];
+	  line0->src_id[xx][jj]=line1->src_id[xx][kk];
 	  kk++;
 	}
       }
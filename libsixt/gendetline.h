@@ -54,20 +54,30 @@ typedef struct {
   double last_readouttime;
 
   /** Photon IDs corresponding to the charges in the individual
-      pixels. */
-  long** ph_id;
+      pixels. The IDs of all pixels are stored in one contiguous
+      block. */
+  long (*ph_id)[NEVENTPHOTONS];
 
   /** Photon IDs corresponding to the carry charges in the individual
       pixels. */
-  long** carry_ph_id;
+  long (*carry_ph_id)[NEVENTPHOTONS];
 
   /** Source IDs corresponding to the charges in the individual
       pixels. */
-  long** src_id;
+  long (*src_id)[NEVENTPHOTONS];
 
   /** Source IDs corresponding to the carry charges in the individual
       pixels. */
-  long** carry_src_id;
+  long (*carry_src_id)[NEVENTPHOTONS];
+
+  /** Indices of the pixels that might contain charges or carry
+      charges. Each pixel is contained at most once (as indicated by
+      the 'isoccupied' flags). Pixels that are not in this list are
+      guaranteed to be empty, such that read-out and clearing only
+      have to regard the listed pixels. */
+  int* occupied;
+  int noccupied;
+  unsigned char* isoccupied;
 
   /** This flag specifies if the line contains any charges (value
       1). If not (value 0), the read-out does not have to be
@@ -78,6 +88,10 @@ typedef struct {
       for the next read-out cycle (f.e. for DEPFETs). */
   int anycarry;
 
+  /** This flag specifies if the line is contained in the list of
+      charged lines of the GenDet (see markGenDetLineCharged()). */
+  int incharged;
+
 } GenDetLine;
 
 
@@ -99,6 +113,22 @@ void destroyGenDetLine(GenDetLine** const line);
     this cause all of the pixels should already be set to 0 charge. */
 void clearGenDetLine(GenDetLine* const line);
 
+/** Mark a pixel as possibly containing charge. This function has
+    to be called whenever the charge or the carry charge of a pixel is
+    modified. */
+static inline void markGenDetLinePixel(GenDetLine* const line, const int xindex)
+{
+  if (0==line->isoccupied[xindex]) {
+    line->isoccupied[xindex]=1;
+    line->occupied[line->noccupied++]=xindex;
+  }
+}
+
+/** Sort the list of occupied pixels in increasing order and remove
+    the pixels that do not contain any charge or carry charge any
+    more. */
+void updateGenDetLineOccupied(GenDetLine* const line);
+
 /** Add the charges in line 1 to line 0. The line must have the same
     width. The line 1 is not modified, i.e. the contained charges
     remain in there and have to be cleared separately. */
@@ -30,17 +30,13 @@
 struct XMLParseData {
 	GenInst* inst;
 	unsigned int seed;
+	/** Light curve of the cosmic ray background given in a
+	 PHABACKGROUND element. It is applied after the whole file has
+	 been parsed, as the AUXBACKGROUND element may follow. */
+	char phabkg_lightcurve[MAXFILENAME];
 	int status;
 };
 
-////////////////////////////////////////////////////////////////////
-// Static variables.
-////////////////////////////////////////////////////////////////////
-
-/** Flag indicating that the erodetbkgrndgen module is initialized and
- operational. */
-static int auxBkgInitialized = 0;
-
 ////////////////////////////////////////////////////////////////////
 // Static function declarations.
 ////////////////////////////////////////////////////////////////////
@@ -89,10 +85,6 @@ void destroyGenInst(GenInst** const inst, int* const status) {
 		if (NULL != (*inst)->det) {
 			destroyGenDet(&(*inst)->det);
 		}
-		if (1 == auxBkgInitialized) {
-			bkgCleanUp(status);
-			auxBkgInitialized = 0;
-		}
 		if (NULL != (*inst)->filename) {
 			free((*inst)->filename);
 		}
@@ -200,6 +192,22 @@ void parseGenInstXML(GenInst* const inst, const char* const filename,
 	// Release memory.
 	XML_ParserFree(parser);
 
+	// Apply the light curve of a PHABACKGROUND element to the cosmic ray
+	// background, independent of the order of the elements.
+	if (strlen(xmlparsedata.phabkg_lightcurve) > 0) {
+		if (NULL != inst->det->auxbkg) {
+			setBkgGeneratorRateFct(inst->det->auxbkg,
+					xmlparsedata.phabkg_lightcurve, status);
+			CHECK_STATUS_VOID(*status);
+		} else {
+			char msg[MAXMSG];
+			sprintf(msg, "light curve '%s' of the PHA background has no "
+					"effect without an AUXBACKGROUND element",
+					xmlparsedata.phabkg_lightcurve);
+			SIXT_WARNING(msg);
+		}
+	}
+
 	// Remove the XML string buffer.
 	freeXMLBuffer(&xmlbuffer);
 
@@ -360,6 +368,14 @@ GenInst* loadGenInst(const char* const filename, const unsigned int seed,
 		if (EXIT_SUCCESS != *status)
 			return (inst);
 	}
+	inst->det->chargedlines = (GenDetLine**) malloc(
+			inst->det->pixgrid->ywidth * sizeof(GenDetLine*));
+	if (NULL == inst->det->chargedlines) {
+		*status = EXIT_FAILURE;
+		SIXT_ERROR("memory allocation for GenDet pixel array failed");
+		return (inst);
+	}
+	inst->det->nchargedlines = 0;
 
 	return (inst);
 }
@@ -697,7 +713,7 @@ static void GenInstXMLElementStart(void* parsedata, const char* el,
 
 	} else if (!strcmp(Uelement, "AUXBACKGROUND")) {
 
-		if (0 == auxBkgInitialized) {
+		if (NULL == xmlparsedata->inst->det->auxbkg) {
 			// Determine the file containing the simulated background
 			// hits from GEANT4.
 			char filename[MAXFILENAME];
@@ -714,13 +730,16 @@ static void GenInstXMLElementStart(void* parsedata, const char* el,
 			strcpy(filepathname, xmlparsedata->inst->filepath);
 			strcat(filepathname, filename);
 
-			bkgAux rateinfo;
-			rateinfo.rate = getXMLAttributeDouble(attr, "RATE");
-
-			bkgInitializeAux(filepathname, xmlparsedata->seed, &rateinfo,
-					&xmlparsedata->status);
+			GenDet* det = xmlparsedata->inst->det;
+			det->auxbkg = newBkgGenerator(filepathname,
+					getXMLAttributeDouble(attr, "RATE"), &xmlparsedata->status);
 			CHECK_STATUS_VOID(xmlparsedata->status);
-			auxBkgInitialized = 1;
+			det->auxbkg_list = newBkgOutput(&xmlparsedata->status);
+			CHECK_STATUS_VOID(xmlparsedata->status);
+			det->auxbkg_rng = gsl_rng_alloc(gsl_rng_ranlux);
+			CHECK_NULL_VOID(det->auxbkg_rng, xmlparsedata->status,
+					"memory allocation for random number generator failed");
+			gsl_rng_set(det->auxbkg_rng, xmlparsedata->seed);
 
 			// Load the optional light curve if available. The light curve
 			// defines the time-variability of the background flux.
@@ -730,7 +749,8 @@ static void GenInstXMLElementStart(void* parsedata, const char* el,
 			if (strlen(filename) > 0) {
 				strcpy(filepathname, xmlparsedata->inst->filepath);
 				strcat(filepathname, filename);
-				bkgSetRateFct(filepathname, &xmlparsedata->status);
+				setBkgGeneratorRateFct(det->auxbkg, filepathname,
+						&xmlparsedata->status);
 				CHECK_STATUS_VOID(xmlparsedata->status);
 			}
 		}
@@ -783,12 +803,13 @@ static void GenInstXMLElementStart(void* parsedata, const char* el,
 		// defines the time-variability of the background flux.
 		getXMLAttributeString(attr, "LIGHTCURVE", filename);
 
-		// Check if a light curve has been specified.
+		// Check if a light curve has been specified. It modifies the
+		// rate of the cosmic ray background and is applied at the end
+		// of the parsing (see parseGenInstXML).
 		if (strlen(filename) > 0) {
-			strcpy(filepathname, xmlparsedata->inst->filepath);
-			strcat(filepathname, filename);
-			bkgSetRateFct(filepathname, &xmlparsedata->status);
-			CHECK_STATUS_VOID(xmlparsedata->status);
+			strcpy(xmlparsedata->phabkg_lightcurve,
+					xmlparsedata->inst->filepath);
+			strcat(xmlparsedata->phabkg_lightcurve, filename);
 		}
 
 	} else if (!strcmp(Uelement, "SPLIT")) {
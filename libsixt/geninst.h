@@ -76,7 +76,10 @@ GenInst* newGenInst(int* const status);
     to the GenInst data structure to NULL. */
 void destroyGenInst(GenInst** const det, int* const status);
 
-/** Parse the GenInst definition from an XML file. */
+/** Parse the GenInst definition from an XML file. The seed
+    initializes the random number stream of the cosmic ray background
+    of the instrument. Different instruments of the same simulation
+    should therefore be loaded with different seeds. */
 GenInst* loadGenInst(const char* const filename,
 		     const unsigned int seed,
 		     int* const status);
@@ -201,7 +201,7 @@ void processImpactsWithRMF(AdvDet* det,PixImpFile* piximpacfile,TesEventFile* ev
 }
 
 /** Processes the impacts, including crosstalk and RMF energy randomization **/
-void impactsToEvents(AdvDet *det,PixImpFile *piximpactfile,TesEventFile* event_file,int save_crosstalk, FILE* progressfile, int* const status){
+void impactsToEvents(AdvDet *det,PixImpactSource *source,TesEventFile* event_file,int save_crosstalk, FILE* progressfile, int* const status){
 
 	const double sample_length = 1./(det->SampleFreq);
 
@@ -221,7 +221,7 @@ void impactsToEvents(AdvDet *det,PixImpFile *piximpactfile,TesEventFile* event_f
 	int id = -1;
 
 	//Get the number of impacts
-	unsigned int total_length=piximpactfile->nrows;
+	unsigned int total_length=getPixImpactSourceSize(source);
 	unsigned int ndone=0;
 	unsigned int progress=0;
 	if (NULL==progressfile) {
@@ -234,7 +234,7 @@ void impactsToEvents(AdvDet *det,PixImpFile *piximpactfile,TesEventFile* event_f
 	}
 
 	// Iterate over impacts
-	while (getNextImpactFromPixImpFile(piximpactfile,&impact,status)){
+	while (getNextImpactFromSource(source,&impact,status)){
 		id = impact.pixID;
 		ndone+=1;
 
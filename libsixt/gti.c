@@ -202,6 +202,59 @@ double sumGTI(GTI* const gti)
 }
 
 
+GTI* getGTIShard(GTI* const gti,
+		 const int shard,
+		 const int nshards,
+		 const double chunk,
+		 int* const status)
+{
+  CHECK_STATUS_RET(*status, NULL);
+
+  if ((nshards<1)||(shard<0)||(shard>=nshards)) {
+    char msg[MAXMSG];
+    sprintf(msg, "invalid shard %d (number of shards: %d)", shard, nshards);
+    SIXT_ERROR(msg);
+    *status=EXIT_FAILURE;
+    return(NULL);
+  }
+
+  GTI* sgti=newGTI(status);
+  CHECK_STATUS_RET(*status, sgti);
+  sgti->mjdref  =gti->mjdref;
+  sgti->timezero=gti->timezero;
+
+  // Running number of the (piece of the) interval.
+  long npiece=0;
+  int ii;
+  for (ii=0; ii<gti->ngti; ii++) {
+    double start=gti->start[ii];
+    while (start<gti->stop[ii]) {
+      double stop=gti->stop[ii];
+      if ((chunk>0.)&&(stop-start>chunk)) {
+	stop=start+chunk;
+      }
+      if (npiece%nshards==shard) {
+	appendGTI(sgti, start, stop, status);
+	CHECK_STATUS_RET(*status, sgti);
+      }
+      npiece++;
+      start=stop;
+    }
+  }
+
+  if (0==sgti->ngti) {
+    char msg[MAXMSG];
+    sprintf(msg, "shard %d of %d does not contain any GTI "
+	    "(reduce the number of shards or the chunk length)",
+	    shard, nshards);
+    SIXT_ERROR(msg);
+    *status=EXIT_FAILURE;
+  }
+
+  return(sgti);
+}
+
+
 GTI* getGTIFromFileOrContinuous(char* const filename,
 				const double tstart,
 				const double tstop,
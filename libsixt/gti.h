@@ -72,6 +72,21 @@ void appendGTI(GTI* const gti,
 /** Sum all GTIs. */
 double sumGTI(GTI* const gti);
 
+/** Return the part of the GTI collection that is simulated by the
+    shard with the index 'shard' (0..nshards-1) of a run that is split
+    into 'nshards' independent processes. If chunk>0, the intervals
+    are first divided into pieces of at most 'chunk' seconds. The
+    (pieces of the) intervals are assigned to the shards in a
+    round-robin manner, such that the union over all shards
+    reproduces the original GTI collection. The boundaries of the
+    pieces are GTI stops for the shards, i.e., the detector is cleared
+    there and events are not read out across them. */
+GTI* getGTIShard(GTI* const gti,
+		 const int shard,
+		 const int nshards,
+		 const double chunk,
+		 int* const status);
+
 /** If a file name is specified, the GTI is loaded from the
     corresponding file. If not, a simple GTI is set up covering
     continuously the interval from tstart to tstop. */
@@ -34,6 +34,8 @@ ImpactFile* newImpactFile(int* const status)
 
   // Initialize pointers with NULL.
   file->fptr=NULL;
+  file->writer=NULL;
+  file->colbuffer=NULL;
 
   // Initialize values.
   file->nrows=0;
@@ -52,11 +54,20 @@ ImpactFile* newImpactFile(int* const status)
 void freeImpactFile(ImpactFile** const file, int* const status)
 {
   if (NULL!=*file) {
+    // Write the remaining impacts, even if an error occurred before.
+    int flush_status=EXIT_SUCCESS;
+    destroyFitsWriter(&(*file)->writer, &flush_status);
+    if (EXIT_SUCCESS==*status) {
+      *status=flush_status;
+    }
     if (NULL!=(*file)->fptr) {
       fits_close_file((*file)->fptr, status);
       headas_chat(5, "closed impact list file (containing %ld rows).\n",
 		  (*file)->nrows);
     }
+    if (NULL!=(*file)->colbuffer) {
+      free((*file)->colbuffer);
+    }
     free(*file);
     *file=NULL;
   }
@@ -196,6 +207,7 @@ void getNextImpactFromFile(ImpactFile* const file, Impact* const impact,
     SIXT_ERROR("impact list file contains no further entries");
     return;
   }
+  SIXT_PROF_COUNT(SIXT_PROF_ROWS_READ, 1);
 
   // Read in the data.
   int anynul=0;
@@ -244,6 +256,17 @@ void addImpact2File(ImpactFile* const ilf,
 		    Impact* const impact,
 		    int* const status)
 {
+  SIXT_PROF_COUNT(SIXT_PROF_ROWS_WRITTEN, 1);
+
+  if (NULL!=ilf->writer) {
+    Impact* row=(Impact*)addFitsWriterRow(ilf->writer, sizeof(Impact), status);
+    CHECK_STATUS_VOID(*status);
+    *row=*impact;
+    ilf->row++;
+    ilf->nrows++;
+    return;
+  }
+
   ilf->row++;
   ilf->nrows++;
 
@@ -260,3 +283,64 @@ void addImpact2File(ImpactFile* const ilf,
   fits_write_col(ilf->fptr, TLONG, ilf->csrc_id,
 		 ilf->row, 1, 1, &impact->src_id, status);
 }
+
+
+/** FitsWriterFct for the blocks of impacts. */
+static void writeImpactBlock(fitsfile* const fptr, const long firstrow,
+			     const long nrows, void* const* const rows,
+			     void* const data, int* const status)
+{
+  ImpactFile* const ilf=(ImpactFile*)data;
+  const Impact* const* const imp=(const Impact* const*)rows;
+  double* dbuffer=(double*)ilf->colbuffer;
+  float* fbuffer=(float*)ilf->colbuffer;
+  long* lbuffer=(long*)ilf->colbuffer;
+  long ii;
+
+  for (ii=0; ii<nrows; ii++) dbuffer[ii]=imp[ii]->time;
+  fits_write_col(fptr, TDOUBLE, ilf->ctime, firstrow, 1, nrows,
+		 dbuffer, status);
+  for (ii=0; ii<nrows; ii++) fbuffer[ii]=imp[ii]->energy;
+  fits_write_col(fptr, TFLOAT, ilf->cenergy, firstrow, 1, nrows,
+		 fbuffer, status);
+  for (ii=0; ii<nrows; ii++) dbuffer[ii]=imp[ii]->position.x;
+  fits_write_col(fptr, TDOUBLE, ilf->cx, firstrow, 1, nrows,
+		 dbuffer, status);
+  for (ii=0; ii<nrows; ii++) dbuffer[ii]=imp[ii]->position.y;
+  fits_write_col(fptr, TDOUBLE, ilf->cy, firstrow, 1, nrows,
+		 dbuffer, status);
+  for (ii=0; ii<nrows; ii++) lbuffer[ii]=imp[ii]->ph_id;
+  fits_write_col(fptr, TLONG, ilf->cph_id, firstrow, 1, nrows,
+		 lbuffer, status);
+  for (ii=0; ii<nrows; ii++) lbuffer[ii]=imp[ii]->src_id;
+  fits_write_col(fptr, TLONG, ilf->csrc_id, firstrow, 1, nrows,
+		 lbuffer, status);
+}
+
+
+void startImpactFileWriter(ImpactFile* const ilf, const int threaded,
+			   int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+  CHECK_NULL_VOID(ilf, *status, "no impact list file opened");
+  CHECK_NULL_VOID(ilf->fptr, *status, "no impact list file opened");
+  if (NULL!=ilf->writer) {
+    return;
+  }
+
+  ilf->colbuffer=malloc(IMPACTFILE_BLOCKSIZE*MAX(sizeof(double), sizeof(long)));
+  CHECK_MALLOC_VOID_STATUS(ilf->colbuffer, *status);
+
+  ilf->writer=newFitsWriter(ilf->fptr, ilf->row+1, sizeof(Impact),
+			    IMPACTFILE_BLOCKSIZE, IMPACTFILE_WRITERBLOCKS,
+			    getFitsWriterThreading(threaded),
+			    writeImpactBlock, ilf, status);
+}
+
+
+void flushImpactFile(ImpactFile* const ilf, int* const status)
+{
+  if (NULL!=ilf) {
+    flushFitsWriter(ilf->writer, status);
+  }
+}
@@ -24,10 +24,18 @@
 #define IMPACTFILE_H 1
 
 #include "sixt.h"
+#include "profiling.h"
+#include "fitswriter.h"
 #include "impact.h"
 #include "point.h"
 
 
+/** Number of impacts per block of the background writer and number
+    of blocks that can be queued. */
+#define IMPACTFILE_BLOCKSIZE (4096)
+#define IMPACTFILE_WRITERBLOCKS (4)
+
+
 /////////////////////////////////////////////////////////////////
 // Type Declarations.
 /////////////////////////////////////////////////////////////////
@@ -48,6 +56,14 @@ typedef struct {
   /** Column numbers in the FITS binary table. */
   int ctime, cenergy, cx, cy, cph_id, csrc_id;
 
+  /** Writer for the impacts appended with addImpact2File() (NULL if
+      they are written directly), see startImpactFileWriter(). */
+  FitsWriter* writer;
+
+  /** Scratch memory for the transfer of a single column of a block
+      of impacts. */
+  void* colbuffer;
+
 } ImpactFile;
 
 
@@ -95,5 +111,17 @@ void addImpact2File(ImpactFile* const ilf,
 		    Impact* const impact,
 		    int* const status);
 
+/** Write the impacts appended with addImpact2File() in blocks of
+    IMPACTFILE_BLOCKSIZE rows. If 'threaded' is non-zero and CFITSIO
+    is thread-safe, the blocks are written by a background thread.
+    The FITS file must not be accessed directly (via 'fptr')
+    afterwards without calling flushImpactFile() before. */
+void startImpactFileWriter(ImpactFile* const ilf, const int threaded,
+			   int* const status);
+
+/** Write all impacts, which have been appended so far, to the FITS
+    file. */
+void flushImpactFile(ImpactFile* const ilf, int* const status);
+
 
 #endif /* IMPACTFILE_H */
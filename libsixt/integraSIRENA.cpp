@@ -58,6 +58,10 @@ MAP OF SECTIONS IN THIS FILE:
 
 #include "genutils.h"
 #include "tasksSIRENA.h"
+#include "libsnapshotSIRENA.h"
+#include "profiling.h"
+
+#include <sys/mman.h>
 
 #define POOLS
 const unsigned int POOL_SIZE = 200;
@@ -635,7 +639,10 @@ extern "C" void reconstructRecordSIRENA(TesRecord* record, int trig_reclength, T
         
         // Detect pulses in record
         //log_trace("Before runDetect");
+        SIXT_PROF_BEGIN(SIXT_PROF_SIRENA_DETECT);
 	runDetect(record, trig_reclength,lastRecord, *pulsesAll, &reconstruct_init, &pulsesInRecord);
+        SIXT_PROF_END(SIXT_PROF_SIRENA_DETECT);
+        SIXT_PROF_COUNT(SIXT_PROF_PULSES, pulsesInRecord->ndetpulses);
         log_trace("After runDetect");
 	
 	if(pulsesInRecord->ndetpulses == 0) // No pulses found in record
@@ -647,7 +654,9 @@ extern "C" void reconstructRecordSIRENA(TesRecord* record, int trig_reclength, T
 	if ((reconstruct_init->opmode == 1) && (strcmp(reconstruct_init->EnergyMethod,"PCA") != 0))
 	{
 		// Filter and calculates energy
+		SIXT_PROF_BEGIN(SIXT_PROF_SIRENA_ENERGY);
 		runEnergy(record, trig_reclength, &reconstruct_init, &pulsesInRecord, optimalFilter,*pulsesAll);
+		SIXT_PROF_END(SIXT_PROF_SIRENA_ENERGY);
 	}
 	log_trace("After runEnergy");
 	
@@ -972,6 +981,7 @@ extern "C" void freeOptimalFilterSIRENA(OptimalFilterSIRENA* OFilterColl)
 /***** SECTION 9 ************************************************************
 * getLibraryCollection: This funtion creates and retrieves a LibraryCollection from a file.
 * 
+* - If the file is a binary snapshot of the library ('sirenasnapshot'), map it ('getLibraryCollectionSnapshot')
 * - Create LibraryCollection structure
 * - Open FITS file in READONLY mode (move to the first HDU) and get number of templates (rows)
 * - Allocate library structure
@@ -1003,6 +1013,12 @@ extern "C" void freeOptimalFilterSIRENA(OptimalFilterSIRENA* OFilterColl)
 ******************************************************************************/
 LibraryCollection* getLibraryCollection(const char* const filename, int opmode, int hduPRECALWN, int hduPRCLOFWM, int largeFilter, char* filter_domain, int pulse_length, char *energy_method, char *ofnoise, char *filter_method, char oflib, char **ofinterp, double filtEev, int lagsornot, int preBuffer, int* const status)
 {  	
+        // Binary snapshot of the library (created by sirenasnapshot): map it instead of reading the FITS file
+        if (isLibrarySnapshot(filename))
+        {
+                return(getLibraryCollectionSnapshot(filename, opmode, hduPRECALWN, hduPRCLOFWM, largeFilter, filter_domain, pulse_length, energy_method, ofnoise, filter_method, oflib, ofinterp, filtEev, lagsornot, preBuffer, status));
+        }
+
         // Create LibraryCollection structure
 	LibraryCollection* library_collection = new LibraryCollection;
 
@@ -1260,6 +1276,8 @@ LibraryCollection* getLibraryCollection(const char* const filename, int opmode,
 		EP_PRINT_ERROR("Cannot run readFitsSimple in integraSIRENA.cpp",*status);
 		*status=EPFAIL; return(library_collection);
 	}
+	// The library rows are looked for by binary search ('find_library_row')
+	checkLibraryOrder(library_collection->energies,ntemplates,"energies");
 	if (opmode == 1)
         {
                 int filtEevIsAEnergy = 0;
@@ -3275,7 +3293,9 @@ LibraryCollection::LibraryCollection():
   optimal_filtersabTIME(0),
   optimal_filtersabFREQ(0),
   PRECALWN(0),
-  PRCLOFWM(0)
+  PRCLOFWM(0),
+  snapshot_map(0),
+  snapshot_size(0)
 {
   
 }
@@ -3312,7 +3332,9 @@ LibraryCollection::LibraryCollection(const LibraryCollection& other):
   optimal_filtersabTIME(0),
   optimal_filtersabFREQ(0),
   PRECALWN(0),
-  PRCLOFWM(0)
+  PRCLOFWM(0),
+  snapshot_map(0),
+  snapshot_size(0)
 {
   if(other.energies){
     energies = gsl_vector_alloc(other.energies->size);
@@ -3758,6 +3780,11 @@ LibraryCollection& LibraryCollection::operator=(const LibraryCollection& other)
                                   other.PRCLOFWM->size2);
       gsl_matrix_memcpy(PRCLOFWM, other.PRCLOFWM);
     }
+
+    // The data have been copied, the snapshot is not needed anymore
+    if(snapshot_map){
+      munmap(snapshot_map, snapshot_size); snapshot_map = 0; snapshot_size = 0;
+    }
   }
   return *this;
 }
@@ -3869,6 +3896,11 @@ LibraryCollection::~LibraryCollection()
   if(PRCLOFWM) {
     gsl_matrix_free(PRCLOFWM); PRCLOFWM = 0;
   }
+
+  // The vectors and matrices loaded from a snapshot point into the mapping
+  if(snapshot_map){
+    munmap(snapshot_map, snapshot_size); snapshot_map = 0;
+  }
 }
 
 // PulseDetected
@@ -229,6 +229,10 @@ typedef struct LibraryCollection
 	
 	/** PRECALOFWM vector */
 	gsl_matrix *PRCLOFWM;
+
+	/** Read-only mapping of the snapshot file the library has been loaded from (if any, see 'getLibraryCollectionSnapshot') */
+	void *snapshot_map;
+	size_t snapshot_size;
 #ifdef __cplusplus
   LibraryCollection();
   LibraryCollection(const LibraryCollection& other);
@@ -59,10 +59,78 @@ void freeKDTreeElement(KDTreeElement** el)
 }
 
 
-KDTreeElement* buildKDTree2(Source* const list,
-			    const long nelements,
-			    const int depth,
-			    int* const status)
+/** Partition step of the quick sort of the Source objects with
+    respect to the specified coordinate axis. Works like the
+    corresponding routine used by quicksortSources(), but the unit
+    vectors of the source positions are pre-calculated and moved
+    together with the Source objects. */
+static long KDTreePartition(Source* const list,
+			    Vector* const location,
+			    const long left, const long right,
+			    const long pivotIndex, const int axis)
+{
+  double pivotValue=getVectorDimensionValue(&location[pivotIndex], axis);
+
+  // Move pivot to end.
+  Source buffer;
+  Vector vbuffer;
+  buffer=list[pivotIndex];
+  list[pivotIndex]=list[right];
+  list[right]=buffer;
+  vbuffer=location[pivotIndex];
+  location[pivotIndex]=location[right];
+  location[right]=vbuffer;
+
+  long storeIndex=left;
+  long ii;
+  for (ii=left; ii<right; ii++) {
+    if (getVectorDimensionValue(&location[ii], axis)<=pivotValue) {
+      if (ii>storeIndex) {
+	buffer=list[storeIndex];
+	list[storeIndex]=list[ii];
+	list[ii]=buffer;
+	vbuffer=location[storeIndex];
+	location[storeIndex]=location[ii];
+	location[ii]=vbuffer;
+      }
+      storeIndex++;
+    }
+  }
+
+  // Move pivot to its final place
+  buffer=list[storeIndex];
+  list[storeIndex]=list[right];
+  list[right]=buffer;
+  vbuffer=location[storeIndex];
+  location[storeIndex]=location[right];
+  location[right]=vbuffer;
+
+  return(storeIndex);
+}
+
+
+/** Quick sort of the Source objects and their unit vectors, yielding
+    the same order as quicksortSources(). */
+static void KDTreeQuicksort(Source* const list,
+			    Vector* const location,
+			    const long left, const long right,
+			    const int axis)
+{
+  if (right>left) {
+    int pivotIndex=left+(right-left)/2;
+    int pivotNewIndex=KDTreePartition(list, location, left, right,
+				      pivotIndex, axis);
+    KDTreeQuicksort(list, location, left, pivotNewIndex-1, axis);
+    KDTreeQuicksort(list, location, pivotNewIndex+1, right, axis);
+  }
+}
+
+
+static KDTreeElement* buildKDTreeLocation(Source* const list,
+					  Vector* const location,
+					  const long nelements,
+					  const int depth,
+					  int* const status)
 {
   if (0==nelements) return(NULL);
 
@@ -78,20 +146,69 @@ KDTreeElement* buildKDTree2(Source* const list,
 
   long median=nelements/2;
   int axis=depth % 3;
-  quicksortSources(list, 0, nelements-1, axis);
+  KDTreeQuicksort(list, location, 0, nelements-1, axis);
 
   // Fill the newly created node with data.
   *(node->src)=list[median];
 
   // Set right and left pointers of node.
   if (median>0) {
-    node->left=buildKDTree2(list, median, depth+1, status);
+    node->left=buildKDTreeLocation(list, location, median, depth+1, status);
+    CHECK_STATUS_RET(*status, node);
+  }
+
+  if (median<nelements-1) {
+    node->right=buildKDTreeLocation(&list[median+1], &location[median+1],
+				    nelements-median-1,
+				    depth+1, status);
+  }
+
+  return(node);
+}
+
+
+KDTreeElement* buildKDTree2(Source* const list,
+			    const long nelements,
+			    const int depth,
+			    int* const status)
+{
+  if (0==nelements) return(NULL);
+
+  // Calculate the unit vectors of the source positions once instead
+  // of for each comparison during the sorting.
+  Vector* location=(Vector*)malloc(nelements*sizeof(Vector));
+  CHECK_NULL(location, *status,
+	     "memory allocation for source positions failed");
+  long ii;
+  for (ii=0; ii<nelements; ii++) {
+    location[ii]=unit_vector(list[ii].ra, list[ii].dec);
   }
 
+  KDTreeElement* node=
+    buildKDTreeLocation(list, location, nelements, depth, status);
+
+  free(location);
+  return(node);
+}
+
+
+KDTreeElement* restoreKDTree(Source* const list,
+			     const long nelements,
+			     int* const status)
+{
+  if (0==nelements) return(NULL);
+
+  KDTreeElement* node=newKDTreeElement(status);
+  CHECK_STATUS_RET(*status, node);
+
+  long median=nelements/2;
+  *(node->src)=list[median];
+  if (median>0) {
+    node->left=restoreKDTree(list, median, status);
+    CHECK_STATUS_RET(*status, node);
+  }
   if (median<nelements-1) {
-    node->right=buildKDTree2(&list[median+1],
-			     nelements-median-1,
-			     depth+1, status);
+    node->right=restoreKDTree(&list[median+1], nelements-median-1, status);
   }
 
   return(node);
@@ -105,6 +222,7 @@ LinkedPhoListElement* KDTreeRangeSearch(KDTreeElement* const node,
 					const double t0, const double t1,
 					const double mjdref,
 					SimputCtlg* const simputcat,
+					PhotonEnergyTables* const energies,
 					int* const status)
 {
   // Check if the kd-Tree exists.
@@ -116,7 +234,8 @@ LinkedPhoListElement* KDTreeRangeSearch(KDTreeElement* const node,
   Vector location=unit_vector(node->src->ra, node->src->dec);
   if (0==check_fov(&location, ref, min_align)) {
     // Generate photons for this particular source.
-    list=getXRayPhotons(node->src, simputcat, t0, t1, mjdref, status);
+    list=getXRayPhotons(node->src, simputcat, energies,
+			 t0, t1, mjdref, status);
     CHECK_STATUS_RET(*status, list);
   }
 
@@ -145,7 +264,7 @@ LinkedPhoListElement* KDTreeRangeSearch(KDTreeElement* const node,
   if (NULL!=near) {
     LinkedPhoListElement* near_list=
       KDTreeRangeSearch(near, depth+1, ref, min_align,
-			t0, t1, mjdref, simputcat, status);
+			t0, t1, mjdref, simputcat, energies, status);
 
     // Merge the new photons into the existing list.
     list=mergeLinkedPhoLists(list, near_list);
@@ -162,7 +281,7 @@ LinkedPhoListElement* KDTreeRangeSearch(KDTreeElement* const node,
       // Append newly found entries.
       LinkedPhoListElement* far_list =
 	KDTreeRangeSearch(far, depth+1, ref, min_align,
-			  t0, t1, mjdref, simputcat, status);
+			  t0, t1, mjdref, simputcat, energies, status);
 
       // Merge the new photons into the existing list.
       list = mergeLinkedPhoLists(list, far_list);
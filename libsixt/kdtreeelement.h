@@ -54,12 +54,23 @@ KDTreeElement* newKDTreeElement(int* const status);
 /** Destructor. */
 void freeKDTreeElement(KDTreeElement** el);
 
-/** Build up the KDTree from the given list of Sources. */
+/** Build up the KDTree from the given list of Sources. The list is
+    re-ordered such that the node of each sub-tree with n elements
+    starting at list[i] is list[i+n/2], with the left sub-tree
+    starting at list[i] and the right one at list[i+n/2+1]. */
 KDTreeElement* buildKDTree2(Source* const list,
 			    const long nelements,
 			    const int depth,
 			    int* const status);
 
+/** Set up the KDTree from a list of Sources, which has been
+    re-ordered by buildKDTree2() before. The resulting tree is the
+    same as the one returned by buildKDTree2(), but no sorting is
+    necessary. */
+KDTreeElement* restoreKDTree(Source* const list,
+			     const long nelements,
+			     int* const status);
+
 /** Perform a range search on the given kdTree, i.e., return all X-ray
     sources lying within a certain radius around the reference
     point. This region is defined by the minimum cosine value for the
@@ -73,6 +84,7 @@ LinkedPhoListElement* KDTreeRangeSearch(KDTreeElement* const node,
 					const double t0, const double t1,
 					const double mjdref,
 					SimputCtlg* const simputcat,
+					PhotonEnergyTables* const energies,
 					int* const status);
 
 
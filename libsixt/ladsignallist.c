@@ -47,3 +47,192 @@ void freeLADSignalList(LADSignalListItem** const list)
     *list=NULL;
   }
 }
+
+
+/** Number of items allocated at once by the LADSignalListPool. */
+#define LADSIGNALLISTPOOLBLOCK (1024)
+
+
+LADSignalListPool* newLADSignalListPool(int* const status)
+{
+  LADSignalListPool* pool=
+    (LADSignalListPool*)malloc(sizeof(LADSignalListPool));
+  CHECK_NULL(pool, *status,
+	     "memory allocation for LADSignalListPool failed");
+
+  // Initialize pointers with NULL.
+  pool->free=NULL;
+  pool->blocks=NULL;
+  pool->nblocks=0;
+
+  return(pool);
+}
+
+
+void freeLADSignalListPool(LADSignalListPool** const pool)
+{
+  if (NULL!=*pool) {
+    if (NULL!=(*pool)->blocks) {
+      long ii;
+      for (ii=0; ii<(*pool)->nblocks; ii++) {
+	free((*pool)->blocks[ii]);
+      }
+      free((*pool)->blocks);
+    }
+    free(*pool);
+    *pool=NULL;
+  }
+}
+
+
+LADSignalListItem* getLADSignalListPoolItem(LADSignalListPool* const pool,
+					    int* const status)
+{
+  // If there are no more items available, allocate a new block.
+  if (NULL==pool->free) {
+    LADSignalListItem** blocks=
+      (LADSignalListItem**)realloc(pool->blocks,
+				   (pool->nblocks+1)*sizeof(LADSignalListItem*));
+    CHECK_NULL(blocks, *status,
+	       "memory allocation for LADSignalListPool failed");
+    pool->blocks=blocks;
+
+    LADSignalListItem* block=
+      (LADSignalListItem*)malloc(LADSIGNALLISTPOOLBLOCK*
+				 sizeof(LADSignalListItem));
+    CHECK_NULL(block, *status,
+	       "memory allocation for LADSignalListPool failed");
+    pool->blocks[pool->nblocks++]=block;
+
+    // Chain the new items into the free list.
+    long ii;
+    for (ii=0; ii<LADSIGNALLISTPOOLBLOCK-1; ii++) {
+      block[ii].next=&(block[ii+1]);
+    }
+    block[LADSIGNALLISTPOOLBLOCK-1].next=NULL;
+    pool->free=block;
+  }
+
+  LADSignalListItem* el=pool->free;
+  pool->free=el->next;
+  el->next=NULL;
+
+  return(el);
+}
+
+
+void releaseLADSignalListPoolItem(LADSignalListPool* const pool,
+				  LADSignalListItem* const item)
+{
+  item->next=pool->free;
+  pool->free=item;
+}
+
+
+LADSignalQueue* newLADSignalQueue(int* const status)
+{
+  LADSignalQueue* queue=(LADSignalQueue*)malloc(sizeof(LADSignalQueue));
+  CHECK_NULL(queue, *status,
+	     "memory allocation for LADSignalQueue failed");
+
+  // Initialize pointers with NULL.
+  queue->item=NULL;
+  queue->nsignals=0;
+  queue->size=0;
+  queue->seqno=0;
+
+  return(queue);
+}
+
+
+void freeLADSignalQueue(LADSignalQueue** const queue)
+{
+  if (NULL!=*queue) {
+    if (NULL!=(*queue)->item) {
+      free((*queue)->item);
+    }
+    free(*queue);
+    *queue=NULL;
+  }
+}
+
+
+/** Order of two queue entries: by time, and by the insertion
+    sequence for identical times. */
+static inline int LADSignalQueueItemBefore(const LADSignalQueueItem* const a,
+					   const LADSignalQueueItem* const b)
+{
+  if (a->signal.time<b->signal.time) return(1);
+  if (a->signal.time>b->signal.time) return(0);
+  return(a->seqno<b->seqno);
+}
+
+
+void insertLADSignal2Queue(LADSignalQueue* const queue,
+			   const LADSignal* const signal,
+			   int* const status)
+{
+  // Enlarge the heap array if necessary.
+  if (queue->nsignals>=queue->size) {
+    long size=MAX(2*queue->size, 1024);
+    LADSignalQueueItem* item=
+      (LADSignalQueueItem*)realloc(queue->item,
+				   size*sizeof(LADSignalQueueItem));
+    CHECK_NULL_VOID(item, *status,
+		    "memory allocation for LADSignalQueue failed");
+    queue->item=item;
+    queue->size=size;
+  }
+
+  LADSignalQueueItem newitem;
+  copyLADSignal(&newitem.signal, signal);
+  newitem.seqno=queue->seqno++;
+
+  // Sift up.
+  long pos=queue->nsignals++;
+  while (pos>0) {
+    long parent=(pos-1)/2;
+    if (!LADSignalQueueItemBefore(&newitem, &(queue->item[parent]))) break;
+    queue->item[pos]=queue->item[parent];
+    pos=parent;
+  }
+  queue->item[pos]=newitem;
+}
+
+
+LADSignal* firstLADSignalQueue(const LADSignalQueue* const queue)
+{
+  if (0==queue->nsignals) {
+    return(NULL);
+  }
+  return(&(queue->item[0].signal));
+}
+
+
+void popLADSignalQueue(LADSignalQueue* const queue)
+{
+  if (0==queue->nsignals) {
+    return;
+  }
+
+  // Move the last element to the top and sift it down.
+  queue->nsignals--;
+  if (0==queue->nsignals) {
+    return;
+  }
+  LADSignalQueueItem last=queue->item[queue->nsignals];
+  long pos=0;
+  while (1) {
+    long child=2*pos+1;
+    if (child>=queue->nsignals) break;
+    if ((child+1<queue->nsignals) &&
+	LADSignalQueueItemBefore(&(queue->item[child+1]),
+				 &(queue->item[child]))) {
+      child++;
+    }
+    if (!LADSignalQueueItemBefore(&(queue->item[child]), &last)) break;
+    queue->item[pos]=queue->item[child];
+    pos=child;
+  }
+  queue->item[pos]=last;
+}
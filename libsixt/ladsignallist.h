@@ -42,6 +42,48 @@ struct structLADSignalListItem {
 typedef struct structLADSignalListItem LADSignalListItem;
 
 
+/** Pool of LADSignalListItems. Released items are kept in a free
+    list and are handed out again, such that the list elements are
+    allocated in blocks rather than one by one. */
+typedef struct {
+  /** Items available for re-use. */
+  LADSignalListItem* free;
+
+  /** Allocated blocks of items. */
+  LADSignalListItem** blocks;
+  long nblocks;
+} LADSignalListPool;
+
+
+/** Entry of the LADSignalQueue. */
+typedef struct {
+  LADSignal signal;
+
+  /** Sequence number of the insertion. Used to keep signals with
+      identical times in the order in which they have been
+      inserted. */
+  unsigned long seqno;
+} LADSignalQueueItem;
+
+
+/** Time-ordered priority queue of LADSignals, implemented as a
+    binary min-heap. Insertion and removal of the earliest signal are
+    O(log n) with n the number of pending signals. */
+typedef struct {
+  /** Heap array. */
+  LADSignalQueueItem* item;
+
+  /** Number of signals in the queue. */
+  long nsignals;
+
+  /** Allocated size of the heap array. */
+  long size;
+
+  /** Sequence number for the next insertion. */
+  unsigned long seqno;
+} LADSignalQueue;
+
+
 /////////////////////////////////////////////////////////////////
 // Function Declarations.
 /////////////////////////////////////////////////////////////////
@@ -53,5 +95,41 @@ LADSignalListItem* newLADSignalListItem(int* const status);
 /** Destructor. */
 void freeLADSignalList(LADSignalListItem** const list);
 
+/** Constructor for an empty LADSignalListPool. */
+LADSignalListPool* newLADSignalListPool(int* const status);
+
+/** Destructor. Releases all items that have been obtained from the
+    pool, regardless whether they have been returned or not. */
+void freeLADSignalListPool(LADSignalListPool** const pool);
+
+/** Obtain an item from the pool. The next pointer is initialized
+    with NULL. */
+LADSignalListItem* getLADSignalListPoolItem(LADSignalListPool* const pool,
+					    int* const status);
+
+/** Return an item to the pool. */
+void releaseLADSignalListPoolItem(LADSignalListPool* const pool,
+				  LADSignalListItem* const item);
+
+/** Constructor for an empty LADSignalQueue. */
+LADSignalQueue* newLADSignalQueue(int* const status);
+
+/** Destructor. */
+void freeLADSignalQueue(LADSignalQueue** const queue);
+
+/** Insert a copy of the signal into the queue. Signals with
+    identical times are returned in the order of insertion. */
+void insertLADSignal2Queue(LADSignalQueue* const queue,
+			   const LADSignal* const signal,
+			   int* const status);
+
+/** Return a pointer to the earliest signal in the queue or NULL if
+    the queue is empty. The pointer becomes invalid with the next
+    modification of the queue. */
+LADSignal* firstLADSignalQueue(const LADSignalQueue* const queue);
+
+/** Remove the earliest signal from the queue. */
+void popLADSignalQueue(LADSignalQueue* const queue);
+
 
 #endif /* LADSIGNALLIST_H */
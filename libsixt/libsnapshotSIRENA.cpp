@@ -0,0 +1,764 @@
+/***********************************************************************
+   This file is part of SIXTE/SIRENA software.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+***********************************************************************
+*                      LIBSNAPSHOTSIRENA
+*
+*  File:       libsnapshotSIRENA.cpp
+*
+***********************************************************************/
+
+/******************************************************************************
+DESCRIPTION:
+
+The purpose of this package is to write the LibraryCollection built from a library FITS file ('getLibraryCollection' in production
+mode) into a binary snapshot file, and to load it back by mapping the file into memory.
+
+A snapshot consists of a header ('LibSnapshotHeader'), an index with one entry per vector/matrix ('LibSnapshotEntry') and the arrays
+of doubles, each of them starting at an offset multiple of 'LIBSNAPSHOT_ALIGN'. When loading a snapshot, the file is mapped read-only
+and shared, and the gsl vectors and matrices of the LibraryCollection point directly into the mapping, so the pages are only read
+from disk when they are used and concurrent reconstruction processes share the same physical memory. Only the fields which are
+modified during the reconstruction ('pulse_templates_filder', 'maxDERs' and 'samp1DERs', see 'filderLibrary') are copied.
+
+The header and the index are always verified when loading. The checksum of the arrays is verified by 'verifyLibrarySnapshot' (after
+creating a snapshot) since it would require reading the whole file at every load.
+
+MAP OF SECTIONS IN THIS FILE:
+
+ - 1. snapshotChecksum
+ - 2. snapshot_fields
+ - 3. writeLibrarySnapshot
+ - 4. isLibrarySnapshot
+ - 5. verifyLibrarySnapshot
+ - 6. getLibraryCollectionSnapshot
+ - 7. createLibrarySnapshotSIRENA
+
+*******************************************************************************/
+
+#include "libsnapshotSIRENA.h"
+#include "pulseprocess.h"
+
+#include <cstddef>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Byte order mark of the snapshot header
+#define LIBSNAPSHOT_BYTEORDER 0x01020304
+
+/***** SECTION 1 ************************************************************
+* snapshotChecksum function: This function updates a 64-bit FNV-1a checksum with 'size' bytes of 'data'.
+*
+* The data are processed in 8-byte words (the arrays and the header of a snapshot are multiples of 8 bytes) and the remaining bytes
+* one by one.
+*
+* Parameters:
+* - hash: Current value of the checksum (14695981039346656037 to start)
+* - data: Data to be added to the checksum
+* - size: Number of bytes of 'data'
+******************************************************************************/
+static uint64_t snapshotChecksum(uint64_t hash, const void *data, size_t size)
+{
+	const uint64_t prime = 1099511628211ULL;
+	const unsigned char *bytes = (const unsigned char *) data;
+	size_t nwords = size/sizeof(uint64_t);
+
+	for (size_t i=0;i<nwords;i++)
+	{
+		uint64_t word;
+		memcpy(&word,bytes+i*sizeof(uint64_t),sizeof(uint64_t));
+		hash = (hash^word)*prime;
+	}
+	for (size_t i=nwords*sizeof(uint64_t);i<size;i++)
+	{
+		hash = (hash^bytes[i])*prime;
+	}
+
+	return(hash);
+}
+/*xxxx end of SECTION 1 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
+
+
+/***** SECTION 2 ************************************************************
+* snapshot_fields: Fields of the LibraryCollection stored in a snapshot.
+*
+* Every field is identified in the index by its name. The arrays of templates/filters have one entry per row. The fields marked as
+* 'writable' are modified during the reconstruction and they are copied from the mapping instead of being used in place.
+******************************************************************************/
+enum {SNAP_VECTOR, SNAP_MATRIX, SNAP_TEMPLATES, SNAP_MFILTERS, SNAP_OFILTERS};
+
+typedef struct SnapshotField
+{
+	const char *name;
+	int type;
+	size_t offset;
+	bool writable;
+} SnapshotField;
+
+#define SNAPSHOT_FIELD(field,type,writable) {#field, type, offsetof(LibraryCollection,field), writable}
+
+static const SnapshotField snapshot_fields[] = {
+	SNAPSHOT_FIELD(energies,SNAP_VECTOR,false),
+	SNAPSHOT_FIELD(pulse_heights,SNAP_VECTOR,false),
+	SNAPSHOT_FIELD(pulse_templatesMaxLengthFixedFilter,SNAP_TEMPLATES,false),
+	SNAPSHOT_FIELD(pulse_templates,SNAP_TEMPLATES,false),
+	SNAPSHOT_FIELD(pulse_templates_filder,SNAP_TEMPLATES,true),
+	SNAPSHOT_FIELD(maxDERs,SNAP_VECTOR,true),
+	SNAPSHOT_FIELD(samp1DERs,SNAP_VECTOR,true),
+	SNAPSHOT_FIELD(pulse_templates_B0,SNAP_TEMPLATES,false),
+	SNAPSHOT_FIELD(matched_filters,SNAP_MFILTERS,false),
+	SNAPSHOT_FIELD(matched_filters_B0,SNAP_MFILTERS,false),
+	SNAPSHOT_FIELD(optimal_filters,SNAP_OFILTERS,false),
+	SNAPSHOT_FIELD(optimal_filtersFREQ,SNAP_OFILTERS,false),
+	SNAPSHOT_FIELD(optimal_filtersTIME,SNAP_OFILTERS,false),
+	SNAPSHOT_FIELD(V,SNAP_MATRIX,false),
+	SNAPSHOT_FIELD(W,SNAP_MATRIX,false),
+	SNAPSHOT_FIELD(WAB,SNAP_MATRIX,false),
+	SNAPSHOT_FIELD(T,SNAP_MATRIX,false),
+	SNAPSHOT_FIELD(t,SNAP_VECTOR,false),
+	SNAPSHOT_FIELD(X,SNAP_MATRIX,false),
+	SNAPSHOT_FIELD(Y,SNAP_MATRIX,false),
+	SNAPSHOT_FIELD(Z,SNAP_MATRIX,false),
+	SNAPSHOT_FIELD(r,SNAP_VECTOR,false),
+	SNAPSHOT_FIELD(PAB,SNAP_MATRIX,false),
+	SNAPSHOT_FIELD(PABMXLFF,SNAP_MATRIX,false),
+	SNAPSHOT_FIELD(DAB,SNAP_MATRIX,false),
+	SNAPSHOT_FIELD(optimal_filtersab,SNAP_OFILTERS,false),
+	SNAPSHOT_FIELD(optimal_filtersabTIME,SNAP_OFILTERS,false),
+	SNAPSHOT_FIELD(optimal_filtersabFREQ,SNAP_OFILTERS,false),
+	SNAPSHOT_FIELD(PRECALWN,SNAP_MATRIX,false),
+	SNAPSHOT_FIELD(PRCLOFWM,SNAP_MATRIX,false)
+};
+
+static const int snapshot_nfields = sizeof(snapshot_fields)/sizeof(snapshot_fields[0]);
+
+// Entry of the index together with the data to be written
+typedef struct SnapshotItem
+{
+	LibSnapshotEntry entry;
+	const gsl_vector *vector;
+	const gsl_matrix *matrix;
+} SnapshotItem;
+
+static void addSnapshotItem(std::vector<SnapshotItem> &items, const char *name, int row, int duration, double energy, double pulse_height,
+			    const gsl_vector *vector, const gsl_matrix *matrix)
+{
+	SnapshotItem item;
+	memset(&item.entry,0,sizeof(LibSnapshotEntry));
+	strncpy(item.entry.name,name,LIBSNAPSHOT_NAMELEN-1);
+	item.entry.row = row;
+	item.entry.duration = duration;
+	item.entry.energy = energy;
+	item.entry.pulse_height = pulse_height;
+	item.entry.kind = LIBSNAPSHOT_NULL;
+	if (vector != NULL)
+	{
+		item.entry.kind = LIBSNAPSHOT_VECTOR;
+		item.entry.size1 = vector->size;
+	}
+	else if (matrix != NULL)
+	{
+		item.entry.kind = LIBSNAPSHOT_MATRIX;
+		item.entry.size1 = matrix->size1;
+		item.entry.size2 = matrix->size2;
+	}
+	item.vector = vector;
+	item.matrix = matrix;
+	items.push_back(item);
+}
+
+static uint64_t alignSnapshotOffset(uint64_t offset)
+{
+	return((offset+LIBSNAPSHOT_ALIGN-1)/LIBSNAPSHOT_ALIGN*LIBSNAPSHOT_ALIGN);
+}
+/*xxxx end of SECTION 2 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
+
+
+/***** SECTION 3 ************************************************************
+* writeLibrarySnapshot function: This function writes a LibraryCollection into a binary snapshot file.
+*
+* The snapshot is written into a temporary file which is renamed to 'filename' at the end, so processes mapping a previous
+* version of the snapshot are not affected.
+*
+* Parameters:
+* - library_collection: LibraryCollection to be written
+* - options: Header with the options the library has been loaded with (the rest of the header is filled in here)
+* - filename: Name of the snapshot file
+******************************************************************************/
+int writeLibrarySnapshot(LibraryCollection *library_collection, LibSnapshotHeader *options, const char* const filename)
+{
+	string message = "";
+	const char *base = (const char *) library_collection;
+
+	// Index
+	std::vector<SnapshotItem> items;
+	for (int f=0;f<snapshot_nfields;f++)
+	{
+		const SnapshotField *field = &snapshot_fields[f];
+		const void *ptr = *(void * const *) (base+field->offset);
+		if (ptr == NULL)	continue;
+
+		if (field->type == SNAP_VECTOR)
+		{
+			addSnapshotItem(items,field->name,-1,0,0.0,0.0,(const gsl_vector *) ptr,NULL);
+		}
+		else if (field->type == SNAP_MATRIX)
+		{
+			addSnapshotItem(items,field->name,-1,0,0.0,0.0,NULL,(const gsl_matrix *) ptr);
+		}
+		else
+		{
+			for (int i=0;i<library_collection->ntemplates;i++)
+			{
+				if (field->type == SNAP_TEMPLATES)
+				{
+					const PulseTemplate *pt = (const PulseTemplate *) ptr+i;
+					addSnapshotItem(items,field->name,i,pt->template_duration,pt->energy,pt->pulse_height,pt->ptemplate,NULL);
+				}
+				else if (field->type == SNAP_MFILTERS)
+				{
+					const MatchedFilter *mf = (const MatchedFilter *) ptr+i;
+					addSnapshotItem(items,field->name,i,mf->mfilter_duration,mf->energy,mf->pulse_height,mf->mfilter,NULL);
+				}
+				else
+				{
+					const OptimalFilterSIRENA *of = (const OptimalFilterSIRENA *) ptr+i;
+					addSnapshotItem(items,field->name,i,of->ofilter_duration,of->energy,0.0,of->ofilter,NULL);
+				}
+			}
+		}
+	}
+
+	// Layout
+	LibSnapshotHeader header = *options;
+	memset(header.magic,0,sizeof(header.magic));
+	strncpy(header.magic,LIBSNAPSHOT_MAGIC,sizeof(header.magic));
+	header.version = LIBSNAPSHOT_VERSION;
+	header.byteorder = LIBSNAPSHOT_BYTEORDER;
+	header.nentries = items.size();
+	header.ntemplates = library_collection->ntemplates;
+	header.nfixedfilters = library_collection->nfixedfilters;
+	header.baseline = library_collection->baseline;
+	header.header_size = alignSnapshotOffset(sizeof(LibSnapshotHeader)+items.size()*sizeof(LibSnapshotEntry));
+	uint64_t offset = header.header_size;
+	for (size_t i=0;i<items.size();i++)
+	{
+		LibSnapshotEntry *entry = &items[i].entry;
+		if (entry->kind == LIBSNAPSHOT_NULL)	continue;
+		entry->offset = offset;
+		uint64_t nelements = entry->size1*((entry->kind == LIBSNAPSHOT_MATRIX) ? entry->size2 : 1);
+		offset = alignSnapshotOffset(offset+nelements*sizeof(double));
+	}
+	header.file_size = offset;
+	header.index_checksum = 0;
+	header.data_checksum = 0;
+
+	string tmpname = string(filename) + ".tmp";
+	FILE *fp = fopen(tmpname.c_str(),"wb");
+	if (fp == NULL)
+	{
+		message = "Cannot create library snapshot file " + tmpname;
+		EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
+	}
+
+	// Arrays (written row by row, matrices might have tda>size2 and vectors stride>1)
+	bool ok = (fseek(fp,header.header_size,SEEK_SET) == 0);
+	uint64_t hash = 14695981039346656037ULL;
+	uint64_t position = header.header_size;
+	static const char padding[LIBSNAPSHOT_ALIGN] = {0};
+	std::vector<double> buffer;
+	for (size_t i=0;ok && (i<items.size());i++)
+	{
+		const LibSnapshotEntry *entry = &items[i].entry;
+		if (entry->kind == LIBSNAPSHOT_NULL)	continue;
+
+		if (entry->offset > position)
+		{
+			size_t npad = entry->offset-position;
+			ok = (fwrite(padding,1,npad,fp) == npad);
+			hash = snapshotChecksum(hash,padding,npad);
+			position = entry->offset;
+		}
+
+		size_t nrows = (entry->kind == LIBSNAPSHOT_MATRIX) ? entry->size1 : 1;
+		size_t ncols = (entry->kind == LIBSNAPSHOT_MATRIX) ? entry->size2 : entry->size1;
+		buffer.resize(ncols);
+		for (size_t j=0;ok && (j<nrows);j++)
+		{
+			if (entry->kind == LIBSNAPSHOT_MATRIX)
+			{
+				memcpy(&buffer[0],items[i].matrix->data+j*items[i].matrix->tda,ncols*sizeof(double));
+			}
+			else
+			{
+				for (size_t k=0;k<ncols;k++)	buffer[k] = gsl_vector_get(items[i].vector,k);
+			}
+			ok = (fwrite(&buffer[0],sizeof(double),ncols,fp) == ncols);
+			hash = snapshotChecksum(hash,&buffer[0],ncols*sizeof(double));
+			position += ncols*sizeof(double);
+		}
+	}
+	if (ok && (header.file_size > position))
+	{
+		size_t npad = header.file_size-position;
+		ok = (fwrite(padding,1,npad,fp) == npad);
+		hash = snapshotChecksum(hash,padding,npad);
+	}
+	header.data_checksum = hash;
+
+	// Header and index
+	hash = snapshotChecksum(14695981039346656037ULL,&header,sizeof(LibSnapshotHeader));
+	for (size_t i=0;i<items.size();i++)
+	{
+		hash = snapshotChecksum(hash,&items[i].entry,sizeof(LibSnapshotEntry));
+	}
+	LibSnapshotHeader final_header = header;
+	final_header.index_checksum = hash;
+	ok = ok && (fseek(fp,0,SEEK_SET) == 0);
+	ok = ok && (fwrite(&final_header,sizeof(LibSnapshotHeader),1,fp) == 1);
+	for (size_t i=0;ok && (i<items.size());i++)
+	{
+		ok = (fwrite(&items[i].entry,sizeof(LibSnapshotEntry),1,fp) == 1);
+	}
+	size_t npad = header.header_size-sizeof(LibSnapshotHeader)-items.size()*sizeof(LibSnapshotEntry);
+	ok = ok && (fwrite(padding,1,npad,fp) == npad);
+
+	if ((fclose(fp) != 0) || !ok)
+	{
+		remove(tmpname.c_str());
+		message = "Cannot write library snapshot file " + tmpname;
+		EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
+	}
+	if (rename(tmpname.c_str(),filename) != 0)
+	{
+		remove(tmpname.c_str());
+		message = "Cannot rename " + tmpname + " to " + string(filename);
+		EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
+	}
+
+	return(EPOK);
+}
+/*xxxx end of SECTION 3 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
+
+
+/***** SECTION 4 ************************************************************
+* isLibrarySnapshot function: This function returns 1 if 'filename' is a library snapshot file (it starts with 'LIBSNAPSHOT_MAGIC')
+*                             and 0 otherwise (FITS files, extended FITS file names, non existing files...).
+*
+* Parameters:
+* - filename: Name of the file
+******************************************************************************/
+extern "C" int isLibrarySnapshot(const char* const filename)
+{
+	FILE *fp = fopen(filename,"rb");
+	if (fp == NULL)	return(0);
+
+	char magic[16];
+	int is_snapshot = ((fread(magic,1,sizeof(magic),fp) == sizeof(magic))
+		&& (strncmp(magic,LIBSNAPSHOT_MAGIC,sizeof(magic)) == 0));
+	fclose(fp);
+
+	return(is_snapshot);
+}
+/*xxxx end of SECTION 4 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
+
+
+/***** SECTION 5 ************************************************************
+* checkSnapshotHeader function: This function checks the header and the index of a mapped snapshot (magic, version, byte order,
+*                               sizes and checksum). Every array of the index must lie inside the file.
+*
+* verifyLibrarySnapshot function: This function maps a snapshot file and checks its header, its index and the checksum of its arrays.
+*
+* Parameters:
+* - map: Snapshot file mapped into memory
+* - size: Size of the snapshot file
+* - filename: Name of the snapshot file
+******************************************************************************/
+static int checkSnapshotHeader(const char *map, size_t size, const char* const filename)
+{
+	string message = "";
+	const LibSnapshotHeader *header = (const LibSnapshotHeader *) map;
+
+	if ((size < sizeof(LibSnapshotHeader)) || (strncmp(header->magic,LIBSNAPSHOT_MAGIC,sizeof(header->magic)) != 0))
+	{
+		message = string(filename) + " is not a library snapshot file";
+		EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
+	}
+	if (header->byteorder != LIBSNAPSHOT_BYTEORDER)
+	{
+		message = "Library snapshot " + string(filename) + " has been created on a machine with a different byte order";
+		EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
+	}
+	if (header->version != LIBSNAPSHOT_VERSION)
+	{
+		char valueAux[256];
+		sprintf(valueAux,"%u (expected %d)",header->version,LIBSNAPSHOT_VERSION);
+		message = "Library snapshot " + string(filename) + " has version " + string(valueAux) + ": create it again with sirenasnapshot";
+		EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
+	}
+	if ((header->file_size != size) || (header->header_size > size) || (header->header_size < sizeof(LibSnapshotHeader)) || (header->header_size % LIBSNAPSHOT_ALIGN != 0)
+		|| (header->nentries > (header->header_size-sizeof(LibSnapshotHeader))/sizeof(LibSnapshotEntry)))
+	{
+		message = "Library snapshot " + string(filename) + " is truncated or corrupted";
+		EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
+	}
+
+	LibSnapshotHeader aux = *header;
+	aux.index_checksum = 0;
+	uint64_t hash = snapshotChecksum(14695981039346656037ULL,&aux,sizeof(LibSnapshotHeader));
+	hash = snapshotChecksum(hash,map+sizeof(LibSnapshotHeader),header->nentries*sizeof(LibSnapshotEntry));
+	if (hash != header->index_checksum)
+	{
+		message = "Wrong checksum of the header of the library snapshot " + string(filename);
+		EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
+	}
+
+	const LibSnapshotEntry *index = (const LibSnapshotEntry *) (map+sizeof(LibSnapshotHeader));
+	for (uint64_t i=0;i<header->nentries;i++)
+	{
+		const LibSnapshotEntry *entry = &index[i];
+		if (entry->kind == LIBSNAPSHOT_NULL)	continue;
+		// Number of elements (without overflowing with corrupted dimensions) and room left after the offset
+		uint64_t size2 = (entry->kind == LIBSNAPSHOT_MATRIX) ? entry->size2 : 1;
+		bool overflow = (size2 != 0) && (entry->size1 > UINT64_MAX/size2);
+		uint64_t nelements = overflow ? 0 : entry->size1*size2;
+		if (((entry->kind != LIBSNAPSHOT_VECTOR) && (entry->kind != LIBSNAPSHOT_MATRIX))
+			|| overflow || (nelements == 0) || (entry->offset % LIBSNAPSHOT_ALIGN != 0) || (entry->offset < header->header_size)
+			|| (entry->offset > size) || (nelements > (size-entry->offset)/sizeof(double)))
+		{
+			message = "Wrong entry in the index of the library snapshot " + string(filename);
+			EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
+		}
+	}
+
+	return(EPOK);
+}
+
+extern "C" int verifyLibrarySnapshot(const char* const filename)
+{
+	string message = "";
+
+	int fd = open(filename,O_RDONLY);
+	struct stat st;
+	if ((fd < 0) || (fstat(fd,&st) != 0))
+	{
+		if (fd >= 0)	close(fd);
+		message = "Cannot open library snapshot " + string(filename);
+		EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
+	}
+	size_t size = st.st_size;
+	void *map = (size > 0) ? mmap(NULL,size,PROT_READ,MAP_SHARED,fd,0) : MAP_FAILED;
+	close(fd);
+	if (map == MAP_FAILED)
+	{
+		message = "Cannot map library snapshot " + string(filename);
+		EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
+	}
+
+	int result = checkSnapshotHeader((const char *) map,size,filename);
+	if (result == EPOK)
+	{
+		const LibSnapshotHeader *header = (const LibSnapshotHeader *) map;
+		uint64_t hash = snapshotChecksum(14695981039346656037ULL,(const char *) map+header->header_size,size-header->header_size);
+		if (hash != header->data_checksum)
+		{
+			message = "Wrong checksum of the data of the library snapshot " + string(filename);
+			EP_PRINT_ERROR(message,EPFAIL); result = EPFAIL;
+		}
+	}
+	munmap(map,size);
+
+	return(result);
+}
+/*xxxx end of SECTION 5 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
+
+
+/***** SECTION 6 ************************************************************
+* getLibraryCollectionSnapshot function: This function creates and retrieves a LibraryCollection from a library snapshot file.
+*
+* The snapshot must have been created with the same options as the ones of the current run (it contains the library as loaded
+* by 'getLibraryCollection' with those options). The vectors and matrices point into the read-only mapping of the file (views which
+* do not own their data, so 'gsl_vector_free' and 'gsl_matrix_free' only free the structures), except the writable fields, which are
+* copied. The mapping is released in the destructor of the LibraryCollection.
+*
+* Parameters:
+* - filename: File name of the snapshot
+* - opmode: Calibration run (0) or energy reconstruction run (1); only 1 is allowed
+* - rest of parameters: As in 'getLibraryCollection'
+* - ofinterp: Optimal Filter by using the Matched Filter or the DAB as matched filter (MF/DAB), changed as in the FITS library
+* - status: Input/output status
+******************************************************************************/
+static gsl_vector* snapshotVector(const double *data, size_t size, bool writable)
+{
+	gsl_vector *vector;
+	if (writable)
+	{
+		vector = gsl_vector_alloc(size);
+		memcpy(vector->data,data,size*sizeof(double));
+	}
+	else
+	{
+		vector = (gsl_vector *) malloc(sizeof(gsl_vector));
+		*vector = gsl_vector_view_array((double *) data,size).vector;
+	}
+	return(vector);
+}
+
+static gsl_matrix* snapshotMatrix(const double *data, size_t size1, size_t size2)
+{
+	gsl_matrix *matrix = (gsl_matrix *) malloc(sizeof(gsl_matrix));
+	*matrix = gsl_matrix_view_array((double *) data,size1,size2).matrix;
+	return(matrix);
+}
+
+static void checkSnapshotOption(string &mismatch, const char *name, double snapshot_value, double value)
+{
+	if (snapshot_value != value)
+	{
+		char valueAux[256];
+		sprintf(valueAux,"%s=%g (requested %g) ",name,snapshot_value,value);
+		mismatch += valueAux;
+	}
+}
+
+static void checkSnapshotOption(string &mismatch, const char *name, const char *snapshot_value, const char *value)
+{
+	if (strncmp(snapshot_value,value,LIBSNAPSHOT_STRLEN) != 0)
+	{
+		mismatch += string(name) + "=" + string(snapshot_value) + " (requested " + string(value) + ") ";
+	}
+}
+
+LibraryCollection* getLibraryCollectionSnapshot(const char* const filename, int opmode, int hduPRECALWN, int hduPRCLOFWM, int largeFilter, char *filter_domain, int pulse_length, char *energy_method, char *ofnoise, char *filter_method, char oflib, char **ofinterp, double filtEev, int lagsornot, int preBuffer, int* const status)
+{
+	string message = "";
+
+	LibraryCollection* library_collection = new LibraryCollection;
+
+	if (opmode != 1)
+	{
+		message = "Library snapshots can only be used to reconstruct (opmode=1): use the library FITS file instead of " + string(filename);
+		EP_PRINT_ERROR(message,EPFAIL);
+		*status = EPFAIL; return(library_collection);
+	}
+
+	// Map the file
+	int fd = open(filename,O_RDONLY);
+	struct stat st;
+	if ((fd < 0) || (fstat(fd,&st) != 0))
+	{
+		if (fd >= 0)	close(fd);
+		message = "Cannot open library snapshot " + string(filename);
+		EP_PRINT_ERROR(message,EPFAIL);
+		*status = EPFAIL; return(library_collection);
+	}
+	size_t size = st.st_size;
+	void *map = (size > 0) ? mmap(NULL,size,PROT_READ,MAP_SHARED,fd,0) : MAP_FAILED;
+	close(fd);
+	if (map == MAP_FAILED)
+	{
+		message = "Cannot map library snapshot " + string(filename);
+		EP_PRINT_ERROR(message,EPFAIL);
+		*status = EPFAIL; return(library_collection);
+	}
+	library_collection->snapshot_map = map;
+	library_collection->snapshot_size = size;
+
+	const char *base = (const char *) map;
+	if (checkSnapshotHeader(base,size,filename))
+	{
+		*status = EPFAIL; return(library_collection);
+	}
+	const LibSnapshotHeader *header = (const LibSnapshotHeader *) base;
+	const LibSnapshotEntry *index = (const LibSnapshotEntry *) (base+sizeof(LibSnapshotHeader));
+
+	// The snapshot must have been created with the same options
+	string mismatch = "";
+	checkSnapshotOption(mismatch,"hduPRECALWN",header->hduPRECALWN,hduPRECALWN);
+	checkSnapshotOption(mismatch,"hduPRCLOFWM",header->hduPRCLOFWM,hduPRCLOFWM);
+	checkSnapshotOption(mismatch,"largeFilter",header->largeFilter,largeFilter);
+	checkSnapshotOption(mismatch,"PulseLength",header->pulse_length,pulse_length);
+	checkSnapshotOption(mismatch,"OFLib",header->oflib,oflib);
+	checkSnapshotOption(mismatch,"LagsOrNot",header->lagsornot,lagsornot);
+	checkSnapshotOption(mismatch,"preBuffer",header->preBuffer,preBuffer);
+	checkSnapshotOption(mismatch,"filtEeV",header->filtEev,filtEev);
+	checkSnapshotOption(mismatch,"FilterDomain",header->filter_domain,filter_domain);
+	checkSnapshotOption(mismatch,"EnergyMethod",header->energy_method,energy_method);
+	checkSnapshotOption(mismatch,"OFNoise",header->ofnoise,ofnoise);
+	checkSnapshotOption(mismatch,"FilterMethod",header->filter_method,filter_method);
+	checkSnapshotOption(mismatch,"OFInterp",header->ofinterp_in,*ofinterp);
+	if (mismatch != "")
+	{
+		message = "Library snapshot " + string(filename) + " has been created with different options: " + mismatch;
+		EP_PRINT_ERROR(message,EPFAIL);
+		*status = EPFAIL; return(library_collection);
+	}
+
+	library_collection->ntemplates = header->ntemplates;
+	library_collection->nfixedfilters = header->nfixedfilters;
+	library_collection->baseline = header->baseline;
+	int ntemplates = library_collection->ntemplates;
+
+	char *lc = (char *) library_collection;
+	for (uint64_t i=0;i<header->nentries;i++)
+	{
+		const LibSnapshotEntry *entry = &index[i];
+
+		const SnapshotField *field = NULL;
+		for (int f=0;f<snapshot_nfields;f++)
+		{
+			if (strncmp(entry->name,snapshot_fields[f].name,LIBSNAPSHOT_NAMELEN) == 0)
+			{
+				field = &snapshot_fields[f];
+				break;
+			}
+		}
+		bool is_array = (field != NULL) && (field->type != SNAP_VECTOR) && (field->type != SNAP_MATRIX);
+		int expected_kind = ((field != NULL) && (field->type == SNAP_MATRIX)) ? LIBSNAPSHOT_MATRIX : LIBSNAPSHOT_VECTOR;
+		if ((field == NULL)
+			|| (is_array && ((entry->row < 0) || (entry->row >= ntemplates) || ((entry->kind != LIBSNAPSHOT_NULL) && (entry->kind != expected_kind))))
+			|| (!is_array && ((entry->row != -1) || (entry->kind != expected_kind))))
+		{
+			message = "Unexpected entry in the index of the library snapshot " + string(filename);
+			EP_PRINT_ERROR(message,EPFAIL);
+			*status = EPFAIL; return(library_collection);
+		}
+
+		const double *data = (const double *) (base+entry->offset);
+		void **ptr = (void **) (lc+field->offset);
+		gsl_vector *vector = (entry->kind == LIBSNAPSHOT_VECTOR) ? snapshotVector(data,entry->size1,field->writable) : NULL;
+		if (field->type == SNAP_VECTOR)
+		{
+			*ptr = vector;
+		}
+		else if (field->type == SNAP_MATRIX)
+		{
+			*ptr = snapshotMatrix(data,entry->size1,entry->size2);
+		}
+		else if (field->type == SNAP_TEMPLATES)
+		{
+			if (*ptr == NULL)	*ptr = new PulseTemplate[ntemplates];
+			PulseTemplate *pt = (PulseTemplate *) *ptr+entry->row;
+			pt->template_duration = entry->duration;
+			pt->energy = entry->energy;
+			pt->pulse_height = entry->pulse_height;
+			pt->ptemplate = vector;
+		}
+		else if (field->type == SNAP_MFILTERS)
+		{
+			if (*ptr == NULL)	*ptr = new MatchedFilter[ntemplates];
+			MatchedFilter *mf = (MatchedFilter *) *ptr+entry->row;
+			mf->mfilter_duration = entry->duration;
+			mf->energy = entry->energy;
+			mf->pulse_height = entry->pulse_height;
+			mf->mfilter = vector;
+		}
+		else
+		{
+			if (*ptr == NULL)	*ptr = new OptimalFilterSIRENA[ntemplates];
+			OptimalFilterSIRENA *of = (OptimalFilterSIRENA *) *ptr+entry->row;
+			of->ofilter_duration = entry->duration;
+			of->energy = entry->energy;
+			of->ofilter = vector;
+		}
+	}
+
+	if ((library_collection->energies == NULL) || (library_collection->pulse_templates == NULL))
+	{
+		message = "Library snapshot " + string(filename) + " does not contain the energies or the templates";
+		EP_PRINT_ERROR(message,EPFAIL);
+		*status = EPFAIL; return(library_collection);
+	}
+
+	strcpy(*ofinterp,header->ofinterp);
+
+	return(library_collection);
+}
+/*xxxx end of SECTION 6 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
+
+
+/***** SECTION 7 ************************************************************
+* createLibrarySnapshotSIRENA function: This function loads a library FITS file as in the energy reconstruction (opmode=1) and writes
+*                                      it into a binary snapshot file. The written snapshot is verified.
+*
+* Parameters:
+* - library_file: File name of the library FITS file
+* - snapshot_file: File name of the snapshot
+* - rest of parameters: As in 'initializeReconstructionSIRENA' (the snapshot can only be used with the same values)
+* - clobber: Overwrite or not the snapshot file if it exists
+* - status: Input/output status
+******************************************************************************/
+extern "C" void createLibrarySnapshotSIRENA(char* const library_file, char* const snapshot_file, int pulse_length, char* filter_domain, char* filter_method,
+		char* energy_method, double filtEev, char *ofnoise, int lagsornot, char oflib, char *ofinterp, int preBuffer,
+		char hduPRECALWN, char hduPRCLOFWM, char clobber, int* const status)
+{
+	string message = "";
+
+	if ((clobber == 0) && (access(snapshot_file,F_OK) == 0))
+	{
+		message = "Library snapshot " + string(snapshot_file) + " already exists: must not be overwritten (clobber=no)";
+		EP_PRINT_ERROR(message,EPFAIL);
+		*status = EPFAIL; return;
+	}
+
+	// As in 'initializeReconstructionSIRENA' for opmode=1
+	int largeFilter = pulse_length;
+	char ofinterp_out[LIBSNAPSHOT_STRLEN];
+	strncpy(ofinterp_out,ofinterp,LIBSNAPSHOT_STRLEN-1);
+	ofinterp_out[LIBSNAPSHOT_STRLEN-1] = '\0';
+	char *ofinterp_ptr = ofinterp_out;
+
+	LibraryCollection* library_collection = getLibraryCollection(library_file, 1, hduPRECALWN, hduPRCLOFWM, largeFilter, filter_domain, pulse_length, energy_method, ofnoise, filter_method, oflib, &ofinterp_ptr, filtEev, lagsornot, preBuffer, status);
+	if (*status)
+	{
+		EP_PRINT_ERROR("Error in getLibraryCollection",EPFAIL);
+		delete library_collection; return;
+	}
+
+	LibSnapshotHeader options;
+	memset(&options,0,sizeof(LibSnapshotHeader));
+	options.hduPRECALWN = hduPRECALWN;
+	options.hduPRCLOFWM = hduPRCLOFWM;
+	options.largeFilter = largeFilter;
+	options.pulse_length = pulse_length;
+	options.oflib = oflib;
+	options.lagsornot = lagsornot;
+	options.preBuffer = preBuffer;
+	options.filtEev = filtEev;
+	strncpy(options.filter_domain,filter_domain,LIBSNAPSHOT_STRLEN-1);
+	strncpy(options.energy_method,energy_method,LIBSNAPSHOT_STRLEN-1);
+	strncpy(options.ofnoise,ofnoise,LIBSNAPSHOT_STRLEN-1);
+	strncpy(options.filter_method,filter_method,LIBSNAPSHOT_STRLEN-1);
+	strncpy(options.ofinterp_in,ofinterp,LIBSNAPSHOT_STRLEN-1);
+	strncpy(options.ofinterp,ofinterp_out,LIBSNAPSHOT_STRLEN-1);
+
+	if (writeLibrarySnapshot(library_collection,&options,snapshot_file))
+	{
+		EP_PRINT_ERROR("Error in writeLibrarySnapshot",EPFAIL);
+		*status = EPFAIL;
+	}
+	else if (verifyLibrarySnapshot(snapshot_file))
+	{
+		EP_PRINT_ERROR("Error in verifyLibrarySnapshot",EPFAIL);
+		*status = EPFAIL;
+	}
+
+	delete library_collection;
+}
+/*xxxx end of SECTION 7 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
@@ -0,0 +1,153 @@
+/***********************************************************************
+   This file is part of SIXTE/SIRENA software.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+***********************************************************************
+*                      LIBSNAPSHOTSIRENA
+*
+*  File:       libsnapshotSIRENA.h
+*
+*  Binary snapshots of the SIRENA reconstruction libraries
+*
+***********************************************************************/
+
+#ifndef LIBSNAPSHOTSIRENA_H
+#define LIBSNAPSHOTSIRENA_H 1
+
+#include <stdint.h>
+
+#include "integraSIRENA.h"
+
+// First bytes of a library snapshot file
+#define LIBSNAPSHOT_MAGIC "SIRENA-LIBSNAP"
+
+// Version of the snapshot format (to be increased whenever the layout changes)
+#define LIBSNAPSHOT_VERSION 1
+
+// Alignment (bytes) of the arrays in the snapshot file
+#define LIBSNAPSHOT_ALIGN 64
+
+// Length of the character fields of the snapshot header
+#define LIBSNAPSHOT_STRLEN 32
+
+// Length of the field names of the snapshot index
+#define LIBSNAPSHOT_NAMELEN 48
+
+// Kind of the data of an entry of the snapshot index
+#define LIBSNAPSHOT_NULL   0
+#define LIBSNAPSHOT_VECTOR 1
+#define LIBSNAPSHOT_MATRIX 2
+
+typedef struct LibSnapshotHeader
+{
+	/** LIBSNAPSHOT_MAGIC */
+	char magic[16];
+
+	/** LIBSNAPSHOT_VERSION */
+	uint32_t version;
+
+	/** 0x01020304 as written by the machine which created the snapshot (byte order check) */
+	uint32_t byteorder;
+
+	/** Size of the header and the index (offset of the first array) */
+	uint64_t header_size;
+
+	/** Size of the whole file */
+	uint64_t file_size;
+
+	/** Number of entries of the index */
+	uint64_t nentries;
+
+	/** Checksum of the header and the index (computed with 'index_checksum' set to 0) */
+	uint64_t index_checksum;
+
+	/** Checksum of the arrays (from 'header_size' to 'file_size') */
+	uint64_t data_checksum;
+
+	/** Scalars of the LibraryCollection */
+	int32_t ntemplates;
+	int32_t nfixedfilters;
+	double baseline;
+
+	/** Options the FITS library was loaded with ('getLibraryCollection') */
+	int32_t hduPRECALWN;
+	int32_t hduPRCLOFWM;
+	int32_t largeFilter;
+	int32_t pulse_length;
+	int32_t oflib;
+	int32_t lagsornot;
+	int32_t preBuffer;
+	int32_t reserved;
+	double filtEev;
+	char filter_domain[LIBSNAPSHOT_STRLEN];
+	char energy_method[LIBSNAPSHOT_STRLEN];
+	char ofnoise[LIBSNAPSHOT_STRLEN];
+	char filter_method[LIBSNAPSHOT_STRLEN];
+	/** OFInterp requested and OFInterp resulting from the library content */
+	char ofinterp_in[LIBSNAPSHOT_STRLEN];
+	char ofinterp[LIBSNAPSHOT_STRLEN];
+
+} LibSnapshotHeader;
+
+typedef struct LibSnapshotEntry
+{
+	/** Name of the LibraryCollection field */
+	char name[LIBSNAPSHOT_NAMELEN];
+
+	/** Row of the template/filter for arrays of templates/filters (-1 otherwise) */
+	int32_t row;
+
+	/** LIBSNAPSHOT_NULL, LIBSNAPSHOT_VECTOR or LIBSNAPSHOT_MATRIX */
+	int32_t kind;
+
+	/** Duration, energy and pulse height of the template/filter */
+	int32_t duration;
+	int32_t reserved;
+	double energy;
+	double pulse_height;
+
+	/** Dimensions of the array (size2=0 for vectors) */
+	uint64_t size1;
+	uint64_t size2;
+
+	/** Offset of the array in the file (multiple of LIBSNAPSHOT_ALIGN) */
+	uint64_t offset;
+
+} LibSnapshotEntry;
+
+#ifdef __cplusplus
+extern "C"
+#endif
+void createLibrarySnapshotSIRENA(char* const library_file, char* const snapshot_file, int pulse_length, char* filter_domain, char* filter_method,
+		char* energy_method, double filtEev, char *ofnoise, int lagsornot, char oflib, char *ofinterp, int preBuffer,
+		char hduPRECALWN, char hduPRCLOFWM, char clobber, int* const status);
+
+#ifdef __cplusplus
+extern "C"
+#endif
+int isLibrarySnapshot(const char* const filename);
+
+#ifdef __cplusplus
+extern "C"
+#endif
+int verifyLibrarySnapshot(const char* const filename);
+
+#ifdef __cplusplus
+int writeLibrarySnapshot(LibraryCollection *library_collection, LibSnapshotHeader *options, const char* const filename);
+
+LibraryCollection* getLibraryCollectionSnapshot(const char* const filename, int opmode, int hduPRECALWN, int hduPRCLOFWM, int largeFilter, char *filter_domain, int pulse_length, char *energy_method, char *ofnoise, char *filter_method, char oflib, char **ofinterp, double filtEev, int lagsornot, int preBuffer, int* const status);
+#endif
+
+#endif
@@ -22,12 +22,34 @@
 
 #include "linkedpholist.h"
 
+
+/** Number of elements allocated at once. */
+#define LINKEDPHOLIST_BLOCKSIZE (4096)
+
+/** Released elements (linked via 'next'), which are handed out again
+    by newLinkedPhoListElement(). The blocks of elements are kept
+    until the end of the program. */
+static LinkedPhoListElement* unused_elements=NULL;
+
+
 LinkedPhoListElement* newLinkedPhoListElement(int* const status)
 {
-  LinkedPhoListElement* el=
-    (LinkedPhoListElement*)malloc(sizeof(LinkedPhoListElement));
-  CHECK_NULL(el, *status,
-	     "memory allocation for LinkedPhoListElement failed");
+  if (NULL==unused_elements) {
+    LinkedPhoListElement* block=(LinkedPhoListElement*)
+      malloc(LINKEDPHOLIST_BLOCKSIZE*sizeof(LinkedPhoListElement));
+    CHECK_NULL(block, *status,
+	       "memory allocation for LinkedPhoListElement failed");
+    SIXT_PROF_COUNT(SIXT_PROF_ALLOCATIONS, 1);
+    long ii;
+    for (ii=0; ii<LINKEDPHOLIST_BLOCKSIZE-1; ii++) {
+      block[ii].next=&block[ii+1];
+    }
+    block[LINKEDPHOLIST_BLOCKSIZE-1].next=NULL;
+    unused_elements=block;
+  }
+
+  LinkedPhoListElement* el=unused_elements;
+  unused_elements=el->next;
 
   // Initialize pointers with NULL.
   el->next=NULL;
@@ -36,15 +58,21 @@ LinkedPhoListElement* newLinkedPhoListElement(int* const status)
 }
 
 
-void freeLinkedPhoList(LinkedPhoListElement** const list)
+void releaseLinkedPhoListElement(LinkedPhoListElement* const el)
 {
-  if (NULL!=*list) {
-    if (NULL!=(*list)->next) {
-      freeLinkedPhoList(&((*list)->next));
-    }
+  if (NULL!=el) {
+    el->next=unused_elements;
+    unused_elements=el;
+  }
+}
 
-    free(*list);
-    *list=NULL;
+
+void freeLinkedPhoList(LinkedPhoListElement** const list)
+{
+  while (NULL!=*list) {
+    LinkedPhoListElement* next=(*list)->next;
+    releaseLinkedPhoListElement(*list);
+    *list=next;
   }
 }
 
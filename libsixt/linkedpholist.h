@@ -24,6 +24,7 @@
 #define LINKEDPHOLIST_H 1
 
 #include "sixt.h"
+#include "profiling.h"
 #include "photon.h"
 
 
@@ -48,10 +49,16 @@ typedef struct structLinkedPhoListElement LinkedPhoListElement;
 /////////////////////////////////////////////////////////////////
 
 
-/** Constructor. */
+/** Constructor. The elements are allocated in blocks and released
+    elements are reused, so a single element must be released with
+    releaseLinkedPhoListElement() instead of free(). The pool is not
+    thread-safe. */
 LinkedPhoListElement* newLinkedPhoListElement(int* const status);
 
-/** Destructor. */
+/** Return a single element to the pool. */
+void releaseLinkedPhoListElement(LinkedPhoListElement* const el);
+
+/** Destructor. Releases all elements of the list. */
 void freeLinkedPhoList(LinkedPhoListElement** const list);
 
 /** Merge 2 time-ordered linked photon lists. */
@@ -126,3 +126,19 @@ double genrand_real3(void)
     return (((double)genrand_int32()) + 0.5)*(1.0/4294967296.0); 
     /* divided by 2^32 */
 }
+
+/* copies the state vector and the current position in it */
+void get_genrand_state(unsigned long state[N], int* const index)
+{
+    int kk;
+    for (kk=0;kk<N;kk++) state[kk]=mt[kk];
+    *index=mti;
+}
+
+/* restores a state obtained with get_genrand_state() */
+void set_genrand_state(const unsigned long state[N], const int index)
+{
+    int kk;
+    for (kk=0;kk<N;kk++) mt[kk]=state[kk];
+    mti=index;
+}
@@ -71,5 +71,11 @@ double genrand_real2(void);
 /* generates a random number on (0,1)-real-interval */
 double genrand_real3(void);
 
+/* copies the state vector and the current position in it */
+void get_genrand_state(unsigned long state[N], int* const index);
+
+/* restores a state obtained with get_genrand_state() */
+void set_genrand_state(const unsigned long state[N], const int index);
+
 
 #endif
@@ -102,6 +102,7 @@ void destroy_name_list(name_list_t *list)
   {
     free(list->names[ii]);
   }
+  free(list->names);
   free(list);
 }
 
@@ -49,6 +49,11 @@ int get_num_files_in_list(char *list, char delim);
  */
 name_list_t *split_list(const char *str, char delim);
 
+/*
+ * Release the memory of a list
+ */
+void destroy_name_list(name_list_t *list);
+
 /*
  * Merge to lists into a new one
  * The old lists will be freed!
@@ -308,30 +308,58 @@ void pha2pi_correct_event(Event* const evt, const Pha2Pi* const p2p,
 	}
 }
 
-void pha2pi_correct_eventfile(EventFile* const evtfile, const Pha2Pi* const p2p,
-		const char* RSPPath, const char* RESPfile, int* const status) {
+/** Data of the EventTransform of the pha2pi correction. */
+typedef struct {
+	const Pha2Pi* p2p;
+
+	/** EBOUNDS of the RMF used for the PI binning. */
+	struct RMF* rmf;
+} Pha2PiTransform;
+
+static void freePha2PiTransform(void* const data) {
+	Pha2PiTransform* t = (Pha2PiTransform*) data;
+	if (NULL != t->rmf) {
+		freeRMF(t->rmf);
+	}
+	free(t);
+}
+
+/** EventTransformFct of the pha2pi correction. */
+static void pha2pi_transform_events(EventFile* const file, const long firstrow,
+		Event* const events, const long nevents, void* const data,
+		int* const status) {
+	(void) file;
+	(void) firstrow;
+	const Pha2PiTransform* t = (const Pha2PiTransform*) data;
+	for (long ii = 0; ii < nevents; ii++) {
+		pha2pi_correct_event(&events[ii], t->p2p, t->rmf, status);
+		CHECK_STATUS_VOID(*status);
+	}
+}
+
+EventTransform* newPha2PiTransform(EventFile* const evtfile,
+		const Pha2Pi* const p2p, const char* RSPPath, const char* RESPfile,
+		int* const status) {
 
 	// Do nothing if the Pha2Pi structure is uninitialized
 	if (p2p == NULL) {
-		return;
+		return NULL;
 	}
 
-	headas_chat(3, "run pha2pi correction on event file ...\n");
-
 	// Read the eventfile RESPFILE keyword.
 	char comment[MAXMSG];
 	char evtrmf[MAXMSG];
 	fits_movnam_hdu(evtfile->fptr, BINARY_TBL, "EVENTS", 0, status);
-	CHECK_STATUS_VOID(*status);
+	CHECK_STATUS_RET(*status, NULL);
 	fits_read_key(evtfile->fptr, TSTRING, "RESPFILE", &evtrmf, comment, status);
-	CHECK_STATUS_VOID(*status);
+	CHECK_STATUS_RET(*status, NULL);
 
 	// CHECK if eventfile & Pha2Pi file were created with the same RMF
 	if (strcmp(evtrmf, p2p->rmffile) != 0) {
 		*status = EXIT_FAILURE;
 		SIXT_ERROR(
 				"RESPfile keyword of EventFile and Pha2Pi are different, but must be the same!");
-		return;
+		return NULL;
 	}
 
 	// CHECK whether the user demands a different RMF:
@@ -357,7 +385,7 @@ void pha2pi_correct_eventfile(EventFile* const evtfile, const Pha2Pi* const p2p,
 		sprintf(msg, "RESPfile '%s' not accessible!", resppathname);
 		SIXT_ERROR(msg);
 		*status = EXIT_FAILURE;
-		return;
+		return NULL;
 	} else if (strcmp(respfile, p2p->rmffile) != 0) {
 		char msg[MAXMSG];
 		sprintf(msg, "pha2pi: Using RMF='%s' for PI binning instead of '%s'!\n",
@@ -367,55 +395,69 @@ void pha2pi_correct_eventfile(EventFile* const evtfile, const Pha2Pi* const p2p,
 
 	// Load the EBOUNDS of the RMF that will be used in the pi correction.
 	// Some fields, e.g., FirstChannel, will not be loaded!
-	struct RMF* rmf = getRMF(status);
-	loadEbounds(rmf, resppathname, status);
-	CHECK_STATUS_VOID(*status);
+	Pha2PiTransform* data = (Pha2PiTransform*) malloc(sizeof(Pha2PiTransform));
+	CHECK_MALLOC_RET_NULL_STATUS(data, *status);
+	data->p2p = p2p;
+	data->rmf = getRMF(status);
+	EventTransform* transform = newEventTransform(pha2pi_transform_events,
+			freePha2PiTransform, data, EVENTCOL_PHA | EVENTCOL_TYPE | EVENTCOL_PI,
+			EVENTCOL_PI, status);
+	if (NULL == transform) {
+		freePha2PiTransform(data);
+		return NULL;
+	}
+	loadEbounds(data->rmf, resppathname, status);
+	CHECK_STATUS_RET(*status, transform);
 
 	// Add 'PI' column to evtfile if necessary
 	if (evtfile->cpi == 0) {
 		evtfile->cpi = evtfile->cpha + 1;
 		addCol2EventFile(evtfile, &evtfile->cpi, "PI", "J", "ADU", status);
-		CHECK_STATUS_VOID(*status);
+		CHECK_STATUS_RET(*status, transform);
 	}
 
-	// Loop over all events in the input list.
-	long ii;
-	for (ii = 1; ii <= evtfile->nrows; ii++) {
-		// Get event
-		Event* event = getEvent(status);
-		CHECK_STATUS_BREAK(*status);
-		getEventFromFile(evtfile, ii, event, status);
-		CHECK_STATUS_BREAK(*status);
+	fits_update_key_longstr(evtfile->fptr, "PHA2PI", p2p->pha2pi_filename,
+				"Pha2Pi correction file", status);
+	if (p2p->pirmf_filename != NULL && strlen(p2p->pirmf_filename) > 0) {
+		fits_update_key(evtfile->fptr, TSTRING, "PIRMF",
+				p2p->pirmf_filename, "PI-RMF needed for PI values", status);
+	} else {
+		headas_chat(5,
+				" 'PIRMF' Key not written to eventfile as not given!\n");
+	}
+	if (p2p->specarf_filename != NULL
+			&& strlen(p2p->specarf_filename) > 0) {
+		fits_update_key(evtfile->fptr, TSTRING, "SPECARF",
+				p2p->specarf_filename, "calibrated ARF for analysis",
+				status);
+	} else {
+		headas_chat(5,
+				" 'SPECARF' Key not written to eventfile as not given!\n");
+	}
 
-		// run pi correction on event
-		pha2pi_correct_event(event, p2p, rmf, status);
+	return (transform);
+}
 
-		// Save changes to eventfile
-		updateEventInFile(evtfile, ii, event, status);
-		CHECK_STATUS_BREAK(*status);
+void pha2pi_correct_eventfile(EventFile* const evtfile, const Pha2Pi* const p2p,
+		const char* RSPPath, const char* RESPfile, int* const status) {
 
-		// Release memory.
-		freeEvent(&event);
+	// Do nothing if the Pha2Pi structure is uninitialized
+	if (p2p == NULL) {
+		return;
+	}
+
+	headas_chat(3, "run pha2pi correction on event file ...\n");
+
+	EventTransform* transform = newPha2PiTransform(evtfile, p2p, RSPPath,
+			RESPfile, status);
+	if (*status == EXIT_SUCCESS) {
+		// Loop over all events in the input list (reading and writing
+		// only the columns needed for the correction).
+		runEventTransforms(evtfile, &transform, 1, status);
 	}
+	freeEventTransform(&transform);
+
 	if (*status == EXIT_SUCCESS) {
-		fits_update_key_longstr(evtfile->fptr, "PHA2PI", p2p->pha2pi_filename,
-					"Pha2Pi correction file", status);
-		if (p2p->pirmf_filename != NULL && strlen(p2p->pirmf_filename) > 0) {
-			fits_update_key(evtfile->fptr, TSTRING, "PIRMF",
-					p2p->pirmf_filename, "PI-RMF needed for PI values", status);
-		} else {
-			headas_chat(5,
-					" 'PIRMF' Key not written to eventfile as not given!\n");
-		}
-		if (p2p->specarf_filename != NULL
-				&& strlen(p2p->specarf_filename) > 0) {
-			fits_update_key(evtfile->fptr, TSTRING, "SPECARF",
-					p2p->specarf_filename, "calibrated ARF for analysis",
-					status);
-		} else {
-			headas_chat(5,
-					" 'SPECARF' Key not written to eventfile as not given!\n");
-		}
 		headas_chat(5, " ... Pha2PI correction successful!\n");
 		return;
 	} else {
@@ -26,6 +26,7 @@
 #include "sixt.h"
 #include "event.h"
 #include "eventfile.h"
+#include "eventtransform.h"
 #include "rmf.h"
 #include "geninst.h"
 
@@ -97,6 +98,17 @@ void pha2pi_correct_event(Event* const evt,
 		const struct RMF* const rmf,
 		int* const status);
 
+/** Prepare the pha2pi correction of an eventfile (check the RMF, add
+    the PI column and the header keywords) and return it as
+    EventTransform, which can be run together with other
+    transforms. Returns NULL if the Pha2Pi structure is
+    uninitialized. */
+EventTransform* newPha2PiTransform(EventFile* const evtfile,
+		const Pha2Pi* const p2p,
+		const char* RSPPath,
+		const char* RESPfile,
+		int* const status);
+
 /** Do the pha2pi correction on a eventfile. */
 void pha2pi_correct_eventfile(EventFile* const evtfile,
 		const Pha2Pi* const p2p,
@@ -28,6 +28,8 @@ void phdetGenDet(GenDet* const det,
 		 const double tend,
 		 int* const status)
 {
+  SIXT_PROF_BEGIN(SIXT_PROF_PHDET);
+
   double operation_time;
   if (NULL==impact) {
     // If no impact has been given as parameter, finalize the GenDet.
@@ -60,4 +62,6 @@ void phdetGenDet(GenDet* const det,
     }
     CHECK_STATUS_VOID(*status);
   }
+
+  SIXT_PROF_END(SIXT_PROF_PHDET);
 }
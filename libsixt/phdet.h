@@ -24,6 +24,7 @@
 #define PHDET_H 1
 
 #include "sixt.h"
+#include "profiling.h"
 #include "gendet.h"
 #include "impact.h"
 
@@ -23,6 +23,16 @@
 #include "phgen.h"
 
 
+/** Photon list buffer. */
+static LinkedPhoListElement* pholist=NULL;
+
+/** Counter for the photon IDs. */
+static long long ph_id=0;
+
+/** Time up to which photons have been generated. */
+static double gentime=0.;
+
+
 int phgen(Attitude* const ac,
 	  SourceCatalog** const srccat,
 	  const unsigned int ncat,
@@ -34,22 +44,18 @@ int phgen(Attitude* const ac,
 	  Photon* const ph,
 	  int* const status)
 {
-  // Photon list buffer.
-  static LinkedPhoListElement* pholist=NULL;
-  // Counter for the photon IDs.
-  static long long ph_id=0;
+  SIXT_PROF_BEGIN(SIXT_PROF_PHGEN);
 
   // Current time.
-  static double time=0.;
-  if (time<t0) {
-    time=t0;
+  if (gentime<t0) {
+    gentime=t0;
   }
 
   // If the photon list is empty generate new photons from the
   // given source catalog.
-  while((NULL==pholist)&&(time<tend)) {
+  while((NULL==pholist)&&(gentime<tend)) {
     // Determine the telescope pointing at the current point of time.
-    Vector pointing=getTelescopeNz(ac, time, status);
+    Vector pointing=getTelescopeNz(ac, gentime, status);
     CHECK_STATUS_BREAK(*status);
 
     // Display the program progress status.
@@ -57,7 +63,7 @@ int phgen(Attitude* const ac,
     calculate_ra_dec(pointing, &ra, &dec);
 
     // Generate new photons for all specified catalogs.
-    double t1=MIN(time+dt, tend);
+    double t1=MIN(gentime+dt, tend);
     unsigned int ii;
     for (ii=0; ii<ncat; ii++) {
       if (NULL==srccat[ii]) continue;
@@ -65,7 +71,7 @@ int phgen(Attitude* const ac,
       // Get photons for all sources in the catalog.
       LinkedPhoListElement* newlist=
 	genFoVXRayPhotons(srccat[ii], &pointing, fov,
-			  time, t1, mjdref, status);
+			  gentime, t1, mjdref, status);
       CHECK_STATUS_BREAK(*status);
 
       // Merge the photon lists.
@@ -73,22 +79,43 @@ int phgen(Attitude* const ac,
     }
 
     // Increase the time.
-    time+=dt;
+    gentime+=dt;
   }
 
   // If there is no photon in the buffer.
-  if (NULL==pholist) return(0);
+  if (NULL==pholist) {
+    SIXT_PROF_END(SIXT_PROF_PHGEN);
+    return(0);
+  }
 
   // Take the first photon from the list and return it.
   copyPhoton(ph, &pholist->photon);
 
   // Delete the processed element.
   LinkedPhoListElement* next=pholist->next;
-  free(pholist);
+  releaseLinkedPhoListElement(pholist);
   pholist=next;
 
   // Set the photon ID.
   ph->ph_id=++ph_id;
 
+  SIXT_PROF_COUNT(SIXT_PROF_PHOTONS, 1);
+  SIXT_PROF_END(SIXT_PROF_PHGEN);
   return(1);
 }
+
+
+int getPhgenState(double* const time, long long* const id)
+{
+  *time=gentime;
+  *id=ph_id;
+  return((NULL==pholist) ? 1 : 0);
+}
+
+
+void setPhgenState(const double time, const long long id)
+{
+  freeLinkedPhoList(&pholist);
+  gentime=time;
+  ph_id=id;
+}
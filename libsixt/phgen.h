@@ -24,6 +24,7 @@
 #define PHGEN_H 1
 
 #include "sixt.h"
+#include "profiling.h"
 #include "attitude.h"
 #include "gendet.h"
 #include "photon.h"
@@ -46,5 +47,15 @@ int phgen(Attitude* const ac,
 	  Photon* const ph,
 	  int* const status);
 
+/** Get the state of the photon generation, i.e., the time up to which
+    photons have been generated and the ID of the last photon. Returns
+    1, if all generated photons have been taken from the buffer, such
+    that the state completely describes the photon generation. */
+int getPhgenState(double* const time, long long* const id);
+
+/** Restore a state obtained with getPhgenState(). Photons remaining
+    in the buffer are discarded. */
+void setPhgenState(const double time, const long long id);
+
 
 #endif /* PHGEN_H */
@@ -23,19 +23,22 @@
 #include "phimg.h"
 
 
-int phimg(GenTel* const tel,
-	  Attitude* const ac,
-	  Photon* const ph,
-	  Impact* const imp,
-	  int* const status)
+static int imagePhoton(GenTel* const tel,
+		       Attitude* const ac,
+		       Photon* const ph,
+		       Impact* const imp,
+		       int* const status)
 {
   // Calculate the minimum cos-value for sources inside the FOV:
   // (angle(x0,source) <= 1/2 * diameter)
   const double fov_min_align=cos(tel->fov_diameter/2.);
 
-  // Determine the telescope pointing direction at the current time.
+  // Determine telescope data like pointing direction (attitude) etc.
+  // at the current time. The telescope coordinate system consists
+  // of an x-, y-, and z-axis.
   struct Telescope telescope;
-  telescope.nz=getTelescopeNz(ac, ph->time, status);
+  getTelescopeFrame(ac, &telescope.nx, &telescope.ny, &telescope.nz,
+		    ph->time, status);
   CHECK_STATUS_RET(*status, 0);
 
   // Check whether the photon is inside the FOV.
@@ -44,12 +47,6 @@ int phimg(GenTel* const tel,
   if (check_fov(&photon_direction, &telescope.nz, fov_min_align)==0) {
     // Photon is inside the FOV!
 
-    // Determine telescope data like pointing direction (attitude) etc.
-    // The telescope coordinate system consists of an x-, y-, and z-axis.
-    getTelescopeAxes(ac, &telescope.nx, &telescope.ny, &telescope.nz,
-		     ph->time, status);
-    CHECK_STATUS_RET(*status, 0);
-
     // Determine the photon impact position on the detector (in [m]).
 
     // Convolution with PSF:
@@ -90,3 +87,19 @@ int phimg(GenTel* const tel,
   }
   // End of FOV check.
 }
+
+
+int phimg(GenTel* const tel,
+	  Attitude* const ac,
+	  Photon* const ph,
+	  Impact* const imp,
+	  int* const status)
+{
+  SIXT_PROF_BEGIN(SIXT_PROF_PHIMG);
+  int isimg=imagePhoton(tel, ac, ph, imp, status);
+  if (0!=isimg) {
+    SIXT_PROF_COUNT(SIXT_PROF_IMPACTS, 1);
+  }
+  SIXT_PROF_END(SIXT_PROF_PHIMG);
+  return(isimg);
+}
@@ -24,6 +24,7 @@
 #define PHIMG_H 1
 
 #include "sixt.h"
+#include "profiling.h"
 #include "attitude.h"
 #include "check_fov.h"
 #include "gentel.h"
@@ -218,6 +218,7 @@ int PhotonFile_getRow(PhotonFile* const plf,
     SIXT_ERROR("photon list file does not contain the requested line");
     return(EXIT_FAILURE);
   }
+  SIXT_PROF_COUNT(SIXT_PROF_ROWS_READ, 1);
 
   // Read in the data.
   ph->time=0.;
@@ -269,6 +270,7 @@ int addPhoton2File(PhotonFile* const plf, Photon* const ph)
 
   plf->row++;
   plf->nrows++;
+  SIXT_PROF_COUNT(SIXT_PROF_ROWS_WRITTEN, 1);
 
   // Convert from [rad] -> [deg]:
   double ra =ph->ra *180./M_PI;
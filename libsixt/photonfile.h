@@ -24,6 +24,7 @@
 #define PHOTONFILE_H 1
 
 #include "sixt.h"
+#include "profiling.h"
 #include "photon.h"
 
 
@@ -61,6 +61,7 @@ void phpat(GenDet* const det,
 	   const char skip_invalids,
 	   int* const status)
 {
+  SIXT_PROF_BEGIN(SIXT_PROF_PHPAT);
 
   // Pattern / grade statistics.
   struct PatternStatistics statistics={
@@ -75,8 +76,12 @@ void phpat(GenDet* const det,
     statistics.npgrade[ii]=0;
   }
 
-  // List of all events belonging to the current frame.
+  // List of all events belonging to the current frame. The events
+  // themselves are stored in a pre-allocated array, which is re-used
+  // for each frame. Events that have already been assigned to a
+  // pattern are removed from the list by setting the pointer to NULL.
   const long maxnframelist=10000;
+  Event* frameevents=NULL;
   Event** framelist=NULL;
   long nframelist=0;
 
@@ -114,6 +119,9 @@ void phpat(GenDet* const det,
     CHECK_STATUS_BREAK_WITH_FITSERROR(*status);
 
     // Allocate memory.
+    frameevents=(Event*)malloc(maxnframelist*sizeof(Event));
+    CHECK_NULL_BREAK(frameevents, *status,
+		     "memory allocation for frame list failed");
     framelist=(Event**)malloc(maxnframelist*sizeof(Event*));
     CHECK_NULL_BREAK(framelist, *status,
 		     "memory allocation for frame list failed");
@@ -141,10 +149,10 @@ void phpat(GenDet* const det,
 
       // Read the next event from the file, if the end has not been
       // reached so far.
+      Event rowevent;
       Event* event=NULL;
       if (ii<src->nrows) {
-	event=getEvent(status);
-	CHECK_STATUS_BREAK(*status);
+	event=&rowevent;
 	getEventFromFile(src, ii+1, event, status);
 	CHECK_STATUS_BREAK(*status);
       }
@@ -282,9 +290,10 @@ void phpat(GenDet* const det,
 	    }
 	    // END of searching the pixel with the maximum signal.
 
-	    // Get a new event.
-	    Event* event=getEvent(status);
-	    CHECK_STATUS_BREAK(*status);
+	    // Set up the pattern event.
+	    Event patevent;
+	    Event* event=&patevent;
+	    clearEvent(event);
 
 	    // Set basic properties.
 	    event->rawx   =neighborlist[maxidx]->rawx;
@@ -461,7 +470,6 @@ void phpat(GenDet* const det,
 
 	    // Remove processed events from neighbor list.
 	    for (kk=0; kk<nneighborlist; kk++) {
-	      freeEvent(&neighborlist[kk]);
 	      neighborlist[kk]=NULL;
 	    }
 	    nneighborlist=0;
@@ -494,22 +502,14 @@ void phpat(GenDet* const det,
 		CHECK_STATUS_BREAK(*status);
 	      }
 	    } // End of application of upper threshold.
-
-	    // Release memory.
-	    freeEvent(&event);
 	  }
 	}
 	CHECK_STATUS_BREAK(*status);
 	// END of loop over all events in the frame list.
 
-	// Delete all remaining events in the frame list.
+	// Discard all remaining events in the frame list.
 	// There might still be some, which are below the
 	// thresholds.
-	for (jj=0; jj<nframelist; jj++) {
-	  if (NULL!=framelist[jj]) {
-	    freeEvent(&framelist[jj]);
-	  }
-	}
 	nframelist=0;
       }
       // END of if new frame.
@@ -521,7 +521,8 @@ void phpat(GenDet* const det,
 	  *status=EXIT_FAILURE;
 	  break;
 	}
-	framelist[nframelist]=event;
+	frameevents[nframelist]=*event;
+	framelist[nframelist]=&frameevents[nframelist];
 	nframelist++;
       }
 
@@ -563,20 +564,16 @@ void phpat(GenDet* const det,
 
 
   // Release memory.
+  if (NULL!=frameevents) {
+    free(frameevents);
+  }
   if (NULL!=framelist) {
-    for (ii=0; ii<nframelist; ii++) {
-      if (NULL!=framelist[ii]) {
-	freeEvent(&framelist[ii]);
-      }
-    }
     free(framelist);
   }
   if (NULL!=neighborlist) {
-    for (ii=0; ii<nneighborlist; ii++) {
-      if (NULL!=neighborlist[ii]) {
-	freeEvent(&neighborlist[ii]);
-      }
-    }
     free(neighborlist);
   }
+
+  SIXT_PROF_COUNT(SIXT_PROF_EVENTS, statistics.nvalids+statistics.ninvalids);
+  SIXT_PROF_END(SIXT_PROF_PHPAT);
 }
@@ -24,6 +24,7 @@
 #define PHPAT_H 1
 
 #include "sixt.h"
+#include "profiling.h"
 #include "event.h"
 #include "eventfile.h"
 #include "gendet.h"
@@ -49,7 +49,7 @@ void phproj(GenInst* const inst,
     // Determine the Position of the source on the sky:
     // First determine telescope pointing direction at the current time.
     Vector nx, ny, nz;
-    getTelescopeAxes(ac, &nx, &ny, &nz, event.time, status);
+    getTelescopeFrame(ac, &nx, &ny, &nz, event.time, status);
     CHECK_STATUS_BREAK(*status);
 
     // Determine RA and DEC of the photon origin.
@@ -135,7 +135,7 @@ void phproj_advdet(GenInst* const inst,
 		// Determine the Position of the source on the sky:
 		// First determine telescope pointing direction at the current time.
 		Vector nx, ny, nz;
-		getTelescopeAxes(ac, &nx, &ny, &nz, time, status);
+		getTelescopeFrame(ac, &nx, &ny, &nz, time, status);
 		CHECK_STATUS_BREAK(*status);
 
 		// Determine RA and DEC of the photon origin.
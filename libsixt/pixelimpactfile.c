@@ -22,6 +22,11 @@
 
 #include "pixelimpactfile.h"
 
+
+/** Number of rows read at once by readPixImpFileRows(). */
+#define PIXIMPFILE_READBLOCK (8192)
+
+
 PixImpFile* newPixImpFile(int* const status){
 
   PixImpFile* file=(PixImpFile*)malloc(sizeof(PixImpFile));
@@ -230,6 +235,7 @@ int getNextImpactFromPixImpFile(PixImpFile* const file,
   if (file->row > file->nrows) {
     return 0;
   }
+  SIXT_PROF_COUNT(SIXT_PROF_ROWS_READ, 1);
 
   // Read in the data.
   // JW: note: initialization of the data is NOT necessary
@@ -277,12 +283,112 @@ int getNextImpactFromPixImpFile(PixImpFile* const file,
   return 1;
 }
 
+void readPixImpFileRows(PixImpFile* const file,
+			const long firstrow,
+			const long nrows,
+			PixImpact* const impacts,
+			int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+  if (nrows<=0) return;
+  if ((firstrow<1)||(firstrow+nrows-1>file->nrows)) {
+    *status=EXIT_FAILURE;
+    SIXT_ERROR("rows out of range of pixel impact list file");
+    return;
+  }
+  SIXT_PROF_COUNT(SIXT_PROF_ROWS_READ, nrows);
+
+  const long nblock=MIN(nrows, PIXIMPFILE_READBLOCK);
+  double* dbuffer=(double*)malloc(nblock*sizeof(double));
+  float* fbuffer=(float*)malloc(nblock*sizeof(float));
+  long* lbuffer=(long*)malloc(nblock*sizeof(long));
+  if ((NULL==dbuffer)||(NULL==fbuffer)||(NULL==lbuffer)) {
+    free(dbuffer);
+    free(fbuffer);
+    free(lbuffer);
+    *status=EXIT_FAILURE;
+    SIXT_ERROR("memory allocation for reading pixel impacts failed");
+    return;
+  }
+
+  long offset;
+  for (offset=0; offset<nrows; offset+=nblock) {
+    const long row=firstrow+offset;
+    const long n=MIN(nblock, nrows-offset);
+    PixImpact* const imp=impacts+offset;
+    int anynul=0;
+    long ii;
+
+    for (ii=0; ii<n; ii++) {
+      imp[ii].grade1=0;
+      imp[ii].grade2=0;
+      imp[ii].totalenergy=0.;
+      imp[ii].nb_pileup=0;
+      imp[ii].weight_index=0;
+    }
+
+    fits_read_col(file->fptr, TDOUBLE, file->ctime, row, 1, n,
+		  NULL, dbuffer, &anynul, status);
+    for (ii=0; ii<n; ii++) imp[ii].time=dbuffer[ii];
+    fits_read_col(file->fptr, TFLOAT, file->cenergy, row, 1, n,
+		  NULL, fbuffer, &anynul, status);
+    for (ii=0; ii<n; ii++) imp[ii].energy=fbuffer[ii];
+    fits_read_col(file->fptr, TDOUBLE, file->cx, row, 1, n,
+		  NULL, dbuffer, &anynul, status);
+    for (ii=0; ii<n; ii++) imp[ii].detposition.x=dbuffer[ii];
+    fits_read_col(file->fptr, TDOUBLE, file->cy, row, 1, n,
+		  NULL, dbuffer, &anynul, status);
+    for (ii=0; ii<n; ii++) imp[ii].detposition.y=dbuffer[ii];
+    fits_read_col(file->fptr, TDOUBLE, file->cu, row, 1, n,
+		  NULL, dbuffer, &anynul, status);
+    for (ii=0; ii<n; ii++) imp[ii].pixposition.x=dbuffer[ii];
+    fits_read_col(file->fptr, TDOUBLE, file->cv, row, 1, n,
+		  NULL, dbuffer, &anynul, status);
+    for (ii=0; ii<n; ii++) imp[ii].pixposition.y=dbuffer[ii];
+    fits_read_col(file->fptr, TLONG, file->cph_id, row, 1, n,
+		  NULL, lbuffer, &anynul, status);
+    for (ii=0; ii<n; ii++) imp[ii].ph_id=lbuffer[ii];
+    fits_read_col(file->fptr, TLONG, file->csrc_id, row, 1, n,
+		  NULL, lbuffer, &anynul, status);
+    for (ii=0; ii<n; ii++) imp[ii].src_id=lbuffer[ii];
+    fits_read_col(file->fptr, TLONG, file->cpix_id, row, 1, n,
+		  NULL, lbuffer, &anynul, status);
+    for (ii=0; ii<n; ii++) imp[ii].pixID=lbuffer[ii]-1;
+
+    if (file->cgrade1!=-1) {
+      fits_read_col(file->fptr, TLONG, file->cgrade1, row, 1, n,
+		    NULL, lbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) imp[ii].grade1=lbuffer[ii];
+    }
+    if (file->cgrade2!=-1) {
+      fits_read_col(file->fptr, TLONG, file->cgrade2, row, 1, n,
+		    NULL, lbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) imp[ii].grade2=lbuffer[ii];
+    }
+    if (file->ctotalenergy!=-1) {
+      fits_read_col(file->fptr, TDOUBLE, file->ctotalenergy, row, 1, n,
+		    NULL, dbuffer, &anynul, status);
+      for (ii=0; ii<n; ii++) imp[ii].totalenergy=dbuffer[ii];
+    }
+
+    if (EXIT_SUCCESS!=*status) {
+      SIXT_ERROR("failed reading from pixel impact list file");
+      break;
+    }
+  }
+
+  free(dbuffer);
+  free(fbuffer);
+  free(lbuffer);
+}
+
 void addImpact2PixImpFile(PixImpFile* const ilf,
 			  PixImpact* const impact,
 			  int* const status)
 {
   ilf->row++;
   ilf->nrows++;
+  SIXT_PROF_COUNT(SIXT_PROF_ROWS_WRITTEN, 1);
 
   impact->pixID=impact->pixID+1;
 
@@ -370,3 +476,426 @@ void copyPixImpact(PixImpact* impact1, PixImpact* impact2){
 	impact1->nb_pileup = impact2->nb_pileup;
 	impact1->weight_index=impact2->weight_index;
 }
+
+PixImpactBuckets* newPixImpactBuckets(const int npix, int* const status)
+{
+  PixImpactBuckets* buckets=(PixImpactBuckets*)malloc(sizeof(PixImpactBuckets));
+  CHECK_MALLOC_RET_NULL_STATUS(buckets, *status);
+
+  buckets->npix=npix;
+  buckets->impact=NULL;
+  buckets->buffer=NULL;
+  buckets->nimpacts=0;
+  buckets->size=0;
+  buckets->buffersize=0;
+  buckets->first=(long*)calloc(npix+1, sizeof(long));
+  if (NULL==buckets->first) {
+    free(buckets);
+    *status=EXIT_FAILURE;
+    SIXT_ERROR("memory allocation for pixel impact buckets failed");
+    return(NULL);
+  }
+
+  return(buckets);
+}
+
+void freePixImpactBuckets(PixImpactBuckets** const buckets)
+{
+  if (NULL!=*buckets) {
+    free((*buckets)->first);
+    free((*buckets)->impact);
+    free((*buckets)->buffer);
+    free(*buckets);
+    *buckets=NULL;
+  }
+}
+
+/** Make sure that the array holds at least 'n' impacts. The previous
+    contents are discarded. */
+static void growPixImpactArray(PixImpact** const array,
+			       long* const size,
+			       const long n,
+			       int* const status)
+{
+  if (n>*size) {
+    free(*array);
+    *array=(PixImpact*)malloc(n*sizeof(PixImpact));
+    if (NULL==*array) {
+      *size=0;
+      *status=EXIT_FAILURE;
+      SIXT_ERROR("memory allocation for pixel impact buckets failed");
+      return;
+    }
+    *size=n;
+  }
+}
+
+/** Discard the contents of the buckets and make sure that they can
+    hold 'n' impacts. */
+static void resetPixImpactBuckets(PixImpactBuckets* const buckets,
+				  const long n,
+				  int* const status)
+{
+  buckets->nimpacts=0;
+  int ii;
+  for (ii=0; ii<=buckets->npix; ii++) {
+    buckets->first[ii]=0;
+  }
+  growPixImpactArray(&buckets->impact, &buckets->size, n, status);
+}
+
+/** Add the 'n' impacts to the number of impacts per pixel, which
+    is accumulated in first[pixid]. */
+static void countPixImpactBuckets(PixImpactBuckets* const buckets,
+				  const PixImpact* const impacts,
+				  const long n,
+				  int* const status)
+{
+  long jj;
+  for (jj=0; jj<n; jj++) {
+    const long pixid=impacts[jj].pixID;
+    if ((pixid<0)||(pixid>=buckets->npix)) {
+      *status=EXIT_FAILURE;
+      char msg[MAXMSG];
+      sprintf(msg, "invalid pixel ID %ld in pixel impact list file", pixid+1);
+      SIXT_ERROR(msg);
+      return;
+    }
+    buckets->first[pixid]++;
+  }
+}
+
+/** Turn the numbers of impacts per pixel into the end of the
+    buckets. */
+static void endPixImpactBuckets(PixImpactBuckets* const buckets)
+{
+  int ii;
+  for (ii=1; ii<=buckets->npix; ii++) {
+    buckets->first[ii]+=buckets->first[ii-1];
+  }
+}
+
+/** Distribute the 'n' impacts into the buckets, starting with the
+    last one. If the impacts are passed in reverse order, they keep
+    their order within the pixels, and first[ii] ends up at the
+    beginning of the bucket of pixel ii. */
+static void scatterPixImpactBuckets(PixImpactBuckets* const buckets,
+				    const PixImpact* const impacts,
+				    const long n)
+{
+  long jj;
+  for (jj=n-1; jj>=0; jj--) {
+    buckets->impact[--buckets->first[impacts[jj].pixID]]=impacts[jj];
+  }
+}
+
+void fillPixImpactBuckets(PixImpactBuckets* const buckets,
+			  PixImpFile* const file,
+			  const long firstrow,
+			  const long lastrow,
+			  int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+
+  const long n=MAX(lastrow-firstrow+1, 0);
+  resetPixImpactBuckets(buckets, n, status);
+  if ((0==n)||(EXIT_SUCCESS!=*status)) return;
+  growPixImpactArray(&buckets->buffer, &buckets->buffersize, n, status);
+  CHECK_STATUS_VOID(*status);
+
+  readPixImpFileRows(file, firstrow, n, buckets->buffer, status);
+  CHECK_STATUS_VOID(*status);
+
+  countPixImpactBuckets(buckets, buckets->buffer, n, status);
+  CHECK_STATUS_VOID(*status);
+  endPixImpactBuckets(buckets);
+  scatterPixImpactBuckets(buckets, buckets->buffer, n);
+  buckets->nimpacts=n;
+}
+
+static const PixImpact* readPixImpactStoreChunk(PixImpactStore* const store,
+						const int ichunk,
+						int* const status);
+
+void fillPixImpactBucketsFromStore(PixImpactBuckets* const buckets,
+				   PixImpactStore* const store,
+				   int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+
+  const long n=store->nimpacts;
+  resetPixImpactBuckets(buckets, n, status);
+  if ((0==n)||(EXIT_SUCCESS!=*status)) return;
+
+  // The impacts are sorted chunk by chunk, such that the store is
+  // never copied as a whole. Count the impacts per pixel ...
+  const int nchunks=(int)((n+PIXIMPSTORE_CHUNKSIZE-1)/PIXIMPSTORE_CHUNKSIZE);
+  int ichunk;
+  for (ichunk=0; ichunk<nchunks; ichunk++) {
+    const PixImpact* chunk=readPixImpactStoreChunk(store, ichunk, status);
+    CHECK_STATUS_VOID(*status);
+    countPixImpactBuckets(buckets, chunk,
+			  MIN(n-(long)ichunk*PIXIMPSTORE_CHUNKSIZE,
+			      PIXIMPSTORE_CHUNKSIZE), status);
+    CHECK_STATUS_VOID(*status);
+  }
+  endPixImpactBuckets(buckets);
+
+  // ... and distribute them in reverse order. The chunks in memory
+  // come last, so the chunk from the temporary file that is still
+  // in the read buffer is used without reading it again.
+  for (ichunk=nchunks-1; ichunk>=0; ichunk--) {
+    const PixImpact* chunk=readPixImpactStoreChunk(store, ichunk, status);
+    CHECK_STATUS_VOID(*status);
+    scatterPixImpactBuckets(buckets, chunk,
+			    MIN(n-(long)ichunk*PIXIMPSTORE_CHUNKSIZE,
+				PIXIMPSTORE_CHUNKSIZE));
+  }
+  buckets->nimpacts=n;
+}
+
+PixImpactStore* newPixImpactStore(const size_t maxmem, int* const status)
+{
+  PixImpactStore* store=(PixImpactStore*)malloc(sizeof(PixImpactStore));
+  CHECK_MALLOC_RET_NULL_STATUS(store, *status);
+
+  store->chunk=NULL;
+  store->nchunks=0;
+  store->nimpacts=0;
+  store->maxchunks=0;
+  if (maxmem>0) {
+    store->maxchunks=
+      (int)MAX(maxmem/(PIXIMPSTORE_CHUNKSIZE*sizeof(PixImpact)), 1);
+  }
+  store->nmemchunks=0;
+  store->spill=NULL;
+  store->readbuffer=NULL;
+  store->readchunk=-1;
+
+  return(store);
+}
+
+void freePixImpactStore(PixImpactStore** const store)
+{
+  if (NULL!=*store) {
+    int ii;
+    for (ii=0; ii<(*store)->nchunks; ii++) {
+      free((*store)->chunk[ii]);
+    }
+    free((*store)->chunk);
+    free((*store)->readbuffer);
+    if (NULL!=(*store)->spill) {
+      fclose((*store)->spill);
+    }
+    free(*store);
+    *store=NULL;
+  }
+}
+
+/** Move the chunk 'ichunk' to the temporary file. */
+static void spillPixImpactStoreChunk(PixImpactStore* const store,
+				     const int ichunk,
+				     int* const status)
+{
+  if (NULL==store->spill) {
+    store->spill=tmpfile();
+    if (NULL==store->spill) {
+      *status=EXIT_FAILURE;
+      SIXT_ERROR("could not create temporary file for pixel impacts");
+      return;
+    }
+  }
+  if ((0!=fseeko(store->spill,
+		 (off_t)ichunk*PIXIMPSTORE_CHUNKSIZE*sizeof(PixImpact),
+		 SEEK_SET))||
+      (PIXIMPSTORE_CHUNKSIZE!=fwrite(store->chunk[ichunk], sizeof(PixImpact),
+				     PIXIMPSTORE_CHUNKSIZE, store->spill))) {
+    *status=EXIT_FAILURE;
+    SIXT_ERROR("writing pixel impacts to temporary file failed");
+    return;
+  }
+  SIXT_PROF_COUNT(SIXT_PROF_ROWS_WRITTEN, PIXIMPSTORE_CHUNKSIZE);
+  if (store->readchunk==ichunk) {
+    store->readchunk=-1;
+  }
+}
+
+/** Return the chunk 'ichunk' for appending impacts. If the memory
+    limit is reached, the oldest chunk in memory is moved to the
+    temporary file and its memory is reused. */
+static PixImpact* getPixImpactStoreChunk(PixImpactStore* const store,
+					 const int ichunk,
+					 int* const status)
+{
+  if (ichunk>=store->nchunks) {
+    PixImpact** chunk=
+      (PixImpact**)realloc(store->chunk, (ichunk+1)*sizeof(PixImpact*));
+    CHECK_MALLOC_RET_NULL_STATUS(chunk, *status);
+    store->chunk=chunk;
+    for (; store->nchunks<=ichunk; store->nchunks++) {
+      store->chunk[store->nchunks]=NULL;
+    }
+  }
+  if (NULL!=store->chunk[ichunk]) {
+    return(store->chunk[ichunk]);
+  }
+
+  if ((0==store->maxchunks)||(store->nmemchunks<store->maxchunks)) {
+    store->chunk[ichunk]=
+      (PixImpact*)malloc(PIXIMPSTORE_CHUNKSIZE*sizeof(PixImpact));
+    CHECK_MALLOC_RET_NULL_STATUS(store->chunk[ichunk], *status);
+    store->nmemchunks++;
+    return(store->chunk[ichunk]);
+  }
+
+  // All chunks in memory precede the new one (see
+  // clearPixImpactStore()).
+  int oldest=0;
+  while (NULL==store->chunk[oldest]) {
+    oldest++;
+  }
+  spillPixImpactStoreChunk(store, oldest, status);
+  CHECK_STATUS_RET(*status, NULL);
+  store->chunk[ichunk]=store->chunk[oldest];
+  store->chunk[oldest]=NULL;
+  return(store->chunk[ichunk]);
+}
+
+void addImpact2PixImpactStore(PixImpactStore* const store,
+			      const PixImpact* const impact,
+			      int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+
+  PixImpact* chunk=
+    getPixImpactStoreChunk(store, store->nimpacts/PIXIMPSTORE_CHUNKSIZE, status);
+  CHECK_STATUS_VOID(*status);
+
+  PixImpact* const imp=&(chunk[store->nimpacts%PIXIMPSTORE_CHUNKSIZE]);
+  *imp=*impact;
+  imp->grade1=0;
+  imp->grade2=0;
+  imp->totalenergy=0.;
+  imp->nb_pileup=0;
+  imp->weight_index=0;
+  store->nimpacts++;
+}
+
+/** Return the chunk 'ichunk' for reading. Chunks from the temporary
+    file are loaded into the read buffer. */
+static const PixImpact* readPixImpactStoreChunk(PixImpactStore* const store,
+						const int ichunk,
+						int* const status)
+{
+  if (NULL!=store->chunk[ichunk]) {
+    return(store->chunk[ichunk]);
+  }
+  if (store->readchunk==ichunk) {
+    return(store->readbuffer);
+  }
+
+  if (NULL==store->readbuffer) {
+    store->readbuffer=
+      (PixImpact*)malloc(PIXIMPSTORE_CHUNKSIZE*sizeof(PixImpact));
+    CHECK_MALLOC_RET_NULL_STATUS(store->readbuffer, *status);
+  }
+  if ((NULL==store->spill)||
+      (0!=fseeko(store->spill,
+		 (off_t)ichunk*PIXIMPSTORE_CHUNKSIZE*sizeof(PixImpact),
+		 SEEK_SET))||
+      (PIXIMPSTORE_CHUNKSIZE!=fread(store->readbuffer, sizeof(PixImpact),
+				    PIXIMPSTORE_CHUNKSIZE, store->spill))) {
+    *status=EXIT_FAILURE;
+    SIXT_ERROR("reading pixel impacts from temporary file failed");
+    return(NULL);
+  }
+  SIXT_PROF_COUNT(SIXT_PROF_ROWS_READ, PIXIMPSTORE_CHUNKSIZE);
+  store->readchunk=ichunk;
+  return(store->readbuffer);
+}
+
+void readPixImpactStore(PixImpactStore* const store,
+			const long first,
+			const long n,
+			PixImpact* const impacts,
+			int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+  if (n<=0) return;
+  if ((first<0)||(first+n>store->nimpacts)) {
+    *status=EXIT_FAILURE;
+    SIXT_ERROR("impacts out of range of pixel impact store");
+    return;
+  }
+
+  long done=0;
+  while (done<n) {
+    const long index=first+done;
+    const PixImpact* chunk=
+      readPixImpactStoreChunk(store, index/PIXIMPSTORE_CHUNKSIZE, status);
+    CHECK_STATUS_VOID(*status);
+    const long offset=index%PIXIMPSTORE_CHUNKSIZE;
+    const long count=MIN(n-done, PIXIMPSTORE_CHUNKSIZE-offset);
+    memcpy(impacts+done, chunk+offset, count*sizeof(PixImpact));
+    done+=count;
+  }
+}
+
+void clearPixImpactStore(PixImpactStore* const store)
+{
+  // Move the chunks in memory to the front, such that they are
+  // reused before any chunk is moved to the temporary file.
+  int ii, nmem=0;
+  for (ii=0; ii<store->nchunks; ii++) {
+    PixImpact* chunk=store->chunk[ii];
+    if (NULL!=chunk) {
+      store->chunk[ii]=NULL;
+      store->chunk[nmem++]=chunk;
+    }
+  }
+  store->nimpacts=0;
+  store->readchunk=-1;
+}
+
+int getNextImpactFromSource(PixImpactSource* const source,
+			    PixImpact* const impact,
+			    int* const status)
+{
+  if (NULL!=source->file) {
+    return(getNextImpactFromPixImpFile(source->file, impact, status));
+  }
+  if (NULL!=source->store) {
+    if (source->index>=source->store->nimpacts) {
+      return 0;
+    }
+    readPixImpactStore(source->store, source->index, 1, impact, status);
+    CHECK_STATUS_RET(*status, 0);
+    source->index++;
+    return 1;
+  }
+  if (source->index>=source->nimpacts) {
+    return 0;
+  }
+  *impact=source->impact[source->index++];
+  return 1;
+}
+
+void rewindPixImpactSource(PixImpactSource* const source)
+{
+  if (NULL!=source->file) {
+    source->file->row=0;
+  } else {
+    source->index=0;
+  }
+}
+
+long getPixImpactSourceSize(const PixImpactSource* const source)
+{
+  if (NULL!=source->file) {
+    return(source->file->nrows);
+  }
+  if (NULL!=source->store) {
+    return(source->store->nimpacts);
+  }
+  return(source->nimpacts);
+}
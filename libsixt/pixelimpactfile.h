@@ -24,6 +24,7 @@
 #define PIXIMPFILE_H 1
 
 #include "sixt.h"
+#include "profiling.h"
 #include "pixelimpact.h"
 #include "point.h"
 
@@ -50,6 +51,78 @@ typedef struct {
 } PixImpFile;
 
 
+/** Pixel impacts of a time interval, sorted by the pixels. */
+typedef struct {
+  /** Number of pixels. */
+  int npix;
+
+  /** The impacts of pixel ii are impact[first[ii]] to
+      impact[first[ii+1]-1] in the order of the file. */
+  long* first;
+  PixImpact* impact;
+  long nimpacts;
+
+  /** Allocated size of the impact array. */
+  long size;
+
+  /** Impacts in the order of the file and its allocated size. Only
+      used when the buckets are filled from a PixImpFile. */
+  PixImpact* buffer;
+  long buffersize;
+
+} PixImpactBuckets;
+
+
+/** Number of impacts in a chunk of a PixImpactStore. */
+#define PIXIMPSTORE_CHUNKSIZE (32768)
+
+/** Pixel impacts kept in memory in chunks of PIXIMPSTORE_CHUNKSIZE
+    impacts. If the chunks in memory exceed the memory limit, the
+    oldest ones are moved to a temporary file. */
+typedef struct {
+  /** Chunks of the impacts. Chunks that have been moved to the
+      temporary file are NULL. */
+  PixImpact** chunk;
+  int nchunks;
+
+  /** Number of stored impacts. */
+  long nimpacts;
+
+  /** Maximum number of chunks in memory (0: no limit). */
+  int maxchunks;
+
+  /** Number of chunks in memory (including unused ones). */
+  int nmemchunks;
+
+  /** Temporary file for the chunks not kept in memory. The chunk ii
+      is stored at the offset ii*PIXIMPSTORE_CHUNKSIZE. */
+  FILE* spill;
+
+  /** Buffer for reading a chunk from the temporary file and index
+      of the chunk in the buffer (-1: none). */
+  PixImpact* readbuffer;
+  int readchunk;
+
+} PixImpactStore;
+
+
+/** Source of pixel impacts, which are either read from a PixImpFile
+    (if 'file' is not NULL), from a PixImpactStore (if 'store' is not
+    NULL), or taken from an array. */
+typedef struct {
+  PixImpFile* file;
+
+  const PixImpact* impact;
+  long nimpacts;
+
+  /** Index of the next impact in the array or the store. */
+  long index;
+
+  PixImpactStore* store;
+
+} PixImpactSource;
+
+
 ////////////////////////////////////////////////////////////////////////
 // Function declarations.
 ////////////////////////////////////////////////////////////////////////
@@ -91,6 +164,15 @@ int getNextImpactFromPixImpFile(PixImpFile* const file,
 			   PixImpact* const impact,
 			   int* const status);
 
+/** Read the rows 'firstrow' to 'firstrow+nrows-1' into the array
+    'impacts'. The columns are read in blocks. The internal row
+    counter is not changed. */
+void readPixImpFileRows(PixImpFile* const file,
+			const long firstrow,
+			const long nrows,
+			PixImpact* const impacts,
+			int* const status);
+
 /** Append a new entry to the PixImpFile. */
 void addImpact2PixImpFile(PixImpFile* const ilf,
 			  PixImpact* const impact,
@@ -112,4 +194,68 @@ void updateGradingPixImp(PixImpFile* const ilf,
 /** copy impact2 into impact1 */
 void copyPixImpact(PixImpact* impact1, PixImpact* impact2);
 
+/** Constructor of the impact buckets for 'npix' pixels. */
+PixImpactBuckets* newPixImpactBuckets(const int npix, int* const status);
+
+/** Destructor of the impact buckets. */
+void freePixImpactBuckets(PixImpactBuckets** const buckets);
+
+/** Read the rows 'firstrow' to 'lastrow' of the PixImpFile and sort
+    them into the buckets of their pixels (counting sort). Previous
+    contents of the buckets are discarded. */
+void fillPixImpactBuckets(PixImpactBuckets* const buckets,
+			  PixImpFile* const file,
+			  const long firstrow,
+			  const long lastrow,
+			  int* const status);
+
+/** Sort all impacts in the store into the buckets of their pixels
+    (counting sort). Previous contents of the buckets are
+    discarded. The store is sorted chunk by chunk, so apart from the
+    buckets no copy of its impacts is made. Chunks in the temporary
+    file of the store are read twice (once for counting, once for
+    sorting). Note that the buckets still hold all impacts of the
+    store in memory, so the memory limit of the store does not bound
+    the memory of the buckets. */
+void fillPixImpactBucketsFromStore(PixImpactBuckets* const buckets,
+				   PixImpactStore* const store,
+				   int* const status);
+
+/** Constructor of an empty impact store. At most 'maxmem' bytes of
+    impacts are kept in memory (0: no limit). */
+PixImpactStore* newPixImpactStore(const size_t maxmem, int* const status);
+
+/** Destructor of the impact store. */
+void freePixImpactStore(PixImpactStore** const store);
+
+/** Append an impact to the store. The grading columns of the impact
+    are reset as for a new row of a PixImpFile. */
+void addImpact2PixImpactStore(PixImpactStore* const store,
+			      const PixImpact* const impact,
+			      int* const status);
+
+/** Copy the impacts 'first' to 'first+n-1' of the store into the
+    array 'impacts'. */
+void readPixImpactStore(PixImpactStore* const store,
+			const long first,
+			const long n,
+			PixImpact* const impacts,
+			int* const status);
+
+/** Remove all impacts from the store. The allocated chunks are kept
+    for the next impacts. */
+void clearPixImpactStore(PixImpactStore* const store);
+
+/** Return the next impact from the source. Returns 0, if there is no
+    impact left. */
+int getNextImpactFromSource(PixImpactSource* const source,
+			    PixImpact* const impact,
+			    int* const status);
+
+/** Start again with the first impact of the source. */
+void rewindPixImpactSource(PixImpactSource* const source);
+
+/** Return the total number of impacts of the source. */
+long getPixImpactSourceSize(const PixImpactSource* const source);
+
 #endif /* PIXIMPFILE_H */
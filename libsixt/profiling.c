@@ -0,0 +1,371 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                  Erlangen-Nuernberg
+*/
+
+#include "profiling.h"
+#include "sixt.h"
+
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define SIXT_PROF_TSC 1
+#endif
+
+
+int sixt_profiling=0;
+
+
+/** Names of the stages and counters in the summary. */
+static const char* const stage_names[SIXT_PROF_NSTAGES]={
+  "phgen", "phimg", "phdet", "phpat", "tes_propagate", "trigger",
+  "sirena_detect", "sirena_energy"
+};
+static const char* const counter_names[SIXT_PROF_NCOUNTERS]={
+  "photons", "impacts", "events", "rows_read", "rows_written",
+  "allocations", "records", "pulses"
+};
+
+/** Calls, time [clock ticks] and counters accumulated by a thread.
+    The hooks only update the block of the calling thread (without
+    locked instructions). The blocks of all threads, also of the ones
+    that have already finished, are kept in a list, which is summed
+    up by the getters. */
+typedef struct SixtProfThread {
+  long stage_calls[SIXT_PROF_NSTAGES];
+  unsigned long long stage_ticks[SIXT_PROF_NSTAGES];
+  long counters[SIXT_PROF_NCOUNTERS];
+  struct SixtProfThread* next;
+} SixtProfThread;
+
+static SixtProfThread* thread_list=NULL;
+static __thread SixtProfThread* thread_block=NULL;
+
+/** Block shared by the threads for which no block could be
+    allocated (their updates may get lost). */
+static SixtProfThread shared_block;
+
+/** Clock of the stage timers: the time stamp counter of the CPU, if
+    it runs at a constant rate, and the monotonic clock [ns]
+    otherwise. The ticks are converted into seconds by comparing with
+    the monotonic clock since the selection of the clock. */
+static pthread_once_t clock_once=PTHREAD_ONCE_INIT;
+static int use_tsc=0;
+static unsigned long long clock_ticks0=0;
+static double clock_time0=0.;
+
+/** Name of the tool and start time of the profiling. */
+static char profiling_tool[MAXMSG]="";
+static double profiling_start=0.;
+
+
+double getSixtProfTime(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec+ts.tv_nsec*1.e-9);
+}
+
+
+static inline SixtProfTicks getSixtProfTicks(void)
+{
+#ifdef SIXT_PROF_TSC
+  if (use_tsc) {
+    return(__rdtsc());
+  }
+#endif
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec*1000000000ULL+ts.tv_nsec);
+}
+
+
+static void selectSixtProfClock(void)
+{
+#ifdef SIXT_PROF_TSC
+  // Invariant TSC (CPUID 0x80000007, EDX bit 8).
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+    use_tsc=(0!=(edx&(1u<<8)));
+  }
+#endif
+  clock_ticks0=getSixtProfTicks();
+  clock_time0=getSixtProfTime();
+}
+
+
+/** Duration of a clock tick [s]. For the time stamp counter, the
+    calibration is done over at least 10ms. */
+static double getSixtProfTickLength(void)
+{
+  pthread_once(&clock_once, selectSixtProfClock);
+  if (0==use_tsc) {
+    return(1.e-9);
+  }
+  double now;
+  while ((now=getSixtProfTime())-clock_time0<0.01);
+  unsigned long long ticks=getSixtProfTicks();
+  return((now-clock_time0)/(double)(ticks-clock_ticks0));
+}
+
+
+static SixtProfThread* getSixtProfThread(void)
+{
+  if (NULL!=thread_block) {
+    return(thread_block);
+  }
+  // The clock is selected before the first time stamp is taken.
+  pthread_once(&clock_once, selectSixtProfClock);
+  SixtProfThread* block=(SixtProfThread*)calloc(1, sizeof(SixtProfThread));
+  if (NULL==block) {
+    return(&shared_block);
+  }
+  block->next=__atomic_load_n(&thread_list, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(&thread_list, &block->next, block, 1,
+				      __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+  thread_block=block;
+  return(block);
+}
+
+
+//the values of a block are only changed by its thread, but they are
+//read by other threads
+#define SIXT_PROF_ADD(value, n)						\
+  __atomic_store_n(&(value), (value)+(n), __ATOMIC_RELAXED)
+
+
+void initSixtProfiling(const char* const tool)
+{
+  const char* file=getenv("SIXTE_PROFILE");
+  if ((NULL==file)||('\0'==file[0])) {
+    return;
+  }
+
+#ifdef SIXT_PROFILING
+  resetSixtProfiling();
+  strncpy(profiling_tool, tool, MAXMSG-1);
+  profiling_tool[MAXMSG-1]='\0';
+  profiling_start=getSixtProfTime();
+  sixt_profiling=1;
+#else
+  (void)tool;
+  SIXT_WARNING("SIXTE_PROFILE is ignored, since SIXTE has been built "
+	       "without profiling support (configure --enable-profiling)");
+#endif
+}
+
+
+SixtProfTicks beginSixtProfStage(const SixtProfStage stage)
+{
+  SixtProfThread* block=getSixtProfThread();
+  SIXT_PROF_ADD(block->stage_calls[stage], 1);
+  return(getSixtProfTicks());
+}
+
+
+void endSixtProfStage(const SixtProfStage stage, const SixtProfTicks t0)
+{
+  if (0==t0) {
+    return;
+  }
+  SixtProfTicks t1=getSixtProfTicks();
+  SixtProfThread* block=getSixtProfThread();
+  SIXT_PROF_ADD(block->stage_ticks[stage], t1-t0);
+}
+
+
+void addSixtProfCount(const SixtProfCounter counter, const long n)
+{
+  SixtProfThread* block=getSixtProfThread();
+  SIXT_PROF_ADD(block->counters[counter], n);
+}
+
+
+void getSixtProfStage(const SixtProfStage stage,
+		      long* const calls, double* const time)
+{
+  unsigned long long ticks=
+    __atomic_load_n(&shared_block.stage_ticks[stage], __ATOMIC_RELAXED);
+  *calls=__atomic_load_n(&shared_block.stage_calls[stage], __ATOMIC_RELAXED);
+  SixtProfThread* block=__atomic_load_n(&thread_list, __ATOMIC_ACQUIRE);
+  for (; NULL!=block; block=block->next) {
+    *calls+=__atomic_load_n(&block->stage_calls[stage], __ATOMIC_RELAXED);
+    ticks+=__atomic_load_n(&block->stage_ticks[stage], __ATOMIC_RELAXED);
+  }
+  *time=(0==ticks) ? 0. : ticks*getSixtProfTickLength();
+}
+
+
+long getSixtProfCount(const SixtProfCounter counter)
+{
+  long value=__atomic_load_n(&shared_block.counters[counter], __ATOMIC_RELAXED);
+  SixtProfThread* block=__atomic_load_n(&thread_list, __ATOMIC_ACQUIRE);
+  for (; NULL!=block; block=block->next) {
+    value+=__atomic_load_n(&block->counters[counter], __ATOMIC_RELAXED);
+  }
+  return(value);
+}
+
+
+static void resetSixtProfThread(SixtProfThread* const block)
+{
+  int ii;
+  for (ii=0; ii<SIXT_PROF_NSTAGES; ii++) {
+    __atomic_store_n(&block->stage_calls[ii], 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&block->stage_ticks[ii], 0, __ATOMIC_RELAXED);
+  }
+  for (ii=0; ii<SIXT_PROF_NCOUNTERS; ii++) {
+    __atomic_store_n(&block->counters[ii], 0, __ATOMIC_RELAXED);
+  }
+}
+
+
+void resetSixtProfiling(void)
+{
+  pthread_once(&clock_once, selectSixtProfClock);
+  resetSixtProfThread(&shared_block);
+  SixtProfThread* block=__atomic_load_n(&thread_list, __ATOMIC_ACQUIRE);
+  for (; NULL!=block; block=block->next) {
+    resetSixtProfThread(block);
+  }
+}
+
+
+static void writeSixtProfilingJSON(const char* const filename,
+				   const double walltime,
+				   int* const status)
+{
+  FILE* fp=fopen(filename, "w");
+  if (NULL==fp) {
+    *status=EXIT_FAILURE;
+    return;
+  }
+
+  fprintf(fp, "{\n  \"tool\": \"%s\",\n  \"walltime\": %.6f,\n",
+	  profiling_tool, walltime);
+  fprintf(fp, "  \"stages\": {\n");
+  int ii;
+  for (ii=0; ii<SIXT_PROF_NSTAGES; ii++) {
+    long calls;
+    double time;
+    getSixtProfStage((SixtProfStage)ii, &calls, &time);
+    fprintf(fp, "    \"%s\": { \"calls\": %ld, \"time\": %.6f }%s\n",
+	    stage_names[ii], calls, time,
+	    (ii<SIXT_PROF_NSTAGES-1) ? "," : "");
+  }
+  fprintf(fp, "  },\n  \"counters\": {\n");
+  for (ii=0; ii<SIXT_PROF_NCOUNTERS; ii++) {
+    fprintf(fp, "    \"%s\": %ld%s\n", counter_names[ii],
+	    getSixtProfCount((SixtProfCounter)ii),
+	    (ii<SIXT_PROF_NCOUNTERS-1) ? "," : "");
+  }
+  fprintf(fp, "  }\n}\n");
+
+  if (0!=fclose(fp)) {
+    *status=EXIT_FAILURE;
+  }
+}
+
+
+static void writeSixtProfilingFITS(const char* const filename,
+				   const double walltime,
+				   int* const status)
+{
+  fitsfile* fptr=NULL;
+  char name[MAXFILENAME];
+  snprintf(name, MAXFILENAME, "!%s", filename);
+  fits_create_file(&fptr, name, status);
+  CHECK_STATUS_VOID(*status);
+
+  do { // Error handling loop.
+    char* ttype1[]={"STAGE", "CALLS", "TIME"};
+    char* tform1[]={"16A", "K", "D"};
+    char* tunit1[]={"", "", "s"};
+    fits_create_tbl(fptr, BINARY_TBL, 0, 3, ttype1, tform1, tunit1,
+		    "STAGES", status);
+    fits_update_key(fptr, TSTRING, "TOOL", profiling_tool,
+		    "name of the profiled tool", status);
+    double wt=walltime;
+    fits_update_key(fptr, TDOUBLE, "WALLTIME", &wt,
+		    "[s] total run time", status);
+    CHECK_STATUS_BREAK(*status);
+
+    int ii;
+    for (ii=0; ii<SIXT_PROF_NSTAGES; ii++) {
+      long calls;
+      double time;
+      getSixtProfStage((SixtProfStage)ii, &calls, &time);
+      char* sname=(char*)stage_names[ii];
+      fits_write_col(fptr, TSTRING, 1, ii+1, 1, 1, &sname, status);
+      fits_write_col(fptr, TLONG, 2, ii+1, 1, 1, &calls, status);
+      fits_write_col(fptr, TDOUBLE, 3, ii+1, 1, 1, &time, status);
+    }
+    CHECK_STATUS_BREAK(*status);
+
+    char* ttype2[]={"COUNTER", "VALUE"};
+    char* tform2[]={"16A", "K"};
+    fits_create_tbl(fptr, BINARY_TBL, 0, 2, ttype2, tform2, NULL,
+		    "COUNTERS", status);
+    for (ii=0; ii<SIXT_PROF_NCOUNTERS; ii++) {
+      long value=getSixtProfCount((SixtProfCounter)ii);
+      char* cname=(char*)counter_names[ii];
+      fits_write_col(fptr, TSTRING, 1, ii+1, 1, 1, &cname, status);
+      fits_write_col(fptr, TLONG, 2, ii+1, 1, 1, &value, status);
+    }
+    CHECK_STATUS_BREAK(*status);
+  } while(0); // END of error handling loop.
+
+  int status2=EXIT_SUCCESS;
+  fits_close_file(fptr, &status2);
+  if (EXIT_SUCCESS==*status) {
+    *status=status2;
+  }
+}
+
+
+void writeSixtProfiling(void)
+{
+  if (0==sixt_profiling) {
+    return;
+  }
+  const char* file=getenv("SIXTE_PROFILE");
+  if ((NULL==file)||('\0'==file[0])) {
+    return;
+  }
+
+  double walltime=getSixtProfTime()-profiling_start;
+  int status=EXIT_SUCCESS;
+  size_t len=strlen(file);
+  if ((len>=5)&&(0==strcmp(file+len-5, ".json"))) {
+    writeSixtProfilingJSON(file, walltime, &status);
+  } else {
+    writeSixtProfilingFITS(file, walltime, &status);
+  }
+
+  if (EXIT_SUCCESS!=status) {
+    char msg[MAXMSG];
+    snprintf(msg, MAXMSG, "could not write profiling summary to '%s'", file);
+    SIXT_WARNING(msg);
+    fits_clear_errmsg();
+  } else {
+    headas_chat(3, "profiling summary written to '%s'\n", file);
+  }
+}
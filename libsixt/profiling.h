@@ -0,0 +1,173 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                  Erlangen-Nuernberg
+*/
+
+
+#ifndef PROFILING_H
+#define PROFILING_H 1
+
+#include <sixteconfig.h>
+
+
+/** Per-stage timers and counters of the simulation and
+    reconstruction pipelines.
+
+    The instrumentation is compiled in, if SIXT_PROFILING is defined
+    (configure --enable-profiling). Otherwise all hooks expand to
+    nothing. At runtime it is activated by setting the environment
+    variable SIXTE_PROFILE to the name of the output file. The summary
+    is written in JSON format, if the file name ends with ".json", and
+    as FITS table otherwise.
+
+    Every call of a stage is timed, also for the stages that are
+    entered for each photon, as their cost is dominated by rare calls
+    (refills of the photon buffer from the source catalog, readouts of
+    the detector). Stages may be nested, e.g., the
+    time of the trigger stage includes the SIRENA reconstruction of
+    its records. Counters and timers can be used from several threads:
+    each thread accumulates its own values, which are summed up when
+    they are read. The stages are timed with the time stamp counter of
+    the CPU, if it runs at a constant rate, and with the monotonic
+    clock otherwise. */
+
+
+/////////////////////////////////////////////////////////////////
+// Type Declarations.
+/////////////////////////////////////////////////////////////////
+
+
+/** Timed pipeline stages. */
+typedef enum {
+  SIXT_PROF_PHGEN=0,
+  SIXT_PROF_PHIMG,
+  SIXT_PROF_PHDET,
+  SIXT_PROF_PHPAT,
+  SIXT_PROF_TES_PROPAGATE,
+  SIXT_PROF_TRIGGER,
+  SIXT_PROF_SIRENA_DETECT,
+  SIXT_PROF_SIRENA_ENERGY,
+  SIXT_PROF_NSTAGES
+} SixtProfStage;
+
+
+/** Counted quantities. */
+typedef enum {
+  SIXT_PROF_PHOTONS=0,
+  SIXT_PROF_IMPACTS,
+  SIXT_PROF_EVENTS,
+  SIXT_PROF_ROWS_READ,
+  SIXT_PROF_ROWS_WRITTEN,
+  SIXT_PROF_ALLOCATIONS,
+  SIXT_PROF_RECORDS,
+  SIXT_PROF_PULSES,
+  SIXT_PROF_NCOUNTERS
+} SixtProfCounter;
+
+
+/** Time stamp of the stage timers [clock ticks]. */
+typedef unsigned long long SixtProfTicks;
+
+
+/////////////////////////////////////////////////////////////////
+// Function Declarations.
+/////////////////////////////////////////////////////////////////
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Flag whether the profiling is active at runtime. */
+extern int sixt_profiling;
+
+/** Activate the profiling, if the environment variable SIXTE_PROFILE
+    is set. The name of the tool is stored in the summary. Should be
+    called once at the start of a tool. */
+void initSixtProfiling(const char* const tool);
+
+/** Write the summary to the file given by SIXTE_PROFILE. Errors are
+    only reported as warnings. */
+void writeSixtProfiling(void);
+
+/** Current value of the monotonic clock [s]. */
+double getSixtProfTime(void);
+
+/** Start of a stage. Returns the current time stamp. */
+SixtProfTicks beginSixtProfStage(const SixtProfStage stage);
+
+/** End of a stage started at time stamp t0 (as returned by
+    beginSixtProfStage()). */
+void endSixtProfStage(const SixtProfStage stage, const SixtProfTicks t0);
+
+/** Add n to a counter. */
+void addSixtProfCount(const SixtProfCounter counter, const long n);
+
+/** Total number of calls and time [s] of a stage. */
+void getSixtProfStage(const SixtProfStage stage,
+		      long* const calls, double* const time);
+
+/** Value of a counter. */
+long getSixtProfCount(const SixtProfCounter counter);
+
+/** Reset all timers and counters. Must not be called while other
+    threads update them. */
+void resetSixtProfiling(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/////////////////////////////////////////////////////////////////
+// Hooks.
+/////////////////////////////////////////////////////////////////
+
+
+#ifdef SIXT_PROFILING
+
+/** Start timing a stage. Declares a local variable, so it must be
+    followed by SIXT_PROF_END in the same scope. */
+#define SIXT_PROF_BEGIN(stage)						\
+  const SixtProfTicks sixt_prof_t0_##stage=				\
+    sixt_profiling ? beginSixtProfStage(stage) : 0
+
+/** Stop timing a stage. */
+#define SIXT_PROF_END(stage)						\
+  do {									\
+    if (sixt_prof_t0_##stage>0)					\
+      endSixtProfStage(stage, sixt_prof_t0_##stage);			\
+  } while (0)
+
+/** Add n to a counter. */
+#define SIXT_PROF_COUNT(counter, n)					\
+  do {									\
+    if (sixt_profiling) addSixtProfCount(counter, n);			\
+  } while (0)
+
+#else
+
+#define SIXT_PROF_BEGIN(stage) do {} while (0)
+#define SIXT_PROF_END(stage) do {} while (0)
+#define SIXT_PROF_COUNT(counter, n) do {} while (0)
+
+#endif /* SIXT_PROFILING */
+
+
+#endif /* PROFILING_H */
@@ -199,3 +199,102 @@ void getOpenPixels(ProjectedMask* proj_repix)
 
   proj_repix->OpenPixels=PixCount;
 }
+
+
+// Smallest integer >=n, which only contains the prime factors 2, 3,
+// and 5 and can therefore be transformed efficiently.
+static int getFFTSize(const int n)
+{
+  int m;
+  for (m=MAX(n, 1); ; m++) {
+    int r=m;
+    while (0==r%2) r/=2;
+    while (0==r%3) r/=3;
+    while (0==r%5) r/=5;
+    if (1==r) return(m);
+  }
+}
+
+
+void backprojectDetHistogram(const ProjectedMask* const proj,
+			     double** const hist,
+			     const int xwidth, const int ywidth,
+			     const int xstep, const int ystep,
+			     SourceImage* const si, int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+
+  if (proj->OpenPixels<=0.) {
+    SIXT_ERROR("projected mask does not contain any open pixels");
+    *status=EXIT_FAILURE;
+    return;
+  }
+
+  // The FFT arrays have to cover the full extent of the linear
+  // correlation in order to avoid wrap-around effects.
+  const int n1=getFFTSize(MAX(si->naxis1, proj->naxis1+(xwidth-1)*xstep));
+  const int n2=getFFTSize(MAX(si->naxis2, proj->naxis2+(ywidth-1)*ystep));
+  const long nfft=(long)n1*(n2/2+1);
+
+  double* image=NULL;
+  fftw_complex* fft_hist=NULL;
+  fftw_complex* fft_mask=NULL;
+  double* result=NULL;
+
+  do {
+    // Row-major image with n1 rows of n2 pixels.
+    image=(double*)fftw_malloc(sizeof(double)*n1*n2);
+    CHECK_NULL_BREAK(image, *status, "memory allocation for FFT failed");
+
+    // Detector histogram, placed at the positions of the detector
+    // pixels in the SourceImage.
+    int ii, jj;
+    memset(image, 0, sizeof(double)*n1*n2);
+    for(ii=0; ii<xwidth; ii++){
+      for(jj=0; jj<ywidth; jj++){
+	image[(long)(ii*xstep)*n2+jj*ystep]=hist[ii][jj];
+      }
+    }
+    fft_hist=FFTOfArray_r2c(image, n1, n2, status);
+    CHECK_STATUS_BREAK(*status);
+
+    // Flipped and normalized projected mask.
+    memset(image, 0, sizeof(double)*n1*n2);
+    for(ii=0; ii<proj->naxis1; ii++){
+      for(jj=0; jj<proj->naxis2; jj++){
+	int shift_ii=proj->naxis1-1-ii;
+	int shift_jj=proj->naxis2-1-jj;
+	image[(long)shift_ii*n2+shift_jj]=proj->map[ii][jj]/proj->OpenPixels;
+      }
+    }
+    fft_mask=FFTOfArray_r2c(image, n1, n2, status);
+    CHECK_STATUS_BREAK(*status);
+
+    // Multiply the transforms.
+    long kk;
+    for(kk=0; kk<nfft; kk++){
+      double re=fft_hist[kk][0]*fft_mask[kk][0]-fft_hist[kk][1]*fft_mask[kk][1];
+      double im=fft_hist[kk][0]*fft_mask[kk][1]+fft_hist[kk][1]*fft_mask[kk][0];
+      fft_hist[kk][0]=re;
+      fft_hist[kk][1]=im;
+    }
+
+    // The inverse transform releases its input array.
+    result=FFTOfArray_c2r(fft_hist, n1, n2, status);
+    fft_hist=NULL;
+    CHECK_STATUS_BREAK(*status);
+
+    // Add the normalized result to the SourceImage.
+    const double norm=1./((double)n1*(double)n2);
+    for(ii=0; ii<si->naxis1; ii++){
+      for(jj=0; jj<si->naxis2; jj++){
+	si->pixel[ii][jj]+=result[(long)ii*n2+jj]*norm;
+      }
+    }
+  } while(0);
+
+  if (NULL!=image) fftw_free(image);
+  if (NULL!=fft_hist) fftw_free(fft_hist);
+  if (NULL!=fft_mask) fftw_free(fft_mask);
+  if (NULL!=result) fftw_free(result);
+}
@@ -27,6 +27,8 @@
 #include "sixt.h"
 #include "codedmask.h"
 #include "squarepixels.h"
+#include "sourceimage.h"
+#include "fft_array.h"
 
 ////////////////////////////////////////////////////////////////////////
 // Type Declarations.
@@ -68,4 +70,19 @@ void getProjectedMask(const CodedMask* const mask, ProjectedMask* proj);
 
 void getOpenPixels(ProjectedMask* proj_repix); //gets sum of all open-pixel-values -> for normalization
 
+/** Adds the back-projection of a detector-plane histogram to the
+    SourceImage. hist[x][y] contains the summed charge of all events
+    in detector pixel (x,y), whose lower left corner corresponds to
+    the SourceImage pixel (x*xstep, y*ystep). The result is the same
+    as adding the flipped ProjectedMask, normalized by its open
+    pixels, once for every single event, but it is obtained from one
+    FFT-based correlation, i.e., the costs do not depend on the number
+    of events. Contributions that fall outside the SourceImage are
+    discarded. */
+void backprojectDetHistogram(const ProjectedMask* const proj,
+			     double** const hist,
+			     const int xwidth, const int ywidth,
+			     const int xstep, const int ystep,
+			     SourceImage* const si, int* const status);
+
 #endif /* PROJECTEDMASK_H */
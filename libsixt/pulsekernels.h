@@ -0,0 +1,59 @@
+/***********************************************************************
+   This file is part of SIXTE/SIRENA software.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+***********************************************************************
+*                      PULSEKERNELS
+*
+*  File:       pulsekernels.h
+*
+*  Kernels of the pulse detection working on contiguous arrays
+*  (implemented in pulseprocess.cpp, which provides the GSL versions)
+*
+***********************************************************************/
+
+#ifndef PULSEKERNELS_H_
+#define PULSEKERNELS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/** Length of the box-car of 'lpf_boxcar' for the given scale factor and sampling rate */
+	int lpf_boxcar_length(double scaleFactor, int sampleRate);
+
+	/** Low-pass filtering of x[0..n-1] (in place) with a box-car of length boxLength (1<=boxLength<n) */
+	void lpf_boxcar_array(double *x, int n, int boxLength);
+
+	/** Derivative x_(i+1)-x_i of x[0..n-1] (in place, n>=2) */
+	void differentiate_array(double *x, int n);
+
+	/** Low-pass filtering followed by the derivative in a single pass (in place, 1<=boxLength<n) */
+	void lpf_boxcar_differentiate_array(double *x, int n, int boxLength);
+
+	/** Smooth derivative of x[0..n-1] (in place) with a box-car of (even) length N */
+	void smoothDerivative_array(double *x, int n, int N);
+
+	/** Mean and standard deviation of x[0..n-1] (1e10 both if any value is greater than 1e10) */
+	void findMeanSigma_array(const double *x, int n, double *mean, double *sigma);
+
+	/** Median of x[0..n-1] (the elements of 'x' are reordered) */
+	double median_array(double *x, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*PULSEKERNELS_H_*/
@@ -58,11 +58,44 @@ MAP OF SECTIONS IN THIS FILE:
  - 15. find_model_samp1DERsNoReSCLD
  - 16. smoothDerivative
  - 17. noDetect
+ - 19. find_library_row
+ - 20. checkLibraryOrder
+ - 21. lpf_boxcar_differentiate
+ - 22. lpf_boxcar_length, lpf_boxcar_array, lpf_boxcar_differentiate_array
+ - 23. differentiate_array
+ - 24. findMeanSigma_array
+ - 25. median_array
+ - 26. smoothDerivative_array
 
 *******************************************************************************/
 
 #include "pulseprocess.h"
 #include <limits>
+#include <algorithm>
+#include <vector>
+
+// Applies a kernel working on contiguous arrays to the first 'n' elements of a GSL vector (copying them if the vector is not contiguous)
+static void applyArrayKernel(gsl_vector *invector, int n, void (*kernel)(double *, int, int), int param)
+{
+	if (invector->stride == 1)
+	{
+		kernel(invector->data,n,param);
+	}
+	else
+	{
+		gsl_vector *invectorAux = gsl_vector_alloc(n);
+		gsl_vector_view temp = gsl_vector_subvector(invector,0,n);
+		gsl_vector_memcpy(invectorAux,&temp.vector);
+		kernel(invectorAux->data,n,param);
+		gsl_vector_memcpy(&temp.vector,invectorAux);
+		gsl_vector_free(invectorAux); invectorAux = 0;
+	}
+}
+
+static void differentiateKernel(double *x, int n, int)
+{
+	differentiate_array(x,n);
+}
 
 /***** SECTION 1 ************************************************************
 * lpf_boxcar function: This function implements a low pass filtering as a box-car function in time
@@ -79,11 +112,9 @@ MAP OF SECTIONS IN THIS FILE:
 *   	sinc(fc)=0, sinc(1)=0 => fc=1
 *   	fc=kf1 => fc~2f1
 *
-* - Declare variables
-* - Define the LPF (frequency domain) and the box-car function (time domain)
-* - It is going to work with a longer vector to not have fake results for the last boxLength windows
-* - Apply the box-car window by shifting it along the (lengthened) input vector
-* - Free allocated GSL vectors
+* - Define the LPF (frequency domain) and the box-car function (time domain) ('lpf_boxcar_length')
+* - Apply the box-car window by shifting it along the input vector, lengthened with a decaying tail to not have fake
+*   results for the last boxLength windows ('lpf_boxcar_array')
 *
 *  The function returns:
 *    1: Function cannot run
@@ -98,85 +129,13 @@ MAP OF SECTIONS IN THIS FILE:
 ******************************************************************************/
 int lpf_boxcar (gsl_vector **invector, int szVct, double scaleFactor, int sampleRate)
 {
-	string message = "";
-	char valERROR[256];
-	
-	// Declare variables
-	gsl_vector *invectorAux;
-	gsl_vector *invectorAux1;
-	double cutFreq;	//Frequency domain
-	int boxLength;	//Time domain
-	double boxSum = 0.0;
-
 	// Define the LPF (frequency domain) and the box-car function (time domain)
-	cutFreq = 2 * (1/(2*pi*scaleFactor));	//According to Jan, sinc(f1)=0.6 where f1=1/(2pi*scaleFactor)
-						//sinc(0.5)~0.6 => f1~0.5
-						//sinc(fc)=0, sinc(1)=0 => fc=1
-						//fc=kf1 => fc~2f1
-	boxLength =(int) ((1/cutFreq) * sampleRate);
-
-	if (boxLength < 1)		boxLength = 1;
+	int boxLength = lpf_boxcar_length(scaleFactor,sampleRate);
 	if (boxLength >= szVct)	        return(4);
 
-	// It is going to work with a longer vector to not have fake results for the last boxLength windows
-	// (due to not having n samples to take into account)
-	// It is not necessary to check the allocation because 'boxLength' is 1 at least
-	invectorAux = gsl_vector_alloc(szVct+boxLength);
-	invectorAux1 = gsl_vector_alloc(szVct+boxLength);
-	for (int i=0;i<szVct;i++)
-	{
-		gsl_vector_set(invectorAux,i,gsl_vector_get(*invector,i));	// 'i' already correct in the for
-	}
-	double value = gsl_vector_get(*invector,szVct-1);
-	for (int i=szVct;i<szVct+boxLength;i++)
-	{
-		if (value > 0) 		value = value-0.01*value;
-		else if (value< 0)	value = value+0.01*value;
-		gsl_vector_set(invectorAux,i,value);				// 'i' already correct in the for
-	}
-
-	// Apply the box-car window by shifting it along the (lengthened) input vector 
-	for (int i=0;i<boxLength;i++)
-	{
-		boxSum = boxSum + gsl_vector_get(invectorAux,i);
-	}
-	gsl_vector_set(invectorAux1,0,boxSum/boxLength);			// 'i' already correct in the for
-
-	if (invectorAux->size-boxLength-1+1 > invectorAux1->size-1)
-	{
-		sprintf(valERROR,"%d",__LINE__+8);
-		string str(valERROR);
-		message = "Setting i-th element of vector out of range in line " + str + " (" + __FILE__ + ")";
-		EP_PRINT_ERROR(message,EPFAIL);
-	}
-	for (int i=0;i<invectorAux->size-boxLength;i++)
-	{
-		boxSum = boxSum - gsl_vector_get(invectorAux,i) + gsl_vector_get(invectorAux,i+boxLength);
-		gsl_vector_set(invectorAux1,i+1,boxSum/boxLength);		
-	}
-
-	if (invectorAux->size-boxLength+boxLength-2+1 > invectorAux1->size-1)
-	{
-		sprintf(valERROR,"%d",__LINE__+8);
-		string str(valERROR);
-		message = "Setting i-th element of vector out of range in line " + str + " (" + __FILE__ + ")";
-		EP_PRINT_ERROR(message,EPFAIL);
-	}
-	for (int i=0;i<boxLength-1;i++)
-	{
-		boxSum = boxSum - gsl_vector_get(invectorAux,invectorAux->size-boxLength+i);
-		gsl_vector_set(invectorAux1,invectorAux->size-boxLength+i+1,boxSum/(boxLength-i-1));
-	}
-
-	for (int i=0;i<szVct;i++)
-	{
-		gsl_vector_set(*invector,i,gsl_vector_get(invectorAux1,i));	// 'i' already correct in the for
-	}
+	// Apply the box-car window by shifting it along the (lengthened) input vector
+	applyArrayKernel(*invector,szVct,lpf_boxcar_array,boxLength);
 
-	// Free allocated GSL vectors
-	gsl_vector_free(invectorAux); invectorAux = 0;
-	gsl_vector_free(invectorAux1); invectorAux1 = 0;
-	
 	if (boxLength == 1)	return(3);
 
 	return (EPOK);
@@ -196,12 +155,7 @@ int lpf_boxcar (gsl_vector **invector, int szVct, double scaleFactor, int sample
 ******************************************************************************/
 int differentiate (gsl_vector **invector,int szVct)
 {
-	for (int i=0; i<szVct-1; i++)
-	{
-		gsl_vector_set(*invector,i,gsl_vector_get(*invector,i+1)-gsl_vector_get(*invector,i));	
-	}
-	gsl_vector_set(*invector,szVct-1,gsl_vector_get(*invector,szVct-2));
-	//gsl_vector_set(*invector,szVct-1,-999);
+	applyArrayKernel(*invector,szVct,differentiateKernel,0);
 
 	return (EPOK);
 }
@@ -218,41 +172,16 @@ int differentiate (gsl_vector **invector,int szVct)
 ******************************************************************************/
 int findMeanSigma (gsl_vector *invector, double *mean, double *sigma)
 {
-	// Declare variables
-	int size = invector->size; // Size of the input vector
-	// To calculate the mean
-	bool veryBig = false;
-        double suma = 0.0;
-
-	// Mean
-	for (int i=0;i<size;i++)
+	if (invector->stride == 1)
 	{
-                if (gsl_vector_get(invector,i)>1e10)
-		{
-			veryBig =true;
-			break;
-		}
-	}
-	
-	if (veryBig == false)
-	{
-                *mean = 0.0;
-                for (int i=0;i<size;i++)
-                {
-                    *mean = *mean + gsl_vector_get(invector,i);
-                }
-                *mean = *mean/size;
-		// Standard deviation
-                for (int i=0;i<size;i++)
-                {
-                    suma = suma + pow(gsl_vector_get(invector,i)-*mean,2.0);
-                }
-                *sigma = sqrt(suma/(size-1));
+		findMeanSigma_array(invector->data,invector->size,mean,sigma);
 	}
-	else	// To avoid an inf in IO or a NAN in JUPITER
+	else
 	{
-		*mean = 1e10;
-		*sigma = 1e10;
+		gsl_vector *invectorAux = gsl_vector_alloc(invector->size);
+		gsl_vector_memcpy(invectorAux,invector);
+		findMeanSigma_array(invectorAux->data,invectorAux->size,mean,sigma);
+		gsl_vector_free(invectorAux); invectorAux = 0;
 	}
 
 	return EPOK;
@@ -270,7 +199,7 @@ int findMeanSigma (gsl_vector *invector, double *mean, double *sigma)
 * if there are pulses in the input invector they are always positive).
 *
 * - Declare variables
-* - Calculate the median
+* - Calculate the median (by selection, 'median_array')
 * - Iterate until there are no points out of the maximum excursion (kappa*sigma)
 * - Establish the threshold as mean+nSigmas*sigma
 *
@@ -291,77 +220,55 @@ int medianKappaClipping (gsl_vector *invector, double kappa, double stopCriteria
 	int size = invector->size; // Size of the input vector
 	double mean1, sg1;
 	double mean2, sg2;
-	gsl_vector_view temp;
 	// Variables to remove input vector elements higher than the maximum excursion (kappa*sg)
-	int i;							// To go through the elements of a vector
-	int cnt;						// Number of points inside the excursion (mean+-excursion)
-	// It is not necessary to check the allocation because 'invector' size must already be > 0
-	gsl_vector *invectorNew = gsl_vector_alloc(size);	// Auxiliary vector
-        
-	// To calculate the median
-	//double data[size];					// Intermediate value to use 'gsl_stats_median_from_sorted_data'
+	int cnt;						// Number of points outside the excursion (mean+-excursion)
 	double median;
 
+	// The mean and sigma are calculated without the last boxLPF+1 samples (affected by the low-pass filtering)
+	int sizeStats = size-boxLPF-1;
+	if ((sizeStats < 1) || (sizeStats > size))
+	{
+		// As before, a too short vector is reported but not treated as a failure (the statistics of the empty
+		// view are not defined, so the threshold is NaN and no pulses are found in this record)
+		sprintf(valERROR,"%d",__LINE__-5);
+		string str(valERROR);
+		message = "View goes out of scope the original vector in line " + str + " (" + __FILE__ + ")";
+		EP_PRINT_ERROR(message,EPFAIL);
+		sizeStats = 0;
+	}
+
+	// It is not necessary to check the allocation because 'invector' size must already be > 0
+	gsl_vector *invectorNew = gsl_vector_alloc(size);	// Auxiliary (contiguous) vector
+	double *data = invectorNew->data;
+
 	// Median
-        gsl_vector_memcpy(invectorNew,invector);
-        gsl_sort_vector(invectorNew);
-        if (size%2 == 0)	//Even
-        {
-            median = (gsl_vector_get(invectorNew,(int) (size/2)-1)+gsl_vector_get(invectorNew,(int) (size/2)))/2;
-        }
-        else                    //Odd
-        {
-            median = gsl_vector_get(invectorNew,(int) (size/2));
-        }
+	gsl_vector_memcpy(invectorNew,invector);
+	median = median_array(data,size);
 
 	gsl_vector_memcpy(invectorNew,invector);
 
 	// Iterate until no points out of the maximum excursion (kappa*sigma)
 	do
 	{
-		if ((size-boxLPF-1 < 1) || (size-boxLPF-1 >invectorNew->size))
-		{
-			sprintf(valERROR,"%d",__LINE__+5);
-			string str(valERROR);
-			message = "View goes out of scope the original vector in line " + str + " (" + __FILE__ + ")";
-			EP_PRINT_ERROR(message,EPFAIL);
-		}
-		temp = gsl_vector_subvector(invectorNew,0,size-boxLPF-1);
-		if (findMeanSigma (&temp.vector, &mean1, &sg1))
-		{
-			message = "Cannot run findMeanSigma routine for kappa-sigma iteration";
-			EP_PRINT_ERROR(message,EPFAIL);return(EPFAIL);
-		}
-		i = 0;
-		cnt = 0;
+		findMeanSigma_array(data,sizeStats,&mean1,&sg1);
 
-		while (i<invectorNew->size)
+		// HARDPOINT!!!!!!!!!!!!!!!!!!! (kappa)
+		double upper = mean1 + kappa*sg1;
+		double lower = mean1 - kappa*sg1;
+		cnt = 0;
+		for (int i=0;i<size;i++)
 		{
-			if ((gsl_vector_get(invectorNew,i) >= mean1 + kappa*sg1) || (gsl_vector_get(invectorNew,i) <= mean1 - kappa*sg1))
-			// HARDPOINT!!!!!!!!!!!!!!!!!!! (kappa)
+			if ((data[i] >= upper) || (data[i] <= lower))
 			{
-				if ((i < 0) || (i >(invectorNew)->size-1))
-				{
-					sprintf(valERROR,"%d",__LINE__+5);
-					string str(valERROR);
-					message = "Setting with <= 0 size in line " + str + " (" + __FILE__ + ")";
-					EP_PRINT_ERROR(message,EPFAIL);
-				}
-				gsl_vector_set(invectorNew,i,median);
+				data[i] = median;
 				cnt++;
 			}
-			i++;
 		}
 
 		if (cnt != 0)
 		// Some points of the invector have been replaced with the median
 		{
-			temp = gsl_vector_subvector(invectorNew,0,size-boxLPF-1);
-			if (findMeanSigma (&temp.vector, &mean2, &sg2))
-			{
-				message = "Cannot run findMeanSigma routine for kappa-sigma iteration after replacement with the median";
-				EP_PRINT_ERROR(message,EPFAIL);return(EPFAIL);
-			}
+			findMeanSigma_array(data,sizeStats,&mean2,&sg2);
 		}
 		else
 		// No points of the invector have been replaced with the median
@@ -1350,67 +1257,48 @@ int RS_filter (gsl_vector *vector, double lrs, double lb, double B, double *puls
 int find_model_energies(double energy, ReconstructInitSIRENA *reconstruct_init,gsl_vector **modelFound)
 {
 	string message = "";
-	char valERROR[256];
-	
-	gsl_vector *modelFound_aux;
-	if ((modelFound_aux = gsl_vector_alloc(reconstruct_init->library_collection->pulse_templates[0].template_duration)) == 0)
-	{
-		sprintf(valERROR,"%d",__LINE__-2);
-		string str(valERROR);
-	        message = "Allocating with <= 0 size in line " + str + " (" + __FILE__ + ")";
-		EP_PRINT_ERROR(message,EPFAIL);
-	}
 
 	long nummodels = reconstruct_init->library_collection->ntemplates;
 
+	gsl_vector_view temp;
+
 	if (energy < gsl_vector_get(reconstruct_init->library_collection->energies,0))
 	{
-		gsl_vector_memcpy(modelFound_aux,reconstruct_init->library_collection->pulse_templates_B0[0].ptemplate);
-		gsl_vector_scale(modelFound_aux,energy/gsl_vector_get(reconstruct_init->library_collection->energies,0));
+		temp = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_B0[0].ptemplate,0,(*modelFound)->size);
+		gsl_vector_memcpy(*modelFound,&temp.vector);
+		gsl_vector_scale(*modelFound,energy/gsl_vector_get(reconstruct_init->library_collection->energies,0));
 	}
 	else if (energy > gsl_vector_get(reconstruct_init->library_collection->energies,nummodels-1))
 	{
-		gsl_vector_memcpy(modelFound_aux,reconstruct_init->library_collection->pulse_templates_B0[nummodels-1].ptemplate);
-		gsl_vector_scale(modelFound_aux,energy/gsl_vector_get(reconstruct_init->library_collection->energies,nummodels-1));
+		temp = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_B0[nummodels-1].ptemplate,0,(*modelFound)->size);
+		gsl_vector_memcpy(*modelFound,&temp.vector);
+		gsl_vector_scale(*modelFound,energy/gsl_vector_get(reconstruct_init->library_collection->energies,nummodels-1));
 	}
 	else
 	{
-		for (int i=0;i<nummodels-1;i++)
+		long i = find_library_row(reconstruct_init->library_collection->energies,nummodels,energy,1);
+
+		if (fabs(energy-gsl_vector_get(reconstruct_init->library_collection->energies,i))<1e-6)
 		{
-			if (fabs(energy-gsl_vector_get(reconstruct_init->library_collection->energies,i))<1e-6)
-			{
-				gsl_vector_memcpy(modelFound_aux,reconstruct_init->library_collection->pulse_templates_B0[i].ptemplate);
-				gsl_vector_scale(modelFound_aux,energy/gsl_vector_get(reconstruct_init->library_collection->energies,i));
+			temp = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_B0[i].ptemplate,0,(*modelFound)->size);
+			gsl_vector_memcpy(*modelFound,&temp.vector);
+			gsl_vector_scale(*modelFound,energy/gsl_vector_get(reconstruct_init->library_collection->energies,i));
+		}
+		else
+		{
+			// Interpolate between the two corresponding rows in "models"
+			gsl_vector_view tempA = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_B0[i].ptemplate,0,(*modelFound)->size);
+			gsl_vector_view tempB = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_B0[i+1].ptemplate,0,(*modelFound)->size);
 
-				break;
-			}
-			else if ((energy > gsl_vector_get(reconstruct_init->library_collection->energies,i)) && (energy < gsl_vector_get(reconstruct_init->library_collection->energies,i+1)))
+			if (interpolate_model(modelFound,energy,&tempA.vector,gsl_vector_get(reconstruct_init->library_collection->energies,i),
+				&tempB.vector,gsl_vector_get(reconstruct_init->library_collection->energies,i+1)))
 			{
-				// Interpolate between the two corresponding rows in "models"
-				// It is not necessary to check the allocation because the same kind of allocation has been checked previously
-				gsl_vector *modelAux = gsl_vector_alloc(reconstruct_init->library_collection->pulse_templates[0].template_duration);
-				gsl_vector_set_zero(modelAux);
-
-				if (interpolate_model(&modelAux,energy,reconstruct_init->library_collection->pulse_templates_B0[i].ptemplate,gsl_vector_get(reconstruct_init->library_collection->energies,i),
-					reconstruct_init->library_collection->pulse_templates_B0[i+1].ptemplate,gsl_vector_get(reconstruct_init->library_collection->energies,i+1)))
-				{
-					message = "Cannot run interpolate_model with two rows in models";
-					EP_PRINT_ERROR(message,EPFAIL);return(EPFAIL);
-				}
-				gsl_vector_memcpy(modelFound_aux,modelAux);
-				gsl_vector_free(modelAux); modelAux = 0;
-
-				break;
+				message = "Cannot run interpolate_model with two rows in models";
+				EP_PRINT_ERROR(message,EPFAIL);return(EPFAIL);
 			}
 		}
 	}
 
-	gsl_vector_view temp;
-	temp = gsl_vector_subvector(modelFound_aux,0,(*modelFound)->size);
-	gsl_vector_memcpy(*modelFound,&temp.vector);
-
-	gsl_vector_free(modelFound_aux); modelFound_aux = 0;
-
     return(EPOK);
 }
 /*xxxx end of SECTION 8 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
@@ -1434,7 +1322,6 @@ int find_model_energies(double energy, ReconstructInitSIRENA *reconstruct_init,g
 int find_model_maxDERs(double maxDER, ReconstructInitSIRENA *reconstruct_init, gsl_vector **modelFound)
 {
 	string message = "";
-	char valERROR[256];
 
 	long nummodels = reconstruct_init->library_collection->ntemplates;
         
@@ -1454,38 +1341,25 @@ int find_model_maxDERs(double maxDER, ReconstructInitSIRENA *reconstruct_init, g
 	}
 	else
 	{
-		for (int i=0;i<nummodels-1;i++)
+		long i = find_library_row(reconstruct_init->library_collection->maxDERs,nummodels,maxDER,1);
+
+		if (fabs(maxDER-gsl_vector_get(reconstruct_init->library_collection->maxDERs,i))<1e-6)
 		{
-			if (fabs(maxDER-gsl_vector_get(reconstruct_init->library_collection->maxDERs,i))<1e-6)
-			{
-                                temp = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[i].ptemplate,0,(*modelFound)->size);
-                                gsl_vector_memcpy(*modelFound,&temp.vector);
-                                gsl_vector_scale(*modelFound,maxDER/gsl_vector_max(*modelFound));
+                        temp = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[i].ptemplate,0,(*modelFound)->size);
+                        gsl_vector_memcpy(*modelFound,&temp.vector);
+                        gsl_vector_scale(*modelFound,maxDER/gsl_vector_max(*modelFound));
+		}
+		else
+		{
+			// Interpolate between the two corresponding rows in "models"
+                        gsl_vector_view tempA = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[i].ptemplate,0,(*modelFound)->size);
+                        gsl_vector_view tempB = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[i+1].ptemplate,0,(*modelFound)->size);
 
-				break;
-			}
-			else if ((maxDER > gsl_vector_get(reconstruct_init->library_collection->maxDERs,i)) && (maxDER < gsl_vector_get(reconstruct_init->library_collection->maxDERs,i+1)))
+                        if (interpolate_model(modelFound,maxDER,&tempA.vector,gsl_vector_get(reconstruct_init->library_collection->maxDERs,i),
+                                &tempB.vector,gsl_vector_get(reconstruct_init->library_collection->maxDERs,i+1)))
 			{
-				// Interpolate between the two corresponding rows in "models"
-                                
-                                gsl_vector *modelA = gsl_vector_alloc((*modelFound)->size);
-                                gsl_vector *modelB = gsl_vector_alloc((*modelFound)->size);
-                                gsl_vector_set_zero(*modelFound);
-                                temp = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[i].ptemplate,0,(*modelFound)->size);
-                                gsl_vector_memcpy(modelA,&temp.vector);
-                                temp = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[i+1].ptemplate,0,(*modelFound)->size);
-                                gsl_vector_memcpy(modelB,&temp.vector);
-
-                                if (interpolate_model(modelFound,maxDER,modelA,gsl_vector_get(reconstruct_init->library_collection->maxDERs,i),modelB,gsl_vector_get(reconstruct_init->library_collection->maxDERs,i+1)))
-				{
-					message = "Cannot run interpolate_model with two rows in models";
-					EP_PRINT_ERROR(message,EPFAIL);return(EPFAIL);
-				}
-				
-				gsl_vector_free(modelA); modelA = 0;
-                                gsl_vector_free(modelB); modelB = 0;
-
-				break;
+				message = "Cannot run interpolate_model with two rows in models";
+				EP_PRINT_ERROR(message,EPFAIL);return(EPFAIL);
 			}
 		}
 	}
@@ -1515,7 +1389,6 @@ int find_model_maxDERs(double maxDER, ReconstructInitSIRENA *reconstruct_init, g
 int find_model_samp1DERs(double samp1DER, ReconstructInitSIRENA *reconstruct_init, gsl_vector **modelFound)
 {
 	string message = "";
-	char valERROR[256];
 	
 	long nummodels = reconstruct_init->library_collection->ntemplates;
         
@@ -1533,32 +1406,25 @@ int find_model_samp1DERs(double samp1DER, ReconstructInitSIRENA *reconstruct_ini
                 gsl_vector_memcpy(*modelFound,&temp.vector);
                 gsl_vector_scale(*modelFound,samp1DER/gsl_vector_get(*modelFound,0));  ///Creo que haba un error antes escalando con 'gsl_vector_get(modelFound_aux,nummodels-1)'
 	}
+	else if (nummodels == 1)
+	{
+                temp = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[0].ptemplate,0,(*modelFound)->size);
+                gsl_vector_memcpy(*modelFound,&temp.vector);
+	}
 	else
 	{
-		for (int i=0;i<nummodels-1;i++)
-		{
-			if ((samp1DER >= gsl_vector_get(reconstruct_init->library_collection->samp1DERs,i)) && (samp1DER < gsl_vector_get(reconstruct_init->library_collection->samp1DERs,i+1)))
-			{
-				// Interpolate between the two corresponding rows in "models"
-                                gsl_vector *modelA = gsl_vector_alloc((*modelFound)->size);
-                                gsl_vector *modelB = gsl_vector_alloc((*modelFound)->size);
-                                gsl_vector_set_zero(*modelFound);
-                                temp = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[i].ptemplate,0,(*modelFound)->size);
-                                gsl_vector_memcpy(modelA,&temp.vector);
-                                temp = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[i+1].ptemplate,0,(*modelFound)->size);
-                                gsl_vector_memcpy(modelB,&temp.vector);
-
-                                if (interpolate_model(modelFound,samp1DER,modelA,gsl_vector_get(reconstruct_init->library_collection->samp1DERs,i),modelB,gsl_vector_get(reconstruct_init->library_collection->samp1DERs,i+1)))
-				{
-					message = "Cannot run interpolate_model with two rows in models";
-					EP_PRINT_ERROR(message,EPFAIL);return(EPFAIL);
-				}
-				gsl_vector_free(modelA); modelA = 0;
-                                gsl_vector_free(modelB); modelB = 0;
+		// 'samp1DER' equal to the last 'samp1DERs' is interpolated between the last two rows
+		long i = GSL_MIN(find_library_row(reconstruct_init->library_collection->samp1DERs,nummodels,samp1DER,0),nummodels-2);
 
+		// Interpolate between the two corresponding rows in "models"
+                gsl_vector_view tempA = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[i].ptemplate,0,(*modelFound)->size);
+                gsl_vector_view tempB = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[i+1].ptemplate,0,(*modelFound)->size);
 
-				break;
-			}
+                if (interpolate_model(modelFound,samp1DER,&tempA.vector,gsl_vector_get(reconstruct_init->library_collection->samp1DERs,i),
+                        &tempB.vector,gsl_vector_get(reconstruct_init->library_collection->samp1DERs,i+1)))
+		{
+			message = "Cannot run interpolate_model with two rows in models";
+			EP_PRINT_ERROR(message,EPFAIL);return(EPFAIL);
 		}
 	}
 	
@@ -1594,12 +1460,6 @@ int interpolate_model(gsl_vector **modelFound, double p_model, gsl_vector *model
 {
 	// Declare variables
 	double factor1, factor2;
-	
-	// It is not necessary to check the allocation because 'modelIn1' and 'modelIn2' sizes must already be > 0
-	gsl_vector *modelIn1Aux = gsl_vector_alloc(modelIn1->size);
-	gsl_vector *modelIn2Aux = gsl_vector_alloc(modelIn2->size);
-	gsl_vector_memcpy(modelIn1Aux,modelIn1);
-	gsl_vector_memcpy(modelIn2Aux,modelIn2);
 
 	// Method 1: The simplest method
 	/*gsl_vector_add(*modelFound,modelIn1);
@@ -1609,13 +1469,12 @@ int interpolate_model(gsl_vector **modelFound, double p_model, gsl_vector *model
 	// Method 2: A bit more intelligent averaging
 	factor1 = (p_modelIn2-p_model)/(p_modelIn2-p_modelIn1);
 	factor2 = (p_model-p_modelIn1)/(p_modelIn2-p_modelIn1);
-	gsl_vector_scale(modelIn1Aux,factor1);
-	gsl_vector_scale(modelIn2Aux,factor2);
-        gsl_vector_memcpy(*modelFound,modelIn1Aux);
-	gsl_vector_add(*modelFound,modelIn2Aux);
 	
-	gsl_vector_free(modelIn1Aux); modelIn1Aux = 0;
-	gsl_vector_free(modelIn2Aux); modelIn2Aux = 0;
+	// No auxiliary vectors are allocated ('modelFound' may not alias 'modelIn1' or 'modelIn2')
+	for (size_t k=0;k<(*modelFound)->size;k++)
+	{
+		gsl_vector_set(*modelFound,k,factor1*gsl_vector_get(modelIn1,k)+factor2*gsl_vector_get(modelIn2,k));
+	}
 
     return(EPOK);
 }
@@ -2753,7 +2612,6 @@ int FindSecondaries
 int find_model_samp1DERsNoReSCLD(double samp1DER, ReconstructInitSIRENA *reconstruct_init, gsl_vector **modelFound, int *indexMin, int *indexMax)
 {
 	string message = "";
-	char valERROR[256];
 
 	long nummodels = reconstruct_init->library_collection->ntemplates;
         
@@ -2767,7 +2625,7 @@ int find_model_samp1DERsNoReSCLD(double samp1DER, ReconstructInitSIRENA *reconst
                 *indexMin = -999;
                 *indexMax = 0;
 	}
-	else if (samp1DER > gsl_vector_get(reconstruct_init->library_collection->samp1DERs,nummodels-1))
+	else if ((samp1DER > gsl_vector_get(reconstruct_init->library_collection->samp1DERs,nummodels-1)) || (nummodels == 1))
 	{
                 temp = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[nummodels-1].ptemplate,0,(*modelFound)->size);
                 gsl_vector_memcpy(*modelFound,&temp.vector);
@@ -2777,33 +2635,21 @@ int find_model_samp1DERsNoReSCLD(double samp1DER, ReconstructInitSIRENA *reconst
 	}
 	else
 	{
-		for (int i=0;i<nummodels-1;i++)
-		{
-			if ((samp1DER >= gsl_vector_get(reconstruct_init->library_collection->samp1DERs,i)) && (samp1DER < gsl_vector_get(reconstruct_init->library_collection->samp1DERs,i+1)))
-			{
-				// Interpolate between the two corresponding rows in "models"
-	                        *indexMin = i;
-                                *indexMax = i+1;
-                                
-                                gsl_vector *modelA = gsl_vector_alloc((*modelFound)->size);
-                                gsl_vector *modelB = gsl_vector_alloc((*modelFound)->size);
-                                gsl_vector_set_zero(*modelFound);
-                                temp = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[i].ptemplate,0,(*modelFound)->size);
-                                gsl_vector_memcpy(modelA,&temp.vector);
-                                temp = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[i+1].ptemplate,0,(*modelFound)->size);
-                                gsl_vector_memcpy(modelB,&temp.vector);
-
-                                if (interpolate_model(modelFound,samp1DER,modelA,gsl_vector_get(reconstruct_init->library_collection->samp1DERs,i),modelB,gsl_vector_get(reconstruct_init->library_collection->samp1DERs,i+1)))
-				{
-					message = "Cannot run interpolate_model with two rows in models";
-					EP_PRINT_ERROR(message,EPFAIL);return(EPFAIL);
-				}
-				
-				gsl_vector_free(modelA); modelA = 0;
-                                gsl_vector_free(modelB); modelB = 0;
+		// 'samp1DER' equal to the last 'samp1DERs' is interpolated between the last two rows
+		long i = GSL_MIN(find_library_row(reconstruct_init->library_collection->samp1DERs,nummodels,samp1DER,0),nummodels-2);
 
-				break;
-			}
+		// Interpolate between the two corresponding rows in "models"
+                *indexMin = i;
+                *indexMax = i+1;
+
+                gsl_vector_view tempA = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[i].ptemplate,0,(*modelFound)->size);
+                gsl_vector_view tempB = gsl_vector_subvector(reconstruct_init->library_collection->pulse_templates_filder[i+1].ptemplate,0,(*modelFound)->size);
+
+                if (interpolate_model(modelFound,samp1DER,&tempA.vector,gsl_vector_get(reconstruct_init->library_collection->samp1DERs,i),
+                        &tempB.vector,gsl_vector_get(reconstruct_init->library_collection->samp1DERs,i+1)))
+		{
+			message = "Cannot run interpolate_model with two rows in models";
+			EP_PRINT_ERROR(message,EPFAIL);return(EPFAIL);
 		}
 	}
 
@@ -2815,6 +2661,8 @@ int find_model_samp1DERsNoReSCLD(double samp1DER, ReconstructInitSIRENA *reconst
 /***** SECTION 16 ************************************************************
 * smoothDerivative function: This function applies the smooth derivative to the input vector
 *
+* The input vector is convolved with a box-car of length N whose first half is -1 and second half +1 ('smoothDerivative_array').
+*
 * Parameters:
 * - invector: Input/Ouput GSL vector (input vector/smooth differentiated input vector)
 * - N: box-car length (it must be an even number)
@@ -2829,71 +2677,7 @@ int smoothDerivative (gsl_vector **invector, int N)
         }
         else            // Even number
         {
-                //gsl_vector *invectorAux = gsl_vector_alloc((*invector)->size+N);
-                int szVct = (*invector)->size+N;
-                //int szVct = invectorAux->size;
-                //for (int i=0;i<N;i++)       gsl_vector_set(invectorAux,i,0.0);
-                //for (int i=N;i<szVct;i++)   gsl_vector_set(invectorAux,i,gsl_vector_get(*invector,i-N));
-
-                //cout<<"smoothDerivative0:"<<endl;
-                //for (int i=0;i<szVct-N;i++)   cout<<i<<" "<<gsl_vector_get(*invector,i)<<endl;
-                
-                gsl_vector *window = gsl_vector_alloc(N);
-                gsl_vector_set_all(window,1.0);
-                for (int i=0;i<N/2;i++)     gsl_vector_set(window,i,-1.0);
-                
-                gsl_vector *conv = gsl_vector_alloc(szVct);
-                gsl_vector_set_zero(conv);
-                
-            
-                
-                int index;
-                for (int i=0;i<szVct;i++)
-                {
-                        //cout<<"i: "<<i<<endl;
-                        index = N-1;
-                        for (int j=i;j>=i-N+1;j--)
-                        {
-                                //cout<<"j: "<<j<<endl;
-                                //if ((j>=0) && (j<szVct))
-                                if ((j>=0) && (j<(*invector)->size))
-                                {
-                                        //cout<<i<<" "<<j<<" "<<index<<endl;
-                                        gsl_vector_set(conv,i,gsl_vector_get(conv,i)+gsl_vector_get(*invector,j)*gsl_vector_get(window,index));
-                                        //gsl_vector_set(conv,i,gsl_vector_get(conv,i)+gsl_vector_get(invectorAux,j)*gsl_vector_get(window,index));
-                                        index = index - 1;
-                                        //cout<<"if "<<i<<" "<<j<<" "<<index<<" conv="<<gsl_vector_get(conv,i)<<endl;
-                                }
-                        }
-                }
-                
-                gsl_vector_free(window); window = 0;
-                //cout<<"smoothDerivative1:"<<endl;
-                //for (int i=0;i<szVct;i++)   cout<<i<<" "<<gsl_vector_get(conv,i)<<endl;
-                
-                //cout<<"(*invector)->size: "<<(*invector)->size<<endl;
-                //cout<<"conv->size: "<<conv->size<<endl;
-                gsl_vector_view temp;
-                temp = gsl_vector_subvector(conv,0,szVct-N);
-		gsl_vector_memcpy(*invector,&temp.vector);
-                //for (int i=0;i<N-1;i++)     
-                //        gsl_vector_set(*invector,i,0.0);
-                //cout<<"sm0: "<<gsl_vector_get(*invector,(*invector)->size-3)<<" "<<gsl_vector_get(*invector,(*invector)->size-2)<<" "<<gsl_vector_get(*invector,(*invector)->size-1)<<endl;
-                
-                //gsl_vector_set(*invector,(*invector)->size-1,gsl_vector_get(*invector,(*invector)->size-2));
-                
-                //cout<<"sm1: "<<gsl_vector_get(*invector,(*invector)->size-3)<<" "<<gsl_vector_get(*invector,(*invector)->size-2)<<" "<<gsl_vector_get(*invector,(*invector)->size-1)<<endl;
-                
-                //cout<<"smoothDerivative2:"<<endl;
-                //for (int i=0;i<(*invector)->size;i++)   cout<<i<<" "<<gsl_vector_get(*invector,i)<<endl;
-                
-                //gsl_vector_memcpy(invectorAux,conv);
-                
-                /*gsl_vector_view temp;
-                temp = gsl_vector_subvector(conv,N,szVct-N);
-		gsl_vector_memcpy(*invector,&temp.vector);*/
-                
-                gsl_vector_free(conv); conv = 0;
+                applyArrayKernel(*invector,(*invector)->size,smoothDerivative_array,N);
         }
 
 	return (EPOK);
@@ -3244,3 +3028,345 @@ int noDetect(gsl_vector *der, ReconstructInitSIRENA *reconstruct_init, int *numb
         return (EPOK);
 }
 /*xxxx end of SECTION 18 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
+
+
+/***** SECTION 19 ************************************************************
+* find_library_row function: This function finds by binary search the row of the library whose parameter (energy, maxDER or samp1DER)
+*                            is the largest one lower than or equal to 'p'.
+*
+* The library rows are sorted by energy, and 'maxDERs' and 'samp1DERs' increase with the energy (see 'checkLibraryOrder'). Then, if 
+* 'p' is in the range of the library, the rows 'i' and 'i+1' straddle 'p' (or 'p' is the parameter of the last row, 'i'='nummodels'-1).
+* If 'p' is lower than the lowest parameter, 0 is returned.
+*
+* If several rows have the parameter 'p', the first one is returned if 'firstEqual'=1 and the last one otherwise. This is the row the 
+* linear scans found: the ones checking first whether 'p' is equal to the parameter of the row stop at the first equal row, and the ones 
+* looking for 'params[i]' <= 'p' < 'params[i+1]' ('find_model_samp1DERs') stop at the last one.
+* If the parameters are not sorted, the rows 'i' and 'i+1' still straddle 'p', but they may not be the first ones doing it in the library.
+*
+* Parameters:
+* - params: GSL vector with the parameters of the library rows ('energies', 'maxDERs' or 'samp1DERs')
+* - nummodels: Number of rows of the library to be taken into account
+* - p: Parameter of the pulse whose template or filter is being sought
+* - firstEqual: 1 to return the first of the rows whose parameter is equal to 'p', 0 to return the last one
+******************************************************************************/
+long find_library_row(gsl_vector *params, long nummodels, double p, int firstEqual)
+{
+	long lo = 0;
+	long hi = nummodels;
+
+	// Invariant: params[lo] <= p < params[hi] (params[nummodels] = +infinity)
+	while (hi-lo > 1)
+	{
+		long mid = lo+(hi-lo)/2;
+		if (gsl_vector_get(params,mid) <= p)	lo = mid;
+		else					hi = mid;
+	}
+
+	if ((firstEqual == 1) && (gsl_vector_get(params,lo) == p))
+	{
+		// First row of the run of rows equal to 'p' (invariant: params[lo] != p, params[hi] = p)
+		if (gsl_vector_get(params,0) == p)	return(0);
+		hi = lo;
+		lo = 0;
+		while (hi-lo > 1)
+		{
+			long mid = lo+(hi-lo)/2;
+			if (gsl_vector_get(params,mid) == p)	hi = mid;
+			else					lo = mid;
+		}
+		lo = hi;
+	}
+
+	return(lo);
+}
+/*xxxx end of SECTION 19 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
+
+
+/***** SECTION 20 ************************************************************
+* checkLibraryOrder function: This function checks that the parameters of the library rows ('energies', 'maxDERs' or 'samp1DERs') are in 
+*                             ascending order, as required by the binary search of the library rows ('find_library_row').
+*
+* If they are not, a warning is written (the found rows may not be the ones the linear scans of the library used to find).
+*
+* Parameters:
+* - params: GSL vector with the parameters of the library rows
+* - nummodels: Number of rows of the library
+* - name: Name of the parameter (for the warning)
+******************************************************************************/
+int checkLibraryOrder(gsl_vector *params, long nummodels, const char *name)
+{
+	string message = "";
+
+	for (long i=0;i<nummodels-1;i++)
+	{
+		if (gsl_vector_get(params,i+1) < gsl_vector_get(params,i))
+		{
+			message = "The library " + string(name) + " are not in ascending order => Templates and filters can be wrongly interpolated";
+			EP_PRINT_ERROR(message,-999);	// Only a warning
+			break;
+		}
+	}
+
+	return(EPOK);
+}
+/*xxxx end of SECTION 20 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
+
+
+/***** SECTION 21 ************************************************************
+* lpf_boxcar_differentiate function: This function low-pass filters ('lpf_boxcar') and differentiates ('differentiate') the input
+*                                    vector in a single pass over the data ('lpf_boxcar_differentiate_array').
+*
+* The result is the same as calling 'lpf_boxcar' and 'differentiate' one after the other.
+*
+*  The function returns (as 'lpf_boxcar'):
+*    1: Function cannot run
+*    3: Cut-off frequency too high => Equivalent to not filter (the input vector is only differentiated)
+*    4: Cut-off frequency too low (the input vector is not modified)
+*
+* Parameters:
+* - invector: Input/Output vector (non-filtered input vector/differentiated filtered input vector)
+* - szVct: Size of the invector
+* - scaleFactor: Scale factor
+* - sampleRate: Sampling frequency (samples per second)
+******************************************************************************/
+int lpf_boxcar_differentiate (gsl_vector **invector, int szVct, double scaleFactor, int sampleRate)
+{
+	int boxLength = lpf_boxcar_length(scaleFactor,sampleRate);
+	if (boxLength >= szVct)	        return(4);
+
+	applyArrayKernel(*invector,szVct,lpf_boxcar_differentiate_array,boxLength);
+
+	if (boxLength == 1)	return(3);
+
+	return (EPOK);
+}
+/*xxxx end of SECTION 21 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
+
+
+/***** SECTION 22 ************************************************************
+* lpf_boxcar_length function: This function calculates the length of the box-car of 'lpf_boxcar' (at least 1).
+*
+* lpf_boxcar_array function: This function low-pass filters (in place) an array of 'n' samples with a box-car of length 'boxLength'.
+*
+* The box-car sum is updated as a running sum (one sample enters and one sample leaves the box). The array is lengthened with a tail
+* decaying by 1% per sample (starting from the last sample) to not have fake results for the last boxLength windows. Since the output
+* overwrites the input, the sample leaving the box is kept before overwriting it.
+*
+* lpf_boxcar_differentiate_array function: As 'lpf_boxcar_array' followed by 'differentiate_array', without storing the filtered array.
+*
+* Parameters:
+* - scaleFactor: Scale factor
+* - sampleRate: Sampling frequency (samples per second)
+* - x: Input/Output array
+* - n: Number of samples of 'x'
+* - boxLength: Length of the box-car (1<=boxLength<n)
+******************************************************************************/
+int lpf_boxcar_length(double scaleFactor, int sampleRate)
+{
+	double cutFreq = 2 * (1/(2*pi*scaleFactor));	//According to Jan, sinc(f1)=0.6 where f1=1/(2pi*scaleFactor)
+							//sinc(0.5)~0.6 => f1~0.5
+							//sinc(fc)=0, sinc(1)=0 => fc=1
+							//fc=kf1 => fc~2f1
+	int boxLength =(int) ((1/cutFreq) * sampleRate);
+
+	if (boxLength < 1)		boxLength = 1;
+
+	return(boxLength);
+}
+
+// Next sample of the tail lengthening the record in 'lpf_boxcar'
+static inline double lpf_boxcar_tail(double value)
+{
+	if (value > 0) 		value = value-0.01*value;
+	else if (value< 0)	value = value+0.01*value;
+
+	return(value);
+}
+
+void lpf_boxcar_array(double *x, int n, int boxLength)
+{
+	double boxSum = 0.0;
+	for (int i=0;i<boxLength;i++)
+	{
+		boxSum = boxSum + x[i];
+	}
+
+	double tail = x[n-1];	// Last sample of the lengthened record
+	double out = x[0];	// Sample leaving the box
+	x[0] = boxSum/boxLength;
+
+	int i;
+	for (i=0;i<n-boxLength;i++)
+	{
+		boxSum = boxSum - out + x[i+boxLength];
+		out = x[i+1];
+		x[i+1] = boxSum/boxLength;
+	}
+	for (;i<n-1;i++)
+	{
+		tail = lpf_boxcar_tail(tail);
+		boxSum = boxSum - out + tail;
+		out = x[i+1];
+		x[i+1] = boxSum/boxLength;
+	}
+}
+
+void lpf_boxcar_differentiate_array(double *x, int n, int boxLength)
+{
+	double boxSum = 0.0;
+	for (int i=0;i<boxLength;i++)
+	{
+		boxSum = boxSum + x[i];
+	}
+
+	double tail = x[n-1];			// Last sample of the lengthened record
+	double filtered = boxSum/boxLength;	// i-th filtered sample
+
+	int i;
+	for (i=0;i<n-boxLength;i++)
+	{
+		boxSum = boxSum - x[i] + x[i+boxLength];
+		double next = boxSum/boxLength;
+		x[i] = next-filtered;
+		filtered = next;
+	}
+	for (;i<n-1;i++)
+	{
+		tail = lpf_boxcar_tail(tail);
+		boxSum = boxSum - x[i] + tail;
+		double next = boxSum/boxLength;
+		x[i] = next-filtered;
+		filtered = next;
+	}
+	x[n-1] = x[n-2];
+}
+/*xxxx end of SECTION 22 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
+
+
+/***** SECTION 23 ************************************************************
+* differentiate_array function: This function applies the derivative method (x_i-x_(i-1)) to an array (in place). The last sample
+*                               is set to the previous derivative value.
+*
+* Parameters:
+* - x: Input/Output array
+* - n: Number of samples of 'x' (at least 2)
+******************************************************************************/
+void differentiate_array(double *x, int n)
+{
+	if (n < 2)	return;
+
+	for (int i=0; i<n-1; i++)
+	{
+		x[i] = x[i+1]-x[i];
+	}
+	x[n-1] = x[n-2];
+}
+/*xxxx end of SECTION 23 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
+
+
+/***** SECTION 24 ************************************************************
+* findMeanSigma_array function: This function calculates the mean and the standard deviation of an array
+*
+* If any element is greater than 1e10, both are set to 1e10 (to avoid an inf in IO or a NAN in JUPITER).
+*
+* Parameters:
+* - x: Input array
+* - n: Number of elements of 'x'
+* - mean: Mean of the elements of 'x'
+* - sigma: Standard deviation of the elements of 'x'
+******************************************************************************/
+void findMeanSigma_array(const double *x, int n, double *mean, double *sigma)
+{
+	for (int i=0;i<n;i++)
+	{
+		if (x[i]>1e10)
+		{
+			*mean = 1e10;
+			*sigma = 1e10;
+			return;
+		}
+	}
+
+	double sum = 0.0;
+	for (int i=0;i<n;i++)
+	{
+		sum = sum + x[i];
+	}
+	*mean = sum/n;
+
+	double suma = 0.0;
+	for (int i=0;i<n;i++)
+	{
+		double diff = x[i]-*mean;
+		suma = suma + diff*diff;
+	}
+	*sigma = sqrt(suma/(n-1));
+}
+/*xxxx end of SECTION 24 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
+
+
+/***** SECTION 25 ************************************************************
+* median_array function: This function calculates the median of an array by selection (without sorting the whole array)
+*
+* The element in the middle is placed with 'std::nth_element'. If the number of elements is even, the other middle element is
+* the maximum of the lower part.
+*
+* Parameters:
+* - x: Input array (its elements are reordered)
+* - n: Number of elements of 'x'
+******************************************************************************/
+double median_array(double *x, int n)
+{
+	std::nth_element(x,x+n/2,x+n);
+	double median = x[n/2];
+	if (n%2 == 0)	//Even
+	{
+		median = (*std::max_element(x,x+n/2)+median)/2;
+	}
+
+	return(median);
+}
+/*xxxx end of SECTION 25 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
+
+
+/***** SECTION 26 ************************************************************
+* smoothDerivative_array function: This function applies the smooth derivative to an array (in place)
+*
+* The output is the convolution with a box-car of length N whose first half is -1 and second half +1 (samples before the start of the 
+* array are 0). The window is summed in the same order as originally in 'smoothDerivative' (from the current sample backwards), so the 
+* result is bit-identical to it. The original values of the last N samples are kept in a circular buffer, since the output overwrites 
+* the input.
+*
+* Parameters:
+* - x: Input/Output array
+* - n: Number of samples of 'x'
+* - N: Box-car length (it must be an even number)
+******************************************************************************/
+void smoothDerivative_array(double *x, int n, int N)
+{
+	int half = N/2;
+	std::vector<double> last(N,0.0);	// last[k%N] = x[k]
+
+	for (int i=0;i<n;i++)
+	{
+		last[i%N] = x[i];
+
+		// x[i]+...+x[i-half+1]-x[i-half]-...-x[i-N+1]
+		int kmax = std::min(i+1,N);
+		int j = i%N;
+		double conv = 0.0;
+		int k = 0;
+		for (;k<std::min(kmax,half);k++)
+		{
+			conv = conv+last[j];
+			j = (j == 0) ? N-1 : j-1;
+		}
+		for (;k<kmax;k++)
+		{
+			conv = conv-last[j];
+			j = (j == 0) ? N-1 : j-1;
+		}
+		x[i] = conv;
+	}
+}
+/*xxxx end of SECTION 26 xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/
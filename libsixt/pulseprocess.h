@@ -42,11 +42,13 @@
 	#include <inoututils.h>
 
 	#include <integraSIRENA.h>
+	#include <pulsekernels.h>
 	
 	#include <iomanip>      // std::setprecision
 
 	int lpf_boxcar (gsl_vector **invector, int szVct, double scaleFactor, int sampleRate);
 	int differentiate (gsl_vector **invector,int szVct);
+	int lpf_boxcar_differentiate (gsl_vector **invector, int szVct, double scaleFactor, int sampleRate);
 
 	int findMeanSigma (gsl_vector *invector, double *mean, double *sigma);
 	int medianKappaClipping (gsl_vector *invector, double kappa, double stopCriteria, double nSigmas, int boxLPF,double *threshold);
@@ -59,6 +61,8 @@
 	int find_model_maxDERs(double maxDER, ReconstructInitSIRENA *reconstruct_init, gsl_vector **modelFound);
 	int find_model_samp1DERs(double samp1DER, ReconstructInitSIRENA *reconstruct_init, gsl_vector **modelFound);
 	int interpolate_model(gsl_vector **modelFound, double ph_model, gsl_vector *modelIn1, double ph_modelIn1, gsl_vector *modelIn2, double ph_modelIn2);
+	long find_library_row(gsl_vector *params, long nummodels, double p, int firstEqual);
+	int checkLibraryOrder(gsl_vector *params, long nummodels, const char *name);
 
 	int findPulsesCAL
 	(
@@ -21,6 +21,43 @@
 #include "radec2xylib.h"
 
 
+// Report a failed conversion of world coordinates (in [deg]).
+static void radec2xy_error( const double* const world, struct wcsprm* const wcs,
+                            const int wcsstatus, int* const status ) {
+    char msg[MAXMSG];
+    sprintf(msg,
+            "WCS coordinate conversion failed (RA=%lf, Dec=%lf, error code %d)",
+            world[0], world[1], wcsstatus);
+
+    char *projection, *wcstype;
+    wcstype = strdup(wcs->ctype[0]);
+    if( wcstype != NULL ) {
+        while ((projection = strsep(&wcstype, "-")) != NULL);
+        if (projection != NULL && strcmp(projection, "AIT") != 0) {
+            char tmpmsg[MAXMSG];
+            sprintf(tmpmsg, "\n(---> You might want to consider the AIT projection type "
+                            "instead of %s)", projection);
+            strcat(msg, tmpmsg);
+        }
+    }
+    SIXT_ERROR(msg);
+    *status = EXIT_FAILURE;
+}
+
+// Image position of the pixel coordinates.
+static ImgPos radec2xy_pixel( const double* const pixcrd ) {
+    ImgPos pos;
+    pos.x = (long) pixcrd[0];
+    if (pixcrd[0] < 0.){
+        pos.x--;
+    }
+    pos.y = (long) pixcrd[1];
+    if (pixcrd[1] < 0.){
+        pos.y--;
+    }
+    return pos;
+}
+
 // Convert world coordinates to image coordinates X and Y.
 ImgPos radec2xy( Event* const event, struct wcsprm* const wcs, int* const status ) {
 
@@ -29,42 +66,16 @@ ImgPos radec2xy( Event* const event, struct wcsprm* const wcs, int* const status
             event->dec * 180. / M_PI
     };
 
-    ImgPos pos;
     double imgcrd[2], pixcrd[2];
     double phi, theta;
     int wcsstatus = 0;
 
     wcss2p(wcs, 1, 2, world, &phi, &theta, imgcrd, pixcrd, &wcsstatus);
     if (0 != wcsstatus) {
-        char msg[MAXMSG];
-        sprintf(msg,
-                "WCS coordinate conversion failed (RA=%lf, Dec=%lf, error code %d)",
-                world[0], world[1], wcsstatus);
-
-        char *projection, *wcstype;
-        wcstype = strdup(wcs->ctype[0]);
-        if( wcstype != NULL ) {
-            while ((projection = strsep(&wcstype, "-")) != NULL);
-            if (projection != NULL && strcmp(projection, "AIT") != 0) {
-                char tmpmsg[MAXMSG];
-                sprintf(tmpmsg, "\n(---> You might want to consider the AIT projection type "
-                                "instead of %s)", projection);
-                strcat(msg, tmpmsg);
-            }
-        }
-        SIXT_ERROR(msg);
-        *status = EXIT_FAILURE;
+        radec2xy_error(world, wcs, wcsstatus, status);
     }
 
-    pos.x = (long) pixcrd[0];
-    if (pixcrd[0] < 0.){
-        pos.x--;
-    }
-    pos.y = (long) pixcrd[1];
-    if (pixcrd[1] < 0.){
-        pos.y--;
-    }
-    return pos;
+    return radec2xy_pixel(pixcrd);
 }
 
 // WCS data structure used for projection.
@@ -105,19 +116,82 @@ struct wcsprm getRadec2xyWCS( float* RefRA, float* RefDec, char* Projection, int
 }
 
 
-void addXY2eventfile(EventFile* const evtfile, float* RefRA, float* RefDec, char* Projection, int* const status) {
+/** Data of the EventTransform adding the X and Y columns. */
+typedef struct {
+    struct wcsprm wcs;
+
+    /** Buffers for the conversion of a block of events. */
+    double *world, *imgcrd, *pixcrd, *phi, *theta;
+    int* stat;
+    long *x, *y;
+} Radec2xyTransform;
+
+static void freeRadec2xyTransform(void* const data) {
+    Radec2xyTransform* t = (Radec2xyTransform*) data;
+    wcsfree(&t->wcs);
+    free(t->world);
+    free(t->imgcrd);
+    free(t->pixcrd);
+    free(t->phi);
+    free(t->theta);
+    free(t->stat);
+    free(t->x);
+    free(t->y);
+    free(t);
+}
 
-    headas_chat(3, "add XY coordinates to event file ...\n");
+// Convert the coordinates of a block of events with a single call
+// of wcss2p and write them to the X and Y columns.
+static void radec2xy_transform_events(EventFile* const file, const long firstrow,
+                                      Event* const events, const long nevents,
+                                      void* const data, int* const status) {
+    Radec2xyTransform* t = (Radec2xyTransform*) data;
+
+    long ii;
+    for (ii = 0; ii < nevents; ii++) {
+        t->world[2*ii] = events[ii].ra * 180. / M_PI;
+        t->world[2*ii+1] = events[ii].dec * 180. / M_PI;
+    }
+    wcss2p(&t->wcs, (int)nevents, 2, t->world, t->phi, t->theta,
+           t->imgcrd, t->pixcrd, t->stat);
+
+    // Events after a failed conversion are not written.
+    long n;
+    for (n = 0; n < nevents; n++) {
+        if (0 != t->stat[n]) {
+            radec2xy_error(&t->world[2*n], &t->wcs, t->stat[n], status);
+            break;
+        }
+        ImgPos pos = radec2xy_pixel(&t->pixcrd[2*n]);
+        t->x[n] = pos.x;
+        t->y[n] = pos.y;
+    }
+
+    // The column numbers are determined for each block, as columns
+    // might have been inserted by other transforms in the meantime.
+    int fitsstatus = EXIT_SUCCESS;
+    int cx, cy;
+    fits_get_colnum(file->fptr, CASEINSEN, "X", &cx, &fitsstatus);
+    fits_get_colnum(file->fptr, CASEINSEN, "Y", &cy, &fitsstatus);
+    fits_write_col(file->fptr, TLONG, cx, firstrow, 1, n, t->x, &fitsstatus);
+    fits_write_col(file->fptr, TLONG, cy, firstrow, 1, n, t->y, &fitsstatus);
+    if (EXIT_SUCCESS != fitsstatus) {
+        *status = fitsstatus;
+    }
+}
+
+
+EventTransform* newRadec2xyTransform(EventFile* const evtfile, float* RefRA, float* RefDec, char* Projection, int* const status) {
 
     // Check if the input file contains recombined event patterns.
     fits_movnam_hdu(evtfile->fptr, BINARY_TBL, "EVENTS", 0, status);
-    CHECK_STATUS_VOID(*status);
+    CHECK_STATUS_RET(*status, NULL);
 
     char evtype[MAXMSG], comment[MAXMSG];
     fits_read_key(evtfile->fptr, TSTRING, "EVTYPE", evtype, comment, status);
     if (EXIT_SUCCESS != *status) {
         SIXT_ERROR("could not read FITS keyword 'EVTYPE'");
-        return;
+        return NULL;
     }
     strtoupper(evtype);
     if (0 != strcmp(evtype, "PATTERN")) {
@@ -125,112 +199,131 @@ void addXY2eventfile(EventFile* const evtfile, float* RefRA, float* RefDec, char
         char msg[MAXMSG];
         sprintf(msg, "event type of input file is '%s' (must be 'PATTERN')", evtype);
         SIXT_ERROR(msg);
-        return;
+        return NULL;
     }
 
     // Determine WCS
-    struct wcsprm wcs = getRadec2xyWCS(RefRA, RefDec, Projection, status);
-    CHECK_STATUS_VOID(*status)
+    Radec2xyTransform* data = (Radec2xyTransform*) calloc(1, sizeof(Radec2xyTransform));
+    CHECK_MALLOC_RET_NULL_STATUS(data, *status);
+    data->wcs = getRadec2xyWCS(RefRA, RefDec, Projection, status);
+    EventTransform* transform = newEventTransform(radec2xy_transform_events,
+            freeRadec2xyTransform, data, EVENTCOL_RA | EVENTCOL_DEC, 0, status);
+    if (NULL == transform) {
+        freeRadec2xyTransform(data);
+        return NULL;
+    }
+    CHECK_STATUS_RET(*status, transform);
+    struct wcsprm* const wcs = &data->wcs;
+
+    // Memory for the conversion of a block of events.
+    const long n = EVENTTRANSFORM_BLOCKSIZE;
+    data->world = (double*) malloc(2 * n * sizeof(double));
+    data->imgcrd = (double*) malloc(2 * n * sizeof(double));
+    data->pixcrd = (double*) malloc(2 * n * sizeof(double));
+    data->phi = (double*) malloc(n * sizeof(double));
+    data->theta = (double*) malloc(n * sizeof(double));
+    data->stat = (int*) malloc(n * sizeof(int));
+    data->x = (long*) malloc(n * sizeof(long));
+    data->y = (long*) malloc(n * sizeof(long));
+    if (NULL == data->world || NULL == data->imgcrd || NULL == data->pixcrd ||
+        NULL == data->phi || NULL == data->theta || NULL == data->stat ||
+        NULL == data->x || NULL == data->y) {
+        SIXT_ERROR("memory allocation failed");
+        *status = EXIT_FAILURE;
+        return transform;
+    }
 
     // Add 'X', 'Y' column to evtfile if necessary
-    int cx;
+    int cx, cy;
     fits_get_colnum(evtfile->fptr, CASEINSEN, "X", &cx, status);
     if( *status == COL_NOT_FOUND ){
         fits_clear_errmsg();
         *status=EXIT_SUCCESS;
         cx = evtfile->cra + 1;
         addCol2EventFile(evtfile, &cx, "X", "J", "", status);
-        CHECK_STATUS_VOID(*status);
+        CHECK_STATUS_RET(*status, transform);
     }
 
-    int cy;
     fits_get_colnum(evtfile->fptr, CASEINSEN, "Y", &cy, status);
     if( *status == COL_NOT_FOUND ){
         fits_clear_errmsg();
         *status=EXIT_SUCCESS;
         cy = evtfile->cra + 2;
         addCol2EventFile(evtfile, &cy, "Y", "J", "", status);
-        CHECK_STATUS_VOID(*status);
+        CHECK_STATUS_RET(*status, transform);
     }
 
     // Update the WCS keywords in the output file.
     char keyword[MAXMSG];
     sprintf(keyword, "TCTYP%d", cx);
-    fits_update_key(evtfile->fptr, TSTRING, keyword, wcs.ctype[0],
+    fits_update_key(evtfile->fptr, TSTRING, keyword, wcs->ctype[0],
                     "projection type", status);
     sprintf(keyword, "TCTYP%d", cy);
-    fits_update_key(evtfile->fptr, TSTRING, keyword, wcs.ctype[1],
+    fits_update_key(evtfile->fptr, TSTRING, keyword, wcs->ctype[1],
                     "projection type", status);
     sprintf(keyword, "TCRVL%d", cx);
-    fits_update_key(evtfile->fptr, TDOUBLE, keyword, &wcs.crval[0],
+    fits_update_key(evtfile->fptr, TDOUBLE, keyword, &wcs->crval[0],
                     "reference value", status);
     sprintf(keyword, "TCRVL%d", cy);
-    fits_update_key(evtfile->fptr, TDOUBLE, keyword, &wcs.crval[1],
+    fits_update_key(evtfile->fptr, TDOUBLE, keyword, &wcs->crval[1],
                     "reference value", status);
     sprintf(keyword, "TCRPX%d", cx);
-    fits_update_key(evtfile->fptr, TFLOAT, keyword, &wcs.crpix[0],
+    fits_update_key(evtfile->fptr, TFLOAT, keyword, &wcs->crpix[0],
                     "reference point", status);
     sprintf(keyword, "TCRPX%d", cy);
-    fits_update_key(evtfile->fptr, TFLOAT, keyword, &wcs.crpix[1],
+    fits_update_key(evtfile->fptr, TFLOAT, keyword, &wcs->crpix[1],
                     "reference point", status);
     sprintf(keyword, "TCDLT%d", cx);
-    fits_update_key(evtfile->fptr, TDOUBLE, keyword, &wcs.cdelt[0],
+    fits_update_key(evtfile->fptr, TDOUBLE, keyword, &wcs->cdelt[0],
                     "pixel increment", status);
     sprintf(keyword, "TCDLT%d", cy);
-    fits_update_key(evtfile->fptr, TDOUBLE, keyword, &wcs.cdelt[1],
+    fits_update_key(evtfile->fptr, TDOUBLE, keyword, &wcs->cdelt[1],
                     "pixel increment", status);
     sprintf(keyword, "TCUNI%d", cx);
-    fits_update_key(evtfile->fptr, TSTRING, keyword, wcs.cunit[0],
+    fits_update_key(evtfile->fptr, TSTRING, keyword, wcs->cunit[0],
                     "axis units", status);
     sprintf(keyword, "TCUNI%d", cy);
-    fits_update_key(evtfile->fptr, TSTRING, keyword, wcs.cunit[1],
+    fits_update_key(evtfile->fptr, TSTRING, keyword, wcs->cunit[1],
                     "axis units",status);
-    CHECK_STATUS_VOID(*status);
+    CHECK_STATUS_RET(*status, transform);
 
-    fits_update_key(evtfile->fptr, TSTRING, "REFXCTYP", wcs.ctype[0],
+    fits_update_key(evtfile->fptr, TSTRING, "REFXCTYP", wcs->ctype[0],
                     "projection type", status);
-    fits_update_key(evtfile->fptr, TSTRING, "REFYCTYP", wcs.ctype[1],
+    fits_update_key(evtfile->fptr, TSTRING, "REFYCTYP", wcs->ctype[1],
                     "projection type", status);
-    fits_update_key(evtfile->fptr, TSTRING, "REFXCUNI", wcs.cunit[0],
+    fits_update_key(evtfile->fptr, TSTRING, "REFXCUNI", wcs->cunit[0],
                     "axis units", status);
-    fits_update_key(evtfile->fptr, TSTRING, "REFYCUNI", wcs.cunit[1],
+    fits_update_key(evtfile->fptr, TSTRING, "REFYCUNI", wcs->cunit[1],
                     "axis units", status);
-    fits_update_key(evtfile->fptr, TFLOAT, "REFXCRPX", &wcs.crpix[0],
+    fits_update_key(evtfile->fptr, TFLOAT, "REFXCRPX", &wcs->crpix[0],
                     "reference value", status);
-    fits_update_key(evtfile->fptr, TFLOAT, "REFYCRPX", &wcs.crpix[1],
+    fits_update_key(evtfile->fptr, TFLOAT, "REFYCRPX", &wcs->crpix[1],
                     "reference value", status);
-    fits_update_key(evtfile->fptr, TDOUBLE, "REFXCRVL", &wcs.crval[0],
+    fits_update_key(evtfile->fptr, TDOUBLE, "REFXCRVL", &wcs->crval[0],
                     "reference value", status);
-    fits_update_key(evtfile->fptr, TDOUBLE, "REFYCRVL", &wcs.crval[1],
+    fits_update_key(evtfile->fptr, TDOUBLE, "REFYCRVL", &wcs->crval[1],
                     "reference value", status);
-    fits_update_key(evtfile->fptr, TDOUBLE, "REFXCDLT", &wcs.cdelt[0],
+    fits_update_key(evtfile->fptr, TDOUBLE, "REFXCDLT", &wcs->cdelt[0],
                     "pixel increment", status);
-    fits_update_key(evtfile->fptr, TDOUBLE, "REFYCDLT", &wcs.cdelt[1],
+    fits_update_key(evtfile->fptr, TDOUBLE, "REFYCDLT", &wcs->cdelt[1],
                     "pixel increment", status);
-    CHECK_STATUS_VOID(*status);
+    CHECK_STATUS_RET(*status, transform);
 
+    return transform;
+}
 
-    // Loop over all events in the input list.
-    Event* event = getEvent(status);
-    CHECK_STATUS_VOID(*status);
-    long ii;
-    for (ii = 1; ii <= evtfile->nrows; ii++) {
-        // Get event
-        getEventFromFile(evtfile, (int)ii, event, status);
-        CHECK_STATUS_BREAK(*status);
 
-        ImgPos pos = radec2xy( event, &wcs, status );
-        CHECK_STATUS_BREAK(*status);
+void addXY2eventfile(EventFile* const evtfile, float* RefRA, float* RefDec, char* Projection, int* const status) {
 
-        // Save changes to eventfile
-        fits_write_col(evtfile->fptr, TLONG, cx, ii, 1, 1, &pos.x, status);
-        fits_write_col(evtfile->fptr, TLONG, cy, ii, 1, 1, &pos.y, status);
-        CHECK_STATUS_BREAK(*status);
+    headas_chat(3, "add XY coordinates to event file ...\n");
 
+    EventTransform* transform = newRadec2xyTransform(evtfile, RefRA, RefDec, Projection, status);
+    if (*status == EXIT_SUCCESS) {
+        // Loop over all events in the input list.
+        runEventTransforms(evtfile, &transform, 1, status);
     }
     // Release memory.
-    freeEvent(&event);
-    wcsfree(&wcs);
+    freeEventTransform(&transform);
 
     if (*status == EXIT_SUCCESS) {
         headas_chat(3, " ... adding X, Y coordinates successful!\n");
@@ -240,4 +333,4 @@ void addXY2eventfile(EventFile* const evtfile, float* RefRA, float* RefDec, char
         SIXT_ERROR(msg);
         *status = EXIT_FAILURE;
     }
-}
\ No newline at end of file
+}
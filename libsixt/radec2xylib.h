@@ -26,6 +26,7 @@
 #include "event.h"
 #include "wcs.h"
 #include "eventfile.h"
+#include "eventtransform.h"
 
 ////////////////////////////////////////////////////////////////////////
 // Type declarations.
@@ -47,6 +48,12 @@ ImgPos radec2xy( Event* const event, struct wcsprm* const wcs, int* const status
 
 struct wcsprm getRadec2xyWCS( float* RefRA, float* RefDec, char* Projection, int* const status );
 
+/** Prepare the conversion of the RA and Dec values of the events in
+    an event file (check the event type, add the X and Y columns and
+    the WCS header keywords) and return it as EventTransform, which
+    converts the events of a block with a single call of wcss2p. */
+EventTransform* newRadec2xyTransform(EventFile* const evtfile, float* RefRA, float* RefDec, char* Projection, int* const status);
+
 void addXY2eventfile(EventFile* const evtfile, float* RefRA, float* RefDec, char* Projection, int* const status);
 
 #endif /* RADEC2XY_H */
@@ -34,6 +34,11 @@ unsigned int SIXT_RNG_INITIALIZED = 0;
 
 int USE_PSEUDO_RNG = 0;
 
+/** Seed of the random number generator and number of random numbers
+    drawn since its initialization. */
+static unsigned int rng_seed=0;
+static unsigned long long rng_ndraws=0;
+
 unsigned int sixt_rng_is_initialized() {
 	return SIXT_RNG_INITIALIZED;
 }
@@ -87,6 +92,7 @@ static double sixt_std_random_number(int* const status){
 
 
 double sixt_get_random_number(int* const status){
+	rng_ndraws++;
 	return random_number_generator(status);
 }
 
@@ -106,6 +112,8 @@ void sixt_init_rng(const unsigned int seed, int* const status) {
 		return;
 	}
 
+	rng_seed=seed;
+	rng_ndraws=0;
 
 	if(getenv("SIXTE_USE_PSEUDO_RNG")!=NULL) {
 		USE_PSEUDO_RNG = 1;
@@ -162,6 +170,67 @@ void sixt_destroy_rng()
 }
 
 
+void sixt_get_rng_state(SixtRngState* const state, int* const status)
+{
+	if (SIXT_RNG_INITIALIZED==0) {
+		SIXT_ERROR("random number generator is not initialized");
+		*status=EXIT_FAILURE;
+		return;
+	}
+
+	state->pseudo=USE_PSEUDO_RNG;
+	state->seed=rng_seed;
+	state->ndraws=rng_ndraws;
+	if (1==USE_PSEUDO_RNG) {
+		get_genrand_state(state->mt, &state->mti);
+	} else {
+		memset(state->mt, 0, sizeof(state->mt));
+		state->mti=0;
+	}
+}
+
+
+void sixt_set_rng_state(const SixtRngState* const state, int* const status)
+{
+	if (SIXT_RNG_INITIALIZED==0) {
+		SIXT_ERROR("random number generator is not initialized");
+		*status=EXIT_FAILURE;
+		return;
+	}
+	if ((state->pseudo!=USE_PSEUDO_RNG)||(state->seed!=rng_seed)) {
+		SIXT_ERROR("random number generator state belongs to a different "
+				"generator or seed");
+		*status=EXIT_FAILURE;
+		return;
+	}
+
+	if (1==USE_PSEUDO_RNG) {
+		set_genrand_state(state->mt, state->mti);
+		rng_ndraws=state->ndraws;
+		return;
+	}
+
+#ifdef USE_RCL
+	SIXT_ERROR("the state of the RCL random number generator cannot be restored");
+	*status=EXIT_FAILURE;
+#else
+	// The state of the HEAdas generator is not accessible. The random
+	// numbers drawn before the state are generated again, starting
+	// from the initialization if the generator is already beyond it.
+	if (rng_ndraws>state->ndraws) {
+		HDmtFree();
+		HDmtInit(rng_seed);
+		rng_ndraws=0;
+	}
+	headas_chat(3, "advance random number generator by %llu numbers ...\n",
+		    state->ndraws-rng_ndraws);
+	for (; rng_ndraws<state->ndraws; rng_ndraws++) {
+		HDmtDrand();
+	}
+#endif
+}
+
+
 void sixt_get_gauss_random_numbers(double* const x,
 				   double* const y,
 				   int* const status)
@@ -189,3 +258,52 @@ double rndexp(const double avgdist, int* const status)
   return(-log(rand)*avgdist);
 }
 
+
+
+long rndpoisson(const double mean, int* const status)
+{
+  assert(mean>=0.);
+
+  if (mean<10.) {
+    // Multiplication of uniform random numbers.
+    const double limit=exp(-mean);
+    double prod=sixt_get_random_number(status);
+    CHECK_STATUS_RET(*status, 0);
+    long n=0;
+    while (prod>=limit) {
+      n++;
+      prod*=sixt_get_random_number(status);
+      CHECK_STATUS_RET(*status, 0);
+    }
+    return(n);
+  }
+
+  // Transformed rejection with squeeze (PTRS) according to
+  // Hoermann (1993), Insurance: Mathematics and Economics 12, 39.
+  const double slam=sqrt(mean);
+  const double loglam=log(mean);
+  const double b=0.931+2.53*slam;
+  const double a=-0.059+0.02483*b;
+  const double invalpha=1.1239+1.1328/(b-3.4);
+  const double vr=0.9277-3.6224/(b-2.);
+
+  while (1) {
+    double u=sixt_get_random_number(status)-0.5;
+    double v=sixt_get_random_number(status);
+    CHECK_STATUS_RET(*status, 0);
+    double us=0.5-fabs(u);
+    if (us<=0.) {
+      continue;
+    }
+    long k=(long)floor((2.*a/us+b)*u+mean+0.43);
+    if ((us>=0.07)&&(v<=vr)) {
+      return(k);
+    }
+    if ((k<0)||((us<0.013)&&(v>us))) {
+      continue;
+    }
+    if (log(v)+log(invalpha)-log(a/(us*us)+b)<=-mean+k*loglam-lgamma(k+1.)) {
+      return(k);
+    }
+  }
+}
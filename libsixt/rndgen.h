@@ -31,6 +31,33 @@
 #endif
 
 
+/** Size of the state vector of the pseudo random number generator
+    (MT19937). */
+#define SIXT_RNG_STATESIZE (624)
+
+
+/** State of the random number generator. The pseudo random number
+    generator used for testing (SIXTE_USE_PSEUDO_RNG) is described by
+    its state vector. The state of the HEAdas generator is not
+    accessible. It is given by the seed and the number of random
+    numbers drawn since the initialization. */
+typedef struct {
+  /** Flag whether the pseudo random number generator is used. */
+  int pseudo;
+
+  /** Seed used for the initialization. */
+  unsigned int seed;
+
+  /** Number of random numbers drawn since the initialization. */
+  unsigned long long ndraws;
+
+  /** State vector and current position of the pseudo random number
+      generator. */
+  unsigned long mt[SIXT_RNG_STATESIZE];
+  int mti;
+} SixtRngState;
+
+
 /** Return value of SIXT_RNG_INITIALIZED. */
 unsigned int sixt_rng_is_initialized();
 
@@ -59,6 +86,16 @@ void sixt_init_rng(const unsigned int seed, int* const status);
 /** Clean up the random number generator. */
 void sixt_destroy_rng();
 
+/** Get the current state of the random number generator. */
+void sixt_get_rng_state(SixtRngState* const state, int* const status);
+
+/** Restore a state obtained with sixt_get_rng_state(). The generator
+    must have been initialized with the same seed before. For the
+    HEAdas generator, the random numbers drawn before the state are
+    generated again, which takes a few ns per number (some 10 s for
+    10^10 numbers). */
+void sixt_set_rng_state(const SixtRngState* const state, int* const status);
+
 /** This routine produces two Gaussian distributed random numbers. The
     standard deviation of the Gaussian distribution sigma is assumed
     to be unity. The two numbers are returned via the pointer function
@@ -73,5 +110,10 @@ void sixt_get_gauss_random_numbers(double* const x,
     photons from a source. The photons have Poisson statistics. */
 double rndexp(const double avg, int* const status);
 
+/** Returns a random number from a Poisson distribution with the given
+    mean. It is used to determine the number of photons, which a
+    source with constant flux emits within a time interval. */
+long rndpoisson(const double mean, int* const status);
+
 
 #endif /* RNDGEN_H */
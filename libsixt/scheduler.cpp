@@ -5,6 +5,7 @@
 
 #include "threadsafe_queue.h"
 #include "tasksSIRENA.h"
+#include "profiling.h"
 
 std::mutex end_workers_mut;
 std::mutex end_eworkers_mut;
@@ -34,11 +35,14 @@ void detection_worker()
     sirena_data* data;
     if(detection_queue.wait_and_pop(data)){
       //log_trace("Extracting detection data from queue...");
+      SIXT_PROF_BEGIN(SIXT_PROF_SIRENA_DETECT);
       th_runDetect(data->rec, data->trig_reclength,
                 data->last_record,
                 data->all_pulses,
                 &(data->rec_init),
                 &(data->record_pulses));
+      SIXT_PROF_END(SIXT_PROF_SIRENA_DETECT);
+      SIXT_PROF_COUNT(SIXT_PROF_PULSES, data->record_pulses->ndetpulses);
       detected_queue.push(data);
       std::unique_lock<std::mutex> lk(records_detected_mut);
       ++records_detected;
@@ -61,11 +65,13 @@ void energy_worker()
     if(energy_queue.wait_and_pop(data)){
       //log_trace("Extracting energy data from queue...");
       //log_debug("Energy data in record %i",data->n_record);
+      SIXT_PROF_BEGIN(SIXT_PROF_SIRENA_ENERGY);
       th_runEnergy(data->rec, data->trig_reclength,
                    &(data->rec_init),
                    &(data->record_pulses),
                    //&(data->optimal_filter));
                    &(data->optimal_filter),data->all_pulses);
+      SIXT_PROF_END(SIXT_PROF_SIRENA_ENERGY);
       end_queue.push(data);
       std::unique_lock<std::mutex> lk(records_energy_mut);
       ++records_energy;
@@ -88,11 +94,13 @@ void energy_worker_v2()
     if(detected_queue.wait_and_pop(data)){
       //log_trace("Extracting energy data from queue...");
       //log_debug("Energy data in record %i",data->n_record);
+      SIXT_PROF_BEGIN(SIXT_PROF_SIRENA_ENERGY);
       th_runEnergy(data->rec, data->trig_reclength,
                    &(data->rec_init),
                    &(data->record_pulses),
                    //&(data->optimal_filter);
                    &(data->optimal_filter),data->all_pulses);
+      SIXT_PROF_END(SIXT_PROF_SIRENA_ENERGY);
       end_queue.push(data);
       std::unique_lock<std::mutex> lk(records_energy_mut);
       ++records_energy;
@@ -57,6 +57,25 @@ unsigned int getSeed(int seed)
 }
 
 
+unsigned int getShardSeed(const unsigned int seed, const int shard)
+{
+  if (0==shard) {
+    return(seed);
+  }
+
+  // Scramble the shard index such that the seeds of different shards
+  // do not coincide with the consecutive seeds used for the individual
+  // sub-instruments of a shard.
+  unsigned int hash=(unsigned int)shard*0x9e3779b9u;
+  hash^=hash>>16;
+  hash*=0x85ebca6bu;
+  hash^=hash>>13;
+  hash*=0xc2b2ae35u;
+  hash^=hash>>16;
+  return(seed^hash);
+}
+
+
 void strtoupper(char* const string)
 {
   int count=0;
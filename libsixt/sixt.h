@@ -226,6 +226,11 @@ unsigned long microtime();
 /** Return a seed for the random number generator. */
 unsigned int getSeed(int seed);
 
+/** Derive the seed for the random number generator of an individual
+    shard of a run that is split into several independent processes.
+    Shard 0 uses the original seed. */
+unsigned int getShardSeed(const unsigned int seed, const int shard);
+
 
 /** Convert a squence of chars into captial letters. The sequence has
     to be terminated by a '\0' mark. */
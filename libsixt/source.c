@@ -35,6 +35,8 @@ Source* newSource(int* const status)
   src->dec          =0.;
   src->extension    =0.;
   src->row          =0;
+  src->energies     =NULL;
+  src->rate         =0.;
 
   return(src);
 }
@@ -52,8 +54,63 @@ void freeSource(Source** const src)
 }
 
 
+/** Create the photons of a source with energy table in the interval
+    from the end of the previously simulated time to t1. */
+static LinkedPhoListElement* getConstSourcePhotons(Source* const src,
+						   const SimputSrc* const simputsrc,
+						   const double t0,
+						   const double t1,
+						   int* const status)
+{
+  LinkedPhoListElement* list=NULL;
+  LinkedPhoListElement** list_next=&list;
+
+  double start=MAX(t0, *(src->t_next_photon));
+  if (t1<=start) return(list);
+
+  Photon* photons=NULL;
+  long nphotons=0, size=0;
+  genConstSourcePhotons(src->energies, src->rate,
+			simputsrc->ra, simputsrc->dec, simputsrc->src_id, start, t1,
+			&photons, &nphotons, &size, status);
+  *(src->t_next_photon)=t1;
+
+  // Convert the buffer into a linked list.
+  long ii;
+  for (ii=0; (ii<nphotons)&&(EXIT_SUCCESS==*status); ii++) {
+    *list_next=newLinkedPhoListElement(status);
+    CHECK_STATUS_BREAK(*status);
+    (*list_next)->photon=photons[ii];
+    list_next=&((*list_next)->next);
+  }
+
+  if (NULL!=photons) free(photons);
+  return(list);
+}
+
+
+/** Set the energy table and photon rate of a point source with
+    constant flux and spectrum. */
+static void setupConstSource(Source* const src,
+			     SimputCtlg* const simputcat,
+			     SimputSrc* const simputsrc,
+			     PhotonEnergyTables* const energies,
+			     const double time,
+			     const double mjdref,
+			     int* const status)
+{
+  char specref[MAXFILENAME];
+  getSimputSrcSpecRef(simputcat, simputsrc, time, mjdref, specref, status);
+  CHECK_STATUS_VOID(*status);
+  src->energies=getPhotonEnergyTable(energies, simputcat, specref, status);
+  CHECK_STATUS_VOID(*status);
+  src->rate=getSimputPhotonRate(simputcat, simputsrc, time, mjdref, status);
+}
+
+
 LinkedPhoListElement* getXRayPhotons(Source* const src,
 				     SimputCtlg* const simputcat,
+				     PhotonEnergyTables* const energies,
 				     const double t0, const double t1,
 				     const double mjdref,
 				     int* const status)
@@ -74,12 +131,25 @@ LinkedPhoListElement* getXRayPhotons(Source* const src,
     CHECK_NULL(src->t_next_photon, *status,
 	       "memory allocation for 't_next_photon' (double) failed");
 
+    // Point sources with constant flux and spectrum do not need the
+    // SIMPUT library for each photon.
+    if ((NULL!=energies)&&(src->extension<=0.)&&
+	(isConstSimputSrc(simputsrc))) {
+      setupConstSource(src, simputcat, simputsrc, energies, t0, mjdref, status);
+      CHECK_STATUS_RET(*status, list);
+      *(src->t_next_photon)=t0;
+      return(getConstSourcePhotons(src, simputsrc, t0, t1, status));
+    }
+
     int failed=
       getSimputPhotonTime(simputcat, simputsrc, t0, mjdref,
 			  src->t_next_photon, status);
     CHECK_STATUS_RET(*status, list);
     if (1==failed) return(list);
 
+  } else if (NULL!=src->energies) {
+    return(getConstSourcePhotons(src, simputsrc, t0, t1, status));
+
   } else if (*(src->t_next_photon) < t0) {
     int failed=
       getSimputPhotonTime(simputcat, simputsrc, t0, mjdref,
@@ -128,6 +198,36 @@ LinkedPhoListElement* getXRayPhotons(Source* const src,
 }
 
 
+void restoreSource(Source* const src,
+		   SimputCtlg* const simputcat,
+		   PhotonEnergyTables* const energies,
+		   const double t_next_photon,
+		   const int isconst,
+		   const double mjdref,
+		   int* const status)
+{
+  if (NULL==src->t_next_photon) {
+    src->t_next_photon=(double*)malloc(sizeof(double));
+    CHECK_NULL_VOID(src->t_next_photon, *status,
+		    "memory allocation for 't_next_photon' (double) failed");
+  }
+  *(src->t_next_photon)=t_next_photon;
+
+  if (0!=isconst) {
+    if (NULL==energies) {
+      SIXT_ERROR("energy tables are required to restore a source with "
+		 "constant flux and spectrum");
+      *status=EXIT_FAILURE;
+      return;
+    }
+    SimputSrc* simputsrc=getSimputSrc(simputcat, src->row, status);
+    CHECK_STATUS_VOID(*status);
+    setupConstSource(src, simputcat, simputsrc, energies,
+		     t_next_photon, mjdref, status);
+  }
+}
+
+
 static long SourcesPartition(Source* const list,
 			     const long left, const long right,
 			     const long pivotIndex, const int axis)
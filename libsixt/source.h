@@ -25,6 +25,7 @@
 
 #include "sixt.h"
 
+#include "constsource.h"
 #include "linkedpholist.h"
 #include "photon.h"
 #include "simput.h"
@@ -48,9 +49,20 @@ typedef struct {
       at line 1. */
   long row;
 
-  /** Time of the emission of the last photon. */
+  /** Time of the emission of the last photon. For sources with an
+      energy table, the end of the time interval, for which photons
+      have already been created. NULL until the first photons are
+      requested. */
   double* t_next_photon;
 
+  /** Energy distribution of the photons of a point source with
+      constant flux and spectrum (shared with other sources). NULL, if
+      the photons are created by the SIMPUT library. */
+  const PhotonEnergyTable* energies;
+
+  /** Photon rate [photons/s] of a source with energy table. */
+  double rate;
+
 } Source;
 
 
@@ -66,14 +78,29 @@ Source* newSource(int* const status);
 void freeSource(Source** const src);
 
 /** Create photons for a particular source in the specified time
-    interval. */
+    interval. Point sources with constant flux and spectrum are
+    simulated in bulk with an energy table obtained from 'energies'
+    (if not NULL). All other sources use the SIMPUT library for each
+    photon. */
 LinkedPhoListElement* getXRayPhotons(Source* const src,
 				     SimputCtlg* const simput,
+				     PhotonEnergyTables* const energies,
 				     const double t0,
 				     const double t1,
 				     const double mjdref,
 				     int* const status);
 
+/** Restore the state of a source from a simulation checkpoint: the
+    time of the next photon and, for point sources with constant flux
+    and spectrum (isconst!=0), the energy table and photon rate. */
+void restoreSource(Source* const src,
+		   SimputCtlg* const simputcat,
+		   PhotonEnergyTables* const energies,
+		   const double t_next_photon,
+		   const int isconst,
+		   const double mjdref,
+		   int* const status);
+
 /** Sort the list of Source objects with the specified number of
     entries with respect to the requested coordinate axis using a
     quick sort algorithm. */
@@ -22,6 +22,9 @@
 
 #include "sourcecatalog.h"
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 
 SourceCatalog* newSourceCatalog(int* const status)
 {
@@ -34,6 +37,14 @@ SourceCatalog* newSourceCatalog(int* const status)
   cat->extsources =NULL;
   cat->nextsources=0;
   cat->simput     =NULL;
+  cat->energies   =NULL;
+
+  // Energy tables are added for the sources with constant flux and
+  // spectrum, when their first photons are requested. Without tables
+  // all photons are obtained from the SIMPUT library.
+  if (0!=useConstSourcePhotons()) {
+    cat->energies=newPhotonEnergyTables(status);
+  }
   return(cat);
 }
 
@@ -49,6 +60,8 @@ void freeSourceCatalog(SourceCatalog** const cat, int* const status)
     if (NULL!=(*cat)->extsources) {
       free((*cat)->extsources);
     }
+    // Free the energy tables.
+    freePhotonEnergyTables(&((*cat)->energies));
     // Free the SIMPUT source catalog.
     if (NULL!=(*cat)->simput) {
       freeSimputCtlg(&((*cat)->simput), status);
@@ -59,6 +72,619 @@ void freeSourceCatalog(SourceCatalog** const cat, int* const status)
 }
 
 
+/** Conversion factor from the unit of an angle in the SIMPUT catalog
+    to [rad]. */
+static double getSimputAngleUnit(fitsfile* const fptr,
+				 const int colnum,
+				 int* const status)
+{
+  char keyword[MAXMSG], unit[MAXMSG]="";
+  sprintf(keyword, "TUNIT%d", colnum);
+  fits_read_key(fptr, TSTRING, keyword, unit, NULL, status);
+  CHECK_STATUS_RET(*status, 0.);
+
+  if (0==strcmp(unit, "deg")) {
+    return(M_PI/180.);
+  } else if (0==strcmp(unit, "rad")) {
+    return(1.);
+  } else if (0==strcmp(unit, "arcmin")) {
+    return(M_PI/180./60.);
+  } else if (0==strcmp(unit, "arcsec")) {
+    return(M_PI/180./3600.);
+  }
+
+  char msg[MAXMSG];
+  sprintf(msg, "unknown unit '%s' of column %d in source catalog",
+	  unit, colnum);
+  SIXT_ERROR(msg);
+  *status=EXIT_FAILURE;
+  return(0.);
+}
+
+
+/** Append a Source object to an array, which is enlarged if
+    necessary. */
+static void appendSource(Source** const list,
+			 long* const nelements,
+			 long* const size,
+			 const Source* const src,
+			 int* const status)
+{
+  if (*nelements>=*size) {
+    long newsize=MAX(1024, 2*(*size));
+    Source* newlist=(Source*)realloc(*list, newsize*sizeof(Source));
+    CHECK_NULL_VOID(newlist, *status,
+		    "memory allocation for source list failed");
+    *list=newlist;
+    *size=newsize;
+  }
+  (*list)[(*nelements)++]=*src;
+}
+
+
+/** Read the positions of all sources from the SIMPUT catalog in a
+    single pass. The RA, DEC, and IMAGE columns are read in blocks
+    directly from the catalog table. Sources without image are
+    point-like. Their positions are converted to [rad] in double
+    precision and can therefore differ from the values of the SIMPUT
+    library, which may apply the conversion factor in single
+    precision, by a relative amount of up to 1e-7. They are only used
+    to select the sources in the field of view, while the photon
+    directions are still obtained from the SIMPUT library. Only for
+    sources with an image, the routines of the SIMPUT library are
+    used to determine the extension and the position of the image
+    center. The point-like sources are stored in
+    'list', which must be large enough for all entries of the catalog,
+    and the extended sources in cat->extsources. */
+static void readSourcePositions(SourceCatalog* const cat,
+				fitsfile* const fptr,
+				Source* const list,
+				long* const npointlike,
+				int* const status)
+{
+  double* ra=NULL;
+  double* dec=NULL;
+  char** image=NULL;
+  long extsize=0;
+
+  *npointlike=0;
+  cat->nextsources=0;
+
+  do { // Error handling loop.
+
+    int cra, cdec, cimage;
+    fits_get_colnum(fptr, CASEINSEN, "RA", &cra, status);
+    fits_get_colnum(fptr, CASEINSEN, "DEC", &cdec, status);
+    fits_get_colnum(fptr, CASEINSEN, "IMAGE", &cimage, status);
+    CHECK_STATUS_BREAK(*status);
+    const double ra_unit=getSimputAngleUnit(fptr, cra, status);
+    const double dec_unit=getSimputAngleUnit(fptr, cdec, status);
+    CHECK_STATUS_BREAK(*status);
+
+    int typecode;
+    long repeat, width;
+    fits_get_coltype(fptr, cimage, &typecode, &repeat, &width, status);
+    CHECK_STATUS_BREAK(*status);
+
+    // Number of rows read at once.
+    long nbuffer;
+    fits_get_rowsize(fptr, &nbuffer, status);
+    CHECK_STATUS_BREAK(*status);
+    nbuffer=MAX(nbuffer, 1024);
+
+    ra=(double*)malloc(nbuffer*sizeof(double));
+    dec=(double*)malloc(nbuffer*sizeof(double));
+    image=(char**)malloc(nbuffer*sizeof(char*));
+    CHECK_NULL_BREAK(image, *status, "memory allocation for buffer failed");
+    image[0]=(char*)malloc(nbuffer*(repeat+1)*sizeof(char));
+    if ((NULL==ra)||(NULL==dec)||(NULL==image[0])) {
+      SIXT_ERROR("memory allocation for buffer failed");
+      *status=EXIT_FAILURE;
+      break;
+    }
+    long ii;
+    for (ii=1; ii<nbuffer; ii++) {
+      image[ii]=image[0]+ii*(repeat+1);
+    }
+
+    // Empty template object.
+    Source templatesrc={ .ra=0., .dec=0., .extension=0., .row=0,
+			 .t_next_photon=NULL, .energies=NULL, .rate=0. };
+
+    long firstrow;
+    for (firstrow=1; firstrow<=cat->simput->nentries; firstrow+=nbuffer) {
+      long nrows=MIN(nbuffer, cat->simput->nentries-firstrow+1);
+      int anynul=0;
+      fits_read_col(fptr, TDOUBLE, cra, firstrow, 1, nrows, NULL, ra,
+		    &anynul, status);
+      fits_read_col(fptr, TDOUBLE, cdec, firstrow, 1, nrows, NULL, dec,
+		    &anynul, status);
+      fits_read_col(fptr, TSTRING, cimage, firstrow, 1, nrows, "", image,
+		    &anynul, status);
+      CHECK_STATUS_BREAK(*status);
+
+      for (ii=0; ii<nrows; ii++) {
+	const long row=firstrow+ii;
+
+	if (isSimputNullRef(image[ii])) {
+	  // This is a point-like source.
+	  Source* src=&list[(*npointlike)++];
+	  *src=templatesrc;
+	  src->row=row;
+	  src->ra =ra[ii]*ra_unit;
+	  src->dec=dec[ii]*dec_unit;
+	  continue;
+	}
+
+	// The source has an image.
+	SimputSrc* simputsrc=getSimputSrc(cat->simput, row, status);
+	CHECK_STATUS_BREAK(*status);
+
+	double ra_center_img=0.0;
+	double dec_center_img=0.0;
+	float extension=getSimputSrcExt(cat->simput, simputsrc,
+					&ra_center_img, &dec_center_img,
+					0., 0., status);
+	CHECK_STATUS_BREAK(*status);
+
+	if (extension>0.) {
+	  // This is an extended source.
+	  Source src=templatesrc;
+	  // We need the center pixels here of the image, as this is
+	  // what the extensions refers to.
+	  src.ra  =ra_center_img;
+	  src.dec =dec_center_img;
+	  src.row =row;
+	  src.extension=extension;
+	  appendSource(&cat->extsources, &cat->nextsources, &extsize,
+		       &src, status);
+	  CHECK_STATUS_BREAK(*status);
+	} else {
+	  // This is a point-like source.
+	  Source* src=&list[(*npointlike)++];
+	  *src=templatesrc;
+	  src->ra =simputsrc->ra;
+	  src->dec=simputsrc->dec;
+	  src->row=row;
+	}
+      }
+      CHECK_STATUS_BREAK(*status);
+    }
+    CHECK_STATUS_BREAK(*status);
+
+  } while(0); // END of error handling loop.
+
+  if (NULL!=ra) free(ra);
+  if (NULL!=dec) free(dec);
+  if (NULL!=image) {
+    if (NULL!=image[0]) free(image[0]);
+    free(image);
+  }
+}
+
+
+/** Name of the file, in which the KDTree of the catalog is cached.
+    The cache is only used, if the environment variable
+    SIXTE_SRCCAT_CACHE is set (and not "0"). The file is located next
+    to the catalog. Returns 0 if the cache is not used. */
+static int getSourceCatalogCacheName(const char* const filename,
+				     char* const cachefile)
+{
+  const char* env=getenv("SIXTE_SRCCAT_CACHE");
+  if ((NULL==env)||('\0'==env[0])||(0==strcmp(env, "0"))) {
+    return(0);
+  }
+
+  // Remove extended file name syntax.
+  char name[MAXFILENAME];
+  strncpy(name, filename, MAXFILENAME-1);
+  name[MAXFILENAME-1]='\0';
+  char* bracket=strchr(name, '[');
+  if (NULL!=bracket) *bracket='\0';
+  if (strlen(name)+8>=MAXFILENAME) {
+    return(0);
+  }
+  sprintf(cachefile, "%s.kdtree", name);
+  return(1);
+}
+
+
+/** Add the name, the modification time, and the size of a file to
+    the hash value (FNV-1a). Returns 0 if the file cannot be
+    accessed. */
+static int hashFileState(const char* const name,
+			 unsigned long long* const hash)
+{
+  struct stat st;
+  if (0!=stat(name, &st)) {
+    return(0);
+  }
+
+  long long state[2]={ (long long)st.st_mtime, (long long)st.st_size };
+  const unsigned char* bytes[2]={ (const unsigned char*)name,
+				  (const unsigned char*)state };
+  size_t nbytes[2]={ strlen(name), sizeof(state) };
+  int ii;
+  for (ii=0; ii<2; ii++) {
+    size_t jj;
+    for (jj=0; jj<nbytes[ii]; jj++) {
+      *hash^=bytes[ii][jj];
+      *hash*=1099511628211ULL;
+    }
+  }
+  return(1);
+}
+
+
+/** Key identifying the catalog, to which the cache belongs. It
+    consists of the data checksum of the SRC_CAT table, and a hash of
+    the modification times and sizes of the catalog file and of all
+    files with images referenced in the IMAGE column, as the extended
+    sources depend on them. The current HDU of 'fptr' must be the
+    catalog table. Returns 0, if one of the files cannot be accessed
+    and the cache should not be used. */
+static int getSourceCatalogCacheKey(fitsfile* const fptr,
+				    const char* const filename,
+				    const long nentries,
+				    char* const key,
+				    int* const status)
+{
+  unsigned long datasum, hdusum;
+  fits_get_chksum(fptr, &datasum, &hdusum, status);
+  CHECK_STATUS_RET(*status, 0);
+
+  // The catalog file (without extended file name syntax) and its
+  // directory, relative to which the images are referenced.
+  char catfile[MAXFILENAME];
+  strncpy(catfile, filename, MAXFILENAME-1);
+  catfile[MAXFILENAME-1]='\0';
+  char* bracket=strchr(catfile, '[');
+  if (NULL!=bracket) *bracket='\0';
+  size_t dirlen=0;
+  char* slash=strrchr(catfile, '/');
+  if (NULL!=slash) dirlen=slash-catfile+1;
+
+  unsigned long long hash=14695981039346656037ULL;
+  int valid=hashFileState(catfile, &hash);
+
+  // Distinct files referenced in the IMAGE column (sorted).
+  char** files=NULL;
+  long nfiles=0, filesize=0;
+  char** image=NULL;
+
+  do { // Error handling loop.
+    if (0==valid) break;
+
+    int cimage, typecode;
+    long repeat, width;
+    fits_get_colnum(fptr, CASEINSEN, "IMAGE", &cimage, status);
+    fits_get_coltype(fptr, cimage, &typecode, &repeat, &width, status);
+    CHECK_STATUS_BREAK(*status);
+
+    const long nbuffer=1024;
+    image=(char**)malloc(nbuffer*sizeof(char*));
+    CHECK_NULL_BREAK(image, *status, "memory allocation for buffer failed");
+    image[0]=(char*)malloc(nbuffer*(repeat+1)*sizeof(char));
+    CHECK_NULL_BREAK(image[0], *status, "memory allocation for buffer failed");
+    long ii;
+    for (ii=1; ii<nbuffer; ii++) {
+      image[ii]=image[0]+ii*(repeat+1);
+    }
+
+    long firstrow;
+    for (firstrow=1; (firstrow<=nentries)&&(0!=valid); firstrow+=nbuffer) {
+      long nrows=MIN(nbuffer, nentries-firstrow+1);
+      int anynul=0;
+      fits_read_col(fptr, TSTRING, cimage, firstrow, 1, nrows, "", image,
+		    &anynul, status);
+      CHECK_STATUS_BREAK(*status);
+
+      for (ii=0; ii<nrows; ii++) {
+	if (isSimputNullRef(image[ii])) continue;
+
+	// File part of the reference. References to HDUs in the
+	// catalog file itself are covered by the catalog.
+	bracket=strchr(image[ii], '[');
+	if (NULL!=bracket) *bracket='\0';
+	if ('\0'==image[ii][0]) continue;
+
+	char name[MAXFILENAME];
+	if ('/'==image[ii][0]) {
+	  if (strlen(image[ii])>=MAXFILENAME) {
+	    valid=0;
+	    break;
+	  }
+	  strcpy(name, image[ii]);
+	} else {
+	  if (dirlen+strlen(image[ii])>=MAXFILENAME) {
+	    valid=0;
+	    break;
+	  }
+	  strncpy(name, catfile, dirlen);
+	  strcpy(name+dirlen, image[ii]);
+	}
+
+	// Position of the file in the sorted list.
+	long lo=0, hi=nfiles;
+	while (lo<hi) {
+	  long mid=(lo+hi)/2;
+	  if (strcmp(files[mid], name)<0) {
+	    lo=mid+1;
+	  } else {
+	    hi=mid;
+	  }
+	}
+	if ((lo<nfiles)&&(0==strcmp(files[lo], name))) continue;
+
+	if (nfiles==filesize) {
+	  filesize=MAX(16, 2*filesize);
+	  char** tmp=(char**)realloc(files, filesize*sizeof(char*));
+	  CHECK_NULL_BREAK(tmp, *status, "memory allocation for file list failed");
+	  files=tmp;
+	}
+	char* copy=strdup(name);
+	CHECK_NULL_BREAK(copy, *status, "memory allocation for file list failed");
+	memmove(files+lo+1, files+lo, (nfiles-lo)*sizeof(char*));
+	files[lo]=copy;
+	nfiles++;
+      }
+      CHECK_STATUS_BREAK(*status);
+    }
+    CHECK_STATUS_BREAK(*status);
+
+    for (ii=0; (ii<nfiles)&&(0!=valid); ii++) {
+      valid=hashFileState(files[ii], &hash);
+    }
+  } while(0); // END of error handling loop.
+
+  if (NULL!=image) {
+    if (NULL!=image[0]) free(image[0]);
+    free(image);
+  }
+  if (NULL!=files) {
+    long ii;
+    for (ii=0; ii<nfiles; ii++) {
+      free(files[ii]);
+    }
+    free(files);
+  }
+  CHECK_STATUS_RET(*status, 0);
+
+  if (0==valid) {
+    headas_chat(3, "source catalog cache not used, as not all image files "
+		"can be accessed\n");
+    return(0);
+  }
+  sprintf(key, "%lu-%016llx", datasum, hash);
+  return(1);
+}
+
+
+/** Number of rows of the cache file tables processed at once. */
+#define SOURCECATALOG_CACHE_ROWS (100000)
+
+/** Write an array of Source objects to a new table in the cache
+    file. */
+static void saveSourceCacheTable(fitsfile* const fptr,
+				 char* const extname,
+				 const char* const catsum,
+				 const long nentries,
+				 const Source* const list,
+				 const long nelements,
+				 int* const status)
+{
+  char* ttype[]={"RA", "DEC", "ROW", "EXTENSION"};
+  char* tform[]={"D", "D", "K", "E"};
+  char* tunit[]={"rad", "rad", "", "rad"};
+  fits_create_tbl(fptr, BINARY_TBL, 0, 4, ttype, tform, tunit,
+		  extname, status);
+  fits_update_key(fptr, TSTRING, "CATSUM", (char*)catsum,
+		  "data checksum of the source catalog", status);
+  long n=nentries;
+  fits_update_key(fptr, TLONG, "NENTRIES", &n,
+		  "number of entries in the source catalog", status);
+  CHECK_STATUS_VOID(*status);
+
+  double* ra=(double*)malloc(SOURCECATALOG_CACHE_ROWS*sizeof(double));
+  double* dec=(double*)malloc(SOURCECATALOG_CACHE_ROWS*sizeof(double));
+  LONGLONG* row=(LONGLONG*)malloc(SOURCECATALOG_CACHE_ROWS*sizeof(LONGLONG));
+  float* extension=(float*)malloc(SOURCECATALOG_CACHE_ROWS*sizeof(float));
+  if ((NULL==ra)||(NULL==dec)||(NULL==row)||(NULL==extension)) {
+    SIXT_ERROR("memory allocation for buffer failed");
+    *status=EXIT_FAILURE;
+  }
+
+  long first;
+  for (first=0; (first<nelements)&&(EXIT_SUCCESS==*status);
+       first+=SOURCECATALOG_CACHE_ROWS) {
+    long nrows=MIN(SOURCECATALOG_CACHE_ROWS, nelements-first);
+    long ii;
+    for (ii=0; ii<nrows; ii++) {
+      ra[ii]=list[first+ii].ra;
+      dec[ii]=list[first+ii].dec;
+      row[ii]=list[first+ii].row;
+      extension[ii]=list[first+ii].extension;
+    }
+    fits_write_col(fptr, TDOUBLE, 1, first+1, 1, nrows, ra, status);
+    fits_write_col(fptr, TDOUBLE, 2, first+1, 1, nrows, dec, status);
+    fits_write_col(fptr, TLONGLONG, 3, first+1, 1, nrows, row, status);
+    fits_write_col(fptr, TFLOAT, 4, first+1, 1, nrows, extension, status);
+  }
+
+  if (NULL!=ra) free(ra);
+  if (NULL!=dec) free(dec);
+  if (NULL!=row) free(row);
+  if (NULL!=extension) free(extension);
+}
+
+
+/** Read an array of Source objects from a table in the cache
+    file. Returns NULL if the table does not belong to the catalog
+    with the given checksum. */
+static Source* loadSourceCacheTable(fitsfile* const fptr,
+				    char* const extname,
+				    const char* const catsum,
+				    const long nentries,
+				    long* const nelements,
+				    int* const status)
+{
+  fits_movnam_hdu(fptr, BINARY_TBL, extname, 0, status);
+  char sum[MAXMSG];
+  long n;
+  fits_read_key(fptr, TSTRING, "CATSUM", sum, NULL, status);
+  fits_read_key(fptr, TLONG, "NENTRIES", &n, NULL, status);
+  fits_get_num_rows(fptr, nelements, status);
+  CHECK_STATUS_RET(*status, NULL);
+  if ((0!=strcmp(sum, catsum))||(n!=nentries)) {
+    return(NULL);
+  }
+
+  Source* list=(Source*)malloc(MAX(*nelements, 1)*sizeof(Source));
+  double* ra=(double*)malloc(SOURCECATALOG_CACHE_ROWS*sizeof(double));
+  double* dec=(double*)malloc(SOURCECATALOG_CACHE_ROWS*sizeof(double));
+  LONGLONG* row=(LONGLONG*)malloc(SOURCECATALOG_CACHE_ROWS*sizeof(LONGLONG));
+  float* extension=(float*)malloc(SOURCECATALOG_CACHE_ROWS*sizeof(float));
+  if ((NULL==list)||(NULL==ra)||(NULL==dec)||(NULL==row)||(NULL==extension)) {
+    SIXT_ERROR("memory allocation for source list failed");
+    *status=EXIT_FAILURE;
+  }
+
+  long first;
+  for (first=0; (first<*nelements)&&(EXIT_SUCCESS==*status);
+       first+=SOURCECATALOG_CACHE_ROWS) {
+    long nrows=MIN(SOURCECATALOG_CACHE_ROWS, *nelements-first);
+    int anynul=0;
+    fits_read_col(fptr, TDOUBLE, 1, first+1, 1, nrows, NULL, ra,
+		  &anynul, status);
+    fits_read_col(fptr, TDOUBLE, 2, first+1, 1, nrows, NULL, dec,
+		  &anynul, status);
+    fits_read_col(fptr, TLONGLONG, 3, first+1, 1, nrows, NULL, row,
+		  &anynul, status);
+    fits_read_col(fptr, TFLOAT, 4, first+1, 1, nrows, NULL, extension,
+		  &anynul, status);
+    CHECK_STATUS_BREAK(*status);
+    long ii;
+    for (ii=0; ii<nrows; ii++) {
+      list[first+ii].ra =ra[ii];
+      list[first+ii].dec=dec[ii];
+      list[first+ii].row=(long)row[ii];
+      list[first+ii].extension=extension[ii];
+      list[first+ii].t_next_photon=NULL;
+      list[first+ii].energies=NULL;
+      list[first+ii].rate=0.;
+    }
+  }
+
+  if (NULL!=ra) free(ra);
+  if (NULL!=dec) free(dec);
+  if (NULL!=row) free(row);
+  if (NULL!=extension) free(extension);
+  if ((EXIT_SUCCESS!=*status)&&(NULL!=list)) {
+    free(list);
+    list=NULL;
+  }
+  return(list);
+}
+
+
+/** Store the point-like sources in the order of the KDTree (as left
+    by buildKDTree2()) and the extended sources in the cache file. The
+    file is written under a temporary name and renamed afterwards,
+    such that other processes never read an incomplete file. Errors
+    are only reported as warnings. */
+static void saveSourceCatalogCache(const SourceCatalog* const cat,
+				   const char* const cachefile,
+				   const char* const catsum,
+				   const Source* const list,
+				   const long npointlike)
+{
+  int status=EXIT_SUCCESS;
+  char tmpfile[MAXFILENAME];
+  if (strlen(cachefile)+16>=MAXFILENAME) return;
+  sprintf(tmpfile, "%s.%ld", cachefile, (long)getpid());
+  remove(tmpfile);
+
+  fitsfile* fptr=NULL;
+  fits_create_file(&fptr, tmpfile, &status);
+  if (EXIT_SUCCESS==status) {
+    saveSourceCacheTable(fptr, "POINTSRC", catsum, cat->simput->nentries,
+			 list, npointlike, &status);
+    saveSourceCacheTable(fptr, "EXTSRC", catsum, cat->simput->nentries,
+			 cat->extsources, cat->nextsources, &status);
+    int status2=EXIT_SUCCESS;
+    fits_close_file(fptr, &status2);
+    if (EXIT_SUCCESS==status) status=status2;
+  }
+
+  if ((EXIT_SUCCESS!=status)||(0!=rename(tmpfile, cachefile))) {
+    remove(tmpfile);
+    char msg[MAXMSG];
+    sprintf(msg, "could not store source catalog cache '%s'", cachefile);
+    SIXT_WARNING(msg);
+    fits_clear_errmsg();
+  } else {
+    headas_chat(3, "stored source catalog cache '%s'\n", cachefile);
+  }
+}
+
+
+/** Load the KDTree and the extended sources from the cache
+    file. Returns 1 on success and 0 if there is no valid cache for
+    the catalog. */
+static int loadSourceCatalogCache(SourceCatalog* const cat,
+				  const char* const cachefile,
+				  const char* const catsum,
+				  int* const status)
+{
+  int exists=0, loaded=0, status2=EXIT_SUCCESS;
+  fits_file_exists(cachefile, &exists, &status2);
+  if ((EXIT_SUCCESS!=status2)||(1!=exists)) {
+    fits_clear_errmsg();
+    return(0);
+  }
+
+  fitsfile* fptr=NULL;
+  Source* list=NULL;
+  long npointlike=0, nextended=0;
+  fits_open_file(&fptr, cachefile, READONLY, &status2);
+  if (EXIT_SUCCESS==status2) {
+    list=loadSourceCacheTable(fptr, "POINTSRC", catsum, cat->simput->nentries,
+			      &npointlike, &status2);
+    if (NULL!=list) {
+      cat->extsources=loadSourceCacheTable(fptr, "EXTSRC", catsum,
+					   cat->simput->nentries,
+					   &nextended, &status2);
+    }
+    int status3=EXIT_SUCCESS;
+    fits_close_file(fptr, &status3);
+  }
+
+  if ((EXIT_SUCCESS==status2)&&(NULL!=list)&&(NULL!=cat->extsources)) {
+    cat->nextsources=nextended;
+    cat->tree=restoreKDTree(list, npointlike, status);
+    loaded=(EXIT_SUCCESS==*status);
+    if (loaded) {
+      headas_chat(3, "loaded %ld sources from cache '%s'\n",
+		  npointlike+nextended, cachefile);
+    }
+  } else {
+    if (NULL!=cat->extsources) {
+      free(cat->extsources);
+      cat->extsources=NULL;
+    }
+    if (EXIT_SUCCESS!=status2) {
+      char msg[MAXMSG];
+      sprintf(msg, "could not read source catalog cache '%s'", cachefile);
+      SIXT_WARNING(msg);
+      fits_clear_errmsg();
+    }
+  }
+
+  if (NULL!=list) free(list);
+  return(loaded);
+}
+
+
 SourceCatalog* loadSourceCatalog(const char* const filename,
 				 struct ARF* const arf,
 				 int* const status)
@@ -79,91 +705,66 @@ SourceCatalog* loadSourceCatalog(const char* const filename,
   // Set reference to ARF for SIMPUT library.
   setSimputARF(cat->simput, arf);
 
-  // Determine the number of point-like and the number of
-  // extended sources.
-  unsigned long nextended =0;
-  unsigned long npointlike=0;
-  long ii;
-
-  double ra_center_img=0.0;
-  double dec_center_img=0.0;
+  // Open the catalog table once more for reading the source positions
+  // column-wise.
+  fitsfile* fptr=NULL;
+  fits_open_file(&fptr, filename, READONLY, status);
+  CHECK_STATUS_RET(*status, cat);
 
-  for (ii=0; ii<cat->simput->nentries; ii++) {
-    // Get the source.
-    SimputSrc* src=getSimputSrc(cat->simput, ii+1, status);
+  // Check if the KDTree is available from the cache.
+  char cachefile[MAXFILENAME];
+  char catsum[MAXMSG]="";
+  int loaded=0;
+  int usecache=0;
+  do { // Error handling loop.
+    fits_movnam_hdu(fptr, BINARY_TBL, "SRC_CAT", 0, status);
     CHECK_STATUS_BREAK(*status);
 
-    // Determine whether the source is extended
-    int is_extended=isSimputSrcExtended(cat->simput, src, 0., 0., status);
-    CHECK_STATUS_BREAK(*status);
-    if (is_extended) {
-      // This is an extended source.
-      nextended++;
-    } else {
-      // This is a point-like source.
-      npointlike++;
+    usecache=getSourceCatalogCacheName(filename, cachefile);
+    if (0!=usecache) {
+      usecache=getSourceCatalogCacheKey(fptr, filename,
+					cat->simput->nentries, catsum, status);
+      CHECK_STATUS_BREAK(*status);
+    }
+    if (0!=usecache) {
+      loaded=loadSourceCatalogCache(cat, cachefile, catsum, status);
+      CHECK_STATUS_BREAK(*status);
     }
+  } while(0); // END of error handling loop.
+  if (EXIT_SUCCESS!=*status) {
+    int status2=EXIT_SUCCESS;
+    fits_close_file(fptr, &status2);
+    return(cat);
   }
-  CHECK_STATUS_RET(*status, cat);
-
-  // Allocate memory for an array of the point-like sources,
-  // which will be converted into a KDTree afterwards.
-  Source* list=(Source*)malloc(npointlike*sizeof(Source));
-  CHECK_NULL_RET(list, *status,
-		 "memory allocation for source list failed", cat);
-
-  // Allocate memory for the array of the extended sources.
-  cat->extsources=(Source*)malloc(nextended*sizeof(Source));
-  CHECK_NULL_RET(list, *status,
-		 "memory allocation for source list failed", cat);
-
-  // Empty template object.
-  Source* templatesrc=newSource(status);
-  CHECK_STATUS_RET(*status, cat);
-
-  // Loop over all entries in the SIMPUT source catalog.
-  unsigned long cpointlike=0;
-  cat->nextsources=0;
-  for (ii=0; ii<cat->simput->nentries; ii++) {
-    // Get the source.
-    SimputSrc* src=getSimputSrc(cat->simput, ii+1, status);
-    CHECK_STATUS_BREAK(*status);
-
-    float extension=getSimputSrcExt(cat->simput, src, &ra_center_img, &dec_center_img, 0., 0., status);
-    CHECK_STATUS_BREAK(*status);
 
-    if (extension>0.) {
-      // This is an extended source.
-      cat->nextsources++;
-      // Start with an empty Source object for this entry.
-      cat->extsources[cat->nextsources-1] = *templatesrc;
-      // Set the properties from the SIMPUT catalog (position, extension, and row number in the catalog).
-
-      // we need the center pixels here of the image, as this is what the extensions refers to)
-      cat->extsources[cat->nextsources-1].ra  = ra_center_img;
-      cat->extsources[cat->nextsources-1].dec = dec_center_img;
-      cat->extsources[cat->nextsources-1].row = ii+1;
-      cat->extsources[cat->nextsources-1].extension = extension;
+  if (0==loaded) {
+    // Allocate memory for an array of the point-like sources,
+    // which will be converted into a KDTree afterwards.
+    Source* list=(Source*)malloc(MAX(cat->simput->nentries, 1)*sizeof(Source));
+    CHECK_NULL_RET(list, *status,
+		   "memory allocation for source list failed", cat);
+
+    long npointlike=0;
+    readSourcePositions(cat, fptr, list, &npointlike, status);
+    if (EXIT_SUCCESS!=*status) {
+      free(list);
+      int status2=EXIT_SUCCESS;
+      fits_close_file(fptr, &status2);
+      return(cat);
+    }
 
-    } else {
-      // This is a point-like source.
-      cpointlike++;
-      list[cpointlike-1]     = *templatesrc;
-      list[cpointlike-1].ra  = src->ra;
-      list[cpointlike-1].dec = src->dec;
-      list[cpointlike-1].row = ii+1;
+    // Build a KDTree from the source list (array of Source objects).
+    cat->tree=buildKDTree2(list, npointlike, 0, status);
+    if ((EXIT_SUCCESS==*status)&&(0!=usecache)) {
+      saveSourceCatalogCache(cat, cachefile, catsum, list, npointlike);
     }
+    free(list);
+    CHECK_STATUS_RET(*status, cat);
   }
-  CHECK_STATUS_RET(*status, cat);
-  // END of loop over all entries in the FITS table.
 
-  // Build a KDTree from the source list (array of Source objects).
-  cat->tree=buildKDTree2(list, npointlike, 0, status);
+  fits_close_file(fptr, status);
   CHECK_STATUS_RET(*status, cat);
 
-  // In a later development stage this could be directly stored in
-  // a memory-mapped space.
-
   // Load spectra into the internal cache used by the SIMPUT library.
   // This works only if all spectra are contained as mission-independent
   // spectra in a single binary-table FITS file HDU, which can be found
@@ -186,10 +787,6 @@ SourceCatalog* loadSourceCatalog(const char* const filename,
     CHECK_STATUS_RET(*status, cat);
   }
 
-  // Release memory.
-  if (templatesrc) free(templatesrc);
-  if (list) free(list);
-
   return(cat);
 }
 
@@ -213,7 +810,7 @@ LinkedPhoListElement* genFoVXRayPhotons(SourceCatalog* const cat,
   // The kdTree only contains point-like sources.
   LinkedPhoListElement* list=
     KDTreeRangeSearch(cat->tree, 0, pointing, close_fov_min_align,
-		      t0, t1, mjdref, cat->simput, status);
+		      t0, t1, mjdref, cat->simput, cat->energies, status);
 
   // Loop over all extended sources.
   long ii;
@@ -230,7 +827,7 @@ LinkedPhoListElement* genFoVXRayPhotons(SourceCatalog* const cat,
 
 		  // Generate photons for this particular source.
 		  LinkedPhoListElement* newlist=
-				  getXRayPhotons(&(cat->extsources[ii]), cat->simput,
+				  getXRayPhotons(&(cat->extsources[ii]), cat->simput, NULL,
 						  t0, t1, mjdref, status);
 		  CHECK_STATUS_RET(*status, list);
 
@@ -52,6 +52,10 @@ typedef struct {
   /** SIMPUT source catalog containing all relevant data. */
   SimputCtlg* simput;
 
+  /** Energy tables of the point sources with constant flux and
+      spectrum (NULL if not used, see useConstSourcePhotons()). */
+  PhotonEnergyTables* energies;
+
 } SourceCatalog;
 
 
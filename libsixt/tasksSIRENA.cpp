@@ -1932,11 +1932,11 @@ int filderLibrary(ReconstructInitSIRENA** reconstruct_init, double samprate)
 		{
 			gsl_vector_memcpy(model, (*reconstruct_init)->library_collection->pulse_templates[i].ptemplate);
 
-			// PULSE TEMPLATE: Low-pass filtering
-			status = lpf_boxcar(&model,model->size,scaleFactor,samprate);
+			// PULSE TEMPLATE: Low-pass filtering and derivative after filtering (in a single pass)
+			status = lpf_boxcar_differentiate(&model,model->size,scaleFactor,samprate);
 			if (status == 1)
 			{
-				message = "Cannot run routine lpf_boxcar for low-pass filtering";
+				message = "Cannot run routine lpf_boxcar_differentiate for low-pass filtering and differentiating";
 				EP_PRINT_ERROR(message,status); return(EPFAIL);
 			}
 			if (status == 3)
@@ -1948,13 +1948,6 @@ int filderLibrary(ReconstructInitSIRENA** reconstruct_init, double samprate)
 				message = "lpf_boxcar: scaleFactor too high => Cut-off frequency too low";
 				EP_PRINT_ERROR(message,status); return(EPFAIL);
 			}
-
-			// PULSE TEMPLATE: Derivative after filtering
-			if (differentiate (&model,model->size))
-			{
-				message = "Cannot run routine differentiate in filderLibrary";
-				EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
-			}
                     
 
                         if(!sc->is_threading()){
@@ -1987,6 +1980,10 @@ int filderLibrary(ReconstructInitSIRENA** reconstruct_init, double samprate)
 		}
 
 		gsl_vector_free(model); model = 0;
+
+		// 'pulse_templates_filder', 'maxDERs' and 'samp1DERs' have changed
+		checkLibraryOrder((*reconstruct_init)->library_collection->maxDERs,(*reconstruct_init)->library_collection->ntemplates,"maxDERs");
+		checkLibraryOrder((*reconstruct_init)->library_collection->samp1DERs,(*reconstruct_init)->library_collection->ntemplates,"samp1DERs");
 	}
 
 	return(EPOK);
@@ -2176,11 +2173,11 @@ int procRecord(ReconstructInitSIRENA** reconstruct_init, double tstartRecord, do
 		//?? Too many messages
 	}
 
-	// Low-pass filtering
-	status = lpf_boxcar(&record,record->size,scaleFactor,samprate);
+	// Low-pass filtering and differentiate after filtering (in a single pass)
+	status = lpf_boxcar_differentiate(&record,record->size,scaleFactor,samprate);
 	if (status == EPFAIL)
 	{
-		message = "Cannot run routine lpf_boxcar for low pass filtering";
+		message = "Cannot run routine lpf_boxcar_differentiate for low pass filtering and differentiating";
 		EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
 	}
 	if (status == 3)
@@ -2192,13 +2189,6 @@ int procRecord(ReconstructInitSIRENA** reconstruct_init, double tstartRecord, do
 		message = "lpf_boxcar: scaleFactor too high => Cut-off frequency too low";
 		EP_PRINT_ERROR(message,status); return(EPFAIL);
 	}
-	
-	// Differentiate after filtering
-	if (differentiate (&record, record->size))
-	{
-		message = "Cannot run routine differentiate for differentiating after filtering";
-		EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
-	}
 	gsl_vector_memcpy(recordDERIVATIVE,record);
         
         // Smooth derivative
@@ -9527,56 +9517,39 @@ int find_matchedfilter(int runF0orB0val, double maxDER, gsl_vector *maxDERs, Rec
 	}
 	else
 	{
-		for (int i=0;i<nummodels;i++)
+		long i = find_library_row(maxDERs_LIB1row,nummodels,maxDER,1);
+
+		if (maxDER == gsl_vector_get(maxDERs_LIB1row,i))
 		{
-                        if (maxDER == gsl_vector_get(maxDERs_LIB1row,i))
-			{
-				if (runF0orB0val == 0)	gsl_vector_memcpy(matchedfilterFound_aux,reconstruct_init->library_collection->matched_filters[i].mfilter);
-				else			gsl_vector_memcpy(matchedfilterFound_aux,reconstruct_init->library_collection->matched_filters_B0[i].mfilter);
+			if (runF0orB0val == 0)	gsl_vector_memcpy(matchedfilterFound_aux,reconstruct_init->library_collection->matched_filters[i].mfilter);
+			else			gsl_vector_memcpy(matchedfilterFound_aux,reconstruct_init->library_collection->matched_filters_B0[i].mfilter);
 
-				*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+			*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+			*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+		}
+		else
+		{
+			*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+			*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
 
-				break;
-			}
-			else if ((maxDER > gsl_vector_get(maxDERs_LIB1row,i)) && (maxDER < gsl_vector_get(maxDERs_LIB1row,i+1)))
+			// Interpolate between the two corresponding rows in "models"
+			if (runF0orB0val == 0)
 			{
-				*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
-
-				// Interpolate between the two corresponding rows in "models"
-				gsl_vector *matchedfilterAux;
-				if ((matchedfilterAux = gsl_vector_alloc(reconstruct_init->library_collection->matched_filters[0].mfilter_duration)) == 0)
+				if (interpolate_model(&matchedfilterFound_aux,maxDER,reconstruct_init->library_collection->matched_filters[i].mfilter,gsl_vector_get(maxDERs_LIB1row,i),
+					reconstruct_init->library_collection->matched_filters[i+1].mfilter,gsl_vector_get(maxDERs_LIB1row,i+1)))
 				{
-					sprintf(valERROR,"%d",__LINE__-2);
-					string str(valERROR);
-					message = "Allocating with <= 0 size in line " + str + " (" + __FILE__ + ")";
+					message = "Cannot run interpolate_model routine for model interpolation";
 					EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
 				}
-				gsl_vector_set_zero(matchedfilterAux);
-				if (runF0orB0val == 0)
-				{
-					if (interpolate_model(&matchedfilterAux,maxDER,reconstruct_init->library_collection->matched_filters[i].mfilter,gsl_vector_get(maxDERs_LIB1row,i),
-						reconstruct_init->library_collection->matched_filters[i+1].mfilter,gsl_vector_get(maxDERs_LIB1row,i+1)))
-					{
-						message = "Cannot run interpolate_model routine for model interpolation";
-						EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
-					}
-				}
-				else
+			}
+			else
+			{
+				if (interpolate_model(&matchedfilterFound_aux,maxDER,reconstruct_init->library_collection->matched_filters_B0[i].mfilter,gsl_vector_get(maxDERs_LIB1row,i),
+					reconstruct_init->library_collection->matched_filters_B0[i+1].mfilter,gsl_vector_get(maxDERs_LIB1row,i+1)))
 				{
-                                        if (interpolate_model(&matchedfilterAux,maxDER,reconstruct_init->library_collection->matched_filters_B0[i].mfilter,gsl_vector_get(maxDERs_LIB1row,i),
-						reconstruct_init->library_collection->matched_filters_B0[i+1].mfilter,gsl_vector_get(maxDERs_LIB1row,i+1)))
-					{
-						message = "Cannot run interpolate_model routine for model interpolation";
-						EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
-					}
+					message = "Cannot run interpolate_model routine for model interpolation";
+					EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
 				}
-				gsl_vector_memcpy(matchedfilterFound_aux,matchedfilterAux);
-
-				gsl_vector_free(matchedfilterAux); matchedfilterAux = 0;
-				
-				break;
 			}
 		}
 	}
@@ -9666,31 +9639,15 @@ int find_matchedfilterDAB(double maxDER, gsl_vector *maxDERs, ReconstructInitSIR
 	}
 	else
 	{
-		for (int i=0;i<nummodels;i++)
-		{
-			if (maxDER == gsl_vector_get(maxDERs,i))
-			{
-				gsl_vector_memcpy(matchedfilterFound_aux,reconstruct_init->library_collection->matched_filters[i].mfilter);
-				
-				gsl_matrix_get_row(PabFound_aux,reconstruct_init->library_collection->PAB,i);
+		long i = find_library_row(maxDERs,nummodels,maxDER,1);
 
-				*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+		gsl_vector_memcpy(matchedfilterFound_aux,reconstruct_init->library_collection->matched_filters[i].mfilter);
 
-				break;
-			}
-			else if ((maxDER > gsl_vector_get(maxDERs,i)) && (maxDER < gsl_vector_get(maxDERs,i+1)))
-			{
-				*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
+		gsl_matrix_get_row(PabFound_aux,reconstruct_init->library_collection->PAB,i);
 
-				gsl_vector_memcpy(matchedfilterFound_aux,reconstruct_init->library_collection->matched_filters[i].mfilter);
-				
-				gsl_matrix_get_row(PabFound_aux,reconstruct_init->library_collection->PAB,i);
-	
-				break;
-			}
-		}
+		*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+		if (maxDER == gsl_vector_get(maxDERs,i))	*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+		else						*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
 	}
 	
 	gsl_vector_view temp;
@@ -9800,44 +9757,26 @@ int find_optimalfilter(double maxDER, gsl_vector *maxDERs, ReconstructInitSIRENA
 	}
 	else
 	{
-		for (int i=0;i<nummodels;i++)
+		long i = find_library_row(maxDERs,nummodels,maxDER,1);
+
+		if (maxDER == gsl_vector_get(maxDERs,i))
 		{
-			if (maxDER == gsl_vector_get(maxDERs,i))
-			{
-				gsl_vector_memcpy(optimalfilterFound_Aux,reconstruct_init->library_collection->optimal_filters[i].ofilter);
+			gsl_vector_memcpy(optimalfilterFound_Aux,reconstruct_init->library_collection->optimal_filters[i].ofilter);
 
-				*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+			*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+			*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+		}
+		else
+		{
+			*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+			*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
 
-				break;
-			}
-			else if ((maxDER > gsl_vector_get(maxDERs,i)) && (maxDER < gsl_vector_get(maxDERs,i+1)))
+			// Interpolate between the two corresponding rows in "models"
+			if (interpolate_model(&optimalfilterFound_Aux,maxDER,reconstruct_init->library_collection->optimal_filters[i].ofilter,gsl_vector_get(maxDERs,i),
+				reconstruct_init->library_collection->optimal_filters[i+1].ofilter,gsl_vector_get(maxDERs,i+1)))
 			{
-				*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
-
-				// Interpolate between the two corresponding rows in "models"
-				gsl_vector *optimalfilter_Aux2;
-				if ((optimalfilter_Aux2 = gsl_vector_alloc(reconstruct_init->library_collection->optimal_filters[0].ofilter_duration)) == 0)
-				{
-					sprintf(valERROR,"%d",__LINE__-2);
-					string str(valERROR);
-					message = "Allocating with <= 0 size in line " + str + " (" + __FILE__ + ")";
-					EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
-				}
-				gsl_vector_set_zero(optimalfilter_Aux2);
-				if (interpolate_model(&optimalfilter_Aux2,maxDER,reconstruct_init->library_collection->optimal_filters[i].ofilter,gsl_vector_get(maxDERs,i),
-					reconstruct_init->library_collection->optimal_filters[i+1].ofilter,gsl_vector_get(maxDERs,i+1)))
-				{
-					message = "Cannot run interpolate_model routine for model interpolation";
-					EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
-				}
-
-				gsl_vector_memcpy(optimalfilterFound_Aux,optimalfilter_Aux2);
-
-				gsl_vector_free(optimalfilter_Aux2); optimalfilter_Aux2 = 0;
-							
-				break;
+				message = "Cannot run interpolate_model routine for model interpolation";
+				EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
 			}
 		}
 	}
@@ -9977,41 +9916,19 @@ int find_optimalfilterDAB(double maxDER, gsl_vector *maxDERs, ReconstructInitSIR
 	}
 	else
 	{
-		for (int i=0;i<nummodels;i++)
-		{
-			if (maxDER == gsl_vector_get(maxDERs,i))
-			{
-				gsl_vector_memcpy(optimalfilterFound_Aux,reconstruct_init->library_collection->optimal_filters[i].ofilter);
-				
-				if (((*PabFound)->size == reconstruct_init->library_collection->pulse_templatesMaxLengthFixedFilter[0].template_duration)
-				   && (reconstruct_init->library_collection->pulse_templatesMaxLengthFixedFilter[0].template_duration != -999))
-					gsl_matrix_get_row(PabFound_Aux,reconstruct_init->library_collection->PABMXLFF,i);
-				else
-					gsl_matrix_get_row(PabFound_Aux,reconstruct_init->library_collection->PAB,i);
-				
-				*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+		long i = find_library_row(maxDERs,nummodels,maxDER,1);
 
-				break;
-			}
-			else if ((maxDER > gsl_vector_get(maxDERs,i)) && (maxDER < gsl_vector_get(maxDERs,i+1)))
-			{
-				*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
-		
-				gsl_vector_memcpy(optimalfilterFound_Aux,reconstruct_init->library_collection->optimal_filters[i].ofilter);
+		gsl_vector_memcpy(optimalfilterFound_Aux,reconstruct_init->library_collection->optimal_filters[i].ofilter);
 
-				if (((*PabFound)->size == reconstruct_init->library_collection->pulse_templatesMaxLengthFixedFilter[0].template_duration)
-				   && (reconstruct_init->library_collection->pulse_templatesMaxLengthFixedFilter[0].template_duration != -999))
-				{
-					gsl_matrix_get_row(PabFound_Aux,reconstruct_init->library_collection->PABMXLFF,i);
-				}
-				else
-					gsl_matrix_get_row(PabFound_Aux,reconstruct_init->library_collection->PAB,i);
-								
-				break;
-			}
-		}
+		if (((*PabFound)->size == reconstruct_init->library_collection->pulse_templatesMaxLengthFixedFilter[0].template_duration)
+		   && (reconstruct_init->library_collection->pulse_templatesMaxLengthFixedFilter[0].template_duration != -999))
+			gsl_matrix_get_row(PabFound_Aux,reconstruct_init->library_collection->PABMXLFF,i);
+		else
+			gsl_matrix_get_row(PabFound_Aux,reconstruct_init->library_collection->PAB,i);
+
+		*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+		if (maxDER == gsl_vector_get(maxDERs,i))	*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+		else						*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
 	}
 	
 	gsl_vector *fixedlengths = gsl_vector_alloc(reconstruct_init->library_collection->nfixedfilters);
@@ -10123,33 +10040,17 @@ int find_prclwn(double maxDER, gsl_vector *maxDERs, ReconstructInitSIRENA *recon
 		*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,nummodels-2);
 		*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,nummodels-1);
 	}
-	else
+	else if (nummodels > 1)
 	{
-		for (int i=0;i<nummodels-1;i++)
-		{
-			if (maxDER == gsl_vector_get(maxDERs,i))
-			{
-				gsl_matrix_get_row(PRCLWNFound_Aux,reconstruct_init->library_collection->PRECALWN,i);
-				
-				gsl_matrix_get_row(PabFound_Aux,reconstruct_init->library_collection->PAB,i);
-				
-				*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				
-				break;
-			}
-			else if ((maxDER > gsl_vector_get(maxDERs,i)) && (maxDER < gsl_vector_get(maxDERs,i+1)))
-			{
-				*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
-				
-				gsl_matrix_get_row(PRCLWNFound_Aux,reconstruct_init->library_collection->PRECALWN,i);
-				
-				gsl_matrix_get_row(PabFound_Aux,reconstruct_init->library_collection->PAB,i);
-								
-				break;
-			}
-		}
+		// 'maxDER' equal to the last 'maxDERs' is handled as if it were higher
+		long i = GSL_MIN(find_library_row(maxDERs,nummodels,maxDER,1),nummodels-2);
+
+		gsl_matrix_get_row(PRCLWNFound_Aux,reconstruct_init->library_collection->PRECALWN,i);
+		gsl_matrix_get_row(PabFound_Aux,reconstruct_init->library_collection->PAB,i);
+
+		*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+		if (maxDER == gsl_vector_get(maxDERs,i))	*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+		else						*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
 	}
 	
 	gsl_vector *fixedlengths = gsl_vector_alloc(reconstruct_init->library_collection->nfixedfilters);
@@ -10273,27 +10174,16 @@ int find_prclofwm(double maxDER, gsl_vector *maxDERs, ReconstructInitSIRENA *rec
                 
                 *Ebeta = 0.0;
 	}
-	else
+	else if (nummodels > 1)
 	{
-		for (int i=0;i<nummodels-1;i++)
-		{
-			if (maxDER == gsl_vector_get(maxDERs_LIB1row,i))
-			{
-				gsl_matrix_get_row(PRCLOFWMFound_Aux,reconstruct_init->library_collection->PRCLOFWM,i);
-				
-				*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-			}
-			else if ((maxDER > gsl_vector_get(maxDERs_LIB1row,i)) && (maxDER < gsl_vector_get(maxDERs_LIB1row,i+1)))
-			{		
-				gsl_matrix_get_row(PRCLOFWMFound_Aux,reconstruct_init->library_collection->PRCLOFWM,i);
-				
-				*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
-								
-				break;
-			}
-		}
+		// 'maxDER' equal to the last 'maxDERs' is handled as if it were higher
+		long i = GSL_MIN(find_library_row(maxDERs_LIB1row,nummodels,maxDER,1),nummodels-2);
+
+		gsl_matrix_get_row(PRCLOFWMFound_Aux,reconstruct_init->library_collection->PRCLOFWM,i);
+
+		*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+		if (maxDER == gsl_vector_get(maxDERs_LIB1row,i))	*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+		else							*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
 	}
 	
 	gsl_vector *fixedlengths = gsl_vector_alloc(reconstruct_init->library_collection->nfixedfilters);
@@ -10381,31 +10271,16 @@ int find_Esboundary(double maxDER, gsl_vector *maxDERs, ReconstructInitSIRENA *r
 		*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,nummodels-2);
 		*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,nummodels-1);
 	}
-	else
+	else if (nummodels > 1)
 	{
-		for (int i=0;i<nummodels-1;i++)
-		{
-			if (maxDER == gsl_vector_get(maxDERs,i))
-			{
-				*indexEalpha = i;
-				*indexEbeta = i+1;
-				
-				*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
+		// 'maxDER' equal to the last 'maxDERs' is handled as if it were higher
+		long i = GSL_MIN(find_library_row(maxDERs,nummodels,maxDER,1),nummodels-2);
 
-				break;
-			}
-			else if ((maxDER > gsl_vector_get(maxDERs,i)) && (maxDER < gsl_vector_get(maxDERs,i+1)))
-			{
-				*indexEalpha = i;
-				*indexEbeta = i+1;
-				
-				*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
-				*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
-				
-				break;
-			}
-		}
+		*indexEalpha = i;
+		*indexEbeta = i+1;
+
+		*Ealpha = gsl_vector_get(reconstruct_init->library_collection->energies,i);
+		*Ebeta = gsl_vector_get(reconstruct_init->library_collection->energies,i+1);
 	}
 
 	return(EPOK);
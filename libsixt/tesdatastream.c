@@ -410,8 +410,9 @@ void appendTESFitsStream(fitsfile *fptr,
 
 }
 
-void getTESDataStream(TESDataStream* TESData,
-		PixImpFile* PixFile,
+/** Generate the data stream from the impacts of the given source. */
+static void generateTESDataStream(TESDataStream* TESData,
+		PixImpactSource* source,
 		TESProfiles* TESProf,
 		AdvDet* det,
 		double tstart,
@@ -467,7 +468,7 @@ void getTESDataStream(TESDataStream* TESData,
 	CHECK_STATUS_VOID(*status);
 
 	/* Initialize Noise buffer */
-	NoiseBuffer* NBuffer=newNoiseBuffer(status, &Npix);
+	NoiseBuffer* NBuffer=newNoiseBuffer(status, &Npix, simulated_pixels, &SampleFreq);
 	CHECK_STATUS_VOID(*status);
 
 	/* Initialize 1/F noise arrays */
@@ -515,7 +516,7 @@ void getTESDataStream(TESDataStream* TESData,
 
 		/* Fill Noise buffer */
 		if (inoise==NOISEBUFFERSIZE) {
-			genNoiseSpectrum(simulated_pixels,NBuffer,&SampleFreq,&rng,status);
+			genNoiseSpectrum(NBuffer,&rng,status);
 			CHECK_STATUS_VOID(*status);
 			inoise=0;
 		}
@@ -528,7 +529,7 @@ void getTESDataStream(TESDataStream* TESData,
 
 		/* Get first event from the impact file */
 		if (tstep==0) {
-			piximpstatus=getNextImpactFromPixImpFile(PixFile,&impact,status);
+			piximpstatus=getNextImpactFromSource(source,&impact,status);
 			CHECK_STATUS_VOID(*status);
 		}
 
@@ -563,7 +564,7 @@ void getTESDataStream(TESDataStream* TESData,
 				ntot++;
 			}
 			CHECK_STATUS_VOID(*status);
-			piximpstatus=getNextImpactFromPixImpFile(PixFile,&impact,status);
+			piximpstatus=getNextImpactFromSource(source,&impact,status);
 			CHECK_STATUS_VOID(*status);
 		}
 
@@ -580,7 +581,7 @@ void getTESDataStream(TESDataStream* TESData,
 			CHECK_STATUS_VOID(*status);
 
 			/* Add noise to the pixel value (double) */
-			PixVal=PixVal + NBuffer->Buffer[inoise][ipix];
+			PixVal=PixVal + NBuffer->Buffer[(size_t)ipix*NOISEBUFFERSIZE+inoise];
 
 			/* Loop over linked list and add pulse values */
 			current=ActPulses[ipix];
@@ -623,10 +624,53 @@ void getTESDataStream(TESDataStream* TESData,
 	for (ipix=0;ipix<Npix;ipix++) {
 		destroyEventNode(ActPulses[ipix]);
 	}
+	free(ActPulses);
 	destroyNoiseBuffer(NBuffer,status);
+	gsl_rng_free(rng);
 	free(simulated_pixels);
 }
 
+void getTESDataStream(TESDataStream* TESData,
+		PixImpFile* PixFile,
+		TESProfiles* TESProf,
+		AdvDet* det,
+		double tstart,
+		double tstop,
+		int Ndetpix,
+		int Nactive,
+		int* activearray,
+		long* Nevts,
+		int *ismonoc,
+		float *monoen,
+		unsigned long int seed,
+		int* const status)
+{
+	PixImpactSource source={PixFile, NULL, 0, 0, NULL};
+	generateTESDataStream(TESData,&source,TESProf,det,tstart,tstop,Ndetpix,
+			Nactive,activearray,Nevts,ismonoc,monoen,seed,status);
+}
+
+void getTESDataStreamFromImpacts(TESDataStream* TESData,
+		const PixImpact* impacts,
+		long nimpacts,
+		TESProfiles* TESProf,
+		AdvDet* det,
+		double tstart,
+		double tstop,
+		int Ndetpix,
+		int Nactive,
+		int* activearray,
+		long* Nevts,
+		int *ismonoc,
+		float *monoen,
+		unsigned long int seed,
+		int* const status)
+{
+	PixImpactSource source={NULL, impacts, nimpacts, 0, NULL};
+	generateTESDataStream(TESData,&source,TESProf,det,tstart,tstop,Ndetpix,
+			Nactive,activearray,Nevts,ismonoc,monoen,seed,status);
+}
+
 
 EvtNode** newEventNodes(int *NPixel, int* const status) {
   int i;
@@ -754,3 +798,238 @@ AdvPix** getSimulatedPixelArray(AdvDet* det,const int* const activearray,const i
 	}
 	return(simulated_pixels);
 }
+
+/** Shared state of the threads generating the pixel data streams. */
+typedef struct{
+	const PixImpactBuckets* buckets;
+	TESProfiles* TESProf;
+	AdvDet* det;
+	double tstart, tstop;
+	long* Nevts;
+	unsigned long int seed;
+
+	/** Pixels with impacts and their streams (NULL as long as the
+	    stream is not available). */
+	int* pixels;
+	int npixels;
+	TESDataStream** streams;
+	float* monoen;
+
+	/** Next pixel to be generated, number of pixels handed over to
+	    the consumer, and maximum number of streams in memory. */
+	int next, consumed, window;
+
+	/** Non-zero, if the threads should terminate. */
+	int stop;
+	int status;
+
+	pthread_mutex_t mutex;
+	pthread_cond_t cond_generated, cond_consumed;
+}TESPixelStreamPool;
+
+/** Generate the data stream of a single pixel. */
+static TESDataStream* generateTESPixelStream(TESPixelStreamPool* pool,
+		int pixel,int* activearray,float* monoen,int* const status){
+	const PixImpactBuckets* buckets=pool->buckets;
+	TESDataStream* stream=newTESDataStream(status);
+	CHECK_STATUS_RET(*status,stream);
+	int ismonoc=0;
+	activearray[pixel]=0;
+	getTESDataStreamFromImpacts(stream,
+			&(buckets->impact[buckets->first[pixel]]),
+			buckets->first[pixel+1]-buckets->first[pixel],
+			pool->TESProf,pool->det,pool->tstart,pool->tstop,
+			pool->det->npix,1,activearray,pool->Nevts,
+			&ismonoc,monoen,pool->seed,status);
+	activearray[pixel]=-1;
+	return(stream);
+}
+
+static void freeTESPixelStream(TESDataStream** stream){
+	if(NULL!=*stream){
+		destroyTESDataStream(*stream);
+		free(*stream);
+		*stream=NULL;
+	}
+}
+
+static void* TESPixelStreamThread(void* arg){
+	TESPixelStreamPool* pool=(TESPixelStreamPool*)arg;
+	int status=EXIT_SUCCESS;
+	int* activearray=(int*)malloc(pool->det->npix*sizeof(int));
+	if(NULL==activearray){
+		status=EXIT_FAILURE;
+		SIXT_ERROR("memory allocation for activearray failed");
+	} else {
+		for(int ii=0;ii<pool->det->npix;ii++){
+			activearray[ii]=-1;
+		}
+	}
+
+	pthread_mutex_lock(&pool->mutex);
+	while(EXIT_SUCCESS==status){
+		// Do not get too far ahead of the consumer.
+		while(0==pool->stop && pool->next<pool->npixels &&
+				pool->next>=pool->consumed+pool->window){
+			pthread_cond_wait(&pool->cond_consumed,&pool->mutex);
+		}
+		if(0!=pool->stop || pool->next>=pool->npixels) break;
+		int index=pool->next++;
+		pthread_mutex_unlock(&pool->mutex);
+
+		float monoen=0.;
+		TESDataStream* stream=generateTESPixelStream(pool,pool->pixels[index],
+				activearray,&monoen,&status);
+
+		pthread_mutex_lock(&pool->mutex);
+		pool->streams[index]=stream;
+		pool->monoen[index]=monoen;
+		pthread_cond_broadcast(&pool->cond_generated);
+	}
+	if(EXIT_SUCCESS!=status){
+		pool->status=status;
+		pool->stop=1;
+		pthread_cond_broadcast(&pool->cond_generated);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	free(activearray);
+	return(NULL);
+}
+
+void processTESPixelStreams(const PixImpactBuckets* const buckets,
+		TESProfiles* TESProf,
+		AdvDet* det,
+		double tstart,
+		double tstop,
+		long* Nevts,
+		unsigned long int seed,
+		int nthreads,
+		TESPixelStreamFct fct,
+		void* data,
+		int* const status){
+	CHECK_STATUS_VOID(*status);
+
+	TESPixelStreamPool pool;
+	pool.buckets=buckets;
+	pool.TESProf=TESProf;
+	pool.det=det;
+	pool.tstart=tstart;
+	pool.tstop=tstop;
+	pool.Nevts=Nevts;
+	pool.seed=seed;
+	pool.npixels=0;
+	pool.next=0;
+	pool.consumed=0;
+	pool.stop=0;
+	pool.status=EXIT_SUCCESS;
+
+	// Pixels with impacts in ascending order.
+	pool.pixels=(int*)malloc(MAX(buckets->npix,1)*sizeof(int));
+	CHECK_MALLOC_VOID_STATUS(pool.pixels,*status);
+	for(int ii=0;ii<buckets->npix;ii++){
+		if(buckets->first[ii+1]>buckets->first[ii]){
+			pool.pixels[pool.npixels++]=ii;
+		}
+	}
+	if(0==pool.npixels){
+		free(pool.pixels);
+		return;
+	}
+	nthreads=MIN(MAX(nthreads,1),pool.npixels);
+
+	if(1==nthreads){
+		int* activearray=(int*)malloc(det->npix*sizeof(int));
+		if(NULL==activearray){
+			free(pool.pixels);
+			*status=EXIT_FAILURE;
+			SIXT_ERROR("memory allocation for activearray failed");
+			return;
+		}
+		for(int ii=0;ii<det->npix;ii++){
+			activearray[ii]=-1;
+		}
+		for(int ii=0;ii<pool.npixels;ii++){
+			float monoen=0.;
+			TESDataStream* stream=generateTESPixelStream(&pool,pool.pixels[ii],
+					activearray,&monoen,status);
+			if(EXIT_SUCCESS==*status){
+				fct(stream,pool.pixels[ii],monoen,data,status);
+			}
+			freeTESPixelStream(&stream);
+			if(EXIT_SUCCESS!=*status) break;
+		}
+		free(activearray);
+		free(pool.pixels);
+		return;
+	}
+
+	pool.window=2*nthreads;
+	pool.streams=(TESDataStream**)calloc(pool.npixels,sizeof(TESDataStream*));
+	pool.monoen=(float*)malloc(pool.npixels*sizeof(float));
+	pthread_t* threads=(pthread_t*)malloc(nthreads*sizeof(pthread_t));
+	if(NULL==pool.streams || NULL==pool.monoen || NULL==threads){
+		free(pool.streams);
+		free(pool.monoen);
+		free(threads);
+		free(pool.pixels);
+		*status=EXIT_FAILURE;
+		SIXT_ERROR("memory allocation for pixel stream threads failed");
+		return;
+	}
+	pthread_mutex_init(&pool.mutex,NULL);
+	pthread_cond_init(&pool.cond_generated,NULL);
+	pthread_cond_init(&pool.cond_consumed,NULL);
+
+	int nstarted;
+	for(nstarted=0;nstarted<nthreads;nstarted++){
+		if(0!=pthread_create(&threads[nstarted],NULL,TESPixelStreamThread,&pool)){
+			break;
+		}
+	}
+	if(0==nstarted){
+		*status=EXIT_FAILURE;
+		SIXT_ERROR("could not start pixel stream threads");
+	}
+
+	// Hand the streams over in the order of the pixels, such that the
+	// output does not depend on the number of threads.
+	for(int ii=0;ii<pool.npixels && EXIT_SUCCESS==*status;ii++){
+		pthread_mutex_lock(&pool.mutex);
+		while(NULL==pool.streams[ii] && EXIT_SUCCESS==pool.status){
+			pthread_cond_wait(&pool.cond_generated,&pool.mutex);
+		}
+		if(EXIT_SUCCESS!=pool.status){
+			*status=pool.status;
+		}
+		pthread_mutex_unlock(&pool.mutex);
+		CHECK_STATUS_BREAK(*status);
+
+		fct(pool.streams[ii],pool.pixels[ii],pool.monoen[ii],data,status);
+
+		pthread_mutex_lock(&pool.mutex);
+		freeTESPixelStream(&pool.streams[ii]);
+		pool.consumed=ii+1;
+		pthread_cond_broadcast(&pool.cond_consumed);
+		pthread_mutex_unlock(&pool.mutex);
+	}
+
+	pthread_mutex_lock(&pool.mutex);
+	pool.stop=1;
+	pthread_cond_broadcast(&pool.cond_consumed);
+	pthread_mutex_unlock(&pool.mutex);
+	for(int ii=0;ii<nstarted;ii++){
+		pthread_join(threads[ii],NULL);
+	}
+	pthread_mutex_destroy(&pool.mutex);
+	pthread_cond_destroy(&pool.cond_generated);
+	pthread_cond_destroy(&pool.cond_consumed);
+
+	for(int ii=0;ii<pool.npixels;ii++){
+		freeTESPixelStream(&pool.streams[ii]);
+	}
+	free(pool.streams);
+	free(pool.monoen);
+	free(threads);
+	free(pool.pixels);
+}
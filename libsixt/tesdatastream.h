@@ -29,6 +29,7 @@
 #include "pixelimpactfile.h"
 #include "tesnoisespectrum.h"
 #include <stdint.h>
+#include <pthread.h>
 
 #define TESFITSMAXPIX 40
 
@@ -117,6 +118,14 @@ typedef struct node{
 
 }EvtNode;
 
+/** Function processing the data stream of a single pixel (see
+    processTESPixelStreams()). */
+typedef void (*TESPixelStreamFct)(TESDataStream* const stream,
+				  const int pixel,
+				  const float monoen,
+				  void* const data,
+				  int* const status);
+
 /////////////////////////////////////////////////////////////////
 // Function Declarations.
 /////////////////////////////////////////////////////////////////
@@ -203,6 +212,41 @@ void getTESDataStream(TESDataStream* TESData,
 		      unsigned long int seed,
 		      int* const status);
 
+/** Same as getTESDataStream, but with the impacts taken from an
+    array (sorted by time) instead of a PixImpFile. */
+void getTESDataStreamFromImpacts(TESDataStream* TESData,
+		      const PixImpact* impacts,
+		      long nimpacts,
+		      TESProfiles* TESProf,
+		      AdvDet* det,
+		      double tstart,
+		      double tstop,
+		      int Ndetpix,
+		      int Nactive,
+		      int* activearray,
+		      long* Nevts,
+		      int *ismonoc,
+		      float *monoen,
+		      unsigned long int seed,
+		      int* const status);
+
+/** Generate the data stream of every pixel with impacts in the
+    buckets on its own (as getTESDataStream with this pixel as the
+    only active one) and pass it to 'fct'. The streams are generated
+    by 'nthreads' threads, but handed to 'fct' on the calling thread
+    in the order of the pixels. */
+void processTESPixelStreams(const PixImpactBuckets* const buckets,
+		      TESProfiles* TESProf,
+		      AdvDet* det,
+		      double tstart,
+		      double tstop,
+		      long* Nevts,
+		      unsigned long int seed,
+		      int nthreads,
+		      TESPixelStreamFct fct,
+		      void* data,
+		      int* const status);
+
 /** Add an event to the node list */
 int addEventToNode(EvtNode** ActPulses,
 		   TESProfiles* Pulses,
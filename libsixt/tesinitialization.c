@@ -27,22 +27,24 @@
 void tesinitialization(TESInitStruct* const init,TESGeneralParameters* const par, int* const status){
   int ii;
 
-  // Open the pixel impact file
-  init->impfile=openPixImpFile(par->PixImpList, READONLY,status);
-  CHECK_STATUS_VOID(*status);
-  // Read keywords from input file
-  sixt_read_fits_stdkeywords_obsolete(init->impfile->fptr,
-			     init->telescop,
-			     init->instrume,
-			     init->filter,
-			     init->ancrfile,
-			     init->respfile,
-			     &(init->mjdref),
-			     &(init->timezero),
-			     &(init->tstart),
-			     &(init->tstop),
-			     status);
-  CHECK_STATUS_VOID(*status);
+  // Open the pixel impact file and read the keywords from it. Without
+  // a pixel impact file, the keywords have to be set by the caller.
+  if (strlen(par->PixImpList)>0) {
+    init->impfile=openPixImpFile(par->PixImpList, READONLY,status);
+    CHECK_STATUS_VOID(*status);
+    sixt_read_fits_stdkeywords_obsolete(init->impfile->fptr,
+			       init->telescop,
+			       init->instrume,
+			       init->filter,
+			       init->ancrfile,
+			       init->respfile,
+			       &(init->mjdref),
+			       &(init->timezero),
+			       &(init->tstart),
+			       &(init->tstop),
+			       status);
+    CHECK_STATUS_VOID(*status);
+  }
   if(par->check_times){
 	  printf("Pixel impact file reaches from %lfs-%lfs .\n", init->tstart, init->tstop);
 	  if(init->tstart>par->tstart){
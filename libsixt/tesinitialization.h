@@ -114,7 +114,9 @@ typedef struct {
 ////////////////////////////////////////////////////////////////////////
 
 /** Initializes the different variables necessary fo the simulations. Depending
-    on the tool calling this function, not all the variables are set. */
+    on the tool calling this function, not all the variables are set. If
+    no pixel impact file is given, the keywords have to be set in 'init'
+    before. */
 void tesinitialization(TESInitStruct* const init,TESGeneralParameters* const par, int* const status);
 
 /** Constructor. Returns a pointer to an empty TESInitStruct data
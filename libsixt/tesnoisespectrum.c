@@ -23,6 +23,13 @@
 
 #include "tesnoisespectrum.h"
 
+#include <pthread.h>
+
+/** The FFTW planner is not thread-safe, so noise buffers can only be
+    used in parallel, if their plans are created and destroyed one at
+    a time. */
+static pthread_mutex_t noise_plan_mutex=PTHREAD_MUTEX_INITIALIZER;
+
 void setNoiseGSLSeed(gsl_rng **r, unsigned long int seed){
 
   const gsl_rng_type * T;
@@ -78,10 +85,76 @@ void setNoiseGSLSeed(gsl_rng **r, unsigned long int seed){
 //}
 
 
+/** Check whether two pixels have the same noise filter. */
+static int sameNoiseFilter(const TESNoiseProperties* a,
+			   const TESNoiseProperties* b)
+{
+    int k;
+
+    if (a==b) {
+      return 1;
+    }
+    if ((a->WhiteRMS!=b->WhiteRMS)||(a->H0!=b->H0)||
+	(a->Nz!=b->Nz)||(a->Np!=b->Np)) {
+      return 0;
+    }
+    for (k=0;k<a->Nz;k++) {
+      if (a->Zeros[k]!=b->Zeros[k]) return 0;
+    }
+    for (k=0;k<a->Np;k++) {
+      if (a->Poles[k]!=b->Poles[k]) return 0;
+    }
+    return 1;
+}
+
+/** Calculate the amplitudes |H|*WhiteRMS*sqrt(df/2) of the noise
+    filter of a pixel for the frequency bins 0..BufferSize/2. */
+static void calcNoiseFilter(const TESNoiseProperties* noise,
+			    double* filter,
+			    int BufferSize,
+			    double SampFreq)
+{
+    const double pi=M_PI;
+    int i, k;
+    fftw_complex Ze, Po, H; /* Products of Zeros & Poles */
+    double w, f;               /* Omega and frequency*/
+
+    /* Calculate size of frequency bin */
+    const double df=SampFreq/BufferSize;
+
+    filter[0]=0.;
+    for (i=1; i<=BufferSize/2; i++) {
+
+      /* Set initial value of zeros and poles */
+      Ze = 1.0 + 0.0 * I;  /* Zeros initialisation */
+      Po = 1.0 + 0.0 * I;  /* Poles initialisation */
+
+      /* Calculate frequency and angular frequency for spectrum */
+      f=i*df;
+      w=2.0*pi*f;
+
+      /* Multiply all the zeros */
+      for (k=0;k<noise->Nz;k++) {
+	Ze = Ze * (1.0 + noise->Zeros[k] * w * I);
+      }
+
+      /* Multiply all the poles */
+      for (k=0;k<noise->Np;k++) {
+	Po = Po * (1.0 + noise->Poles[k] * w * I);
+      }
+
+      /* Calculate the filter amplitude */
+      H = noise->H0 * Ze / Po;
+      filter[i]=cabs(H) * noise->WhiteRMS * sqrt(df) / sqrt(2.);
+    }
+}
+
 NoiseBuffer* newNoiseBuffer(int* const status,
-			    int *NumberOfPixels)
+			    int *NumberOfPixels,
+			    AdvPix** simulated_pixels,
+			    double *SampFreq)
 {
-    int i;
+    int i, j;
 
     /* Set Buffer properties */
 
@@ -94,17 +167,71 @@ NoiseBuffer* newNoiseBuffer(int* const status,
 
     NBuffer->BufferSize=NOISEBUFFERSIZE;
     NBuffer->NPixel=*NumberOfPixels;
-    NBuffer->Buffer=(double**)malloc(NBuffer->BufferSize*sizeof(double*));
-    if(NBuffer->Buffer==NULL){
+    NBuffer->NFilter=0;
+    NBuffer->Filter=NULL;
+    NBuffer->FilterIndex=NULL;
+    NBuffer->Spectrum=NULL;
+    NBuffer->Plan=NULL;
+
+    const int NBins=NBuffer->BufferSize/2+1;
+
+    /* One contiguous block for all pixels, with the samples of
+       each pixel one after another */
+    NBuffer->Buffer=(double*)fftw_malloc((size_t)NBuffer->NPixel*
+					 NBuffer->BufferSize*sizeof(double));
+    NBuffer->Spectrum=(fftw_complex*)fftw_malloc(NBins*sizeof(fftw_complex));
+    NBuffer->FilterIndex=(int*)malloc(MAX(NBuffer->NPixel,1)*sizeof(int));
+    if((NBuffer->Buffer==NULL && NBuffer->NPixel>0) ||
+       NBuffer->Spectrum==NULL || NBuffer->FilterIndex==NULL){
       *status=EXIT_FAILURE;
       SIXT_ERROR("memory allocation for NBuffer Buffer failed");
       CHECK_STATUS_RET(*status, NBuffer);
     }
-    for (i=0;i<NBuffer->BufferSize;i++) {
-      NBuffer->Buffer[i]=(double*)malloc(NBuffer->NPixel*sizeof(double));
-      if(NBuffer->Buffer[i]==NULL){
+
+    /* Pixels with the same noise parameters share one filter */
+    for (j=0; j<NBuffer->NPixel; j++) {
+      NBuffer->FilterIndex[j]=j;
+      for (i=0; i<j; i++) {
+	if (NBuffer->FilterIndex[i]==i &&
+	    sameNoiseFilter(simulated_pixels[i]->TESNoise,
+			    simulated_pixels[j]->TESNoise)) {
+	  NBuffer->FilterIndex[j]=i;
+	  break;
+	}
+      }
+      if (NBuffer->FilterIndex[j]==j) {
+	NBuffer->NFilter++;
+      }
+    }
+
+    NBuffer->Filter=(double*)malloc((size_t)MAX(NBuffer->NFilter,1)*NBins*sizeof(double));
+    if(NBuffer->Filter==NULL){
+      *status=EXIT_FAILURE;
+      SIXT_ERROR("memory allocation for noise filters failed");
+      CHECK_STATUS_RET(*status, NBuffer);
+    }
+    int nfilter=0;
+    for (j=0; j<NBuffer->NPixel; j++) {
+      if (NBuffer->FilterIndex[j]==j) {
+	calcNoiseFilter(simulated_pixels[j]->TESNoise,
+			&NBuffer->Filter[(size_t)nfilter*NBins],
+			NBuffer->BufferSize, *SampFreq);
+	NBuffer->FilterIndex[j]=nfilter++;
+      } else {
+	NBuffer->FilterIndex[j]=NBuffer->FilterIndex[NBuffer->FilterIndex[j]];
+      }
+    }
+
+    /* The same plan is used for all pixels, with the output written
+       directly to the buffer of the respective pixel */
+    if (NBuffer->NPixel>0) {
+      pthread_mutex_lock(&noise_plan_mutex);
+      NBuffer->Plan=fftw_plan_dft_c2r_1d(NBuffer->BufferSize,NBuffer->Spectrum,
+					  NBuffer->Buffer,FFTW_ESTIMATE);
+      pthread_mutex_unlock(&noise_plan_mutex);
+      if(NBuffer->Plan==NULL){
 	*status=EXIT_FAILURE;
-	SIXT_ERROR("memory allocation for NBuffer Buffer failed");
+	SIXT_ERROR("creation of FFTW plan for the noise failed");
 	CHECK_STATUS_RET(*status, NBuffer);
       }
     }
@@ -163,97 +290,46 @@ NoiseOoF* newNoiseOoF(int* const status,gsl_rng **r,double sample_freq,AdvPix* p
 }
 
 
-int genNoiseSpectrum(AdvPix** simulated_pixels,
-		     NoiseBuffer* NBuffer,
-		     double *SampFreq,
+int genNoiseSpectrum(NoiseBuffer* NBuffer,
 		     gsl_rng **r,
                      int* const status)
 {
-    double Gx, Gy, sigma, df;
-    const double pi=M_PI;
-    int i,j, k;
+    int i, j;
 
-    fftw_complex *in;
-    double *out;
-    fftw_plan p=NULL;
-    fftw_complex Ze, Po, H; /* Products of Zeros & Poles */
-    double w, f;               /* Omega and frequency*/
-
-    sigma=1.;
-
-    in=(fftw_complex *) fftw_malloc(sizeof(fftw_complex) * (NBuffer->BufferSize/2+1));
-    if(in==NULL){
-      *status=EXIT_FAILURE;
-      SIXT_ERROR("memory allocation for fftw_complex failed");
-      CHECK_STATUS_RET(*status, *status);
-    }
-    out=(double *) fftw_malloc(sizeof(double) * NBuffer->BufferSize);
-    if(out==NULL){
-      *status=EXIT_FAILURE;
-      SIXT_ERROR("memory allocation for fftw_complex failed");
-      CHECK_STATUS_RET(*status, *status);
-    }
+    const int N=NBuffer->BufferSize;
+    const int NBins=N/2+1;
+    const double norm=1./sqrt(2*N);
 
-
-    /* Calculate size of frequency bin */
-    df=*SampFreq/(NBuffer->BufferSize);
+    /* Real and imaginary parts of the spectrum */
+    double* in=(double*)NBuffer->Spectrum;
 
     for (j=0; j<NBuffer->NPixel; j++) {
 
-      for (i=1; i<=NBuffer->BufferSize/2; i++) {
-
-        /* Define the noise filter */
-	/* Set initial value of zeros and poles */
-        Ze = 1.0 + 0.0 * I;  /* Zeros initialisation */
-        Po = 1.0 + 0.0 * I;  /* Poles initialisation */
-
-	/* Calculate frequency and angular frequency for spectrum */
-	f=i*df;
-	w=2.0*pi*f;
-
-	/* Multiply all the zeros */
-        for (k=0;k<simulated_pixels[j]->TESNoise->Nz;k++) {
-          Ze = Ze * (1.0 + simulated_pixels[j]->TESNoise->Zeros[k] * w * I);
-        }
-
-	/* Multiply all the poles */
-	for (k=0;k<simulated_pixels[j]->TESNoise->Np;k++) {
-	  Po = Po * (1.0 + simulated_pixels[j]->TESNoise->Poles[k] * w * I);
-	}
-
-	/* Calculate the filter amplitude (complex) */
-	H = simulated_pixels[j]->TESNoise->H0 * Ze / Po;
-
-	if (i==NBuffer->BufferSize/2) { // At Nyquist freq, the FT is purely real-> draw only one gaussian variable
-	  /* Create a complex white noise spectrum */
-	  Gx=gsl_ran_gaussian(*r,sigma);
-	  in[i]=Gx + 0.0*I;
-
-	  /* Multiply the noise filter with the white noise */
-	  in[i]=in[i] * cabs(H) * simulated_pixels[j]->TESNoise->WhiteRMS * sqrt(df) / sqrt(2.);
-	} else {
-	  /* Create a complex white noise spectrum */
-	  Gx=gsl_ran_gaussian(*r,sigma);
-	  Gy=gsl_ran_gaussian(*r,sigma);
-	  in[i]=Gx + Gy*I;
-
-	  /* Multiply the noise filter with the white noise */
-	  in[i]=in[i] * H * simulated_pixels[j]->TESNoise->WhiteRMS *sqrt(df) / sqrt(2.);
-	}
+      /* Create a complex white noise spectrum */
+      in[0]=0.;
+      in[1]=0.;
+      for (i=1; i<N/2; i++) {
+	in[2*i]=gsl_ran_gaussian(*r,1.);
+	in[2*i+1]=gsl_ran_gaussian(*r,1.);
+      }
+      /* At Nyquist freq, the FT is purely real-> draw only one gaussian variable */
+      in[N]=gsl_ran_gaussian(*r,1.);
+      in[N+1]=0.;
+
+      /* Multiply the noise filter with the white noise */
+      const double* filter=&NBuffer->Filter[(size_t)NBuffer->FilterIndex[j]*NBins];
+      for (i=1; i<NBins; i++) {
+	in[2*i]*=filter[i];
+	in[2*i+1]*=filter[i];
       }
-      in[0]=0.0 + 0.0*I;
-      p=(fftw_plan) fftw_plan_dft_c2r_1d(NBuffer->BufferSize,in,out,FFTW_ESTIMATE);
 
-      fftw_execute(p);
+      double* out=&NBuffer->Buffer[(size_t)j*N];
+      fftw_execute_dft_c2r(NBuffer->Plan,NBuffer->Spectrum,out);
 
-      for (i=0;i<NBuffer->BufferSize;i++) {
-        NBuffer->Buffer[i][j]=out[i] / sqrt(2*NBuffer->BufferSize) ;
+      for (i=0;i<N;i++) {
+	out[i]*=norm;
       }
-
     }
-    fftw_destroy_plan(p);
-    fftw_free(in);
-    fftw_free(out);
 
     return *status;
 }
@@ -310,17 +386,21 @@ void getNextOoFNoiseSumval(NoiseOoF** OFNoise,  /* */
 
 int destroyNoiseBuffer(NoiseBuffer* NBuffer,
 		       int* const status) {
-    int i;
 
     if(NBuffer!=NULL){
+      if(NBuffer->Plan!=NULL){
+	pthread_mutex_lock(&noise_plan_mutex);
+	fftw_destroy_plan(NBuffer->Plan);
+	pthread_mutex_unlock(&noise_plan_mutex);
+      }
       if(NBuffer->Buffer!=NULL){
-	for (i=0;i<NBuffer->BufferSize;i++) {
-	  if(NBuffer->Buffer[i]!=NULL){
-	    free(NBuffer->Buffer[i]);
-	  }
-	}
-	free(NBuffer->Buffer);
+	fftw_free(NBuffer->Buffer);
+      }
+      if(NBuffer->Spectrum!=NULL){
+	fftw_free(NBuffer->Spectrum);
       }
+      free(NBuffer->Filter);
+      free(NBuffer->FilterIndex);
       free(NBuffer);
     }
 
@@ -69,8 +69,23 @@ typedef struct {
   /** Number of Pixels (to be obtained from other struct later) */
   int NPixel;
 
-  /** Actual buffer */
-  double **Buffer;
+  /** Actual buffer, with the BufferSize values of pixel j starting
+      at Buffer[j*BufferSize] */
+  double *Buffer;
+
+  /** Amplitudes |H|*WhiteRMS*sqrt(df/2) of the noise filters for the
+      frequency bins 0..BufferSize/2 (one row per filter). Pixels
+      with the same noise parameters share a filter. */
+  int NFilter;
+  double *Filter;
+
+  /** Filter of each pixel */
+  int *FilterIndex;
+
+  /** Noise spectrum of a pixel and the FFT plan, which is reused for
+      all pixels */
+  fftw_complex *Spectrum;
+  fftw_plan Plan;
 } NoiseBuffer;
 
 
@@ -105,16 +120,18 @@ void setNoiseGSLSeed(gsl_rng **r, unsigned long int seed);
 ///** Function to allocate and fill noise parameter struct */
 //NoiseSpectrum* newNoiseSpectrum(AdvDet *det,
 //				int* const status);
+/** Function to allocate the noise buffer and to calculate the noise
+    filters of the pixels */
 NoiseBuffer* newNoiseBuffer(int* const status,
-			    int *NumberOfPixels);
+			    int *NumberOfPixels,
+			    AdvPix** simulated_pixels,
+			    double *SampFreq);
 
 /** Function to initialise arrays for 1/f noise generation */
 NoiseOoF* newNoiseOoF(int* const status,gsl_rng **r,double sample_freq,AdvPix* pixel);
 
 /** Generate noise data from a noise spectrum */
-int genNoiseSpectrum(AdvPix** simulated_pixels,
-		     NoiseBuffer* NBuffer,
-		     double *SampFreq,
+int genNoiseSpectrum(NoiseBuffer* NBuffer,
 		     gsl_rng **r,
 		     int* const status);
 
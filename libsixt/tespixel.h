@@ -191,6 +191,8 @@ struct tesparams {
 
   int simnoise;  // simulate noise?
   int stochastic_integrator; //use stochastic integrator?
+  void *sde_workspace; // workspace of the stochastic integrator
+  void *quiescent_info; // linearised model for quiescent periods (NULL if not used)
 
   double Pnb1;   // thermal noise
 
@@ -211,7 +213,8 @@ struct tesparams {
   // BBFB parameters
   int dobbfb; // option to perform bbfb
   int decimation_filter; // Option to filter with average during decimation
-  void *bbfb_info; // data for bbfb
+  void *bbfb_info; // data for bbfb (shared by the pixels of a readout channel)
+  int bbfb_index; // index of the pixel in its bbfb loop
   tes_bbfb_loop apply_bbfb; // function to apply a bbfb mechanism (funciton pointer)
 
   int twofluid; //Do we use the twofluid model?
@@ -145,14 +145,14 @@ void copyTriggerKeywords(fitsfile* fptr,fitsfile* fptr2,int* const status){
 
 }
 
-void triggerWithImpact(TESDataStream* const stream,TESGeneralParameters * par,
+/** Trigger on the impacts of the given source between 'tstart' and
+    'tstop'. The stream starts at 'tstartTES'. */
+static void triggerWithImpactSource(TESDataStream* const stream,TESGeneralParameters * par,
 		TESInitStruct* init,float monoen,ReconstructInit* reconstruct_init,int event_list_size,
-		const char identify,int* const status){
+		const char identify,PixImpactSource* source,double tstart,double tstop,
+		double tstartTES,int* const status){
 
 	//Get parameters from structures
-	char* const impactlist = par->PixImpList;
-	double tstart = init->tstart;
-	double tstop = init->tstop;
 	const int triggerSize = par->triggerSize;
 	const int preBufferSize = par->preBufferSize;
 	const double sampleFreq = init->det->SampleFreq;
@@ -173,40 +173,6 @@ void triggerWithImpact(TESDataStream* const stream,TESGeneralParameters * par,
 		allocateTesEventListTrigger(event_list,event_list_size,status);
 		CHECK_STATUS_VOID(*status);
 	}
-	////////////////////////////////
-	//Open Impact file
-	////////////////////////////////
-	PixImpFile* impfile=openPixImpFile(impactlist, READONLY, status);
-	CHECK_STATUS_VOID(*status);
-	double tstartImp=0;
-	double tstopImp=0;
-	char comment[MAXMSG];
-	fits_read_key(impfile->fptr, TDOUBLE, "TSTART", &tstartImp, comment, status);
-	fits_read_key(impfile->fptr, TDOUBLE, "TSTOP", &tstopImp, comment, status);
-	CHECK_STATUS_VOID(*status);
-
-	//Check if tstart/tstop are compatible with pix impact file and correct if necessary
-	double tstartTES = tstart;
-	printf("Pix impact file reaches from %lfs-%lfs .\n", tstartImp, tstopImp);
-	if(tstartImp>tstart){
-		if(tstartImp>tstop){
-			SIXT_ERROR("Impact file tstart is larger than end of TES ADC data -> abort");
-			*status=EXIT_FAILURE;
-			CHECK_STATUS_VOID(*status);
-		}
-		puts("Impact file tstart is larger than in TES ADC data.");
-		tstart=tstartImp;
-	}
-	if(tstopImp<tstop){
-		if(tstopImp<tstart){
-			SIXT_ERROR("Impact file tstop is smaller than start of TES ADC data -> abort");
-			*status=EXIT_FAILURE;
-			CHECK_STATUS_VOID(*status);
-		}
-		puts("Impact file tstop is smaller than in TES ADC data.");
-		tstop=tstopImp;
-	}
-	printf("Simulate from %lfs-%lfs .\n", tstart, tstop);
 
 
 
@@ -267,7 +233,7 @@ void triggerWithImpact(TESDataStream* const stream,TESGeneralParameters * par,
 		/* Get first pulse in correct time frame from the impact file */
 		if (tstep==0) {
 			do {
-				piximpstatus=getNextImpactFromPixImpFile(impfile,&impact,status);
+				piximpstatus=getNextImpactFromSource(source,&impact,status);
 				CHECK_STATUS_VOID(*status);
 			} while((impact.time<tstart) && piximpstatus );
 		}
@@ -300,7 +266,7 @@ void triggerWithImpact(TESDataStream* const stream,TESGeneralParameters * par,
 				numberSimulated[impact.pixID-pixlow]++;
 			}
 			CHECK_STATUS_VOID(*status);
-			piximpstatus=getNextImpactFromPixImpFile(impfile,&impact,status);
+			piximpstatus=getNextImpactFromSource(source,&impact,status);
 			CHECK_STATUS_VOID(*status);
 		}
 
@@ -370,20 +336,20 @@ void triggerWithImpact(TESDataStream* const stream,TESGeneralParameters * par,
 	//If there is no trigger, print WARNING. Still compute numberSimulated.
 	if (nRecords==0) {
 		puts("WARNING: No trigger found. Check in impact file that there does exist an event inside the simulation time in the given pixels");
-		//Reinitialize impfile
-		impfile->row=0;
+		//Reinitialize impact source
+		rewindPixImpactSource(source);
 		//Get first impact after tstart
 		do {
-			piximpstatus=getNextImpactFromPixImpFile(impfile,&impact,status);
+			piximpstatus=getNextImpactFromSource(source,&impact,status);
 			CHECK_STATUS_VOID(*status);
-		} while(impact.time<tstart);
+		} while((impact.time<tstart) && piximpstatus);
 
 		//Iterate over the impacts
 		while ((piximpstatus>0) && (impact.time<tstop)){
 			if ((impact.pixID>=pixlow) && (impact.pixID<(pixlow+Npix))){
 				numberSimulated[impact.pixID-pixlow]++;
 			}
-			piximpstatus=getNextImpactFromPixImpFile(impfile,&impact,status);
+			piximpstatus=getNextImpactFromSource(source,&impact,status);
 			CHECK_STATUS_VOID(*status);
 		}
 	}
@@ -393,6 +359,8 @@ void triggerWithImpact(TESDataStream* const stream,TESGeneralParameters * par,
 	int lastpix = pixlow+Npix;
 	int numberpix = Npix;
 	if(par->WriteRecordFile){
+		flushTesTriggerFile(init->record_file,status);
+		CHECK_STATUS_VOID(*status);
 		saveTriggerKeywords(init->record_file->fptr,firstpix,lastpix,numberpix,monoen,
 				numberSimulated,numberTrigger,status);
 	}
@@ -401,8 +369,9 @@ void triggerWithImpact(TESDataStream* const stream,TESGeneralParameters * par,
 				numberSimulated,numberTrigger,status);
 	}
 
+	SIXT_PROF_COUNT(SIXT_PROF_RECORDS,nRecords);
+
 	//Free memory
-	freePixImpFile(&impfile, status);
 	free(numberSimulated);
 	free(numberTrigger);
 	free(positionInTrigger);
@@ -421,3 +390,66 @@ void triggerWithImpact(TESDataStream* const stream,TESGeneralParameters * par,
 	freeSixtStdKeywords(keywords);
 
 }
+
+void triggerWithImpact(TESDataStream* const stream,TESGeneralParameters * par,
+		TESInitStruct* init,float monoen,ReconstructInit* reconstruct_init,int event_list_size,
+		const char identify,int* const status){
+
+	//Get parameters from structures
+	char* const impactlist = par->PixImpList;
+	double tstart = init->tstart;
+	double tstop = init->tstop;
+
+	////////////////////////////////
+	//Open Impact file
+	////////////////////////////////
+	PixImpFile* impfile=openPixImpFile(impactlist, READONLY, status);
+	CHECK_STATUS_VOID(*status);
+	double tstartImp=0;
+	double tstopImp=0;
+	char comment[MAXMSG];
+	fits_read_key(impfile->fptr, TDOUBLE, "TSTART", &tstartImp, comment, status);
+	fits_read_key(impfile->fptr, TDOUBLE, "TSTOP", &tstopImp, comment, status);
+	CHECK_STATUS_VOID(*status);
+
+	//Check if tstart/tstop are compatible with pix impact file and correct if necessary
+	double tstartTES = tstart;
+	printf("Pix impact file reaches from %lfs-%lfs .\n", tstartImp, tstopImp);
+	if(tstartImp>tstart){
+		if(tstartImp>tstop){
+			SIXT_ERROR("Impact file tstart is larger than end of TES ADC data -> abort");
+			*status=EXIT_FAILURE;
+			CHECK_STATUS_VOID(*status);
+		}
+		puts("Impact file tstart is larger than in TES ADC data.");
+		tstart=tstartImp;
+	}
+	if(tstopImp<tstop){
+		if(tstopImp<tstart){
+			SIXT_ERROR("Impact file tstop is smaller than start of TES ADC data -> abort");
+			*status=EXIT_FAILURE;
+			CHECK_STATUS_VOID(*status);
+		}
+		puts("Impact file tstop is smaller than in TES ADC data.");
+		tstop=tstopImp;
+	}
+	printf("Simulate from %lfs-%lfs .\n", tstart, tstop);
+
+	PixImpactSource source={impfile, NULL, 0, 0, NULL};
+	SIXT_PROF_BEGIN(SIXT_PROF_TRIGGER);
+	triggerWithImpactSource(stream,par,init,monoen,reconstruct_init,event_list_size,
+			identify,&source,tstart,tstop,tstartTES,status);
+	SIXT_PROF_END(SIXT_PROF_TRIGGER);
+	freePixImpFile(&impfile, status);
+}
+
+void triggerWithImpactList(TESDataStream* const stream,TESGeneralParameters * par,
+		TESInitStruct* init,float monoen,ReconstructInit* reconstruct_init,int event_list_size,
+		const char identify,const PixImpact* impacts,long nimpacts,double tstart,double tstop,
+		int* const status){
+	PixImpactSource source={NULL, impacts, nimpacts, 0, NULL};
+	SIXT_PROF_BEGIN(SIXT_PROF_TRIGGER);
+	triggerWithImpactSource(stream,par,init,monoen,reconstruct_init,event_list_size,
+			identify,&source,tstart,tstop,tstart,status);
+	SIXT_PROF_END(SIXT_PROF_TRIGGER);
+}
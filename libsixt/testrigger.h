@@ -25,6 +25,7 @@
 
 #include "testriggerfile.h"
 #include "tesinitialization.h"
+#include "profiling.h"
 
 /** Save pixels, NES/NET and monoen keywords to the given FITS file */
 void saveTriggerKeywords(fitsfile* fptr,int firstpix,int lastpix,int numberpix,float monoen,
@@ -38,4 +39,13 @@ void triggerWithImpact(TESDataStream* const stream,TESGeneralParameters * par,
 		TESInitStruct* init,float monoen,ReconstructInit* reconstruct_init,int event_list_size,
 		const char identify,int* const status);
 
+/** Same as triggerWithImpact, but with the impacts (sorted by time)
+    taken from an array instead of the PixImpList file and the stream
+    starting at 'tstart'. Only the impacts between 'tstart' and
+    'tstop' are considered. */
+void triggerWithImpactList(TESDataStream* const stream,TESGeneralParameters * par,
+		TESInitStruct* init,float monoen,ReconstructInit* reconstruct_init,int event_list_size,
+		const char identify,const PixImpact* impacts,long nimpacts,double tstart,double tstop,
+		int* const status);
+
 #endif /* TESTRIGGER_H */
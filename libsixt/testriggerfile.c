@@ -32,6 +32,7 @@ TesTriggerFile* newTesTriggerFile(unsigned long triggerSize,int write_doubles, i
 
   // Initialize pointers with NULL.
   file->fptr    =NULL;
+  file->writer  =NULL;
 
   // Initialize values.
   file->nrows	     =0;
@@ -51,6 +52,13 @@ TesTriggerFile* newTesTriggerFile(unsigned long triggerSize,int write_doubles, i
 /** Destructor. */
 void freeTesTriggerFile(TesTriggerFile** const file, int* const status){
   if (NULL!=*file) {
+    // Write the remaining records, even if an error occurred before.
+    int flush_status=EXIT_SUCCESS;
+    destroyFitsWriter(&(*file)->writer, &flush_status);
+    if (EXIT_SUCCESS==*status) {
+      *status=flush_status;
+    }
+
     if (NULL!=(*file)->fptr) {
       // delete superfluous rows
       if ((*file)->rowbuffer!=0){
@@ -305,8 +313,104 @@ int getNextRecord(TesTriggerFile* const file,TesRecord* record,int* const status
 
 }
 
+/** Record as it is kept by the writer: followed by the ADC values
+    and the PH_IDs */
+typedef struct{
+	double time;
+	long pixid;
+	unsigned long nadc;
+	long nphid;
+}TesTriggerRow;
+
+/** Offset of the PH_IDs behind the TesTriggerRow */
+static size_t getTriggerRowPhIDOffset(unsigned long nadc,int write_doubles){
+	size_t adcsize=nadc*(write_doubles ? sizeof(double) : sizeof(uint16_t));
+	return(sizeof(TesTriggerRow)+(adcsize+sizeof(long)-1)/sizeof(long)*sizeof(long));
+}
+
+/** FitsWriterFct for the blocks of records. Rows are reserved in the
+    table and written in the same way as by writeRecord(), but for
+    all records of the block at once (except for the variable-length
+    PH_ID column, whose heap is filled in the order of the rows). */
+static void writeRecordBlock(fitsfile* const fptr,const long firstrow,const long nrows,
+		void* const* const rows,void* const data,int* const status){
+	TesTriggerFile* file=(TesTriggerFile*)data;
+	const int datatype=(file->write_doubles ? TDOUBLE : TUSHORT);
+	const size_t adcsize=(file->write_doubles ? sizeof(double) : sizeof(uint16_t));
+
+	// Reserve the rows
+	int fullsize=1;
+	for (long ii=0; ii<nrows; ii++){
+		if (file->rowbuffer==0){
+			file->rowbuffer = (long) file->nrows/2;
+			fits_insert_rows(fptr, file->nrows, file->rowbuffer, status);
+		}
+		file->rowbuffer--;
+		file->nrows++;
+		file->row++;
+		if (((const TesTriggerRow*)rows[ii])->nadc!=file->trigger_size){
+			fullsize=0;
+		}
+	}
+	CHECK_STATUS_VOID(*status);
+
+	// Scratch memory for the values of all rows of one column
+	void* scratch=malloc(nrows*MAX(file->trigger_size*adcsize,sizeof(double)));
+	CHECK_MALLOC_VOID_STATUS(scratch,*status);
+	double* dbuffer=(double*)scratch;
+	long* lbuffer=(long*)scratch;
+	for (long ii=0; ii<nrows; ii++) dbuffer[ii]=((const TesTriggerRow*)rows[ii])->time;
+	fits_write_col(fptr, TDOUBLE, file->timeCol, firstrow, 1, nrows, dbuffer, status);
+	for (long ii=0; ii<nrows; ii++) lbuffer[ii]=((const TesTriggerRow*)rows[ii])->pixid;
+	fits_write_col(fptr, TLONG, file->pixIDCol, firstrow, 1, nrows, lbuffer, status);
+
+	if (fullsize){
+		char* cbuffer=(char*)scratch;
+		for (long ii=0; ii<nrows; ii++){
+			memcpy(cbuffer+ii*file->trigger_size*adcsize,(const char*)rows[ii]+sizeof(TesTriggerRow),
+					file->trigger_size*adcsize);
+		}
+		fits_write_col(fptr, datatype, file->trigCol, firstrow, 1, nrows*file->trigger_size,
+				cbuffer, status);
+	} else {
+		for (long ii=0; ii<nrows; ii++){
+			const TesTriggerRow* row=(const TesTriggerRow*)rows[ii];
+			fits_write_col(fptr, datatype, file->trigCol, firstrow+ii, 1, row->nadc,
+					(char*)rows[ii]+sizeof(TesTriggerRow), status);
+		}
+	}
+
+	free(scratch);
+
+	for (long ii=0; ii<nrows; ii++){
+		const TesTriggerRow* row=(const TesTriggerRow*)rows[ii];
+		fits_write_col(fptr, TLONG, file->ph_idCol, firstrow+ii, 1, row->nphid,
+				(char*)rows[ii]+getTriggerRowPhIDOffset(row->nadc,file->write_doubles), status);
+	}
+}
+
 /** Writes a record to a file */
 void writeRecord(TesTriggerFile* outputFile,TesRecord* record,int* const status){
+        SIXT_PROF_COUNT(SIXT_PROF_ROWS_WRITTEN, 1);
+        if (NULL!=outputFile->writer){
+                size_t adcsize=(outputFile->write_doubles ? sizeof(double) : sizeof(uint16_t));
+                size_t phidoffset=getTriggerRowPhIDOffset(record->trigger_size,outputFile->write_doubles);
+                char* row=(char*)addFitsWriterRow(outputFile->writer,
+                    phidoffset+record->phid_list->index*sizeof(long),status);
+                CHECK_STATUS_VOID(*status);
+                TesTriggerRow* header=(TesTriggerRow*)row;
+                header->time=record->time;
+                header->pixid=record->pixid;
+                header->nadc=record->trigger_size;
+                header->nphid=record->phid_list->index;
+                memcpy(row+sizeof(TesTriggerRow),
+                       (outputFile->write_doubles ? (void*)record->adc_double : (void*)record->adc_array),
+                       record->trigger_size*adcsize);
+                memcpy(row+phidoffset,record->phid_list->phid_array,
+                       record->phid_list->index*sizeof(long));
+                return;
+        }
+
         // if we've run out of buffer, extend the table
         if (outputFile->rowbuffer==0){
                 // extend to 1.5 of previous length
@@ -333,3 +437,47 @@ void writeRecord(TesTriggerFile* outputFile,TesRecord* record,int* const status)
 	outputFile->nrows++;
 	outputFile->row++;
 }
+
+/** Write the records in blocks */
+void startTesTriggerFileWriter(TesTriggerFile* file,int threaded,int* const status){
+	CHECK_STATUS_VOID(*status);
+	CHECK_NULL_VOID(file,*status,"no trigger file opened");
+	CHECK_NULL_VOID(file->fptr,*status,"no trigger file opened");
+	if (NULL!=file->writer){
+		return;
+	}
+
+	file->writer=newFitsWriter(file->fptr,file->row,
+			getTriggerRowPhIDOffset(file->trigger_size,file->write_doubles),
+			TESTRIGGERFILE_BLOCKSIZE,TESTRIGGERFILE_WRITERBLOCKS,
+			getFitsWriterThreading(threaded),writeRecordBlock,file,status);
+}
+
+/** Pool for the writers of several trigger files */
+FitsWriterPool* newTesTriggerFileWriterPool(unsigned long triggerSize,int write_doubles,
+		int threaded,int* const status){
+	CHECK_STATUS_RET(*status,NULL);
+	return(newFitsWriterPool(getTriggerRowPhIDOffset(triggerSize,write_doubles),
+			TESTRIGGERFILE_BLOCKSIZE,TESTRIGGERFILE_WRITERBLOCKS,
+			getFitsWriterThreading(threaded),status));
+}
+
+/** Write the records in blocks of a shared pool */
+void startTesTriggerFileSharedWriter(TesTriggerFile* file,FitsWriterPool* pool,int* const status){
+	CHECK_STATUS_VOID(*status);
+	CHECK_NULL_VOID(file,*status,"no trigger file opened");
+	CHECK_NULL_VOID(file->fptr,*status,"no trigger file opened");
+	if (NULL!=file->writer){
+		return;
+	}
+
+	file->writer=newSharedFitsWriter(pool,file->fptr,file->row,
+			writeRecordBlock,file,status);
+}
+
+/** Writes all records to the file */
+void flushTesTriggerFile(TesTriggerFile* file,int* const status){
+	if (NULL!=file){
+		flushFitsWriter(file->writer,status);
+	}
+}
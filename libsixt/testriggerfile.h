@@ -24,6 +24,8 @@
 #define TESTRIGGERFILE_H 1
 
 #include "sixt.h"
+#include "profiling.h"
+#include "fitswriter.h"
 #include "tesdatastream.h"
 #include "pixelimpactfile.h"
 #include "tesrecord.h"
@@ -63,10 +65,18 @@ typedef struct{
 	/** Option to write the records in doubles */
 	int write_doubles;
 
+	/** Writer for the records (NULL if they are written directly),
+	    see startTesTriggerFileWriter(). While it is active, the
+	    row counters are updated by the writer. */
+	FitsWriter* writer;
+
 }TesTriggerFile;
 
 #define TESTRIGGERFILE_ROWBUFFERSIZE 100 // initial default value of rowbuffer
 
+#define TESTRIGGERFILE_BLOCKSIZE 64 // records per block of the writer
+#define TESTRIGGERFILE_WRITERBLOCKS 4 // blocks that can be queued for the writer
+
 ////////////////////////////////////////////////////////////////////////
 // Function declarations.
 ////////////////////////////////////////////////////////////////////////
@@ -100,4 +110,26 @@ int getNextRecord(TesTriggerFile* const file,TesRecord* record,int* const status
 /** Writes a record to a file */
 void writeRecord(TesTriggerFile* outputFile,TesRecord* record,int* const status);
 
+/** Write the records in blocks of TESTRIGGERFILE_BLOCKSIZE rows, by a
+    background thread if 'threaded' is non-zero and CFITSIO is
+    thread-safe. The FITS file must not be accessed directly (via
+    'fptr') afterwards without calling flushTesTriggerFile() before. */
+void startTesTriggerFileWriter(TesTriggerFile* file,int threaded,int* const status);
+
+/** Create a pool of blocks for the writers of several trigger files
+    with records of 'triggerSize' ADC values, see
+    startTesTriggerFileSharedWriter(). The pool has to be destroyed
+    (destroyFitsWriterPool()) after all of its files. */
+FitsWriterPool* newTesTriggerFileWriterPool(unsigned long triggerSize,int write_doubles,
+		int threaded,int* const status);
+
+/** Like startTesTriggerFileWriter(), but the records are written in
+    the blocks and by the thread of the given pool, which is shared
+    with other trigger files. Flushing the file writes the records of
+    all of these files. */
+void startTesTriggerFileSharedWriter(TesTriggerFile* file,FitsWriterPool* pool,int* const status);
+
+/** Writes all records to the file, which have been passed to writeRecord() */
+void flushTesTriggerFile(TesTriggerFile* file,int* const status);
+
 #endif /* TESTRIGGERFILE_H */
@@ -23,6 +23,100 @@
 #include "vignetting.h"
 
 
+/** Maximum number of cells of a grid index per grid point. */
+#define VIGN_CELLS_PER_POINT (16)
+
+
+/** Cell of the grid index containing the given value (values outside
+    the grid are assigned to the first or last cell). */
+static inline int getGridCell(const VignettingGridIndex* const index,
+			      const float value)
+{
+  double x=(value-index->min)*index->scale;
+  if (!(x>0.)) {
+    return(0);
+  }
+  if (x>=index->ncells) {
+    return(index->ncells-1);
+  }
+  return((int)x);
+}
+
+
+/** Set up the index of a monotonically increasing grid. The cell
+    width is chosen as the minimum distance between two grid points,
+    such that uniform grids have at most one grid point per cell. */
+static void setGridIndex(VignettingGridIndex* const index,
+			 const float* const grid, const int n,
+			 int* const status)
+{
+  if (NULL!=index->first) {
+    free(index->first);
+    index->first=NULL;
+  }
+
+  double range=grid[n-1]-grid[0];
+  double min_spacing=range;
+  int ii;
+  for (ii=1; ii<n; ii++) {
+    double spacing=grid[ii]-grid[ii-1];
+    if ((spacing>0.) && (spacing<min_spacing)) {
+      min_spacing=spacing;
+    }
+  }
+
+  index->ncells=1;
+  if (range>0.) {
+    double ncells=ceil(range/min_spacing);
+    if (ncells>VIGN_CELLS_PER_POINT*(double)n) {
+      ncells=VIGN_CELLS_PER_POINT*(double)n;
+    }
+    index->ncells=(int)ncells;
+  }
+  index->min=grid[0];
+  index->scale=(range>0.) ? index->ncells/range : 0.;
+
+  index->first=(int*)malloc(index->ncells*sizeof(int));
+  CHECK_NULL_VOID(index->first, *status,
+		  "could not allocate memory for the vignetting lookup table");
+
+  // The cell of the grid points increases monotonically with their
+  // value, so all grid points before first[cell] are below any value
+  // in the cell.
+  int cell;
+  ii=0;
+  for (cell=0; cell<index->ncells; cell++) {
+    while ((ii<n) && (getGridCell(index, grid[ii])<cell)) {
+      ii++;
+    }
+    index->first[cell]=ii;
+  }
+}
+
+
+void setVignettingLookup(Vignetting* const vi, int* const status)
+{
+  if (NULL!=vi->vignet0) {
+    free(vi->vignet0);
+  }
+  vi->vignet0=(float*)malloc(vi->nenergies*vi->ntheta*sizeof(float));
+  CHECK_NULL_VOID(vi->vignet0, *status,
+		  "could not allocate memory for the vignetting lookup table");
+
+  int ii, jj;
+  for (ii=0; ii<vi->nenergies; ii++) {
+    for (jj=0; jj<vi->ntheta; jj++) {
+      vi->vignet0[ii*vi->ntheta+jj]=vi->vignet[ii][jj][0];
+    }
+  }
+
+  setGridIndex(&vi->energy_index, vi->energy, vi->nenergies, status);
+  CHECK_STATUS_VOID(*status);
+  setGridIndex(&vi->theta_index, vi->theta, vi->ntheta, status);
+  CHECK_STATUS_VOID(*status);
+}
+
+
 Vignetting* newVignetting(const char* const filename, int* const status)
 {
   Vignetting* vignetting=NULL;
@@ -38,6 +132,9 @@ Vignetting* newVignetting(const char* const filename, int* const status)
       SIXT_ERROR("could not allocate memory for storing the vignetting data");
       break;
     }
+    vignetting->vignet0=NULL;
+    vignetting->energy_index.first=NULL;
+    vignetting->theta_index.first=NULL;
 
 
     // Open the FITS file for reading the vignetting function.
@@ -233,6 +330,10 @@ Vignetting* newVignetting(const char* const filename, int* const status)
     	}
     }
 
+    // Lookup tables for the interpolation.
+    setVignettingLookup(vignetting, status);
+    CHECK_STATUS_BREAK(*status);
+
 
 
   } while(0); // END of Error handling loop
@@ -272,6 +373,9 @@ void destroyVignetting(Vignetting** const vi) {
       }
       free((*vi)->vignet);
     }
+    if (NULL!=(*vi)->vignet0) free((*vi)->vignet0);
+    if (NULL!=(*vi)->energy_index.first) free((*vi)->energy_index.first);
+    if (NULL!=(*vi)->theta_index.first)  free((*vi)->theta_index.first);
     free((*vi));
     *vi=NULL;
   }
@@ -279,27 +383,37 @@ void destroyVignetting(Vignetting** const vi) {
 
 
 // At the moment SIXTE can only handle the cases without phi dependece phi = 0.
-static float interpol_vign_theta(const float theta, const float* arr_theta, float** arr_vign, const int ntheta){
+static inline float interpol_vign_theta(const Vignetting* const vi,
+					const float theta,
+					const float* const vign){
 
+	const float* const arr_theta=vi->theta;
+	const int ntheta=vi->ntheta;
 
 	// Check if the required angle is larger than the biggest in the
 	// vignetting data.
 	if (theta>=arr_theta[ntheta-1]) {
-		return(arr_vign[ntheta-1][0]);
+		return(vign[ntheta-1]);
+	}
+	if (ntheta<2) {
+		return 1.;
 	}
 
 	// Find the two values in the vignetting data surrounding
-	// the required angle.
-	int jj;
-	for(jj=1; jj<ntheta; jj++) {
-		if (arr_theta[jj]>=theta) {
-			// Interpolate between both values.
-			return(arr_vign[jj-1][0]+
-					(arr_vign[jj][0]-arr_vign[jj-1][0])*
-					(theta-arr_theta[jj-1])/(arr_theta[jj]-arr_theta[jj-1]));
-		}
+	// the required angle, starting at the first grid point of the
+	// cell of the index containing the angle.
+	int jj=vi->theta_index.first[getGridCell(&vi->theta_index, theta)];
+	if (jj<1) {
+		jj=1;
+	}
+	while (arr_theta[jj]<theta) {
+		jj++;
 	}
-	return 1.;
+
+	// Interpolate between both values.
+	return(vign[jj-1]+
+			(vign[jj]-vign[jj-1])*
+			(theta-arr_theta[jj-1])/(arr_theta[jj]-arr_theta[jj-1]));
 }
 
 float get_Vignetting_Factor(const Vignetting* const vi, const float energy,
@@ -322,19 +436,24 @@ float get_Vignetting_Factor(const Vignetting* const vi, const float energy,
   /* if we are above or below the defined energies, we return the vignetting
    * value at the edge of the grid  */
   if (energy<=vi->Emin){
-	  return interpol_vign_theta(theta, vi->theta, vi->vignet[0], vi->ntheta);
+	  return interpol_vign_theta(vi, theta, vi->vignet0);
   }
   if (energy>=vi->Emax){
-	  return interpol_vign_theta(theta, vi->theta, vi->vignet[vi->nenergies-1], vi->ntheta);
+	  return interpol_vign_theta(vi, theta, &vi->vignet0[(vi->nenergies-1)*vi->ntheta]);
   }
 
-  // Find the right energy bin.
-  int ind = binary_search_float(energy,vi->energy,vi->nenergies );
+  // Find the right energy bin (the last energy below or equal to
+  // the required one).
+  int ind=vi->energy_index.first[getGridCell(&vi->energy_index, energy)];
+  while (vi->energy[ind]<=energy) {
+	  ind++;
+  }
+  ind--;
 
   double vign_val[2];
   // assume linear interpolation
-  vign_val[0] = interpol_vign_theta(theta, vi->theta, vi->vignet[ind], vi->ntheta);
-  vign_val[1] = interpol_vign_theta(theta, vi->theta, vi->vignet[ind+1], vi->ntheta);
+  vign_val[0] = interpol_vign_theta(vi, theta, &vi->vignet0[ind*vi->ntheta]);
+  vign_val[1] = interpol_vign_theta(vi, theta, &vi->vignet0[(ind+1)*vi->ntheta]);
 
 
   double ifac = (energy-vi->energy[ind]) / ( vi->energy[ind+1] - vi->energy[ind] );
@@ -342,3 +461,17 @@ float get_Vignetting_Factor(const Vignetting* const vi, const float energy,
   return interp_lin_1d(ifac, vign_val[0], vign_val[1]);
 
 }
+
+void get_Vignetting_Factors(const Vignetting* const vi,
+			    const long n,
+			    const float* const energy,
+			    const float* const theta,
+			    const float* const phi,
+			    float* const factor)
+{
+  long ii;
+  for (ii=0; ii<n; ii++) {
+    factor[ii]=get_Vignetting_Factor(vi, energy[ii], theta[ii],
+				     (NULL==phi) ? 0. : phi[ii]);
+  }
+}
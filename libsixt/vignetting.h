@@ -31,6 +31,20 @@
 ////////////////////////////////////////////////////////////////////////
 
 
+/** Index of the bins of a monotonically increasing grid. The range of
+    the grid is divided into cells of equal width, such that the bin
+    of a value is found from the first grid point in its cell with a
+    number of comparisons that does not depend on the grid size. */
+typedef struct {
+  /** Number of cells. */
+  int ncells;
+  /** Lower boundary of the first cell and number of cells per unit. */
+  double min, scale;
+  /** Index of the first grid point lying in or above each cell. */
+  int* first;
+} VignettingGridIndex;
+
+
 /** Data structure containing the mirror vignetting function. */
 typedef struct {
   /** Number of energy bins. */
@@ -54,6 +68,12 @@ typedef struct {
   /** Maximum available energy [keV]. */
   float Emax;
 
+  /** Vignetting data at phi=0 as contiguous array
+      [energy*ntheta+theta], and indices of the energy and off-axis
+      angle grids (see setVignettingLookup()). */
+  float* vignet0;
+  VignettingGridIndex energy_index, theta_index;
+
 } Vignetting;
 
 
@@ -67,6 +87,11 @@ typedef struct {
     FITS file is defined by OGIP Memo CAL/GEN/92-021. */
 Vignetting* newVignetting(const char* const filename, int* const status);
 
+/** Prepare the lookup tables of the vignetting function, which are
+    used by get_Vignetting_Factor(). This is done by newVignetting()
+    and has to be repeated if the grids or the data are modified. */
+void setVignettingLookup(Vignetting* const vi, int* const status);
+
 /** Destructor for Vignetting data structure. */
 void destroyVignetting(Vignetting** const vi);
 
@@ -81,5 +106,15 @@ float get_Vignetting_Factor(const Vignetting* const vi,
 			    const float theta,
 			    const float phi);
 
+/** Determine the Vignetting factors for the n photons with the given
+    energies, off-axis angles, and azimuth angles (batch version of
+    get_Vignetting_Factor()). The azimuth angles may be NULL. */
+void get_Vignetting_Factors(const Vignetting* const vi,
+			    const long n,
+			    const float* const energy,
+			    const float* const theta,
+			    const float* const phi,
+			    float* const factor);
+
 
 #endif /* VIGNETTING_H */
@@ -0,0 +1,527 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                  Erlangen-Nuernberg
+*/
+
+
+#include "visibility.h"
+
+
+/** Maximum number of iterations for the determination of the
+    boundaries of a visibility interval. */
+#define VISIBILITY_MAX_ITER (100)
+
+/** Additional search radius ([rad]) to make sure that rounding
+    errors do not exclude sources at the boundary of the search
+    cone. */
+#define VISIBILITY_MARGIN (1.e-9)
+
+
+/** Right ascension ([rad], 0..2pi) and declination ([rad]) of a unit
+    vector. */
+static void getSkyPosition(const Vector* const v,
+			   double* const ra, double* const dec)
+{
+  *ra=atan2(v->y, v->x);
+  if (*ra<0.) {
+    *ra+=2.*M_PI;
+  }
+  *dec=asin(MAX(-1., MIN(1., v->z)));
+}
+
+/** Declination band of the index. */
+static int getSkyBand(const SkyIndex* const idx, const double dec)
+{
+  int band=(int)((dec+0.5*M_PI)/idx->bandwidth);
+  return(MAX(0, MIN(idx->nbands-1, band)));
+}
+
+
+typedef struct {
+  int band;
+  double ra;
+  long index;
+} SkyIndexEntry;
+
+static int compareSkyIndexEntries(const void* a, const void* b)
+{
+  const SkyIndexEntry* ea=(const SkyIndexEntry*)a;
+  const SkyIndexEntry* eb=(const SkyIndexEntry*)b;
+  if (ea->band!=eb->band) {
+    return(ea->band<eb->band ? -1 : 1);
+  }
+  if (ea->ra!=eb->ra) {
+    return(ea->ra<eb->ra ? -1 : 1);
+  }
+  return((ea->index>eb->index)-(ea->index<eb->index));
+}
+
+
+SkyIndex* newSkyIndex(const Vector* const dir,
+		      const long ndirs,
+		      const double bandwidth,
+		      int* const status)
+{
+  SkyIndex* idx=(SkyIndex*)malloc(sizeof(SkyIndex));
+  CHECK_NULL_RET(idx, *status, "memory allocation for SkyIndex failed", idx);
+
+  idx->ndirs=ndirs;
+  idx->nbands=MAX(1, MIN(100000, (int)ceil(M_PI/MAX(bandwidth, 1.e-9))));
+  idx->bandwidth=M_PI/idx->nbands;
+  idx->first=(long*)calloc(idx->nbands+1, sizeof(long));
+  idx->dir=(Vector*)malloc(MAX(ndirs, 1)*sizeof(Vector));
+  idx->ra=(double*)malloc(MAX(ndirs, 1)*sizeof(double));
+  idx->index=(long*)malloc(MAX(ndirs, 1)*sizeof(long));
+  SkyIndexEntry* entries=(SkyIndexEntry*)malloc(MAX(ndirs, 1)*sizeof(SkyIndexEntry));
+  if ((NULL==idx->first)||(NULL==idx->dir)||(NULL==idx->ra)||
+      (NULL==idx->index)||(NULL==entries)) {
+    *status=EXIT_FAILURE;
+    SIXT_ERROR("memory allocation for SkyIndex failed");
+    if (NULL!=entries) free(entries);
+    return(idx);
+  }
+
+  // Sort the directions by declination band and right ascension.
+  long ii;
+  for (ii=0; ii<ndirs; ii++) {
+    double dec;
+    getSkyPosition(&dir[ii], &entries[ii].ra, &dec);
+    entries[ii].band=getSkyBand(idx, dec);
+    entries[ii].index=ii;
+  }
+  qsort(entries, ndirs, sizeof(SkyIndexEntry), compareSkyIndexEntries);
+
+  for (ii=0; ii<ndirs; ii++) {
+    idx->dir[ii]  =dir[entries[ii].index];
+    idx->ra[ii]   =entries[ii].ra;
+    idx->index[ii]=entries[ii].index;
+    idx->first[entries[ii].band+1]++;
+  }
+  int band;
+  for (band=0; band<idx->nbands; band++) {
+    idx->first[band+1]+=idx->first[band];
+  }
+  free(entries);
+
+  return(idx);
+}
+
+
+void freeSkyIndex(SkyIndex** const idx)
+{
+  if (NULL!=*idx) {
+    if (NULL!=(*idx)->first) {
+      free((*idx)->first);
+    }
+    if (NULL!=(*idx)->dir) {
+      free((*idx)->dir);
+    }
+    if (NULL!=(*idx)->ra) {
+      free((*idx)->ra);
+    }
+    if (NULL!=(*idx)->index) {
+      free((*idx)->index);
+    }
+    free(*idx);
+    *idx=NULL;
+  }
+}
+
+
+/** Check the directions of the index in the range first..last-1 and
+    append those within the search cone to the list. */
+static long checkSkyRange(const SkyIndex* const idx,
+			  const long first, const long last,
+			  const Vector* const ref,
+			  const double min_align,
+			  long* const list,
+			  long nfound)
+{
+  long ii;
+  for (ii=first; ii<last; ii++) {
+    if (scalar_product(&idx->dir[ii], ref)>=min_align) {
+      list[nfound++]=idx->index[ii];
+    }
+  }
+  return(nfound);
+}
+
+/** First position in the band range first..last-1 with a right
+    ascension not smaller than ra. */
+static long lowerSkyBound(const SkyIndex* const idx,
+			  long first, long last,
+			  const double ra)
+{
+  while (first<last) {
+    long middle=first+(last-first)/2;
+    if (idx->ra[middle]<ra) {
+      first=middle+1;
+    } else {
+      last=middle;
+    }
+  }
+  return(first);
+}
+
+
+long querySkyIndex(const SkyIndex* const idx,
+		   const Vector* const ref,
+		   const double radius,
+		   long* const list)
+{
+  const double min_align=cos(MIN(radius, M_PI));
+
+  double ra0, dec0;
+  getSkyPosition(ref, &ra0, &dec0);
+
+  // Half width of the search cone in right ascension. If the cone
+  // contains one of the poles, all right ascensions have to be
+  // checked.
+  double dra=M_PI;
+  if (fabs(dec0)+radius<0.5*M_PI) {
+    dra=asin(MIN(1., sin(radius)/cos(dec0)));
+  }
+
+  long nfound=0;
+  int band;
+  const int band0=getSkyBand(idx, dec0-radius);
+  const int band1=getSkyBand(idx, dec0+radius);
+  for (band=band0; band<=band1; band++) {
+    const long first=idx->first[band], last=idx->first[band+1];
+    if (first==last) continue;
+
+    if (dra>=M_PI) {
+      nfound=checkSkyRange(idx, first, last, ref, min_align, list, nfound);
+      continue;
+    }
+
+    double ra_min=ra0-dra, ra_max=ra0+dra;
+    if (ra_min<0.) {
+      // The range wraps around at ra=0.
+      nfound=checkSkyRange(idx, lowerSkyBound(idx, first, last, ra_min+2.*M_PI),
+			   last, ref, min_align, list, nfound);
+      ra_min=0.;
+    }
+    if (ra_max>2.*M_PI) {
+      nfound=checkSkyRange(idx, first,
+			   lowerSkyBound(idx, first, last, ra_max-2.*M_PI),
+			   ref, min_align, list, nfound);
+      ra_max=2.*M_PI;
+    }
+    nfound=checkSkyRange(idx, lowerSkyBound(idx, first, last, ra_min),
+			 lowerSkyBound(idx, first, last, ra_max),
+			 ref, min_align, list, nfound);
+  }
+
+  return(nfound);
+}
+
+
+/** Angle between two unit vectors ([rad]). */
+static double getAngle(const Vector* const a, const Vector* const b)
+{
+  return(acos(MAX(-1., MIN(1., scalar_product(a, b)))));
+}
+
+/** Distance of the source from the boundary of its visibility range
+    at the given time in terms of the cosine of the angle to the
+    telescope pointing direction. The value is not negative if the
+    source is visible. */
+static double getVisibility(Attitude* const ac,
+			    const Vector* const dir,
+			    const double min_align,
+			    const double time,
+			    int* const status)
+{
+  Vector nz=getTelescopeNz(ac, time, status);
+  return(scalar_product(dir, &nz)-min_align);
+}
+
+/** Determine the time between t0 and t1, when the source enters or
+    leaves the visibility range, by root-finding on the visibility
+    function (Illinois variant of the regula falsi). f0 and f1 are the
+    values of the visibility function at t0 and t1 and must have
+    different signs. */
+static double findVisibilityEdge(Attitude* const ac,
+				 const Vector* const dir,
+				 const double min_align,
+				 double t0, double f0,
+				 double t1, double f1,
+				 const double accuracy,
+				 int* const status)
+{
+  const int visible1=(f1>=0.);
+  int side=0, iter;
+  for (iter=0; (iter<VISIBILITY_MAX_ITER)&&(t1-t0>accuracy); iter++) {
+    double t=(f0*t1-f1*t0)/(f0-f1);
+    if (!((t>t0)&&(t<t1))) {
+      t=0.5*(t0+t1);
+    }
+    double f=getVisibility(ac, dir, min_align, t, status);
+    CHECK_STATUS_BREAK(*status);
+
+    if ((f>=0.)==visible1) {
+      t1=t;
+      f1=f;
+      if (-1==side) f0*=0.5;
+      side=-1;
+    } else {
+      t0=t;
+      f0=f;
+      if (1==side) f1*=0.5;
+      side=1;
+    }
+  }
+  return(0.5*(t0+t1));
+}
+
+/** Search the extremum of the visibility function between t0 and t1
+    by golden-section search, the maximum for a source that is not
+    visible at t0 and t1, and the minimum for a source that is. The
+    search is stopped as soon as a point of time with the opposite
+    visibility is found. The function returns this time or the
+    position of the extremum and stores the corresponding value of
+    the visibility function in fext. */
+static double findVisibilityExtremum(Attitude* const ac,
+				     const Vector* const dir,
+				     const double min_align,
+				     double t0, double t1,
+				     const int visible,
+				     const double accuracy,
+				     double* const fext,
+				     int* const status)
+{
+  const double ratio=0.5*(sqrt(5.)-1.);
+  const double sign=(0!=visible) ? -1. : 1.;
+  double ta=t1-ratio*(t1-t0), tb=t0+ratio*(t1-t0);
+  double fa=getVisibility(ac, dir, min_align, ta, status);
+  double fb=getVisibility(ac, dir, min_align, tb, status);
+  int iter;
+  for (iter=0; (iter<VISIBILITY_MAX_ITER)&&(t1-t0>accuracy); iter++) {
+    CHECK_STATUS_BREAK(*status);
+    if (((fa>=0.)!=visible)||((fb>=0.)!=visible)) break;
+
+    if (sign*fa>sign*fb) {
+      t1=tb;
+      tb=ta;
+      fb=fa;
+      ta=t1-ratio*(t1-t0);
+      fa=getVisibility(ac, dir, min_align, ta, status);
+    } else {
+      t0=ta;
+      ta=tb;
+      fa=fb;
+      tb=t0+ratio*(t1-t0);
+      fb=getVisibility(ac, dir, min_align, tb, status);
+    }
+  }
+
+  if (((fb>=0.)!=visible)||(sign*fb>sign*fa)) {
+    *fext=fb;
+    return(tb);
+  }
+  *fext=fa;
+  return(ta);
+}
+
+
+GTI** getVisibilityGTIs(Attitude* const ac,
+			const Vector* const dir,
+			const double* const radius,
+			const long ndirs,
+			const double tstart,
+			const double tstop,
+			const double dt,
+			const double accuracy,
+			int* const status)
+{
+  GTI** gtis=NULL;
+  SkyIndex* idx=NULL;
+  double* min_align=NULL;
+  char* visible=NULL;
+  double* start=NULL;
+  long* list=NULL;
+
+  do { // Error handling loop.
+
+    if (dt<=0.) {
+      *status=EXIT_FAILURE;
+      SIXT_ERROR("time step for the visibility calculation must be positive");
+      break;
+    }
+
+    gtis=(GTI**)calloc(MAX(ndirs, 1), sizeof(GTI*));
+    min_align=(double*)malloc(MAX(ndirs, 1)*sizeof(double));
+    visible=(char*)calloc(MAX(ndirs, 1), sizeof(char));
+    start=(double*)malloc(MAX(ndirs, 1)*sizeof(double));
+    list=(long*)malloc(MAX(ndirs, 1)*sizeof(long));
+    if ((NULL==gtis)||(NULL==min_align)||(NULL==visible)||
+	(NULL==start)||(NULL==list)) {
+      *status=EXIT_FAILURE;
+      SIXT_ERROR("memory allocation for visibility calculation failed");
+      break;
+    }
+
+    double max_radius=0.;
+    long ii;
+    for (ii=0; ii<ndirs; ii++) {
+      gtis[ii]=newGTI(status);
+      CHECK_STATUS_BREAK(*status);
+      gtis[ii]->mjdref=ac->mjdref;
+      min_align[ii]=cos(MIN(radius[ii], M_PI));
+      max_radius=MAX(max_radius, radius[ii]);
+    }
+    CHECK_STATUS_BREAK(*status);
+
+    idx=newSkyIndex(dir, ndirs, max_radius, status);
+    CHECK_STATUS_BREAK(*status);
+
+    // Sources visible at the beginning.
+    Vector nz0=getTelescopeNz(ac, tstart, status);
+    CHECK_STATUS_BREAK(*status);
+    long nfound=querySkyIndex(idx, &nz0, max_radius+VISIBILITY_MARGIN,
+				 list);
+    for (ii=0; ii<nfound; ii++) {
+      const long src=list[ii];
+      if (scalar_product(&dir[src], &nz0)>=min_align[src]) {
+	visible[src]=1;
+	start[src]=tstart;
+      }
+    }
+
+    // Index of the next attitude entry after the current step.
+    long entry=(ac->nentries>1) ? 0 : ac->nentries;
+
+    // Loop over the time interval in steps of dt.
+    long step;
+    double t0=tstart;
+    for (step=1; t0<tstop; step++) {
+      const double t1=MIN(tstart+step*dt, tstop);
+      Vector nz1=getTelescopeNz(ac, t1, status);
+      CHECK_STATUS_BREAK(*status);
+
+      // Maximum angle between the pointing direction in the middle
+      // of the step and the track of the telescope during the step.
+      // As the track consists of arcs of great circles between the
+      // attitude entries, it is sufficient to check the end points of
+      // the step and the attitude entries in between.
+      Vector nzc=getTelescopeNz(ac, 0.5*(t0+t1), status);
+      CHECK_STATUS_BREAK(*status);
+      double track=MAX(getAngle(&nzc, &nz0), getAngle(&nzc, &nz1));
+      while ((entry<ac->nentries)&&(ac->entry[entry].time<=t0)) {
+	entry++;
+      }
+      long jj;
+      for (jj=entry; (jj<ac->nentries)&&(ac->entry[jj].time<t1); jj++) {
+	track=MAX(track, getAngle(&nzc, &ac->entry[jj].nz));
+      }
+
+      // Only the sources within the visibility range plus the track
+      // can become visible or invisible during this step.
+      nfound=querySkyIndex(idx, &nzc, max_radius+track+VISIBILITY_MARGIN,
+			   list);
+      for (ii=0; ii<nfound; ii++) {
+	const long src=list[ii];
+	const double f0=scalar_product(&dir[src], &nz0)-min_align[src];
+	const double f1=scalar_product(&dir[src], &nz1)-min_align[src];
+
+	if ((f0>=0.)!=(f1>=0.)) {
+	  // The source enters or leaves the visibility range.
+	  double edge=findVisibilityEdge(ac, &dir[src], min_align[src],
+					 t0, f0, t1, f1, accuracy, status);
+	  CHECK_STATUS_BREAK(*status);
+	  if (f1>=0.) {
+	    start[src]=edge;
+	    visible[src]=1;
+	  } else {
+	    appendGTI(gtis[src], start[src], edge, status);
+	    CHECK_STATUS_BREAK(*status);
+	    visible[src]=0;
+	  }
+	  continue;
+	}
+
+	// The source might be visible (or invisible) only for a short
+	// time in between, if it is close to the boundary of its
+	// visibility range during the step.
+	const double distance=getAngle(&dir[src], &nzc);
+	if ((0==visible[src]) ? (distance>radius[src]+track) :
+	    (distance<radius[src]-track)) {
+	  continue;
+	}
+	double fext;
+	double text=findVisibilityExtremum(ac, &dir[src], min_align[src],
+					   t0, t1, visible[src], accuracy,
+					   &fext, status);
+	CHECK_STATUS_BREAK(*status);
+	if ((fext>=0.)==visible[src]) {
+	  continue;
+	}
+	double edge0=findVisibilityEdge(ac, &dir[src], min_align[src],
+					t0, f0, text, fext, accuracy, status);
+	double edge1=findVisibilityEdge(ac, &dir[src], min_align[src],
+					text, fext, t1, f1, accuracy, status);
+	CHECK_STATUS_BREAK(*status);
+	if (0==visible[src]) {
+	  appendGTI(gtis[src], edge0, edge1, status);
+	} else {
+	  appendGTI(gtis[src], start[src], edge0, status);
+	  start[src]=edge1;
+	}
+	CHECK_STATUS_BREAK(*status);
+      }
+      CHECK_STATUS_BREAK(*status);
+
+      t0=t1;
+      nz0=nz1;
+    }
+    CHECK_STATUS_BREAK(*status);
+
+    // Close the intervals of the sources, which are still visible at
+    // the end.
+    for (ii=0; ii<ndirs; ii++) {
+      if (0!=visible[ii]) {
+	appendGTI(gtis[ii], start[ii], tstop, status);
+	CHECK_STATUS_BREAK(*status);
+      }
+    }
+
+  } while(0); // END of error handling loop.
+
+  freeSkyIndex(&idx);
+  if (NULL!=min_align) free(min_align);
+  if (NULL!=visible) free(visible);
+  if (NULL!=start) free(start);
+  if (NULL!=list) free(list);
+
+  return(gtis);
+}
+
+
+void freeVisibilityGTIs(GTI*** const gtis, const long ndirs)
+{
+  if (NULL!=*gtis) {
+    long ii;
+    for (ii=0; ii<ndirs; ii++) {
+      freeGTI(&(*gtis)[ii]);
+    }
+    free(*gtis);
+    *gtis=NULL;
+  }
+}
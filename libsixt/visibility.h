@@ -0,0 +1,114 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                  Erlangen-Nuernberg
+*/
+
+
+#ifndef VISIBILITY_H
+#define VISIBILITY_H 1
+
+#include "sixt.h"
+#include "vector.h"
+#include "attitude.h"
+#include "gti.h"
+
+
+/////////////////////////////////////////////////////////////////
+// Type Declarations.
+/////////////////////////////////////////////////////////////////
+
+
+/** Index of a set of directions on the sky. The directions are
+    sorted into bands of declination and by right ascension within
+    each band, such that the directions close to a reference
+    direction can be found without looking at all the others. */
+typedef struct {
+  /** Number of directions. */
+  long ndirs;
+
+  /** Number and width ([rad]) of the declination bands. */
+  int nbands;
+  double bandwidth;
+
+  /** The directions in the sorted order, with the directions of band
+      ii at the positions first[ii]..first[ii+1]-1. */
+  long* first;
+  Vector* dir;
+
+  /** Right ascension ([rad], 0..2pi) of the sorted directions. */
+  double* ra;
+
+  /** Index of the sorted directions in the original list. */
+  long* index;
+
+} SkyIndex;
+
+
+/////////////////////////////////////////////////////////////////
+// Function Declarations.
+/////////////////////////////////////////////////////////////////
+
+
+/** Constructor. Sets up the index for the given list of unit
+    vectors. The width of the declination bands ([rad]) should be of
+    the order of the radius of the typical search. */
+SkyIndex* newSkyIndex(const Vector* const dir,
+		      const long ndirs,
+		      const double bandwidth,
+		      int* const status);
+
+/** Destructor. */
+void freeSkyIndex(SkyIndex** const idx);
+
+/** Find all directions of the index, which lie within the angle
+    'radius' ([rad]) around the reference direction. The indices of
+    these directions in the original list are stored in the array
+    'list', which must be able to hold idx->ndirs entries. The
+    function returns the number of directions found. */
+long querySkyIndex(const SkyIndex* const idx,
+		   const Vector* const ref,
+		   const double radius,
+		   long* const list);
+
+/** Determine for each of the given source directions the intervals
+    between tstart and tstop, during which the angle between the
+    telescope pointing direction and the source does not exceed the
+    radius ([rad]) specified for the source. The attitude is sampled
+    in steps of dt. Within each step only the sources close to the
+    track of the telescope are considered, and the times, when a
+    source enters or leaves the visibility range, are determined by
+    root-finding with the given accuracy ([s]). The function returns
+    an array of ndirs GTI collections, which has to be released with
+    freeVisibilityGTIs(). */
+GTI** getVisibilityGTIs(Attitude* const ac,
+			const Vector* const dir,
+			const double* const radius,
+			const long ndirs,
+			const double tstart,
+			const double tstop,
+			const double dt,
+			const double accuracy,
+			int* const status);
+
+/** Destructor for the array of GTI collections returned by
+    getVisibilityGTIs(). */
+void freeVisibilityGTIs(GTI*** const gtis, const long ndirs);
+
+
+#endif /* VISIBILITY_H */
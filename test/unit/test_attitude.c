@@ -0,0 +1,249 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <time.h>
+
+#include "attitude.h"
+
+
+#define NENTRIES 2000
+#define NTIMES 100000
+#define TOLERANCE 1.e-12
+
+/** Survey attitude with NENTRIES entries in steps of 1s scanning
+    along great circles with a slowly changing roll angle, which is
+    kept constant over every other segment. */
+static Attitude* get_survey_attitude(AttNxAlign align){
+  int status=EXIT_SUCCESS;
+  Attitude* ac=getAttitude(&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  ac->entry=(AttitudeEntry*)malloc(NENTRIES*sizeof(AttitudeEntry));
+  assert_non_null(ac->entry);
+  ac->nentries=NENTRIES;
+  ac->align=align;
+
+  long ii;
+  for (ii=0; ii<NENTRIES; ii++){
+    ac->entry[ii]=initializeAttitudeEntry();
+    ac->entry[ii].time=ii*1.;
+    double ra=0.3+ii*0.5*M_PI/180.;
+    double dec=0.6*sin(ii*0.01)+((ii%100<10) ? 0. : 1.e-4);
+    ac->entry[ii].nz=unit_vector(ra,dec);
+    ac->entry[ii].roll_angle=0.2+0.001*(ii/2);
+  }
+  // Pointed sections (identical subsequent pointing directions).
+  for (ii=500; ii<520; ii++){
+    ac->entry[ii].nz=ac->entry[499].nz;
+  }
+  ac->tstart=ac->entry[0].time;
+  ac->tstop =ac->entry[NENTRIES-1].time;
+  return(ac);
+}
+
+/** Sorted points of time within the attitude. */
+static double* get_sorted_times(const Attitude* const ac){
+  double* time=(double*)malloc(NTIMES*sizeof(double));
+  assert_non_null(time);
+  long ii;
+  for (ii=0; ii<NTIMES; ii++){
+    time[ii]=ac->tstart+(ac->tstop-ac->tstart)*(ii+0.5)/NTIMES;
+  }
+  // Entries times themselves.
+  time[0]=ac->tstart;
+  time[NTIMES/2]=ac->entry[NENTRIES/2].time;
+  time[NTIMES-1]=ac->tstop;
+  return(time);
+}
+
+static double vector_deviation(const Vector a, const Vector b){
+  return(fmax(fabs(a.x-b.x),fmax(fabs(a.y-b.y),fabs(a.z-b.z))));
+}
+
+/** Compare getTelescopeFrame to getTelescopeNz and getTelescopeAxes
+    for the given points of time. */
+static void check_frames(Attitude* const ac, const double* const time, long ntimes){
+  int status=EXIT_SUCCESS;
+  double maxdev=0.;
+  long ii;
+  for (ii=0; ii<ntimes; ii++){
+    Vector nx, ny, nz, rnx, rny, rnz;
+    getTelescopeFrame(ac,&nx,&ny,&nz,time[ii],&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    long currentry=ac->currentry;
+
+    getTelescopeAxes(ac,&rnx,&rny,&rnz,time[ii],&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    assert_int_equal(ac->currentry,currentry);
+    maxdev=fmax(maxdev,vector_deviation(nx,rnx));
+    maxdev=fmax(maxdev,vector_deviation(ny,rny));
+    maxdev=fmax(maxdev,vector_deviation(nz,rnz));
+
+    rnz=getTelescopeNz(ac,time[ii],&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    maxdev=fmax(maxdev,vector_deviation(nz,rnz));
+
+    // Only the pointing direction.
+    Vector nz1;
+    getTelescopeFrame(ac,NULL,NULL,&nz1,time[ii],&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    assert_true(nz1.x==nz.x && nz1.y==nz.y && nz1.z==nz.z);
+  }
+  assert_true(maxdev<=TOLERANCE);
+}
+
+static void test_frame_north(){
+  Attitude* ac=get_survey_attitude(ATTNX_NORTH);
+  double* time=get_sorted_times(ac);
+  check_frames(ac,time,NTIMES);
+  free(time);
+  freeAttitude(&ac);
+}
+
+static void test_frame_motion(){
+  Attitude* ac=get_survey_attitude(ATTNX_MOTION);
+  double* time=get_sorted_times(ac);
+  check_frames(ac,time,NTIMES);
+  free(time);
+  freeAttitude(&ac);
+}
+
+/** Random access, such that the attitude entries have to be
+    searched by bisection. */
+static void test_frame_random_access(){
+  Attitude* ac=get_survey_attitude(ATTNX_MOTION);
+  double* time=get_sorted_times(ac);
+  srand(1);
+  long ii;
+  for (ii=NTIMES-1; ii>0; ii--){
+    long jj=rand()%(ii+1);
+    double buffer=time[ii];
+    time[ii]=time[jj];
+    time[jj]=buffer;
+  }
+  check_frames(ac,time,NTIMES/10);
+  free(time);
+  freeAttitude(&ac);
+}
+
+static void test_frame_pointing(){
+  int status=EXIT_SUCCESS;
+  Attitude* ac=getPointingAttitude(55000.,0.,1000.,1.2,-0.4,0.7,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  const double time[]={0.,10.,500.5,1000.};
+  check_frames(ac,time,sizeof(time)/sizeof(time[0]));
+  freeAttitude(&ac);
+
+  // Pointing towards the pole.
+  ac=getPointingAttitude(55000.,0.,1000.,0.,M_PI/2.,0.3,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  check_frames(ac,time,sizeof(time)/sizeof(time[0]));
+  freeAttitude(&ac);
+}
+
+static void test_frames_batch(){
+  int status=EXIT_SUCCESS;
+  Attitude* ac=get_survey_attitude(ATTNX_NORTH);
+  double* time=get_sorted_times(ac);
+  Vector* nx=(Vector*)malloc(NTIMES*sizeof(Vector));
+  Vector* ny=(Vector*)malloc(NTIMES*sizeof(Vector));
+  Vector* nz=(Vector*)malloc(NTIMES*sizeof(Vector));
+  assert_true(NULL!=nx && NULL!=ny && NULL!=nz);
+
+  getTelescopeFrames(ac,NTIMES,time,nx,ny,nz,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  long ii;
+  for (ii=0; ii<NTIMES; ii+=7){
+    Vector rnx, rny, rnz;
+    getTelescopeFrame(ac,&rnx,&rny,&rnz,time[ii],&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    assert_true(vector_deviation(nx[ii],rnx)==0.);
+    assert_true(vector_deviation(ny[ii],rny)==0.);
+    assert_true(vector_deviation(nz[ii],rnz)==0.);
+  }
+
+  free(nx);
+  free(ny);
+  free(nz);
+  free(time);
+  freeAttitude(&ac);
+}
+
+static void test_frame_out_of_range(){
+  int status=EXIT_SUCCESS;
+  Attitude* ac=get_survey_attitude(ATTNX_NORTH);
+  Vector nx, ny, nz;
+  getTelescopeFrame(ac,&nx,&ny,&nz,ac->tstop+1.,&status);
+  assert_int_equal(status,EXIT_FAILURE);
+  status=EXIT_SUCCESS;
+  getTelescopeFrame(ac,&nx,&ny,&nz,ac->tstart-1.,&status);
+  assert_int_equal(status,EXIT_FAILURE);
+  freeAttitude(&ac);
+}
+
+#ifdef SIXT_BENCHMARK
+/** Reports the rate (frames/s) of the evaluation of the telescope
+    frame by getTelescopeNz and getTelescopeAxes (as done per photon
+    in phimg), by getTelescopeFrame, and by getTelescopeFrames. */
+static void benchmark_frames(){
+  int status=EXIT_SUCCESS;
+  Attitude* ac=get_survey_attitude(ATTNX_NORTH);
+  double* time=get_sorted_times(ac);
+  Vector* nx=(Vector*)malloc(NTIMES*sizeof(Vector));
+  Vector* ny=(Vector*)malloc(NTIMES*sizeof(Vector));
+  Vector* nz=(Vector*)malloc(NTIMES*sizeof(Vector));
+  assert_true(NULL!=nx && NULL!=ny && NULL!=nz);
+
+  long ii;
+  clock_t start=clock();
+  for (ii=0; ii<NTIMES; ii++){
+    nz[ii]=getTelescopeNz(ac,time[ii],&status);
+    getTelescopeAxes(ac,&nx[ii],&ny[ii],&nz[ii],time[ii],&status);
+  }
+  double t_axes=(double)(clock()-start)/CLOCKS_PER_SEC;
+
+  start=clock();
+  for (ii=0; ii<NTIMES; ii++){
+    getTelescopeFrame(ac,&nx[ii],&ny[ii],&nz[ii],time[ii],&status);
+  }
+  double t_frame=(double)(clock()-start)/CLOCKS_PER_SEC;
+
+  start=clock();
+  getTelescopeFrames(ac,NTIMES,time,nx,ny,nz,&status);
+  double t_frames=(double)(clock()-start)/CLOCKS_PER_SEC;
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  printf("# getTelescopeNz+getTelescopeAxes %.3g frames/s, "
+	 "getTelescopeFrame %.3g frames/s, getTelescopeFrames %.3g frames/s\n",
+	 NTIMES/fmax(t_axes,1e-9),NTIMES/fmax(t_frame,1e-9),NTIMES/fmax(t_frames,1e-9));
+
+  free(nx);
+  free(ny);
+  free(nz);
+  free(time);
+  freeAttitude(&ac);
+}
+#endif
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_frame_north),
+    cmocka_unit_test(test_frame_motion),
+    cmocka_unit_test(test_frame_random_access),
+    cmocka_unit_test(test_frame_pointing),
+    cmocka_unit_test(test_frames_batch),
+    cmocka_unit_test(test_frame_out_of_range),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_frames),
+#endif
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
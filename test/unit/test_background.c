@@ -0,0 +1,263 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <time.h>
+
+#include "background.h"
+
+
+#define NEVENTS 20000
+#define RATE 5000.
+
+/** Hits of a background simulation: events with up to 4 secondary
+    interactions (with the same time stamp). */
+static long synthetic_hits(double** x, double** y, double** t, double** e){
+  long maxrows=5*NEVENTS;
+  *x=(double*)malloc(maxrows*sizeof(double));
+  *y=(double*)malloc(maxrows*sizeof(double));
+  *t=(double*)malloc(maxrows*sizeof(double));
+  *e=(double*)malloc(maxrows*sizeof(double));
+  assert_true(NULL!=*x && NULL!=*y && NULL!=*t && NULL!=*e);
+
+  srand(1);
+  long numrows=0;
+  long ii;
+  for (ii=0; ii<NEVENTS; ii++){
+    int nhits=1+((rand()%10==0) ? rand()%5 : 0);
+    int jj;
+    for (jj=0; jj<nhits; jj++){
+      (*x)[numrows]=(rand()%20000)/1000.-10.;
+      (*y)[numrows]=(rand()%20000)/1000.-10.;
+      (*t)[numrows]=ii+1.;
+      (*e)[numrows]=(rand()%100000)/10.;
+      numrows++;
+    }
+  }
+  return(numrows);
+}
+
+/** Background list as generated originally by bkgGetBackgroundList
+    (walking the hits of an event by their time stamps). */
+static backgroundOutput* ref_list(const long numrows, const double* x,
+				  const double* y, const double* t,
+				  const double* e, const size_t* eventlist,
+				  const long numevents, gsl_rng* rng,
+				  const double interval){
+  backgroundOutput* list=(backgroundOutput*)calloc(1,sizeof(backgroundOutput));
+  list->numevents=gsl_ran_poisson(rng,RATE*interval);
+  if (list->numevents>0){
+    int arrsize=list->numevents;
+    list->hit_energy=(double*)malloc(arrsize*sizeof(double));
+    list->hit_time=(double*)malloc(arrsize*sizeof(double));
+    list->hit_xpos=(double*)malloc(arrsize*sizeof(double));
+    list->hit_ypos=(double*)malloc(arrsize*sizeof(double));
+    int cc, hitcnt=0;
+    for (cc=0; cc<list->numevents; cc++){
+      int rand=(int)floor((numevents-1)*gsl_ran_flat(rng,0,1));
+      do {
+	size_t row=eventlist[rand]+hitcnt;
+	list->hit_energy[list->numhits]=e[row];
+	list->hit_time[list->numhits]=t[row];
+	list->hit_xpos[list->numhits]=x[row];
+	list->hit_ypos[list->numhits]=y[row];
+	list->numhits++;
+	if ((long)row!=numrows-1 && t[row+1]==t[row]){
+	  hitcnt++;
+	} else {
+	  hitcnt=0;
+	}
+	if (list->numhits==arrsize){
+	  arrsize+=50;
+	  list->hit_energy=(double*)realloc(list->hit_energy,arrsize*sizeof(double));
+	  list->hit_time=(double*)realloc(list->hit_time,arrsize*sizeof(double));
+	  list->hit_xpos=(double*)realloc(list->hit_xpos,arrsize*sizeof(double));
+	  list->hit_ypos=(double*)realloc(list->hit_ypos,arrsize*sizeof(double));
+	}
+      } while (hitcnt>0);
+    }
+  }
+  return(list);
+}
+
+static size_t* ref_eventlist(const double* t, const long numrows, long* numevents){
+  size_t* eventlist=(size_t*)malloc(numrows*sizeof(size_t));
+  long ii;
+  *numevents=0;
+  eventlist[(*numevents)++]=0;
+  for (ii=0; ii<numrows-1; ii++){
+    if (t[ii]!=t[ii+1]){
+      eventlist[(*numevents)++]=ii+1;
+    }
+  }
+  return(eventlist);
+}
+
+static void assert_lists_equal(const backgroundOutput* a, const backgroundOutput* b){
+  assert_int_equal(a->numevents,b->numevents);
+  assert_int_equal(a->numhits,b->numhits);
+  int ii;
+  for (ii=0; ii<a->numhits; ii++){
+    assert_true(a->hit_xpos[ii]==b->hit_xpos[ii]);
+    assert_true(a->hit_ypos[ii]==b->hit_ypos[ii]);
+    assert_true(a->hit_time[ii]==b->hit_time[ii]);
+    assert_true(a->hit_energy[ii]==b->hit_energy[ii]);
+  }
+}
+
+/** The generator draws the same events as the original module for
+    the same random numbers. */
+static void test_bkg_generator_list(){
+  int status=EXIT_SUCCESS;
+  double *x, *y, *t, *e;
+  long numrows=synthetic_hits(&x,&y,&t,&e);
+  long numevents;
+  size_t* eventlist=ref_eventlist(t,numrows,&numevents);
+  assert_int_equal(numevents,NEVENTS);
+
+  BkgGenerator* gen=newBkgGeneratorHits(numrows,x,y,t,e,RATE,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_int_equal(gen->table->numevents,NEVENTS);
+  backgroundOutput* list=newBkgOutput(&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  gsl_rng* rng=gsl_rng_alloc(gsl_rng_ranlux);
+  gsl_rng* refrng=gsl_rng_alloc(gsl_rng_ranlux);
+  gsl_rng_set(rng,7);
+  gsl_rng_set(refrng,7);
+
+  const double intervals[]={1.e-3,0.1,2.,1.e-4};
+  int ii;
+  for (ii=0; ii<400; ii++){
+    double interval=intervals[ii%4];
+    getBkgGeneratorList(gen,rng,interval,list,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    backgroundOutput* ref=ref_list(numrows,x,y,t,e,eventlist,numevents,refrng,interval);
+    assert_lists_equal(list,ref);
+    bkgFree(ref);
+  }
+
+  // Invalid interval.
+  getBkgGeneratorList(gen,rng,0.,list,&status);
+  assert_int_equal(status,EXIT_FAILURE);
+
+  gsl_rng_free(rng);
+  gsl_rng_free(refrng);
+  bkgFree(list);
+  destroyBkgGenerator(&gen);
+  assert_null(gen);
+  free(eventlist);
+  free(x);
+  free(y);
+  free(t);
+  free(e);
+}
+
+/** Clones share the event table, but have their own state. */
+static void test_bkg_generator_clone(){
+  int status=EXIT_SUCCESS;
+  double *x, *y, *t, *e;
+  long numrows=synthetic_hits(&x,&y,&t,&e);
+  BkgGenerator* gen=newBkgGeneratorHits(numrows,x,y,t,e,RATE,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  BkgGenerator* clone=cloneBkgGenerator(gen,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_ptr_equal(clone->table,gen->table);
+  assert_int_equal(gen->table->refcount,2);
+
+  backgroundOutput* list=newBkgOutput(&status);
+  backgroundOutput* clonelist=newBkgOutput(&status);
+  gsl_rng* rng=gsl_rng_alloc(gsl_rng_ranlux);
+  gsl_rng* clonerng=gsl_rng_alloc(gsl_rng_ranlux);
+  gsl_rng_set(rng,3);
+  gsl_rng_set(clonerng,3);
+  int ii;
+  for (ii=0; ii<100; ii++){
+    getBkgGeneratorList(gen,rng,0.01,list,&status);
+    getBkgGeneratorList(clone,clonerng,0.01,clonelist,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    assert_lists_equal(list,clonelist);
+  }
+  assert_true(gen->intervalsum==clone->intervalsum);
+
+  // The table is released with the last generator.
+  destroyBkgGenerator(&gen);
+  getBkgGeneratorList(clone,clonerng,0.01,clonelist,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  destroyBkgGenerator(&clone);
+
+  gsl_rng_free(rng);
+  gsl_rng_free(clonerng);
+  bkgFree(list);
+  bkgFree(clonelist);
+  free(x);
+  free(y);
+  free(t);
+  free(e);
+}
+
+#ifdef SIXT_BENCHMARK
+/** Reports the time needed to generate the background in intervals
+    of 1ms with a list per interval (as bkgGetBackgroundList) and
+    with a reused list, extrapolated to an exposure of 100ks. */
+static void benchmark_bkg_generator(){
+  int status=EXIT_SUCCESS;
+  double *x, *y, *t, *e;
+  long numrows=synthetic_hits(&x,&y,&t,&e);
+  long numevents;
+  size_t* eventlist=ref_eventlist(t,numrows,&numevents);
+  BkgGenerator* gen=newBkgGeneratorHits(numrows,x,y,t,e,RATE,&status);
+  backgroundOutput* list=newBkgOutput(&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  gsl_rng* rng=gsl_rng_alloc(gsl_rng_ranlux);
+
+  const double interval=1.e-3;
+  const long nintervals=200000;
+  long ii;
+  clock_t start=clock();
+  for (ii=0; ii<nintervals; ii++){
+    backgroundOutput* ref=ref_list(numrows,x,y,t,e,eventlist,numevents,rng,interval);
+    bkgFree(ref);
+  }
+  double t_ref=(double)(clock()-start)/CLOCKS_PER_SEC;
+
+  start=clock();
+  for (ii=0; ii<nintervals; ii++){
+    getBkgGeneratorList(gen,rng,interval,list,&status);
+  }
+  double t_gen=(double)(clock()-start)/CLOCKS_PER_SEC;
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  double scale=1.e5/(nintervals*interval);
+  printf("# 1ms intervals, %.0f events/s, 100ks exposure: list per interval %.1fs, "
+	 "reused list %.1fs\n", RATE, t_ref*scale, t_gen*scale);
+
+  gsl_rng_free(rng);
+  bkgFree(list);
+  destroyBkgGenerator(&gen);
+  free(eventlist);
+  free(x);
+  free(y);
+  free(t);
+  free(e);
+}
+#endif
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_bkg_generator_list),
+    cmocka_unit_test(test_bkg_generator_clone),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_bkg_generator),
+#endif
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
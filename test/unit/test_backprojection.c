@@ -0,0 +1,163 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "sixt.h"
+
+#include "projectedmask.h"
+#include "sourceimage.h"
+
+
+#define NEVENTS 2000
+
+static SourceImage* get_empty_image(const int naxis1, const int naxis2,
+				    int* const status){
+
+	struct SourceImageParameters sip = {
+		.naxis1 = naxis1,
+		.naxis2 = naxis2,
+		.crpix1 = 0.,
+		.crpix2 = 0.,
+		.cdelt1 = 1.,
+		.cdelt2 = 1.,
+		.crval1 = 0.,
+		.crval2 = 0.
+	};
+	SourceImage* si = getEmptySourceImage(&sip, status);
+	assert_int_equal(*status, EXIT_SUCCESS);
+
+	return (si);
+}
+
+/** Compares the FFT-based back-projection of a detector histogram
+    with the direct addition of the projected mask for every event. */
+static void test_backprojection(){
+	int status = EXIT_SUCCESS;
+
+	const int xwidth = 13, ywidth = 11;
+	const int xstep = 3, ystep = 3;
+
+	// Random projected mask with a transparency of about 50%.
+	srand(42);
+	ProjectedMask* pm = getEmptyProjectedMask(17, 19, 1., 1., &status);
+	assert_int_equal(status, EXIT_SUCCESS);
+	int ii, jj;
+	for (ii=0; ii<pm->naxis1; ii++){
+		for (jj=0; jj<pm->naxis2; jj++){
+			pm->map[ii][jj] = (rand()%2) ? 1. : 0.;
+		}
+	}
+	pm->map[0][0] = 0.5;
+	getOpenPixels(pm);
+
+	const int naxis1 = pm->naxis1+(xwidth-1)*xstep;
+	const int naxis2 = pm->naxis2+(ywidth-1)*ystep;
+	SourceImage* direct = get_empty_image(naxis1, naxis2, &status);
+	SourceImage* hist = get_empty_image(xwidth, ywidth, &status);
+	SourceImage* fft = get_empty_image(naxis1, naxis2, &status);
+
+	// Per-event back-projection as done originally by comabackpro.
+	int kk;
+	for (kk=0; kk<NEVENTS; kk++){
+		int rawx = rand()%xwidth;
+		int rawy = rand()%ywidth;
+		double charge = 1.+(rand()%100)/10.;
+
+		for (ii=0; ii<pm->naxis1; ii++){
+			for (jj=0; jj<pm->naxis2; jj++){
+				int shift_ii = pm->naxis1-1-ii;
+				int shift_jj = pm->naxis2-1-jj;
+				direct->pixel[shift_ii+rawx*xstep][shift_jj+rawy*ystep] +=
+						charge/pm->OpenPixels*pm->map[ii][jj];
+			}
+		}
+		hist->pixel[rawx][rawy] += charge;
+	}
+
+	backprojectDetHistogram(pm, hist->pixel, xwidth, ywidth, xstep, ystep,
+			fft, &status);
+	assert_int_equal(status, EXIT_SUCCESS);
+
+	double max = 0.;
+	for (ii=0; ii<naxis1; ii++){
+		for (jj=0; jj<naxis2; jj++){
+			max = MAX(max, fabs(direct->pixel[ii][jj]));
+		}
+	}
+	assert_true(max > 0.);
+	for (ii=0; ii<naxis1; ii++){
+		for (jj=0; jj<naxis2; jj++){
+			assert_true(fabs(fft->pixel[ii][jj]-direct->pixel[ii][jj]) <=
+					1.e-9*max);
+		}
+	}
+
+	free_SourceImage(direct);
+	free_SourceImage(hist);
+	free_SourceImage(fft);
+}
+
+/** Compares the real-to-complex and complex-to-real transforms with
+    the complex transforms used previously, for even and odd sizes. */
+static void test_fft_r2c_c2r(){
+	int status = EXIT_SUCCESS;
+
+	const int sizes[][2] = {{12, 10}, {9, 7}, {16, 5}};
+	unsigned int kk;
+	for (kk=0; kk<sizeof(sizes)/sizeof(sizes[0]); kk++){
+		const int n1 = sizes[kk][0], n2 = sizes[kk][1];
+		const int nhalf = n2/2+1;
+		int ii, jj;
+
+		double* image = (double*) fftw_malloc(sizeof(double)*n1*n2);
+		assert_non_null(image);
+		double max = 0.;
+		for (ii=0; ii<n1*n2; ii++){
+			image[ii] = sin(0.7*ii)+0.3*(ii%5);
+			max = MAX(max, fabs(image[ii]));
+		}
+
+		// Forward transforms.
+		fftw_complex* c2c = FFTOfArray_1d(image, n1, n2, FFTW_FORWARD, &status);
+		assert_int_equal(status, EXIT_SUCCESS);
+		fftw_complex* r2c = FFTOfArray_r2c(image, n1, n2, &status);
+		assert_int_equal(status, EXIT_SUCCESS);
+		const double tol = 1.e-12*max*n1*n2;
+		for (ii=0; ii<n1; ii++){
+			for (jj=0; jj<nhalf; jj++){
+				assert_true(fabs(r2c[ii*nhalf+jj][0]-c2c[ii*n2+jj][0]) <= tol);
+				assert_true(fabs(r2c[ii*nhalf+jj][1]-c2c[ii*n2+jj][1]) <= tol);
+			}
+		}
+
+		// Backward transforms (both release their input).
+		fftw_complex* c2c_back = FFTOfArray(c2c, n1, n2, FFTW_BACKWARD, &status);
+		assert_int_equal(status, EXIT_SUCCESS);
+		double* c2r_back = FFTOfArray_c2r(r2c, n1, n2, &status);
+		assert_int_equal(status, EXIT_SUCCESS);
+		for (ii=0; ii<n1*n2; ii++){
+			assert_true(fabs(c2r_back[ii]-c2c_back[ii][0]) <= tol*n1*n2);
+			assert_true(fabs(c2r_back[ii]/(n1*n2)-image[ii]) <= 1.e-12*max*n1*n2);
+		}
+
+		fftw_free(image);
+		fftw_free(c2c_back);
+		fftw_free(c2r_back);
+	}
+}
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_backprojection),
+    cmocka_unit_test(test_fft_r2c_c2r)
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
@@ -0,0 +1,405 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "sixt.h"
+#include "checkpoint.h"
+
+
+#define CHECKPOINT "test_checkpoint.fits"
+#define SIMPUT_FILENAME "test_checkpoint.simput"
+
+/** Size of a WFI-like detector. */
+#define WIDTH 512
+
+static GenInst* new_instrument(){
+  int status=EXIT_SUCCESS;
+  GenInst* inst=newGenInst(&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  GenDet* det=inst->det;
+  det->pixgrid=newGenPixGrid(&status);
+  det->clocklist=newClockList(&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  det->pixgrid->xwidth=WIDTH;
+  det->pixgrid->ywidth=WIDTH;
+  det->line=(GenDetLine**)malloc(WIDTH*sizeof(GenDetLine*));
+  assert_non_null(det->line);
+  int ii;
+  for (ii=0; ii<WIDTH; ii++){
+    det->line[ii]=newGenDetLine(WIDTH,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+  }
+  det->chargedlines=(GenDetLine**)malloc(WIDTH*sizeof(GenDetLine*));
+  assert_non_null(det->chargedlines);
+  return(inst);
+}
+
+/** Charges in every 5th pixel (marked in reverse order within a line,
+    such that the order of the 'occupied' lists matters) and dead
+    times in every 3rd pixel. */
+static void fill_detector(GenInst* inst){
+  GenDet* det=inst->det;
+  int ii, jj;
+  for (ii=0; ii<WIDTH; ii++){
+    GenDetLine* line=det->line[ii];
+    for (jj=WIDTH-1; jj>=0; jj--){
+      if (0==(ii+jj)%5){
+	markGenDetLinePixel(line,jj);
+	line->charge[jj]=0.1f*(float)(jj+1);
+	line->ccarry[jj]=(0==jj%2) ? 0.01f*(float)ii : 0.f;
+	line->ph_id[jj][0]=ii*WIDTH+jj;
+	line->src_id[jj][0]=ii;
+	line->carry_ph_id[jj][NEVENTPHOTONS-1]=-jj;
+	line->carry_src_id[jj][NEVENTPHOTONS-1]=7;
+	line->anycharge=1;
+      }
+      if (0==(ii*WIDTH+jj)%3){
+	line->deadtime[jj]=100.+1.e-9*(ii*WIDTH+jj);
+      }
+    }
+    line->last_readouttime=99.9+ii/3.;
+  }
+  det->lineoffset=17;
+  det->anyphoton=1;
+  det->clocklist->element=3;
+  det->clocklist->frame=123456;
+  det->clocklist->time=100.1/3.;
+  det->clocklist->readout_time=100./3.;
+  inst->tel->num_imaged=42;
+}
+
+static void assert_detectors_equal(const GenDet* a, const GenDet* b){
+  assert_int_equal(a->lineoffset,b->lineoffset);
+  assert_int_equal(a->anyphoton,b->anyphoton);
+  assert_int_equal(a->clocklist->element,b->clocklist->element);
+  assert_int_equal(a->clocklist->frame,b->clocklist->frame);
+  assert_true(a->clocklist->time==b->clocklist->time);
+  assert_true(a->clocklist->readout_time==b->clocklist->readout_time);
+  int ii, jj;
+  for (ii=0; ii<WIDTH; ii++){
+    const GenDetLine* la=a->line[ii];
+    const GenDetLine* lb=b->line[ii];
+    assert_true(la->last_readouttime==lb->last_readouttime);
+    assert_int_equal(la->anycharge,lb->anycharge);
+    assert_int_equal(la->anycarry,lb->anycarry);
+    assert_int_equal(la->noccupied,lb->noccupied);
+    for (jj=0; jj<la->noccupied; jj++){
+      assert_int_equal(la->occupied[jj],lb->occupied[jj]);
+    }
+    for (jj=0; jj<WIDTH; jj++){
+      assert_int_equal(la->isoccupied[jj],lb->isoccupied[jj]);
+      assert_true(la->charge[jj]==lb->charge[jj]);
+      assert_true(la->ccarry[jj]==lb->ccarry[jj]);
+      assert_true(la->deadtime[jj]==lb->deadtime[jj]);
+      assert_memory_equal(la->ph_id[jj],lb->ph_id[jj],NEVENTPHOTONS*sizeof(long));
+      assert_memory_equal(la->src_id[jj],lb->src_id[jj],NEVENTPHOTONS*sizeof(long));
+      assert_memory_equal(la->carry_ph_id[jj],lb->carry_ph_id[jj],
+			  NEVENTPHOTONS*sizeof(long));
+      assert_memory_equal(la->carry_src_id[jj],lb->carry_src_id[jj],
+			  NEVENTPHOTONS*sizeof(long));
+    }
+  }
+}
+
+/** The pseudo random number generator continues with the same
+    sequence after its state has been restored. */
+static void test_rng_state(){
+  int status=EXIT_SUCCESS;
+  setenv("SIXTE_USE_PSEUDO_RNG","1",1);
+  sixt_init_rng(42,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  int ii;
+  for (ii=0; ii<1000; ii++){
+    sixt_get_random_number(&status);
+  }
+  SixtRngState state;
+  sixt_get_rng_state(&state,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_int_equal(state.seed,42);
+  assert_true(1000==state.ndraws);
+
+  double values[2000];
+  for (ii=0; ii<2000; ii++){
+    values[ii]=sixt_get_random_number(&status);
+  }
+  sixt_set_rng_state(&state,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  for (ii=0; ii<2000; ii++){
+    assert_true(values[ii]==sixt_get_random_number(&status));
+  }
+
+  // A state of a different seed is rejected.
+  state.seed=43;
+  sixt_set_rng_state(&state,&status);
+  assert_int_equal(status,EXIT_FAILURE);
+
+  sixt_destroy_rng();
+  unsetenv("SIXTE_USE_PSEUDO_RNG");
+}
+
+/** The HEAdas generator continues with the same sequence after its
+    state has been restored in a new process. Taking the state does
+    not change the sequence, so a simulation with checkpoints uses the
+    same random numbers as one without. */
+static void test_rng_replay(){
+  int status=EXIT_SUCCESS;
+  unsetenv("SIXTE_USE_PSEUDO_RNG");
+  sixt_init_rng(42,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  double values[3000];
+  int ii;
+  for (ii=0; ii<3000; ii++){
+    values[ii]=sixt_get_random_number(&status);
+  }
+  sixt_destroy_rng();
+
+  // The same sequence with the state taken after 1000 numbers.
+  sixt_init_rng(42,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  for (ii=0; ii<1000; ii++){
+    assert_true(values[ii]==sixt_get_random_number(&status));
+  }
+  SixtRngState state;
+  sixt_get_rng_state(&state,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_int_equal(state.pseudo,0);
+  assert_int_equal(state.seed,42);
+  assert_true(1000==state.ndraws);
+  for (ii=1000; ii<3000; ii++){
+    assert_true(values[ii]==sixt_get_random_number(&status));
+  }
+
+  // Restore the state in a new process, after some numbers have been
+  // drawn already, and in the current one (going back).
+  sixt_destroy_rng();
+  sixt_init_rng(42,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  for (ii=0; ii<10; ii++){
+    sixt_get_random_number(&status);
+  }
+  sixt_set_rng_state(&state,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  for (ii=1000; ii<3000; ii++){
+    assert_true(values[ii]==sixt_get_random_number(&status));
+  }
+  sixt_set_rng_state(&state,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_true(values[1000]==sixt_get_random_number(&status));
+
+  sixt_destroy_rng();
+}
+
+/** The detector state is restored exactly. The time needed to write
+    the checkpoint of a WFI-size detector is reported and must stay
+    well below 1 s. */
+static void test_detector_state(){
+  int status=EXIT_SUCCESS;
+  setenv("SIXTE_USE_PSEUDO_RNG","1",1);
+  sixt_init_rng(7,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  remove(CHECKPOINT);
+
+  GenInst* inst=new_instrument();
+  fill_detector(inst);
+  setPhgenState(123.25,99);
+
+  SourceCatalog* srccat[1]={NULL};
+  PhotonFile* plf[1]={NULL};
+  ImpactFile* ilf[1]={NULL};
+  EventFile* elf[1]={NULL};
+  SimCheckpoint cp;
+  cp.tstart=0.;
+  cp.tstop=1000.;
+  cp.gtibin=2;
+  cp.simtime=512.5;
+  cp.progress=51;
+
+  struct timespec start, stop;
+  clock_gettime(CLOCK_MONOTONIC,&start);
+  writeCheckpoint(CHECKPOINT,&cp,&inst,1,srccat,1,55000.,plf,ilf,elf,&status);
+  clock_gettime(CLOCK_MONOTONIC,&stop);
+  assert_int_equal(status,EXIT_SUCCESS);
+  double elapsed=(stop.tv_sec-start.tv_sec)+(stop.tv_nsec-start.tv_nsec)*1.e-9;
+  printf("# checkpoint of a %dx%d detector written in %.3fs\n",
+	 WIDTH,WIDTH,elapsed);
+  assert_true(elapsed<1.);
+  assert_int_equal(cp.nphotons[0],-1);
+  assert_int_equal(cp.nevents[0],-1);
+
+  assert_int_equal(getCheckpointSeed(CHECKPOINT,&status),7);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  // Restore the state into a new instrument.
+  setPhgenState(0.,0);
+  GenInst* inst2=new_instrument();
+  SimCheckpoint cp2;
+  cp2.tstart=0.;
+  cp2.tstop=1000.;
+  loadCheckpoint(CHECKPOINT,&cp2,&inst2,1,srccat,1,55000.,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_int_equal(cp2.gtibin,2);
+  assert_true(512.5==cp2.simtime);
+  assert_int_equal(cp2.progress,51);
+  assert_int_equal(cp2.nphotons[0],-1);
+  assert_int_equal(inst2->tel->num_imaged,42);
+  assert_detectors_equal(inst->det,inst2->det);
+
+  double phtime;
+  long long ph_id;
+  assert_int_equal(getPhgenState(&phtime,&ph_id),1);
+  assert_true(123.25==phtime);
+  assert_true(99==ph_id);
+
+  // A checkpoint of a different simulation is rejected.
+  GenInst* inst3=new_instrument();
+  cp2.tstop=2000.;
+  loadCheckpoint(CHECKPOINT,&cp2,&inst3,1,srccat,1,55000.,&status);
+  assert_int_equal(status,EXIT_FAILURE);
+
+  destroyGenInst(&inst,&status);
+  destroyGenInst(&inst2,&status);
+  destroyGenInst(&inst3,&status);
+  setPhgenState(0.,0);
+  remove(CHECKPOINT);
+  sixt_destroy_rng();
+  unsetenv("SIXTE_USE_PSEUDO_RNG");
+}
+
+/** The states of several instruments (as in erosim) are stored
+    separately and restored into the respective instruments. */
+static void test_several_instruments(){
+  int status=EXIT_SUCCESS;
+  setenv("SIXTE_USE_PSEUDO_RNG","1",1);
+  sixt_init_rng(7,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  remove(CHECKPOINT);
+
+  GenInst* inst[2]={new_instrument(), new_instrument()};
+  fill_detector(inst[0]);
+  inst[1]->det->lineoffset=3;
+  markGenDetLinePixel(inst[1]->det->line[5],7);
+  inst[1]->det->line[5]->charge[7]=1.5f;
+  inst[1]->det->line[5]->anycharge=1;
+  inst[1]->tel->num_imaged=1;
+  setPhgenState(10.,5);
+
+  SourceCatalog* srccat[1]={NULL};
+  PhotonFile* plf[2]={NULL, NULL};
+  ImpactFile* ilf[2]={NULL, NULL};
+  EventFile* elf[2]={NULL, NULL};
+  SimCheckpoint cp;
+  cp.tstart=0.;
+  cp.tstop=1000.;
+  cp.gtibin=0;
+  cp.simtime=0.;
+  cp.progress=1;
+  writeCheckpoint(CHECKPOINT,&cp,inst,2,srccat,1,55000.,plf,ilf,elf,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  GenInst* inst2[2]={new_instrument(), new_instrument()};
+  SimCheckpoint cp2;
+  cp2.tstart=0.;
+  cp2.tstop=1000.;
+  loadCheckpoint(CHECKPOINT,&cp2,inst2,2,srccat,1,55000.,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_detectors_equal(inst[0]->det,inst2[0]->det);
+  assert_detectors_equal(inst[1]->det,inst2[1]->det);
+  assert_int_equal(inst2[0]->tel->num_imaged,42);
+  assert_int_equal(inst2[1]->tel->num_imaged,1);
+
+  // The number of instruments has to match.
+  GenInst* inst3=new_instrument();
+  loadCheckpoint(CHECKPOINT,&cp2,&inst3,1,srccat,1,55000.,&status);
+  assert_int_equal(status,EXIT_FAILURE);
+
+  status=EXIT_SUCCESS;
+  int ii;
+  for (ii=0; ii<2; ii++){
+    destroyGenInst(&inst[ii],&status);
+    destroyGenInst(&inst2[ii],&status);
+  }
+  destroyGenInst(&inst3,&status);
+  setPhgenState(0.,0);
+  remove(CHECKPOINT);
+  sixt_destroy_rng();
+  unsetenv("SIXTE_USE_PSEUDO_RNG");
+}
+
+
+/** Copy of the dummy SIMPUT catalog, whose source refers to a power
+    spectrum in its timing column if 'psd' is set. */
+static void create_psd_catalog(const int psd){
+  int status=EXIT_SUCCESS;
+  fitsfile* in=NULL;
+  fitsfile* out=NULL;
+  remove(SIMPUT_FILENAME);
+  fits_open_file(&in,"data/dummy.simput",READONLY,&status);
+  fits_create_file(&out,SIMPUT_FILENAME,&status);
+  fits_copy_file(in,out,1,1,1,&status);
+  fits_close_file(in,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  if (psd){
+    fits_movnam_hdu(out,BINARY_TBL,"SRC_CAT",0,&status);
+    int col;
+    fits_get_colnum(out,CASEINSEN,"TIMING",&col,&status);
+    char* ref[]={"[PSD,1]"};
+    fits_write_col(out,TSTRING,col,1,1,1,ref,&status);
+
+    char* ttype[]={"FREQUENC", "POWER"};
+    char* tform[]={"1E", "1E"};
+    char* tunit[]={"Hz", ""};
+    fits_create_tbl(out,BINARY_TBL,0,2,ttype,tform,tunit,"PSD",&status);
+    fits_update_key(out,TSTRING,"HDUCLASS","HEASARC/SIMPUT_FILENAME","",&status);
+    fits_update_key(out,TSTRING,"HDUCLAS1","POWSPEC","",&status);
+    float freq[]={0.01f, 0.1f, 1.f}, power[]={1.f, 0.1f, 0.01f};
+    fits_write_col(out,TFLOAT,1,1,1,3,freq,&status);
+    fits_write_col(out,TFLOAT,2,1,1,3,power,&status);
+  }
+  fits_close_file(out,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+}
+
+/** Light curves generated from a power spectrum cannot be restored,
+    so checkpoints of catalogs containing them are refused. */
+static void test_psd_sources(){
+  int status=EXIT_SUCCESS;
+  unsetenv("SIXTE_SRCCAT_CACHE");
+  struct ARF* arf=loadARF("data/dummy.arf",&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  int psd;
+  for (psd=0; psd<2; psd++){
+    create_psd_catalog(psd);
+    SourceCatalog* srccat[2]={NULL, NULL};
+    srccat[1]=loadSourceCatalog(SIMPUT_FILENAME,arf,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    checkCheckpointSources(srccat,2,&status);
+    assert_int_equal(status,psd ? EXIT_FAILURE : EXIT_SUCCESS);
+    status=EXIT_SUCCESS;
+    freeSourceCatalog(&srccat[1],&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+  }
+
+  freeARF(arf);
+  remove(SIMPUT_FILENAME);
+}
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_rng_state),
+    cmocka_unit_test(test_rng_replay),
+    cmocka_unit_test(test_detector_state),
+    cmocka_unit_test(test_several_instruments),
+    cmocka_unit_test(test_psd_sources)
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
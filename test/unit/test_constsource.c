@@ -0,0 +1,357 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <time.h>
+
+#include "constsource.h"
+#include "source.h"
+
+
+#define SIMPUT_FILENAME "data/dummy.simput"
+#define ARF_FILENAME "data/dummy.arf"
+#define NBINS 200
+
+/** Kolmogorov-Smirnov limit of the 0.1% significance level. */
+#define KS_LIMIT 1.95
+
+
+static int compare_double(const void* a, const void* b){
+  double da=*(const double*)a, db=*(const double*)b;
+  return((da>db)-(da<db));
+}
+
+/** ARF with NBINS bins between 0.1 and 10.1 keV. */
+static struct ARF* new_arf(){
+  struct ARF* arf=(struct ARF*)calloc(1,sizeof(struct ARF));
+  assert_non_null(arf);
+  arf->NumberEnergyBins=NBINS;
+  arf->LowEnergy=(float*)malloc(NBINS*sizeof(float));
+  arf->HighEnergy=(float*)malloc(NBINS*sizeof(float));
+  arf->EffArea=(float*)malloc(NBINS*sizeof(float));
+  assert_true(NULL!=arf->LowEnergy && NULL!=arf->HighEnergy && NULL!=arf->EffArea);
+  int ii;
+  for (ii=0; ii<NBINS; ii++){
+    arf->LowEnergy[ii]=0.1+ii*0.05;
+    arf->HighEnergy[ii]=0.1+(ii+1)*0.05;
+    arf->EffArea[ii]=(ii<20) ? 0. : 100.+ii;
+  }
+  return(arf);
+}
+
+static void free_arf(struct ARF* arf){
+  free(arf->LowEnergy);
+  free(arf->HighEnergy);
+  free(arf->EffArea);
+  free(arf);
+}
+
+/** Linear spectrum between 0.5 and 8 keV (such that the interpolation
+    between the grid points is exact). */
+static SimputMIdpSpec* new_spectrum(){
+  int status=EXIT_SUCCESS;
+  SimputMIdpSpec* spec=newSimputMIdpSpec(&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  spec->nentries=76;
+  spec->energy=(float*)malloc(spec->nentries*sizeof(float));
+  spec->pflux=(float*)malloc(spec->nentries*sizeof(float));
+  assert_true(NULL!=spec->energy && NULL!=spec->pflux);
+  long ii;
+  for (ii=0; ii<spec->nentries; ii++){
+    spec->energy[ii]=0.5+ii*0.1;
+    spec->pflux[ii]=10.-spec->energy[ii];
+  }
+  return(spec);
+}
+
+/** Maximum distance between the empirical distribution of the sorted
+    sample and the given distribution function. */
+static double ks_distance(const double* sorted, long n,
+			  double (*cdf)(double, const void*), const void* data){
+  double d=0.;
+  long ii;
+  for (ii=0; ii<n; ii++){
+    double f=cdf(sorted[ii],data);
+    d=MAX(d,MAX(f-(double)ii/n,(double)(ii+1)/n-f));
+  }
+  return(d);
+}
+
+/** Maximum distance between the empirical distributions of two sorted
+    samples. */
+static double ks_distance2(const double* a, long na, const double* b, long nb){
+  double d=0.;
+  long ia=0, ib=0;
+  while (ia<na && ib<nb){
+    double x=MIN(a[ia],b[ib]);
+    while (ia<na && a[ia]<=x) ia++;
+    while (ib<nb && b[ib]<=x) ib++;
+    d=MAX(d,fabs((double)ia/na-(double)ib/nb));
+  }
+  return(d);
+}
+
+/** Expected distribution function of the photon energies: the
+    spectrum folded with the ARF, evaluated at the bin centers, and
+    uniform within each bin. */
+static double folded_cdf(double energy, const void* data){
+  const struct ARF* arf=(const struct ARF*)data;
+  double sum=0., below=0.;
+  int ii;
+  for (ii=0; ii<NBINS; ii++){
+    double e=0.5*(arf->LowEnergy[ii]+arf->HighEnergy[ii]);
+    double w=(e>=0.5 && e<=8.) ? arf->EffArea[ii]*0.05*(10.-e) : 0.;
+    sum+=w;
+    if (energy>=arf->HighEnergy[ii]){
+      below+=w;
+    } else if (energy>arf->LowEnergy[ii]){
+      below+=w*(energy-arf->LowEnergy[ii])/0.05;
+    }
+  }
+  return(below/sum);
+}
+
+static double uniform_cdf(double x, const void* data){
+  const double* range=(const double*)data;
+  return(MAX(0.,MIN(1.,(x-range[0])/(range[1]-range[0]))));
+}
+
+/** The Poisson random numbers have the right mean and variance. */
+static void test_poisson(){
+  int status=EXIT_SUCCESS;
+  sixt_init_rng(11,&status);
+  double means[]={0.3,4.,25.,1.e4};
+  const long n=40000;
+  unsigned int ii;
+  for (ii=0; ii<sizeof(means)/sizeof(means[0]); ii++){
+    double sum=0., sum2=0.;
+    long jj;
+    for (jj=0; jj<n; jj++){
+      long k=rndpoisson(means[ii],&status);
+      assert_true(k>=0);
+      sum+=k;
+      sum2+=(double)k*k;
+    }
+    double mean=sum/n;
+    double var=sum2/n-mean*mean;
+    assert_true(fabs(mean-means[ii])<5.*sqrt(means[ii]/n));
+    assert_true(fabs(var/means[ii]-1.)<0.05);
+  }
+  assert_int_equal(rndpoisson(0.,&status),0);
+  assert_int_equal(status,EXIT_SUCCESS);
+  sixt_destroy_rng();
+}
+
+/** The energies follow the spectrum folded with the ARF, and the
+    arrival times are sorted and uniformly distributed within the
+    interval. */
+static void test_const_photons(){
+  int status=EXIT_SUCCESS;
+  sixt_init_rng(12,&status);
+  struct ARF* arf=new_arf();
+  SimputMIdpSpec* spec=new_spectrum();
+  PhotonEnergyTable* table=newPhotonEnergyTable(spec,arf,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_true(table->cdf[NBINS-1]==1.);
+  assert_true(table->cdf[19]==0.);
+
+  Photon* photons=NULL;
+  long nphotons=0, size=0;
+  const double rate=5000., t[2]={100.,120.};
+  long n=genConstSourcePhotons(table,rate,0.1,-0.2,7,t[0],t[1],
+			       &photons,&nphotons,&size,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_int_equal(n,nphotons);
+  assert_true(size>=nphotons);
+  assert_true(fabs(n-rate*(t[1]-t[0]))<5.*sqrt(rate*(t[1]-t[0])));
+
+  double* energy=(double*)malloc(n*sizeof(double));
+  double* time=(double*)malloc(n*sizeof(double));
+  assert_true(NULL!=energy && NULL!=time);
+  long ii;
+  for (ii=0; ii<n; ii++){
+    assert_true(photons[ii].time>t[0] && photons[ii].time<=t[1]);
+    if (ii>0) assert_true(photons[ii].time>=photons[ii-1].time);
+    assert_true(photons[ii].ra==0.1);
+    assert_true(photons[ii].dec==-0.2);
+    assert_int_equal(photons[ii].src_id,7);
+    assert_int_equal(photons[ii].ph_id,0);
+    energy[ii]=photons[ii].energy;
+    time[ii]=photons[ii].time;
+  }
+  qsort(energy,n,sizeof(double),compare_double);
+  assert_true(energy[0]>=arf->LowEnergy[20]);
+  assert_true(ks_distance(energy,n,folded_cdf,arf)<KS_LIMIT/sqrt(n));
+  assert_true(ks_distance(time,n,uniform_cdf,t)<KS_LIMIT/sqrt(n));
+
+  // Further photons are appended.
+  long n2=genConstSourcePhotons(table,rate,0.1,-0.2,7,t[1],t[1]+1.,
+				&photons,&nphotons,&size,&status);
+  assert_int_equal(nphotons,n+n2);
+  assert_true(photons[n].time>t[1]);
+
+  // Empty intervals.
+  assert_int_equal(genConstSourcePhotons(table,rate,0.,0.,1,t[1],t[1],
+					 &photons,&nphotons,&size,&status),0);
+  assert_int_equal(genConstSourcePhotons(table,0.,0.,0.,1,t[0],t[1],
+					 &photons,&nphotons,&size,&status),0);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  free(energy);
+  free(time);
+  free(photons);
+  freePhotonEnergyTable(&table);
+  assert_null(table);
+  freeSimputMIdpSpec(&spec);
+  free_arf(arf);
+  sixt_destroy_rng();
+}
+
+/** Photons of the first source of the catalog in [0,tend]. */
+static long get_photons(Source* const src, SimputCtlg* const cat,
+			PhotonEnergyTables* const energies, const double tend,
+			double** const energy){
+  int status=EXIT_SUCCESS;
+  LinkedPhoListElement* list=NULL;
+  LinkedPhoListElement** list_next=&list;
+  double t;
+  for (t=0.; t<tend; t+=1.){
+    // The photons of later intervals are appended at the end.
+    *list_next=getXRayPhotons(src,cat,energies,t,MIN(t+1.,tend),55000.,&status);
+    while (NULL!=*list_next){
+      list_next=&((*list_next)->next);
+    }
+  }
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  // The list is released element by element while it is read.
+  long n=0, size=1024;
+  *energy=(double*)malloc(size*sizeof(double));
+  double last=0.;
+  while (NULL!=list){
+    assert_true(list->photon.time>=last && list->photon.time<=tend);
+    last=list->photon.time;
+    if (n>=size){
+      size*=2;
+      *energy=(double*)realloc(*energy,size*sizeof(double));
+    }
+    (*energy)[n++]=list->photon.energy;
+    LinkedPhoListElement* next=list->next;
+    releaseLinkedPhoListElement(list);
+    list=next;
+  }
+  qsort(*energy,n,sizeof(double),compare_double);
+  return(n);
+}
+
+/** The photons of a constant point source created with the energy
+    table have the same distributions as the ones obtained from the
+    SIMPUT library for each photon. */
+static void test_simput_distribution(){
+  int status=EXIT_SUCCESS;
+  sixt_init_rng(13,&status);
+  setSimputRndGen(sixt_get_random_number);
+  SimputCtlg* cat=openSimputCtlg(SIMPUT_FILENAME,READONLY,0,0,0,0,&status);
+  struct ARF* arf=loadARF(ARF_FILENAME,&status);
+  setSimputARF(cat,arf);
+  SimputSrc* simputsrc=getSimputSrc(cat,1,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_true(isConstSimputSrc(simputsrc));
+  double rate=getSimputPhotonRate(cat,simputsrc,0.,55000.,&status);
+  assert_true(rate>0.);
+  const double tend=ceil(20000./rate);
+
+  PhotonEnergyTables* energies=newPhotonEnergyTables(&status);
+  Source* src[2];
+  double* energy[2];
+  long n[2];
+  int ii;
+  for (ii=0; ii<2; ii++){
+    src[ii]=newSource(&status);
+    src[ii]->ra=simputsrc->ra;
+    src[ii]->dec=simputsrc->dec;
+    src[ii]->row=1;
+    n[ii]=get_photons(src[ii],cat,(0==ii) ? NULL : energies,tend,&energy[ii]);
+  }
+  assert_null(src[0]->energies);
+  assert_non_null(src[1]->energies);
+  assert_int_equal(energies->ntables,1);
+
+  double expected=rate*tend;
+  assert_true(fabs(n[0]-expected)<5.*sqrt(expected));
+  assert_true(fabs(n[1]-expected)<5.*sqrt(expected));
+  assert_true(ks_distance2(energy[0],n[0],energy[1],n[1])<
+	      KS_LIMIT*sqrt((double)(n[0]+n[1])/n[0]/n[1]));
+
+  for (ii=0; ii<2; ii++){
+    free(energy[ii]);
+    freeSource(&src[ii]);
+  }
+  freePhotonEnergyTables(&energies);
+  assert_null(energies);
+  freeSimputCtlg(&cat,&status);
+  freeARF(arf);
+  sixt_destroy_rng();
+}
+
+#ifdef SIXT_BENCHMARK
+/** Reports the number of photons per second created for a bright
+    source with the SIMPUT library for each photon and with the energy
+    table. */
+static void benchmark_const_source(){
+  int status=EXIT_SUCCESS;
+  sixt_init_rng(14,&status);
+  setSimputRndGen(sixt_get_random_number);
+  SimputCtlg* cat=openSimputCtlg(SIMPUT_FILENAME,READONLY,0,0,0,0,&status);
+  struct ARF* arf=loadARF(ARF_FILENAME,&status);
+  setSimputARF(cat,arf);
+  SimputSrc* simputsrc=getSimputSrc(cat,1,&status);
+  double rate=getSimputPhotonRate(cat,simputsrc,0.,55000.,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  const double tend=ceil(5.e5/rate);
+
+  PhotonEnergyTables* energies=newPhotonEnergyTables(&status);
+  double speed[2];
+  int ii;
+  for (ii=0; ii<2; ii++){
+    Source* src=newSource(&status);
+    src->ra=simputsrc->ra;
+    src->dec=simputsrc->dec;
+    src->row=1;
+    double* energy;
+    clock_t start=clock();
+    long n=get_photons(src,cat,(0==ii) ? NULL : energies,tend,&energy);
+    speed[ii]=n/((double)(clock()-start)/CLOCKS_PER_SEC);
+    free(energy);
+    freeSource(&src);
+  }
+
+  printf("# source with %.3g photons/s: SIMPUT %.3g photons/s, "
+	 "energy table %.3g photons/s\n", rate, speed[0], speed[1]);
+
+  freePhotonEnergyTables(&energies);
+  freeSimputCtlg(&cat,&status);
+  freeARF(arf);
+  sixt_destroy_rng();
+}
+#endif
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_poisson),
+    cmocka_unit_test(test_const_photons),
+    cmocka_unit_test(test_simput_distribution),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_const_source),
+#endif
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
@@ -0,0 +1,272 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <time.h>
+
+#include "eventtransform.h"
+
+
+#define FILENAME "test_eventtransform.fits"
+#define FILENAME2 "test_eventtransform2.fits"
+#define NEVENTS 40000
+
+/** Event file with the columns of the event file template and
+    NEVENTS events. */
+static EventFile* create_event_file(const char* const filename){
+  int status=EXIT_SUCCESS;
+  fitsfile* fptr=NULL;
+  char name[MAXFILENAME];
+  sprintf(name,"!%s",filename);
+  fits_create_file(&fptr,name,&status);
+  char* ttype[]={"TIME","FRAME","PHA","PI","SIGNAL","RAWX","RAWY","RA","DEC",
+		 "PH_ID","SRC_ID","NPIXELS","TYPE","PILEUP","SIGNALS","PHAS"};
+  char* tform[]={"D","J","J","J","E","I","I","D","D",
+		 "2J","2J","J","I","I","9E","9J"};
+  fits_create_tbl(fptr,BINARY_TBL,0,16,ttype,tform,NULL,"EVENTS",&status);
+  fits_close_file(fptr,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  EventFile* file=openEventFile(filename,READWRITE,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  Event event;
+  clearEvent(&event);
+  long ii;
+  for (ii=0; ii<NEVENTS; ii++){
+    event.time=ii*0.1;
+    event.frame=ii;
+    event.pha=ii%4096;
+    event.pi=0;
+    event.signal=(ii%4096)*0.01;
+    event.rawx=ii%384;
+    event.rawy=(ii/384)%384;
+    event.ra=(ii%1000)*1.e-5;
+    event.dec=-(ii%777)*1.e-5;
+    event.ph_id[0]=ii+1;
+    event.src_id[0]=ii%5;
+    event.npixels=1+ii%4;
+    event.type=ii%14-1;
+    event.pileup=ii%2;
+    int jj;
+    for (jj=0; jj<9; jj++){
+      event.signals[jj]=jj*0.1;
+      event.phas[jj]=ii%100+jj;
+    }
+    addEvent2File(file,&event,&status);
+  }
+  flushEventFile(file,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  return(file);
+}
+
+static void assert_events_equal(const Event* a, const Event* b){
+  assert_true(a->time==b->time);
+  assert_int_equal(a->frame,b->frame);
+  assert_int_equal(a->pha,b->pha);
+  assert_int_equal(a->pi,b->pi);
+  assert_true(a->signal==b->signal);
+  assert_int_equal(a->rawx,b->rawx);
+  assert_int_equal(a->rawy,b->rawy);
+  assert_true(a->ra==b->ra);
+  assert_true(a->dec==b->dec);
+  assert_int_equal(a->ph_id[0],b->ph_id[0]);
+  assert_int_equal(a->src_id[1],b->src_id[1]);
+  assert_int_equal(a->npixels,b->npixels);
+  assert_int_equal(a->type,b->type);
+  assert_int_equal(a->pileup,b->pileup);
+  assert_true(a->signals[8]==b->signals[8]);
+  assert_int_equal(a->phas[4],b->phas[4]);
+}
+
+/** Blocks of columns are read and written like the single rows. */
+static void test_event_columns(){
+  int status=EXIT_SUCCESS;
+  EventFile* file=create_event_file(FILENAME);
+
+  const long firstrow=1000, nrows=3*EVENTFILE_BUFFERSIZE+17;
+  Event* events=(Event*)malloc(nrows*sizeof(Event));
+  assert_non_null(events);
+  readEventColumns(file,EVENTCOL_ALL,firstrow,nrows,events,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  long ii;
+  for (ii=0; ii<nrows; ii++){
+    Event event;
+    getEventFromFile(file,firstrow+ii,&event,&status);
+    assert_events_equal(&events[ii],&event);
+  }
+
+  // Only the selected column is changed.
+  for (ii=0; ii<nrows; ii++){
+    events[ii].pha+=7;
+    events[ii].rawx=-1;
+  }
+  writeEventColumns(file,EVENTCOL_PHA,firstrow,nrows,events,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  for (ii=0; ii<nrows; ii++){
+    Event event;
+    getEventFromFile(file,firstrow+ii,&event,&status);
+    events[ii].rawx=event.rawx;
+    assert_events_equal(&events[ii],&event);
+    assert_int_equal(event.pha,(firstrow+ii-1)%4096+7);
+  }
+
+  // Rows beyond the end of the file.
+  readEventColumns(file,EVENTCOL_PHA,NEVENTS,2,events,&status);
+  assert_int_equal(status,EXIT_FAILURE);
+
+  free(events);
+  status=EXIT_SUCCESS;
+  freeEventFile(&file,&status);
+  remove(FILENAME);
+}
+
+static void set_pi(EventFile* const file, const long firstrow,
+		   Event* const events, const long nevents,
+		   void* const data, int* const status){
+  (void)file;
+  (void)firstrow;
+  (void)data;
+  (void)status;
+  long ii;
+  for (ii=0; ii<nevents; ii++){
+    events[ii].pi=2*events[ii].pha+events[ii].type;
+  }
+}
+
+static void set_rawx(EventFile* const file, const long firstrow,
+		     Event* const events, const long nevents,
+		     void* const data, int* const status){
+  (void)file;
+  (void)firstrow;
+  (void)data;
+  (void)status;
+  long ii;
+  for (ii=0; ii<nevents; ii++){
+    events[ii].rawx=events[ii].pi%100;
+  }
+}
+
+/** Fused transforms yield the same file as separate passes. */
+static void test_fused_transforms(){
+  int status=EXIT_SUCCESS;
+  EventFile* fused=create_event_file(FILENAME);
+  EventFile* separate=create_event_file(FILENAME2);
+  EventTransform* transforms[2];
+  transforms[0]=newEventTransform(set_pi,NULL,NULL,EVENTCOL_PHA|EVENTCOL_TYPE,
+				  EVENTCOL_PI,&status);
+  transforms[1]=newEventTransform(set_rawx,NULL,NULL,EVENTCOL_PI,
+				  EVENTCOL_RAWX,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  runEventTransforms(fused,transforms,2,&status);
+  runEventTransforms(separate,&transforms[0],1,&status);
+  runEventTransforms(separate,&transforms[1],1,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  long row;
+  for (row=1; row<=NEVENTS; row++){
+    Event a, b;
+    getEventFromFile(fused,row,&a,&status);
+    getEventFromFile(separate,row,&b,&status);
+    assert_events_equal(&a,&b);
+    assert_int_equal(a.pi,2*((row-1)%4096)+(row-1)%14-1);
+    assert_int_equal(a.rawx,a.pi%100);
+    assert_int_equal(a.rawy,((row-1)/384)%384);
+  }
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  freeEventTransform(&transforms[0]);
+  freeEventTransform(&transforms[1]);
+  assert_null(transforms[0]);
+  freeEventFile(&fused,&status);
+  freeEventFile(&separate,&status);
+  remove(FILENAME);
+  remove(FILENAME2);
+}
+
+static void fail_second_block(EventFile* const file, const long firstrow,
+			      Event* const events, const long nevents,
+			      void* const data, int* const status){
+  set_pi(file,firstrow,events,nevents,data,status);
+  if (firstrow>1){
+    *status=EXIT_FAILURE;
+  }
+}
+
+/** After an error no further blocks are written. */
+static void test_transform_error(){
+  int status=EXIT_SUCCESS;
+  EventFile* file=create_event_file(FILENAME);
+  EventTransform* transform=
+    newEventTransform(fail_second_block,NULL,NULL,EVENTCOL_PHA|EVENTCOL_TYPE,
+		      EVENTCOL_PI,&status);
+  runEventTransforms(file,&transform,1,&status);
+  assert_int_equal(status,EXIT_FAILURE);
+
+  status=EXIT_SUCCESS;
+  Event event;
+  getEventFromFile(file,EVENTTRANSFORM_BLOCKSIZE,&event,&status);
+  assert_int_equal(event.pi,2*event.pha+event.type);
+  getEventFromFile(file,EVENTTRANSFORM_BLOCKSIZE+1,&event,&status);
+  assert_int_equal(event.pi,0);
+
+  freeEventTransform(&transform);
+  freeEventFile(&file,&status);
+  remove(FILENAME);
+}
+
+#ifdef SIXT_BENCHMARK
+/** Reports the time needed to set the PI values of all events by
+    reading and updating the rows one after another (as done by
+    pha2pi_correct_eventfile() before) and with a transform. */
+static void benchmark_eventtransform(){
+  int status=EXIT_SUCCESS;
+  EventFile* file=create_event_file(FILENAME);
+
+  clock_t start=clock();
+  long row;
+  for (row=1; row<=NEVENTS; row++){
+    Event event;
+    getEventFromFile(file,row,&event,&status);
+    event.pi=2*event.pha+event.type;
+    updateEventInFile(file,row,&event,&status);
+  }
+  double t_rows=(double)(clock()-start)/CLOCKS_PER_SEC;
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  EventTransform* transform=
+    newEventTransform(set_pi,NULL,NULL,EVENTCOL_PHA|EVENTCOL_TYPE,
+		      EVENTCOL_PI,&status);
+  start=clock();
+  runEventTransforms(file,&transform,1,&status);
+  double t_transform=(double)(clock()-start)/CLOCKS_PER_SEC;
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  printf("# %d events: row by row %.3fs, transform %.3fs\n",
+	 NEVENTS, t_rows, t_transform);
+
+  freeEventTransform(&transform);
+  freeEventFile(&file,&status);
+  remove(FILENAME);
+}
+#endif
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_event_columns),
+    cmocka_unit_test(test_fused_transforms),
+    cmocka_unit_test(test_transform_error),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_eventtransform),
+#endif
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
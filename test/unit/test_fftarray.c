@@ -0,0 +1,223 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <time.h>
+
+#include "sixt.h"
+
+#include "fft_array.h"
+
+
+/** Cross-correlation of an event image with a reconstruction array
+    as done by comarecon before the plan cache: c2c transforms of the
+    real-valued images, with a plan created with FFTW_ESTIMATE and
+    destroyed for every transform. */
+static fftw_complex* c2c_estimate(fftw_complex* input, const int n1, const int n2, const int sign){
+	fftw_complex* output = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*n1*n2);
+	assert_non_null(output);
+	fftw_plan plan = fftw_plan_dft_2d(n1, n2, input, output, sign, FFTW_ESTIMATE);
+	assert_non_null(plan);
+	fftw_execute(plan);
+	fftw_destroy_plan(plan);
+	return (output);
+}
+
+static double* correlate_c2c(const double* events, const double* recon, const int n1, const int n2){
+	const long n = (long)n1*n2;
+	fftw_complex* ein = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*n);
+	fftw_complex* rin = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*n);
+	assert_non_null(ein);
+	assert_non_null(rin);
+	long kk;
+	for (kk=0; kk<n; kk++){
+		ein[kk][0] = events[kk];
+		ein[kk][1] = 0.;
+		rin[kk][0] = recon[kk];
+		rin[kk][1] = 0.;
+	}
+	fftw_complex* efft = c2c_estimate(ein, n1, n2, FFTW_FORWARD);
+	fftw_complex* rfft = c2c_estimate(rin, n1, n2, FFTW_FORWARD);
+	for (kk=0; kk<n; kk++){
+		ein[kk][0] = efft[kk][0]*rfft[kk][0]+efft[kk][1]*rfft[kk][1];
+		ein[kk][1] = -efft[kk][0]*rfft[kk][1]+efft[kk][1]*rfft[kk][0];
+	}
+	fftw_complex* product = c2c_estimate(ein, n1, n2, FFTW_BACKWARD);
+
+	double* image = (double*)malloc(sizeof(double)*n);
+	assert_non_null(image);
+	for (kk=0; kk<n; kk++){
+		image[kk] = product[kk][0]/n;
+	}
+	fftw_free(ein);
+	fftw_free(rin);
+	fftw_free(efft);
+	fftw_free(rfft);
+	fftw_free(product);
+	return (image);
+}
+
+/** The same cross-correlation with the cached r2c/c2r transforms, as
+    done by comarecon now. */
+static double* correlate_r2c(const double* events, const double* recon, const int n1, const int n2){
+	int status = EXIT_SUCCESS;
+	fftw_complex* efft = FFTOfArray_r2c(events, n1, n2, &status);
+	fftw_complex* rfft = FFTOfArray_r2c(recon, n1, n2, &status);
+	assert_int_equal(status, EXIT_SUCCESS);
+	const long nfft = (long)n1*(n2/2+1);
+	fftw_complex* multiply = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*nfft);
+	assert_non_null(multiply);
+	long kk;
+	for (kk=0; kk<nfft; kk++){
+		multiply[kk][0] = efft[kk][0]*rfft[kk][0]+efft[kk][1]*rfft[kk][1];
+		multiply[kk][1] = -efft[kk][0]*rfft[kk][1]+efft[kk][1]*rfft[kk][0];
+	}
+	double* product = FFTOfArray_c2r(multiply, n1, n2, &status);
+	assert_int_equal(status, EXIT_SUCCESS);
+
+	const long n = (long)n1*n2;
+	double* image = (double*)malloc(sizeof(double)*n);
+	assert_non_null(image);
+	for (kk=0; kk<n; kk++){
+		image[kk] = product[kk]/n;
+	}
+	fftw_free(efft);
+	fftw_free(rfft);
+	fftw_free(product);
+	return (image);
+}
+
+/** Event image with a few counts per pixel and a reconstruction array
+    of +1/-1 entries (open/closed mask elements). */
+static void random_images(double* events, double* recon, const long n, const unsigned int seed){
+	srand(seed);
+	long kk;
+	for (kk=0; kk<n; kk++){
+		events[kk] = rand()%5;
+		recon[kk] = (rand()%2) ? 1. : -1.;
+	}
+}
+
+static void assert_images_equal(const double* a, const double* b, const long n){
+	double max = 0., diff = 0.;
+	long kk;
+	for (kk=0; kk<n; kk++){
+		max = fmax(max, fabs(a[kk]));
+		diff = fmax(diff, fabs(a[kk]-b[kk]));
+	}
+	assert_true(max > 0.);
+	assert_true(diff <= 1e-9*max);
+}
+
+/** The cached r2c/c2r path gives the same sky image as the c2c path,
+    for even and odd dimensions and for input arrays with and without
+    the alignment of fftw_malloc (the plans are created for aligned
+    arrays and applied with the new-array execute functions). */
+static void test_fftarray_r2c_c2c(void **state){
+	(void)state;
+	const int sizes[][2] = {{64, 64}, {96, 80}, {75, 61}, {64, 33}};
+	unsigned int ss;
+	for (ss=0; ss<sizeof(sizes)/sizeof(sizes[0]); ss++){
+		const int n1 = sizes[ss][0], n2 = sizes[ss][1];
+		const long n = (long)n1*n2;
+
+		// Aligned arrays and copies shifted by one double.
+		double* events = (double*)fftw_malloc(sizeof(double)*n);
+		double* recon = (double*)fftw_malloc(sizeof(double)*n);
+		double* shifted = (double*)fftw_malloc(sizeof(double)*(2*n+2));
+		assert_non_null(events);
+		assert_non_null(recon);
+		assert_non_null(shifted);
+		random_images(events, recon, n, ss+1);
+		double* events_shifted = shifted+1;
+		double* recon_shifted = shifted+n+2;
+		memcpy(events_shifted, events, sizeof(double)*n);
+		memcpy(recon_shifted, recon, sizeof(double)*n);
+		assert_int_equal(fftw_alignment_of(events), 0);
+		assert_int_not_equal(fftw_alignment_of(events_shifted), 0);
+
+		double* reference = correlate_c2c(events, recon, n1, n2);
+		double* aligned = correlate_r2c(events, recon, n1, n2);
+		double* unaligned = correlate_r2c(events_shifted, recon_shifted, n1, n2);
+		// Once more with the cached plans.
+		double* cached = correlate_r2c(events, recon, n1, n2);
+		assert_images_equal(reference, aligned, n);
+		assert_images_equal(reference, unaligned, n);
+		assert_memory_equal(aligned, cached, sizeof(double)*n);
+
+		free(reference);
+		free(aligned);
+		free(unaligned);
+		free(cached);
+		fftw_free(events);
+		fftw_free(recon);
+		fftw_free(shifted);
+	}
+
+	int status = EXIT_SUCCESS;
+	freeFFTPlans(NULL, &status);
+	assert_int_equal(status, EXIT_SUCCESS);
+}
+
+#ifdef SIXT_BENCHMARK
+/** Sky images per second of a 1024x1024 detector reconstructed with
+    the c2c path (planned for every transform) and with the cached
+    r2c/c2r path. */
+static void benchmark_fftarray_1024(void **state){
+	(void)state;
+	const int n1 = 1024, n2 = 1024;
+	const long n = (long)n1*n2;
+	const int nimages = 10;
+	double* events = (double*)fftw_malloc(sizeof(double)*n);
+	double* recon = (double*)fftw_malloc(sizeof(double)*n);
+	assert_non_null(events);
+	assert_non_null(recon);
+	random_images(events, recon, n, 7);
+
+	double* c2c = NULL;
+	double* r2c = NULL;
+	int ii;
+	clock_t start = clock();
+	for (ii=0; ii<nimages; ii++){
+		free(c2c);
+		c2c = correlate_c2c(events, recon, n1, n2);
+	}
+	double t_c2c = (double)(clock()-start)/CLOCKS_PER_SEC;
+
+	start = clock();
+	for (ii=0; ii<nimages; ii++){
+		free(r2c);
+		r2c = correlate_r2c(events, recon, n1, n2);
+	}
+	double t_r2c = (double)(clock()-start)/CLOCKS_PER_SEC;
+
+	printf("# %dx%d: c2c with FFTW_ESTIMATE plans %.2f images/s, cached r2c/c2r plans %.2f images/s (speed-up %.2f)\n",
+	       n1, n2, nimages/fmax(t_c2c, 1e-9), nimages/fmax(t_r2c, 1e-9), t_c2c/fmax(t_r2c, 1e-9));
+	assert_images_equal(c2c, r2c, n);
+
+	free(c2c);
+	free(r2c);
+	fftw_free(events);
+	fftw_free(recon);
+	int status = EXIT_SUCCESS;
+	freeFFTPlans(NULL, &status);
+}
+#endif
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_fftarray_r2c_c2c),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_fftarray_1024),
+#endif
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
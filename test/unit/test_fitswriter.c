@@ -0,0 +1,569 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <time.h>
+#include <unistd.h>
+
+#include "fitswriter.h"
+#include "eventfile.h"
+#include "impactfile.h"
+#include "testriggerfile.h"
+
+
+#define NROWS 10000
+#define BLOCKSIZE 64
+
+/** Number of rows written to the real FITS files (not a multiple of
+    the block sizes of the files). */
+#define NFILEROWS 2500
+#define TRIGGERSIZE 100
+
+/** Ways of writing the FITS files, which have to give the same
+    output. */
+enum {WRITE_DIRECT, WRITE_BLOCKS, WRITE_THREAD, WRITE_SHARED, NWRITEMODES};
+
+/** Table emulating the FITS file: rows of variable length with their
+    first value being the row number of the producer. */
+typedef struct {
+  long* value;
+  long* tablerow;
+  long nrows;
+  long nblocks;
+
+  /** Block, at which an error is raised (0 for none). */
+  long failblock;
+
+  /** Latency of the writing of a block (microseconds). */
+  useconds_t latency;
+} MockTable;
+
+static void write_mock_block(fitsfile* const fptr, const long firstrow,
+			     const long nrows, void* const* const rows,
+			     void* const data, int* const status){
+  (void)fptr;
+  MockTable* table=(MockTable*)data;
+  table->nblocks++;
+  if (table->nblocks==table->failblock){
+    *status=EXIT_FAILURE;
+    return;
+  }
+  if (table->latency>0){
+    usleep(table->latency);
+  }
+  long ii;
+  for (ii=0; ii<nrows; ii++){
+    const long* row=(const long*)rows[ii];
+    long jj;
+    for (jj=1; jj<=row[0]%7; jj++){
+      assert_int_equal(row[jj],row[0]+jj);
+    }
+    table->value[table->nrows]=row[0];
+    table->tablerow[table->nrows]=firstrow+ii;
+    table->nrows++;
+  }
+}
+
+static MockTable* new_mock_table(){
+  MockTable* table=(MockTable*)calloc(1,sizeof(MockTable));
+  assert_non_null(table);
+  table->value=(long*)malloc(NROWS*sizeof(long));
+  table->tablerow=(long*)malloc(NROWS*sizeof(long));
+  assert_true(NULL!=table->value && NULL!=table->tablerow);
+  return(table);
+}
+
+static void free_mock_table(MockTable* table){
+  free(table->value);
+  free(table->tablerow);
+  free(table);
+}
+
+/** Add 'n' rows with 1 to 7 values each, starting at row number
+    'first'. */
+static void add_rows(FitsWriter* writer, long first, long n, int* status){
+  long ii;
+  for (ii=first; ii<first+n; ii++){
+    long nvalues=1+ii%7;
+    long* row=(long*)addFitsWriterRow(writer,nvalues*sizeof(long),status);
+    if (NULL==row) return;
+    long jj;
+    for (jj=0; jj<nvalues; jj++){
+      row[jj]=ii+jj;
+    }
+  }
+}
+
+static void check_rows(const MockTable* table, long n, long firstrow){
+  assert_int_equal(table->nrows,n);
+  long ii;
+  for (ii=0; ii<n; ii++){
+    assert_int_equal(table->value[ii],ii);
+    assert_int_equal(table->tablerow[ii],firstrow+ii);
+  }
+}
+
+/** All rows arrive in order at the right table rows, with and
+    without the thread. */
+static void test_fitswriter_order(){
+  int threaded;
+  for (threaded=0; threaded<=1; threaded++){
+    int status=EXIT_SUCCESS;
+    MockTable* table=new_mock_table();
+    FitsWriter* writer=newFitsWriter(NULL,5,2*sizeof(long),BLOCKSIZE,3,threaded,
+				     write_mock_block,table,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    add_rows(writer,0,NROWS,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    destroyFitsWriter(&writer,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    assert_null(writer);
+    check_rows(table,NROWS,5);
+    free_mock_table(table);
+  }
+}
+
+/** After a flush all rows are written, also an incomplete block. */
+static void test_fitswriter_flush(){
+  int status=EXIT_SUCCESS;
+  MockTable* table=new_mock_table();
+  FitsWriter* writer=newFitsWriter(NULL,1,sizeof(long),BLOCKSIZE,2,1,
+				   write_mock_block,table,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  table->latency=1000;
+
+  add_rows(writer,0,BLOCKSIZE*3+10,&status);
+  flushFitsWriter(writer,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  check_rows(table,BLOCKSIZE*3+10,1);
+
+  // Flushing an idle writer has no effect.
+  long nblocks=table->nblocks;
+  flushFitsWriter(writer,&status);
+  assert_int_equal(table->nblocks,nblocks);
+
+  add_rows(writer,BLOCKSIZE*3+10,5,&status);
+  flushFitsWriter(writer,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  check_rows(table,BLOCKSIZE*3+15,1);
+
+  destroyFitsWriter(&writer,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_int_equal(table->nblocks,nblocks+1);
+  free_mock_table(table);
+}
+
+/** Several files share the blocks and the thread of one pool. The
+    rows of each file arrive in order at the right table rows. */
+static void test_fitswriter_shared(){
+  const int nfiles=5;
+  int threaded;
+  for (threaded=0; threaded<=1; threaded++){
+    int status=EXIT_SUCCESS;
+    FitsWriterPool* pool=newFitsWriterPool(2*sizeof(long),BLOCKSIZE,2,threaded,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    MockTable* table[nfiles];
+    FitsWriter* writer[nfiles];
+    int ii;
+    for (ii=0; ii<nfiles; ii++){
+      table[ii]=new_mock_table();
+      writer[ii]=newSharedFitsWriter(pool,NULL,ii+1,write_mock_block,table[ii],&status);
+      assert_int_equal(status,EXIT_SUCCESS);
+    }
+
+    // Rows of the files are added in turns of different lengths.
+    long nrows[nfiles];
+    memset(nrows,0,sizeof(nrows));
+    long jj;
+    for (jj=0; jj<NROWS/2; jj++){
+      ii=(jj*jj)%nfiles;
+      long n=1+jj%3;
+      if (nrows[ii]+n>NROWS) continue;
+      add_rows(writer[ii],nrows[ii],n,&status);
+      nrows[ii]+=n;
+    }
+    assert_int_equal(status,EXIT_SUCCESS);
+
+    // Destroying a writer flushes the rows of all files.
+    destroyFitsWriter(&writer[0],&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    for (ii=0; ii<nfiles; ii++){
+      check_rows(table[ii],nrows[ii],ii+1);
+    }
+
+    for (ii=1; ii<nfiles; ii++){
+      destroyFitsWriter(&writer[ii],&status);
+    }
+    destroyFitsWriterPool(&pool,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    assert_null(pool);
+    for (ii=0; ii<nfiles; ii++){
+      free_mock_table(table[ii]);
+    }
+  }
+}
+
+/** Rows larger than the block buffer are written in blocks of their
+    own. */
+static void test_fitswriter_large_rows(){
+  int status=EXIT_SUCCESS;
+  MockTable* table=new_mock_table();
+  FitsWriter* writer=newFitsWriter(NULL,1,1,4,2,0,write_mock_block,table,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  add_rows(writer,0,100,&status);
+  destroyFitsWriter(&writer,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  check_rows(table,100,1);
+  free_mock_table(table);
+}
+
+/** An error of the writer is passed to the producer. */
+static void test_fitswriter_error(){
+  int threaded;
+  for (threaded=0; threaded<=1; threaded++){
+    int status=EXIT_SUCCESS;
+    MockTable* table=new_mock_table();
+    table->failblock=3;
+    FitsWriter* writer=newFitsWriter(NULL,1,8*sizeof(long),BLOCKSIZE,2,threaded,
+				     write_mock_block,table,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    add_rows(writer,0,NROWS,&status);
+    assert_int_equal(status,EXIT_FAILURE);
+
+    // No further blocks are written.
+    assert_int_equal(table->nrows,2*BLOCKSIZE);
+    status=EXIT_SUCCESS;
+    destroyFitsWriter(&writer,&status);
+    assert_int_equal(status,EXIT_FAILURE);
+    assert_null(writer);
+    assert_int_equal(table->nrows,2*BLOCKSIZE);
+    free_mock_table(table);
+  }
+}
+
+static void test_fitswriter_invalid(){
+  int status=EXIT_SUCCESS;
+  FitsWriter* writer=newFitsWriter(NULL,1,8,0,2,0,write_mock_block,NULL,&status);
+  assert_null(writer);
+  assert_int_equal(status,EXIT_FAILURE);
+
+  // Destroying and flushing no writer is allowed.
+  status=EXIT_SUCCESS;
+  destroyFitsWriter(&writer,&status);
+  flushFitsWriter(writer,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+}
+
+/** Both files have the same HDUs with the same header cards (apart
+    from the DATE and CHECKSUM keywords) and the same data units,
+    including the heap, byte for byte. */
+static void assert_files_equal(const char* const filename1,
+			       const char* const filename2){
+  int status=EXIT_SUCCESS;
+  fitsfile* fptr[2]={NULL,NULL};
+  fits_open_file(&fptr[0],filename1,READONLY,&status);
+  fits_open_file(&fptr[1],filename2,READONLY,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  FILE* fp[2]={fopen(filename1,"rb"),fopen(filename2,"rb")};
+  assert_true(NULL!=fp[0] && NULL!=fp[1]);
+
+  int nhdus[2];
+  fits_get_num_hdus(fptr[0],&nhdus[0],&status);
+  fits_get_num_hdus(fptr[1],&nhdus[1],&status);
+  assert_int_equal(nhdus[0],nhdus[1]);
+
+  int hdu;
+  for (hdu=1; hdu<=nhdus[0]; hdu++){
+    int nkeys[2], kk, hdutype;
+    for (kk=0; kk<2; kk++){
+      fits_movabs_hdu(fptr[kk],hdu,&hdutype,&status);
+      fits_get_hdrspace(fptr[kk],&nkeys[kk],NULL,&status);
+    }
+    assert_int_equal(status,EXIT_SUCCESS);
+    assert_int_equal(nkeys[0],nkeys[1]);
+
+    int ii;
+    for (ii=1; ii<=nkeys[0]; ii++){
+      char card[2][FLEN_CARD];
+      fits_read_record(fptr[0],ii,card[0],&status);
+      fits_read_record(fptr[1],ii,card[1],&status);
+      assert_int_equal(status,EXIT_SUCCESS);
+      if ((0==strncmp(card[0],"DATE    ",8))||(0==strncmp(card[0],"CHECKSUM",8))){
+	assert_memory_equal(card[0],card[1],8);
+	continue;
+      }
+      assert_string_equal(card[0],card[1]);
+    }
+
+    LONGLONG headstart[2], datastart[2], dataend[2];
+    for (kk=0; kk<2; kk++){
+      fits_get_hduaddrll(fptr[kk],&headstart[kk],&datastart[kk],&dataend[kk],&status);
+    }
+    assert_int_equal(status,EXIT_SUCCESS);
+    assert_true(datastart[0]==datastart[1] && dataend[0]==dataend[1]);
+    const size_t size=dataend[0]-datastart[0];
+    char* data[2];
+    for (kk=0; kk<2; kk++){
+      data[kk]=(char*)malloc(size+1);
+      assert_non_null(data[kk]);
+      assert_int_equal(fseek(fp[kk],datastart[kk],SEEK_SET),0);
+      assert_int_equal(fread(data[kk],1,size,fp[kk]),size);
+    }
+    assert_memory_equal(data[0],data[1],size);
+    free(data[0]);
+    free(data[1]);
+  }
+
+  fclose(fp[0]);
+  fclose(fp[1]);
+  fits_close_file(fptr[0],&status);
+  fits_close_file(fptr[1],&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+}
+
+/** Empty binary table with the given columns. */
+static void create_table(const char* const filename, const char* const extname,
+			 const int ncols, char** ttype, char** tform){
+  int status=EXIT_SUCCESS;
+  fitsfile* fptr=NULL;
+  char name[MAXFILENAME];
+  sprintf(name,"!%s",filename);
+  fits_create_file(&fptr,name,&status);
+  fits_create_tbl(fptr,BINARY_TBL,0,ncols,ttype,tform,NULL,extname,&status);
+  fits_close_file(fptr,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+}
+
+/** The impact files written directly, in blocks, and by the writer
+    thread are identical. */
+static void test_fitswriter_impact_files(){
+  char* ttype[]={"TIME","ENERGY","X","Y","PH_ID","SRC_ID"};
+  char* tform[]={"D","E","D","D","J","J"};
+  char filename[NWRITEMODES][MAXFILENAME];
+  int mode;
+  for (mode=WRITE_DIRECT; mode<=WRITE_THREAD; mode++){
+    int status=EXIT_SUCCESS;
+    sprintf(filename[mode],"test_fitswriter_impact%d.fits",mode);
+    create_table(filename[mode],"IMPACTS",6,ttype,tform);
+    ImpactFile* file=openImpactFile(filename[mode],READWRITE,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    if (WRITE_DIRECT!=mode){
+      startImpactFileWriter(file,(WRITE_THREAD==mode),&status);
+    }
+    long ii;
+    for (ii=0; ii<NFILEROWS; ii++){
+      Impact impact;
+      impact.time=ii*0.37;
+      impact.energy=0.1+(ii%997)*0.013;
+      impact.position.x=(ii%311)*1.e-4-0.015;
+      impact.position.y=-(ii%293)*1.e-4+0.014;
+      impact.ph_id=ii+1;
+      impact.src_id=ii%3;
+      addImpact2File(file,&impact,&status);
+      // Direct accesses in between (e.g., by the checkpoints).
+      if (NFILEROWS/3==ii){
+	flushImpactFile(file,&status);
+      }
+    }
+    freeImpactFile(&file,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+  }
+  assert_files_equal(filename[WRITE_DIRECT],filename[WRITE_BLOCKS]);
+  assert_files_equal(filename[WRITE_DIRECT],filename[WRITE_THREAD]);
+  for (mode=WRITE_DIRECT; mode<=WRITE_THREAD; mode++){
+    remove(filename[mode]);
+  }
+}
+
+/** The event files written without writer, in blocks, and by the
+    writer thread are identical. */
+static void test_fitswriter_event_files(){
+  char* ttype[]={"TIME","FRAME","PHA","PI","SIGNAL","RAWX","RAWY","RA","DEC",
+		 "PH_ID","SRC_ID","NPIXELS","TYPE","PILEUP","SIGNALS","PHAS"};
+  char* tform[]={"D","J","J","J","E","I","I","D","D",
+		 "2J","2J","J","I","I","9E","9J"};
+  char filename[NWRITEMODES][MAXFILENAME];
+  int mode;
+  for (mode=WRITE_DIRECT; mode<=WRITE_THREAD; mode++){
+    int status=EXIT_SUCCESS;
+    sprintf(filename[mode],"test_fitswriter_event%d.fits",mode);
+    create_table(filename[mode],"EVENTS",16,ttype,tform);
+    EventFile* file=openEventFile(filename[mode],READWRITE,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    if (WRITE_DIRECT!=mode){
+      startEventFileWriter(file,(WRITE_THREAD==mode),&status);
+    }
+    Event event;
+    clearEvent(&event);
+    long ii;
+    for (ii=0; ii<NFILEROWS; ii++){
+      event.time=ii*0.1;
+      event.frame=ii;
+      event.pha=ii%4096;
+      event.signal=(ii%4096)*0.01;
+      event.rawx=ii%384;
+      event.rawy=(ii/384)%384;
+      event.ra=(ii%1000)*1.e-5;
+      event.dec=-(ii%777)*1.e-5;
+      event.ph_id[0]=ii+1;
+      event.ph_id[1]=(ii%5==0) ? ii : 0;
+      event.src_id[0]=ii%5;
+      event.npixels=1+ii%4;
+      event.type=ii%14-1;
+      event.pileup=ii%2;
+      int jj;
+      for (jj=0; jj<9; jj++){
+	event.signals[jj]=jj*0.1+ii*1.e-3;
+	event.phas[jj]=ii%100+jj;
+      }
+      addEvent2File(file,&event,&status);
+      if (NFILEROWS/3==ii){
+	flushEventFile(file,&status);
+      }
+    }
+    freeEventFile(&file,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+  }
+  assert_files_equal(filename[WRITE_DIRECT],filename[WRITE_BLOCKS]);
+  assert_files_equal(filename[WRITE_DIRECT],filename[WRITE_THREAD]);
+  for (mode=WRITE_DIRECT; mode<=WRITE_THREAD; mode++){
+    remove(filename[mode]);
+  }
+}
+
+/** The trigger files written directly, in blocks, by the writer
+    thread, and by a thread shared with a second file are identical,
+    also with shorter records and the variable-length PH_ID
+    column. */
+static void test_fitswriter_trigger_files(){
+  char filename[NWRITEMODES][MAXFILENAME];
+  int write_doubles;
+  for (write_doubles=0; write_doubles<=1; write_doubles++){
+    int mode;
+    for (mode=WRITE_DIRECT; mode<NWRITEMODES; mode++){
+      int status=EXIT_SUCCESS;
+      SixtStdKeywords* keywords=buildSixtStdKeywords("TEST","TEST","NONE","NONE","NONE",
+						     "RECORDS",55000.,0.,0.,NFILEROWS,&status);
+      assert_int_equal(status,EXIT_SUCCESS);
+      sprintf(filename[mode],"!test_fitswriter_trigger%d.fits",mode);
+      TesTriggerFile* file=opennewTesTriggerFile(filename[mode],keywords,"none","none",
+						 TRIGGERSIZE,10,156250.,write_doubles,1,&status);
+      TesTriggerFile* other=NULL;
+      FitsWriterPool* pool=NULL;
+      assert_int_equal(status,EXIT_SUCCESS);
+      if ((WRITE_BLOCKS==mode)||(WRITE_THREAD==mode)){
+	startTesTriggerFileWriter(file,(WRITE_THREAD==mode),&status);
+      } else if (WRITE_SHARED==mode){
+	other=opennewTesTriggerFile("!test_fitswriter_trigger_other.fits",keywords,"none","none",
+				    TRIGGERSIZE,10,156250.,write_doubles,1,&status);
+	pool=newTesTriggerFileWriterPool(TRIGGERSIZE,write_doubles,1,&status);
+	startTesTriggerFileSharedWriter(file,pool,&status);
+	startTesTriggerFileSharedWriter(other,pool,&status);
+      }
+      assert_int_equal(status,EXIT_SUCCESS);
+
+      TesRecord* record=createTesRecord(TRIGGERSIZE,6.4e-6,0,&status);
+      assert_int_equal(status,EXIT_SUCCESS);
+      long ii;
+      for (ii=0; ii<NFILEROWS; ii++){
+	record->trigger_size=(ii%50==49) ? TRIGGERSIZE/2+ii%7 : TRIGGERSIZE;
+	record->time=ii*1.e-3;
+	record->pixid=1+ii%16;
+	unsigned long jj;
+	for (jj=0; jj<record->trigger_size; jj++){
+	  record->adc_array[jj]=(uint16_t)((ii*31+jj*7)%65536);
+	  record->adc_double[jj]=ii+jj*0.25;
+	}
+	record->phid_list->index=ii%4;
+	int kk;
+	for (kk=0; kk<record->phid_list->index; kk++){
+	  record->phid_list->phid_array[kk]=ii*4+kk+1;
+	}
+	writeRecord(file,record,&status);
+	if (NULL!=other){
+	  writeRecord(other,record,&status);
+	}
+	if (NFILEROWS/3==ii){
+	  flushTesTriggerFile(file,&status);
+	}
+      }
+      assert_int_equal(status,EXIT_SUCCESS);
+      freeTesRecord(&record);
+      freeTesTriggerFile(&file,&status);
+      freeTesTriggerFile(&other,&status);
+      destroyFitsWriterPool(&pool,&status);
+      freeSixtStdKeywords(keywords);
+      assert_int_equal(status,EXIT_SUCCESS);
+    }
+    for (mode=WRITE_BLOCKS; mode<NWRITEMODES; mode++){
+      assert_files_equal(filename[WRITE_DIRECT]+1,filename[mode]+1);
+    }
+    for (mode=WRITE_DIRECT; mode<NWRITEMODES; mode++){
+      remove(filename[mode]+1);
+    }
+    remove("test_fitswriter_trigger_other.fits");
+  }
+}
+
+#ifdef SIXT_BENCHMARK
+static double wall_time(){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return(ts.tv_sec+ts.tv_nsec*1.e-9);
+}
+
+/** Reports the time needed to produce rows, which take about as long
+    to generate as to write (e.g., on a network file system), with
+    and without the writer thread. */
+static void benchmark_fitswriter(){
+  const long nrows=BLOCKSIZE*50;
+  double t[2];
+  int threaded;
+  for (threaded=0; threaded<=1; threaded++){
+    int status=EXIT_SUCCESS;
+    MockTable* table=new_mock_table();
+    table->latency=5000;
+    FitsWriter* writer=newFitsWriter(NULL,1,8*sizeof(long),BLOCKSIZE,4,threaded,
+				     write_mock_block,table,&status);
+    double start=wall_time();
+    long ii;
+    for (ii=0; ii<nrows; ii+=BLOCKSIZE){
+      usleep(5000);
+      add_rows(writer,ii,BLOCKSIZE,&status);
+    }
+    destroyFitsWriter(&writer,&status);
+    t[threaded]=wall_time()-start;
+    assert_int_equal(status,EXIT_SUCCESS);
+    check_rows(table,nrows,1);
+    free_mock_table(table);
+  }
+  printf("# %ld rows, 5ms per block to produce and 5ms to write: "
+	 "synchronous %.3fs, writer thread %.3fs\n", nrows, t[0], t[1]);
+}
+#endif
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_fitswriter_order),
+    cmocka_unit_test(test_fitswriter_flush),
+    cmocka_unit_test(test_fitswriter_shared),
+    cmocka_unit_test(test_fitswriter_large_rows),
+    cmocka_unit_test(test_fitswriter_error),
+    cmocka_unit_test(test_fitswriter_invalid),
+    cmocka_unit_test(test_fitswriter_impact_files),
+    cmocka_unit_test(test_fitswriter_event_files),
+    cmocka_unit_test(test_fitswriter_trigger_files),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_fitswriter),
+#endif
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
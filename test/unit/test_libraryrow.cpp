@@ -0,0 +1,244 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "pulseprocess.h"
+
+
+#define NROWS 128
+
+/** Row found by the linear scans of the library used before
+    'find_library_row' (find_model_energies, find_matchedfilter, ...):
+    the first row equal to 'p', or the first row 'i' with
+    params[i] < p < params[i+1]. */
+static long ref_scan_equal(gsl_vector* params, const long n, const double p){
+	if (p < gsl_vector_get(params, 0)) return (0);
+	long ii;
+	for (ii=0; ii<n-1; ii++){
+		if (p == gsl_vector_get(params, ii)) return (ii);
+		if ((p > gsl_vector_get(params, ii)) && (p < gsl_vector_get(params, ii+1))) return (ii);
+	}
+	// Above the library or equal to the last row only.
+	return (n-1);
+}
+
+/** Row found by the linear scan of find_model_samp1DERs: the first
+    row 'i' with params[i] <= p < params[i+1]. */
+static long ref_scan_lower(gsl_vector* params, const long n, const double p){
+	if (p < gsl_vector_get(params, 0)) return (0);
+	long ii;
+	for (ii=0; ii<n-1; ii++){
+		if ((p >= gsl_vector_get(params, ii)) && (p < gsl_vector_get(params, ii+1))) return (ii);
+	}
+	return (n-1);
+}
+
+/** Library parameters in ascending order, with runs of equal rows
+    if 'duplicates' is set. */
+static gsl_vector* sorted_params(const long n, const int duplicates, const unsigned int seed){
+	gsl_vector* params = gsl_vector_alloc(n);
+	srand(seed);
+	double value = 200.;
+	long ii;
+	for (ii=0; ii<n; ii++){
+		if (!duplicates || (ii == 0) || (rand()%3 != 0)){
+			value += 10.+rand()%1000/10.;
+		}
+		gsl_vector_set(params, ii, value);
+	}
+	return (params);
+}
+
+/** Parameters of the pulses: all library values, values in between,
+    at the ulp next to them, and outside of the library. */
+static void check_rows(gsl_vector* params, const long n,
+		       long (*ref)(gsl_vector*, long, double), const int firstEqual){
+	const double pmin = gsl_vector_get(params, 0);
+	const double pmax = gsl_vector_get(params, n-1);
+	long ii;
+	for (ii=0; ii<n; ii++){
+		const double p = gsl_vector_get(params, ii);
+		const double tests[] = {p, nextafter(p, -INFINITY), nextafter(p, INFINITY), p+0.5};
+		unsigned int jj;
+		for (jj=0; jj<sizeof(tests)/sizeof(tests[0]); jj++){
+			if (tests[jj] < pmin) continue;
+			assert_int_equal(find_library_row(params, n, tests[jj], firstEqual),
+					 ref(params, n, tests[jj]));
+		}
+	}
+	assert_int_equal(find_library_row(params, n, pmin-100., firstEqual), 0);
+	assert_int_equal(find_library_row(params, n, pmax+100., firstEqual), n-1);
+	assert_int_equal(find_library_row(params, n, INFINITY, firstEqual), n-1);
+	assert_int_equal(find_library_row(params, 1, pmax, firstEqual), 0);
+}
+
+static void test_sorted(void **state){
+	(void)state;
+	gsl_vector* params = sorted_params(NROWS, 0, 1);
+	check_rows(params, NROWS, ref_scan_equal, 1);
+	check_rows(params, NROWS, ref_scan_lower, 0);
+	gsl_vector_free(params);
+}
+
+static void test_duplicates(void **state){
+	(void)state;
+	unsigned int seed;
+	for (seed=0; seed<10; seed++){
+		gsl_vector* params = sorted_params(NROWS, 1, seed);
+		check_rows(params, NROWS, ref_scan_equal, 1);
+		check_rows(params, NROWS, ref_scan_lower, 0);
+		gsl_vector_free(params);
+	}
+
+	// All the rows equal, and runs at the ends of the library.
+	const double runs[][6] = {{500., 500., 500., 500., 500., 500.},
+				  {100., 100., 100., 200., 300., 400.},
+				  {100., 200., 300., 400., 400., 400.}};
+	gsl_vector* params = gsl_vector_alloc(6);
+	unsigned int kk;
+	for (kk=0; kk<sizeof(runs)/sizeof(runs[0]); kk++){
+		int ii;
+		for (ii=0; ii<6; ii++) gsl_vector_set(params, ii, runs[kk][ii]);
+		check_rows(params, 6, ref_scan_equal, 1);
+		check_rows(params, 6, ref_scan_lower, 0);
+	}
+	gsl_vector_free(params);
+}
+
+/** If the library is not sorted (checkLibraryOrder warns about it),
+    the found row may not be the first one straddling 'p', but it must
+    still be equal to 'p' or straddle it. */
+static void test_unsorted(void **state){
+	(void)state;
+	unsigned int seed;
+	for (seed=0; seed<10; seed++){
+		gsl_vector* params = sorted_params(NROWS, 1, 100+seed);
+		long ii;
+		for (ii=0; ii<NROWS/8; ii++){
+			gsl_vector_swap_elements(params, 1+rand()%(NROWS-1), 1+rand()%(NROWS-1));
+		}
+		const double pmin = gsl_vector_get(params, 0);
+		int firstEqual;
+		for (firstEqual=0; firstEqual<2; firstEqual++){
+			for (ii=0; ii<4*NROWS; ii++){
+				const double p = (ii < NROWS) ? gsl_vector_get(params, ii) : pmin+rand()%200000/10.;
+				if (p < pmin) continue;
+				const long row = find_library_row(params, NROWS, p, firstEqual);
+				assert_true(gsl_vector_get(params, row) <= p);
+				if ((row < NROWS-1) && (gsl_vector_get(params, row) != p)){
+					assert_true(p < gsl_vector_get(params, row+1));
+				}
+				if (gsl_vector_get(params, row) != p){
+					// The same pair of rows as the scan if it is the only one.
+					long nstraddle = 0, jj;
+					for (jj=0; jj<NROWS; jj++){
+						if ((gsl_vector_get(params, jj) <= p) &&
+						    ((jj == NROWS-1) || (p < gsl_vector_get(params, jj+1)))) nstraddle++;
+					}
+					if (nstraddle == 1) assert_int_equal(row, ref_scan_lower(params, NROWS, p));
+				}
+			}
+		}
+		gsl_vector_free(params);
+	}
+}
+
+#ifdef SIXT_BENCHMARK
+/** Templates per second found by find_model_energies in a library of
+    NROWS rows, for pulses spread over the library and for a narrow
+    line, compared with the lookups of the linear scan. */
+static void benchmark_find_model_energies(void **state){
+	(void)state;
+	const int length = 2048;
+	LibraryCollection* library = new LibraryCollection();
+	library->ntemplates = NROWS;
+	library->energies = sorted_params(NROWS, 0, 2);
+	library->pulse_templates = new PulseTemplate[NROWS];
+	library->pulse_templates_B0 = new PulseTemplate[NROWS];
+	long ii;
+	int kk;
+	for (ii=0; ii<NROWS; ii++){
+		const double energy = gsl_vector_get(library->energies, ii);
+		library->pulse_templates[ii].template_duration = length;
+		library->pulse_templates_B0[ii].template_duration = length;
+		library->pulse_templates_B0[ii].ptemplate = gsl_vector_alloc(length);
+		for (kk=0; kk<length; kk++){
+			gsl_vector_set(library->pulse_templates_B0[ii].ptemplate, kk,
+				       energy*(exp(-kk/(100.+ii))-exp(-kk/(5.+ii/10.))));
+		}
+	}
+	ReconstructInitSIRENA* reconstruct_init = new ReconstructInitSIRENA();
+	reconstruct_init->library_collection = library;
+	gsl_vector* model = gsl_vector_alloc(length);
+
+	const double emin = gsl_vector_get(library->energies, 0);
+	const double emax = gsl_vector_get(library->energies, NROWS-1);
+	const long npulses = 200000;
+	double* energies = (double*)malloc(npulses*sizeof(double));
+	int spread;
+	for (spread=1; spread>=0; spread--){
+		srand(3);
+		for (ii=0; ii<npulses; ii++){
+			const double u = rand()/(RAND_MAX+1.);
+			energies[ii] = spread ? emin+u*(emax-emin) : (emin+emax)/2.+4.*(u-0.5);
+		}
+
+		clock_t start = clock();
+		long sum = 0;
+		for (ii=0; ii<npulses; ii++){
+			sum += ref_scan_equal(library->energies, NROWS, energies[ii]);
+		}
+		double t_scan = (double)(clock()-start)/CLOCKS_PER_SEC;
+
+		start = clock();
+		for (ii=0; ii<npulses; ii++){
+			sum -= find_library_row(library->energies, NROWS, energies[ii], 1);
+		}
+		double t_search = (double)(clock()-start)/CLOCKS_PER_SEC;
+		assert_int_equal(sum, 0);
+
+		start = clock();
+		for (ii=0; ii<npulses; ii++){
+			assert_int_equal(find_model_energies(energies[ii], reconstruct_init, &model), EPOK);
+		}
+		double t_model = (double)(clock()-start)/CLOCKS_PER_SEC;
+
+		printf("# %d rows, %s: linear scan %.0f lookups/s, binary search %.0f lookups/s, "
+		       "find_model_energies (%d samples) %.0f templates/s\n", NROWS,
+		       spread ? "energies over the library" : "4 eV wide line",
+		       npulses/fmax(t_scan, 1e-9), npulses/fmax(t_search, 1e-9), length,
+		       npulses/fmax(t_model, 1e-9));
+	}
+
+	free(energies);
+	gsl_vector_free(model);
+	reconstruct_init->library_collection = 0;
+	delete reconstruct_init;
+	delete library;
+}
+#endif
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_sorted),
+    cmocka_unit_test(test_duplicates),
+    cmocka_unit_test(test_unsorted),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_find_model_energies),
+#endif
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
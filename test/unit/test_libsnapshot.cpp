@@ -0,0 +1,373 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libsnapshotSIRENA.h"
+
+
+#define LIBRARY "test_libsnapshot_library.fits"
+#define SNAPSHOT "test_libsnapshot.snap"
+#define DAMAGED "test_libsnapshot_damaged.snap"
+#define NTEMPLATES 4
+#define LENGTH 64
+
+/** Options of the reconstruction the library is loaded with: optimal
+    filters computed from the matched filters of the library (only
+    the LIBRARY HDU is read). */
+#define PULSE_LENGTH LENGTH
+#define LARGE_FILTER LENGTH
+static char filter_domain[] = "T";
+static char filter_method[] = "F0";
+static char energy_method[] = "OPTFILT";
+static char ofnoise[] = "NSD";
+
+/** Library FITS file with the columns read by getLibraryCollection
+    for the options above. */
+static void create_library(void){
+	fitsfile* fptr = NULL;
+	int status = 0;
+	char tform[16];
+	sprintf(tform, "%dD", LENGTH);
+	char* ttype[] = {(char*)"ENERGY", (char*)"PHEIGHT", (char*)"PULSE", (char*)"PULSEB0", (char*)"MF", (char*)"MFB0"};
+	char* tforms[] = {(char*)"1D", (char*)"1D", tform, tform, tform, tform};
+	char* tunit[] = {(char*)"eV", (char*)"ADC", (char*)"ADC", (char*)"ADC", (char*)"", (char*)""};
+
+	fits_create_file(&fptr, "!" LIBRARY, &status);
+	fits_create_tbl(fptr, BINARY_TBL, 0, 6, ttype, tforms, tunit, (char*)"LIBRARY", &status);
+	double baseline = 1000.;
+	fits_update_key(fptr, TDOUBLE, "BASELINE", &baseline, NULL, &status);
+
+	double pulse[LENGTH], pulseb0[LENGTH], mf[LENGTH], mfb0[LENGTH];
+	int it, kk;
+	for (it=0; it<NTEMPLATES; it++){
+		double energy = 1000.*(it+1);
+		double pheight = 0.8*energy+it;
+		for (kk=0; kk<LENGTH; kk++){
+			pulseb0[kk] = pheight*(exp(-kk/(20.+it))-exp(-kk/(2.+it/4.)));
+			pulse[kk] = pulseb0[kk]+baseline;
+			mf[kk] = pulseb0[kk]/(pheight*LENGTH);
+			mfb0[kk] = mf[kk]-1./LENGTH;
+		}
+		fits_write_col(fptr, TDOUBLE, 1, it+1, 1, 1, &energy, &status);
+		fits_write_col(fptr, TDOUBLE, 2, it+1, 1, 1, &pheight, &status);
+		fits_write_col(fptr, TDOUBLE, 3, it+1, 1, LENGTH, pulse, &status);
+		fits_write_col(fptr, TDOUBLE, 4, it+1, 1, LENGTH, pulseb0, &status);
+		fits_write_col(fptr, TDOUBLE, 5, it+1, 1, LENGTH, mf, &status);
+		fits_write_col(fptr, TDOUBLE, 6, it+1, 1, LENGTH, mfb0, &status);
+	}
+	fits_close_file(fptr, &status);
+	assert_int_equal(status, 0);
+}
+
+static LibraryCollection* load_library(const char* filename, int* const status){
+	char ofinterp_buffer[LIBSNAPSHOT_STRLEN] = "MF";
+	char* ofinterp = ofinterp_buffer;
+	return (getLibraryCollection(filename, 1, 0, 0, LARGE_FILTER, filter_domain, PULSE_LENGTH,
+				     energy_method, ofnoise, filter_method, 0, &ofinterp, 0., 0, 0, status));
+}
+
+static void create_snapshot(int* const status){
+	char ofinterp[] = "MF";
+	createLibrarySnapshotSIRENA((char*)LIBRARY, (char*)SNAPSHOT, PULSE_LENGTH, filter_domain, filter_method,
+				    energy_method, 0., ofnoise, 0, 0, ofinterp, 0, 0, 0, 1, status);
+}
+
+static void assert_vectors_equal(const gsl_vector* a, const gsl_vector* b){
+	if (a == NULL){
+		assert_null(b);
+		return;
+	}
+	assert_non_null(b);
+	assert_int_equal(a->size, b->size);
+	size_t ii;
+	for (ii=0; ii<a->size; ii++){
+		assert_memory_equal(gsl_vector_const_ptr(a, ii), gsl_vector_const_ptr(b, ii), sizeof(double));
+	}
+}
+
+static void assert_matrices_equal(const gsl_matrix* a, const gsl_matrix* b){
+	if (a == NULL){
+		assert_null(b);
+		return;
+	}
+	assert_non_null(b);
+	assert_int_equal(a->size1, b->size1);
+	assert_int_equal(a->size2, b->size2);
+	size_t ii;
+	for (ii=0; ii<a->size1; ii++){
+		gsl_vector_const_view ra = gsl_matrix_const_row(a, ii);
+		gsl_vector_const_view rb = gsl_matrix_const_row(b, ii);
+		assert_vectors_equal(&ra.vector, &rb.vector);
+	}
+}
+
+static void assert_templates_equal(const PulseTemplate* a, const PulseTemplate* b, const int n){
+	if (a == NULL){
+		assert_null(b);
+		return;
+	}
+	assert_non_null(b);
+	int ii;
+	for (ii=0; ii<n; ii++){
+		assert_int_equal(a[ii].template_duration, b[ii].template_duration);
+		assert_true(a[ii].energy == b[ii].energy);
+		assert_true(a[ii].pulse_height == b[ii].pulse_height);
+		assert_vectors_equal(a[ii].ptemplate, b[ii].ptemplate);
+	}
+}
+
+static void assert_mfilters_equal(const MatchedFilter* a, const MatchedFilter* b, const int n){
+	if (a == NULL){
+		assert_null(b);
+		return;
+	}
+	assert_non_null(b);
+	int ii;
+	for (ii=0; ii<n; ii++){
+		assert_int_equal(a[ii].mfilter_duration, b[ii].mfilter_duration);
+		assert_true(a[ii].energy == b[ii].energy);
+		assert_true(a[ii].pulse_height == b[ii].pulse_height);
+		assert_vectors_equal(a[ii].mfilter, b[ii].mfilter);
+	}
+}
+
+/** Arrays of optimal filters are only written to the snapshot if
+    they have been allocated, but the rows may be empty. */
+static void assert_ofilters_equal(const OptimalFilterSIRENA* a, const OptimalFilterSIRENA* b, const int n){
+	if (a == NULL){
+		assert_null(b);
+		return;
+	}
+	assert_non_null(b);
+	int ii;
+	for (ii=0; ii<n; ii++){
+		assert_int_equal(a[ii].ofilter_duration, b[ii].ofilter_duration);
+		assert_true(a[ii].energy == b[ii].energy);
+		assert_vectors_equal(a[ii].ofilter, b[ii].ofilter);
+	}
+}
+
+/** Every scalar, vector and matrix of the LibraryCollection. */
+static void assert_libraries_equal(const LibraryCollection* a, const LibraryCollection* b){
+	assert_int_equal(a->ntemplates, b->ntemplates);
+	assert_int_equal(a->nfixedfilters, b->nfixedfilters);
+	assert_true(a->baseline == b->baseline);
+	const int n = a->ntemplates;
+	assert_vectors_equal(a->energies, b->energies);
+	assert_vectors_equal(a->pulse_heights, b->pulse_heights);
+	assert_templates_equal(a->pulse_templatesMaxLengthFixedFilter, b->pulse_templatesMaxLengthFixedFilter, n);
+	assert_templates_equal(a->pulse_templates, b->pulse_templates, n);
+	assert_templates_equal(a->pulse_templates_filder, b->pulse_templates_filder, n);
+	assert_vectors_equal(a->maxDERs, b->maxDERs);
+	assert_vectors_equal(a->samp1DERs, b->samp1DERs);
+	assert_templates_equal(a->pulse_templates_B0, b->pulse_templates_B0, n);
+	assert_mfilters_equal(a->matched_filters, b->matched_filters, n);
+	assert_mfilters_equal(a->matched_filters_B0, b->matched_filters_B0, n);
+	assert_ofilters_equal(a->optimal_filters, b->optimal_filters, n);
+	assert_ofilters_equal(a->optimal_filtersFREQ, b->optimal_filtersFREQ, n);
+	assert_ofilters_equal(a->optimal_filtersTIME, b->optimal_filtersTIME, n);
+	assert_matrices_equal(a->V, b->V);
+	assert_matrices_equal(a->W, b->W);
+	assert_matrices_equal(a->WAB, b->WAB);
+	assert_matrices_equal(a->T, b->T);
+	assert_vectors_equal(a->t, b->t);
+	assert_matrices_equal(a->X, b->X);
+	assert_matrices_equal(a->Y, b->Y);
+	assert_matrices_equal(a->Z, b->Z);
+	assert_vectors_equal(a->r, b->r);
+	assert_matrices_equal(a->PAB, b->PAB);
+	assert_matrices_equal(a->PABMXLFF, b->PABMXLFF);
+	assert_matrices_equal(a->DAB, b->DAB);
+	assert_ofilters_equal(a->optimal_filtersab, b->optimal_filtersab, n);
+	assert_ofilters_equal(a->optimal_filtersabTIME, b->optimal_filtersabTIME, n);
+	assert_ofilters_equal(a->optimal_filtersabFREQ, b->optimal_filtersabFREQ, n);
+	assert_matrices_equal(a->PRECALWN, b->PRECALWN);
+	assert_matrices_equal(a->PRCLOFWM, b->PRCLOFWM);
+}
+
+static unsigned char* read_file(const char* filename, size_t* size){
+	FILE* fp = fopen(filename, "rb");
+	assert_non_null(fp);
+	fseek(fp, 0, SEEK_END);
+	*size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	unsigned char* data = (unsigned char*)malloc(*size);
+	assert_non_null(data);
+	assert_int_equal(fread(data, 1, *size, fp), *size);
+	fclose(fp);
+	return (data);
+}
+
+static void write_file(const char* filename, const unsigned char* data, const size_t size){
+	FILE* fp = fopen(filename, "wb");
+	assert_non_null(fp);
+	assert_int_equal(fwrite(data, 1, size, fp), size);
+	fclose(fp);
+}
+
+/** FNV-1a checksum of the snapshot index (as snapshotChecksum). */
+static uint64_t index_checksum(const unsigned char* data){
+	LibSnapshotHeader header;
+	memcpy(&header, data, sizeof(header));
+	header.index_checksum = 0;
+	const uint64_t prime = 1099511628211ULL;
+	uint64_t hash = 14695981039346656037ULL;
+	const size_t size = sizeof(header)+header.nentries*sizeof(LibSnapshotEntry);
+	size_t ii;
+	for (ii=0; ii<size; ii+=sizeof(uint64_t)){
+		uint64_t word;
+		memcpy(&word, (ii < sizeof(header)) ? (const unsigned char*)&header+ii : data+ii, sizeof(uint64_t));
+		hash = (hash^word)*prime;
+	}
+	return (hash);
+}
+
+/** Snapshot whose first vector entry has been changed by 'damage',
+    with a valid index checksum: it must be rejected by
+    verifyLibrarySnapshot and getLibraryCollection. */
+static void check_damaged_entry(void (*damage)(LibSnapshotEntry*, const size_t)){
+	size_t size;
+	unsigned char* data = read_file(SNAPSHOT, &size);
+	LibSnapshotHeader header;
+	memcpy(&header, data, sizeof(header));
+	LibSnapshotEntry* index = (LibSnapshotEntry*)(data+sizeof(header));
+	uint64_t ii;
+	for (ii=0; ii<header.nentries; ii++){
+		if (index[ii].kind == LIBSNAPSHOT_VECTOR) break;
+	}
+	assert_true(ii < header.nentries);
+	damage(&index[ii], size);
+	header.index_checksum = index_checksum(data);
+	memcpy(data, &header, sizeof(header));
+	write_file(DAMAGED, data, size);
+	free(data);
+
+	assert_int_equal(verifyLibrarySnapshot(DAMAGED), EPFAIL);
+	int status = EPOK;
+	LibraryCollection* library = load_library(DAMAGED, &status);
+	assert_int_equal(status, EPFAIL);
+	delete library;
+	remove(DAMAGED);
+}
+
+static void offset_beyond_file(LibSnapshotEntry* entry, const size_t size){
+	entry->offset = (size/LIBSNAPSHOT_ALIGN+2)*LIBSNAPSHOT_ALIGN;
+}
+
+static void overflowing_dimensions(LibSnapshotEntry* entry, const size_t size){
+	(void)size;
+	// size1*size2 wraps around to 2 elements
+	entry->kind = LIBSNAPSHOT_MATRIX;
+	entry->size1 = (UINT64_MAX/2)+2;
+	entry->size2 = 2;
+}
+
+/** The library written to a snapshot and loaded from it is equal to
+    the library loaded from the FITS file. */
+static void test_libsnapshot_roundtrip(void **state){
+	(void)state;
+	create_library();
+
+	int status = EPOK;
+	LibraryCollection* fits_library = load_library(LIBRARY, &status);
+	assert_int_equal(status, EPOK);
+
+	// All the fields, also the ones which are filled in later
+	// ('filderLibrary'), as they are written by writeLibrarySnapshot.
+	LibSnapshotHeader options;
+	memset(&options, 0, sizeof(options));
+	options.largeFilter = LARGE_FILTER;
+	options.pulse_length = PULSE_LENGTH;
+	strcpy(options.filter_domain, filter_domain);
+	strcpy(options.energy_method, energy_method);
+	strcpy(options.ofnoise, ofnoise);
+	strcpy(options.filter_method, filter_method);
+	strcpy(options.ofinterp_in, "MF");
+	strcpy(options.ofinterp, "MF");
+	assert_int_equal(writeLibrarySnapshot(fits_library, &options, SNAPSHOT), EPOK);
+	assert_true(isLibrarySnapshot(SNAPSHOT));
+	assert_false(isLibrarySnapshot(LIBRARY));
+	assert_int_equal(verifyLibrarySnapshot(SNAPSHOT), EPOK);
+
+	LibraryCollection* snapshot_library = load_library(SNAPSHOT, &status);
+	assert_int_equal(status, EPOK);
+	assert_non_null(snapshot_library->snapshot_map);
+	assert_libraries_equal(fits_library, snapshot_library);
+	delete snapshot_library;
+
+	// The snapshot of sirenasnapshot: the fields read from the FITS
+	// file are equal.
+	create_snapshot(&status);
+	assert_int_equal(status, EPOK);
+	snapshot_library = load_library(SNAPSHOT, &status);
+	assert_int_equal(status, EPOK);
+	assert_int_equal(snapshot_library->ntemplates, NTEMPLATES);
+	assert_vectors_equal(fits_library->energies, snapshot_library->energies);
+	assert_vectors_equal(fits_library->pulse_heights, snapshot_library->pulse_heights);
+	int it;
+	for (it=0; it<NTEMPLATES; it++){
+		assert_vectors_equal(fits_library->pulse_templates[it].ptemplate, snapshot_library->pulse_templates[it].ptemplate);
+		assert_vectors_equal(fits_library->pulse_templates_B0[it].ptemplate, snapshot_library->pulse_templates_B0[it].ptemplate);
+		assert_vectors_equal(fits_library->matched_filters[it].mfilter, snapshot_library->matched_filters[it].mfilter);
+	}
+	delete snapshot_library;
+	delete fits_library;
+
+	remove(SNAPSHOT);
+	remove(LIBRARY);
+}
+
+/** Truncated snapshots and entries outside of the file. */
+static void test_libsnapshot_damaged(void **state){
+	(void)state;
+	create_library();
+	int status = EPOK;
+	create_snapshot(&status);
+	assert_int_equal(status, EPOK);
+
+	size_t size;
+	unsigned char* data = read_file(SNAPSHOT, &size);
+	LibSnapshotHeader header;
+	memcpy(&header, data, sizeof(header));
+	const size_t lengths[] = {size-1, size-sizeof(double), header.header_size, sizeof(header), 8};
+	unsigned int ii;
+	for (ii=0; ii<sizeof(lengths)/sizeof(lengths[0]); ii++){
+		write_file(DAMAGED, data, lengths[ii]);
+		assert_int_equal(verifyLibrarySnapshot(DAMAGED), EPFAIL);
+		status = EPOK;
+		// Files shorter than the magic are read as FITS files
+		LibraryCollection* library = load_library(DAMAGED, &status);
+		assert_int_not_equal(status, EPOK);
+		delete library;
+	}
+	free(data);
+	remove(DAMAGED);
+
+	check_damaged_entry(offset_beyond_file);
+	check_damaged_entry(overflowing_dimensions);
+
+	remove(SNAPSHOT);
+	remove(LIBRARY);
+}
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_libsnapshot_roundtrip),
+    cmocka_unit_test(test_libsnapshot_damaged),
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
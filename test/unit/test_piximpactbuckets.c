@@ -0,0 +1,430 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <time.h>
+
+#include "pixelimpactfile.h"
+
+
+#define FILENAME "test_piximpactbuckets.fits"
+#define OUTFILENAME "test_piximpactbuckets_out.fits"
+#define NPIX 3000
+#define NGTI 10
+#define NIMPACTS 5000
+
+/** Pixel of an impact of a point source, which is imaged onto the
+    center of the array, with a few impacts spread over the whole
+    array (background). */
+static long point_source_pixel(){
+  if (rand()%10==0){
+    return(rand()%NPIX);
+  }
+  double r=(rand()%1000)/1000.;
+  return(NPIX/2+(long)((rand()%2 ? 1 : -1)*30.*r*r));
+}
+
+static char* ttype[]={"TIME","ENERGY","X","Y","U","V","PH_ID","SRC_ID","PIXID"};
+static char* tform[]={"D","E","D","D","D","D","J","J","J"};
+
+/** Pixel impact file with NGTI intervals of NIMPACTS impacts each
+    (sorted by time). */
+static void create_impact_file(){
+  int status=EXIT_SUCCESS;
+  fitsfile* fptr=NULL;
+  fits_create_file(&fptr,"!" FILENAME,&status);
+  fits_create_tbl(fptr,BINARY_TBL,0,9,ttype,tform,NULL,"PIXELIMPACT",&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  const long nrows=NGTI*NIMPACTS;
+  double* time=(double*)malloc(nrows*sizeof(double));
+  float* energy=(float*)malloc(nrows*sizeof(float));
+  double* pos=(double*)malloc(nrows*sizeof(double));
+  long* phid=(long*)malloc(nrows*sizeof(long));
+  long* pixid=(long*)malloc(nrows*sizeof(long));
+  assert_true(NULL!=time && NULL!=energy && NULL!=pos && NULL!=phid && NULL!=pixid);
+
+  srand(1);
+  long ii;
+  for (ii=0; ii<nrows; ii++){
+    time[ii]=(ii/NIMPACTS)*100.+(ii%NIMPACTS)*0.01;
+    energy[ii]=0.5+(rand()%1000)/100.;
+    pos[ii]=(rand()%1000)*1.e-6;
+    phid[ii]=ii+1;
+    pixid[ii]=point_source_pixel()+1;
+  }
+  fits_write_col(fptr,TDOUBLE,1,1,1,nrows,time,&status);
+  fits_write_col(fptr,TFLOAT,2,1,1,nrows,energy,&status);
+  int col;
+  for (col=3; col<=6; col++){
+    fits_write_col(fptr,TDOUBLE,col,1,1,nrows,pos,&status);
+  }
+  fits_write_col(fptr,TLONG,7,1,1,nrows,phid,&status);
+  fits_write_col(fptr,TLONG,8,1,1,nrows,pixid,&status);
+  fits_write_col(fptr,TLONG,9,1,1,nrows,pixid,&status);
+  fits_close_file(fptr,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  free(time);
+  free(energy);
+  free(pos);
+  free(phid);
+  free(pixid);
+}
+
+/** Empty pixel impact file opened for writing. */
+static PixImpFile* new_impact_file(const char* const filename){
+  int status=EXIT_SUCCESS;
+  fitsfile* fptr=NULL;
+  char buffer[MAXFILENAME];
+  sprintf(buffer,"!%s",filename);
+  fits_create_file(&fptr,buffer,&status);
+  fits_create_tbl(fptr,BINARY_TBL,0,9,ttype,tform,NULL,"PIXELIMPACT",&status);
+  fits_close_file(fptr,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  PixImpFile* file=openPixImpFile(filename,READWRITE,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  return(file);
+}
+
+/** All impacts of the test file. */
+static PixImpact* read_impacts(){
+  int status=EXIT_SUCCESS;
+  create_impact_file();
+  PixImpFile* file=openPixImpFile(FILENAME,READONLY,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  PixImpact* impacts=(PixImpact*)malloc(NGTI*NIMPACTS*sizeof(PixImpact));
+  assert_non_null(impacts);
+  readPixImpFileRows(file,1,NGTI*NIMPACTS,impacts,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  freePixImpFile(&file,&status);
+  remove(FILENAME);
+  return(impacts);
+}
+
+static void assert_impacts_equal(const PixImpact* a, const PixImpact* b){
+  assert_int_equal(a->pixID,b->pixID);
+  assert_true(a->time==b->time);
+  assert_true(a->energy==b->energy);
+  assert_true(a->detposition.x==b->detposition.x);
+  assert_true(a->pixposition.y==b->pixposition.y);
+  assert_int_equal(a->ph_id,b->ph_id);
+  assert_int_equal(a->src_id,b->src_id);
+}
+
+/** The buckets contain the impacts of each pixel in the order of the
+    file, as found by scanning the file for the pixel. */
+static void test_buckets_per_pixel(){
+  int status=EXIT_SUCCESS;
+  create_impact_file();
+  PixImpFile* file=openPixImpFile(FILENAME,READONLY,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  PixImpactBuckets* buckets=newPixImpactBuckets(NPIX,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  int gti;
+  for (gti=0; gti<NGTI; gti+=NGTI-1){
+    long firstrow=gti*NIMPACTS+1;
+    fillPixImpactBuckets(buckets,file,firstrow,firstrow+NIMPACTS-1,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    assert_int_equal(buckets->nimpacts,NIMPACTS);
+    assert_int_equal(buckets->first[0],0);
+    assert_int_equal(buckets->first[NPIX],NIMPACTS);
+
+    int pixel;
+    for (pixel=0; pixel<NPIX; pixel+=7){
+      long index=buckets->first[pixel];
+      PixImpact impact;
+      file->row=firstrow-1;
+      while (file->row<firstrow+NIMPACTS-1 &&
+	     getNextImpactFromPixImpFile(file,&impact,&status)){
+	if (impact.pixID==pixel){
+	  assert_true(index<buckets->first[pixel+1]);
+	  assert_impacts_equal(&buckets->impact[index],&impact);
+	  index++;
+	}
+      }
+      assert_int_equal(status,EXIT_SUCCESS);
+      assert_int_equal(index,buckets->first[pixel+1]);
+    }
+  }
+
+  // Empty range.
+  fillPixImpactBuckets(buckets,file,5,4,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_int_equal(buckets->nimpacts,0);
+  assert_int_equal(buckets->first[NPIX],0);
+
+  // Rows beyond the end of the file.
+  fillPixImpactBuckets(buckets,file,file->nrows,file->nrows+1,&status);
+  assert_int_equal(status,EXIT_FAILURE);
+
+  freePixImpactBuckets(&buckets);
+  assert_null(buckets);
+  status=EXIT_SUCCESS;
+  freePixImpFile(&file,&status);
+  remove(FILENAME);
+}
+
+/** Impacts of pixels outside of the array are rejected. */
+static void test_buckets_invalid_pixel(){
+  int status=EXIT_SUCCESS;
+  create_impact_file();
+  PixImpFile* file=openPixImpFile(FILENAME,READONLY,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  PixImpactBuckets* buckets=newPixImpactBuckets(NPIX/2,&status);
+  fillPixImpactBuckets(buckets,file,1,NIMPACTS,&status);
+  assert_int_equal(status,EXIT_FAILURE);
+  freePixImpactBuckets(&buckets);
+  status=EXIT_SUCCESS;
+  freePixImpFile(&file,&status);
+  remove(FILENAME);
+}
+
+/** A source yields the same impacts from an array as from the
+    file. */
+static void test_impact_source(){
+  int status=EXIT_SUCCESS;
+  create_impact_file();
+  PixImpFile* file=openPixImpFile(FILENAME,READONLY,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  PixImpact* impacts=(PixImpact*)malloc(NIMPACTS*sizeof(PixImpact));
+  assert_non_null(impacts);
+  readPixImpFileRows(file,1,NIMPACTS,impacts,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_int_equal(file->row,0);
+
+  PixImpactSource filesource={file,NULL,0,0,NULL};
+  PixImpactSource arraysource={NULL,impacts,NIMPACTS,0,NULL};
+  int pass;
+  for (pass=0; pass<2; pass++){
+    long ii;
+    for (ii=0; ii<NIMPACTS; ii++){
+      PixImpact a, b;
+      assert_int_equal(getNextImpactFromSource(&filesource,&a,&status),1);
+      assert_int_equal(getNextImpactFromSource(&arraysource,&b,&status),1);
+      assert_impacts_equal(&a,&b);
+    }
+    PixImpact c;
+    assert_int_equal(getNextImpactFromSource(&arraysource,&c,&status),0);
+    assert_int_equal(status,EXIT_SUCCESS);
+    rewindPixImpactSource(&filesource);
+    rewindPixImpactSource(&arraysource);
+  }
+
+  free(impacts);
+  freePixImpFile(&file,&status);
+  remove(FILENAME);
+}
+
+/** The store returns the impacts in the order they were added, also
+    if most of them have been moved to the temporary file, and can be
+    reused for the next GTI. */
+static void test_impact_store(){
+  int status=EXIT_SUCCESS;
+  PixImpact* impacts=read_impacts();
+  const long n=NGTI*NIMPACTS;
+
+  // Keep a single chunk in memory.
+  PixImpactStore* store=newPixImpactStore(1,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  PixImpactBuckets* buckets=newPixImpactBuckets(NPIX,&status);
+  PixImpactBuckets* refbuckets=newPixImpactBuckets(NPIX,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  PixImpFile* file=new_impact_file(OUTFILENAME);
+
+  int pass;
+  for (pass=0; pass<2; pass++){
+    const long first=pass*n/2;
+    const long count=n-first;
+    long ii;
+    for (ii=0; ii<count; ii++){
+      addImpact2PixImpactStore(store,&impacts[first+ii],&status);
+    }
+    assert_int_equal(status,EXIT_SUCCESS);
+    assert_int_equal(store->nimpacts,count);
+    assert_int_equal(store->nmemchunks,1);
+    assert_non_null(store->spill);
+
+    PixImpactSource storesource={NULL,NULL,0,0,store};
+    PixImpactSource arraysource={NULL,impacts+first,count,0,NULL};
+    assert_int_equal(getPixImpactSourceSize(&storesource),count);
+    for (ii=0; ii<count; ii++){
+      PixImpact a, b;
+      assert_int_equal(getNextImpactFromSource(&storesource,&a,&status),1);
+      assert_int_equal(getNextImpactFromSource(&arraysource,&b,&status),1);
+      assert_impacts_equal(&a,&b);
+      assert_int_equal(a.grade1,0);
+    }
+    PixImpact c;
+    assert_int_equal(getNextImpactFromSource(&storesource,&c,&status),0);
+    assert_int_equal(status,EXIT_SUCCESS);
+
+    // The buckets are the same as those from a file.
+    for (ii=0; ii<count; ii++){
+      PixImpact imp=impacts[first+ii];
+      addImpact2PixImpFile(file,&imp,&status);
+    }
+    fillPixImpactBucketsFromStore(buckets,store,&status);
+    fillPixImpactBuckets(refbuckets,file,file->row-count+1,file->row,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    assert_int_equal(buckets->nimpacts,count);
+    assert_memory_equal(buckets->first,refbuckets->first,(NPIX+1)*sizeof(long));
+    for (ii=0; ii<count; ii++){
+      assert_impacts_equal(&buckets->impact[ii],&refbuckets->impact[ii]);
+    }
+
+    clearPixImpactStore(store);
+    assert_int_equal(store->nimpacts,0);
+  }
+
+  // Impacts beyond the end of the store.
+  PixImpact imp;
+  readPixImpactStore(store,0,1,&imp,&status);
+  assert_int_equal(status,EXIT_FAILURE);
+
+  free(impacts);
+  freePixImpactBuckets(&buckets);
+  freePixImpactBuckets(&refbuckets);
+  freePixImpactStore(&store);
+  assert_null(store);
+  status=EXIT_SUCCESS;
+  freePixImpFile(&file,&status);
+  remove(OUTFILENAME);
+}
+
+#ifdef SIXT_BENCHMARK
+/** Reports the time needed to get the impacts of every hit pixel of
+    every GTI by scanning the file for each pixel (as done originally
+    by xifupipeline, extrapolated from the first 20 pixels of each
+    GTI) and by sorting the impacts of a GTI into buckets. */
+static void benchmark_buckets(){
+  int status=EXIT_SUCCESS;
+  create_impact_file();
+  PixImpFile* file=openPixImpFile(FILENAME,READONLY,&status);
+  PixImpactBuckets* buckets=newPixImpactBuckets(NPIX,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  double t_scan=0.;
+  long nhit=0;
+  clock_t start;
+  int gti;
+  for (gti=0; gti<NGTI; gti++){
+    long firstrow=gti*NIMPACTS+1;
+    fillPixImpactBuckets(buckets,file,firstrow,firstrow+NIMPACTS-1,&status);
+    long nhit_gti=0;
+    int pixel;
+    for (pixel=0; pixel<NPIX; pixel++){
+      if (buckets->first[pixel+1]>buckets->first[pixel]) nhit_gti++;
+    }
+    nhit+=nhit_gti;
+
+    start=clock();
+    int nscanned=0;
+    for (pixel=0; pixel<NPIX && nscanned<20; pixel++){
+      if (buckets->first[pixel+1]==buckets->first[pixel]) continue;
+      PixImpact impact;
+      long count=0;
+      file->row=firstrow-1;
+      while (file->row<firstrow+NIMPACTS-1 &&
+	     getNextImpactFromPixImpFile(file,&impact,&status)){
+	if (impact.pixID==pixel) count++;
+      }
+      assert_int_equal(count,buckets->first[pixel+1]-buckets->first[pixel]);
+      nscanned++;
+    }
+    t_scan+=(double)(clock()-start)/CLOCKS_PER_SEC*nhit_gti/nscanned;
+  }
+
+  start=clock();
+  for (gti=0; gti<NGTI; gti++){
+    long firstrow=gti*NIMPACTS+1;
+    fillPixImpactBuckets(buckets,file,firstrow,firstrow+NIMPACTS-1,&status);
+  }
+  double t_buckets=(double)(clock()-start)/CLOCKS_PER_SEC;
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  printf("# %d pixels, %d GTIs with %d impacts, %ld hit pixels: "
+	 "scan per pixel %.2fs, buckets %.4fs\n",
+	 NPIX, NGTI, NIMPACTS, nhit, t_scan, t_buckets);
+
+  freePixImpactBuckets(&buckets);
+  freePixImpFile(&file,&status);
+  remove(FILENAME);
+}
+#endif
+
+#ifdef SIXT_BENCHMARK
+/** Reports the time needed to pass the impacts of NGTI intervals
+    from the imaging to the grading or the TES streams via a pixel
+    impact file (as done originally by xifupipeline) and via the
+    store, and the FITS rows that are not written and read again. */
+static void benchmark_store(){
+  int status=EXIT_SUCCESS;
+  PixImpact* impacts=read_impacts();
+  PixImpactBuckets* buckets=newPixImpactBuckets(NPIX,&status);
+  PixImpactStore* store=newPixImpactStore(0,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  clock_t start=clock();
+  PixImpFile* file=new_impact_file(OUTFILENAME);
+  long row=0;
+  int gti;
+  long ii;
+  for (gti=0; gti<NGTI; gti++){
+    for (ii=0; ii<NIMPACTS; ii++){
+      PixImpact imp=impacts[gti*NIMPACTS+ii];
+      addImpact2PixImpFile(file,&imp,&status);
+    }
+    fillPixImpactBuckets(buckets,file,row+1,file->row,&status);
+    row=file->row;
+  }
+  freePixImpFile(&file,&status);
+  remove(OUTFILENAME);
+  double t_file=(double)(clock()-start)/CLOCKS_PER_SEC;
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  start=clock();
+  for (gti=0; gti<NGTI; gti++){
+    for (ii=0; ii<NIMPACTS; ii++){
+      addImpact2PixImpactStore(store,&impacts[gti*NIMPACTS+ii],&status);
+    }
+    fillPixImpactBucketsFromStore(buckets,store,&status);
+    clearPixImpactStore(store);
+  }
+  double t_store=(double)(clock()-start)/CLOCKS_PER_SEC;
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  printf("# %d GTIs with %d impacts: piximpact file %.3fs, store %.3fs "
+	 "(%d FITS rows written and read less)\n",
+	 NGTI, NIMPACTS, t_file, t_store, NGTI*NIMPACTS);
+
+  free(impacts);
+  freePixImpactBuckets(&buckets);
+  freePixImpactStore(&store);
+}
+#endif
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_buckets_per_pixel),
+    cmocka_unit_test(test_buckets_invalid_pixel),
+    cmocka_unit_test(test_impact_source),
+    cmocka_unit_test(test_impact_store),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_buckets),
+#endif
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_store),
+#endif
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
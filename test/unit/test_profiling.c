@@ -0,0 +1,190 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <pthread.h>
+
+#include "sixt.h"
+#include "profiling.h"
+
+
+#define JSONFILE "test_profiling.json"
+
+/** Some work that cannot be optimized away. */
+static volatile double sink=0.;
+static void work(const int n){
+  int ii;
+  for (ii=0; ii<n; ii++){
+    sink+=sqrt((double)ii);
+  }
+}
+
+static void test_counters(){
+  resetSixtProfiling();
+  addSixtProfCount(SIXT_PROF_PHOTONS,5);
+  addSixtProfCount(SIXT_PROF_PHOTONS,7);
+  addSixtProfCount(SIXT_PROF_ROWS_WRITTEN,1);
+  assert_int_equal(getSixtProfCount(SIXT_PROF_PHOTONS),12);
+  assert_int_equal(getSixtProfCount(SIXT_PROF_ROWS_WRITTEN),1);
+  assert_int_equal(getSixtProfCount(SIXT_PROF_PULSES),0);
+  resetSixtProfiling();
+  assert_int_equal(getSixtProfCount(SIXT_PROF_PHOTONS),0);
+}
+
+/** Every call of a stage is timed, also for the stages that are
+    entered for each photon, such that rare expensive calls are not
+    missed. */
+static void test_stage_timing(){
+  resetSixtProfiling();
+  const long ncalls=163;
+  long ii;
+  double start=getSixtProfTime();
+  for (ii=0; ii<ncalls; ii++){
+    SixtProfTicks t0=beginSixtProfStage(SIXT_PROF_PHGEN);
+    assert_true(t0>0);
+    // A single expensive call, as the refill of the photon buffer.
+    work((ncalls-1==ii) ? 1000000 : 10);
+    endSixtProfStage(SIXT_PROF_PHGEN,t0);
+  }
+  double elapsed=getSixtProfTime()-start;
+
+  long calls;
+  double time;
+  getSixtProfStage(SIXT_PROF_PHGEN,&calls,&time);
+  assert_int_equal(calls,ncalls);
+  assert_true(time<=elapsed);
+  // The expensive call is included in the total time.
+  assert_true(time>=0.5*elapsed);
+  getSixtProfStage(SIXT_PROF_TRIGGER,&calls,&time);
+  assert_int_equal(calls,0);
+  assert_true(0.==time);
+}
+
+static void* count_thread(void* arg){
+  (void)arg;
+  int ii;
+  for (ii=0; ii<100000; ii++){
+    addSixtProfCount(SIXT_PROF_PULSES,1);
+    endSixtProfStage(SIXT_PROF_SIRENA_DETECT,
+		     beginSixtProfStage(SIXT_PROF_SIRENA_DETECT));
+  }
+  return(NULL);
+}
+
+/** Counters and timers can be updated from several threads. */
+static void test_threads(){
+  resetSixtProfiling();
+  pthread_t threads[4];
+  int ii;
+  for (ii=0; ii<4; ii++){
+    assert_int_equal(pthread_create(&threads[ii],NULL,count_thread,NULL),0);
+  }
+  for (ii=0; ii<4; ii++){
+    pthread_join(threads[ii],NULL);
+  }
+  assert_int_equal(getSixtProfCount(SIXT_PROF_PULSES),400000);
+  long calls;
+  double time;
+  getSixtProfStage(SIXT_PROF_SIRENA_DETECT,&calls,&time);
+  assert_int_equal(calls,400000);
+}
+
+/** The summary is written in JSON format, if SIXTE_PROFILE ends
+    with ".json". Without profiling support nothing is written. */
+static void test_json_summary(){
+  remove(JSONFILE);
+  setenv("SIXTE_PROFILE",JSONFILE,1);
+  initSixtProfiling("test_profiling");
+  SIXT_PROF_BEGIN(SIXT_PROF_PHGEN);
+  SIXT_PROF_COUNT(SIXT_PROF_PHOTONS,42);
+  SIXT_PROF_END(SIXT_PROF_PHGEN);
+  writeSixtProfiling();
+  unsetenv("SIXTE_PROFILE");
+
+  FILE* fp=fopen(JSONFILE,"r");
+#ifdef SIXT_PROFILING
+  assert_non_null(fp);
+  char buffer[4096];
+  size_t n=fread(buffer,1,sizeof(buffer)-1,fp);
+  buffer[n]='\0';
+  fclose(fp);
+  assert_non_null(strstr(buffer,"\"tool\": \"test_profiling\""));
+  assert_non_null(strstr(buffer,"\"photons\": 42"));
+  assert_non_null(strstr(buffer,"\"phgen\": { \"calls\": 1,"));
+  assert_non_null(strstr(buffer,"\"sirena_energy\": { \"calls\": 0,"));
+  remove(JSONFILE);
+  sixt_profiling=0;
+#else
+  assert_null(fp);
+#endif
+}
+
+#ifdef SIXT_BENCHMARK
+/** Reports the cost of the hooks spent for each photon of runsixt
+    (best of several runs): the photon generation, imaging and
+    detection stages, each with a counter, around a few hundred
+    nanoseconds of work. */
+static void benchmark_overhead(){
+  const long n=1000000;
+  resetSixtProfiling();
+  int active=sixt_profiling;
+  sixt_profiling=1;
+
+  double t[2]={1.e9, 1.e9};
+  int run, pass;
+  for (run=0; run<5; run++){
+    for (pass=0; pass<2; pass++){
+      double start=getSixtProfTime();
+      long ii;
+      for (ii=0; ii<n; ii++){
+	if (0==pass){
+	  work(50);
+	  work(50);
+	  work(50);
+	} else {
+	  SIXT_PROF_BEGIN(SIXT_PROF_PHGEN);
+	  work(50);
+	  SIXT_PROF_COUNT(SIXT_PROF_PHOTONS,1);
+	  SIXT_PROF_END(SIXT_PROF_PHGEN);
+	  SIXT_PROF_BEGIN(SIXT_PROF_PHIMG);
+	  work(50);
+	  SIXT_PROF_COUNT(SIXT_PROF_IMPACTS,1);
+	  SIXT_PROF_END(SIXT_PROF_PHIMG);
+	  SIXT_PROF_BEGIN(SIXT_PROF_PHDET);
+	  work(50);
+	  SIXT_PROF_COUNT(SIXT_PROF_EVENTS,1);
+	  SIXT_PROF_END(SIXT_PROF_PHDET);
+	}
+      }
+      t[pass]=MIN(t[pass], getSixtProfTime()-start);
+    }
+  }
+  sixt_profiling=active;
+
+  printf("# photon of %.0fns: %.1fns per photon for the hooks of 3 stages "
+	 "(%.0f photons/s without, %.0f photons/s with profiling, "
+	 "overhead %.1f%%)\n", t[0]/n*1.e9, (t[1]-t[0])/n*1.e9,
+	 n/t[0], n/t[1], (t[1]-t[0])/t[0]*100.);
+}
+#endif
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_counters),
+    cmocka_unit_test(test_stage_timing),
+    cmocka_unit_test(test_threads),
+    cmocka_unit_test(test_json_summary),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_overhead),
+#endif
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
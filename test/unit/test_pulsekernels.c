@@ -0,0 +1,243 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pulsekernels.h"
+
+
+#define NSAMPLES 4096
+
+/** Synthetic record: baseline with noise and a few exponential pulses. */
+static void synthetic_record(double* const x, const int n, const unsigned int seed){
+	srand(seed);
+	int ii;
+	for (ii=0; ii<n; ii++){
+		x[ii] = 1000.+((rand()%2001)-1000)/100.;
+	}
+	int start;
+	for (start=n/10; start<n; start+=n/4+1){
+		for (ii=start; ii<n; ii++){
+			x[ii] += 500.*(exp(-(ii-start)/200.)-exp(-(ii-start)/10.));
+		}
+	}
+}
+
+/** Box-car low-pass filtering as done originally by 'lpf_boxcar'
+    (over a copy of the record lengthened with a decaying tail). */
+static void ref_lpf_boxcar(double* const x, const int n, const int boxLength){
+	double* aux = malloc((n+boxLength)*sizeof(double));
+	double* aux1 = malloc((n+boxLength)*sizeof(double));
+	int ii;
+	memcpy(aux, x, n*sizeof(double));
+	double value = x[n-1];
+	for (ii=n; ii<n+boxLength; ii++){
+		if (value > 0) value = value-0.01*value;
+		else if (value < 0) value = value+0.01*value;
+		aux[ii] = value;
+	}
+	double boxSum = 0.;
+	for (ii=0; ii<boxLength; ii++){
+		boxSum = boxSum + aux[ii];
+	}
+	aux1[0] = boxSum/boxLength;
+	for (ii=0; ii<n; ii++){
+		boxSum = boxSum - aux[ii] + aux[ii+boxLength];
+		aux1[ii+1] = boxSum/boxLength;
+	}
+	memcpy(x, aux1, n*sizeof(double));
+	free(aux);
+	free(aux1);
+}
+
+static void ref_differentiate(double* const x, const int n){
+	int ii;
+	for (ii=0; ii<n-1; ii++){
+		x[ii] = x[ii+1]-x[ii];
+	}
+	x[n-1] = x[n-2];
+}
+
+/** Convolution with the (-1,...,-1,+1,...,+1) window as done
+    originally by 'smoothDerivative'. */
+static void ref_smoothDerivative(double* const x, const int n, const int N){
+	double* conv = calloc(n, sizeof(double));
+	int ii, jj;
+	for (ii=0; ii<n; ii++){
+		int index = N-1;
+		for (jj=ii; jj>=ii-N+1; jj--){
+			if (jj>=0){
+				conv[ii] += x[jj]*((index < N/2) ? -1.0 : 1.0);
+				index--;
+			}
+		}
+	}
+	memcpy(x, conv, n*sizeof(double));
+	free(conv);
+}
+
+static int compare_doubles(const void* a, const void* b){
+	double da = *(const double*)a, db = *(const double*)b;
+	return ((da > db) - (da < db));
+}
+
+static double ref_median(const double* const x, const int n){
+	double* sorted = malloc(n*sizeof(double));
+	memcpy(sorted, x, n*sizeof(double));
+	qsort(sorted, n, sizeof(double), compare_doubles);
+	double median = (n%2 == 0) ? (sorted[n/2-1]+sorted[n/2])/2 : sorted[n/2];
+	free(sorted);
+	return (median);
+}
+
+static void assert_arrays_equal(const double* const a, const double* const b, const int n){
+	int ii;
+	for (ii=0; ii<n; ii++){
+		assert_true(a[ii] == b[ii]);
+	}
+}
+
+static void test_lpf_boxcar(){
+	double x[NSAMPLES], ref[NSAMPLES];
+	const int lengths[] = {1, 2, 7, 64, NSAMPLES-1};
+	unsigned int kk;
+	for (kk=0; kk<sizeof(lengths)/sizeof(lengths[0]); kk++){
+		synthetic_record(x, NSAMPLES, kk);
+		memcpy(ref, x, sizeof(x));
+		lpf_boxcar_array(x, NSAMPLES, lengths[kk]);
+		ref_lpf_boxcar(ref, NSAMPLES, lengths[kk]);
+		assert_arrays_equal(x, ref, NSAMPLES);
+	}
+}
+
+static void test_lpf_boxcar_length(){
+	// 1/cutFreq = pi*scaleFactor
+	assert_int_equal(lpf_boxcar_length(0.005, 1000), 15);
+	assert_int_equal(lpf_boxcar_length(1e-9, 156250), 1);
+}
+
+static void test_lpf_boxcar_differentiate(){
+	double x[NSAMPLES], ref[NSAMPLES];
+	const int lengths[] = {1, 3, 16, 100, NSAMPLES-1};
+	unsigned int kk;
+	for (kk=0; kk<sizeof(lengths)/sizeof(lengths[0]); kk++){
+		synthetic_record(x, NSAMPLES, 10+kk);
+		memcpy(ref, x, sizeof(x));
+		lpf_boxcar_differentiate_array(x, NSAMPLES, lengths[kk]);
+		ref_lpf_boxcar(ref, NSAMPLES, lengths[kk]);
+		ref_differentiate(ref, NSAMPLES);
+		assert_arrays_equal(x, ref, NSAMPLES);
+	}
+
+	synthetic_record(x, NSAMPLES, 20);
+	memcpy(ref, x, sizeof(x));
+	differentiate_array(x, NSAMPLES);
+	ref_differentiate(ref, NSAMPLES);
+	assert_arrays_equal(x, ref, NSAMPLES);
+}
+
+static void test_smoothDerivative(){
+	double x[NSAMPLES], ref[NSAMPLES];
+	const int lengths[] = {2, 4, 32};
+	unsigned int kk;
+	for (kk=0; kk<sizeof(lengths)/sizeof(lengths[0]); kk++){
+		synthetic_record(x, NSAMPLES, 30+kk);
+		memcpy(ref, x, sizeof(x));
+		smoothDerivative_array(x, NSAMPLES, lengths[kk]);
+		ref_smoothDerivative(ref, NSAMPLES, lengths[kk]);
+		assert_arrays_equal(x, ref, NSAMPLES);
+	}
+}
+
+static void test_median_mean_sigma(){
+	double x[NSAMPLES];
+	const int sizes[] = {1, 2, 5, 100, NSAMPLES-1, NSAMPLES};
+	unsigned int kk;
+	int ii;
+	for (kk=0; kk<sizeof(sizes)/sizeof(sizes[0]); kk++){
+		synthetic_record(x, sizes[kk], 40+kk);
+		double ref = ref_median(x, sizes[kk]);
+		assert_true(median_array(x, sizes[kk]) == ref);
+	}
+
+	synthetic_record(x, NSAMPLES, 50);
+	double mean, sigma;
+	findMeanSigma_array(x, NSAMPLES, &mean, &sigma);
+	double sum = 0., suma = 0.;
+	for (ii=0; ii<NSAMPLES; ii++) sum += x[ii];
+	for (ii=0; ii<NSAMPLES; ii++) suma += (x[ii]-sum/NSAMPLES)*(x[ii]-sum/NSAMPLES);
+	assert_true(mean == sum/NSAMPLES);
+	assert_true(sigma == sqrt(suma/(NSAMPLES-1)));
+
+	x[7] = 2e10;
+	findMeanSigma_array(x, NSAMPLES, &mean, &sigma);
+	assert_true(mean == 1e10);
+	assert_true(sigma == 1e10);
+}
+
+#ifdef SIXT_BENCHMARK
+/** Reports the throughput (records/s) of the low-pass filtering and
+    derivative of a record, as two passes and as the fused kernel. */
+static void benchmark_lpf_boxcar_differentiate(){
+	const int sizes[] = {1000, 10000, 100000};
+	const int boxLength = 16;
+	unsigned int kk;
+	for (kk=0; kk<sizeof(sizes)/sizeof(sizes[0]); kk++){
+		const int n = sizes[kk];
+		const int nrecords = 20000000/n;
+		double* record = malloc(n*sizeof(double));
+		double* x = malloc(n*sizeof(double));
+		synthetic_record(record, n, 60);
+
+		int ii;
+		clock_t start = clock();
+		for (ii=0; ii<nrecords; ii++){
+			memcpy(x, record, n*sizeof(double));
+			lpf_boxcar_array(x, n, boxLength);
+			differentiate_array(x, n);
+		}
+		double t_two = (double)(clock()-start)/CLOCKS_PER_SEC;
+
+		start = clock();
+		for (ii=0; ii<nrecords; ii++){
+			memcpy(x, record, n*sizeof(double));
+			lpf_boxcar_differentiate_array(x, n, boxLength);
+		}
+		double t_fused = (double)(clock()-start)/CLOCKS_PER_SEC;
+
+		printf("# %6d samples: lpf_boxcar+differentiate %.0f records/s, "
+		       "fused %.0f records/s\n", n,
+		       nrecords/fmax(t_two, 1e-9), nrecords/fmax(t_fused, 1e-9));
+
+		free(record);
+		free(x);
+	}
+}
+#endif
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_lpf_boxcar),
+    cmocka_unit_test(test_lpf_boxcar_length),
+    cmocka_unit_test(test_lpf_boxcar_differentiate),
+    cmocka_unit_test(test_smoothDerivative),
+    cmocka_unit_test(test_median_mean_sigma),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_lpf_boxcar_differentiate),
+#endif
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
@@ -0,0 +1,326 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <time.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+#include "sourcecatalog.h"
+#include "rndgen.h"
+
+
+#define TEMPLATE "data/dummy.simput"
+#define FILENAME "test_sourcecatalog.simput"
+#define CACHEFILE FILENAME ".kdtree"
+#define ARF_FILENAME "data/dummy.arf"
+
+/** Relative difference allowed between the source positions of the
+    catalog and of the SIMPUT library. */
+#define POSITION_TOLERANCE (1.e-7)
+
+/** Copy of the dummy catalog with nsources point sources at random
+    positions within 5 degrees around (RA,Dec)=(10,-20) degrees. All
+    sources refer to the spectrum of the dummy catalog. */
+static void create_catalog(const long nsources){
+  int status=EXIT_SUCCESS;
+  fitsfile* in=NULL;
+  fitsfile* out=NULL;
+  remove(FILENAME);
+  fits_open_file(&in,TEMPLATE,READONLY,&status);
+  fits_create_file(&out,FILENAME,&status);
+  fits_copy_file(in,out,1,1,1,&status);
+  fits_close_file(in,&status);
+  fits_movnam_hdu(out,BINARY_TBL,"SRC_CAT",0,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  long nrows;
+  fits_get_num_rows(out,&nrows,&status);
+  if (nsources>nrows){
+    fits_insert_rows(out,nrows,nsources-nrows,&status);
+  } else if (nsources<nrows){
+    fits_delete_rows(out,nsources+1,nrows-nsources,&status);
+  }
+
+  // Copy all columns except for the position from the first row.
+  int ncols, col;
+  fits_get_num_cols(out,&ncols,&status);
+  int cra, cdec;
+  fits_get_colnum(out,CASEINSEN,"RA",&cra,&status);
+  fits_get_colnum(out,CASEINSEN,"DEC",&cdec,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  for (col=1; col<=ncols; col++){
+    if ((col==cra)||(col==cdec)) continue;
+    int typecode;
+    long repeat, width;
+    fits_get_coltype(out,col,&typecode,&repeat,&width,&status);
+    if (TSTRING==typecode){
+      char buffer[MAXFILENAME];
+      char* value[]={buffer};
+      int anynul;
+      fits_read_col(out,TSTRING,col,1,1,1,"",value,&anynul,&status);
+      long row;
+      for (row=2; row<=nsources; row++){
+	fits_write_col(out,TSTRING,col,row,1,1,value,&status);
+      }
+    } else {
+      double value;
+      int anynul;
+      fits_read_col(out,TDOUBLE,col,1,1,1,NULL,&value,&anynul,&status);
+      long row;
+      for (row=2; row<=nsources; row++){
+	fits_write_col(out,TDOUBLE,col,row,1,1,&value,&status);
+      }
+    }
+  }
+
+  double* ra=(double*)malloc(nsources*sizeof(double));
+  double* dec=(double*)malloc(nsources*sizeof(double));
+  assert_true(NULL!=ra && NULL!=dec);
+  srand(3);
+  long ii;
+  for (ii=0; ii<nsources; ii++){
+    ra[ii] =10.+10.*(rand()/(double)RAND_MAX-0.5);
+    dec[ii]=-20.+10.*(rand()/(double)RAND_MAX-0.5);
+  }
+  fits_write_col(out,TDOUBLE,cra,1,1,nsources,ra,&status);
+  fits_write_col(out,TDOUBLE,cdec,1,1,nsources,dec,&status);
+  fits_close_file(out,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  free(ra);
+  free(dec);
+}
+
+/** List of the point sources as built before with the routines of
+    the SIMPUT library for each row. */
+static Source* reference_list(SimputCtlg* const simput, long* const nsources){
+  int status=EXIT_SUCCESS;
+  Source* list=(Source*)malloc(simput->nentries*sizeof(Source));
+  assert_non_null(list);
+  *nsources=0;
+  long row;
+  for (row=1; row<=simput->nentries; row++){
+    SimputSrc* src=getSimputSrc(simput,row,&status);
+    double ra, dec;
+    float extension=getSimputSrcExt(simput,src,&ra,&dec,0.,0.,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    if (extension>0.) continue;
+    Source* s=&list[(*nsources)++];
+    s->ra=src->ra;
+    s->dec=src->dec;
+    s->extension=0.;
+    s->row=row;
+    s->t_next_photon=NULL;
+    s->energies=NULL;
+    s->rate=0.;
+  }
+  return(list);
+}
+
+/** The trees have the same structure and sources. The positions may
+    differ by the relative amount 'tolerance' (the catalog converts
+    them to [rad] in double precision, the SIMPUT library possibly in
+    single precision). */
+static void assert_trees_equal(const KDTreeElement* a, const KDTreeElement* b,
+			       const double tolerance){
+  if (NULL==a){
+    assert_null(b);
+    return;
+  }
+  assert_non_null(b);
+  assert_true(fabs(a->src->ra-b->src->ra)<=tolerance*fabs(b->src->ra));
+  assert_true(fabs(a->src->dec-b->src->dec)<=tolerance*fabs(b->src->dec));
+  assert_int_equal(a->src->row,b->src->row);
+  assert_true(a->src->extension==b->src->extension);
+  assert_trees_equal(a->left,b->left,tolerance);
+  assert_trees_equal(a->right,b->right,tolerance);
+}
+
+/** The catalog loaded in a single pass yields the same KDTree as the
+    sources obtained one by one from the SIMPUT library. */
+static void test_load_catalog(){
+  int status=EXIT_SUCCESS;
+  create_catalog(5000);
+  unsetenv("SIXTE_SRCCAT_CACHE");
+  struct ARF* arf=loadARF(ARF_FILENAME,&status);
+  SourceCatalog* cat=loadSourceCatalog(FILENAME,arf,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_int_equal(cat->nextsources,0);
+
+  long nsources;
+  Source* list=reference_list(cat->simput,&nsources);
+  assert_int_equal(nsources,5000);
+  KDTreeElement* tree=buildKDTree2(list,nsources,0,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_trees_equal(cat->tree,tree,POSITION_TOLERANCE);
+
+  freeKDTreeElement(&tree);
+  free(list);
+  freeSourceCatalog(&cat,&status);
+  freeARF(arf);
+  remove(FILENAME);
+}
+
+/** Modification time of a file. */
+static time_t get_mtime(const char* const name){
+  struct stat st;
+  assert_int_equal(stat(name,&st),0);
+  return(st.st_mtime);
+}
+
+/** Set the modification time of a file. */
+static void set_mtime(const char* const name, const time_t mtime){
+  struct utimbuf times={ .actime=mtime, .modtime=mtime };
+  assert_int_equal(utime(name,&times),0);
+}
+
+/** The KDTree restored from the cache is identical to the one built
+    from the catalog. A modified catalog invalidates the cache. */
+static void test_catalog_cache(){
+  int status=EXIT_SUCCESS;
+  create_catalog(3000);
+  remove(CACHEFILE);
+  setenv("SIXTE_SRCCAT_CACHE","1",1);
+  struct ARF* arf=loadARF(ARF_FILENAME,&status);
+  SourceCatalog* built=loadSourceCatalog(FILENAME,arf,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  FILE* cache=fopen(CACHEFILE,"r");
+  assert_non_null(cache);
+  fclose(cache);
+
+  SourceCatalog* cached=loadSourceCatalog(FILENAME,arf,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_trees_equal(built->tree,cached->tree,0.);
+  assert_int_equal(built->nextsources,cached->nextsources);
+  freeSourceCatalog(&cached,&status);
+
+  // The cache is valid as long as the catalog file is not touched
+  // (the same holds for the files with the images).
+  set_mtime(CACHEFILE,1000);
+  cached=loadSourceCatalog(FILENAME,arf,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_int_equal(get_mtime(CACHEFILE),1000);
+  freeSourceCatalog(&cached,&status);
+  set_mtime(FILENAME,get_mtime(FILENAME)+10);
+  cached=loadSourceCatalog(FILENAME,arf,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_true(get_mtime(CACHEFILE)!=1000);
+  assert_trees_equal(built->tree,cached->tree,0.);
+  freeSourceCatalog(&cached,&status);
+  freeSourceCatalog(&built,&status);
+
+  // A catalog with other positions must not use the old cache.
+  create_catalog(2999);
+  built=loadSourceCatalog(FILENAME,arf,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  long nsources;
+  Source* list=reference_list(built->simput,&nsources);
+  KDTreeElement* tree=buildKDTree2(list,nsources,0,&status);
+  assert_trees_equal(built->tree,tree,POSITION_TOLERANCE);
+
+  freeKDTreeElement(&tree);
+  free(list);
+  freeSourceCatalog(&built,&status);
+  freeARF(arf);
+  unsetenv("SIXTE_SRCCAT_CACHE");
+  remove(FILENAME);
+  remove(CACHEFILE);
+}
+
+/** With SIXTE_SIMPUT_PHOTONS set, no energy tables are used and all
+    photons are obtained from the SIMPUT library. */
+static void test_simput_photons_switch(){
+  int status=EXIT_SUCCESS;
+  create_catalog(10);
+  unsetenv("SIXTE_SRCCAT_CACHE");
+  struct ARF* arf=loadARF(ARF_FILENAME,&status);
+
+  SourceCatalog* cat=loadSourceCatalog(FILENAME,arf,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_non_null(cat->energies);
+  freeSourceCatalog(&cat,&status);
+
+  setenv("SIXTE_SIMPUT_PHOTONS","1",1);
+  cat=loadSourceCatalog(FILENAME,arf,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_null(cat->energies);
+  freeSourceCatalog(&cat,&status);
+  unsetenv("SIXTE_SIMPUT_PHOTONS");
+
+  freeARF(arf);
+  remove(FILENAME);
+}
+
+#ifdef SIXT_BENCHMARK
+/** Reports the time from opening the catalog until the first photons
+    are generated for different catalog sizes, with and without the
+    cache of the KDTree. */
+static void benchmark_first_photon(){
+  long nsources[]={1000,10000,100000};
+  unsigned int ii;
+  for (ii=0; ii<sizeof(nsources)/sizeof(nsources[0]); ii++){
+    int status=EXIT_SUCCESS;
+    create_catalog(nsources[ii]);
+    remove(CACHEFILE);
+    struct ARF* arf=loadARF(ARF_FILENAME,&status);
+    Vector pointing=unit_vector(10.*M_PI/180.,-20.*M_PI/180.);
+
+    double t[2];
+    int pass;
+    for (pass=0; pass<2; pass++){
+      if (0==pass){
+	unsetenv("SIXTE_SRCCAT_CACHE");
+      } else {
+	// Create the cache file first.
+	setenv("SIXTE_SRCCAT_CACHE","1",1);
+	SourceCatalog* cat=loadSourceCatalog(FILENAME,arf,&status);
+	freeSourceCatalog(&cat,&status);
+      }
+      sixt_init_rng(1,&status);
+      clock_t start=clock();
+      SourceCatalog* cat=loadSourceCatalog(FILENAME,arf,&status);
+      LinkedPhoListElement* photons=NULL;
+      double t0=0.;
+      while ((NULL==photons)&&(EXIT_SUCCESS==status)&&(t0<100.)){
+	photons=genFoVXRayPhotons(cat,&pointing,1.*M_PI/180.,t0,t0+1.,
+				  55000.,&status);
+	t0+=1.;
+      }
+      t[pass]=(double)(clock()-start)/CLOCKS_PER_SEC;
+      assert_int_equal(status,EXIT_SUCCESS);
+      assert_non_null(photons);
+      freeLinkedPhoList(&photons);
+      freeSourceCatalog(&cat,&status);
+      sixt_destroy_rng();
+    }
+
+    printf("# %6ld sources: time to first photon %.3fs, with cache %.3fs\n",
+	   nsources[ii], t[0], t[1]);
+
+    freeARF(arf);
+    unsetenv("SIXTE_SRCCAT_CACHE");
+    remove(FILENAME);
+    remove(CACHEFILE);
+  }
+}
+#endif
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_load_catalog),
+    cmocka_unit_test(test_catalog_cache),
+    cmocka_unit_test(test_simput_photons_switch),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_first_photon),
+#endif
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
@@ -0,0 +1,228 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <time.h>
+
+#include "tesnoisespectrum.h"
+
+
+#define NTYPES 3
+#define SAMPLEFREQ 156250.
+
+/** Pixels with NTYPES different noise spectra (pixel j has type
+    j%NTYPES). Type 0 is white noise. */
+static AdvPix** new_pixels(int npix, TESNoiseProperties** noise){
+  int status=EXIT_SUCCESS;
+  int type;
+  for (type=0; type<NTYPES; type++){
+    noise[type]=newTESNoise(&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    noise[type]->WhiteRMS=10.+type;
+    noise[type]->H0=1.;
+    if (type>0){
+      noise[type]->Nz=1;
+      noise[type]->Np=type;
+      noise[type]->Zeros=(double*)malloc(sizeof(double));
+      noise[type]->Poles=(double*)malloc(type*sizeof(double));
+      assert_true(NULL!=noise[type]->Zeros && NULL!=noise[type]->Poles);
+      noise[type]->Zeros[0]=1.e-5;
+      int k;
+      for (k=0; k<type; k++){
+	noise[type]->Poles[k]=1.e-4/(k+1);
+      }
+    }
+  }
+
+  AdvPix* pix=(AdvPix*)calloc(npix,sizeof(AdvPix));
+  AdvPix** pixels=(AdvPix**)malloc(npix*sizeof(AdvPix*));
+  assert_true(NULL!=pix && NULL!=pixels);
+  int j;
+  for (j=0; j<npix; j++){
+    pix[j].TESNoise=noise[j%NTYPES];
+    pixels[j]=&pix[j];
+  }
+  return(pixels);
+}
+
+static void free_pixels(AdvPix** pixels, TESNoiseProperties** noise){
+  free(pixels[0]);
+  free(pixels);
+  int type;
+  for (type=0; type<NTYPES; type++){
+    destroyTESNoiseProperties(noise[type]);
+  }
+}
+
+/** Expected amplitude of the filter of a pixel. */
+static double filter_amplitude(const TESNoiseProperties* noise, int bin){
+  const double df=SAMPLEFREQ/NOISEBUFFERSIZE;
+  const double w=2.*M_PI*bin*df;
+  double complex H=noise->H0;
+  int k;
+  for (k=0; k<noise->Nz; k++){
+    H*=1.+noise->Zeros[k]*w*I;
+  }
+  for (k=0; k<noise->Np; k++){
+    H/=1.+noise->Poles[k]*w*I;
+  }
+  return(cabs(H)*noise->WhiteRMS*sqrt(df/2.));
+}
+
+/** Pixels with the same noise parameters share their filter. */
+static void test_noise_filters(){
+  int status=EXIT_SUCCESS;
+  TESNoiseProperties* noise[NTYPES];
+  int npix=10;
+  double freq=SAMPLEFREQ;
+  AdvPix** pixels=new_pixels(npix,noise);
+
+  // A copy of the parameters yields the same filter.
+  TESNoiseProperties copy=*noise[2];
+  pixels[8]->TESNoise=&copy;
+
+  NoiseBuffer* buffer=newNoiseBuffer(&status,&npix,pixels,&freq);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_int_equal(buffer->NFilter,NTYPES);
+
+  const int nbins=NOISEBUFFERSIZE/2+1;
+  int j;
+  for (j=0; j<npix; j++){
+    assert_int_equal(buffer->FilterIndex[j],buffer->FilterIndex[j%NTYPES]);
+    const double* filter=&buffer->Filter[buffer->FilterIndex[j]*nbins];
+    assert_true(filter[0]==0.);
+    int bin;
+    for (bin=1; bin<nbins; bin+=997){
+      double expected=filter_amplitude(pixels[j]->TESNoise,bin);
+      assert_true(fabs(filter[bin]-expected)<=1.e-12*expected);
+    }
+  }
+
+  destroyNoiseBuffer(buffer,&status);
+  free_pixels(pixels,noise);
+}
+
+/** The variance of white noise matches the spectrum, and the pixels
+    have independent noise. */
+static void test_noise_variance(){
+  int status=EXIT_SUCCESS;
+  TESNoiseProperties* noise[NTYPES];
+  int npix=NTYPES+1;
+  double freq=SAMPLEFREQ;
+  AdvPix** pixels=new_pixels(npix,noise);
+  gsl_rng* rng;
+  setNoiseGSLSeed(&rng,42);
+
+  NoiseBuffer* buffer=newNoiseBuffer(&status,&npix,pixels,&freq);
+  genNoiseSpectrum(buffer,&rng,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  const int n=NOISEBUFFERSIZE;
+  const double f=filter_amplitude(noise[0],1);
+  const double expected=f*f*(4.*(n/2-1)+1.)/(2.*n);
+  const double* b0=&buffer->Buffer[0];
+  const double* b3=&buffer->Buffer[NTYPES*n];
+  double sum=0., sum2=0., diff=0.;
+  int i;
+  for (i=0; i<n; i++){
+    sum+=b0[i];
+    sum2+=b0[i]*b0[i];
+    diff+=fabs(b0[i]-b3[i]);
+  }
+  const double mean=sum/n;
+  const double var=sum2/n-mean*mean;
+  assert_true(fabs(var/expected-1.)<0.03);
+  assert_true(fabs(mean)<5.*sqrt(expected/n));
+  assert_true(diff>0.);
+
+  destroyNoiseBuffer(buffer,&status);
+  gsl_rng_free(rng);
+  free_pixels(pixels,noise);
+}
+
+/** Refilling the buffers with the same seed gives the same noise,
+    independent of the other buffers in use. */
+static void test_noise_reproducible(){
+  int status=EXIT_SUCCESS;
+  TESNoiseProperties* noise[NTYPES];
+  int npix=5;
+  double freq=SAMPLEFREQ;
+  AdvPix** pixels=new_pixels(npix,noise);
+
+  NoiseBuffer* buffer[2];
+  gsl_rng* rng[2];
+  int k;
+  for (k=0; k<2; k++){
+    buffer[k]=newNoiseBuffer(&status,&npix,pixels,&freq);
+    setNoiseGSLSeed(&rng[k],7);
+  }
+  int fill;
+  for (fill=0; fill<3; fill++){
+    for (k=0; k<2; k++){
+      genNoiseSpectrum(buffer[k],&rng[k],&status);
+    }
+    assert_int_equal(status,EXIT_SUCCESS);
+    assert_memory_equal(buffer[0]->Buffer,buffer[1]->Buffer,
+			(size_t)npix*NOISEBUFFERSIZE*sizeof(double));
+  }
+
+  for (k=0; k<2; k++){
+    destroyNoiseBuffer(buffer[k],&status);
+    gsl_rng_free(rng[k]);
+  }
+  free_pixels(pixels,noise);
+}
+
+#ifdef SIXT_BENCHMARK
+/** Reports the number of noise samples generated per second for
+    different numbers of active pixels. */
+static void benchmark_noise(){
+  int npixels[]={1,10,100,1000};
+  unsigned int ii;
+  for (ii=0; ii<sizeof(npixels)/sizeof(npixels[0]); ii++){
+    int status=EXIT_SUCCESS;
+    TESNoiseProperties* noise[NTYPES];
+    int npix=npixels[ii];
+    double freq=SAMPLEFREQ;
+    AdvPix** pixels=new_pixels(npix,noise);
+    gsl_rng* rng;
+    setNoiseGSLSeed(&rng,1);
+
+    const int nfill=npix<100 ? 20 : 2;
+    clock_t start=clock();
+    NoiseBuffer* buffer=newNoiseBuffer(&status,&npix,pixels,&freq);
+    int fill;
+    for (fill=0; fill<nfill; fill++){
+      genNoiseSpectrum(buffer,&rng,&status);
+    }
+    double t=(double)(clock()-start)/CLOCKS_PER_SEC;
+    assert_int_equal(status,EXIT_SUCCESS);
+
+    printf("# %4d pixels: %.3g noise samples/s\n",
+	   npix, (double)npix*nfill*NOISEBUFFERSIZE/t);
+
+    destroyNoiseBuffer(buffer,&status);
+    gsl_rng_free(rng);
+    free_pixels(pixels,noise);
+  }
+}
+#endif
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_noise_filters),
+    cmocka_unit_test(test_noise_variance),
+    cmocka_unit_test(test_noise_reproducible),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_noise),
+#endif
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
@@ -0,0 +1,222 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <complex.h>
+#include <time.h>
+
+#include "tessim.h"
+
+
+#define TCLOCK 50e-9
+#define DELAY 40
+#define GBW 15e3
+#define I0_START 50e-6
+#define NCLOCKS 200000
+
+/** BBFB loop of a single pixel as computed originally by
+    run_timedomain_bbfb_loop (cexp/cos at every clock). */
+typedef struct {
+  double carrier_frequency;
+  double cphase;
+  double bias_leakage;
+  double bias_leakage_phase;
+  double fb_leakage;
+  int fb_leakage_lag;
+  double _Complex integral;
+  double fb_values[DELAY];
+  int fb_index;
+} ref_bbfb;
+
+static void ref_init(ref_bbfb *ref, double carrier_frequency, double bias_leakage,
+		     double bias_leakage_phase, double fb_leakage, int fb_leakage_lag){
+  ref->carrier_frequency=carrier_frequency;
+  ref->cphase=2*M_PI*DELAY*TCLOCK*carrier_frequency;
+  ref->bias_leakage=bias_leakage;
+  ref->bias_leakage_phase=bias_leakage_phase;
+  ref->fb_leakage=fb_leakage;
+  ref->fb_leakage_lag=fb_leakage_lag;
+  ref->integral=I0_START*sqrt(2)/(TCLOCK*GBW*2*M_PI*2);
+  for (int ii=0;ii<DELAY;ii++){
+    ref->fb_values[ii]=I0_START*sqrt(2)*cos(2*M_PI*carrier_frequency*(ii+1)*TCLOCK);
+  }
+  ref->fb_index=0;
+}
+
+static double ref_run(ref_bbfb *ref, tesparams *tes, double time){
+  double _Complex lod = cexp(I*(2*M_PI*ref->carrier_frequency*time));
+  double _Complex lor = cexp(-I*(2*M_PI*ref->carrier_frequency*time+ref->cphase));
+  double fb_leakage_value = ref->fb_leakage*ref->fb_values[(ref->fb_index-ref->fb_leakage_lag+DELAY) % DELAY];
+  double bias_leakage_value = ref->bias_leakage*cos(2*M_PI*ref->carrier_frequency*time+ref->bias_leakage_phase)*sqrt(2);
+  double squid_input = tes->I0*cos(2*M_PI*ref->carrier_frequency*time)*sqrt(2);
+  double current_error = squid_input-ref->fb_values[ref->fb_index]+bias_leakage_value+fb_leakage_value;
+  double squid_error=tes->M_in*current_error/tes->TTR;
+  double error=sin(2*M_PI*squid_error)/(2*M_PI)/tes->M_in*tes->TTR;
+  ref->integral+= error*lod;
+  double _Complex base = ref->integral*TCLOCK*GBW*2*M_PI*2;
+  ref->fb_values[ref->fb_index] = creal(base*lor);
+  ref->fb_index = (ref->fb_index+1) % DELAY;
+  return(cabs(base));
+}
+
+static tesparams* get_mock_tes(){
+  tesparams *tes=(tesparams*)calloc(1,sizeof(tesparams));
+  assert_non_null(tes);
+  tes->I0=I0_START;
+  tes->I0_start=I0_START;
+  tes->M_in=1e-10*1e6;
+  tes->TTR=1.;
+  tes->delta_t=TCLOCK;
+  tes->tstart=0.;
+  return(tes);
+}
+
+/** TES current with a pulse starting at clock 'start'. */
+static double pulse_current(int clock, int start, double height){
+  if (clock<start){
+    return(I0_START);
+  }
+  double t=(clock-start)*TCLOCK;
+  return(I0_START*(1.-height*(exp(-t/2e-3)-exp(-t/1e-4))));
+}
+
+/** A channel with a single pixel reproduces the original loop. */
+static void test_bbfb_single_pixel(){
+  int status=EXIT_SUCCESS;
+  tesparams *tes=get_mock_tes();
+
+  timedomain_bbfb_info *bbfb=init_timedomain_bbfb(TCLOCK,DELAY,GBW,1e-3,3,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  add_timedomain_bbfb_pixel(bbfb,tes,2.1e6,0,1e-3*I0_START,0.3,I0_START,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_int_equal(tes->bbfb_index,0);
+  assert_ptr_equal(tes->bbfb_info,bbfb);
+
+  ref_bbfb ref;
+  ref_init(&ref,2.1e6,1e-3*I0_START,0.3,1e-3,3);
+
+  double maxdev=0.;
+  for (int ii=1;ii<=NCLOCKS;ii++){
+    double time=ii*TCLOCK;
+    tes->I0=pulse_current(ii,NCLOCKS/10,0.2);
+    double out=run_timedomain_bbfb_loop(tes,time,tes->I0,0.,NULL);
+    double expected=ref_run(&ref,tes,time);
+    maxdev=fmax(maxdev,fabs(out-expected));
+  }
+  assert_true(maxdev<=1e-9*I0_START);
+
+  free_timedomain_bbfb(&bbfb,&status);
+  assert_null(bbfb);
+  free(tes);
+}
+
+/** Each pixel of a channel gets the output of its own loop, up to the
+    crosstalk through the shared SQUID and feedback line, which is
+    proportional to the pulse heights (the carriers being far apart
+    compared to the loop bandwidth). */
+static void test_bbfb_channel(){
+  int status=EXIT_SUCCESS;
+  const int npix=8;
+  tesparams *tes[npix];
+  ref_bbfb ref[npix];
+
+  timedomain_bbfb_info *bbfb=init_timedomain_bbfb(TCLOCK,DELAY,GBW,0.,0,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  for (int pp=0;pp<npix;pp++){
+    double frequency=1e6+pp*1e5;
+    tes[pp]=get_mock_tes();
+    add_timedomain_bbfb_pixel(bbfb,tes[pp],frequency,0,0.,0.,I0_START,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    assert_int_equal(tes[pp]->bbfb_index,pp);
+    ref_init(&ref[pp],frequency,0.,0.,0.,0);
+  }
+
+  const double max_height=0.005*npix;
+  double maxdev=0.;
+  for (int ii=1;ii<=NCLOCKS;ii++){
+    double time=ii*TCLOCK;
+    for (int pp=0;pp<npix;pp++){
+      tes[pp]->I0=pulse_current(ii,NCLOCKS/10+pp*1000,0.005*(pp+1));
+    }
+    for (int pp=0;pp<npix;pp++){
+      double out=run_timedomain_bbfb_loop(tes[pp],time,tes[pp]->I0,0.,NULL);
+      double expected=ref_run(&ref[pp],tes[pp],time);
+      if (ii>NCLOCKS/20){ // after the settling of the loops
+        maxdev=fmax(maxdev,fabs(out-expected));
+      }
+    }
+  }
+  assert_true(maxdev<=0.1*max_height*I0_START);
+
+  free_timedomain_bbfb(&bbfb,&status);
+  for (int pp=0;pp<npix;pp++){
+    free(tes[pp]);
+  }
+}
+
+#ifdef SIXT_BENCHMARK
+/** Reports the clock rate (samples/s) of a channel loop and of
+    independent per-pixel loops against the number of pixels. */
+static void benchmark_bbfb_channel(){
+  int status=EXIT_SUCCESS;
+  const int npixs[]={1,2,8,16,40};
+  const int nclocks=50000;
+  for (unsigned int kk=0;kk<sizeof(npixs)/sizeof(npixs[0]);kk++){
+    int npix=npixs[kk];
+    tesparams **tes=(tesparams**)malloc(npix*sizeof(*tes));
+    ref_bbfb *ref=(ref_bbfb*)malloc(npix*sizeof(*ref));
+    timedomain_bbfb_info *bbfb=init_timedomain_bbfb(TCLOCK,DELAY,GBW,0.,0,&status);
+    for (int pp=0;pp<npix;pp++){
+      tes[pp]=get_mock_tes();
+      add_timedomain_bbfb_pixel(bbfb,tes[pp],1e6+pp*1e5,0,0.,0.,I0_START,&status);
+      ref_init(&ref[pp],1e6+pp*1e5,0.,0.,0.,0);
+    }
+    assert_int_equal(status,EXIT_SUCCESS);
+
+    clock_t start=clock();
+    for (int ii=1;ii<=nclocks;ii++){
+      for (int pp=0;pp<npix;pp++){
+        ref_run(&ref[pp],tes[pp],ii*TCLOCK);
+      }
+    }
+    double t_pixel=(double)(clock()-start)/CLOCKS_PER_SEC;
+
+    start=clock();
+    for (int ii=1;ii<=nclocks;ii++){
+      for (int pp=0;pp<npix;pp++){
+        run_timedomain_bbfb_loop(tes[pp],ii*TCLOCK,tes[pp]->I0,0.,NULL);
+      }
+    }
+    double t_channel=(double)(clock()-start)/CLOCKS_PER_SEC;
+
+    printf("# %2d pixels: per-pixel loops %.3g samples/s, channel loop %.3g samples/s\n",
+	   npix,nclocks/fmax(t_pixel,1e-9),nclocks/fmax(t_channel,1e-9));
+
+    free_timedomain_bbfb(&bbfb,&status);
+    for (int pp=0;pp<npix;pp++){
+      free(tes[pp]);
+    }
+    free(tes);
+    free(ref);
+  }
+}
+#endif
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_bbfb_single_pixel),
+    cmocka_unit_test(test_bbfb_channel),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_bbfb_channel),
+#endif
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
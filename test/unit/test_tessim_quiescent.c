@@ -0,0 +1,174 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <gsl/gsl_fft_real.h>
+
+#include "tessim.h"
+
+
+#define SAMPLEFREQ 156.25e3
+#define SEGLEN 4096
+#define NSEG 64
+#define NSAMPLES (SEGLEN*(NSEG+1))
+#define NBANDS 4
+
+/** Frequency bands [Hz] in which the noise power is compared. */
+static const double band_edges[NBANDS+1]={100.,1e3,5e3,20e3,75e3};
+
+/** Samples of the noise stream. */
+typedef struct {
+  double* data;
+  long n;
+} stream_buffer;
+
+static stream_buffer buffer;
+
+static void buffer_write(tesparams *tes, double time, double pulse, int *status){
+  (void)tes;
+  (void)time;
+  (void)status;
+  if (buffer.n<NSAMPLES){
+    buffer.data[buffer.n]=pulse;
+  }
+  buffer.n++;
+}
+
+/** Parameters of a single AC biased pixel with the defaults of
+    tessim.par, without SQUID noise (which is the same in both modes). */
+static void default_params(tespxlparams *par, double quiescent_tol){
+  memset(par,0,sizeof(*par));
+  par->type="SPA";
+  par->id=1;
+  par->tstart=0.;
+  par->tstop=NSAMPLES/SAMPLEFREQ;
+  par->acdc=1;
+  par->T_start=90e-3;
+  par->Tb=55e-3;
+  par->R0=1.1e-3;
+  par->RL=0.;
+  par->Rpara=0.;
+  par->TTR=4.11;
+  par->alpha=100.;
+  par->beta=10.;
+  par->Lin=0.;
+  par->Lfilter=2e-6;
+  par->Ce1=0.26e-12;
+  par->Gb1=300e-12;
+  par->n=4.;
+  par->I0=72.5e-6;
+  par->V0=-1.;
+  par->bias=0.15;
+  par->sample_rate=SAMPLEFREQ;
+  par->imin=-1e-8;
+  par->imax=5e-5;
+  par->simnoise=1;
+  par->m_excess=0.8;
+  par->squid_noise=0.;
+  par->M_in=0.1724;
+  par->quiescent_tol=quiescent_tol;
+  par->readoutMode=READOUT_TOTAL;
+  par->seed=42;
+}
+
+/** Noise power of a noise-only stream in the bands, averaged over
+    NSEG segments (the first segment is skipped). */
+static void band_power(double quiescent_tol, double power[NBANDS],
+		       unsigned long* nlinear){
+  int status=EXIT_SUCCESS;
+  tespxlparams par;
+  default_params(&par,quiescent_tol);
+
+  AdvDet* det=newAdvDet(&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  det->npix=1;
+  det->pix=newAdvPix(&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  tesparams* tes=tes_init(&par,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_non_null(tes);
+  det->pix[0].tes=tes;
+  tes->write_to_stream=&buffer_write;
+
+  buffer.data=(double*)malloc(NSAMPLES*sizeof(double));
+  assert_non_null(buffer.data);
+  buffer.n=0;
+  tes_propagate(det,par.tstop,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_true(buffer.n>=NSAMPLES);
+
+  *nlinear=0;
+  if (NULL!=tes->quiescent_info){
+    *nlinear=((tes_quiescent_info*)tes->quiescent_info)->nsteps;
+  }
+
+  double segment[SEGLEN];
+  for (int bb=0; bb<NBANDS; bb++){
+    power[bb]=0.;
+  }
+  for (int ss=1; ss<=NSEG; ss++){
+    double mean=0.;
+    for (int ii=0; ii<SEGLEN; ii++){
+      segment[ii]=buffer.data[ss*SEGLEN+ii];
+      mean+=segment[ii];
+    }
+    mean/=SEGLEN;
+    for (int ii=0; ii<SEGLEN; ii++){
+      segment[ii]-=mean;
+    }
+    gsl_fft_real_radix2_transform(segment,1,SEGLEN);
+    // half-complex output: Re(k) at k, Im(k) at SEGLEN-k
+    for (int kk=1; kk<SEGLEN/2; kk++){
+      double freq=kk*SAMPLEFREQ/SEGLEN;
+      double pk=segment[kk]*segment[kk]+segment[SEGLEN-kk]*segment[SEGLEN-kk];
+      for (int bb=0; bb<NBANDS; bb++){
+	if (freq>=band_edges[bb] && freq<band_edges[bb+1]){
+	  power[bb]+=pk;
+	}
+      }
+    }
+  }
+
+  free(buffer.data);
+  buffer.data=NULL;
+  tes_free(tes);
+  free(tes);
+  det->pix[0].tes=NULL;
+  destroyAdvDet(&det);
+}
+
+/** The noise spectrum of the linearised model in the quiescent periods
+    agrees with the one of the full integration. */
+static void test_quiescent_noise_spectrum(){
+  double power_full[NBANDS], power_linear[NBANDS];
+  unsigned long nlinear_full, nlinear;
+
+  band_power(0.,power_full,&nlinear_full);
+  band_power(1e-2,power_linear,&nlinear);
+
+  assert_int_equal(nlinear_full,0);
+  // without impacts, (almost) all steps are done with the linear model
+  assert_true(nlinear>=0.99*NSAMPLES);
+
+  for (int bb=0; bb<NBANDS; bb++){
+    double ratio=power_linear[bb]/power_full[bb];
+    printf("# %6.0f-%6.0f Hz: linearised/full noise power %.4f\n",
+	   band_edges[bb],band_edges[bb+1],ratio);
+    assert_true(power_full[bb]>0.);
+    assert_true(fabs(ratio-1.)<0.15);
+  }
+}
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_quiescent_noise_spectrum)
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
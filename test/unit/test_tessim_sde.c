@@ -0,0 +1,184 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "tessim.h"
+
+
+#define SAMPLEFREQ 156.25e3
+#define PULSE_STEP 64
+#define PULSE_ENERGY (6.*1.602176565e-16) // 6 keV [J]
+#define SEED 42
+
+/** Integrators of the TES system. */
+enum {STEP_TES_SDE, STEP_SDE, STEP_RK4};
+
+/** Parameters of a single AC biased pixel with the defaults of
+    tessim.par. */
+static void default_params(tespxlparams *par, int simnoise, double sample_rate){
+  memset(par,0,sizeof(*par));
+  par->type="SPA";
+  par->id=1;
+  par->tstart=0.;
+  par->tstop=1.;
+  par->acdc=1;
+  par->T_start=90e-3;
+  par->Tb=55e-3;
+  par->R0=1.1e-3;
+  par->RL=0.;
+  par->Rpara=0.;
+  par->TTR=4.11;
+  par->alpha=100.;
+  par->beta=10.;
+  par->Lin=0.;
+  par->Lfilter=2e-6;
+  par->Ce1=0.26e-12;
+  par->Gb1=300e-12;
+  par->n=4.;
+  par->I0=72.5e-6;
+  par->V0=-1.;
+  par->bias=0.15;
+  par->sample_rate=sample_rate;
+  par->imin=-1e-8;
+  par->imax=5e-5;
+  par->simnoise=simnoise;
+  par->m_excess=0.8;
+  par->squid_noise=0.;
+  par->M_in=0.1724;
+  par->readoutMode=READOUT_TOTAL;
+  par->stochastic_integrator=1;
+  par->seed=SEED;
+}
+
+/** Current and temperature of a pixel absorbing a photon at
+    PULSE_STEP, integrated with 'stepper' as in tes_propagate. The
+    random number generator is seeded with SEED. */
+static void run_pulse(int stepper, int simnoise, double sample_rate,
+		      long nsteps, double* current, double* temperature){
+  int status=EXIT_SUCCESS;
+  tespxlparams par;
+  default_params(&par,simnoise,sample_rate);
+  tesparams* tes=tes_init(&par,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_non_null(tes);
+
+  gsl_rng* rng=gsl_rng_alloc(gsl_rng_mt19937);
+  assert_non_null(rng);
+  gsl_rng_set(rng,SEED);
+
+  const int noise_terms=simnoise ? TES_SDE_NOISE_TERMS : 0;
+  double Y[TES_SDE_DIM]={tes->I0,tes->T1};
+  double time=0.;
+  for (long ii=0; ii<nsteps; ii++){
+    tes->En1=(ii==PULSE_STEP) ? PULSE_ENERGY/(tes->delta_t*tes->therm) : 0.;
+    int s=GSL_SUCCESS;
+    if (stepper==STEP_TES_SDE){
+      s=tes_sde_step(tes,noise_terms,Y,rng);
+    } else if (stepper==STEP_SDE){
+      s=sde_step(TES_sde_deterministic,TES_sde_noise,TES_SDE_DIM,noise_terms,Y,tes->delta_t,rng,tes);
+    } else {
+      s=gsl_odeiv2_driver_apply_fixed_step(tes->odedriver,&time,tes->delta_t,1,Y);
+    }
+    assert_int_equal(s,GSL_SUCCESS);
+
+    tes->I0=Y[0];
+    tes->T1=Y[1];
+    tes->RT=tes->RTI(tes,Y);
+    tes->Pb1=tpow(tes);
+    current[ii]=Y[0];
+    temperature[ii]=Y[1];
+  }
+
+  gsl_rng_free(rng);
+  tes_free(tes);
+  free(tes);
+}
+
+/** Largest difference between two traces relative to the pulse
+    height of the first one (its largest deviation from the first
+    sample). */
+static double trace_difference(const double* a, const double* b, long n){
+  double height=0., diff=0.;
+  for (long ii=0; ii<n; ii++){
+    height=fmax(height,fabs(a[ii]-a[0]));
+    diff=fmax(diff,fabs(a[ii]-b[ii]));
+  }
+  assert_true(height>0.);
+  return diff/height;
+}
+
+/** With noise, the specialized integrator draws the same random
+    numbers as the generic sde_step and reproduces its traces up to
+    rounding. */
+static void test_tes_sde_step_noise(void **state){
+  (void)state;
+  const long nsteps=2048;
+  double* current[2];
+  double* temperature[2];
+  for (int kk=0; kk<2; kk++){
+    current[kk]=(double*)malloc(nsteps*sizeof(double));
+    temperature[kk]=(double*)malloc(nsteps*sizeof(double));
+    assert_non_null(current[kk]);
+    assert_non_null(temperature[kk]);
+  }
+
+  run_pulse(STEP_TES_SDE,1,SAMPLEFREQ,nsteps,current[0],temperature[0]);
+  run_pulse(STEP_SDE,1,SAMPLEFREQ,nsteps,current[1],temperature[1]);
+
+  double dI=trace_difference(current[1],current[0],nsteps);
+  double dT=trace_difference(temperature[1],temperature[0],nsteps);
+  printf("# with noise: tes_sde_step/sde_step differences %.3g (current), %.3g (temperature) of the pulse height\n",dI,dT);
+  assert_true(dI<1e-9);
+  assert_true(dT<1e-9);
+
+  for (int kk=0; kk<2; kk++){
+    free(current[kk]);
+    free(temperature[kk]);
+  }
+}
+
+/** Without noise, the specialized integrator (an Euler step) follows
+    the RK4 integration of the GSL. The step is reduced by a factor of
+    ten with respect to the default sample rate to keep the error of
+    the Euler step well below the tolerance. */
+static void test_tes_sde_step_rk4(void **state){
+  (void)state;
+  const long nsteps=20480;
+  double* current[2];
+  double* temperature[2];
+  for (int kk=0; kk<2; kk++){
+    current[kk]=(double*)malloc(nsteps*sizeof(double));
+    temperature[kk]=(double*)malloc(nsteps*sizeof(double));
+    assert_non_null(current[kk]);
+    assert_non_null(temperature[kk]);
+  }
+
+  run_pulse(STEP_TES_SDE,0,10.*SAMPLEFREQ,nsteps,current[0],temperature[0]);
+  run_pulse(STEP_RK4,0,10.*SAMPLEFREQ,nsteps,current[1],temperature[1]);
+
+  double dI=trace_difference(current[1],current[0],nsteps);
+  double dT=trace_difference(temperature[1],temperature[0],nsteps);
+  printf("# without noise: tes_sde_step/RK4 differences %.3g (current), %.3g (temperature) of the pulse height\n",dI,dT);
+  assert_true(dI<1e-2);
+  assert_true(dT<1e-2);
+
+  for (int kk=0; kk<2; kk++){
+    free(current[kk]);
+    free(temperature[kk]);
+  }
+}
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_tes_sde_step_noise),
+    cmocka_unit_test(test_tes_sde_step_rk4)
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
@@ -3,6 +3,8 @@
 #include <setjmp.h>
 #include <cmocka.h>
 
+#include <time.h>
+
 //#include "sixt.h"
 #include "vignetting.h"
 
@@ -107,14 +109,169 @@ void test_get_vign_factor(){
 	return;
 }
 
+/** Interpolation over the off-axis angle as done originally by
+    get_Vignetting_Factor (linear scan of the grid). */
+static float ref_interpol_vign_theta(const float theta, const float* arr_theta,
+				     float** arr_vign, const int ntheta){
+	if (theta>=arr_theta[ntheta-1]) {
+		return(arr_vign[ntheta-1][0]);
+	}
+	int jj;
+	for(jj=1; jj<ntheta; jj++) {
+		if (arr_theta[jj]>=theta) {
+			return(arr_vign[jj-1][0]+
+					(arr_vign[jj][0]-arr_vign[jj-1][0])*
+					(theta-arr_theta[jj-1])/(arr_theta[jj]-arr_theta[jj-1]));
+		}
+	}
+	return 1.;
+}
+
+static float ref_get_Vignetting_Factor(const Vignetting* const vi,
+				       const float energy, const float theta){
+	if (energy<=vi->Emin){
+		return ref_interpol_vign_theta(theta, vi->theta, vi->vignet[0], vi->ntheta);
+	}
+	if (energy>=vi->Emax){
+		return ref_interpol_vign_theta(theta, vi->theta, vi->vignet[vi->nenergies-1], vi->ntheta);
+	}
+	int ind = binary_search_float(energy,vi->energy,vi->nenergies );
+	double vign_val[2];
+	vign_val[0] = ref_interpol_vign_theta(theta, vi->theta, vi->vignet[ind], vi->ntheta);
+	vign_val[1] = ref_interpol_vign_theta(theta, vi->theta, vi->vignet[ind+1], vi->ntheta);
+	double ifac = (energy-vi->energy[ind]) / ( vi->energy[ind+1] - vi->energy[ind] );
+	return interp_lin_1d(ifac, vign_val[0], vign_val[1]);
+}
+
+/** Vignetting function on a (non-uniform) grid of the given size. */
+static Vignetting* vign_synthetic(const int nenergies, const int ntheta, int* status){
+	Vignetting* vi = (Vignetting*)calloc(1, sizeof(Vignetting));
+	assert_non_null(vi);
+	vi->nenergies = nenergies;
+	vi->ntheta = ntheta;
+	vi->nphi = 1;
+	vi->energy = (float*)malloc(nenergies*sizeof(float));
+	vi->theta = (float*)malloc(ntheta*sizeof(float));
+	vi->phi = (float*)calloc(1, sizeof(float));
+	vi->vignet = (float***)malloc(nenergies*sizeof(float**));
+	for (int ii=0; ii<nenergies; ii++){
+		vi->energy[ii] = 0.2+0.1*ii+0.002*ii*ii;
+		vi->vignet[ii] = (float**)malloc(ntheta*sizeof(float*));
+		for (int jj=0; jj<ntheta; jj++){
+			vi->vignet[ii][jj] = (float*)malloc(sizeof(float));
+			vi->vignet[ii][jj][0] = exp(-jj*(1.+0.01*ii)/ntheta);
+		}
+	}
+	for (int jj=0; jj<ntheta; jj++){
+		vi->theta[jj] = (jj+0.3*jj*jj/ntheta)/60./180.*M_PI;
+	}
+	vi->Emin = vi->energy[0];
+	vi->Emax = vi->energy[nenergies-1];
+	setVignettingLookup(vi, status);
+	return vi;
+}
+
+/** Random energies and off-axis angles, including the grid points
+    and values outside the grids. */
+static void random_photons(const Vignetting* const vi, const long n,
+			   float* energy, float* theta){
+	srand(1);
+	for (long ii=0; ii<n; ii++){
+		float emax = vi->Emax*1.2, thmax = vi->theta[vi->ntheta-1]*1.2;
+		energy[ii] = (rand()/(float)RAND_MAX)*emax;
+		theta[ii] = (rand()/(float)RAND_MAX)*thmax;
+		if (ii%7==0) energy[ii] = vi->energy[rand()%vi->nenergies];
+		if (ii%5==0) theta[ii] = vi->theta[rand()%vi->ntheta];
+	}
+}
+
+static void check_vign_equivalence(const Vignetting* const vi){
+	const long n = 100000;
+	float* energy = (float*)malloc(n*sizeof(float));
+	float* theta = (float*)malloc(n*sizeof(float));
+	float* factor = (float*)malloc(n*sizeof(float));
+	random_photons(vi, n, energy, theta);
+
+	get_Vignetting_Factors(vi, n, energy, theta, NULL, factor);
+	for (long ii=0; ii<n; ii++){
+		float ref = ref_get_Vignetting_Factor(vi, energy[ii], theta[ii]);
+		assert_true(get_Vignetting_Factor(vi, energy[ii], theta[ii], 0.)==ref);
+		assert_true(factor[ii]==ref);
+	}
+
+	free(energy);
+	free(theta);
+	free(factor);
+}
+
+void test_vign_lookup(){
+
+	int status = EXIT_SUCCESS;
+
+	Vignetting* vi = vign_load(&status);
+	check_vign_equivalence(vi);
+	destroyVignetting(&vi);
+
+	const int sizes[][2] = {{1,1}, {2,2}, {30,50}, {200,1000}};
+	for (unsigned int kk=0; kk<sizeof(sizes)/sizeof(sizes[0]); kk++){
+		vi = vign_synthetic(sizes[kk][0], sizes[kk][1], &status);
+		assert_int_equal(status,EXIT_SUCCESS);
+		check_vign_equivalence(vi);
+		destroyVignetting(&vi);
+	}
+}
+
+#ifdef SIXT_BENCHMARK
+/** Reports the throughput (photons/s) of the original interpolation
+    and of the lookup against the grid size. */
+void benchmark_vign(){
+
+	int status = EXIT_SUCCESS;
+	const long n = 1000000;
+	float* energy = (float*)malloc(n*sizeof(float));
+	float* theta = (float*)malloc(n*sizeof(float));
+	float* factor = (float*)malloc(n*sizeof(float));
+
+	const int sizes[][2] = {{10,20}, {50,200}, {200,1000}};
+	for (unsigned int kk=0; kk<sizeof(sizes)/sizeof(sizes[0]); kk++){
+		Vignetting* vi = vign_synthetic(sizes[kk][0], sizes[kk][1], &status);
+		assert_int_equal(status,EXIT_SUCCESS);
+		random_photons(vi, n, energy, theta);
+
+		clock_t start = clock();
+		for (long ii=0; ii<n; ii++){
+			factor[ii] = ref_get_Vignetting_Factor(vi, energy[ii], theta[ii]);
+		}
+		double t_ref = (double)(clock()-start)/CLOCKS_PER_SEC;
+
+		start = clock();
+		get_Vignetting_Factors(vi, n, energy, theta, NULL, factor);
+		double t_lut = (double)(clock()-start)/CLOCKS_PER_SEC;
+
+		printf("# %3d energies x %4d angles: interpolation %.3g photons/s, "
+		       "lookup %.3g photons/s\n", sizes[kk][0], sizes[kk][1],
+		       n/fmax(t_ref,1e-9), n/fmax(t_lut,1e-9));
+		destroyVignetting(&vi);
+	}
+
+	free(energy);
+	free(theta);
+	free(factor);
+}
+#endif
+
 int main(void)
 {
   
   const struct CMUnitTest tests[] = {
     cmocka_unit_test(test_vign_load),
-	cmocka_unit_test(test_vign_check_dimensions),
-	cmocka_unit_test(test_print_values),
-	cmocka_unit_test(test_get_vign_factor)
+    cmocka_unit_test(test_vign_check_dimensions),
+    cmocka_unit_test(test_print_values),
+    cmocka_unit_test(test_get_vign_factor),
+    cmocka_unit_test(test_vign_lookup),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_vign),
+#endif
   };
 
   cmocka_set_message_output(CM_OUTPUT_TAP);
@@ -0,0 +1,296 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <time.h>
+
+#include "visibility.h"
+
+
+/** Survey attitude similar to the one of eROSITA: the telescope scans
+    a great circle with a period of 4 hours, whose pole moves by 1
+    degree per day. The attitude has one entry per second. */
+#define SCAN_PERIOD (14400.)
+#define POLE_DRIFT (M_PI/180./86400.)
+#define DURATION (14400.)
+
+/** Radius of the visibility range ([rad]). */
+#define RADIUS (0.51*M_PI/180.)
+
+static Attitude* survey_attitude(){
+  int status=EXIT_SUCCESS;
+  Attitude* ac=getAttitude(&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  ac->nentries=(long)DURATION+1;
+  ac->entry=(AttitudeEntry*)malloc(ac->nentries*sizeof(AttitudeEntry));
+  assert_non_null(ac->entry);
+  long ii;
+  for (ii=0; ii<ac->nentries; ii++){
+    double t=(double)ii;
+    double lambda=t*POLE_DRIFT;
+    double phi=2.*M_PI*t/SCAN_PERIOD;
+    // Pole in the x-y plane, scan in the plane through the z-axis.
+    Vector u={.x=-sin(lambda), .y=cos(lambda), .z=0.};
+    Vector v={.x=0., .y=0., .z=1.};
+    ac->entry[ii]=initializeAttitudeEntry();
+    ac->entry[ii].time=t;
+    ac->entry[ii].nz=vector_add(scale_vector(u,cos(phi)),scale_vector(v,sin(phi)));
+  }
+  ac->tstart=0.;
+  ac->tstop=DURATION;
+  return(ac);
+}
+
+/** Random direction within the given angle of the scanned great
+    circle, at right ascensions of the first half of the scan. */
+static Vector random_source(double width){
+  double phi=(rand()%100000)/100000.*M_PI;
+  double offset=((rand()%100000)/50000.-1.)*width;
+  Vector u={.x=0., .y=1., .z=0.};
+  Vector v={.x=0., .y=0., .z=1.};
+  Vector w={.x=1., .y=0., .z=0.};
+  return(normalize_vector(vector_add(vector_add(scale_vector(u,cos(phi)),
+						scale_vector(v,sin(phi))),
+				     scale_vector(w,sin(offset)))));
+}
+
+/** The index finds the same directions as a comparison with all
+    directions, also around the poles and at ra=0. */
+static void test_sky_index(){
+  int status=EXIT_SUCCESS;
+  const long ndirs=20000;
+  Vector* dir=(Vector*)malloc(ndirs*sizeof(Vector));
+  long* list=(long*)malloc(ndirs*sizeof(long));
+  char* found=(char*)malloc(ndirs);
+  assert_true(NULL!=dir && NULL!=list && NULL!=found);
+  srand(1);
+  long ii;
+  for (ii=0; ii<ndirs; ii++){
+    double z=(rand()%100001)/50000.-1.;
+    double ra=(rand()%100000)/100000.*2.*M_PI;
+    dir[ii]=unit_vector(ra,asin(z));
+  }
+  SkyIndex* idx=newSkyIndex(dir,ndirs,0.02,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+
+  double decs[]={-M_PI/2., -1.3, -0.2, 0., 0.7, 1.5, M_PI/2.};
+  double ras[]={0., 0.001, 3., 2.*M_PI-0.001};
+  double radii[]={0.001, 0.02, 0.1, 1., 3.};
+  unsigned int id, ir, irad;
+  for (id=0; id<sizeof(decs)/sizeof(decs[0]); id++){
+    for (ir=0; ir<sizeof(ras)/sizeof(ras[0]); ir++){
+      for (irad=0; irad<sizeof(radii)/sizeof(radii[0]); irad++){
+	Vector ref=unit_vector(ras[ir],decs[id]);
+	long nfound=querySkyIndex(idx,&ref,radii[irad],list);
+	memset(found,0,ndirs);
+	for (ii=0; ii<nfound; ii++){
+	  assert_int_equal(found[list[ii]],0);
+	  found[list[ii]]=1;
+	}
+	for (ii=0; ii<ndirs; ii++){
+	  int inside=(scalar_product(&dir[ii],&ref)>=cos(radii[irad]));
+	  assert_int_equal(found[ii],inside);
+	}
+      }
+    }
+  }
+
+  freeSkyIndex(&idx);
+  assert_null(idx);
+  free(dir);
+  free(list);
+  free(found);
+}
+
+/** Visibility intervals determined by stepping through the attitude
+    in steps of dt for each source, as done by ero_vis for a single
+    search cone. An interval starts at the first step, where the
+    source is visible, and ends at the first step, where it is not
+    visible any more. */
+static GTI** stepped_gtis(Attitude* ac, const Vector* dir, long ndirs,
+			  double dt){
+  int status=EXIT_SUCCESS;
+  GTI** gtis=(GTI**)malloc(ndirs*sizeof(GTI*));
+  char* visible=(char*)calloc(ndirs,1);
+  double* start=(double*)malloc(ndirs*sizeof(double));
+  assert_true(NULL!=gtis && NULL!=visible && NULL!=start);
+  long ii;
+  for (ii=0; ii<ndirs; ii++){
+    gtis[ii]=newGTI(&status);
+  }
+  const double min_align=cos(RADIUS);
+  long step;
+  for (step=0; step*dt<DURATION; step++){
+    double t=step*dt;
+    Vector nz=getTelescopeNz(ac,t,&status);
+    for (ii=0; ii<ndirs; ii++){
+      int inside=(scalar_product(&dir[ii],&nz)>=min_align);
+      if (inside && !visible[ii]){
+	start[ii]=t;
+      } else if (!inside && visible[ii]){
+	appendGTI(gtis[ii],start[ii],t,&status);
+      }
+      visible[ii]=inside;
+    }
+  }
+  for (ii=0; ii<ndirs; ii++){
+    if (visible[ii]){
+      appendGTI(gtis[ii],start[ii],DURATION,&status);
+    }
+  }
+  assert_int_equal(status,EXIT_SUCCESS);
+  free(visible);
+  free(start);
+  return(gtis);
+}
+
+/** Maximum difference of the interval boundaries. The intervals must
+    match one by one. */
+static double max_edge_error(GTI** a, GTI** b, long ndirs){
+  double error=0.;
+  long ii;
+  for (ii=0; ii<ndirs; ii++){
+    assert_int_equal(a[ii]->ngti,b[ii]->ngti);
+    int jj;
+    for (jj=0; jj<a[ii]->ngti; jj++){
+      error=MAX(error,fabs(a[ii]->start[jj]-b[ii]->start[jj]));
+      error=MAX(error,fabs(a[ii]->stop[jj]-b[ii]->stop[jj]));
+    }
+  }
+  return(error);
+}
+
+/** The intervals agree with a reference obtained by fine stepping,
+    also for coarse steps and sources that are visible only for a
+    short time close to the boundary of the visibility range. */
+static void test_visibility_edges(){
+  int status=EXIT_SUCCESS;
+  Attitude* ac=survey_attitude();
+  const long ndirs=200;
+  const double dt_ref=0.01;
+  Vector* dir=(Vector*)malloc(ndirs*sizeof(Vector));
+  double* radius=(double*)malloc(ndirs*sizeof(double));
+  assert_true(NULL!=dir && NULL!=radius);
+  srand(2);
+  long ii;
+  for (ii=0; ii<ndirs; ii++){
+    dir[ii]=random_source(RADIUS*1.1);
+    radius[ii]=RADIUS;
+  }
+  GTI** ref=stepped_gtis(ac,dir,ndirs,dt_ref);
+  long nvisible=0;
+  for (ii=0; ii<ndirs; ii++){
+    if (ref[ii]->ngti>0) nvisible++;
+  }
+  assert_true(nvisible>ndirs/2);
+
+  double dts[]={1., 30., 600.};
+  unsigned int kk;
+  for (kk=0; kk<sizeof(dts)/sizeof(dts[0]); kk++){
+    GTI** gtis=getVisibilityGTIs(ac,dir,radius,ndirs,0.,DURATION,dts[kk],
+				 1.e-4,&status);
+    assert_int_equal(status,EXIT_SUCCESS);
+    double error=max_edge_error(gtis,ref,ndirs);
+    assert_true(error<=dt_ref+1.e-4);
+    printf("# dt=%.0fs: max. deviation of GTI boundaries from reference "
+	   "(dt=%.2fs) %.3gs\n", dts[kk], dt_ref, error);
+    freeVisibilityGTIs(&gtis,ndirs);
+    assert_null(gtis);
+  }
+
+  // Stepping in steps of 1s as before.
+  GTI** stepped=stepped_gtis(ac,dir,ndirs,1.);
+  printf("# stepping with dt=1s: max. deviation %.3gs\n",
+	 max_edge_error(stepped,ref,ndirs));
+  freeVisibilityGTIs(&stepped,ndirs);
+
+  freeVisibilityGTIs(&ref,ndirs);
+  free(dir);
+  free(radius);
+  freeAttitude(&ac);
+}
+
+/** A pointed observation. */
+static void test_visibility_pointing(){
+  int status=EXIT_SUCCESS;
+  Attitude* ac=getPointingAttitude(0.,0.,100.,0.5,0.2,0.,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  Vector dir[2]={unit_vector(0.5,0.2+0.5*RADIUS),unit_vector(0.5,0.2+2.*RADIUS)};
+  double radius[2]={RADIUS,RADIUS};
+  GTI** gtis=getVisibilityGTIs(ac,dir,radius,2,10.,60.,1.,1.e-3,&status);
+  assert_int_equal(status,EXIT_SUCCESS);
+  assert_int_equal(gtis[0]->ngti,1);
+  assert_true(gtis[0]->start[0]==10.);
+  assert_true(gtis[0]->stop[0]==60.);
+  assert_int_equal(gtis[1]->ngti,0);
+  freeVisibilityGTIs(&gtis,2);
+  freeAttitude(&ac);
+}
+
+#ifdef SIXT_BENCHMARK
+/** Reports the time needed to determine the visibility intervals for
+    catalogs of different size at once and by stepping through the
+    attitude for each source separately (dt=1s, extrapolated from
+    the first 100 sources). */
+static void benchmark_visibility(){
+  int status=EXIT_SUCCESS;
+  Attitude* ac=survey_attitude();
+  long sizes[]={100, 1000, 10000, 100000};
+  unsigned int kk;
+  for (kk=0; kk<sizeof(sizes)/sizeof(sizes[0]); kk++){
+    const long ndirs=sizes[kk];
+    Vector* dir=(Vector*)malloc(ndirs*sizeof(Vector));
+    double* radius=(double*)malloc(ndirs*sizeof(double));
+    assert_true(NULL!=dir && NULL!=radius);
+    srand(3);
+    long ii;
+    for (ii=0; ii<ndirs; ii++){
+      dir[ii]=random_source(5.*RADIUS);
+      radius[ii]=RADIUS;
+    }
+
+    clock_t start=clock();
+    GTI** gtis=getVisibilityGTIs(ac,dir,radius,ndirs,0.,DURATION,1.,1.e-3,
+				 &status);
+    double t_catalog=(double)(clock()-start)/CLOCKS_PER_SEC;
+    assert_int_equal(status,EXIT_SUCCESS);
+    freeVisibilityGTIs(&gtis,ndirs);
+
+    const long nstepped=MIN(ndirs,100);
+    start=clock();
+    long jj;
+    for (jj=0; jj<nstepped; jj++){
+      GTI** stepped=stepped_gtis(ac,&dir[jj],1,1.);
+      freeVisibilityGTIs(&stepped,1);
+    }
+    double t_stepped=(double)(clock()-start)/CLOCKS_PER_SEC*ndirs/nstepped;
+
+    printf("# %6ld sources: catalog %.3fs, stepping per source %.2fs\n",
+	   ndirs, t_catalog, t_stepped);
+
+    free(dir);
+    free(radius);
+  }
+  freeAttitude(&ac);
+}
+#endif
+
+
+int main(void)
+{
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_sky_index),
+    cmocka_unit_test(test_visibility_edges),
+    cmocka_unit_test(test_visibility_pointing),
+#ifdef SIXT_BENCHMARK
+    cmocka_unit_test(benchmark_visibility),
+#endif
+
+  };
+
+  cmocka_set_message_output(CM_OUTPUT_TAP);
+
+  return cmocka_run_group_tests_name("Default",tests,NULL,NULL);
+}
@@ -44,6 +44,7 @@ int comabackpro_main() {
   ProjectedMask* proj_mask=NULL;
   ProjectedMask* proj_mask_repix=NULL;
   SourceImage* sky_chart=NULL;
+  SourceImage* det_hist=NULL; //histogram of the events in the detector plane
   //SkyImage* sky_image=NULL;
   CoMaEvent* event=NULL;
   //Attitude* ac=NULL;
@@ -55,7 +56,7 @@ int comabackpro_main() {
 
   int status=EXIT_SUCCESS; // Error status.
 
-  int ii,jj;//kk,ll;   //counts
+  //int ii,jj,kk,ll;   //counts
   int Size1, Size2;  //Sizes of ProjectedMask in pixels
   int Size1_RePix, Size2_RePix;  //Sizes of re-pixeled ProjectedMask in pixels
   //int lastEvent=0;
@@ -408,50 +409,55 @@ int comabackpro_main() {
       /*   do{ //search for sources as long as pixval is above certain value
       //run as long as threshold==1*/
 
-      float count=1.;
-      while (0==EventListEOF(&eventfile->generic)) {
-	// printf("%lf\n%",count/eventfile->generic.nrows*100.);
-	/*	for(kk=0; kk<ea->naxis1; kk++){
-		for(ll=0; ll<ea->naxis2; ll++){*/
-
-	    //add projected mask(pm) correctly to SkyChart for current photon/event
-	    //since pm-/SkyChart-pixels fit without reminder into detector-pixels:
-	    //detpix=(pixel of event)*(amount of smaller pixels within one detector pixels)
-	    //+1 -> (int) rounds down;
-	    int detpix_x=(event->rawx)*(int)(detector_pixels->xpixelwidth/RePixValue+1);
-	    int detpix_y=(event->rawy)*(int)(detector_pixels->ypixelwidth/RePixValue+1);
-
-	    //scanning all projected mask pixels to fill in
-	    //skyChart (still pix-values)
-
-	    for(ii=0; ii<proj_mask_repix->naxis1; ii++){
-	      for(jj=0; jj<proj_mask_repix->naxis2; jj++){
-
-		int shift_ii=proj_mask_repix->naxis1-1-ii;
-		int shift_jj=proj_mask_repix->naxis2-1-jj;
+      //bin all events into a detector-plane histogram (in units of
+      //charge), such that the projected mask has to be correlated
+      //only once with the whole histogram instead of being added for
+      //every single event
+      struct SourceImageParameters hip = {
+	.naxis1 = detector_pixels->xwidth,
+	.naxis2 = detector_pixels->ywidth,
+	.crpix1 = 0.,
+	.crpix2 = 0.,
+	.cdelt1 = atan(detector_pixels->xpixelwidth/distance), //in rad
+	.cdelt2 = atan(detector_pixels->ypixelwidth/distance),
+	.crval1 = ra*M_PI/180., //in rad
+	.crval2 = dec*M_PI/180.
+      };
+      det_hist=getEmptySourceImage(&hip, &status);
+      CHECK_STATUS_BREAK(status);
 
-		sky_chart->pixel[shift_ii+detpix_x][shift_jj+detpix_y]+=event->charge/proj_mask_repix->OpenPixels
-		  *proj_mask_repix->map[ii][jj];
-	      }
-	    }
+      while (0==EventListEOF(&eventfile->generic)) {
+	if ((event->rawx<0)||(event->rawx>=det_hist->naxis1)||
+	    (event->rawy<0)||(event->rawy>=det_hist->naxis2)) {
+	  SIXT_ERROR("event lies outside the detector");
+	  status=EXIT_FAILURE;
+	  break;
+	}
+	det_hist->pixel[event->rawx][event->rawy]+=event->charge;
 
-	    status=CoMaEventFile_getNextRow(eventfile, event);
-	    count++;
+	status=CoMaEventFile_getNextRow(eventfile, event);
       }
+      CHECK_STATUS_BREAK(status);
 
-	    /*	  }
-		  }*/
-
+      //add projected mask(pm) correctly to SkyChart for all events:
+      //since pm-/SkyChart-pixels fit without reminder into detector-pixels:
+      //detpix=(pixel of event)*(amount of smaller pixels within one detector pixels)
+      //+1 -> (int) rounds down;
+      backprojectDetHistogram(proj_mask_repix, det_hist->pixel,
+			      det_hist->naxis1, det_hist->naxis2,
+			      (int)(detector_pixels->xpixelwidth/RePixValue+1),
+			      (int)(detector_pixels->ypixelwidth/RePixValue+1),
+			      sky_chart, &status);
+      CHECK_STATUS_BREAK(status);
 
-	//for testing:
-	char name_image[MAXFILENAME];
-	//sprintf(name_image,"skyImg_%lf.fits", position_list->entryCount);
+      if (0!=par.Debug) {
+	saveSourceImage(det_hist, "detHistogram.fits", &status);
+	CHECK_STATUS_BREAK(status);
+      }
 
 	// Write the reconstructed source function to the output FITS file.
-	//  if(position_list->entryCount <=4){
-	  saveSourceImage(sky_chart, name_image, &status);
-	  CHECK_STATUS_BREAK(status);
-	  //	}
+	saveSourceImage(sky_chart, par.Image, &status);
+	CHECK_STATUS_BREAK(status);
 
 	do{ //search for sources as long as pixval is above certain value
 	//run as long as threshold==1
@@ -561,7 +567,7 @@ int comabackpro_main() {
 	    if(lastEvent == 1){break;}
 	  }//END of current 'constant'-interval
 
-	  saveSourceImage(sky_chart,"skyChart.fits", &status);
+	  if (0!=par.Debug) saveSourceImage(sky_chart,"skyChart.fits", &status);
 
 	  //TODO: fill in skyChart at corresponding position in skyImg
 	  for(ii=0; ii<sky_chart->naxis1; ii++){
@@ -596,7 +602,7 @@ int comabackpro_main() {
 	    }
 	  }
 
-	  saveSkyImage(sky_image,"SkyImg.fits",&status);
+	  if (0!=par.Debug) saveSkyImage(sky_image,"SkyImg.fits",&status);
 
 	  //get pointing inbetween (approximation), increase 'timeInterval'
 	  telescope.nz=getTelescopeNz(ac,event->time,&status);
@@ -648,6 +654,7 @@ int comabackpro_main() {
     headas_chat(5, "cleaning up ...\n");
 
    // Free the detector and sky image pixels.
+   if (NULL!=det_hist) free_SourceImage(det_hist);
    destroySquarePixels(&detector_pixels);
    destroyCodedMask(&mask);
 
@@ -742,6 +749,11 @@ int comabackpro_getpar(struct Parameters* par)
     SIXT_ERROR("failed reading value of Sigma");
   }
 
+  //Read the debug flag.
+  else if ((status=PILGetBool("Debug", &par->Debug))) {
+    SIXT_ERROR("failed reading the debug flag");
+  }
+
   CHECK_STATUS_RET(status, status);
 
   return(status);
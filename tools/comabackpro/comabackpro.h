@@ -72,6 +72,9 @@ struct Parameters {
 
   /**threshold for sources, factor to mulpilpy sigma with. */
   double Sigma;
+
+  /** Write intermediate images for debugging. */
+  int Debug;
 };
 
 
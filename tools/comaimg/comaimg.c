@@ -219,8 +219,8 @@ int comaimg_main() {
       //Determine unit vector in photon-direction
       Vector phodir=normalize_vector(unit_vector(photon.ra,photon.dec));
 
-      //Determine current telescope pointing direction.
-      telescope.nz=getTelescopeNz(ac,photon.time,&status);
+      //Determine current telescope pointing direction and axes.
+      getTelescopeFrame(ac,&telescope.nx,&telescope.ny,&telescope.nz,photon.time,&status);
       CHECK_STATUS_BREAK(status);
 
       //Check whether photon is inside FOV:
@@ -228,8 +228,6 @@ int comaimg_main() {
       if (check_fov(&phodir,&telescope.nz,fov_min_align)==0){
 	//Photon is inside fov
 
-	getTelescopeAxes(ac,&telescope.nx,&telescope.ny,&telescope.nz,photon.time,&status);
-
 	if (0!=strcmp(att_buffer, "NONE")){ //attitude-file is used
 	  //set wcs according to new pointing (attitude could have changed)
 	  setWCScurrentPointing(par.Attitude,ac,&telescope.nz,&wcs,&status);
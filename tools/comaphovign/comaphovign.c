@@ -225,7 +225,8 @@ int comaphovign_main() {
 
       // Apply the vignetting.
       // Compare the photon direction to the direction of the telescope axis.
-      Vector nz=getTelescopeNz(ac, photon.time, &status);
+      Vector nz;
+      getTelescopeFrame(ac, NULL, NULL, &nz, photon.time, &status);
       CHECK_STATUS_BREAK(status);
       Vector phodir=unit_vector(photon.ra, photon.dec);
 
@@ -52,7 +52,7 @@ int comarecon_main() {
   fftw_complex* fftReconArray=NULL;
   fftw_complex* fftEventArray=NULL;
   fftw_complex* Multiply = NULL;
-  fftw_complex* fftInvMultiply=NULL;
+  double* fftInvMultiply=NULL;
 
   int status=EXIT_SUCCESS; // Error status.
 
@@ -72,6 +72,10 @@ int comarecon_main() {
     // Read the program parameters using the PIL library.
     if ((status=comarecon_getpar(&par))) break;
 
+    // Set up the re-usable FFT plans.
+    initFFTPlans(par.FFTWisdom, par.FFTThreads, &status);
+    CHECK_STATUS_BREAK(status);
+
     // Open the event file.
     eventfile=openCoMaEventFile(par.EventList, READONLY, &status);
     CHECK_STATUS_BREAK(status);
@@ -277,7 +281,8 @@ int comarecon_main() {
        ReconImage1d=SaveReconArray1d(recon, &status);
 
        //perform a fft with the ReconArray
-       fftReconArray=FFTOfArray_1d(ReconImage1d, Size1, Size2, -1);
+       fftReconArray=FFTOfArray_r2c(ReconImage1d, Size1, Size2, &status);
+       CHECK_STATUS_BREAK(status);
 
        //get repixeled mask from ReconArray, which is needed later for building the mask shadow during IROS
        //basic constructor for both,the whole re-pixeled mask&/shadow element
@@ -297,27 +302,30 @@ int comarecon_main() {
 	 }
 
 	 //perform a fft with the EventArray
-	 fftEventArray=FFTOfArray_1d(EventImage1d, Size1, Size2, -1);
+	 fftEventArray=FFTOfArray_r2c(EventImage1d, Size1, Size2, &status);
+	 CHECK_STATUS_BREAK(status);
 
        //multiply fftEventArray with komplex conjugate of fftReconArray
        //Re-part: E(Re)*R(Re)+E(Im)*R(Im); Im-part: E(Re)*R(Im)-E(Im)*R(Re)
-       Multiply=(fftw_complex*) fftw_malloc(sizeof(fftw_complex)*(Size1*Size2));
-       for(ii=0; ii<Size1; ii++){
-	 for(jj=0; jj<Size2; jj++){
-	   Multiply[ii+Size1*jj][0]=fftEventArray[ii+Size1*jj][0]*fftReconArray[ii+Size1*jj][0]
-	     +fftEventArray[ii+Size1*jj][1]*(fftReconArray[ii+Size1*jj][1]);
-	   Multiply[ii+Size1*jj][1]=-fftEventArray[ii+Size1*jj][0]*(fftReconArray[ii+Size1*jj][1])
-	     +fftEventArray[ii+Size1*jj][1]*fftReconArray[ii+Size1*jj][0];
-	 }
+       //(both arrays are real, so only the non-redundant half is needed)
+       long nfft=(long)Size1*(Size2/2+1);
+       long kk;
+       Multiply=(fftw_complex*) fftw_malloc(sizeof(fftw_complex)*nfft);
+       for(kk=0; kk<nfft; kk++){
+	 Multiply[kk][0]=fftEventArray[kk][0]*fftReconArray[kk][0]
+	   +fftEventArray[kk][1]*(fftReconArray[kk][1]);
+	 Multiply[kk][1]=-fftEventArray[kk][0]*(fftReconArray[kk][1])
+	   +fftEventArray[kk][1]*fftReconArray[kk][0];
        }
 
-       //Inverse FFT of Multilpy which already is of type fftw_complex
-       fftInvMultiply=FFTOfArray(Multiply, Size1, Size2, +1);
+       //Inverse FFT of Multilpy, which is real-valued
+       fftInvMultiply=FFTOfArray_c2r(Multiply, Size1, Size2, &status);
+       CHECK_STATUS_BREAK(status);
 
-       //save real part of inverse fft in sky image
+       //save inverse fft in sky image
        for(ii=0; ii<Size1; ii++){
 	 for(jj=0; jj<Size2; jj++){
-	   sky_pixels->pixel[ii][jj]=fftInvMultiply[ii+Size1*jj][0]/(Size1*Size2);
+	   sky_pixels->pixel[ii][jj]=fftInvMultiply[ii+Size1*jj]/(Size1*Size2);
 	 }
        }
 
@@ -388,6 +396,9 @@ int comarecon_main() {
   free_SourceImage(sky_pixels);
   } while(0);  // END of the error handling loop.
 
+  // Release the FFT plans. The wisdom is only stored after a successful run.
+  freeFFTPlans((EXIT_SUCCESS==status) ? par.FFTWisdom : NULL, &status);
+
   // Close the FITS files.
   status=closeCoMaEventFile(eventfile);
   free(eventfile);
@@ -470,6 +481,16 @@ int comarecon_getpar(struct Parameters* par)
   else if ((status=PILGetReal("Sigma", &par->Sigma))) {
     SIXT_ERROR("failed reading value of Sigma");
   }
+
+  //Read the FFTW wisdom file.
+  else if ((status=PILGetFname("FFTWisdom", par->FFTWisdom))) {
+    SIXT_ERROR("failed reading the name of the FFTW wisdom file");
+  }
+
+  //Read the number of FFT threads.
+  else if ((status=PILGetInt("FFTThreads", &par->FFTThreads))) {
+    SIXT_ERROR("failed reading the number of FFT threads");
+  }
   CHECK_STATUS_RET(status, status);
 
   return(status);
@@ -74,6 +74,11 @@ struct Parameters {
 
   /**threshold for sources, factor to mulpilpy sigma with. */
   double Sigma;
+
+  /** File for FFTW wisdom ('none' to switch off). */
+  char FFTWisdom[MAXFILENAME];
+  /** Number of threads used for the FFTs. */
+  int FFTThreads;
 };
 
 
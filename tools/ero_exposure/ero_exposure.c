@@ -371,7 +371,8 @@ int ero_exposure_main()
       // END of saving an interim map.
 
       // Determine the telescope pointing direction at the current time.
-      Vector telescope_nz=getTelescopeNz(ac, time, &status);
+      Vector telescope_nz;
+      getTelescopeFrame(ac, NULL, NULL, &telescope_nz, time, &status);
       CHECK_STATUS_BREAK(status);
 
       // Calculate the RA and DEC of the pointing direction.
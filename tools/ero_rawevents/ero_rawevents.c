@@ -23,6 +23,69 @@
 #include "ero_rawevents.h"
 
 
+/** EventTransformFct appending a block of events to the eROSITA
+    event file. */
+static void writeRawEvents(EventFile* const file, const long firstrow,
+			   Event* const events, const long nevents,
+			   void* const data, int* const status)
+{
+  (void)file;
+  RawEventsOutput* output=(RawEventsOutput*)data;
+  fitsfile* fptr=output->fptr;
+
+  fits_insert_rows(fptr, firstrow-1, nevents, status);
+  CHECK_STATUS_VOID(*status);
+
+  long* lbuffer=(long*)malloc(nevents*sizeof(long));
+  int* ibuffer=(int*)malloc(nevents*sizeof(int));
+  if ((NULL==lbuffer)||(NULL==ibuffer)) {
+    free(lbuffer);
+    free(ibuffer);
+    SIXT_ERROR("memory allocation failed");
+    *status=EXIT_FAILURE;
+    return;
+  }
+
+  // Separate the time value into ots (on-board second clock)
+  // and fracsec (subsecond clock) integer values.
+  long ii;
+  for (ii=0; ii<nevents; ii++) {
+    lbuffer[ii]=(long)events[ii].time;
+  }
+  fits_write_col(fptr, TLONG, output->cots, firstrow, 1, nevents,
+		 lbuffer, status);
+  for (ii=0; ii<nevents; ii++) {
+    long ots=(long)events[ii].time;
+    lbuffer[ii]=(long)((events[ii].time-ots)*1.e6); // [micro seconds]
+  }
+  fits_write_col(fptr, TLONG, output->cfracsec, firstrow, 1, nevents,
+		 lbuffer, status);
+  for (ii=0; ii<nevents; ii++) {
+    lbuffer[ii]=events[ii].frame;
+  }
+  fits_write_col(fptr, TLONG, output->cframe, firstrow, 1, nevents,
+		 lbuffer, status);
+  for (ii=0; ii<nevents; ii++) {
+    lbuffer[ii]=events[ii].pha;
+  }
+  fits_write_col(fptr, TLONG, output->cpha, firstrow, 1, nevents,
+		 lbuffer, status);
+  for (ii=0; ii<nevents; ii++) {
+    ibuffer[ii]=events[ii].rawx+1;
+  }
+  fits_write_col(fptr, TINT, output->crawx, firstrow, 1, nevents,
+		 ibuffer, status);
+  for (ii=0; ii<nevents; ii++) {
+    ibuffer[ii]=events[ii].rawy+1;
+  }
+  fits_write_col(fptr, TINT, output->crawy, firstrow, 1, nevents,
+		 ibuffer, status);
+
+  free(lbuffer);
+  free(ibuffer);
+}
+
+
 int ero_rawevents_main()
 {
   // Containing all programm parameters read by PIL
@@ -261,37 +324,19 @@ int ero_rawevents_main()
 
     headas_chat(3, "start copy process ...\n");
 
-    // Loop over all events in the input file.
-    long row;
-    for (row=0; row<elf->nrows; row++) {
-
-      // Read the next event from the input file.
-      Event event;
-      getEventFromFile(elf, row+1, &event, &status);
-      CHECK_STATUS_BREAK(status);
-
-      // Store it in the output file.
-      fits_insert_rows(fptr, row, 1, &status);
-      CHECK_STATUS_BREAK(status);
-
-      // Separate the time value into ots (on-board second clock)
-      // and fracsec (subsecond clock) integer values.
-      long ots=(long)event.time;
-      long fracsec=(long)((event.time-ots)*1.e6); // [micro seconds]
-
-      fits_write_col(fptr, TLONG, cots, row+1, 1, 1, &ots, &status);
-      fits_write_col(fptr, TLONG, cfracsec, row+1, 1, 1, &fracsec, &status);
-      fits_write_col(fptr, TLONG, cframe, row+1, 1, 1, &event.frame, &status);
-      fits_write_col(fptr, TLONG, cpha, row+1, 1, 1, &event.pha, &status);
-      int rawx=event.rawx+1;
-      fits_write_col(fptr, TINT, crawx, row+1, 1, 1, &rawx, &status);
-      int rawy=event.rawy+1;
-      fits_write_col(fptr, TINT, crawy, row+1, 1, 1, &rawy, &status);
-
-      CHECK_STATUS_BREAK(status);
-    }
+    // Convert all events in the input file in blocks, reading only
+    // the required columns.
+    RawEventsOutput output={ .fptr=fptr, .cots=cots, .cfracsec=cfracsec,
+			     .cframe=cframe, .crawx=crawx, .crawy=crawy,
+			     .cpha=cpha };
+    EventTransform transform={ .fct=writeRawEvents, .freedata=NULL,
+			       .data=&output,
+			       .incols=EVENTCOL_TIME|EVENTCOL_FRAME|EVENTCOL_PHA|
+			       EVENTCOL_RAWX|EVENTCOL_RAWY,
+			       .outcols=0 };
+    EventTransform* transforms[]={ &transform };
+    runEventTransforms(elf, transforms, 1, &status);
     CHECK_STATUS_BREAK(status);
-    // END of loop over all events in the input file.
 
     // Append a check sum to the FITS header of the event extension.
     int hdutype;
@@ -27,6 +27,7 @@
 #include "sixt.h"
 #include "event.h"
 #include "eventfile.h"
+#include "eventtransform.h"
 
 #define TOOLSUB ero_rawevents_main
 #include "headas_main.c"
@@ -47,6 +48,13 @@ struct Parameters {
 };
 
 
+/** Output eROSITA event file and its column numbers. */
+typedef struct {
+  fitsfile* fptr;
+  int cots, cfracsec, cframe, crawx, crawy, cpha;
+} RawEventsOutput;
+
+
 ////////////////////////////////////////////////////////////////////////
 // Function declarations.
 ////////////////////////////////////////////////////////////////////////
@@ -27,6 +27,7 @@
 #include "check_fov.h"
 #include "gti.h"
 #include "simput.h"
+#include "visibility.h"
 
 #define TOOLSUB ero_vis_main
 #include "headas_main.c"
@@ -51,6 +52,12 @@ struct Parameters {
   /** [rad]. */
   double visibility_range;
 
+  /** Determine individual GTIs for each source in the catalog. */
+  int PerSource;
+
+  /** Accuracy of the GTI boundaries in the per-source mode [s]. */
+  double Accuracy;
+
   int clobber;
 };
 
@@ -58,6 +65,154 @@ struct Parameters {
 int ero_vis_getpar(struct Parameters *parameters);
 
 
+/** Determine the visibility GTIs of each source in the catalog in a
+    single pass over the attitude and store them in the table SRCGTI
+    of the GTI file, with one row (SRC_ID, START, STOP) per
+    interval. */
+static void ero_vis_catalog(struct Parameters* const par,
+			    Attitude* const ac,
+			    SimputCtlg* const cat,
+			    int* const status)
+{
+  const long nsources=cat->nentries;
+  Vector* dir=NULL;
+  double* radius=NULL;
+  long* srcid=NULL;
+  GTI** gtis=NULL;
+  long* col_srcid=NULL;
+  double* col_start=NULL;
+  double* col_stop=NULL;
+  fitsfile* fptr=NULL;
+
+  do { // Beginning of the ERROR handling loop.
+
+    dir=(Vector*)malloc(nsources*sizeof(Vector));
+    radius=(double*)malloc(nsources*sizeof(double));
+    srcid=(long*)malloc(nsources*sizeof(long));
+    if ((NULL==dir)||(NULL==radius)||(NULL==srcid)) {
+      *status=EXIT_FAILURE;
+      SIXT_ERROR("memory allocation for source positions failed");
+      break;
+    }
+
+    // Determine the positions and extensions of all sources.
+    headas_chat(3, "read %ld sources from the catalog ...\n", nsources);
+    long ii;
+    for (ii=0; ii<nsources; ii++) {
+      SimputSrc* src=getSimputSrc(cat, ii+1, status);
+      CHECK_STATUS_BREAK(*status);
+
+      double ra_center_img=0.0;
+      double dec_center_img=0.0;
+      float extension=getSimputSrcExt(cat, src, &ra_center_img, &dec_center_img,
+				      0., 0., status);
+      CHECK_STATUS_BREAK(*status);
+
+      dir[ii]=unit_vector(ra_center_img, dec_center_img);
+      radius[ii]=0.5*par->visibility_range+extension;
+      srcid[ii]=src->src_id;
+    }
+    CHECK_STATUS_BREAK(*status);
+
+    // Calculate the GTIs of all sources.
+    headas_chat(3, "calculate the visibility GTIs of the individual sources ...\n");
+    gtis=getVisibilityGTIs(ac, dir, radius, nsources, par->TSTART,
+			   par->TSTART+par->Exposure, par->dt, par->Accuracy,
+			   status);
+    CHECK_STATUS_BREAK(*status);
+
+    long nrows=0;
+    for (ii=0; ii<nsources; ii++) {
+      nrows+=gtis[ii]->ngti;
+    }
+    headas_chat(5, "%ld visibility intervals\n", nrows);
+
+    col_srcid=(long*)malloc(MAX(nrows, 1)*sizeof(long));
+    col_start=(double*)malloc(MAX(nrows, 1)*sizeof(double));
+    col_stop =(double*)malloc(MAX(nrows, 1)*sizeof(double));
+    if ((NULL==col_srcid)||(NULL==col_start)||(NULL==col_stop)) {
+      *status=EXIT_FAILURE;
+      SIXT_ERROR("memory allocation for GTI table failed");
+      break;
+    }
+    long row=0;
+    for (ii=0; ii<nsources; ii++) {
+      int jj;
+      for (jj=0; jj<gtis[ii]->ngti; jj++) {
+	col_srcid[row]=srcid[ii];
+	col_start[row]=gtis[ii]->start[jj];
+	col_stop[row] =gtis[ii]->stop[jj];
+	row++;
+      }
+    }
+
+    // Check if the file already exists.
+    int exists;
+    fits_file_exists(par->GTIfile, &exists, status);
+    CHECK_STATUS_BREAK(*status);
+    if (0!=exists) {
+      if (0!=par->clobber) {
+	// Delete the file.
+	remove(par->GTIfile);
+      } else {
+	// Throw an error.
+	char msg[MAXMSG];
+	sprintf(msg, "file '%s' already exists", par->GTIfile);
+	SIXT_ERROR(msg);
+	*status=EXIT_FAILURE;
+	break;
+      }
+    }
+
+    // Store the intervals in the output file.
+    fits_create_file(&fptr, par->GTIfile, status);
+    CHECK_STATUS_BREAK(*status);
+    char* ttype[]={"SRC_ID", "START", "STOP"};
+    char* tform[]={"J", "D", "D"};
+    char* tunit[]={"", "s", "s"};
+    fits_create_tbl(fptr, BINARY_TBL, 0, 3, ttype, tform, tunit,
+		    "SRCGTI", status);
+    CHECK_STATUS_BREAK(*status);
+
+    double mjdref=ac->mjdref;
+    double tstop=par->TSTART+par->Exposure;
+    fits_update_key(fptr, TDOUBLE, "MJDREF", &mjdref, NULL, status);
+    fits_update_key(fptr, TDOUBLE, "TSTART", &par->TSTART, NULL, status);
+    fits_update_key(fptr, TDOUBLE, "TSTOP", &tstop, NULL, status);
+    char datestr[MAXMSG];
+    int timeref;
+    fits_get_system_time(datestr, &timeref, status);
+    fits_update_key(fptr, TSTRING, "DATE", datestr,
+		    "File creation date", status);
+    CHECK_STATUS_BREAK(*status);
+
+    if (nrows>0) {
+      fits_write_col(fptr, TLONG, 1, 1, 1, nrows, col_srcid, status);
+      fits_write_col(fptr, TDOUBLE, 2, 1, 1, nrows, col_start, status);
+      fits_write_col(fptr, TDOUBLE, 3, 1, 1, nrows, col_stop, status);
+      CHECK_STATUS_BREAK(*status);
+    }
+
+    fits_close_file(fptr, status);
+    fptr=NULL;
+    CHECK_STATUS_BREAK(*status);
+
+  } while(0); // END of the error handling loop.
+
+  if (NULL!=fptr) {
+    int status2=EXIT_SUCCESS;
+    fits_close_file(fptr, &status2);
+  }
+  freeVisibilityGTIs(&gtis, nsources);
+  if (NULL!=dir) free(dir);
+  if (NULL!=radius) free(radius);
+  if (NULL!=srcid) free(srcid);
+  if (NULL!=col_srcid) free(col_srcid);
+  if (NULL!=col_start) free(col_start);
+  if (NULL!=col_stop) free(col_stop);
+}
+
+
 int ero_vis_main()
 {
   // Program parameters.
@@ -105,6 +260,18 @@ int ero_vis_main()
     }
     // Otherwise use the specified RA and Dec source position.
 
+    // In the per-source mode, the GTIs of all sources in the catalog
+    // are determined at once.
+    if (0!=par.PerSource) {
+      if (NULL==cat) {
+	SIXT_ERROR("per-source GTIs require a SIMPUT catalog");
+	status=EXIT_FAILURE;
+	break;
+      }
+      ero_vis_catalog(&par, ac, cat, &status);
+      break;
+    }
+
     // Set up a new GTI collection.
     gti=newGTI(&status);
     CHECK_STATUS_BREAK(status);
@@ -309,6 +476,7 @@ int ero_vis_main()
   if (NULL!=timestr) free(timestr);
   freeAttitude(&ac);
   freeGTI(&gti);
+  freeSimputCtlg(&cat, &status);
 
   if (EXIT_SUCCESS==status) headas_chat(3, "finished successfully!\n\n");
   return(status);
@@ -341,6 +509,8 @@ int ero_vis_getpar(struct Parameters *par)
   query_simput_parameter_double("TSTART", &par->TSTART, &status);
   query_simput_parameter_double("Exposure", &par->Exposure, &status);
   query_simput_parameter_double("dt", &par->dt, &status);
+  query_simput_parameter_bool("PerSource", &par->PerSource, &status);
+  query_simput_parameter_double("Accuracy", &par->Accuracy, &status);
   query_simput_parameter_bool("clobber", &par->clobber, &status);
 
   return(status);
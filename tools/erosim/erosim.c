@@ -141,6 +141,7 @@ int erosim_main() {
 	// Register HEATOOL
 	set_toolname("erosim");
 	set_toolversion("1.2");
+	initSixtProfiling("erosim");
 
 	do { // Beginning of ERROR HANDLING Loop.
 
@@ -210,6 +211,35 @@ int erosim_main() {
 			strcat(evtfile_filename_template, par.EvtFile);
 		}
 
+		// Determine the checkpoint file.
+		char checkpoint_filename[MAXFILENAME];
+		strcpy(ucase_buffer, par.Checkpoint);
+		strtoupper(ucase_buffer);
+		if (0 == strcmp(ucase_buffer, "NONE")) {
+			strcpy(checkpoint_filename, "");
+		} else {
+			strcpy(checkpoint_filename, par.Prefix);
+			strcat(checkpoint_filename, par.Checkpoint);
+		}
+
+		// Resume the simulation, if a checkpoint is available.
+		int resume = 0;
+		if (0 != par.Resume) {
+			if (0 == strlen(checkpoint_filename)) {
+				SIXT_ERROR("a checkpoint file is required to resume the simulation");
+				status = EXIT_FAILURE;
+				break;
+			}
+			FILE* cpfile = fopen(checkpoint_filename, "r");
+			if (NULL != cpfile) {
+				fclose(cpfile);
+				resume = 1;
+			} else {
+				headas_chat(3, "checkpoint '%s' not found, start new simulation\n",
+						checkpoint_filename);
+			}
+		}
+
 		// Set the progress status output file.
 		strcpy(ucase_buffer, par.ProgressFile);
 		strtoupper(ucase_buffer);
@@ -224,6 +254,16 @@ int erosim_main() {
 
 		char xml_filename[MAXFILENAME];
 
+		// A resumed simulation continues with the seed of the
+		// interrupted one.
+		unsigned int baseseed;
+		if (0 != resume) {
+			baseseed = getCheckpointSeed(checkpoint_filename, &status);
+			CHECK_STATUS_BREAK(status);
+		} else {
+			baseseed = getShardSeed(getSeed(par.Seed), par.Shard);
+		}
+
 		unsigned int seed;
 		// Load the configurations of all seven sub-instruments.
 		for (ii = 0; ii < NUM_TELS; ii++) {
@@ -231,7 +271,7 @@ int erosim_main() {
 			sixt_get_eroXMLFile(xml_filename, ii, &status);
 
 			// Initialize the random number generator for each Telescope
-			seed = getSeed(par.Seed) + ii;
+			seed = baseseed + ii;
 			sixt_init_rng(seed, &status);
 			CHECK_STATUS_BREAK(status);
 
@@ -274,7 +314,9 @@ int erosim_main() {
 			// specific (if available) or the default XML file.
 
 			printf("Telescope %ld, use XML file\n%s\n", ii + 1, xml_filename);
-			subinst[ii] = loadGenInst(buffer, seed, &status);
+			// Use a separate stream of the cosmic ray background for
+			// each sub-instrument.
+			subinst[ii] = loadGenInst(buffer, seed + ii, &status);
 			CHECK_STATUS_BREAK(status);
 
 			// Set the usage of the detector background according to
@@ -287,6 +329,11 @@ int erosim_main() {
 		}
 		CHECK_STATUS_BREAK(status);
 
+		if (strlen(checkpoint_filename) > 0) {
+			checkCheckpointSupport(subinst, NUM_TELS, &status);
+			CHECK_STATUS_BREAK(status);
+		}
+
 		// Determine a fake ARF with the combined effective area of
 		// all seven sub-telescopes.
 		arf7 = (struct ARF*) malloc(sizeof(struct ARF));
@@ -348,6 +395,18 @@ int erosim_main() {
 		double tstop = gti->stop[gti->ngti - 1];
 		double mjdref = gti->mjdref;
 
+		// Only simulate the part of the GTI that belongs to this shard.
+		// The attitude and the file headers still refer to the full GTI.
+		if ((par.NShards > 1) || (0 != par.Shard)) {
+			GTI* sgti = getGTIShard(gti, par.Shard, par.NShards,
+					par.ShardChunk, &status);
+			freeGTI(&gti);
+			gti = sgti;
+			CHECK_STATUS_BREAK(status);
+			headas_chat(3, "simulating shard %d of %d (%d GTI intervals, %.1lf s)\n",
+					par.Shard, par.NShards, gti->ngti, sumGTI(gti));
+		}
+
 		// Set up the Attitude.
 		if (par.Attitude == NULL) {
 			// Set up a simple pointing attitude.
@@ -451,11 +510,17 @@ int erosim_main() {
 		  CHECK_STATUS_BREAK(status);
 		}
 
+		if (strlen(checkpoint_filename) > 0) {
+			checkCheckpointSources(srccat, MAX_N_SIMPUT, &status);
+			CHECK_STATUS_BREAK(status);
+		}
+
 		// --- End of Initialization ---
 
 		// --- Open and set up files ---
 
-		// Open the output photon list files.
+		// Open the output photon list files. A resumed simulation
+		// continues the files of the interrupted one.
 		if (strlen(photonlist_filename_template) > 0) {
 			for (ii = 0; ii < 7; ii++) {
 				char telescop[MAXMSG] = { "" };
@@ -470,11 +535,16 @@ int erosim_main() {
 				char photonlist_filename[MAXFILENAME];
 				sprintf(photonlist_filename, photonlist_filename_template,
 						ii + 1);
-				plf[ii] = openNewPhotonFile(photonlist_filename, telescop,
-						instrume, subinst[ii]->tel->arf->Filter,
-						subinst[ii]->tel->arf_filename,
-						subinst[ii]->det->rmf_filename, mjdref, 0.0, tstart,
-						tstop, par.clobber, &status);
+				if (0 != resume) {
+					plf[ii] = openPhotonFile(photonlist_filename, READWRITE,
+							&status);
+				} else {
+					plf[ii] = openNewPhotonFile(photonlist_filename, telescop,
+							instrume, subinst[ii]->tel->arf->Filter,
+							subinst[ii]->tel->arf_filename,
+							subinst[ii]->det->rmf_filename, mjdref, 0.0, tstart,
+							tstop, par.clobber, &status);
+				}
 				CHECK_STATUS_BREAK(status);
 			}
 			CHECK_STATUS_BREAK(status);
@@ -495,11 +565,16 @@ int erosim_main() {
 				char impactlist_filename[MAXFILENAME];
 				sprintf(impactlist_filename, impactlist_filename_template,
 						ii + 1);
-				ilf[ii] = openNewImpactFile(impactlist_filename, telescop,
-						instrume, subinst[ii]->tel->arf->Filter,
-						subinst[ii]->tel->arf_filename,
-						subinst[ii]->det->rmf_filename, mjdref, 0.0, tstart,
-						tstop, par.clobber, &status);
+				if (0 != resume) {
+					ilf[ii] = openImpactFile(impactlist_filename, READWRITE,
+							&status);
+				} else {
+					ilf[ii] = openNewImpactFile(impactlist_filename, telescop,
+							instrume, subinst[ii]->tel->arf->Filter,
+							subinst[ii]->tel->arf_filename,
+							subinst[ii]->det->rmf_filename, mjdref, 0.0, tstart,
+							tstop, par.clobber, &status);
+				}
 				CHECK_STATUS_BREAK(status);
 			}
 			CHECK_STATUS_BREAK(status);
@@ -518,12 +593,16 @@ int erosim_main() {
 
 			char rawdata_filename[MAXFILENAME];
 			sprintf(rawdata_filename, rawdata_filename_template, ii + 1);
-			elf[ii] = openNewEventFile(rawdata_filename, telescop, instrume,
-					subinst[ii]->tel->arf->Filter,
-					subinst[ii]->tel->arf_filename,
-					subinst[ii]->det->rmf_filename, mjdref, 0.0, tstart, tstop,
-					subinst[ii]->det->pixgrid->xwidth,
-					subinst[ii]->det->pixgrid->ywidth, par.clobber, &status);
+			if (0 != resume) {
+				elf[ii] = openEventFile(rawdata_filename, READWRITE, &status);
+			} else {
+				elf[ii] = openNewEventFile(rawdata_filename, telescop, instrume,
+						subinst[ii]->tel->arf->Filter,
+						subinst[ii]->tel->arf_filename,
+						subinst[ii]->det->rmf_filename, mjdref, 0.0, tstart, tstop,
+						subinst[ii]->det->pixgrid->xwidth,
+						subinst[ii]->det->pixgrid->ywidth, par.clobber, &status);
+			}
 			CHECK_STATUS_BREAK(status);
 
 			// Define the event list file as output file for the respective
@@ -532,7 +611,8 @@ int erosim_main() {
 		}
 		CHECK_STATUS_BREAK(status);
 
-		// Open the output pattern list files.
+		// Open the output pattern list files. They are only filled at
+		// the end and therefore also replaced in a resumed simulation.
 		for (ii = 0; ii < 7; ii++) {
 			char telescop[MAXMSG] = { "" };
 			char instrume[MAXMSG] = { "" };
@@ -550,7 +630,8 @@ int erosim_main() {
 					subinst[ii]->tel->arf_filename,
 					subinst[ii]->det->rmf_filename, mjdref, 0.0, tstart, tstop,
 					subinst[ii]->det->pixgrid->xwidth,
-					subinst[ii]->det->pixgrid->ywidth, par.clobber, &status);
+					subinst[ii]->det->pixgrid->ywidth, par.clobber || resume,
+					&status);
 			CHECK_STATUS_BREAK(status);
 		}
 		CHECK_STATUS_BREAK(status);
@@ -682,6 +763,22 @@ int erosim_main() {
 		}
 		CHECK_STATUS_BREAK(status);
 
+		// Mark the output of a sharded run for the merge with shardmerge.
+		if (par.NShards > 1) {
+			for (ii = 0; ii < 7; ii++) {
+				fits_update_key(elf[ii]->fptr, TINT, "SHARD", &par.Shard,
+						"index of the simulated shard", &status);
+				fits_update_key(elf[ii]->fptr, TINT, "NSHARDS", &par.NShards,
+						"number of shards", &status);
+				fits_update_key(patf[ii]->fptr, TINT, "SHARD", &par.Shard,
+						"index of the simulated shard", &status);
+				fits_update_key(patf[ii]->fptr, TINT, "NSHARDS", &par.NShards,
+						"number of shards", &status);
+				CHECK_STATUS_BREAK(status);
+			}
+			CHECK_STATUS_BREAK(status);
+		}
+
 		// Split event threshold.
 		for (ii = 0; ii < 7; ii++) {
 			if (subinst[ii]->det->threshold_split_lo_fraction > 0.0) {
@@ -723,24 +820,67 @@ int erosim_main() {
 		}
 		CHECK_STATUS_BREAK(status);
 
+		// Restore the state of the simulation from the checkpoint and
+		// remove the output written after it.
+		SimCheckpoint cp;
+		cp.tstart = tstart;
+		cp.tstop = tstop;
+		cp.gtibin = 0;
+		cp.simtime = 0.;
+		cp.progress = 0;
+		if (0 != resume) {
+			loadCheckpoint(checkpoint_filename, &cp, subinst, NUM_TELS, srccat,
+					MAX_N_SIMPUT, par.MJDREF, &status);
+			CHECK_STATUS_BREAK(status);
+			resumeCheckpointFiles(&cp, NUM_TELS, plf, ilf, elf, &status);
+			CHECK_STATUS_BREAK(status);
+			progress = cp.progress;
+			headas_chat(3, "resume simulation at %u %% ...\n", progress);
+		}
+		time_t checkpoint_time = time(NULL);
+
 		// Loop over all intervals in the GTI collection.
-		double simtime = 0.;
-		int gtibin = 0;
+		double simtime = cp.simtime;
+		int gtibin = cp.gtibin;
 		do {
 			// Currently regarded interval.
 			double t0 = gti->start[gtibin];
 			double t1 = gti->stop[gtibin];
 
-			// Set the start time for the detector models.
-			for (ii = 0; ii < 7; ii++) {
-				setGenDetStartTime(subinst[ii]->det, t0);
+			// Set the start time for the detector models, unless the
+			// clocks have been restored from the checkpoint.
+			if (0 == resume) {
+				for (ii = 0; ii < 7; ii++) {
+					setGenDetStartTime(subinst[ii]->det, t0);
+				}
 			}
+			resume = 0;
 
 			// Loop over photon generation and processing
 			// till the time of the photon exceeds the requested
 			// time interval.
 			do {
 
+				// Write a checkpoint after the specified wall-clock time,
+				// as soon as all generated photons have been processed.
+				if (strlen(checkpoint_filename) > 0) {
+					double phtime;
+					long long ph_id;
+					if (1 == getPhgenState(&phtime, &ph_id)) {
+						if (difftime(time(NULL), checkpoint_time)
+								>= par.CheckpointInterval) {
+							cp.gtibin = gtibin;
+							cp.simtime = simtime;
+							cp.progress = progress;
+							writeCheckpoint(checkpoint_filename, &cp, subinst,
+									NUM_TELS, srccat, MAX_N_SIMPUT, par.MJDREF, plf,
+									ilf, elf, &status);
+							CHECK_STATUS_BREAK(status);
+							checkpoint_time = time(NULL);
+						}
+					}
+				}
+
 				// Photon generation.
 				Photon ph;
 				int isph = phgen(ac, srccat, MAX_N_SIMPUT, t0, t1, par.MJDREF,
@@ -929,6 +1069,12 @@ int erosim_main() {
 			}
 		}
 
+		// The checkpoint is not needed any more after the simulation
+		// has been completed.
+		if (strlen(checkpoint_filename) > 0) {
+			remove(checkpoint_filename);
+		}
+
 	} while (0); // END of ERROR HANDLING Loop.
 
 	// --- Clean up ---
@@ -959,6 +1105,8 @@ int erosim_main() {
 	// Clean up the random number generator.
 	sixt_destroy_rng();
 
+	writeSixtProfiling();
+
 	if (EXIT_SUCCESS == status) {
 		headas_chat(3, "finished successfully!\n\n");
 		return (EXIT_SUCCESS);
@@ -1197,6 +1345,24 @@ int erosim_getpar(struct Parameters* const par) {
 		return (status);
 	}
 
+	status = ape_trad_query_int("Shard", &par->Shard);
+	if (EXIT_SUCCESS != status) {
+		SIXT_ERROR("failed reading the shard index");
+		return (status);
+	}
+
+	status = ape_trad_query_int("NShards", &par->NShards);
+	if (EXIT_SUCCESS != status) {
+		SIXT_ERROR("failed reading the number of shards");
+		return (status);
+	}
+
+	status = ape_trad_query_double("ShardChunk", &par->ShardChunk);
+	if (EXIT_SUCCESS != status) {
+		SIXT_ERROR("failed reading the length of the shard chunks");
+		return (status);
+	}
+
 	status = ape_trad_query_string("ProgressFile", &sbuffer);
 	if (EXIT_SUCCESS != status) {
 		SIXT_ERROR("failed reading the name of the progress status file");
@@ -1205,6 +1371,26 @@ int erosim_getpar(struct Parameters* const par) {
 	strcpy(par->ProgressFile, sbuffer);
 	free(sbuffer);
 
+	status = ape_trad_query_string("Checkpoint", &sbuffer);
+	if (EXIT_SUCCESS != status) {
+		SIXT_ERROR("failed reading the name of the checkpoint file");
+		return (status);
+	}
+	strcpy(par->Checkpoint, sbuffer);
+	free(sbuffer);
+
+	status = ape_trad_query_double("CheckpointInterval", &par->CheckpointInterval);
+	if (EXIT_SUCCESS != status) {
+		SIXT_ERROR("failed reading the checkpoint interval");
+		return (status);
+	}
+
+	status = ape_trad_query_bool("Resume", &par->Resume);
+	if (EXIT_SUCCESS != status) {
+		SIXT_ERROR("failed reading the Resume parameter");
+		return (status);
+	}
+
 	status = ape_trad_query_bool("clobber", &par->clobber);
 	if (EXIT_SUCCESS != status) {
 		SIXT_ERROR("failed reading the clobber parameter");
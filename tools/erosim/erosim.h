@@ -26,6 +26,7 @@
 #include "sixt.h"
 
 #include "attitude.h"
+#include "checkpoint.h"
 #include "eventfile.h"
 #include "geninst.h"
 #include "gentel.h"
@@ -91,9 +92,23 @@ struct Parameters {
 
   int Seed;
 
+  /** Index of the simulated shard and total number of shards the
+      GTI is distributed over. */
+  int Shard, NShards;
+  /** Maximum length of the GTI pieces that are assigned to the
+      individual shards [s] (0: do not split the intervals). */
+  double ShardChunk;
+
   /** Skip invalid patterns when producing the output file. */
   char SkipInvalids;
 
+  /** Checkpoint file, minimum wall-clock time between two checkpoints
+      [s], and flag whether the simulation is resumed from the
+      checkpoint. */
+  char Checkpoint[MAXFILENAME];
+  double CheckpointInterval;
+  char Resume;
+
   char clobber;
 };
 
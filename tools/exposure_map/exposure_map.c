@@ -661,7 +661,7 @@ int exposure_map_main()
 
       // Determine the telescope pointing direction at the current time.
       struct Telescope telescope;
-      getTelescopeAxes(ac, &telescope.nx, &telescope.ny, &telescope.nz,
+      getTelescopeFrame(ac, &telescope.nx, &telescope.ny, &telescope.nz,
     		     time, &status);
      CHECK_STATUS_BREAK(status);
 
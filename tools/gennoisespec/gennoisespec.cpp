@@ -1297,11 +1297,11 @@ int inDataIterator(long totalrows, long offset, long firstrow, long nrows, int n
 		// To avoid taking into account the pulse tails at the beginning of a record as part of a pulse-free interval
 		tail_duration = 0;
 
-		// Low-pass filtering
-		status = lpf_boxcar(&ioutgsl_aux,ioutgsl_aux->size,scaleFactor,samprate);
+		// Low-pass filtering and differentiate after filtering (in a single pass)
+		status = lpf_boxcar_differentiate(&ioutgsl_aux,ioutgsl_aux->size,scaleFactor,samprate);
 		if (status == EPFAIL)
 		{
-			message = "Cannot run routine lpf_boxcar for low pass filtering";
+			message = "Cannot run routine lpf_boxcar_differentiate for low pass filtering and differentiating";
 			EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
 		}
 		if (status == 3)
@@ -1315,13 +1315,6 @@ int inDataIterator(long totalrows, long offset, long firstrow, long nrows, int n
 			EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
 		}
 
-		// Differentiate after filtering
-		if (differentiate (&ioutgsl_aux,ioutgsl_aux->size))
-		{
-			message = "Cannot run routine differentiate for differentiating after filtering";
-			EP_PRINT_ERROR(message,EPFAIL); return(EPFAIL);
-		}
-
 		//Finding the pulses: Pulses tstart are found
 		if (findPulsesNoise (ioutgslNOTFIL, ioutgsl_aux, &tstartgsl, &qualitygsl, &energygsl,
 			&nPulses, &threshold,
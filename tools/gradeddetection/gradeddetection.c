@@ -97,7 +97,8 @@ int gradeddetection_main() {
 		}
 
 		// Process impacts
-		impactsToEvents(det,piximp_file,event_file,par.saveCrosstalk,progressfile,&status);
+		PixImpactSource source={piximp_file,NULL,0,0,NULL};
+		impactsToEvents(det,&source,event_file,par.saveCrosstalk,progressfile,&status);
 
 
 	} while(0); // END of the error handling loop.
@@ -34,9 +34,12 @@ static inline LADImpact* ladphimg(const LAD* const lad,
   // (angle(x0,source) <= 1/2 * diameter)
   const double fov_min_align=cos(lad->fov_diameter/2.);
 
-  // Determine telescope pointing direction at the current time.
+  // Determine telescope data like pointing direction (attitude) etc.
+  // at the current time. The telescope coordinate system consists
+  // of an x-, y-, and z-axis.
   struct Telescope telescope;
-  telescope.nz=getTelescopeNz(ac, ph->time, status);
+  getTelescopeFrame(ac, &telescope.nx, &telescope.ny, &telescope.nz,
+		    ph->time, status);
   CHECK_STATUS_RET(*status, NULL);
 
   // Compare the photon direction to the direction of the telescope
@@ -45,12 +48,6 @@ static inline LADImpact* ladphimg(const LAD* const lad,
   if (check_fov(&photon_direction, &telescope.nz, fov_min_align)==0) {
     // Photon is inside the FOV!
 
-    // Determine telescope data like pointing direction (attitude) etc.
-    // The telescope coordinate system consists of an x-, y-, and z-axis.
-    getTelescopeAxes(ac, &telescope.nx, &telescope.ny, &telescope.nz,
-		     ph->time, status);
-    CHECK_STATUS_RET(*status, NULL);
-
     // Calculate the off-axis angle ([rad]).
     double cos_theta=scalar_product(&telescope.nz, &photon_direction);
 
@@ -183,7 +180,7 @@ static inline LADImpact* ladphimg(const LAD* const lad,
 static inline void ladphdet(const LAD* const lad,
 			    LADImpact* const imp,
 			    const int conv_with_rmf,
-			    LADSignalListItem** const siglist,
+			    LADSignalQueue* const sigqueue,
 			    int* const status)
 {
   // Determine the measured signal.
@@ -284,8 +281,6 @@ static inline void ladphdet(const LAD* const lad,
   fraction1=1.0-fraction2;
 
   // Produce a signal.
-  LADSignalListItem** el=siglist;
-
   LADSignal newsignal;
   newsignal.time     =imp->time+drifttime;
   newsignal.panel    =imp->panel;
@@ -303,32 +298,18 @@ static inline void ladphdet(const LAD* const lad,
   newsignal.signal=fraction1*signal;
   newsignal.anode =anode1;
 
-  // Insert into the time-ordered list.
-  while(NULL!=*el) {
-    if (newsignal.time<(*el)->signal.time) break;
-    el=&((*el)->next);
-  }
-  LADSignalListItem* newel=newLADSignalListItem(status);
+  // Insert into the time-ordered queue.
+  insertLADSignal2Queue(sigqueue, &newsignal, status);
   CHECK_STATUS_VOID(*status);
-  copyLADSignal(&(newel->signal), &newsignal);
-  newel->next=*el;
-  *el=newel;
 
   // Secondary signal fraction.
   if (anode1!=anode2) {
     newsignal.signal=fraction2*signal;
     newsignal.anode =anode2;
 
-    // Insert into the time-ordered list.
-    while(NULL!=*el) {
-      if (newsignal.time<(*el)->signal.time) break;
-      el=&((*el)->next);
-    }
-    LADSignalListItem* newel=newLADSignalListItem(status);
+    // Insert into the time-ordered queue.
+    insertLADSignal2Queue(sigqueue, &newsignal, status);
     CHECK_STATUS_VOID(*status);
-    copyLADSignal(&(newel->signal), &newsignal);
-    newel->next=*el;
-    *el=newel;
   }
   // END of loop over adjacent anodes.
 }
@@ -339,8 +320,17 @@ static inline LADEvent* ladevrecomb(const LAD* const lad,
 				    LADSignal* const signal,
 				    int* const status)
 {
-  // List of raw event signals.
+  // List of raw event signals. The signals are appended in
+  // chronological order, such that the list is time-ordered.
   static LADSignalListItem* first=NULL;
+  // Pointer to the next field of the last list entry.
+  static LADSignalListItem** last=&first;
+  // Pool for the list entries.
+  static LADSignalListPool* pool=NULL;
+  if (NULL==pool) {
+    pool=newLADSignalListPool(status);
+    CHECK_STATUS_RET(*status, NULL);
+  }
 
   // Flag if an event is complete (there will be no further
   // signal contributions).
@@ -375,8 +365,11 @@ static inline LADEvent* ladevrecomb(const LAD* const lad,
 
     // Delete the first element from the list.
     LADSignalListItem* next=first->next;
-    free(first);
+    releaseLADSignalListPoolItem(pool, first);
     first=next;
+    if (NULL==first) {
+      last=&first;
+    }
 
     // Search the list in order to find adjacent signals.
     float maxsignal=ev->signal;
@@ -440,8 +433,11 @@ static inline LADEvent* ladevrecomb(const LAD* const lad,
 
 		// Delete the signal entry from the list.
 		next=(*item)->next;
-		free((*item));
+		releaseLADSignalListPoolItem(pool, *item);
 		(*item)=next;
+		if (NULL==next) {
+		  last=item;
+		}
 
 		new=1;
 		break;
@@ -481,16 +477,12 @@ static inline LADEvent* ladevrecomb(const LAD* const lad,
 
 
   if (NULL!=signal) {
-    // Move to the end of the list.
-    LADSignalListItem** item=&first;
-    while (NULL!=(*item)) {
-      item=&((*item)->next);
-    }
-
     // Append the new signal to the end of the list.
-    (*item)=newLADSignalListItem(status);
+    LADSignalListItem* item=getLADSignalListPoolItem(pool, status);
     CHECK_STATUS_RET(*status, NULL);
-    copyLADSignal(&(*item)->signal, signal);
+    copyLADSignal(&(item->signal), signal);
+    (*last)=item;
+    last=&(item->next);
   }
   return(NULL);
 }
@@ -522,8 +514,8 @@ int ladsim_main()
   // Recombined event list file.
   LADEventFile* elf=NULL;
 
-  // List of measured signals.
-  LADSignalListItem* siglist=NULL;
+  // Time-ordered queue of measured signals.
+  LADSignalQueue* sigqueue=NULL;
 
   // Output file for progress status.
   FILE* progressfile=NULL;
@@ -636,6 +628,10 @@ int ladsim_main()
     lad=getLADfromXML(xml_filename, &status);
     CHECK_STATUS_BREAK(status);
 
+    // Set up the queue for the detected signals.
+    sigqueue=newLADSignalQueue(&status);
+    CHECK_STATUS_BREAK(status);
+
     // Set up the background ARF if necessary.
     if (NULL!=lad->bkgctlg) {
       // Get an empty ARF.
@@ -982,7 +978,7 @@ int ladsim_main()
 	  bkgimp->src_id=0;
 
 	  // Insert the background impact into the time-ordered cache.
-	  ladphdet(lad, bkgimp, 0, &siglist, &status);
+	  ladphdet(lad, bkgimp, 0, sigqueue, &status);
 	  CHECK_STATUS_BREAK(status);
 	  readouttime=bkgimp->time;
 
@@ -1005,7 +1001,7 @@ int ladsim_main()
 	} else {
 	  // Insert the foreground event.
 	  if (imp->energy>=0.) {
-	    ladphdet(lad, imp, 1, &siglist, &status);
+	    ladphdet(lad, imp, 1, sigqueue, &status);
 	    CHECK_STATUS_BREAK(status);
 	  }
 	  readouttime=imp->time;
@@ -1013,9 +1009,8 @@ int ladsim_main()
 	}
 
 	// Determine the signals at the individual anodes.
-	while (NULL!=siglist) {
-
-	  LADSignal* signal=&siglist->signal;
+	LADSignal* signal;
+	while (NULL!=(signal=firstLADSignalQueue(sigqueue))) {
 
 	  // Go through the cache of detected signals and read out
 	  // all which happend before imp->time-tDmax. We need to
@@ -1055,10 +1050,8 @@ int ladsim_main()
 		(signal->time-element->asic_readout_time[asic]<
 		 lad->coincidencetime+element->asic_deadtime[asic])) {
 
-	      // Delete the element from the buffered list.
-	      LADSignalListItem* next=siglist->next;
-	      free(siglist);
-	      siglist=next;
+	      // Delete the element from the buffered queue.
+	      popLADSignalQueue(sigqueue);
 	      continue;
 	    }
 	  }
@@ -1069,10 +1062,8 @@ int ladsim_main()
 		  (signal->time-element->asic_readout_time[asic2]<
 		   lad->coincidencetime+element->asic_deadtime[asic2])) {
 
-		// Delete the element from the buffered list.
-		LADSignalListItem* next=siglist->next;
-		free(siglist);
-		siglist=next;
+		// Delete the element from the buffered queue.
+		popLADSignalQueue(sigqueue);
 		continue;
 	      }
 	    }
@@ -1096,7 +1087,7 @@ int ladsim_main()
 
 	  // Recombine neighboring signals to events.
 	  LADEvent* ev;
-	  while ((ev=ladevrecomb(lad, &siglist->signal, &status))) {
+	  while ((ev=ladevrecomb(lad, signal, &status))) {
 	    CHECK_STATUS_BREAK(status);
 
 	    // Add the event to the output file.
@@ -1109,9 +1100,7 @@ int ladsim_main()
 	  // END of loop over all events.
 
 	  // Move to the next entry.
-	  LADSignalListItem* next=siglist->next;
-	  free(siglist);
-	  siglist=next;
+	  popLADSignalQueue(sigqueue);
 	}
 	CHECK_STATUS_BREAK(status);
 	// END of loop over all signals.
@@ -1139,8 +1128,8 @@ int ladsim_main()
 
     // Make sure that the signal list has been processed until
     // the end of the simulated interval.
-    if (siglist!=NULL) {
-      assert(siglist->signal.time>par.TSTART+par.Exposure);
+    if (NULL!=firstLADSignalQueue(sigqueue)) {
+      assert(firstLADSignalQueue(sigqueue)->time>par.TSTART+par.Exposure);
     }
 
     // Store the GTI extension in the event file.
@@ -1179,7 +1168,7 @@ int ladsim_main()
   freePhotonFile(&plf, &status);
   freeSourceCatalog(&srccat, &status);
   freeAttitude(&ac);
-  freeLADSignalList(&siglist);
+  freeLADSignalQueue(&sigqueue);
   freeLAD(&lad, &status);
   freeSimputSrc(&bkgsrc);
   freeARF(bkgarf);
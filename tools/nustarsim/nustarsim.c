@@ -191,7 +191,9 @@ int nustarsim_main()
 
       // Load the instrument configuration either with the
       // specific (if available) or the default XML file.
-      subinst[ii]=loadGenInst(buffer, seed, &status);
+      // Use a separate stream of the cosmic ray background for
+      // each sub-instrument.
+      subinst[ii]=loadGenInst(buffer, seed+ii, &status);
       CHECK_STATUS_BREAK(status);
 
       // Set the usage of the detector background according to
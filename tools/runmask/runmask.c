@@ -653,8 +653,8 @@ int comaimg(struct Parameters* par,  MaskSystem* mask_setup)
       //Determine unit vector in photon-direction
       Vector phodir=normalize_vector(unit_vector(photon.ra,photon.dec));
 
-      //Determine current telescope pointing direction.
-      telescope.nz=getTelescopeNz(ac,photon.time,&status);
+      //Determine current telescope pointing direction and axes.
+      getTelescopeFrame(ac,&telescope.nx,&telescope.ny,&telescope.nz,photon.time,&status);
       CHECK_STATUS_BREAK(status);
 
       //Check whether photon is inside FOV:
@@ -662,8 +662,6 @@ int comaimg(struct Parameters* par,  MaskSystem* mask_setup)
       if (check_fov(&phodir,&telescope.nz,fov_min_align)==0){
 	//Photon is inside fov
 
-	getTelescopeAxes(ac,&telescope.nx,&telescope.ny,&telescope.nz,photon.time,&status);
-
 	if (0!=strcmp(att_buffer, "NONE")){ //attitude-file is used
 	  //set wcs according to new pointing (attitude could have changed)
 	  setWCScurrentPointing(par->Attitude,ac,&telescope.nz,&wcs,&status);
@@ -847,7 +845,7 @@ int comarecon(struct Parameters* par, MaskSystem* mask_setup)
   fftw_complex* fftReconArray=NULL;
   fftw_complex* fftEventArray=NULL;
   fftw_complex* Multiply = NULL;
-  fftw_complex* fftInvMultiply=NULL;
+  double* fftInvMultiply=NULL;
 
   int status=EXIT_SUCCESS; // Error status.
 
@@ -1066,7 +1064,8 @@ int comarecon(struct Parameters* par, MaskSystem* mask_setup)
        ReconImage1d=SaveReconArray1d(recon, &status);
 
        //perform a fft with the ReconArray
-       fftReconArray=FFTOfArray_1d(ReconImage1d, Size1, Size2, -1);
+       fftReconArray=FFTOfArray_r2c(ReconImage1d, Size1, Size2, &status);
+       CHECK_STATUS_BREAK(status);
 
        //get repixeled mask from ReconArray, which is needed later for building the mask shadow during IROS
        //basic constructor for both,the whole re-pixeled mask&/shadow element
@@ -1086,27 +1085,30 @@ int comarecon(struct Parameters* par, MaskSystem* mask_setup)
 	 }
 
 	 //perform a fft with the EventArray
-	 fftEventArray=FFTOfArray_1d(EventImage1d, Size1, Size2, -1);
+	 fftEventArray=FFTOfArray_r2c(EventImage1d, Size1, Size2, &status);
+	 CHECK_STATUS_BREAK(status);
 
        //multiply fftEventArray with komplex conjugate of fftReconArray
        //Re-part: E(Re)*R(Re)+E(Im)*R(Im); Im-part: E(Re)*R(Im)-E(Im)*R(Re)
-       Multiply=(fftw_complex*) fftw_malloc(sizeof(fftw_complex)*(Size1*Size2));
-       for(ii=0; ii<Size1; ii++){
-	 for(jj=0; jj<Size2; jj++){
-	   Multiply[ii+Size1*jj][0]=fftEventArray[ii+Size1*jj][0]*fftReconArray[ii+Size1*jj][0]
-	     +fftEventArray[ii+Size1*jj][1]*(fftReconArray[ii+Size1*jj][1]);
-	   Multiply[ii+Size1*jj][1]=-fftEventArray[ii+Size1*jj][0]*(fftReconArray[ii+Size1*jj][1])
-	     +fftEventArray[ii+Size1*jj][1]*fftReconArray[ii+Size1*jj][0];
-	 }
+       //(both arrays are real, so only the non-redundant half is needed)
+       long nfft=(long)Size1*(Size2/2+1);
+       long kk;
+       Multiply=(fftw_complex*) fftw_malloc(sizeof(fftw_complex)*nfft);
+       for(kk=0; kk<nfft; kk++){
+	 Multiply[kk][0]=fftEventArray[kk][0]*fftReconArray[kk][0]
+	   +fftEventArray[kk][1]*(fftReconArray[kk][1]);
+	 Multiply[kk][1]=-fftEventArray[kk][0]*(fftReconArray[kk][1])
+	   +fftEventArray[kk][1]*fftReconArray[kk][0];
        }
 
-       //Inverse FFT of Multilpy which already is of type fftw_complex
-       fftInvMultiply=FFTOfArray(Multiply, Size1, Size2, +1);
+       //Inverse FFT of Multilpy, which is real-valued
+       fftInvMultiply=FFTOfArray_c2r(Multiply, Size1, Size2, &status);
+       CHECK_STATUS_BREAK(status);
 
-       //save real part of inverse fft in sky image
+       //save inverse fft in sky image
        for(ii=0; ii<Size1; ii++){
 	 for(jj=0; jj<Size2; jj++){
-	   sky_pixels->pixel[ii][jj]=fftInvMultiply[ii+Size1*jj][0]/(Size1*Size2);
+	   sky_pixels->pixel[ii][jj]=fftInvMultiply[ii+Size1*jj]/(Size1*Size2);
 	 }
        }
 
@@ -77,6 +77,7 @@ int runsixt_main()
   // Register HEATOOL
   set_toolname("runsixt");
   set_toolversion("0.19");
+  initSixtProfiling("runsixt");
 
 
   do { // Beginning of ERROR HANDLING Loop.
@@ -145,8 +146,44 @@ int runsixt_main()
       strcat(evtfile_filename, par.EvtFile);
     }
 
-    // Initialize the random number generator.
-    unsigned int seed=getSeed(par.Seed);
+    // Determine the checkpoint file.
+    char checkpoint_filename[MAXFILENAME];
+    strcpy(ucase_buffer, par.Checkpoint);
+    strtoupper(ucase_buffer);
+    if (0==strcmp(ucase_buffer,"NONE")) {
+      strcpy(checkpoint_filename, "");
+    } else {
+      strcpy(checkpoint_filename, par.Prefix);
+      strcat(checkpoint_filename, par.Checkpoint);
+    }
+
+    // Resume the simulation, if a checkpoint is available.
+    int resume=0;
+    if (0!=par.Resume) {
+      if (0==strlen(checkpoint_filename)) {
+	SIXT_ERROR("a checkpoint file is required to resume the simulation");
+	status=EXIT_FAILURE;
+	break;
+      }
+      FILE* cpfile=fopen(checkpoint_filename, "r");
+      if (NULL!=cpfile) {
+	fclose(cpfile);
+	resume=1;
+      } else {
+	headas_chat(3, "checkpoint '%s' not found, start new simulation\n",
+		    checkpoint_filename);
+      }
+    }
+
+    // Initialize the random number generator. A resumed simulation
+    // continues with the seed of the interrupted one.
+    unsigned int seed;
+    if (0!=resume) {
+      seed=getCheckpointSeed(checkpoint_filename, &status);
+      CHECK_STATUS_BREAK(status);
+    } else {
+      seed=getShardSeed(getSeed(par.Seed), par.Shard);
+    }
     sixt_init_rng(seed, &status);
     CHECK_STATUS_BREAK(status);
 
@@ -180,6 +217,11 @@ int runsixt_main()
     // the respective program parameter.
     setGenDetIgnoreBkg(inst->det, !par.Background);
 
+    if (strlen(checkpoint_filename)>0) {
+      checkCheckpointSupport(&inst, 1, &status);
+      CHECK_STATUS_BREAK(status);
+    }
+
     // Set up the Attitude.
     if (par.Attitude==NULL) {
       // Set up a pointing attitude.
@@ -206,6 +248,16 @@ int runsixt_main()
 				   par.MJDREF, &status);
     CHECK_STATUS_BREAK(status);
 
+    // Only simulate the part of the GTI that belongs to this shard.
+    if ((par.NShards>1)||(0!=par.Shard)) {
+      GTI* sgti=getGTIShard(gti, par.Shard, par.NShards, par.ShardChunk, &status);
+      freeGTI(&gti);
+      gti=sgti;
+      CHECK_STATUS_BREAK(status);
+      headas_chat(3, "simulating shard %d of %d (%d GTI intervals, %.1lf s)\n",
+		  par.Shard, par.NShards, gti->ngti, sumGTI(gti));
+    }
+
     // Load the SIMPUT X-ray source catalogs.
     srccat[0]=loadSourceCatalog(par.Simput, inst->tel->arf, &status);
     CHECK_STATUS_BREAK(status);
@@ -260,6 +312,11 @@ int runsixt_main()
       }
     }
 
+    if (strlen(checkpoint_filename)>0) {
+      checkCheckpointSources(srccat, MAX_N_SIMPUT, &status);
+      CHECK_STATUS_BREAK(status);
+    }
+
     // --- End of Initialization ---
 
 
@@ -277,47 +334,61 @@ int runsixt_main()
     }
     double tstop=gti->stop[gti->ngti-1];
 
-    // Open the output photon list file.
+    // Open the output photon list file. A resumed simulation
+    // continues the files of the interrupted one.
     if (strlen(photonlist_filename)>0) {
-      plf=openNewPhotonFile(photonlist_filename,
-			    telescop, instrume, filter,
-			    inst->tel->arf_filename, inst->det->rmf_filename,
-			    par.MJDREF, 0.0, par.TSTART, tstop,
-			    par.clobber, &status);
+      if (0!=resume) {
+	plf=openPhotonFile(photonlist_filename, READWRITE, &status);
+      } else {
+	plf=openNewPhotonFile(photonlist_filename,
+			      telescop, instrume, filter,
+			      inst->tel->arf_filename, inst->det->rmf_filename,
+			      par.MJDREF, 0.0, par.TSTART, tstop,
+			      par.clobber, &status);
+      }
       CHECK_STATUS_BREAK(status);
     }
 
     // Open the output impact list file.
     if (strlen(impactlist_filename)>0) {
-      ilf=openNewImpactFile(impactlist_filename,
-			    telescop, instrume, filter,
-			    inst->tel->arf_filename, inst->det->rmf_filename,
-			    par.MJDREF, 0.0, par.TSTART, tstop,
-			    par.clobber, &status);
+      if (0!=resume) {
+	ilf=openImpactFile(impactlist_filename, READWRITE, &status);
+      } else {
+	ilf=openNewImpactFile(impactlist_filename,
+			      telescop, instrume, filter,
+			      inst->tel->arf_filename, inst->det->rmf_filename,
+			      par.MJDREF, 0.0, par.TSTART, tstop,
+			      par.clobber, &status);
+      }
       CHECK_STATUS_BREAK(status);
     }
 
     // Open the output event list file.
-    elf=openNewEventFile(rawdata_filename,
-			 telescop, instrume, filter,
-			 inst->tel->arf_filename, inst->det->rmf_filename,
-			 par.MJDREF, 0.0, par.TSTART, tstop,
-			 inst->det->pixgrid->xwidth,
-			 inst->det->pixgrid->ywidth,
-			 par.clobber, &status);
+    if (0!=resume) {
+      elf=openEventFile(rawdata_filename, READWRITE, &status);
+    } else {
+      elf=openNewEventFile(rawdata_filename,
+			   telescop, instrume, filter,
+			   inst->tel->arf_filename, inst->det->rmf_filename,
+			   par.MJDREF, 0.0, par.TSTART, tstop,
+			   inst->det->pixgrid->xwidth,
+			   inst->det->pixgrid->ywidth,
+			   par.clobber, &status);
+    }
     CHECK_STATUS_BREAK(status);
 
     // Define the event file as output file.
     setGenDetEventFile(inst->det, elf);
 
-    // Open the output pattern list file.
+    // Open the output pattern list file. It is only filled at the
+    // end and therefore also replaced in a resumed simulation.
     patf=openNewEventFile(evtfile_filename,
 			  telescop, instrume, filter,
 			  inst->tel->arf_filename, inst->det->rmf_filename,
 			  par.MJDREF, 0.0, par.TSTART, tstop,
 			  inst->det->pixgrid->xwidth,
 			  inst->det->pixgrid->ywidth,
-			  par.clobber, &status);
+			  par.clobber || resume, &status);
     CHECK_STATUS_BREAK(status);
 
     float rotation_angle=inst->det->pixgrid->rota*180./M_PI;
@@ -325,6 +396,15 @@ int runsixt_main()
     fits_update_key(patf->fptr, TFLOAT, "CCDROTA", &rotation_angle, "CCD rotation angle [deg]", &status);
     CHECK_STATUS_BREAK(status);
 
+    // Mark the output of a sharded run for the merge with shardmerge.
+    if (par.NShards>1) {
+      fits_update_key(elf->fptr, TINT, "SHARD", &par.Shard, "index of the simulated shard", &status);
+      fits_update_key(elf->fptr, TINT, "NSHARDS", &par.NShards, "number of shards", &status);
+      fits_update_key(patf->fptr, TINT, "SHARD", &par.Shard, "index of the simulated shard", &status);
+      fits_update_key(patf->fptr, TINT, "NSHARDS", &par.NShards, "number of shards", &status);
+      CHECK_STATUS_BREAK(status);
+    }
+
     // Set FITS header keywords.
     // If this is a pointing attitude, store the direction in the output
     // photon list.
@@ -452,22 +532,72 @@ int runsixt_main()
 		    "exposure time [s]", &status);
     CHECK_STATUS_BREAK(status);
 
+    // Restore the state of the simulation from the checkpoint and
+    // remove the output written after it.
+    SimCheckpoint cp;
+    cp.tstart=par.TSTART;
+    cp.tstop=tstop;
+    cp.gtibin=0;
+    cp.simtime=0.;
+    cp.progress=0;
+    if (0!=resume) {
+      loadCheckpoint(checkpoint_filename, &cp, &inst, 1, srccat, MAX_N_SIMPUT,
+		     par.MJDREF, &status);
+      CHECK_STATUS_BREAK(status);
+      resumeCheckpointFiles(&cp, 1, &plf, &ilf, &elf, &status);
+      CHECK_STATUS_BREAK(status);
+      progress=cp.progress;
+      headas_chat(3, "resume simulation at %u %% ...\n", progress);
+    }
+    time_t checkpoint_time=time(NULL);
+
+    // From now on the impacts and raw events are only appended
+    // to the files, which is done in blocks by the FITS writers.
+    if (NULL!=ilf) {
+      startImpactFileWriter(ilf, par.AsyncWrite, &status);
+      CHECK_STATUS_BREAK(status);
+    }
+    startEventFileWriter(elf, par.AsyncWrite, &status);
+    CHECK_STATUS_BREAK(status);
+
     // Loop over all intervals in the GTI collection.
-    int gtibin=0;
-    double simtime=0.;
+    int gtibin=cp.gtibin;
+    double simtime=cp.simtime;
     do {
     	// Currently regarded interval.
     	double t0=gti->start[gtibin];
     	double t1=gti->stop[gtibin];
 
-    	// Set the start time for the instrument model.
-    	setGenDetStartTime(inst->det, t0);
+    	// Set the start time for the instrument model, unless the
+    	// clock has been restored from the checkpoint.
+    	if (0==resume) {
+    		setGenDetStartTime(inst->det, t0);
+    	}
+    	resume=0;
 
     	// Loop over photon generation and processing
     	// till the time of the photon exceeds the requested
     	// time interval.
     	do {
 
+    		// Write a checkpoint after the specified wall-clock time,
+    		// as soon as all generated photons have been processed.
+    		if (strlen(checkpoint_filename)>0) {
+    			double phtime;
+    			long long ph_id;
+    			if (1==getPhgenState(&phtime, &ph_id)) {
+    				if (difftime(time(NULL), checkpoint_time)>=par.CheckpointInterval) {
+    					cp.gtibin=gtibin;
+    					cp.simtime=simtime;
+    					cp.progress=progress;
+    					writeCheckpoint(checkpoint_filename, &cp, &inst, 1, srccat,
+    							MAX_N_SIMPUT, par.MJDREF, &plf, &ilf, &elf, &status);
+    					CHECK_STATUS_BREAK(status);
+    					checkpoint_time=time(NULL);
+    				}
+    			}
+    		}
+
     		// Photon generation.
     		Photon ph;
     		int isph=phgen(ac, srccat, MAX_N_SIMPUT, t0, t1, par.MJDREF, par.dt,
@@ -554,6 +684,10 @@ int runsixt_main()
     // Check if any photons were imaged
     check_if_imaged(inst->tel);
 
+    // Wait until all raw events have been written.
+    flushEventFile(elf, &status);
+    CHECK_STATUS_BREAK(status);
+
 
     // Perform a pattern analysis, only if split events are simulated.
     if (GS_NONE!=inst->det->split->type) {
@@ -609,6 +743,12 @@ int runsixt_main()
     	CHECK_STATUS_BREAK(status);
     }
 
+    // The checkpoint is not needed any more after the simulation
+    // has been completed.
+    if (strlen(checkpoint_filename)>0) {
+    	remove(checkpoint_filename);
+    }
+
 
   } while(0); // END of ERROR HANDLING Loop.
 
@@ -638,6 +778,8 @@ int runsixt_main()
   // Clean up the random number generator.
   sixt_destroy_rng();
 
+  writeSixtProfiling();
+
   if (EXIT_SUCCESS==status) {
     headas_chat(3, "finished successfully!\n\n");
     return(EXIT_SUCCESS);
@@ -825,6 +967,24 @@ int runsixt_getpar(struct Parameters* const par)
     return(status);
   }
 
+  status=ape_trad_query_int("Shard", &par->Shard);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the shard index");
+    return(status);
+  }
+
+  status=ape_trad_query_int("NShards", &par->NShards);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the number of shards");
+    return(status);
+  }
+
+  status=ape_trad_query_double("ShardChunk", &par->ShardChunk);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the length of the shard chunks");
+    return(status);
+  }
+
   status=ape_trad_query_string("ProgressFile", &sbuffer);
   if (EXIT_SUCCESS!=status) {
     SIXT_ERROR("failed reading the name of the progress status file");
@@ -833,6 +993,32 @@ int runsixt_getpar(struct Parameters* const par)
   strcpy(par->ProgressFile, sbuffer);
   free(sbuffer);
 
+  status=ape_trad_query_bool("AsyncWrite", &par->AsyncWrite);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the AsyncWrite parameter");
+    return(status);
+  }
+
+  status=ape_trad_query_string("Checkpoint", &sbuffer);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the name of the checkpoint file");
+    return(status);
+  }
+  strcpy(par->Checkpoint, sbuffer);
+  free(sbuffer);
+
+  status=ape_trad_query_double("CheckpointInterval", &par->CheckpointInterval);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the checkpoint interval");
+    return(status);
+  }
+
+  status=ape_trad_query_bool("Resume", &par->Resume);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the Resume parameter");
+    return(status);
+  }
+
   status=ape_trad_query_bool("clobber", &par->clobber);
   if (EXIT_SUCCESS!=status) {
     SIXT_ERROR("failed reading the clobber parameter");
@@ -26,6 +26,7 @@
 #include "sixt.h"
 
 #include "attitude.h"
+#include "checkpoint.h"
 #include "eventfile.h"
 #include "geninst.h"
 #include "gti.h"
@@ -80,9 +81,26 @@ struct Parameters {
 
   int Seed;
 
+  /** Index of the simulated shard and total number of shards the
+      GTI is distributed over. */
+  int Shard, NShards;
+  /** Maximum length of the GTI pieces that are assigned to the
+      individual shards [s] (0: do not split the intervals). */
+  double ShardChunk;
+
   /** Skip invalid patterns when producing the output pattern file. */
   char SkipInvalids;
 
+  /** Write the impact and raw event files in a background thread. */
+  char AsyncWrite;
+
+  /** Checkpoint file, minimum wall-clock time between two checkpoints
+      [s], and flag whether the simulation is resumed from the
+      checkpoint. */
+  char Checkpoint[MAXFILENAME];
+  double CheckpointInterval;
+  char Resume;
+
   char clobber;
 };
 
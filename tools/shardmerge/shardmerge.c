@@ -0,0 +1,688 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2015-2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                       Erlangen-Nuernberg
+*/
+
+#include "shardmerge.h"
+
+
+// Merges the event files of a simulation that has been distributed
+// over several shards (see the Shard and NShards parameters of runsixt
+// and erosim) into a single time-ordered event file. All columns of
+// the input tables are transferred, which therefore must have the same
+// layout (e.g., the pattern files of runsixt can be merged as well as
+// the raw event files). The GTIs of the shards are combined, and the
+// header of the merged file is taken from the first shard.
+//
+// The photon IDs are renumbered such that they increase with time over
+// the merged file like in an unsharded run: the GTI intervals of all
+// shards are processed in the order of time, and the IDs of each
+// interval are shifted behind the IDs of the preceding interval,
+// keeping the gaps left by undetected photons. The IDs are identical
+// to those of an unsharded run only for the first interval, as the
+// shards use different random numbers. Note that the boundaries of
+// the chunks defined by the ShardChunk parameter are GTI stops for the
+// individual shards: the detector is cleared there, such that events
+// are not read out across them.
+
+
+/** Number of rows read at once when scanning the PH_ID column. */
+#define SHARDMERGE_BUFFER_ROWS (10000)
+
+
+/** Return the GTI interval of an event at the given time, starting
+    the search at the interval of the previous event of the same
+    file. Events outside of the GTIs are assigned to the preceding
+    interval (or to the first one). */
+static int getShardInterval(const GTI* const gti, int interval,
+			    const double time)
+{
+  while ((interval+1<gti->ngti)&&(time>=gti->start[interval+1])) {
+    interval++;
+  }
+  return(interval);
+}
+
+
+/** Determine the smallest and largest absolute photon ID in each GTI
+    interval of the shard. The background identifier -1 and empty
+    entries (0) are not taken into account. */
+static void getPhIDRanges(ShardInput* const in, int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+
+  const int nintervals=MAX(1, in->gti->ngti);
+  in->ph_id_min   =(long*)calloc(nintervals, sizeof(long));
+  in->ph_id_max   =(long*)calloc(nintervals, sizeof(long));
+  in->ph_id_offset=(long*)calloc(nintervals, sizeof(long));
+  if ((NULL==in->ph_id_min)||(NULL==in->ph_id_max)||(NULL==in->ph_id_offset)) {
+    SIXT_ERROR("memory allocation for photon ID ranges failed");
+    *status=EXIT_FAILURE;
+    return;
+  }
+
+  double* time=(double*)malloc(SHARDMERGE_BUFFER_ROWS*sizeof(double));
+  long* ph_id=(long*)malloc(SHARDMERGE_BUFFER_ROWS*NEVENTPHOTONS*sizeof(long));
+  if ((NULL==time)||(NULL==ph_id)) {
+    SIXT_ERROR("memory allocation for PH_ID buffer failed");
+    *status=EXIT_FAILURE;
+  }
+
+  EventFile* const file=in->file;
+  int interval=0;
+  long row;
+  for (row=1; (EXIT_SUCCESS==*status)&&(row<=file->nrows);
+       row+=SHARDMERGE_BUFFER_ROWS) {
+    long nrows=MIN(SHARDMERGE_BUFFER_ROWS, file->nrows-row+1);
+    double dnull=0.;
+    long lnull=0;
+    int anynul=0;
+    fits_read_col(file->fptr, TDOUBLE, file->ctime, row, 1,
+		  nrows, &dnull, time, &anynul, status);
+    fits_read_col(file->fptr, TLONG, file->cph_id, row, 1,
+		  nrows*NEVENTPHOTONS, &lnull, ph_id, &anynul, status);
+    CHECK_STATUS_BREAK(*status);
+
+    long ii;
+    for (ii=0; ii<nrows; ii++) {
+      interval=getShardInterval(in->gti, interval, time[ii]);
+      int jj;
+      for (jj=0; jj<NEVENTPHOTONS; jj++) {
+	long id=ph_id[ii*NEVENTPHOTONS+jj];
+	if ((0==id)||(-1==id)) continue;
+	id=labs(id);
+	if ((0==in->ph_id_min[interval])||(id<in->ph_id_min[interval])) {
+	  in->ph_id_min[interval]=id;
+	}
+	if (id>in->ph_id_max[interval]) {
+	  in->ph_id_max[interval]=id;
+	}
+      }
+    }
+  }
+
+  free(time);
+  free(ph_id);
+}
+
+
+static int compareShardInterval(const void* a, const void* b)
+{
+  const ShardInterval* ia=(const ShardInterval*)a;
+  const ShardInterval* ib=(const ShardInterval*)b;
+  if (ia->start<ib->start) return(-1);
+  if (ia->start>ib->start) return(1);
+  return((ia->input>ib->input)-(ia->input<ib->input));
+}
+
+
+/** Determine the photon ID offsets of the GTI intervals of all
+    shards. The intervals are numbered in the order of time. The
+    first ID of an interval follows the last ID of the preceding
+    interval with the same gap as to the last ID of the same shard,
+    i.e., the number of photons of the shard that have not been
+    detected in between. */
+static void setPhIDOffsets(ShardInput* const input, const int ninputs,
+			   int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+
+  long nintervals=0;
+  int ii;
+  for (ii=0; ii<ninputs; ii++) {
+    nintervals+=MAX(1, input[ii].gti->ngti);
+  }
+  ShardInterval* intervals=(ShardInterval*)malloc(nintervals*sizeof(ShardInterval));
+  long* prevmax=(long*)calloc(ninputs, sizeof(long));
+  if ((NULL==intervals)||(NULL==prevmax)) {
+    SIXT_ERROR("memory allocation for GTI intervals failed");
+    *status=EXIT_FAILURE;
+    free(intervals);
+    free(prevmax);
+    return;
+  }
+
+  // Intervals containing photons.
+  long nn=0;
+  for (ii=0; ii<ninputs; ii++) {
+    int jj;
+    for (jj=0; jj<MAX(1, input[ii].gti->ngti); jj++) {
+      if (0==input[ii].ph_id_max[jj]) continue;
+      intervals[nn].start=(input[ii].gti->ngti>0) ? input[ii].gti->start[jj] : 0.;
+      intervals[nn].input=ii;
+      intervals[nn].interval=jj;
+      nn++;
+    }
+  }
+  qsort(intervals, nn, sizeof(ShardInterval), compareShardInterval);
+
+  long last=0;
+  long kk;
+  for (kk=0; kk<nn; kk++) {
+    ShardInput* in=&input[intervals[kk].input];
+    const int jj=intervals[kk].interval;
+    long gap=in->ph_id_min[jj]-prevmax[intervals[kk].input];
+    if (gap<1) gap=1;
+    in->ph_id_offset[jj]=last+gap-in->ph_id_min[jj];
+    last=in->ph_id_max[jj]+in->ph_id_offset[jj];
+    prevmax[intervals[kk].input]=in->ph_id_max[jj];
+  }
+
+  free(intervals);
+  free(prevmax);
+}
+
+
+/** Shift the photon IDs of the event by the given offset. Background
+    events (-1) and empty entries (0) are not changed. */
+static void shiftPhID(Event* const event, const long offset)
+{
+  int ii;
+  for (ii=0; ii<NEVENTPHOTONS; ii++) {
+    if (event->ph_id[ii]>0) {
+      event->ph_id[ii]+=offset;
+    } else if (event->ph_id[ii]<-1) {
+      event->ph_id[ii]-=offset;
+    }
+  }
+}
+
+
+/** Order of the input files. Files with a SHARD keyword are sorted
+    according to their shard index. */
+static int compareShardInput(const void* a, const void* b)
+{
+  const ShardInput* sa=(const ShardInput*)a;
+  const ShardInput* sb=(const ShardInput*)b;
+  return((sa->shard>sb->shard)-(sa->shard<sb->shard));
+}
+
+
+/** Returns 1 if the current event of input a has to be written
+    before the current event of input b. Events with the same time
+    are ordered according to the shard index, such that the merge is
+    deterministic. */
+static int isEarlier(const ShardInput* const input,
+		     const int a, const int b)
+{
+  if (input[a].event.time<input[b].event.time) return(1);
+  if (input[a].event.time>input[b].event.time) return(0);
+  return(a<b);
+}
+
+
+/** Restore the heap property of the priority queue of input files
+    starting at the given position. */
+static void siftDown(int* const heap, const int nheap, int pos,
+		     const ShardInput* const input)
+{
+  while (2*pos+1<nheap) {
+    int child=2*pos+1;
+    if ((child+1<nheap)&&(isEarlier(input, heap[child+1], heap[child]))) {
+      child++;
+    }
+    if (!isEarlier(input, heap[child], heap[pos])) break;
+    int tmp=heap[pos];
+    heap[pos]=heap[child];
+    heap[child]=tmp;
+    pos=child;
+  }
+}
+
+
+/** Read the next event from the input file. Returns 0 if no further
+    events are available. */
+static int nextShardEvent(ShardInput* const input, int* const status)
+{
+  if (input->row>input->file->nrows) {
+    return(0);
+  }
+  getEventFromFile(input->file, input->row, &input->event, status);
+  CHECK_STATUS_RET(*status, 0);
+  input->interval=getShardInterval(input->gti, input->interval,
+				   input->event.time);
+  shiftPhID(&input->event, input->ph_id_offset[input->interval]);
+  input->evtrow=input->row;
+  input->row++;
+  return(1);
+}
+
+
+/** Check that the event table of the file has the same columns as the
+    table of the first file, such that its rows can be copied to the
+    merged file. */
+static void checkShardColumns(EventFile* const templ, EventFile* const file,
+			      const char* const filename, int* const status)
+{
+  CHECK_STATUS_VOID(*status);
+
+  int ncols0=0, ncols=0;
+  long width0=0, width=0;
+  fits_get_num_cols(templ->fptr, &ncols0, status);
+  fits_get_num_cols(file->fptr, &ncols, status);
+  fits_read_key(templ->fptr, TLONG, "NAXIS1", &width0, NULL, status);
+  fits_read_key(file->fptr, TLONG, "NAXIS1", &width, NULL, status);
+  CHECK_STATUS_VOID(*status);
+
+  int match=((ncols0==ncols)&&(width0==width));
+  int ii;
+  for (ii=1; match&&(ii<=ncols); ii++) {
+    const char* const keys[]={"TTYPE", "TFORM"};
+    int kk;
+    for (kk=0; kk<2; kk++) {
+      char keyname[FLEN_KEYWORD], value0[FLEN_VALUE], value[FLEN_VALUE];
+      fits_make_keyn(keys[kk], ii, keyname, status);
+      fits_read_key(templ->fptr, TSTRING, keyname, value0, NULL, status);
+      fits_read_key(file->fptr, TSTRING, keyname, value, NULL, status);
+      CHECK_STATUS_VOID(*status);
+      if (0!=strcmp(value0, value)) {
+	match=0;
+      }
+    }
+  }
+
+  if (!match) {
+    char msg[MAXMSG];
+    sprintf(msg, "event table of '%s' has different columns than the "
+	    "first file", filename);
+    SIXT_ERROR(msg);
+    *status=EXIT_FAILURE;
+  }
+}
+
+
+static int compareGTIInterval(const void* a, const void* b)
+{
+  const double* ia=(const double*)a;
+  const double* ib=(const double*)b;
+  return((ia[0]>ib[0])-(ia[0]<ib[0]));
+}
+
+
+/** Combine the GTI collections of the individual shards. Adjacent
+    intervals (e.g., chunks of the same original interval) are joined
+    again. */
+static GTI* mergeShardGTIs(const ShardInput* const input, const int ninputs,
+			   int* const status)
+{
+  GTI* gti=newGTI(status);
+  CHECK_STATUS_RET(*status, gti);
+  gti->mjdref  =input[0].gti->mjdref;
+  gti->timezero=input[0].gti->timezero;
+
+  long ntotal=0;
+  int ii;
+  for (ii=0; ii<ninputs; ii++) {
+    if (fabs(input[ii].gti->mjdref-gti->mjdref)>1.e-10) {
+      SIXT_ERROR("shards have different MJDREF values");
+      *status=EXIT_FAILURE;
+      return(gti);
+    }
+    ntotal+=input[ii].gti->ngti;
+  }
+  if (0==ntotal) {
+    return(gti);
+  }
+
+  // List of all intervals as (start, stop) pairs.
+  double* intervals=(double*)malloc(2*ntotal*sizeof(double));
+  CHECK_NULL_RET(intervals, *status,
+		 "memory allocation for GTI intervals failed", gti);
+  long nn=0;
+  for (ii=0; ii<ninputs; ii++) {
+    int jj;
+    for (jj=0; jj<input[ii].gti->ngti; jj++) {
+      intervals[2*nn]  =input[ii].gti->start[jj];
+      intervals[2*nn+1]=input[ii].gti->stop[jj];
+      nn++;
+    }
+  }
+  qsort(intervals, ntotal, 2*sizeof(double), compareGTIInterval);
+
+  double start=intervals[0], stop=intervals[1];
+  for (nn=1; nn<ntotal; nn++) {
+    if (intervals[2*nn]<=stop) {
+      stop=MAX(stop, intervals[2*nn+1]);
+    } else {
+      appendGTI(gti, start, stop, status);
+      CHECK_STATUS_BREAK(*status);
+      start=intervals[2*nn];
+      stop =intervals[2*nn+1];
+    }
+  }
+  if (EXIT_SUCCESS==*status) {
+    appendGTI(gti, start, stop, status);
+  }
+
+  free(intervals);
+  return(gti);
+}
+
+
+/** Create the output file with the headers of the given event file
+    and an empty event table with the same columns. The file is
+    positioned at the event table. */
+static fitsfile* createMergedFile(const char* const filename,
+				  EventFile* const templ,
+				  const int clobber,
+				  int* const status)
+{
+  CHECK_STATUS_RET(*status, NULL);
+
+  // Check if the file already exists.
+  int exists;
+  fits_file_exists(filename, &exists, status);
+  CHECK_STATUS_RET(*status, NULL);
+  if (0!=exists) {
+    if (0!=clobber) {
+      // Delete the file.
+      remove(filename);
+    } else {
+      // Throw an error.
+      char msg[MAXMSG];
+      sprintf(msg, "file '%s' already exists", filename);
+      SIXT_ERROR(msg);
+      *status=EXIT_FAILURE;
+      return(NULL);
+    }
+  }
+
+  fitsfile* fptr=NULL;
+  fits_create_file(&fptr, filename, status);
+  CHECK_STATUS_RET(*status, NULL);
+
+  // Copy the primary HDU and the header of the event extension.
+  int hdunum, hdutype;
+  fits_get_hdu_num(templ->fptr, &hdunum);
+  fits_movabs_hdu(templ->fptr, 1, &hdutype, status);
+  fits_copy_hdu(templ->fptr, fptr, 0, status);
+  fits_movabs_hdu(templ->fptr, hdunum, &hdutype, status);
+  fits_copy_header(templ->fptr, fptr, status);
+  CHECK_STATUS_RET(*status, NULL);
+
+  long nrows=0;
+  fits_get_num_rows(fptr, &nrows, status);
+  if (nrows>0) {
+    fits_delete_rows(fptr, 1, nrows, status);
+  }
+
+  // The merged file does not belong to an individual shard.
+  fits_write_errmark();
+  int status2=EXIT_SUCCESS;
+  fits_delete_key(fptr, "SHARD", &status2);
+  status2=EXIT_SUCCESS;
+  fits_delete_key(fptr, "NSHARDS", &status2);
+  fits_clear_errmark();
+
+  return(fptr);
+}
+
+
+int shardmerge_main() {
+  // Containing all programm parameters read by PIL
+  struct Parameters par;
+  par.EvtFiles=NULL;
+
+  // Input files of the individual shards.
+  name_list_t* filenames=NULL;
+  ShardInput* input=NULL;
+  int ninputs=0;
+
+  // Priority queue of the input files ordered by the time of their
+  // next event.
+  int* heap=NULL;
+
+  // Merged output file.
+  fitsfile* outfptr=NULL;
+  long nout=0;
+  GTI* gti=NULL;
+
+  // Error status.
+  int status=EXIT_SUCCESS;
+
+  // Register HEATOOL:
+  set_toolname("shardmerge");
+  set_toolversion("0.01");
+
+  do { // Beginning of the ERROR handling loop (will at most be run once).
+
+    // --- Initialization ---
+    headas_chat(3, "initialization ...\n");
+
+    // Read parameters using PIL library:
+    status=shardmerge_getpar(&par);
+    CHECK_STATUS_BREAK(status);
+
+    filenames=split_list(par.EvtFiles, DELIM);
+    CHECK_NULL_BREAK(filenames, status, "splitting the list of input files failed");
+
+    input=(ShardInput*)malloc(filenames->num*sizeof(ShardInput));
+    CHECK_NULL_BREAK(input, status, "memory allocation for input files failed");
+    int ii;
+    for (ii=0; ii<filenames->num; ii++) {
+      input[ii].file=NULL;
+      input[ii].gti=NULL;
+      input[ii].shard=-1;
+      input[ii].ph_id_min=NULL;
+      input[ii].ph_id_max=NULL;
+      input[ii].ph_id_offset=NULL;
+      input[ii].interval=0;
+      input[ii].row=1;
+      input[ii].evtrow=0;
+    }
+    heap=(int*)malloc(filenames->num*sizeof(int));
+    CHECK_NULL_BREAK(heap, status, "memory allocation for priority queue failed");
+
+    // Open the input files and determine their shard indices.
+    int nshards=-1;
+    double tstart=0., tstop=0.;
+    for (ninputs=0; ninputs<filenames->num; ninputs++) {
+      ShardInput* in=&input[ninputs];
+      in->file=openEventFile(filenames->names[ninputs], READONLY, &status);
+      CHECK_STATUS_BREAK(status);
+      if (ninputs>0) {
+	checkShardColumns(input[0].file, in->file, filenames->names[ninputs], &status);
+	CHECK_STATUS_BREAK(status);
+      }
+
+      int shardkeys=EXIT_SUCCESS;
+      int nsh=-1;
+      fits_write_errmark();
+      fits_read_key(in->file->fptr, TINT, "SHARD", &in->shard, NULL, &shardkeys);
+      fits_read_key(in->file->fptr, TINT, "NSHARDS", &nsh, NULL, &shardkeys);
+      fits_clear_errmark();
+      if (EXIT_SUCCESS!=shardkeys) {
+	in->shard=-1;
+	nsh=-1;
+      }
+      if (0==ninputs) {
+	nshards=nsh;
+      } else if (nsh!=nshards) {
+	char msg[MAXMSG];
+	sprintf(msg, "file '%s' belongs to a different sharded run",
+		filenames->names[ninputs]);
+	SIXT_ERROR(msg);
+	status=EXIT_FAILURE;
+	break;
+      }
+
+      double t0, t1;
+      fits_read_key(in->file->fptr, TDOUBLE, "TSTART", &t0, NULL, &status);
+      fits_read_key(in->file->fptr, TDOUBLE, "TSTOP", &t1, NULL, &status);
+      CHECK_STATUS_BREAK(status);
+      if ((0==ninputs)||(t0<tstart)) tstart=t0;
+      if ((0==ninputs)||(t1>tstop)) tstop=t1;
+
+      in->gti=loadGTI(filenames->names[ninputs], &status);
+      CHECK_STATUS_BREAK(status);
+    }
+    CHECK_STATUS_BREAK(status);
+
+    // Bring the files into the order of the shard indices and check
+    // that every shard is contained exactly once.
+    if (nshards>0) {
+      qsort(input, ninputs, sizeof(ShardInput), compareShardInput);
+      for (ii=0; ii<ninputs; ii++) {
+	if ((ii>0)&&(input[ii].shard==input[ii-1].shard)) {
+	  char msg[MAXMSG];
+	  sprintf(msg, "shard %d is contained more than once", input[ii].shard);
+	  SIXT_ERROR(msg);
+	  status=EXIT_FAILURE;
+	  break;
+	}
+      }
+      CHECK_STATUS_BREAK(status);
+      if (ninputs!=nshards) {
+	char msg[MAXMSG];
+	sprintf(msg, "only %d of %d shards are merged", ninputs, nshards);
+	SIXT_WARNING(msg);
+      }
+    }
+
+    // Determine the photon ID offsets, such that the IDs of the
+    // different shards do not overlap and increase with time.
+    for (ii=0; ii<ninputs; ii++) {
+      getPhIDRanges(&input[ii], &status);
+      CHECK_STATUS_BREAK(status);
+    }
+    CHECK_STATUS_BREAK(status);
+    setPhIDOffsets(input, ninputs, &status);
+    CHECK_STATUS_BREAK(status);
+
+    // Combine the GTIs.
+    gti=mergeShardGTIs(input, ninputs, &status);
+    CHECK_STATUS_BREAK(status);
+
+    // Set up the output file.
+    outfptr=createMergedFile(par.OutputFile, input[0].file, par.clobber, &status);
+    CHECK_STATUS_BREAK(status);
+    int cph_id;
+    fits_get_colnum(outfptr, CASEINSEN, "PH_ID", &cph_id, &status);
+    CHECK_STATUS_BREAK(status);
+
+    // --- End of Initialization ---
+
+
+    // --- Merge the events ---
+    headas_chat(3, "merge events ...\n");
+
+    int nheap=0;
+    for (ii=0; ii<ninputs; ii++) {
+      if (nextShardEvent(&input[ii], &status)) {
+	heap[nheap++]=ii;
+      }
+      CHECK_STATUS_BREAK(status);
+    }
+    CHECK_STATUS_BREAK(status);
+    for (ii=nheap/2-1; ii>=0; ii--) {
+      siftDown(heap, nheap, ii, input);
+    }
+
+    while (nheap>0) {
+      // Copy the complete row and replace the photon IDs.
+      ShardInput* in=&input[heap[0]];
+      fits_copy_rows(in->file->fptr, outfptr, in->evtrow, 1, &status);
+      nout++;
+      fits_write_col(outfptr, TLONG, cph_id, nout, 1, NEVENTPHOTONS,
+		     in->event.ph_id, &status);
+      CHECK_STATUS_BREAK(status);
+
+      if (!nextShardEvent(in, &status)) {
+	heap[0]=heap[--nheap];
+      }
+      CHECK_STATUS_BREAK(status);
+      siftDown(heap, nheap, 0, input);
+    }
+    CHECK_STATUS_BREAK(status);
+
+    // --- Update the header information ---
+
+    int hdutype;
+    for (ii=1; ii<=2; ii++) {
+      fits_movabs_hdu(outfptr, ii, &hdutype, &status);
+      fits_update_key(outfptr, TDOUBLE, "TSTART", &tstart, NULL, &status);
+      fits_update_key(outfptr, TDOUBLE, "TSTOP", &tstop, NULL, &status);
+    }
+    CHECK_STATUS_BREAK(status);
+
+    // If available, update the exposure time.
+    double exposure;
+    int status2=EXIT_SUCCESS;
+    fits_write_errmark();
+    fits_read_key(outfptr, TDOUBLE, "EXPOSURE", &exposure, NULL, &status2);
+    fits_clear_errmark();
+    if (EXIT_SUCCESS==status2) {
+      exposure=sumGTI(gti);
+      fits_update_key(outfptr, TDOUBLE, "EXPOSURE", &exposure, NULL, &status);
+      CHECK_STATUS_BREAK(status);
+    }
+
+    // Store the combined GTI extension.
+    saveGTIExt(outfptr, "STDGTI", gti, &status);
+    CHECK_STATUS_BREAK(status);
+
+    // Move back to the event extension for the check sum.
+    fits_movabs_hdu(outfptr, 2, &hdutype, &status);
+    CHECK_STATUS_BREAK(status);
+
+    headas_chat(3, "merged %ld events from %d files\n", nout, ninputs);
+
+  } while (0); // END of the error handling loop.
+
+  // --- Cleaning up ---
+  headas_chat(3, "cleaning up ...\n");
+
+  if (NULL!=outfptr) fits_close_file(outfptr, &status);
+  freeGTI(&gti);
+  if (NULL!=filenames) {
+    if (NULL!=input) {
+      int ii;
+      for (ii=0; ii<filenames->num; ii++) {
+	freeEventFile(&input[ii].file, &status);
+	freeGTI(&input[ii].gti);
+	free(input[ii].ph_id_min);
+	free(input[ii].ph_id_max);
+	free(input[ii].ph_id_offset);
+      }
+    }
+    destroy_name_list(filenames);
+  }
+  free(input);
+  free(heap);
+  free(par.EvtFiles);
+
+  if (EXIT_SUCCESS==status) {
+    headas_chat(3, "finished successfully!\n\n");
+    return(EXIT_SUCCESS);
+  } else {
+    return(EXIT_FAILURE);
+  }
+}
+
+
+int shardmerge_getpar(struct Parameters* const par)
+{
+  int status=EXIT_SUCCESS;
+
+  query_simput_parameter_string("EvtFiles", &par->EvtFiles, &status);
+  query_simput_parameter_file_name_buffer("OutputFile", par->OutputFile, MAXFILENAME, &status);
+  query_simput_parameter_bool("clobber", &par->clobber, &status);
+
+  return(status);
+}
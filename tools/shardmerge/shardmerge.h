@@ -0,0 +1,101 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2015-2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                       Erlangen-Nuernberg
+*/
+
+#ifndef SHARDMERGE_H
+#define SHARDMERGE_H 1
+
+
+#include "sixt.h"
+#include "event.h"
+#include "eventfile.h"
+#include "gti.h"
+#include "namelist.h"
+#include "parinput.h"
+
+#define TOOLSUB shardmerge_main
+#include "headas_main.c"
+
+
+////////////////////////////////////////////////////////////////////////
+// Type declarations.
+////////////////////////////////////////////////////////////////////////
+
+
+struct Parameters {
+  /** Comma-separated list of the event files of the individual
+      shards. */
+  char* EvtFiles;
+  /** Merged output event file. */
+  char OutputFile[MAXFILENAME];
+
+  int clobber;
+};
+
+
+/** Input event file of an individual shard. */
+typedef struct {
+  EventFile* file;
+
+  /** Shard index according to the SHARD header keyword (-1 if not
+      available). */
+  int shard;
+
+  /** GTI collection of this shard. */
+  GTI* gti;
+
+  /** Smallest and largest absolute photon ID of the events in the
+      individual GTI intervals of this shard (0 if the interval does
+      not contain any events), and the offset that is added to these
+      photon IDs in the merged file. */
+  long* ph_id_min;
+  long* ph_id_max;
+  long* ph_id_offset;
+
+  /** GTI interval of the current event. */
+  int interval;
+
+  /** Next row to be read, and the row and the data of the current
+      event. */
+  long row;
+  long evtrow;
+  Event event;
+} ShardInput;
+
+
+/** GTI interval of an individual shard, which is used to number the
+    photons of all shards in the order of time. */
+typedef struct {
+  double start;
+  int input;
+  int interval;
+} ShardInterval;
+
+
+////////////////////////////////////////////////////////////////////////
+// Function declarations.
+////////////////////////////////////////////////////////////////////////
+
+
+// Reads the program parameters using PIL
+int shardmerge_getpar(struct Parameters* const par);
+
+
+#endif /* SHARDMERGE_H */
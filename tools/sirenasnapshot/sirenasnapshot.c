@@ -0,0 +1,191 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+*/
+
+#include "sirenasnapshot.h"
+
+
+// Converts a SIRENA library FITS file into a binary snapshot which
+// can be given as LibraryFile to tesreconstruction (and xifupipeline).
+// The library is loaded as in the reconstruction (opmode=1) with the
+// given parameters, which must be the same as the ones of the runs
+// using the snapshot. The snapshot is mapped into memory instead of
+// being read, so its pages are only loaded when they are used and
+// they are shared between concurrent reconstruction processes.
+
+
+////////////////////////////////////
+/** Main procedure. */
+int sirenasnapshot_main() {
+  time_t ttstart = time(0);
+
+  // Containing all programm parameters read by PIL.
+  struct Parameters par;
+
+  // Error status.
+  int status=EXIT_SUCCESS;
+
+  // Register HEATOOL:
+  set_toolname("sirenasnapshot");
+  set_toolversion("0.01");
+
+  do { // Beginning of the ERROR handling loop (will at
+       // most be run once).
+    headas_chat(3, "initialize ...\n");
+    // Get program parameters.
+    status=getpar(&par);
+    CHECK_STATUS_BREAK(status);
+
+    headas_chat(3, "write library snapshot ...\n");
+    createLibrarySnapshotSIRENA(par.LibraryFile, par.SnapshotFile, par.PulseLength,
+				par.FilterDomain, par.FilterMethod, par.EnergyMethod,
+				par.filtEev, par.OFNoise, par.LagsOrNot, par.OFLib,
+				par.OFInterp, par.preBuffer, par.hduPRECALWN,
+				par.hduPRCLOFWM, par.clobber, &status);
+    CHECK_STATUS_BREAK(status);
+
+  } while(0); // END of the error handling loop.
+
+  time_t ttcurrent = time(0);
+  printf("Elapsed time: %f\n", ((float)(ttcurrent - ttstart)));
+  if (EXIT_SUCCESS==status)
+  {
+	headas_chat(3, "finished successfully!\n\n");
+	return(EXIT_SUCCESS);
+  }
+  else
+  {
+	return(status);
+  }
+}
+
+int getpar(struct Parameters* const par)
+{
+  // String input buffer.
+  char* sbuffer=NULL;
+
+  // Error status.
+  int status=EXIT_SUCCESS;
+
+  status=ape_trad_query_string("LibraryFile", &sbuffer);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the name of the library file");
+    return(status);
+  }
+  strcpy(par->LibraryFile, sbuffer);
+  free(sbuffer);
+
+  status=ape_trad_query_string("SnapshotFile", &sbuffer);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the name of the snapshot file");
+    return(status);
+  }
+  strcpy(par->SnapshotFile, sbuffer);
+  free(sbuffer);
+
+  status=ape_trad_query_int("PulseLength", &par->PulseLength);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the PulseLength parameter");
+    return(status);
+  }
+  if (par->PulseLength <= 0) {
+    SIXT_ERROR("parameter error: PulseLength must be greater than 0");
+    return(EXIT_FAILURE);
+  }
+
+  status=ape_trad_query_string("FilterDomain", &sbuffer);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the FilterDomain parameter");
+    return(status);
+  }
+  strncpy(par->FilterDomain, sbuffer, sizeof(par->FilterDomain)-1);
+  par->FilterDomain[sizeof(par->FilterDomain)-1]='\0';
+  free(sbuffer);
+
+  status=ape_trad_query_string("FilterMethod", &sbuffer);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the FilterMethod parameter");
+    return(status);
+  }
+  strncpy(par->FilterMethod, sbuffer, sizeof(par->FilterMethod)-1);
+  par->FilterMethod[sizeof(par->FilterMethod)-1]='\0';
+  free(sbuffer);
+
+  status=ape_trad_query_string("EnergyMethod", &sbuffer);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the EnergyMethod parameter");
+    return(status);
+  }
+  strncpy(par->EnergyMethod, sbuffer, sizeof(par->EnergyMethod)-1);
+  par->EnergyMethod[sizeof(par->EnergyMethod)-1]='\0';
+  free(sbuffer);
+
+  status=ape_trad_query_double("filtEeV", &par->filtEev);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the filtEeV parameter");
+    return(status);
+  }
+
+  status=ape_trad_query_string("OFNoise", &sbuffer);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the OFNoise parameter");
+    return(status);
+  }
+  strncpy(par->OFNoise, sbuffer, sizeof(par->OFNoise)-1);
+  par->OFNoise[sizeof(par->OFNoise)-1]='\0';
+  free(sbuffer);
+
+  status=ape_trad_query_int("LagsOrNot", &par->LagsOrNot);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the LagsOrNot parameter");
+    return(status);
+  }
+
+  status=ape_trad_query_bool("OFLib", &par->OFLib);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the OFLib parameter");
+    return(status);
+  }
+
+  // As in tesreconstruction
+  strcpy(par->OFInterp, "DAB");
+
+  status=ape_trad_query_int("preBuffer", &par->preBuffer);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the preBuffer parameter");
+    return(status);
+  }
+
+  status=ape_trad_query_bool("hduPRECALWN", &par->hduPRECALWN);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the hduPRECALWN parameter");
+    return(status);
+  }
+
+  status=ape_trad_query_bool("hduPRCLOFWM", &par->hduPRCLOFWM);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the hduPRCLOFWM parameter");
+    return(status);
+  }
+
+  status=ape_trad_query_bool("clobber", &par->clobber);
+  if (EXIT_SUCCESS!=status) {
+    SIXT_ERROR("failed reading the clobber parameter");
+    return(status);
+  }
+
+  return(status);
+}
@@ -0,0 +1,79 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SIRENASNAPSHOT_H
+#define SIRENASNAPSHOT_H 1
+
+#include "sixt.h"
+#include "libsnapshotSIRENA.h"
+
+#define TOOLSUB sirenasnapshot_main
+#include "headas_main.c"
+
+#include "versionSIRENA.h"
+
+struct Parameters {
+	//File containing the library
+	char LibraryFile[MAXFILENAME];
+
+	//Output binary snapshot of the library
+	char SnapshotFile[MAXFILENAME];
+
+	//
+	// Parameters of the tesreconstruction runs which will use the snapshot
+	//
+	//Pulse Length
+	int PulseLength;
+
+	//Filtering Domain: Time(T) or Frequency(F)
+	char FilterDomain[2];
+
+	//Filtering Method: F0 (deleting the zero frequency bin) or B0 (deleting the baseline)
+	char FilterMethod[3];
+
+	//Energy Method: OPTFILT, WEIGHT, WEIGHTN, I2R, I2RALL, I2RNOL, I2RFITTED or PCA
+	char EnergyMethod[10];
+
+	//Energy of the filters of the library to be used to calculate energy
+	double filtEev;
+
+	//Noise to use with Optimal Filtering: NSD (Noise Spectral Density) or WEIGHTM (weight matrix)
+	char OFNoise[8];
+
+	//LagsOrNot: LAGS == 1 or NOLAGS == 0
+	int LagsOrNot;
+
+	//Boolean to choose whether to use a library with optimal filters or calculate the optimal filter to each pulse
+	char OFLib;
+
+	//Optimal Filter by using the Matched Filter (MF) or the DAB as matched filter (fixed to DAB as in tesreconstruction)
+	char OFInterp[4];
+
+	//Samples added before the starting time of a pulse
+	int preBuffer;
+
+	//Booleans hduPRECALWN and hduPRCLOFWM of tesreconstruction
+	char hduPRECALWN;
+	char hduPRCLOFWM;
+
+	//Boolean to choose whether to erase an already existing snapshot
+	char clobber;
+};
+
+int getpar(struct Parameters* const par);
+
+#endif /* SIRENASNAPSHOT_H */
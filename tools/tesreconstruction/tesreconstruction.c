@@ -34,6 +34,7 @@ int tesreconstruction_main() {
   // Register HEATOOL:
   set_toolname("tesreconstruction");
   set_toolversion("0.05");
+  initSixtProfiling("tesreconstruction");
   
   do { // Beginning of the ERROR handling loop (will at
        // most be run once).
@@ -661,6 +662,8 @@ int tesreconstruction_main() {
     CHECK_STATUS_BREAK(status);
  
   } while(0); // END of the error handling loop.
+
+  writeSixtProfiling();
   
   if (EXIT_SUCCESS==status) 
   {
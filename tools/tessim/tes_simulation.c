@@ -157,6 +157,31 @@ double TES_sde_noise(double X[], int k, int j, void *params) {
 	return val;
 }
 
+// Drift vector and noise terms for the specialized stochastic integrator.
+// Identical to TES_sde_deterministic and TES_sde_noise, but evaluated
+// for all components at once (b[k][j-1] corresponds to noise term j).
+void TES_sde_coefficients(tesparams *tes, const double X[],
+	double a[TES_SDE_DIM], double b[TES_SDE_DIM][TES_SDE_NOISE_TERMS]) {
+
+	double II = X[0];
+	double TT = X[1];
+	double RT = tes->RTI(tes,X);
+
+	a[0] = (tes->V0-II*(tes->Reff+RT))/tes->Leff;
+	if (tes->acdc) {
+		a[0] = a[0]/2.;
+	}
+	a[1] = (II*II*RT-tes->Pb1+tes->En1+tes->pload+tes->Pcommon)/tes->Ce1;
+
+	double johnson = sqrt(2.*kBoltz*TT*RT);
+	b[0][0] = sqrt(2.*kBoltz*tes->Tb(tes)*tes->Reff)/tes->Leff;
+	b[0][1] = johnson/tes->Leff;
+	b[0][2] = 0;
+	b[1][0] = 0;
+	b[1][1] = II*johnson/tes->Ce1;
+	b[1][2] = sqrt(2.*kBoltz*TT*TT*tes->Gb1)/tes->Ce1;
+}
+
 int TES_jac (double time, const double Y[], double *dfdy, double dfdt[], void *params) {
 
   double II=Y[0];
@@ -665,6 +690,7 @@ tesparams *tes_init(tespxlparams *par,int *status) {
   tes->dobbfb = par->dobbfb;
   tes->decimation_filter = par->decimation_filter;
   tes->bbfb_info = NULL;
+  tes->bbfb_index = 0;
 
   if (tes->dobbfb){
 	tes->decimate_factor=(unsigned int) (1./(tes->sample_rate*par->bbfb_tclock)); // step size wrt. sample rate
@@ -716,6 +742,11 @@ tesparams *tes_init(tespxlparams *par,int *status) {
   tes->simnoise=par->simnoise;
   tes->twofluid=par->twofluid; //Option to use the twofluid model
   tes->stochastic_integrator=par->stochastic_integrator; //Option to use the stochastic integrator
+  tes->sde_workspace=NULL;
+  if (tes->stochastic_integrator) {
+    tes->sde_workspace=tes_sde_init_workspace(status);
+    CHECK_STATUS_RET(*status,NULL);
+  }
   //TODO Change if more models become available
 
   //Handle the frame hit
@@ -835,6 +866,14 @@ tesparams *tes_init(tespxlparams *par,int *status) {
 
   tes->readoutMode = par->readoutMode;
 
+  // linearised model for the quiescent periods between impacts
+  // (not compatible with the time dependent bath temperature of frame hits)
+  tes->quiescent_info=NULL;
+  if (par->quiescent_tol>0. && tes->frame_hit==0) {
+    tes->quiescent_info=tes_init_quiescent(tes,par->quiescent_tol,status);
+    CHECK_STATUS_RET(*status,NULL);
+  }
+
   return(tes);
 }
 
@@ -858,6 +897,14 @@ void tes_free(tesparams *tes) {
   free(tes->odesys);
   tes->odesys=NULL;
 
+  tes_sde_workspace *sde_workspace=(tes_sde_workspace *) tes->sde_workspace;
+  tes_sde_free_workspace(&sde_workspace);
+  tes->sde_workspace=NULL;
+
+  tes_quiescent_info *quiescent_info=(tes_quiescent_info *) tes->quiescent_info;
+  tes_free_quiescent(&quiescent_info);
+  tes->quiescent_info=NULL;
+
   free(tes->impact);
   tes->impact=NULL;
 
@@ -867,7 +914,7 @@ void tes_free(tesparams *tes) {
 //
 // logic problem in multiple calls: a photon read here that is
 // after tstop will get lost
-int tes_propagate(AdvDet *det, double tstop, int *status) {
+static int tes_propagate_pixels(AdvDet *det, double tstop, int *status) {
   CHECK_STATUS_RET(*status,-1);
   // Setup
   unsigned long samplestep[det->npix];
@@ -948,59 +995,80 @@ int tes_propagate(AdvDet *det, double tstop, int *status) {
       double Y[2];
       Y[0]=tes->I0; // current
       Y[1]=tes->T1; // temperature
-      double dRdI=tes->dRdI(tes, Y); //To reduce computational time!
-
-      if (tes->simnoise) {
-        // thermal noise
-        tes->Pnb1=tnoi(tes);
-
-        // Johnson noise terms
-        // (this should now be ok for the excess noise, but needs somebody
-        // else to check this again to be 100% sure)
-        tes->Vdn =gsl_ran_gaussian(rng,sqrt(4.*kBoltz*tes->T1*tes->RT*tes->bandwidth));
-        tes->Vexc=gsl_ran_gaussian(rng,sqrt(4.*kBoltz*tes->T1*tes->RT*tes->bandwidth*2.*dRdI*tes->I0/tes->RT));
-        tes->Vcn =gsl_ran_gaussian(rng,sqrt(4.*kBoltz*tes->Tb(tes)*tes->Reff*tes->bandwidth));
-        tes->Vunk=gsl_ran_gaussian(rng,sqrt(4.*kBoltz*tes->T1*tes->RT*tes->bandwidth*(1.+2*dRdI*tes->I0/tes->RT)*tes->m_excess*tes->m_excess) );
-        tes->Vbn=gsl_ran_gaussian(rng,tes->bias_noise*sqrt(tes->bandwidth));
+      // Between impacts, propagate with the linearised model while
+      // the TES is close to its operating point (not with crosstalk)
+      tes_quiescent_info *qs=(tes_quiescent_info *) tes->quiescent_info;
+      int quiescent=0;
+      if (qs!=NULL && !(det->npix>1 && det->readout_channels != NULL)) {
+        quiescent=tes_is_quiescent(tes,Y);
+        if (!quiescent && qs->active) {
+          // system properties have not been updated during the linear steps
+          tes->RT=tes->RTI(tes, Y);
+          tes->Pb1=tpow(tes);
+          qs->active=0;
+        }
       }
 
-      // absorb next photon?
-      tes->En1=0.;
-      tes->n_absorbed=0;
-      // This while loop handles pileup correctly
-      // i.e. if two photons arrive within one delta_t
-      // their energies are summed up
-      while (tes->time>=tes->impact->time) {
-        tes->Nevts++;
-        tes->n_absorbed++;
-        // increase En1 (note the +=)
-        tes->En1+=tes->impact->energy*keV/(tes->delta_t*tes->therm);
-
-        // remember that we've processed this photon
-        if (tes->write_photon!=NULL) {
-          tes->write_photon(tes,tes->impact->time,tes->impact->ph_id,status);
+      int s = GSL_SUCCESS;
+      if (quiescent) {
+        tes->En1=0.;
+        tes->n_absorbed=0;
+        tes_quiescent_step(tes,Y,rng);
+      } else {
+        double dRdI=tes->dRdI(tes, Y); //To reduce computational time!
+
+        if (tes->simnoise) {
+          // thermal noise
+          tes->Pnb1=tnoi(tes);
+
+          // Johnson noise terms
+          // (this should now be ok for the excess noise, but needs somebody
+          // else to check this again to be 100% sure)
+          tes->Vdn =gsl_ran_gaussian(rng,sqrt(4.*kBoltz*tes->T1*tes->RT*tes->bandwidth));
+          tes->Vexc=gsl_ran_gaussian(rng,sqrt(4.*kBoltz*tes->T1*tes->RT*tes->bandwidth*2.*dRdI*tes->I0/tes->RT));
+          tes->Vcn =gsl_ran_gaussian(rng,sqrt(4.*kBoltz*tes->Tb(tes)*tes->Reff*tes->bandwidth));
+          tes->Vunk=gsl_ran_gaussian(rng,sqrt(4.*kBoltz*tes->T1*tes->RT*tes->bandwidth*(1.+2*dRdI*tes->I0/tes->RT)*tes->m_excess*tes->m_excess) );
+          tes->Vbn=gsl_ran_gaussian(rng,tes->bias_noise*sqrt(tes->bandwidth));
         }
 
-        // get the next photon
-        int success=tes->get_photon(tes->impact,tes->photoninfo,status);
-        CHECK_STATUS_RET(*status,-1);
-        if (success==0) {
-          // there is no further photon to read. Set next impact time to
-          // a time outside much after this
-          tes->impact->time=tstop+100.;
+        // absorb next photon?
+        tes->En1=0.;
+        tes->n_absorbed=0;
+        // This while loop handles pileup correctly
+        // i.e. if two photons arrive within one delta_t
+        // their energies are summed up
+        while (tes->time>=tes->impact->time) {
+          tes->Nevts++;
+          tes->n_absorbed++;
+          SIXT_PROF_COUNT(SIXT_PROF_IMPACTS,1);
+          // increase En1 (note the +=)
+          tes->En1+=tes->impact->energy*keV/(tes->delta_t*tes->therm);
+
+          // remember that we've processed this photon
+          if (tes->write_photon!=NULL) {
+            tes->write_photon(tes,tes->impact->time,tes->impact->ph_id,status);
+          }
+
+          // get the next photon
+          int success=tes->get_photon(tes->impact,tes->photoninfo,status);
+          CHECK_STATUS_RET(*status,-1);
+          if (success==0) {
+            // there is no further photon to read. Set next impact time to
+            // a time outside much after this
+            tes->impact->time=tstop+100.;
+          }
+        }
+        if (tes->stochastic_integrator) {
+          // number of noise terms included in the stochastic differential equation system
+          int noise_terms = 0;
+          if (tes->simnoise) {
+            noise_terms = TES_SDE_NOISE_TERMS;
+          }
+          s=tes_sde_step(tes,noise_terms,Y,rng);
+        } else {
+          s=gsl_odeiv2_driver_apply_fixed_step(tes->odedriver,&(tes->time),tes->delta_t,1,Y);
         }
       }
-      int s = GSL_SUCCESS;
-      if (tes->stochastic_integrator) {
-		  // number of noise terms included in the stochastic differential equation system
-		  int noise_terms = 0;
-		  if (tes->simnoise) {
-			  noise_terms = 3;
-		  }
-		  s=sde_step(TES_sde_deterministic,TES_sde_noise,2,noise_terms,Y,tes->delta_t,rng,tes);
-	  } else {
-		  s=gsl_odeiv2_driver_apply_fixed_step(tes->odedriver,&(tes->time),tes->delta_t,1,Y);
-	  }
       samples[ii]++;
       step_nb[ii]++;
 
@@ -1014,14 +1082,15 @@ int tes_propagate(AdvDet *det, double tstop, int *status) {
       tes->I0=Y[0];
       tes->T1=Y[1];
 
-      // Update system properties
+      // Update system properties (not needed by the linearised model)
+      if (!quiescent) {
+        // New resistance value assuming a simple
+        // linear transition with alpha and beta dependence
+        tes->RT=tes->RTI(tes, Y);//tes->R0+tes->dRdT(tes)*(tes->T1-tes->T_start)+tes->dRdI(tes)*(tes->I0-tes->I0_start);
 
-      // New resistance value assuming a simple
-      // linear transition with alpha and beta dependence
-      tes->RT=tes->RTI(tes, Y);//tes->R0+tes->dRdT(tes)*(tes->T1-tes->T_start)+tes->dRdI(tes)*(tes->I0-tes->I0_start);
-
-      // thermal power flow
-      tes->Pb1=tpow(tes);
+        // thermal power flow
+        tes->Pb1=tpow(tes);
+      }
     }
 
     // Calculate FDM Crosstalk.
@@ -1036,12 +1105,14 @@ int tes_propagate(AdvDet *det, double tstop, int *status) {
       tesparams *tes = det->pix[ii].tes;
 
 
-      // TODO: BBFB loop is simulated here at pixel level whereas it should be done at channel level
+      // BBFB loop is simulated at channel level: it is run for all pixels
+      // of the channel when reaching its first pixel (all pixels have
+      // already been propagated), the other pixels get its output
       double bbfb_output=0.0;
       if (tes->dobbfb){
-    	// Need to apply SQUID noise before BBFB loop
+    	// Need to apply SQUID noise before BBFB loop (one SQUID per channel)
 		double squid_noise_value = 0;
-		if (tes->simnoise) {
+		if (tes->simnoise && tes->bbfb_index==0) {
 		  squid_noise_value=gsl_ran_gaussian(rng,tes->squid_noise*sqrt(tes->bandwidth));
 		}
     	bbfb_output = tes->apply_bbfb(tes,tes->time,tes->I0,squid_noise_value,rng);
@@ -1107,3 +1178,10 @@ int tes_propagate(AdvDet *det, double tstop, int *status) {
   }
   return(0);
 }
+
+int tes_propagate(AdvDet *det, double tstop, int *status) {
+  SIXT_PROF_BEGIN(SIXT_PROF_TES_PROPAGATE);
+  int ret=tes_propagate_pixels(det,tstop,status);
+  SIXT_PROF_END(SIXT_PROF_TES_PROPAGATE);
+  return(ret);
+}
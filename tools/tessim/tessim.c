@@ -41,9 +41,13 @@ int tessim_main() {
   // error status
   int status=EXIT_SUCCESS;
 
+  // blocks and thread shared by the writers of all trigger files
+  FitsWriterPool* writerpool=NULL;
+
   // register HEATOOL
   set_toolname("tessim");
   set_toolversion("0.02");
+  initSixtProfiling("tessim");
 
   do { // start of error handling loop
     // read parameters using PIL
@@ -56,8 +60,8 @@ int tessim_main() {
     tessim_getpar(&par,&det,&properties,&status);
     CHECK_STATUS_BREAK(status);
 
-    if (det->npix>1 && par.dobbfb){
-      SIXT_ERROR("Multipixel simulation and BBFB cannot be simulated together yet");
+    if (det->npix>1 && par.dobbfb && par.doCrosstalk && par.acdc){
+      SIXT_ERROR("FDM crosstalk and BBFB cannot be simulated together yet");
       return EXIT_FAILURE;
     }
 
@@ -111,8 +115,13 @@ int tessim_main() {
         loop_par.readoutMode = par.readoutMode;
         loop_par.twofluid = par.twofluid;
         loop_par.stochastic_integrator = par.stochastic_integrator;
+        loop_par.quiescent_tol = par.quiescent_tol;
         loop_par.frame_hit=0; //Setting to default false //TODO add to multi-tessim
-        loop_par.dobbfb=0; // Disabled for now in multitessim
+        // BBFB loops are run per readout channel (see below)
+        loop_par.dobbfb = par.dobbfb;
+        loop_par.decimation_filter = par.decimation_filter;
+        loop_par.bbfb_tclock = par.bbfb_tclock;
+        loop_par.M_in = par.M_in;
 
         // assign the actual pixid, input and output filename
         loop_par.id = det->pix[ii].pindex + 1; // id's start with 0 in advdet, but not in tessim...
@@ -247,17 +256,23 @@ int tessim_main() {
                                            par.write_doubles,
                                            &status);
           CHECK_STATUS_BREAK(status);
+          // the records are only appended from now on, with one writer
+          // thread and a fixed number of blocks for all pixels
+          if (writerpool==NULL) {
+            writerpool=newTesTriggerFileWriterPool(par.triggerSize,par.write_doubles,
+                                                   par.asyncwrite,&status);
+            CHECK_STATUS_BREAK(status);
+          }
+          startTesTriggerFileSharedWriter(((tes_trigger_info *) tes->streaminfo)->fptr,
+                                          writerpool,&status);
+          CHECK_STATUS_BREAK(status);
           tes->write_to_stream=&tes_append_trigger;
           tes->write_photon=NULL;
       }
       freeSixtStdKeywords(keywords);
 
-      // Initialize BBFB loop
-      // For architecture reasons, this is for the moment at tes level whereas it should actually be at channel level
-      // but this structure is not completely available yet
+      // BBFB loop (initialized below, at channel level)
       if (tes->dobbfb) {
-        tes->bbfb_info = init_timedomain_bbfb(par.bbfb_tclock,par.bbfb_delay,par.carrier_frequency,par.bbfb_gbw,0,
-        		par.bias_leakage*tes->I0_start,par.bias_leakage_phase,par.fb_leakage,par.fb_leakage_lag,tes->I0_start,&status);
         tes->apply_bbfb = &run_timedomain_bbfb_loop;
       }
 
@@ -302,6 +317,47 @@ int tessim_main() {
 
 
 
+    /** SET UP BBFB LOOPS */
+    // One loop per readout channel, with one carrier per pixel
+    ReadoutChannels* bbfb_channels=NULL;
+    if (par.dobbfb) {
+      if (det->npix==1) {
+        tesparams *tes=det->pix[0].tes;
+        timedomain_bbfb_info *bbfb=init_timedomain_bbfb(par.bbfb_tclock,par.bbfb_delay,par.bbfb_gbw,
+            par.fb_leakage,par.fb_leakage_lag,&status);
+        CHECK_STATUS_BREAK(status);
+        add_timedomain_bbfb_pixel(bbfb,tes,par.carrier_frequency,0,par.bias_leakage*tes->I0_start,
+            par.bias_leakage_phase,tes->I0_start,&status);
+        CHECK_STATUS_BREAK(status);
+      } else {
+        // channels and carrier frequencies are given by the channel file
+        bbfb_channels = get_readout_channels(det,&status);
+        if (status!= EXIT_SUCCESS){
+          SIXT_ERROR("failed when loading the readout channels");
+          return EXIT_FAILURE;
+        }
+        // pixels are added in the order of the detector, such that the first
+        // pixel of each loop is the first one to be propagated
+        timedomain_bbfb_info **bbfb_loops=(timedomain_bbfb_info**)calloc(bbfb_channels->num_channels,sizeof(*bbfb_loops));
+        CHECK_NULL_BREAK(bbfb_loops,status,"Memory allocation failed for the BBFB loops");
+        for (int ii=0; ii<det->npix; ii++){
+          int chan=det->pix[ii].channel->channel_id-1;
+          if (bbfb_loops[chan]==NULL) {
+            bbfb_loops[chan]=init_timedomain_bbfb(par.bbfb_tclock,par.bbfb_delay,par.bbfb_gbw,
+                par.fb_leakage,par.fb_leakage_lag,&status);
+            CHECK_STATUS_BREAK(status);
+          }
+          tesparams *tes=det->pix[ii].tes;
+          add_timedomain_bbfb_pixel(bbfb_loops[chan],tes,det->pix[ii].freq,0,par.bias_leakage*tes->I0_start,
+              par.bias_leakage_phase,tes->I0_start,&status);
+          CHECK_STATUS_BREAK(status);
+        }
+        free(bbfb_loops);
+        CHECK_STATUS_BREAK(status);
+        headas_chat(0,"Initialized BBFB loops of %d readout channels\n",bbfb_channels->num_channels);
+      }
+    }
+
     // set up the progress bar, but only for one pixel
     if (par.showprogress) {
       det->pix[0].tes->progressbar=progressbar_new("simulating",
@@ -331,12 +387,17 @@ int tessim_main() {
       }
 
       tes_free_impactlist((tes_impactfile_info **) &tes->photoninfo, &status);
+      if (tes->dobbfb && tes->bbfb_index==0) {
+        // the loop is shared by all pixels of the channel
+        free_timedomain_bbfb((timedomain_bbfb_info **) &tes->bbfb_info, &status);
+      }
       tes_free(tes);
       free(tes);
     }
 
     /** LOOP FOR MULTI TESSIM END */
 
+    freeReadoutChannels(bbfb_channels);
     destroyAdvDet(&det);
     free(par.type);
     free(par.impactlist);
@@ -351,6 +412,11 @@ int tessim_main() {
 
   } while(0); // end of error handling loop
 
+  // all trigger files have been closed (or are left behind after an error)
+  destroyFitsWriterPool(&writerpool,&status);
+
+  writeSixtProfiling();
+
   if (EXIT_SUCCESS==status) {
     headas_chat(3,"finished successfully!\n\n");
     return(EXIT_SUCCESS);
@@ -591,6 +657,8 @@ void tessim_getpar(tespxlparams *par, AdvDet **det, int *properties, int *status
 
   query_simput_parameter_bool("clobber", &par->clobber, status);
 
+  query_simput_parameter_bool("asyncwrite", &par->asyncwrite, status);
+
   // query parameter for calculating I0 via the thermal balance
   query_simput_parameter_bool("thermalBias", &par->thermal_bias, status);
 
@@ -720,6 +788,7 @@ void tessim_getpar(tespxlparams *par, AdvDet **det, int *properties, int *status
   //TODO Change keyword name when new models become available
   // readout mode is only not 'total' for crosstalk
   query_simput_parameter_bool("stochastic_integrator", &par->stochastic_integrator, status);
+  query_simput_parameter_double("quiescent_tol", &par->quiescent_tol, status);
 
   //Handling the frame impacts
   query_simput_parameter_bool("frame_hit", &par->frame_hit, status);
@@ -33,6 +33,7 @@
 #include "tespixel.h"
 #include "advdet.h"
 #include "crosstalk.h"
+#include "profiling.h"
 #include "tescrosstalk.h"
 
 #include <gsl/gsl_odeiv2.h>
@@ -94,10 +95,12 @@ typedef struct {
   int write_doubles; // option to write the records in doubles (irrelevant if triggertype=stream)
 
   int clobber;  // overwrite output files?
+  int asyncwrite; // write the trigger files in a background thread?
   int simnoise; // simulator noise
   int twofluid; // option to use the two fluid model transition
   //TODO Change this keyword once more models become available
   int stochastic_integrator; // option to use the stochastic integrator
+  double quiescent_tol; // relative tolerance for the linearised model in quiescent periods (0: off)
 
   int frame_hit; //Option to use frame hits"
   double frame_hit_time; //Time of frame event (s)
@@ -110,7 +113,7 @@ typedef struct {
   int dobbfb; // bbfb loop?
   int decimation_filter; // option to filter with average during decimation
   double bbfb_tclock; // clock period of the BBFB process [s]
-  double carrier_frequency; // pixel carrier frequency [Hz] TODO: need to harmonize this with multipixel code in which carrier freq are read from XML
+  double carrier_frequency; // pixel carrier frequency [Hz] (single pixel only: with several pixels, the carriers are read from the channel file)
   int bbfb_delay; // delay in clock cycles units of the FB loops (only integer values accepted here - would need DDE integrator otherwise)
   double bbfb_gbw; // gain bandwidth of the BBFB [Hz]
   double bias_leakage; // leakage level from the bias line to the direct chain
@@ -273,6 +276,71 @@ void tes_fits_read_params(char *file,tespxlparams *tes, int *status);
 
 // stochastic_integrator
 int sde_step(double a(double X[], int k, void *params), double b(double X[], int k, int j, void *params), int dim, int m, double Y[], const double delta_t, const gsl_rng *r, void *params);
+// drift (a) and noise terms (b) of the TES system for sde_step
+double TES_sde_deterministic(double X[], int k, void *params);
+double TES_sde_noise(double X[], int k, int j, void *params);
+
+// specialized stochastic integrator for the TES system
+#define TES_SDE_DIM 2           // dimension of the TES system (I0, T1)
+#define TES_SDE_NOISE_TERMS 3   // number of noise terms
+#define TES_SDE_SERIES_TERMS 10 // number of series terms for the stochastic integrals
+
+// persistent per-pixel workspace of tes_sde_step
+typedef struct {
+  double xi[TES_SDE_NOISE_TERMS];  // gaussian random variables
+  double mu[TES_SDE_NOISE_TERMS];
+  double phi[TES_SDE_NOISE_TERMS];
+  double zeta[TES_SDE_NOISE_TERMS][2*TES_SDE_SERIES_TERMS]; // Fourier coefficients, zero-padded beyond p
+  double eta[TES_SDE_NOISE_TERMS][2*TES_SDE_SERIES_TERMS];
+
+  double II[TES_SDE_NOISE_TERMS+1][TES_SDE_NOISE_TERMS+1]; // double stochastic integrals
+  double III[TES_SDE_NOISE_TERMS+1][TES_SDE_NOISE_TERMS+1][TES_SDE_NOISE_TERMS+1]; // triple stochastic integrals
+
+  // precomputed coefficients only depending on p
+  double rho_p;
+  double alpha_p;
+  double rinv[TES_SDE_SERIES_TERMS];  // 1/r
+  double r2inv[TES_SDE_SERIES_TERMS]; // 1/r^2
+  double crl[TES_SDE_SERIES_TERMS][TES_SDE_SERIES_TERMS]; // r/(r^2-l^2), 0 for r==l
+  double w1[TES_SDE_SERIES_TERMS][TES_SDE_SERIES_TERMS];   // weights of the sums of D_p
+  double w2[TES_SDE_SERIES_TERMS][TES_SDE_SERIES_TERMS];
+  double w3[TES_SDE_SERIES_TERMS][2*TES_SDE_SERIES_TERMS];
+} tes_sde_workspace;
+
+tes_sde_workspace *tes_sde_init_workspace(int *status);
+void tes_sde_free_workspace(tes_sde_workspace **ws);
+// one step of the stochastic integrator with m (0 or TES_SDE_NOISE_TERMS) noise terms
+int tes_sde_step(tesparams *tes, int m, double Y[], const gsl_rng *r);
+void TES_sde_coefficients(tesparams *tes, const double X[],
+	double a[TES_SDE_DIM], double b[TES_SDE_DIM][TES_SDE_NOISE_TERMS]);
+
+// linearised small-signal model for quiescent periods
+// number of steps before the next impact at which the full integration is resumed
+#define TES_QUIESCENT_LOOKAHEAD 16
+
+typedef struct {
+  double tol;        // relative tolerance around the operating point
+  double x0[2];      // operating point (I0_start, T_start)
+  double Phi[2][2];  // state-transition matrix of one step
+  double d[2];       // offset of one step due to the drift at the operating point
+  double L[2][2];    // Cholesky factor of the noise covariance of one step
+  int active;        // was the last step done with the linear model?
+  unsigned long nsteps; // number of steps done with the linear model
+} tes_quiescent_info;
+
+tes_quiescent_info *tes_init_quiescent(tesparams *tes, double tol, int *status);
+void tes_free_quiescent(tes_quiescent_info **qs);
+// returns 1 if the TES state Y is within the tolerance of the operating point
+// and the next impact is far enough away
+int tes_is_quiescent(tesparams *tes, const double Y[]);
+// one step of the linearised model
+void tes_quiescent_step(tesparams *tes, double Y[], const gsl_rng *r);
+
+// Boltzmann constant [J/K]
+extern const double kBoltz;
+
+// power flow to the heat sink at the current temperature
+double tpow(tesparams *tes);
 
 // frame hit integrator
 double frameImpactEffects(double time_hit, tesparams* tes, int* shift);
@@ -286,39 +354,69 @@ void read_frame_hit_file(tesparams *tes, int *status);
 ////////////////////////////////
 // BBFB structure and functions
 ///////////////////////////////
+
+// Number of clock steps after which the carrier phasors are computed
+// again exactly instead of being advanced by rotation
+#define BBFB_CARRIER_RESYNC 4096
+
+// BBFB loop of a readout channel: one SQUID and one feedback line
+// shared by all pixels (carriers) of the channel
 typedef struct {
 
   // BBFB parameters
   int delay; // number of clock cycles delay
   double tclock; // clock period
   double time_delay; // loop delay in seconds (to avoid doing delay*tclock all the time)
-  double carrier_frequency; // frequency of the carrier
   double gbw; // gain bandwidth product
-  double phase; // carrier phase
-  double cphase; // correction phase
-  double bias_leakage; // level of leakage from the bias line onto the direct line [A]
-  double bias_leakage_phase; // phase shift between the leakage and the signal
+  double gain; // integrator gain per clock (tclock*gbw*2*pi*2)
   double fb_leakage; // leakage level from the feedback line to the direct chain
   int fb_leakage_lag; // delay in clock cycles of the FB leakage
 
+  // Carriers (one value per pixel, structure of arrays)
+  int npix; // number of pixels in the loop
+  int maxpix; // allocated length of the per-pixel arrays
+  tesparams **pixels; // pixels of the channel
+  double *carrier_frequency; // frequency of the carrier
+  double *phase; // carrier phase
+  double *bias_leakage; // level of leakage from the bias line onto the direct line [A]
+  double *bias_leakage_phase; // phase shift between the leakage and the signal
+  double *carrier_re, *carrier_im; // carrier phasor exp(i*(2*pi*f*time+phase)) at carrier_time
+  double *rotation_re, *rotation_im; // phasor rotation over one time step
+  double *cphase_re, *cphase_im; // exp(-i*cphase), cphase being the loop delay correction phase
+  double *leakage_re, *leakage_im; // exp(i*bias_leakage_phase)
+  double *integral_re, *integral_im; // integrator
+  double *output; // demodulated output (IQ amplitude) of the last clock
+
+  // Carrier time stepping
+  double time_step; // time step between two calls of the loop
+  double carrier_time; // time at which the carrier phasors are valid
+  int carrier_steps; // number of rotations since the phasors were last computed exactly
+
   // Necessary buffers
-  double _Complex integral;
-  double* fb_values;
+  double* fb_values; // feedback (sum over the carriers) of the last delay clocks
   int fb_index;
 
 } timedomain_bbfb_info;
 
-// Constructor of a timedomain_bbfb_info structure
-timedomain_bbfb_info* init_timedomain_bbfb(double tclock,int delay,double carrier_frequency,
-    double gbw,double phase,double bias_leakage,double bias_leakage_phase,
-    double fb_leakage,int fb_leakage_lag,double fb_start,int* status);
+// Constructor of a timedomain_bbfb_info structure (without pixels)
+timedomain_bbfb_info* init_timedomain_bbfb(double tclock,int delay,double gbw,
+    double fb_leakage,int fb_leakage_lag,int* status);
+
+// Add a pixel (carrier) to a BBFB loop. The loop is assigned to tes->bbfb_info
+void add_timedomain_bbfb_pixel(timedomain_bbfb_info *bbfb,tesparams *tes,
+    double carrier_frequency,double phase,double bias_leakage,
+    double bias_leakage_phase,double fb_start,int* status);
 
 // Destructor of timedomain_bbfb_info structure
 void free_timedomain_bbfb(timedomain_bbfb_info **bbfb,int *status);
 
-// Run BBFB loop clock
+// Run BBFB loop clock (for all pixels of the loop of the given TES).
+// Returns the output of the given TES
 double run_timedomain_bbfb_loop(tesparams *tes, double time, double squid_input, double squid_noise_value,gsl_rng *rng);
 
+// Run one BBFB clock for all pixels of a loop, the SQUID input
+// current of each pixel being its current I0
+void run_timedomain_bbfb_channel(timedomain_bbfb_info *bbfb, double time, double squid_noise_value,gsl_rng *rng);
 
 
 #endif
@@ -23,59 +23,187 @@
 #include "tessim.h"
 
 #include <math.h>
-#include <complex.h>
 
-// Constructor of a timedomain_bbfb_info structure
-timedomain_bbfb_info* init_timedomain_bbfb(double tclock,int delay,double carrier_frequency,
-    double gbw,double phase,double bias_leakage,double bias_leakage_phase,
-    double fb_leakage,int fb_leakage_lag,double fb_start,int* status){
+// Constructor of a timedomain_bbfb_info structure (without pixels)
+timedomain_bbfb_info* init_timedomain_bbfb(double tclock,int delay,double gbw,
+    double fb_leakage,int fb_leakage_lag,int* status){
   timedomain_bbfb_info *bbfb=(timedomain_bbfb_info*)malloc(sizeof(*bbfb));
   CHECK_NULL_RET(bbfb,*status,"Memory allocation failed in init_timedomain_bbfb",NULL);
 
   bbfb->delay = delay;
   bbfb->tclock = tclock;
   bbfb->time_delay = delay*tclock;
-  bbfb->carrier_frequency = carrier_frequency;
   bbfb->gbw = gbw;
-  bbfb->phase = phase; // phase of the carrier. Is useless until several carriers are in the same BBFB loop
-  bbfb->cphase = 2*M_PI*bbfb->time_delay*carrier_frequency;
-  bbfb->integral=fb_start*sqrt(2)/(bbfb->tclock*bbfb->gbw*2*M_PI*2); // necessary to compensate for artificial perfect lock at simulation start
-  bbfb->bias_leakage=bias_leakage;
-  bbfb->bias_leakage_phase=bias_leakage_phase;
+  bbfb->gain = bbfb->tclock*bbfb->gbw*2*M_PI*2; // x2 is to compensate modulation loss and have the correct GBW product
   bbfb->fb_leakage=fb_leakage;
   bbfb->fb_leakage_lag=fb_leakage_lag;
 
+  bbfb->npix=0;
+  bbfb->maxpix=0;
+  bbfb->pixels=NULL;
+  bbfb->carrier_frequency=NULL;
+  bbfb->phase=NULL;
+  bbfb->bias_leakage=NULL;
+  bbfb->bias_leakage_phase=NULL;
+  bbfb->carrier_re=NULL;
+  bbfb->carrier_im=NULL;
+  bbfb->rotation_re=NULL;
+  bbfb->rotation_im=NULL;
+  bbfb->cphase_re=NULL;
+  bbfb->cphase_im=NULL;
+  bbfb->leakage_re=NULL;
+  bbfb->leakage_im=NULL;
+  bbfb->integral_re=NULL;
+  bbfb->integral_im=NULL;
+  bbfb->output=NULL;
+
+  bbfb->time_step=0.;
+  bbfb->carrier_time=0.;
+  bbfb->carrier_steps=BBFB_CARRIER_RESYNC; // phasors are computed at the first clock
+
   bbfb->fb_values = (double*)malloc(delay*sizeof(double));
   CHECK_NULL_RET(bbfb->fb_values,*status,"Memory allocation failed in init_timedomain_bbfb",NULL);
-
-  // Initialize FB values with perfect carrier nulling. Necessary to lock FB loop at simulation start
   for (int ii=0;ii<delay;ii++){
-    bbfb->fb_values[ii]=fb_start*sqrt(2)*cos(2*M_PI*bbfb->carrier_frequency*(ii+1)*tclock+bbfb->phase);
+    bbfb->fb_values[ii]=0.;
   }
   bbfb->fb_index=0;
 
   return (bbfb);
 }
 
+// Reallocate one of the per-pixel arrays of a BBFB loop
+static double* realloc_bbfb_array(double *array,int maxpix,int* status){
+  double *new_array=(double*)realloc(array,maxpix*sizeof(double));
+  CHECK_NULL_RET(new_array,*status,"Memory allocation failed in add_timedomain_bbfb_pixel",array);
+  return(new_array);
+}
+
+// Add a pixel (carrier) to a BBFB loop. The loop is assigned to tes->bbfb_info
+void add_timedomain_bbfb_pixel(timedomain_bbfb_info *bbfb,tesparams *tes,
+    double carrier_frequency,double phase,double bias_leakage,
+    double bias_leakage_phase,double fb_start,int* status){
+  CHECK_STATUS_VOID(*status);
+
+  if (bbfb->npix==bbfb->maxpix){
+    int maxpix=(bbfb->maxpix==0) ? 1 : 2*bbfb->maxpix;
+    tesparams **pixels=(tesparams**)realloc(bbfb->pixels,maxpix*sizeof(*pixels));
+    CHECK_NULL_VOID(pixels,*status,"Memory allocation failed in add_timedomain_bbfb_pixel");
+    bbfb->pixels=pixels;
+    bbfb->carrier_frequency=realloc_bbfb_array(bbfb->carrier_frequency,maxpix,status);
+    bbfb->phase=realloc_bbfb_array(bbfb->phase,maxpix,status);
+    bbfb->bias_leakage=realloc_bbfb_array(bbfb->bias_leakage,maxpix,status);
+    bbfb->bias_leakage_phase=realloc_bbfb_array(bbfb->bias_leakage_phase,maxpix,status);
+    bbfb->carrier_re=realloc_bbfb_array(bbfb->carrier_re,maxpix,status);
+    bbfb->carrier_im=realloc_bbfb_array(bbfb->carrier_im,maxpix,status);
+    bbfb->rotation_re=realloc_bbfb_array(bbfb->rotation_re,maxpix,status);
+    bbfb->rotation_im=realloc_bbfb_array(bbfb->rotation_im,maxpix,status);
+    bbfb->cphase_re=realloc_bbfb_array(bbfb->cphase_re,maxpix,status);
+    bbfb->cphase_im=realloc_bbfb_array(bbfb->cphase_im,maxpix,status);
+    bbfb->leakage_re=realloc_bbfb_array(bbfb->leakage_re,maxpix,status);
+    bbfb->leakage_im=realloc_bbfb_array(bbfb->leakage_im,maxpix,status);
+    bbfb->integral_re=realloc_bbfb_array(bbfb->integral_re,maxpix,status);
+    bbfb->integral_im=realloc_bbfb_array(bbfb->integral_im,maxpix,status);
+    bbfb->output=realloc_bbfb_array(bbfb->output,maxpix,status);
+    CHECK_STATUS_VOID(*status);
+    bbfb->maxpix=maxpix;
+  }
+
+  int pp=bbfb->npix;
+  bbfb->pixels[pp]=tes;
+  bbfb->carrier_frequency[pp]=carrier_frequency;
+  bbfb->phase[pp]=phase; // phase of the carrier
+  bbfb->bias_leakage[pp]=bias_leakage;
+  bbfb->bias_leakage_phase[pp]=bias_leakage_phase;
+
+  // All pixels of the loop are propagated with the same time step
+  bbfb->time_step=tes->delta_t;
+  double rotation=2*M_PI*carrier_frequency*bbfb->time_step;
+  bbfb->rotation_re[pp]=cos(rotation);
+  bbfb->rotation_im[pp]=sin(rotation);
+  double cphase=2*M_PI*bbfb->time_delay*carrier_frequency;
+  bbfb->cphase_re[pp]=cos(cphase);
+  bbfb->cphase_im[pp]=-sin(cphase);
+  if (bias_leakage_phase==-999){ // random phase, drawn at every clock
+    bbfb->leakage_re[pp]=1.;
+    bbfb->leakage_im[pp]=0.;
+  } else {
+    bbfb->leakage_re[pp]=cos(bias_leakage_phase);
+    bbfb->leakage_im[pp]=sin(bias_leakage_phase);
+  }
+  bbfb->integral_re[pp]=fb_start*sqrt(2)/bbfb->gain; // necessary to compensate for artificial perfect lock at simulation start
+  bbfb->integral_im[pp]=0.;
+  bbfb->output[pp]=0.;
+
+  // Initialize FB values with perfect carrier nulling. Necessary to lock FB loop at simulation start
+  for (int ii=0;ii<bbfb->delay;ii++){
+    bbfb->fb_values[ii]+=fb_start*sqrt(2)*cos(2*M_PI*carrier_frequency*(ii+1)*bbfb->tclock+phase);
+  }
+
+  bbfb->npix++;
+  bbfb->carrier_steps=BBFB_CARRIER_RESYNC;
+
+  tes->bbfb_info=bbfb;
+  tes->bbfb_index=pp;
+}
+
 // Destructor of timedomain_bbfb_info structure
 void free_timedomain_bbfb(timedomain_bbfb_info **bbfb,int *status) {
   CHECK_STATUS_VOID(*status);
   if (*bbfb!=NULL){
     free((*bbfb)->fb_values);
+    free((*bbfb)->pixels);
+    free((*bbfb)->carrier_frequency);
+    free((*bbfb)->phase);
+    free((*bbfb)->bias_leakage);
+    free((*bbfb)->bias_leakage_phase);
+    free((*bbfb)->carrier_re);
+    free((*bbfb)->carrier_im);
+    free((*bbfb)->rotation_re);
+    free((*bbfb)->rotation_im);
+    free((*bbfb)->cphase_re);
+    free((*bbfb)->cphase_im);
+    free((*bbfb)->leakage_re);
+    free((*bbfb)->leakage_im);
+    free((*bbfb)->integral_re);
+    free((*bbfb)->integral_im);
+    free((*bbfb)->output);
+    free(*bbfb);
   }
   *bbfb=NULL;
 }
 
-// Run BBFB loop clock
-// TODO: this function is effectively valid only for one pixel. It will need to be adapted for a multiple pixels loop
-double run_timedomain_bbfb_loop(tesparams *tes, double time, double squid_input,double squid_noise_value,gsl_rng *rng){
-  timedomain_bbfb_info* bbfb = (timedomain_bbfb_info*) tes->bbfb_info;
+// Set the carrier phasors exp(i*(2*pi*f*time+phase)) at the given time.
+// Consecutive clocks advance them by one rotation, which replaces the
+// cexp/cos per pixel and clock. They are computed again exactly every
+// BBFB_CARRIER_RESYNC clocks to bound the accumulated rounding errors,
+// and whenever the time is not one step after the previous one.
+static void update_bbfb_carriers(timedomain_bbfb_info *bbfb, double time){
+  if (bbfb->carrier_steps<BBFB_CARRIER_RESYNC &&
+      fabs(time-bbfb->carrier_time-bbfb->time_step)<0.5*bbfb->time_step){
+    for (int pp=0;pp<bbfb->npix;pp++){
+      double re=bbfb->carrier_re[pp]*bbfb->rotation_re[pp]-bbfb->carrier_im[pp]*bbfb->rotation_im[pp];
+      double im=bbfb->carrier_re[pp]*bbfb->rotation_im[pp]+bbfb->carrier_im[pp]*bbfb->rotation_re[pp];
+      bbfb->carrier_re[pp]=re;
+      bbfb->carrier_im[pp]=im;
+    }
+    bbfb->carrier_steps++;
+  } else {
+    for (int pp=0;pp<bbfb->npix;pp++){
+      double angle=2*M_PI*bbfb->carrier_frequency[pp]*time+bbfb->phase[pp];
+      bbfb->carrier_re[pp]=cos(angle);
+      bbfb->carrier_im[pp]=sin(angle);
+    }
+    bbfb->carrier_steps=0;
+  }
+  bbfb->carrier_time=time;
+}
 
-  // TODO: precompute lod and lor ? -> we only have ten numbers per period
+// Run one BBFB clock for all pixels of a loop, the SQUID input
+// current of each pixel being its current I0
+void run_timedomain_bbfb_channel(timedomain_bbfb_info *bbfb, double time, double squid_noise_value,gsl_rng *rng){
 
-  // Modulation and demodulation numbers
-  double _Complex lod = cexp(I*(2*M_PI*bbfb->carrier_frequency*time+bbfb->phase));
-  double _Complex lor = cexp(-I*(2*M_PI*bbfb->carrier_frequency*time+bbfb->phase+bbfb->cphase));
+  // Modulation and demodulation numbers (lod=carrier, lor=conj(carrier)*exp(-i*cphase))
+  update_bbfb_carriers(bbfb,time);
 
   // Compute random leakage phases if needed (note that this is not physical but random phase can be used as a worst case: leakage is treated as noise)
   // Signal leakage from FB line to SQUID output
@@ -86,37 +214,67 @@ double run_timedomain_bbfb_loop(tesparams *tes, double time, double squid_input,
   } else {
     fb_leakage_value = bbfb->fb_leakage*bbfb->fb_values[(bbfb->fb_index-bbfb->fb_leakage_lag+bbfb->delay) % bbfb->delay];
   }
-  // Signal leakage from bias line to SQUID output
-  double bias_leakage_value;
-  if (bbfb->bias_leakage_phase==-999){
-    bias_leakage_value = bbfb->bias_leakage*cos(2*M_PI*bbfb->carrier_frequency*time+bbfb->phase+gsl_rng_uniform(rng)*2*M_PI)*sqrt(2);
-  } else {
-    bias_leakage_value = bbfb->bias_leakage*cos(2*M_PI*bbfb->carrier_frequency*time+bbfb->phase+bbfb->bias_leakage_phase)*sqrt(2);
-  }
 
-  // Modulate input
-  squid_input*=cos(2*M_PI*bbfb->carrier_frequency*time+bbfb->phase)*sqrt(2); // change from rms to amplitude
+  // Modulate input of all carriers and add the signal leakage from bias line to SQUID output
+  double squid_input=0.;
+  double bias_leakage_value=0.;
+  for (int pp=0;pp<bbfb->npix;pp++){
+    squid_input+=bbfb->pixels[pp]->I0*bbfb->carrier_re[pp];
+    if (bbfb->bias_leakage_phase[pp]==-999){
+      double random_phase=gsl_rng_uniform(rng)*2*M_PI;
+      bias_leakage_value+=bbfb->bias_leakage[pp]*(bbfb->carrier_re[pp]*cos(random_phase)-bbfb->carrier_im[pp]*sin(random_phase));
+    } else {
+      bias_leakage_value+=bbfb->bias_leakage[pp]*(bbfb->carrier_re[pp]*bbfb->leakage_re[pp]-bbfb->carrier_im[pp]*bbfb->leakage_im[pp]);
+    }
+  }
+  squid_input*=sqrt(2); // change from rms to amplitude
+  bias_leakage_value*=sqrt(2);
 
   // Compute error signal at squid input and add noise
   double current_error = squid_input-bbfb->fb_values[bbfb->fb_index]+bias_leakage_value+fb_leakage_value+squid_noise_value;
 
-  // Error signal in phi_0 units
-  tes->squid_error=tes->M_in*current_error/tes->TTR;
+  // Error signal in phi_0 units (assuming the same SQUID coupling for all pixels of the channel)
+  tesparams *tes=bbfb->pixels[0];
+  double squid_error=tes->M_in*current_error/tes->TTR;
 
   // SQUID transfer function simulated as a sine wave + gain correction to keep signal in units of TES current
-  double error=sin(2*M_PI*tes->squid_error)/(2*M_PI)/tes->M_in*tes->TTR;
+  double error=sin(2*M_PI*squid_error)/(2*M_PI)/tes->M_in*tes->TTR;
 
-  // Integrate signal
-  bbfb->integral+= error*lod; // no need to add - delay as error_index is modulo delay
+  // Integrate signal, compute the output and the feedback of each carrier
+  double fb_value=0.;
+  for (int pp=0;pp<bbfb->npix;pp++){
+    bbfb->integral_re[pp]+=error*bbfb->carrier_re[pp]; // no need to add - delay as error_index is modulo delay
+    bbfb->integral_im[pp]+=error*bbfb->carrier_im[pp];
+    double base_re=bbfb->integral_re[pp]*bbfb->gain;
+    double base_im=bbfb->integral_im[pp]*bbfb->gain;
+    // creal(base*lor)
+    double lor_re=bbfb->carrier_re[pp]*bbfb->cphase_re[pp]+bbfb->carrier_im[pp]*bbfb->cphase_im[pp];
+    double lor_im=bbfb->carrier_re[pp]*bbfb->cphase_im[pp]-bbfb->carrier_im[pp]*bbfb->cphase_re[pp];
+    fb_value+=base_re*lor_re-base_im*lor_im;
+    // TODO: This corresponds to IQ demodulation, creal would correspond to I demodulation (might want to have this as an option using readoutMode)
+    bbfb->output[pp]=hypot(base_re,base_im);
+    bbfb->pixels[pp]->squid_error=squid_error;
+  }
 
-  // Compute feedback and update values for next loop
-  double _Complex base = bbfb->integral*bbfb->tclock*bbfb->gbw*2*M_PI*2; // x2 is to compensate modulation loss and have the correct GBW product
-  //printf("t: %g e: %g phi: %g fb: %g int: %g base: %g\n",time,current_error,tes->squid_error,bbfb->fb_values[bbfb->fb_index],creal(bbfb->integral),cabs(base));
-  bbfb->fb_values[bbfb->fb_index] = creal(base*lor);
+  // Update values for next loop
+  bbfb->fb_values[bbfb->fb_index] = fb_value;
 
   // Go to next index for feedback values
   bbfb->fb_index = (bbfb->fb_index+1) % bbfb->delay;
+}
+
+// Run BBFB loop clock (for all pixels of the loop of the given TES).
+// The loop is run when called for its first pixel, i.e., once all
+// pixels have been propagated (the SQUID input of each pixel is its
+// current I0, squid_input being the one of the given TES). For the
+// other pixels, the output of that clock is returned.
+double run_timedomain_bbfb_loop(tesparams *tes, double time, double squid_input,double squid_noise_value,gsl_rng *rng){
+  timedomain_bbfb_info* bbfb = (timedomain_bbfb_info*) tes->bbfb_info;
+  (void)squid_input;
+
+  if (tes->bbfb_index==0){
+    run_timedomain_bbfb_channel(bbfb,time,squid_noise_value,rng);
+  }
 
-  // TODO: This corresponds to IQ demodulation, creal would correspond to I demodulation (might want to have this as an option using readoutMode)
-  return(cabs(base));
+  return(bbfb->output[tes->bbfb_index]);
 }
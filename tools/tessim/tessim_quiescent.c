@@ -0,0 +1,237 @@
+/*
+   This file is part of SIXTE.
+
+   SIXTE is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   any later version.
+
+   SIXTE is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   For a copy of the GNU General Public License see
+   <http://www.gnu.org/licenses/>.
+
+
+   Copyright 2019 Remeis-Sternwarte, Friedrich-Alexander-Universitaet
+                  Erlangen-Nuernberg
+*/
+
+//
+// Linearised small-signal model of the TES for quiescent periods
+//
+// Between photon impacts the TES relaxes back to its operating point
+// Y0=(I0_start, T_start). Close to this point one step of the
+// integrator used in tes_propagate, Y_{k+1}=F(Y_k, n_k) with the noise
+// terms n_k, is well described by its linearisation
+//   Y_{k+1} = Y0 + Phi (Y_k-Y0) + d + G n_k,
+// with the state-transition matrix Phi=dF/dY, the offset d=F(Y0,0)-Y0
+// and the noise gain G=dF/dn, all evaluated at the operating point.
+// The noise terms are the same as in the full integration, such that
+// G n_k is a gaussian vector with covariance Q=G Sigma G^T, which is
+// generated from two gaussian random numbers via the Cholesky factor
+// of Q.
+//
+
+#include "tessim.h"
+
+// Number of noise terms of TES_Tdifferential_NL.
+#define TES_QUIESCENT_NOISE_TERMS 6
+
+// One deterministic step of the integrator of tes_propagate from the
+// state Y with the noise terms set to the given values (in the order
+// Vdn, Vexc, Vcn, Vunk, Vbn, Pnb1). As in tes_propagate, the power
+// flow to the heat sink is evaluated at the start of the step.
+static int tes_quiescent_map(tesparams *tes, const double Y[],
+			     const double noise[], double Ynew[]) {
+  double T1=tes->T1;
+  double Pb1=tes->Pb1;
+
+  tes->T1=Y[1];
+  tes->Pb1=tpow(tes);
+  tes->Vdn =noise[0];
+  tes->Vexc=noise[1];
+  tes->Vcn =noise[2];
+  tes->Vunk=noise[3];
+  tes->Vbn =noise[4];
+  tes->Pnb1=noise[5];
+
+  double time=tes->time;
+  Ynew[0]=Y[0];
+  Ynew[1]=Y[1];
+  int s=gsl_odeiv2_driver_apply_fixed_step(tes->odedriver,&time,tes->delta_t,1,Ynew);
+
+  tes->T1=T1;
+  tes->Pb1=Pb1;
+  tes->Vdn=0.;
+  tes->Vexc=0.;
+  tes->Vcn=0.;
+  tes->Vunk=0.;
+  tes->Vbn=0.;
+  tes->Pnb1=0.;
+
+  return(s);
+}
+
+tes_quiescent_info *tes_init_quiescent(tesparams *tes, double tol, int *status) {
+  CHECK_STATUS_RET(*status,NULL);
+
+  tes_quiescent_info *qs=(tes_quiescent_info *) malloc(sizeof(tes_quiescent_info));
+  CHECK_MALLOC_RET_NULL_STATUS(qs,*status);
+
+  qs->tol=tol;
+  qs->active=0;
+  qs->nsteps=0;
+
+  // operating point
+  qs->x0[0]=tes->I0_start;
+  qs->x0[1]=tes->T_start;
+
+  double nonoise[TES_QUIESCENT_NOISE_TERMS]={0.,0.,0.,0.,0.,0.};
+  double Y1[2];
+  int s=tes_quiescent_map(tes,qs->x0,nonoise,Y1);
+  qs->d[0]=Y1[0]-qs->x0[0];
+  qs->d[1]=Y1[1]-qs->x0[1];
+
+  // state-transition matrix by central differences
+  for (int jj=0; jj<2; jj++) {
+    double h=1e-6*fabs(qs->x0[jj]);
+    double Yp[2]={qs->x0[0],qs->x0[1]};
+    double Ym[2]={qs->x0[0],qs->x0[1]};
+    Yp[jj]+=h;
+    Ym[jj]-=h;
+    double Fp[2], Fm[2];
+    s+=tes_quiescent_map(tes,Yp,nonoise,Fp);
+    s+=tes_quiescent_map(tes,Ym,nonoise,Fm);
+    for (int ii=0; ii<2; ii++) {
+      qs->Phi[ii][jj]=(Fp[ii]-Fm[ii])/(2.*h);
+    }
+  }
+  gsl_odeiv2_driver_reset(tes->odedriver);
+  if (s!=GSL_SUCCESS) {
+    SIXT_ERROR("failed to set up the linearised TES model");
+    *status=EXIT_FAILURE;
+    free(qs);
+    return(NULL);
+  }
+
+  // covariance of the noise per step
+  double Q[2][2]={{0.,0.},{0.,0.}};
+  if (tes->simnoise) {
+    double II=qs->x0[0];
+    double TT=qs->x0[1];
+    double RT=tes->RTI(tes,qs->x0);
+
+    if (tes->stochastic_integrator) {
+      // white noise terms of the SDE; their integral over one step
+      // is propagated with Gamma=int_0^delta_t exp(A s) ds, which
+      // is approximated by delta_t*(1+Phi)/2
+      double aa[TES_SDE_DIM], bb[TES_SDE_DIM][TES_SDE_NOISE_TERMS];
+      TES_sde_coefficients(tes,qs->x0,aa,bb);
+      double Gamma[2][2];
+      for (int ii=0; ii<2; ii++) {
+        for (int jj=0; jj<2; jj++) {
+          Gamma[ii][jj]=0.5*tes->delta_t*((ii==jj ? 1. : 0.)+qs->Phi[ii][jj]);
+        }
+      }
+      for (int kk=0; kk<TES_SDE_NOISE_TERMS; kk++) {
+        double g[2];
+        for (int ii=0; ii<2; ii++) {
+          g[ii]=(Gamma[ii][0]*bb[0][kk]+Gamma[ii][1]*bb[1][kk])/sqrt(tes->delta_t);
+        }
+        for (int ii=0; ii<2; ii++) {
+          for (int jj=0; jj<2; jj++) {
+            Q[ii][jj]+=g[ii]*g[jj];
+          }
+        }
+      }
+    } else {
+      // standard deviations of the noise terms as drawn in tes_propagate
+      double dRdI=tes->dRdI(tes,qs->x0);
+      double sigma[TES_QUIESCENT_NOISE_TERMS];
+      sigma[0]=sqrt(4.*kBoltz*TT*RT*tes->bandwidth);
+      sigma[1]=sqrt(4.*kBoltz*TT*RT*tes->bandwidth*2.*dRdI*II/RT);
+      sigma[2]=sqrt(4.*kBoltz*tes->Tb(tes)*tes->Reff*tes->bandwidth);
+      sigma[3]=sqrt(4.*kBoltz*TT*RT*tes->bandwidth*(1.+2*dRdI*II/RT)*tes->m_excess*tes->m_excess);
+      sigma[4]=tes->bias_noise*sqrt(tes->bandwidth);
+      double gamma=1.;
+      if (tes->mech==0) {
+        gamma=(pow(tes->Tb(tes)/TT,tes->n+1.0)+1.0)/2.0;
+      }
+      sigma[5]=sqrt(4*kBoltz*TT*TT*tes->Gb1*gamma*tes->bandwidth);
+
+      // noise gain, exact as the step is linear in the noise terms
+      for (int kk=0; kk<TES_QUIESCENT_NOISE_TERMS; kk++) {
+        if (sigma[kk]==0.) {
+          continue;
+        }
+        double noise[TES_QUIESCENT_NOISE_TERMS]={0.,0.,0.,0.,0.,0.};
+        double Fp[2], Fm[2];
+        noise[kk]=sigma[kk];
+        tes_quiescent_map(tes,qs->x0,noise,Fp);
+        noise[kk]=-sigma[kk];
+        tes_quiescent_map(tes,qs->x0,noise,Fm);
+        double g[2]={0.5*(Fp[0]-Fm[0]), 0.5*(Fp[1]-Fm[1])};
+        for (int ii=0; ii<2; ii++) {
+          for (int jj=0; jj<2; jj++) {
+            Q[ii][jj]+=g[ii]*g[jj];
+          }
+        }
+      }
+      gsl_odeiv2_driver_reset(tes->odedriver);
+    }
+  }
+
+  // Cholesky factor of Q
+  qs->L[0][0]=sqrt(MAX(Q[0][0],0.));
+  qs->L[0][1]=0.;
+  qs->L[1][0]=(qs->L[0][0]>0.) ? Q[1][0]/qs->L[0][0] : 0.;
+  qs->L[1][1]=sqrt(MAX(Q[1][1]-qs->L[1][0]*qs->L[1][0],0.));
+
+  return(qs);
+}
+
+void tes_free_quiescent(tes_quiescent_info **qs) {
+  if (*qs!=NULL) {
+    free(*qs);
+    *qs=NULL;
+  }
+}
+
+int tes_is_quiescent(tesparams *tes, const double Y[]) {
+  tes_quiescent_info *qs=(tes_quiescent_info *) tes->quiescent_info;
+
+  // resume the full integration a few samples before the next impact
+  if (tes->impact->time-tes->time<TES_QUIESCENT_LOOKAHEAD*tes->delta_t) {
+    return(0);
+  }
+  if (fabs(Y[0]-qs->x0[0])>qs->tol*fabs(qs->x0[0])) {
+    return(0);
+  }
+  if (fabs(Y[1]-qs->x0[1])>qs->tol*qs->x0[1]) {
+    return(0);
+  }
+  return(1);
+}
+
+void tes_quiescent_step(tesparams *tes, double Y[], const gsl_rng *r) {
+  tes_quiescent_info *qs=(tes_quiescent_info *) tes->quiescent_info;
+
+  double x0=Y[0]-qs->x0[0];
+  double x1=Y[1]-qs->x0[1];
+
+  Y[0]=qs->x0[0]+qs->Phi[0][0]*x0+qs->Phi[0][1]*x1+qs->d[0];
+  Y[1]=qs->x0[1]+qs->Phi[1][0]*x0+qs->Phi[1][1]*x1+qs->d[1];
+
+  if (tes->simnoise) {
+    double g0=gsl_ran_gaussian(r,1.);
+    double g1=gsl_ran_gaussian(r,1.);
+    Y[0]+=qs->L[0][0]*g0;
+    Y[1]+=qs->L[1][0]*g0+qs->L[1][1]*g1;
+  }
+
+  qs->active=1;
+  qs->nsteps++;
+}
@@ -468,3 +468,304 @@ int sde_step(double a(double X[], int k, void *params), double b(double X[], int
 
 	return GSL_SUCCESS;
 }
+
+
+// Specialized stochastic integrator for the TES system
+//
+// This is the same strong order 1.5 scheme as sde_step, specialized
+// for the two-dimensional TES system (I0, T1) with its
+// TES_SDE_NOISE_TERMS noise terms. Compared to sde_step
+// * all work arrays are kept in a persistent per-pixel workspace,
+// * drift and diffusion are evaluated once per sampling point,
+// * the coefficients of the p-series only depending on p are
+//   precomputed, and the Fourier coefficients are zero-padded such
+//   that the inner loops over the series terms are branch-free.
+
+tes_sde_workspace *tes_sde_init_workspace(int *status) {
+	tes_sde_workspace *ws = (tes_sde_workspace *) malloc(sizeof(tes_sde_workspace));
+	CHECK_MALLOC_RET_NULL_STATUS(ws,*status);
+
+	const int p = TES_SDE_SERIES_TERMS;
+
+	// zero padding of the Fourier coefficients beyond p
+	for (int j = 0; j < TES_SDE_NOISE_TERMS; j++) {
+		for (int r = 0; r < 2*TES_SDE_SERIES_TERMS; r++) {
+			ws->zeta[j][r] = 0.;
+			ws->eta[j][r] = 0.;
+		}
+	}
+
+	// coefficients rho_p, alpha_p
+	ws->rho_p = 0;
+	ws->alpha_p = 0;
+	for (int r = 1; r <= p; r++) {
+		ws->rho_p += 1./(r*r);
+		ws->alpha_p += 1./(r*r*r*r);
+	}
+	ws->rho_p = 1./12 - ws->rho_p/(2*M_PI*M_PI);
+	ws->alpha_p = M_PI*M_PI/180 - ws->alpha_p/(2*M_PI*M_PI);
+
+	// reciprocal series weights, such that the inner loops do not need divisions
+	for (int r = 1; r <= p; r++) {
+		ws->rinv[r-1] = 1./r;
+		ws->r2inv[r-1] = 1./(r*r);
+		for (int l = 1; l <= p; l++) {
+			ws->crl[r-1][l-1] = (r != l) ? (r/(1.*r*r-l*l)) : 0.;
+			ws->w1[l-1][r-1] = 1./(l*(1.*l+r));
+			ws->w2[l-1][r-1] = (r < l) ? 1./(r*(1.*l-r)) : 0.;
+		}
+	}
+	for (int l = 1; l <= p; l++) {
+		for (int r = 1; r <= 2*p; r++) {
+			ws->w3[l-1][r-1] = (r > l) ? 1./(r*(1.*r-l)) : 0.;
+		}
+	}
+
+	return ws;
+}
+
+void tes_sde_free_workspace(tes_sde_workspace **ws) {
+	if (*ws != NULL) {
+		free(*ws);
+		*ws = NULL;
+	}
+}
+
+int tes_sde_step(tesparams *tes, int m, double Y[], const gsl_rng *r) {
+
+	const int p = TES_SDE_SERIES_TERMS;
+	const int dim = TES_SDE_DIM;
+	const double delta_t = tes->delta_t;
+	tes_sde_workspace *ws = (tes_sde_workspace *) tes->sde_workspace;
+
+	if (m > TES_SDE_NOISE_TERMS) {
+		return GSL_EINVAL;
+	}
+
+	double aY[TES_SDE_DIM], bY[TES_SDE_DIM][TES_SDE_NOISE_TERMS];
+	TES_sde_coefficients(tes, Y, aY, bY);
+
+	// without noise terms the scheme reduces to an Euler step
+	if (m == 0) {
+		for (int k = 0; k < dim; k++) {
+			Y[k] = Y[k] + aY[k]*delta_t;
+		}
+		return GSL_SUCCESS;
+	}
+
+	double (*zeta)[2*TES_SDE_SERIES_TERMS] = ws->zeta;
+	double (*eta)[2*TES_SDE_SERIES_TERMS] = ws->eta;
+	double (*II)[TES_SDE_NOISE_TERMS+1] = ws->II;
+	double (*III)[TES_SDE_NOISE_TERMS+1][TES_SDE_NOISE_TERMS+1] = ws->III;
+	const double *rinv = ws->rinv;
+	const double *r2inv = ws->r2inv;
+
+	// first initialize all random variables (same order of draws as sde_step)
+	for (int i = 0; i < m; i++) {
+		ws->xi[i] = gsl_ran_gaussian(r, 1);
+		ws->mu[i] = gsl_ran_gaussian(r, 1);
+		ws->phi[i] = gsl_ran_gaussian(r, 1);
+		for (int j = 0; j < p; j++) {
+			zeta[i][j] = gsl_ran_gaussian(r, 1);
+			eta[i][j] = gsl_ran_gaussian(r, 1);
+		}
+	}
+	const double *xi = ws->xi;
+
+	const double sqrt_dt = sqrt(delta_t);
+	const double dt15 = pow(delta_t,1.5);
+	const double dt2 = delta_t*delta_t;
+	const double norm_D = M_PI*M_PI*pow(2,(2.5));
+
+	double dW[TES_SDE_NOISE_TERMS];
+	for (int j = 0; j < m; j++) {
+		dW[j] = sqrt_dt * xi[j];
+	}
+
+	// coefficients a_j, b_j
+	double aa[TES_SDE_NOISE_TERMS], bb[TES_SDE_NOISE_TERMS];
+	for (int j = 0; j < m; j++) {
+		double a_j = 0, b_j = 0;
+		for (int k = 0; k < p; k++) {
+			a_j += zeta[j][k]*rinv[k];
+			b_j += eta[j][k]*r2inv[k];
+		}
+		aa[j] = - a_j * sqrt(2*delta_t)/M_PI - 2*sqrt(delta_t*ws->rho_p)*ws->mu[j];
+		bb[j] = b_j*sqrt(delta_t/2) + sqrt(delta_t*ws->alpha_p)*ws->phi[j];
+	}
+
+	// stochastic integrals II(0,0), II(j,0), II(0,j), II(j,j), III(j,j,j)
+	II[0][0] = 0.5 * dt2;
+	for (int j = 0; j < m; j++) {
+		II[j+1][0] = 0.5 * delta_t * (sqrt_dt*xi[j] + aa[j]);
+		II[0][j+1] = dW[j]*delta_t - II[j+1][0];
+		II[j+1][j+1] = 0.5 * (dW[j]*dW[j]); // Stratonovich value, see sde_step
+		III[j+1][j+1][j+1] = 0.5 * (dW[j]*dW[j]/3 - delta_t) * dW[j];
+	}
+
+	// coefficients A_p, B_p, C_p for all pairs of noise terms
+	double A[TES_SDE_NOISE_TERMS][TES_SDE_NOISE_TERMS];
+	double B[TES_SDE_NOISE_TERMS][TES_SDE_NOISE_TERMS];
+	double C[TES_SDE_NOISE_TERMS][TES_SDE_NOISE_TERMS];
+	for (int j1 = 0; j1 < m; j1++) {
+		for (int j2 = 0; j2 < m; j2++) {
+			double A_p = 0, B_p = 0, C_p = 0;
+			for (int k = 0; k < p; k++) {
+				A_p += (zeta[j1][k] * eta[j2][k] - eta[j1][k] * zeta[j2][k])*rinv[k];
+				B_p += (zeta[j1][k] * zeta[j2][k] + eta[j1][k] * eta[j2][k])*r2inv[k];
+				const double *crl = ws->crl[k];
+				for (int l = 0; l < p; l++) {
+					C_p += (zeta[j1][k]*zeta[j2][l]*rinv[l] - (l+1)*eta[j1][k]*eta[j2][l]*rinv[k]) * crl[l];
+				}
+			}
+			A[j1][j2] = A_p/(2*M_PI);
+			B[j1][j2] = B_p/(4*M_PI*M_PI);
+			C[j1][j2] = - C_p/(2*M_PI*M_PI);
+		}
+	}
+
+	// II(j1,j2) and Stratonovich integrals J(j1,0,j2), J(0,j1,j2), J(j1,j2,0)
+	for (int j1 = 0; j1 < m; j1++) {
+		for (int j2 = 0; j2 < m; j2++) {
+			if (j1 != j2) {
+				II[j1+1][j2+1] = 0.5*delta_t*xi[j1]*xi[j2] - 0.5*sqrt_dt*(xi[j1]*aa[j2] - xi[j2]*aa[j1]) + A[j1][j2] * delta_t;
+			}
+			III[j1+1][0][j2+1] = dt2*xi[j1]*xi[j2]/6 + aa[j1]*II[0][j2+1]/2 + dt15*xi[j2]*bb[j1]/(2*M_PI) - dt2*B[j1][j2]
+								- dt15*aa[j2]*xi[j1]/4 + dt15*xi[j1]*bb[j2]/(2*M_PI);
+			III[0][j1+1][j2+1] = dt2*xi[j1]*xi[j2]/6 - dt15*xi[j2]*bb[j1]/M_PI + dt2*B[j1][j2] - dt15*aa[j2]*xi[j1]/4
+								+ dt15*xi[j1]*bb[j2]/(2*M_PI) + dt2*C[j1][j2] + dt2*A[j1][j2]/2;
+			III[j1+1][j2+1][0] = dt2*xi[j1]*xi[j2]/2 - dt15*(aa[j2]*xi[j1] - aa[j1]*xi[j2])/2 + dt2*A[j1][j2]
+								- III[j1+1][0][j2+1] - III[0][j1+1][j2+1];
+		}
+	}
+
+	// Stratonovich integrals J(j1,j2,j3)
+	for (int j1 = 0; j1 < m; j1++) {
+		for (int j2 = 0; j2 < m; j2++) {
+			for (int j3 = 0; j3 < m; j3++) {
+				if ((j1 == j2) && (j2 == j3)) {
+					continue;
+				}
+				const double *zeta1 = zeta[j1], *eta1 = eta[j1];
+				const double *zeta2 = zeta[j2], *eta2 = eta[j2];
+				const double *zeta3 = zeta[j3], *eta3 = eta[j3];
+
+				// the sums of D_p; coefficients beyond p are zero-padded
+				double sum1 = 0, sum2 = 0, sum3 = 0;
+				for (int l = 1; l <= p; l++) {
+					const double *w1 = ws->w1[l-1];
+					double s1 = 0;
+					for (int k = 1; k <= p; k++) {
+						s1 += (zeta2[l-1]*(zeta3[l+k-1]*eta1[k-1] - zeta1[k-1]*eta1[l+k-1])
+								+ eta2[l-1]*(zeta1[k-1]*zeta3[l+k-1] + eta1[k-1]*eta3[l+k-1])) * w1[k-1];
+					}
+					sum1 += s1;
+				}
+				sum1 = - sum1 / norm_D;
+
+				for (int l = 2; l <= p; l++) {
+					const double *w2 = ws->w2[l-1];
+					double s2 = 0;
+					for (int k = 1; k <= (l-1); k++) {
+						s2 += (zeta2[l-1]*(zeta1[k-1]*eta3[l-k-1] + zeta3[l-k-1]*eta1[k-1])
+								- eta2[l-1]*(zeta1[k-1]*zeta3[l-k-1] - eta1[k-1]*eta3[l-k])) * w2[k-1];
+					}
+					sum2 += s2;
+				}
+				sum2 = sum2 / norm_D;
+
+				for (int l = 1; l <= p; l++) {
+					const double *w3 = ws->w3[l-1];
+					double s3 = 0;
+					for (int k = (l+1); k <= 2*p; k++) {
+						s3 += (zeta2[l-1]*(zeta3[k-l-1]*eta1[k-1] - zeta1[k-1]*eta3[k-l-1])
+								+ eta2[l-1]*(zeta1[k-1]*zeta3[k-l-1] + eta1[k-1]*eta3[k-l-1])) * w3[k-1];
+					}
+					sum3 += s3;
+				}
+				sum3 = sum3 / norm_D;
+
+				double D_p = sum1 + sum2 + sum3;
+
+				III[j1+1][j2+1][j3+1] = xi[j1]*III[0][j2+1][j3+1]/sqrt_dt + 0.5*aa[j1]*II[j2+1][j3+1] + delta_t*bb[j1]*xi[j2]*xi[j3]/(2*M_PI)
+										- dt15*xi[j2]*B[j1][j3] + dt15*xi[j3]*(0.5*A[j1][j2] - C[j2][j1]) + dt15*D_p;
+			}
+		}
+	}
+
+	// Ito values of II(j,j)
+	for (int j = 0; j < m; j++) {
+		II[j+1][j+1] = 0.5 * (dW[j]*dW[j] - delta_t);
+	}
+
+	// triple Ito integrals III(j1,j2,j3)
+	for (int j1 = 1; j1 <= m; j1++) {
+		for (int j2 = 1; j2 <= m; j2++) {
+			for (int j3 = 1; j3 <= m; j3++) {
+				if (!((j1 == j2) && (j2 == j3))) {
+					int Ind_j1_j2 = (j1 == j2);
+					int Ind_j2_j3 = (j2 == j3);
+					III[j1][j2][j3] = III[j1][j2][j3]  - 0.5*(Ind_j1_j2 * II[0][j3] + Ind_j2_j3 * II[j1][0]);
+				}
+			}
+		}
+	}
+
+	// MAIN ALGORITHM
+	double sum1[TES_SDE_DIM], sum2[TES_SDE_DIM], sum3[TES_SDE_DIM], sum4[TES_SDE_DIM];
+	for (int k = 0; k < dim; k++) {
+		sum1[k] = sum2[k] = sum3[k] = sum4[k] = 0;
+		for (int j = 0; j < m; j++) {
+			sum1[k] += bY[k][j] * dW[j];
+		}
+	}
+
+	for (int j1 = 1; j1 <= m; j1++) {
+
+		// sampling points Y_plus and Y_minus
+		double Y_plus[TES_SDE_DIM], Y_minus[TES_SDE_DIM];
+		for (int i = 0; i < dim; i++) {
+			Y_plus[i] = Y[i] + (aY[i]*delta_t)/m + bY[i][j1-1]*sqrt_dt;
+			Y_minus[i] = Y[i] + (aY[i]*delta_t)/m - bY[i][j1-1]*sqrt_dt;
+		}
+		double aYp[TES_SDE_DIM], bYp[TES_SDE_DIM][TES_SDE_NOISE_TERMS];
+		double aYm[TES_SDE_DIM], bYm[TES_SDE_DIM][TES_SDE_NOISE_TERMS];
+		TES_sde_coefficients(tes, Y_plus, aYp, bYp);
+		TES_sde_coefficients(tes, Y_minus, aYm, bYm);
+
+		// second and third sum
+		for (int k = 0; k < dim; k++) {
+			sum2[k] += (aYp[k] - aYm[k]) * II[j1][0];
+			sum3[k] += (aYp[k] - 2*aY[k] + aYm[k]) * II[0][0];
+			for (int j2 = 1; j2 <= m; j2++) {
+				sum2[k] += (bYp[k][j2-1] - bYm[k][j2-1]) * II[j1][j2];
+				sum3[k] += (bYp[k][j2-1] - 2*bY[k][j2-1] + bYm[k][j2-1]) * II[0][j2];
+			}
+		}
+
+		// fourth sum
+		for (int j2 = 1; j2 <= m; j2++) {
+			double Phi_plus[TES_SDE_DIM], Phi_minus[TES_SDE_DIM];
+			for (int i = 0; i < dim; i++) {
+				Phi_plus[i] = Y_plus[i] + bYp[i][j2-1]*sqrt_dt;
+				Phi_minus[i] = Y_plus[i] - bYp[i][j2-1]*sqrt_dt;
+			}
+			double aPp[TES_SDE_DIM], bPp[TES_SDE_DIM][TES_SDE_NOISE_TERMS];
+			double aPm[TES_SDE_DIM], bPm[TES_SDE_DIM][TES_SDE_NOISE_TERMS];
+			TES_sde_coefficients(tes, Phi_plus, aPp, bPp);
+			TES_sde_coefficients(tes, Phi_minus, aPm, bPm);
+
+			for (int k = 0; k < dim; k++) {
+				for (int j3 = 1; j3 <= m; j3++) {
+					sum4[k] += (bPp[k][j3-1] - bPm[k][j3-1] - bYp[k][j3-1] + bYm[k][j3-1]) * III[j1][j2][j3];
+				}
+			}
+		}
+	}
+
+	for (int k = 0; k < dim; k++) {
+		Y[k] = Y[k] + aY[k]*delta_t + sum1[k] + sum2[k]/(2*sqrt_dt) + sum3[k]/(2*delta_t) + sum4[k]/(2*delta_t);
+	}
+
+	return GSL_SUCCESS;
+}
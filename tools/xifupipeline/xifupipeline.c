@@ -56,6 +56,12 @@ int xifupipeline_main()
 	// Piximpact file.
 	PixImpFile* pixilf=NULL;
 
+	// Pixel impacts of the current GTI.
+	PixImpactStore* impstore=NULL;
+
+	// Pixel impacts of the current GTI sorted by pixel.
+	PixImpactBuckets* buckets=NULL;
+
 	// Event list file
 	TesEventFile* event_file=NULL;
 
@@ -84,6 +90,7 @@ int xifupipeline_main()
 	// Register HEATOOL
 	set_toolname("xifupipeline");
 	set_toolversion("0.06");
+	initSixtProfiling("xifupipeline");
 
 
 	do { // Beginning of ERROR HANDLING Loop.
@@ -125,15 +132,13 @@ int xifupipeline_main()
 			strcat(impactlist_filename, par.ImpactList);
 		}
 
-		// Determine the piximpact list output file.
+		// Determine the piximpact list output file (optional, the
+		// impacts are passed on in memory).
 		char piximpactlist_filename[MAXFILENAME]={""};
 		strcpy(ucase_buffer, par.PixImpactList);
 		strtoupper(ucase_buffer);
-		int delete_rawdata=0;
 		if (0==strcmp(ucase_buffer,"NONE")) {
-			delete_rawdata=1;
-			strcpy(piximpactlist_filename, par.Prefix);
-			strcat(piximpactlist_filename, "piximpact.fits");
+			strcpy(piximpactlist_filename, "");
 		} else {
 			strcpy(piximpactlist_filename, par.Prefix);
 			strcat(piximpactlist_filename, par.PixImpactList);
@@ -313,26 +318,46 @@ int xifupipeline_main()
 			CHECK_STATUS_BREAK(status);
 		}
 
-		// Open the piximpact file
-		pixilf=openNewPixImpFile(piximpactlist_filename,telescop, instrume,
-				inst->tel->arf->Filter,
-				inst->tel->arf_filename,
-				inst->det->rmf_filename,
-				par.XMLFile,impactlist_filename,
-				par.MJDREF, 0.0, par.TSTART, tstop,
-				par.clobber, &status);
+		// Open the piximpact file.
+		if (strlen(piximpactlist_filename)>0) {
+			pixilf=openNewPixImpFile(piximpactlist_filename,telescop, instrume,
+					inst->tel->arf->Filter,
+					inst->tel->arf_filename,
+					inst->det->rmf_filename,
+					par.XMLFile,impactlist_filename,
+					par.MJDREF, 0.0, par.TSTART, tstop,
+					par.clobber, &status);
+			CHECK_STATUS_BREAK(status);
+		}
+
+		// Set up the store for the pixel impacts of a GTI. The TES
+		// streams need all impacts of a GTI sorted by pixels in memory,
+		// so moving them to a temporary file would only add I/O. The
+		// memory limit therefore only applies to the grading with the
+		// RMFs.
+		impstore=newPixImpactStore(par.UseRMF ?
+				(size_t)(par.MaxImpactMemory*1024.*1024.) : 0, &status);
 		CHECK_STATUS_BREAK(status);
 
 		// ---- TES initialization ----
-		// Not in Christian's initialization part, but for the moment we need an already existing piximpact file
 		if (!par.UseRMF){
 
 			// Copy parameters in general parameters structure
 			copyParams2GeneralStruct(par,&genpar,par.TSTART,tstop);
 
-			// Build up init structure
+			// Build up init structure with the keywords of the
+			// piximpact list
 			init = newInitStruct(&status);
 			CHECK_STATUS_BREAK(status);
+			strncpy(init->telescop, telescop, MAXMSG-1);
+			strncpy(init->instrume, instrume, MAXMSG-1);
+			strncpy(init->filter, inst->tel->arf->Filter, MAXMSG-1);
+			strncpy(init->ancrfile, inst->tel->arf_filename, MAXMSG-1);
+			strncpy(init->respfile, inst->det->rmf_filename, MAXMSG-1);
+			init->mjdref=par.MJDREF;
+			init->timezero=0.0;
+			init->tstart=par.TSTART;
+			init->tstop=tstop;
 			tesinitialization(init,&genpar,&status);
 			CHECK_STATUS_BREAK(status);
 			// Only one piximpact file should be open at a time
@@ -479,6 +504,17 @@ int xifupipeline_main()
 			CHECK_STATUS_BREAK(status);
 		}
 
+		// From now on the impacts and records are only appended to
+		// the files, which is done in blocks by the FITS writers.
+		if (NULL!=ilf) {
+			startImpactFileWriter(ilf, par.AsyncWrite, &status);
+			CHECK_STATUS_BREAK(status);
+		}
+		if (!par.UseRMF && NULL!=init->record_file) {
+			startTesTriggerFileWriter(init->record_file, par.AsyncWrite, &status);
+			CHECK_STATUS_BREAK(status);
+		}
+
 		// --- End of opening files ---
 
 		// --- Initialize Crosstalk Structure ---
@@ -516,8 +552,10 @@ int xifupipeline_main()
 		// Loop over all intervals in the GTI collection.
 		int gtibin=0;
 		double simtime=0.;
-		long current_impact_row = 0;
-		long current_impact_write_row = 0;
+		if (!par.UseRMF){
+			buckets=newPixImpactBuckets(init->det->npix,&status);
+			CHECK_STATUS_BREAK(status);
+		}
 		long nimpacts=0;
 
     // Start and end time of current mxs flash.
@@ -686,7 +724,10 @@ int xifupipeline_main()
 				nimpacts+=newPixImpacts;
 				if(newPixImpacts>0){
 					for(int jj=0; jj<newPixImpacts; jj++){
-						addImpact2PixImpFile(pixilf, &(piximp[jj]), &status);
+						addImpact2PixImpactStore(impstore, &(piximp[jj]), &status);
+						if (NULL!=pixilf) {
+							addImpact2PixImpFile(pixilf, &(piximp[jj]), &status);
+						}
 					}
 				}
 
@@ -723,82 +764,27 @@ int xifupipeline_main()
 
 			if (!par.UseRMF){
 				headas_chat(3, "\nstart event reconstruction ...\n");
-				// Generate the data streams for each pixel that has been hit
-				int* list_pixels=NULL;
-				getListPixelsHit(pixilf,&list_pixels,init->det->npix,&status);
+				// Sort the impacts of this GTI by pixel
+				fillPixImpactBucketsFromStore(buckets,impstore,&status);
 				CHECK_STATUS_BREAK(status);
 
-				// Close piximpact file
-				current_impact_write_row = pixilf->row;
-				freePixImpFile(&pixilf, &status);
-
-				init->impfile=openPixImpFile(piximpactlist_filename, READONLY,&status);
-				//CHECK_STATUS_BREAK(status);
-
-				// Iterate over the pixels that were hit and run simulation
-				for(int i=0;i<det->npix;i++){
-					if(list_pixels[i]){
-						// Activate corresponding pixel
-						init->activearray[i]=0;
-						genpar.nlo=i;
-						genpar.nhi=i;
-
-						// Reinitialize impact file
-						init->impfile->row = current_impact_row;
-
-						// Stream generation
-						TESDataStream* stream=newTESDataStream(&status);
-						CHECK_STATUS_BREAK(status);
-						int ismonoc=0;
-						float monoen=0.;
-
-						getTESDataStream(stream,
-								init->impfile,
-								init->profiles,
-								init->det,
-								t0,
-								t1,
-								init->det->npix,
-								1,
-								init->activearray,
-								init->Nevts,
-								&ismonoc,
-								&monoen,
-								genpar.seed, // should modify this, we already have a random generator
-								&status);
-						CHECK_STATUS_BREAK(status);
-
-						// Trigger and reconstruction
-						triggerWithImpact(stream,&genpar,init,monoen,reconstruct_init,par.EventListSize,par.Identify,&status);
-						CHECK_STATUS_BREAK(status);
-
-						// Release this stream and deactivate the treated pixel
-						destroyTESDataStream(stream);
-						init->activearray[i]=-1;
-
-					}
-				}
-				free(list_pixels);
+				// Generate the data streams for each pixel that has been hit
+				// and run the trigger and reconstruction on them (in the order
+				// of the pixels)
+				XifuPixelTrigger trigger={&genpar,init,reconstruct_init,buckets,
+						par.EventListSize,par.Identify,t0,t1};
+				processTESPixelStreams(buckets,init->profiles,init->det,t0,t1,
+						init->Nevts,
+						genpar.seed, // should modify this, we already have a random generator
+						par.Threads,triggerXifuPixel,&trigger,&status);
 				CHECK_STATUS_BREAK(status);
-
-				// Close piximpact file in read mode (there should be only one file open)
-				// after saving current row of impact file (this saves the row for next GTI)
-				current_impact_row = init->impfile->row;
-				freePixImpFile(&(init->impfile), &status);
-
-				// Reopen piximpact file for writing for next gti
-				pixilf = openPixImpFile(piximpactlist_filename,READWRITE,&status);
-				pixilf->row = current_impact_write_row;
 			} else{
 				headas_chat(3, "\nstart event grading ...\n");
-				current_impact_write_row = pixilf->row;
-				pixilf->row = current_impact_row; // reboot pixilf to first row of the GTI
-
-				impactsToEvents(det,pixilf,event_file,par.saveCrosstalk,progressfile,&status);
-
-				pixilf->row=current_impact_write_row;
-				current_impact_row=current_impact_write_row;
+				PixImpactSource source={NULL,NULL,0,0,impstore};
+				impactsToEvents(det,&source,event_file,par.saveCrosstalk,progressfile,&status);
+				CHECK_STATUS_BREAK(status);
 			}
+			clearPixImpactStore(impstore);
 
 			// Proceed to the next GTI interval.
 			simtime+=gti->stop[gtibin]-gti->start[gtibin];
@@ -831,12 +817,6 @@ int xifupipeline_main()
 
 		// --- End of simulation process ---
 
-		if (delete_rawdata){
-			headas_chat(3,"removing unwanted RawData file %s \n",piximpactlist_filename);
-			status = remove (piximpactlist_filename);
-			CHECK_STATUS_BREAK(status);
-		}
-
 		CHECK_STATUS_BREAK(status);
 
 
@@ -851,6 +831,8 @@ int xifupipeline_main()
 	freePhotonFile(&plf, &status);
 	freeImpactFile(&ilf, &status);
 	freePixImpFile(&pixilf, &status);
+	freePixImpactStore(&impstore);
+	freePixImpactBuckets(&buckets);
 	for (ii=0; ii<MAX_N_SIMPUT; ii++) {
 		freeSourceCatalog(&(srccat[ii]), &status);
 	}
@@ -873,6 +855,8 @@ int xifupipeline_main()
 	// Clean up the random number generator.
 	sixt_destroy_rng();
 
+	writeSixtProfiling();
+
 	if (EXIT_SUCCESS==status) {
 		headas_chat(3, "finished successfully!\n\n");
 		return(EXIT_SUCCESS);
@@ -1219,6 +1203,24 @@ int xifupipeline_getpar(struct Parameters* const par)
 		return(status);
 	}
 
+	status=ape_trad_query_bool("AsyncWrite", &par->AsyncWrite);
+	if (EXIT_SUCCESS!=status) {
+		SIXT_ERROR("failed reading the AsyncWrite parameter");
+		return(status);
+	}
+
+	status=ape_trad_query_int("Threads", &par->Threads);
+	if (EXIT_SUCCESS!=status) {
+		SIXT_ERROR("failed reading the Threads parameter");
+		return(status);
+	}
+
+	status=ape_trad_query_double("MaxImpactMemory", &par->MaxImpactMemory);
+	if (EXIT_SUCCESS!=status) {
+		SIXT_ERROR("failed reading the MaxImpactMemory parameter");
+		return(status);
+	}
+
 	/* Read mxs related parameters */
 	query_simput_parameter_bool("enable_mxs", &par->enable_mxs, &status);
 	query_simput_parameter_double("mxs_frequency", &par->mxs_frequency, &status);
@@ -1258,30 +1260,16 @@ void copyParams2GeneralStruct(const struct Parameters partmp, TESGeneralParamete
 	par->seed=partmp.Seed;
 }
 
-/** Iterates over the piximpact file to see which pixels were actually hit */
-void getListPixelsHit(PixImpFile* pixilf,int** list_pixels,int npix,int* const status){
-	*list_pixels = malloc(npix*sizeof(int));
-	if (NULL==*list_pixels){
-		*status=EXIT_FAILURE;
-		SIXT_ERROR("memory allocation for list_pixels failed");
-		return;
-	}
-	for(int i=0;i<npix;i++){
-		(*list_pixels)[i]=0;
-	}
-
-	long* pixids = malloc(pixilf->nrows*sizeof(*pixids));
-	if (NULL==pixids){
-		*status=EXIT_FAILURE;
-		SIXT_ERROR("memory allocation for pixids failed");
-		return;
-	}
-	int anynul=0;
-	fits_read_col(pixilf->fptr, TLONG, pixilf->cpix_id,1,1,pixilf->nrows,
-			NULL, pixids, &anynul, status);
-
-	for(int i=0;i<pixilf->nrows;i++){
-		(*list_pixels)[(int)(pixids[i]-1)]=1;
-	}
-
+/** Trigger and reconstruct the data stream of a single pixel. */
+void triggerXifuPixel(TESDataStream* const stream,const int pixel,const float monoen,
+		void* const data,int* const status){
+	XifuPixelTrigger* trigger=(XifuPixelTrigger*)data;
+	trigger->genpar->nlo=pixel;
+	trigger->genpar->nhi=pixel;
+	const PixImpactBuckets* buckets=trigger->buckets;
+	triggerWithImpactList(stream,trigger->genpar,trigger->init,monoen,
+			trigger->reconstruct_init,trigger->event_list_size,trigger->identify,
+			&(buckets->impact[buckets->first[pixel]]),
+			buckets->first[pixel+1]-buckets->first[pixel],
+			trigger->tstart,trigger->tstop,status);
 }
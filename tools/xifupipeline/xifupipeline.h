@@ -124,6 +124,17 @@ struct Parameters {
   /** TDM related constants*/
   int tdm;
 
+  /** Write the impact and record files in a background thread. */
+  char AsyncWrite;
+
+  /** Number of threads generating the TES data streams. */
+  int Threads;
+
+  /** Memory for the pixel impacts of a GTI [MB], beyond which they
+      are moved to a temporary file (0: no limit). Only used for the
+      grading with the RMFs. */
+  double MaxImpactMemory;
+
   char history;
   char clobber;
 
@@ -136,6 +147,19 @@ struct Parameters {
 };
 
 
+/** Data needed to trigger and reconstruct the pixel data streams of
+    a GTI. */
+typedef struct {
+  TESGeneralParameters* genpar;
+  TESInitStruct* init;
+  ReconstructInit* reconstruct_init;
+  const PixImpactBuckets* buckets;
+  int event_list_size;
+  char identify;
+  double tstart, tstop;
+} XifuPixelTrigger;
+
+
 ////////////////////////////////////////////////////////////////////////
 // Function declarations.
 ////////////////////////////////////////////////////////////////////////
@@ -147,7 +171,9 @@ int xifupipeline_getpar(struct Parameters* const par);
     general TES parameters structure */
 void copyParams2GeneralStruct(const struct Parameters partmp, TESGeneralParameters* const par,double tstart,double tstop);
 
-/** Iterates over the piximpact file to see which pixels were actually hit */
-void getListPixelsHit(PixImpFile* pixilf,int** list_pixels,int npix,int* const status);
+/** Trigger and reconstruct the data stream of a single pixel
+    (TESPixelStreamFct with a XifuPixelTrigger as data). */
+void triggerXifuPixel(TESDataStream* const stream,const int pixel,const float monoen,
+		void* const data,int* const status);
 
 #endif /* XIFUPIPELINE_H */